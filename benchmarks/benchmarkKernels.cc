@@ -0,0 +1,176 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2019 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+/*
+ *  Timing benchmarks for the C++ measurement kernels, run on synthetic images of a single Gaussian
+ *  source on a noisy background.
+ *
+ *  Usage: benchmarkKernels [output.json [minSeconds]]
+ *
+ *  Each kernel is run for at least minSeconds (default 0.2) for every combination of PSF size,
+ *  aperture radius (where relevant) and pixel container, and the number of sources measured per
+ *  second is reported.  Results are written as a JSON list to output.json, or to stdout.
+ */
+
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "boost/format.hpp"
+
+#include "lsst/geom.h"
+#include "lsst/afw/geom/ellipses.h"
+#include "lsst/afw/image.h"
+#include "lsst/meas/base/ApertureFlux.h"
+#include "lsst/meas/base/SdssShape.h"
+
+namespace geom = lsst::geom;
+namespace afwGeom = lsst::afw::geom;
+namespace afwImage = lsst::afw::image;
+namespace base = lsst::meas::base;
+
+namespace {
+
+double const NOISE = 10.0;
+double const FLUX = 1E5;
+
+struct BenchmarkResult {
+    std::string kernel;
+    std::string imageType;
+    double psfSigma;
+    double radius;
+    long iterations;
+    double seconds;
+};
+
+/// Fill an image with a circular Gaussian of the given sigma at the image center, plus Gaussian noise.
+template <typename PixelT>
+afwImage::MaskedImage<PixelT> makeScene(int size, double sigma, unsigned int seed) {
+    afwImage::MaskedImage<PixelT> scene(geom::Extent2I(size, size));
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise(0.0, NOISE);
+    double const center = 0.5 * (size - 1) + 0.2;
+    double const norm = FLUX / (2.0 * M_PI * sigma * sigma);
+    for (int y = 0; y < size; ++y) {
+        auto imageIter = scene.getImage()->row_begin(y);
+        for (int x = 0; x < size; ++x, ++imageIter) {
+            double const r2 = (x - center) * (x - center) + (y - center) * (y - center);
+            *imageIter = norm * std::exp(-0.5 * r2 / (sigma * sigma)) + noise(rng);
+        }
+    }
+    *scene.getVariance() = NOISE * NOISE;
+    return scene;
+}
+
+/// Call a kernel repeatedly, doubling the number of calls until they take at least minSeconds.
+template <typename Kernel>
+BenchmarkResult runBenchmark(std::string const& kernel, std::string const& imageType, double psfSigma,
+                             double radius, double minSeconds, Kernel const& function) {
+    function();  // warm up any caches (e.g. sinc coefficients), so they are not timed
+    long iterations = 1;
+    while (true) {
+        auto start = std::chrono::steady_clock::now();
+        for (long i = 0; i < iterations; ++i) {
+            function();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seconds >= minSeconds) {
+            return BenchmarkResult{kernel, imageType, psfSigma, radius, iterations, seconds};
+        }
+        iterations *= 2;
+    }
+}
+
+template <typename ImageT>
+void benchmarkApertures(std::vector<BenchmarkResult>& results, ImageT const& image,
+                        std::string const& imageType, double psfSigma, double minSeconds) {
+    geom::Point2D const center = geom::Box2D(image.getBBox()).getCenter();
+    for (double radius : {3.0, 6.0, 12.0, 25.0}) {
+        afwGeom::ellipses::Ellipse const ellipse(afwGeom::ellipses::Axes(radius, radius, 0.0), center);
+        base::ApertureFluxControl const ctrl;
+        results.push_back(runBenchmark("computeSincFlux", imageType, psfSigma, radius, minSeconds, [&]() {
+            base::ApertureFluxAlgorithm::computeSincFlux(image, ellipse, ctrl);
+        }));
+        results.push_back(runBenchmark("computeNaiveFlux", imageType, psfSigma, radius, minSeconds, [&]() {
+            base::ApertureFluxAlgorithm::computeNaiveFlux(image, ellipse, ctrl);
+        }));
+    }
+}
+
+template <typename ImageT>
+void benchmarkMoments(std::vector<BenchmarkResult>& results, ImageT const& image,
+                      std::string const& imageType, double psfSigma, double minSeconds) {
+    geom::Point2D const center = geom::Box2D(image.getBBox()).getCenter();
+    results.push_back(runBenchmark("computeAdaptiveMoments", imageType, psfSigma, 0.0, minSeconds, [&]() {
+        base::SdssShapeAlgorithm::computeAdaptiveMoments(image, center);
+    }));
+    afwGeom::ellipses::Quadrupole const shape(psfSigma * psfSigma, psfSigma * psfSigma, 0.0);
+    results.push_back(runBenchmark("computeFixedMomentsFlux", imageType, psfSigma, 0.0, minSeconds, [&]() {
+        base::SdssShapeAlgorithm::computeFixedMomentsFlux(image, shape, center);
+    }));
+}
+
+void writeResults(std::ostream& os, std::vector<BenchmarkResult> const& results) {
+    os << "[\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        BenchmarkResult const& r = results[i];
+        os << boost::format(
+                      "  {\"kernel\": \"%s\", \"imageType\": \"%s\", \"psfSigma\": %g, \"radius\": %g, "
+                      "\"iterations\": %d, \"seconds\": %.6g, \"sourcesPerSecond\": %.6g}%s\n") %
+                      r.kernel % r.imageType % r.psfSigma % r.radius % r.iterations % r.seconds %
+                      (r.iterations / r.seconds) % (i + 1 < results.size() ? "," : "");
+    }
+    os << "]\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    double const minSeconds = (argc > 2) ? std::stod(argv[2]) : 0.2;
+    std::vector<BenchmarkResult> results;
+    unsigned int seed = 1;
+    for (double psfSigma : {1.5, 2.5, 4.0}) {
+        int const size = 2 * static_cast<int>(std::ceil(std::max(8.0 * psfSigma, 35.0))) + 1;
+        auto sceneF = makeScene<float>(size, psfSigma, seed++);
+        auto sceneD = makeScene<double>(size, psfSigma, seed++);
+        benchmarkApertures(results, *sceneF.getImage(), "ImageF", psfSigma, minSeconds);
+        benchmarkApertures(results, sceneF, "MaskedImageF", psfSigma, minSeconds);
+        benchmarkApertures(results, *sceneD.getImage(), "ImageD", psfSigma, minSeconds);
+        benchmarkMoments(results, *sceneF.getImage(), "ImageF", psfSigma, minSeconds);
+        benchmarkMoments(results, sceneF, "MaskedImageF", psfSigma, minSeconds);
+        benchmarkMoments(results, *sceneD.getImage(), "ImageD", psfSigma, minSeconds);
+    }
+    if (argc > 1) {
+        std::ofstream os(argv[1]);
+        writeResults(os, results);
+    } else {
+        writeResults(std::cout, results);
+    }
+    return 0;
+}
@@ -0,0 +1,178 @@
+#!/usr/bin/env python
+#
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""Benchmark the single-frame measurement plugins on synthetic scenes.
+
+Scenes are simulated with `lsst.meas.base.tests.TestDataset` for every
+combination of source density, PSF size, aperture radii and source type, and
+measured with `SingleFrameMeasurementTask` with ``doTiming`` enabled.  The
+number of sources measured per second by each plugin is printed, and all
+results are written as JSON (one entry per plugin and scene, plus the host) for
+tracking between releases.
+"""
+
+import argparse
+import itertools
+import json
+import platform
+import time
+
+import numpy as np
+
+import lsst.geom
+import lsst.afw.geom
+import lsst.daf.base
+from lsst.meas.base import SingleFrameMeasurementTask
+from lsst.meas.base.tests import TestDataset
+
+PLUGINS = ("base_SdssCentroid", "base_SdssShape", "base_PsfFlux", "base_GaussianFlux",
+           "base_CircularApertureFlux", "base_PixelFlags", "base_Blendedness")
+
+SCENE_SIZE = 400
+DENSITIES = (25, 100, 400)
+PSF_SIGMAS = (1.5, 2.5, 4.0)
+APERTURE_RADII = ((3.0, 6.0, 12.0), (3.0, 4.5, 6.0, 9.0, 12.0, 17.0, 25.0, 35.0, 50.0))
+SOURCE_TYPES = ("point", "extended")
+
+
+def makeScene(nSources, psfSigma, sourceType, seed):
+    """Make a dataset of randomly placed sources.
+
+    Parameters
+    ----------
+    nSources : `int`
+        Number of sources in the scene.
+    psfSigma : `float`
+        Sigma of the Gaussian PSF, in pixels.
+    sourceType : `str`
+        ``"point"`` for unresolved sources, ``"extended"`` for elliptical
+        Gaussian galaxies.
+    seed : `int`
+        Seed for the source positions, fluxes and shapes.
+
+    Returns
+    -------
+    dataset : `lsst.meas.base.tests.TestDataset`
+        The simulated scene.
+    """
+    bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(SCENE_SIZE, SCENE_SIZE))
+    psfDim = 2*int(np.ceil(5*psfSigma)) + 1
+    dataset = TestDataset(bbox, psfSigma=psfSigma, psfDim=psfDim)
+    rng = np.random.RandomState(seed)
+    border = 5*psfSigma
+    instFluxes = []
+    centers = []
+    shapes = []
+    for _ in range(nSources):
+        centers.append(lsst.geom.Point2D(*rng.uniform(border, SCENE_SIZE - border, size=2)))
+        instFluxes.append(10**rng.uniform(4.0, 5.5))
+        shape = None
+        if sourceType == "extended":
+            r = rng.uniform(1.0, 3.0)
+            shape = lsst.afw.geom.Quadrupole(lsst.afw.geom.ellipses.Axes(
+                r, r*rng.uniform(0.4, 1.0), rng.uniform(0.0, np.pi)))
+        shapes.append(shape)
+    dataset.addSources(instFluxes, centers, shapes)
+    return dataset
+
+
+def makeTask(radii, doReplaceWithNoise):
+    """Make a measurement task running all the benchmarked plugins.
+    """
+    config = SingleFrameMeasurementTask.ConfigClass()
+    config.plugins.names = PLUGINS
+    config.plugins["base_CircularApertureFlux"].radii = list(radii)
+    config.slots.centroid = "base_SdssCentroid"
+    config.slots.shape = "base_SdssShape"
+    config.slots.psfShape = "base_SdssShape_psf"
+    config.slots.apFlux = None
+    config.slots.calibFlux = None
+    config.slots.modelFlux = None
+    config.doReplaceWithNoise = doReplaceWithNoise
+    config.doTiming = True
+    schema = TestDataset.makeMinimalSchema()
+    schema.setAliasMap(None)
+    return SingleFrameMeasurementTask(schema=schema, algMetadata=lsst.daf.base.PropertyList(), config=config)
+
+
+def benchmarkScene(nSources, psfSigma, radii, sourceType, doReplaceWithNoise, seed):
+    """Measure one scene, returning one result dict per plugin.
+    """
+    dataset = makeScene(nSources, psfSigma, sourceType, seed)
+    task = makeTask(radii, doReplaceWithNoise)
+    exposure, catalog = dataset.realize(10.0, task.schema, randomSeed=seed)
+    start = time.perf_counter()
+    task.run(catalog, exposure)
+    total = time.perf_counter() - start
+    metadata = task.algMetadata
+    scene = dict(nSources=len(catalog), psfSigma=psfSigma, nRadii=len(radii), maxRadius=max(radii),
+                 sourceType=sourceType, doReplaceWithNoise=doReplaceWithNoise, taskSeconds=total)
+    results = []
+    for name in PLUGINS:
+        prefix = "TIMING_%s_" % name
+        if not metadata.exists(prefix + "WALLTIME"):
+            continue
+        result = dict(scene, plugin=name,
+                      calls=metadata.getScalar(prefix + "CALLS"),
+                      failures=metadata.getScalar(prefix + "FAILURES"),
+                      seconds=metadata.getScalar(prefix + "WALLTIME"))
+        if metadata.exists(prefix + "CPPTIME"):
+            result["cppSeconds"] = metadata.getScalar(prefix + "CPPTIME")
+        result["sourcesPerSecond"] = result["calls"]/result["seconds"] if result["seconds"] > 0 else None
+        results.append(result)
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("output", nargs="?", default="benchmarkMeasurement.json",
+                        help="File to write the JSON results to")
+    parser.add_argument("--quick", action="store_true",
+                        help="Only run the lowest density and the first value of each other parameter")
+    parser.add_argument("--seed", type=int, default=1, help="Seed for the simulated scenes")
+    parser.add_argument("--no-noise-replacement", dest="doReplaceWithNoise", action="store_false",
+                        help="Measure without replacing neighbors with noise")
+    args = parser.parse_args()
+
+    densities = DENSITIES[:1] if args.quick else DENSITIES
+    psfSigmas = PSF_SIGMAS[:1] if args.quick else PSF_SIGMAS
+    radiiList = APERTURE_RADII[:1] if args.quick else APERTURE_RADII
+    sourceTypes = SOURCE_TYPES[:1] if args.quick else SOURCE_TYPES
+
+    results = []
+    for nSources, psfSigma, radii, sourceType in itertools.product(densities, psfSigmas, radiiList,
+                                                                    sourceTypes):
+        for result in benchmarkScene(nSources, psfSigma, radii, sourceType, args.doReplaceWithNoise,
+                                     args.seed):
+            print("%-28s n=%-4d psf=%-4.1f radii=%-2d %-9s %10.1f sources/s" %
+                  (result["plugin"], nSources, psfSigma, len(radii), sourceType,
+                   result["sourcesPerSecond"] or 0.0))
+            results.append(result)
+
+    with open(args.output, "w") as stream:
+        json.dump(dict(host=platform.node(), python=platform.python_version(), results=results),
+                  stream, indent=2)
+
+
+if __name__ == "__main__":
+    main()
@@ -41,7 +41,26 @@
 #include "lsst/meas/base/ApertureFlux.h"
 #include "lsst/meas/base/ScaledApertureFlux.h"
 #include "lsst/meas/base/CircularApertureFlux.h"
+#include "lsst/meas/base/EllipticalApertureFlux.h"
 #include "lsst/meas/base/Blendedness.h"
+#include "lsst/meas/base/Variance.h"
+#include "lsst/meas/base/FPPosition.h"
+#include "lsst/meas/base/Jacobian.h"
+#include "lsst/meas/base/LocalPhotoCalib.h"
+#include "lsst/meas/base/LocalWcs.h"
+#include "lsst/meas/base/PluginChain.h"
+#include "lsst/meas/base/ScratchArena.h"
+#include "lsst/meas/base/BinnedPyramid.h"
+#include "lsst/meas/base/FootprintTransformer.h"
+#include "lsst/meas/base/SpanKernels.h"
+#include "lsst/meas/base/ResultBuffer.h"
+#include "lsst/meas/base/TraceRecorder.h"
+#include "lsst/meas/base/ReferenceTransform.h"
+#include "lsst/meas/base/FluxKernelBackend.h"
+#include "lsst/meas/base/SpanIndex.h"
+#include "lsst/meas/base/SceneRealizer.h"
+#include "lsst/meas/base/Preconditions.h"
+#include "lsst/meas/base/SpatialOrder.h"
 
 // These are necessary to build Swig modules that %import meas/base/baseLib.i,
 // so it's neighborly to include them here so downstream code can just
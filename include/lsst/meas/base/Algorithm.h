@@ -24,6 +24,14 @@
 #ifndef LSST_MEAS_BASE_Algorithm_h_INCLUDED
 #define LSST_MEAS_BASE_Algorithm_h_INCLUDED
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "lsst/log/Log.h"
 
 #include "lsst/afw/table/fwd.h"
@@ -31,18 +39,129 @@
 #include "lsst/afw/image/Exposure.h"
 #include "lsst/meas/base/exceptions.h"
 #include "lsst/meas/base/FlagHandler.h"
+#include "lsst/meas/base/TraceRecorder.h"
 
 namespace lsst {
 namespace meas {
 namespace base {
 
+/**
+ *  Accumulated time spent inside an algorithm's measure methods, as recorded by
+ *  BaseAlgorithm::ScopedTimer.
+ *
+ *  The counters are atomic so that timed calls may be made concurrently from several threads.
+ */
+struct AlgorithmTiming {
+    std::atomic<std::int64_t> nanoseconds{0};  ///< total wall-clock time
+    std::atomic<std::uint64_t> calls{0};       ///< number of sources measured
+};
+
+/**
+ *  The outcome of a measurement, for algorithms that report routine failures without throwing.
+ *
+ *  Conditions such as a source being too close to the edge of the image or having no usable pixels
+ *  are common, and throwing (and, from Python, translating) a MeasurementError for each such source
+ *  can cost more than measuring it.  Algorithms may instead implement
+ *  SingleFrameAlgorithm::tryMeasure, returning a MeasurementStatus that identifies the flag that
+ *  would have been carried by the MeasurementError; the caller is then responsible for calling fail().
+ */
+class MeasurementStatus {
+public:
+    /// Construct a status indicating success.
+    MeasurementStatus() : _flag(nullptr) {}
+
+    /**
+     *  Construct a status indicating failure.
+     *
+     *  @param[in] flag    Flag to be set by fail(); must outlive the status (flag definitions are
+     *                     normally static class members).
+     *  @param[in] detail  Text appended to the flag's documentation to form the error message.
+     */
+    explicit MeasurementStatus(FlagDefinition const& flag, std::string const& detail = "")
+            : _flag(&flag), _detail(detail) {}
+
+    /// Return true if the measurement succeeded.
+    bool isSuccess() const { return !_flag; }
+
+    explicit operator bool() const { return isSuccess(); }
+
+    /// Return the number of the flag carried by a failure (undefined on success).
+    std::size_t getFlagNumber() const { return _flag ? _flag->number : FlagDefinition::number_undefined; }
+
+    /// Return the message a MeasurementError for this failure would carry.
+    std::string getMessage() const { return _flag ? _flag->doc + _detail : std::string(); }
+
+    /// Construct (without throwing) the MeasurementError equivalent to a failure.
+    MeasurementError makeError() const { return MeasurementError(getMessage(), getFlagNumber()); }
+
+    /// Throw the MeasurementError equivalent to a failure; do nothing on success.
+    void throwIfFailed() const {
+        if (_flag) {
+            throw LSST_EXCEPT(MeasurementError, getMessage(), getFlagNumber());
+        }
+    }
+
+private:
+    FlagDefinition const* _flag;
+    std::string _detail;
+};
+
 /**
  *  Ultimate abstract base class for all C++ measurement algorithms
  *
  *  New algorithms should not inherit directly from this class.
+ *
+ *  The measure and fail methods of all of meas_base's algorithms may be called concurrently from
+ *  several threads (with the GIL released, from Python) as long as each call is given a distinct
+ *  record and a distinct Psf: they are const, keep no per-call state in the algorithm, and share only
+ *  immutable state (keys, flag definitions, controls) or internally synchronized caches (SincCoeffs).
+ *  Distinct records of one catalog may be written concurrently, as their fields occupy distinct
+ *  memory.  The exposure pixels are only read, but no afw Psf (including CachingPsf and TiledPsf) is
+ *  safe to evaluate concurrently, since computeImage and computeKernelImage fill an unsynchronized
+ *  cache; each thread must measure on an exposure carrying its own Psf::clone().  Configuring an
+ *  algorithm (e.g. enableTiming) must not overlap with measuring.
  */
 class BaseAlgorithm {
 public:
+    /**
+     *  Scoped timer that adds the wall-clock time of its lifetime to an algorithm's timing counters.
+     *
+     *  When timing is disabled for the algorithm (the default) the timer does not read the clock,
+     *  so it costs no more than a pointer test.  It is used by the measurement framework to
+     *  separate the time spent inside measure() from the Python overhead of calling it.
+     */
+    class ScopedTimer {
+    public:
+        /**
+         *  Start timing.
+         *
+         *  @param[in] algorithm  Algorithm whose counters should be updated.
+         *  @param[in] nCalls     Number of sources measured in the timed scope.
+         */
+        explicit ScopedTimer(BaseAlgorithm const& algorithm, std::uint64_t nCalls = 1)
+                : _timing(algorithm._timing.get()), _nCalls(nCalls) {
+            if (_timing) {
+                _start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ScopedTimer(ScopedTimer const&) = delete;
+        ScopedTimer& operator=(ScopedTimer const&) = delete;
+
+        ~ScopedTimer() {
+            if (_timing) {
+                auto elapsed = std::chrono::steady_clock::now() - _start;
+                _timing->nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+                _timing->calls += _nCalls;
+            }
+        }
+
+    private:
+        AlgorithmTiming* _timing;
+        std::uint64_t _nCalls;
+        std::chrono::steady_clock::time_point _start;
+    };
+
     /**
      *  Handle an exception thrown by the current algorithm by setting flags in the given
      *  record.
@@ -65,8 +184,51 @@ public:
 
     std::string getLogName() const { return _logName; }
 
+    /**
+     *  Enable or disable recording of the time spent in timed measure calls.
+     *
+     *  Enabling timing resets the counters.  This must not be called while the algorithm is
+     *  measuring on another thread.
+     */
+    void enableTiming(bool enable) { _timing = enable ? std::make_shared<AlgorithmTiming>() : nullptr; }
+
+    /// Return whether timing is enabled.
+    bool isTimingEnabled() const { return static_cast<bool>(_timing); }
+
+    /// Return the total wall-clock time (in seconds) recorded since timing was enabled.
+    double getTimingSeconds() const { return _timing ? 1E-9 * _timing->nanoseconds : 0.0; }
+
+    /// Return the number of sources measured in timed calls since timing was enabled.
+    std::uint64_t getTimingCalls() const { return _timing ? _timing->calls.load() : 0; }
+
+    /**
+     *  Enable or disable tracing of the timed measure calls.
+     *
+     *  While a recorder is set, each timed measure call on a source whose family is sampled adds a
+     *  "cpp" event with the given name to it.  Pass a null recorder to disable tracing.  This must
+     *  not be called while the algorithm is measuring on another thread.
+     */
+    void enableTracing(std::shared_ptr<TraceRecorder> recorder, std::string const& name = "") {
+        _trace = recorder;
+        _traceName = name;
+    }
+
+    /// Return whether tracing is enabled.
+    bool isTracingEnabled() const { return static_cast<bool>(_trace); }
+
+    /// Return the recorder timed measure calls are traced to, or null.
+    TraceRecorder* getTraceRecorder() const { return _trace.get(); }
+
+    /// Return the name of the events recorded by timed measure calls.
+    std::string const& getTraceName() const { return _traceName; }
+
 protected:
     std::string _logName;
+
+private:
+    std::shared_ptr<AlgorithmTiming> _timing;
+    std::shared_ptr<TraceRecorder> _trace;
+    std::string _traceName;
 };
 
 /**
@@ -92,6 +254,19 @@ public:
     virtual void measure(afw::table::SourceRecord& measRecord,
                          afw::image::Exposure<float> const& exposure) const = 0;
 
+    /**
+     *  Measure a single source, returning routine failures instead of throwing them.
+     *
+     *  This is equivalent to measure(), except that an algorithm may report the failures it would
+     *  otherwise throw as MeasurementErrors through the returned status; the caller must then call
+     *  fail() with the equivalent MeasurementError (MeasurementStatus::makeError).  Other exceptions
+     *  may still be thrown.  It is used by measureBatch() and PluginChain.
+     *
+     *  The default implementation calls measure() and returns success.
+     */
+    virtual MeasurementStatus tryMeasure(afw::table::SourceRecord& measRecord,
+                                         afw::image::Exposure<float> const& exposure) const;
+
     /**
      *  Called to simultaneously measure all children in a deblend family, in a single image.
      *
@@ -104,6 +279,41 @@ public:
      */
     virtual void measureN(afw::table::SourceCatalog const& measCat,
                           afw::image::Exposure<float> const& exposure) const;
+
+    /**
+     *  Called to measure many sources independently, in a single call.
+     *
+     *  This is equivalent to calling measure() on each of the given records in turn, and
+     *  is used by the measurement framework to avoid the per-source overhead of calling
+     *  into C++ when neighbors do not need to be replaced with noise.
+     *
+     *  The default implementation does exactly that, handling exceptions the way the
+     *  framework does: failures are isolated to the record being measured and passed to
+     *  fail() (along with the MeasurementError, if that is what was thrown), while
+     *  FatalAlgorithmError and std::bad_alloc are propagated to the caller.  Exceptions other
+     *  than MeasurementError are logged as warnings, since they are not routine failures.
+     *
+     *  @param[in,out] measCat   Catalog containing the records to measure.
+     *  @param[in]     exposure  Image containing the pixel data to be measured.
+     *  @param[in]     indices   Indices of the records in measCat to measure, in order.
+     */
+    virtual void measureBatch(afw::table::SourceCatalog& measCat, afw::image::Exposure<float> const& exposure,
+                              std::vector<std::size_t> const& indices) const;
+
+protected:
+    /**
+     *  Measure the given records of a catalog in turn with a callable, handling failures as the default
+     *  measureBatch() does.
+     *
+     *  This lets subclasses that override measureBatch() to share per-call state between sources (e.g.
+     *  tables computed once for the whole image) keep the framework's failure handling.
+     *
+     *  @param[in,out] measCat     Catalog containing the records to measure.
+     *  @param[in]     indices     Indices of the records in measCat to measure, in order.
+     *  @param[in]     measureOne  Callable that measures a record like tryMeasure().
+     */
+    void measureEach(afw::table::SourceCatalog& measCat, std::vector<std::size_t> const& indices,
+                     std::function<MeasurementStatus(afw::table::SourceRecord&)> const& measureOne) const;
 };
 
 /**
@@ -139,6 +349,18 @@ public:
                                afw::table::SourceRecord const& refRecord,
                                afw::geom::SkyWcs const& refWcs) const = 0;
 
+    /**
+     *  Measure a single source, returning routine failures instead of throwing them.
+     *
+     *  This is to measureForced() as SingleFrameAlgorithm::tryMeasure is to
+     *  SingleFrameAlgorithm::measure.  The default implementation calls measureForced() and returns
+     *  success.
+     */
+    virtual MeasurementStatus tryMeasureForced(afw::table::SourceRecord& measRecord,
+                                               afw::image::Exposure<float> const& exposure,
+                                               afw::table::SourceRecord const& refRecord,
+                                               afw::geom::SkyWcs const& refWcs) const;
+
     /**
      *  Called to simultaneously measure all children in a deblend family, in a single image.
      *
@@ -176,6 +398,13 @@ public:
         measure(measRecord, exposure);
     }
 
+    virtual MeasurementStatus tryMeasureForced(afw::table::SourceRecord& measRecord,
+                                               afw::image::Exposure<float> const& exposure,
+                                               afw::table::SourceRecord const& refRecord,
+                                               afw::geom::SkyWcs const& refWcs) const {
+        return tryMeasure(measRecord, exposure);
+    }
+
     virtual void measureNForced(afw::table::SourceCatalog const& measCat,
                                 afw::image::Exposure<float> const& exposure,
                                 afw::table::SourceCatalog const& refRecord,
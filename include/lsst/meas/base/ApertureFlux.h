@@ -57,9 +57,30 @@ public:
             "Maximum radius (in pixels) for which the sinc algorithm should be used instead of the "
             "faster naive algorithm.  For elliptical apertures, this is the minor axis radius.");
 
+    LSST_CONTROL_FIELD(
+            maxExactRadius, double,
+            "Maximum radius (in pixels) for which apertures too large for the sinc algorithm are measured by "
+            "weighting each pixel by the exact area of its overlap with the aperture, instead of with the "
+            "naive algorithm.  For elliptical apertures, this is the minor axis radius.  Values no larger "
+            "than maxSincRadius disable exact-overlap photometry.");
+
     LSST_CONTROL_FIELD(
             shiftKernel, std::string,
             "Warping kernel used to shift Sinc photometry coefficients to different center positions");
+
+    LSST_CONTROL_FIELD(
+            shiftBankSize, int,
+            "If positive, circular Sinc photometry coefficients are shifted once onto a grid of this many "
+            "sub-pixel positions per axis and cached, instead of being warped for every source; source "
+            "centers are rounded to the nearest grid position (an error of at most 1/(2*shiftBankSize) "
+            "pixels).  Zero warps the coefficients to the exact center of every source.");
+
+    LSST_CONTROL_FIELD(
+            ellipticalCacheTolerance, double,
+            "If positive, cache Sinc photometry coefficients for elliptical apertures, quantizing the "
+            "logarithm of the major axis, the axis ratio and the position angle (in radians) in steps of "
+            "this size.  Measurements that use quantized coefficients are flagged with "
+            "flag_sincCoeffsApproximate.  Zero disables the cache.");
 };
 
 struct ApertureFluxResult;
@@ -81,10 +102,11 @@ class ApertureFluxAlgorithm : public SimpleAlgorithm {
 public:
     // Structures and routines to manage flaghandler
     static FlagDefinitionList const& getFlagDefinitions();
-    static unsigned int const N_FLAGS = 3;
+    static unsigned int const N_FLAGS = 4;
     static FlagDefinition const FAILURE;
     static FlagDefinition const APERTURE_TRUNCATED;
     static FlagDefinition const SINC_COEFFS_TRUNCATED;
+    static FlagDefinition const SINC_COEFFS_APPROXIMATE;
 
     typedef ApertureFluxControl Control;
 
@@ -133,12 +155,36 @@ public:
                                    Control const& ctrl = Control());
     //@}
 
+    //@{
+    /**  Compute the instFlux (and optionally, uncertanties) within an aperture by weighting each pixel
+     *   by the exact area of its overlap with the aperture.
+     *
+     *   Like the naive algorithm this needs no coefficient images, but it correctly handles sub-pixel
+     *   aperture boundaries (treating pixels as uniformly bright squares), so it remains accurate for
+     *   smaller apertures.  Only the pixels crossed by the boundary need their overlap computed; those
+     *   entirely within the aperture are summed directly.
+     *
+     *   @param[in]   image                 Image or MaskedImage to be measured.  If a MaskedImage is
+     *                                      provided, uncertainties will be returned as well as instFluxes.
+     *   @param[in]   ellipse               Ellipse that defines the outer boundary of the aperture.
+     */
+    template <typename T>
+    static Result computeExactFlux(afw::image::Image<T> const& image,
+                                   afw::geom::ellipses::Ellipse const& ellipse,
+                                   Control const& ctrl = Control());
+    template <typename T>
+    static Result computeExactFlux(afw::image::MaskedImage<T> const& image,
+                                   afw::geom::ellipses::Ellipse const& ellipse,
+                                   Control const& ctrl = Control());
+    //@}
+
     //@{
     /**  Compute the instFlux (and optionally, uncertanties) within an aperture using the algorithm
-     *   determined by its size and the maxSincRadius control parameter.
+     *   determined by its size and the maxSincRadius and maxExactRadius control parameters.
      *
      *   This method delegates to computeSincFlux is the minor axis of the aperture is smaller than
-     *   ctrl.maxSincRadius, and delegates to computeNaiveFlux otherwise.
+     *   ctrl.maxSincRadius, to computeExactFlux if it is otherwise no larger than ctrl.maxExactRadius,
+     *   and to computeNaiveFlux otherwise.
      *
      *   @param[in]   image                 Image or MaskedImage to be measured.  If a MaskedImage is
      *                                      provided, uncertainties will be returned as well as instFluxes.
@@ -154,6 +200,61 @@ public:
                               afw::geom::ellipses::Ellipse const& ellipse, Control const& ctrl = Control());
     //@}
 
+    //@{
+    /**  Compute the instFlux (and optionally, uncertainties) within all of the circular apertures
+     *   given by ctrl.radii.
+     *
+     *   This is equivalent to calling computeFlux once for each radius, but the naive apertures are
+     *   measured in a single pass over the pixels of the largest one (binning pixels by their distance
+     *   from the center), and the sinc apertures are evaluated against a single view of the union of
+     *   their coefficient images.  Exact-overlap apertures are measured individually.
+     *
+     *   @param[in]   image                 Image or MaskedImage to be measured.  If a MaskedImage is
+     *                                      provided, uncertainties will be returned as well as instFluxes.
+     *   @param[in]   center                Center of the apertures.
+     *   @param[in]   ctrl                  Control object.
+     *
+     *   @returns     One result per entry in ctrl.radii, in the same order.
+     */
+    template <typename T>
+    static std::vector<Result> computeFluxes(afw::image::Image<T> const& image, geom::Point2D const& center,
+                                             Control const& ctrl = Control());
+
+    template <typename T>
+    static std::vector<Result> computeFluxes(afw::image::MaskedImage<T> const& image,
+                                             geom::Point2D const& center, Control const& ctrl = Control());
+    //@}
+
+    //@{
+    /**  Compute the instFlux (and optionally, uncertainties) within all of the apertures obtained by
+     *   scaling an ellipse by the given factors.
+     *
+     *   This is the elliptical generalization of computeFluxes (ctrl.radii is ignored): apertures whose
+     *   minor axis is no larger than ctrl.maxSincRadius are measured with sinc photometry against a
+     *   single view of the image, those no larger than ctrl.maxExactRadius with exact pixel overlaps,
+     *   and the others in a single naive pass over the largest of them.
+     *
+     *   @param[in]   image                 Image or MaskedImage to be measured.  If a MaskedImage is
+     *                                      provided, uncertainties will be returned as well as instFluxes.
+     *   @param[in]   ellipse               Ellipse that is scaled to obtain the apertures.
+     *   @param[in]   scales                Factors by which the axes of the ellipse are scaled.
+     *   @param[in]   ctrl                  Control object.
+     *
+     *   @returns     One result per entry in scales, in the same order.
+     */
+    template <typename T>
+    static std::vector<Result> computeScaledFluxes(afw::image::Image<T> const& image,
+                                                   afw::geom::ellipses::Ellipse const& ellipse,
+                                                   std::vector<double> const& scales,
+                                                   Control const& ctrl = Control());
+
+    template <typename T>
+    static std::vector<Result> computeScaledFluxes(afw::image::MaskedImage<T> const& image,
+                                                   afw::geom::ellipses::Ellipse const& ellipse,
+                                                   std::vector<double> const& scales,
+                                                   Control const& ctrl = Control());
+    //@}
+
     /**
      *  Construct the algorithm and add its fields to the given Schema.
      */
@@ -203,7 +304,8 @@ private:
         FluxResultKey instFluxKey;
         FlagHandler flags;
 
-        Keys(afw::table::Schema& schema, std::string const& prefix, std::string const& doc, bool isSinc);
+        Keys(afw::table::Schema& schema, std::string const& prefix, std::string const& doc, bool isSinc,
+             bool isApproximate);
     };
 
     std::vector<Keys> _keys;
@@ -0,0 +1,91 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_BASE_BinnedPyramid_h_INCLUDED
+#define LSST_MEAS_BASE_BinnedPyramid_h_INCLUDED
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "lsst/afw/image/MaskedImage.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  Mean-binned copies of the image and variance planes of a MaskedImage, by powers of two in each
+ *  dimension, built on first use.
+ *
+ *  Pixel (i, j) of the level binned by (binX, binY) is the mean of the binX x binY pixels starting at
+ *  index (i*binX, j*binY) of the image (relative to its xy0), and its variance is the variance of that
+ *  mean; bins that would extend past the far edges of the image are dropped.  Each level is computed
+ *  from the next finer one, so binning the whole image at every level costs little more than binning
+ *  it once.  The mask is ignored.
+ *
+ *  The pyramid holds a shallow copy of the image, which shares its pixels and keeps them alive; they
+ *  must not be modified while it is in use.  It is not safe to use from several threads at once.
+ */
+class BinnedPyramid {
+public:
+    using MaskedImageT = afw::image::MaskedImage<float>;
+
+    /// One binned level of the pyramid, with pixels stored row-major.
+    struct Level {
+        int binX;
+        int binY;
+        int width;
+        int height;
+        std::vector<float> image;
+        std::vector<float> variance;
+    };
+
+    explicit BinnedPyramid(MaskedImageT const& mimage) : _mimage(mimage) {}
+
+    BinnedPyramid(BinnedPyramid const&) = delete;
+    BinnedPyramid& operator=(BinnedPyramid const&) = delete;
+
+    /**
+     *  Return the level binned by (binX, binY), computing it (and any finer levels it is computed from)
+     *  if this is its first use.
+     *
+     *  @throws pex::exceptions::InvalidParameterError if binX or binY is not a power of two, or both
+     *          are one.
+     */
+    Level const& getLevel(int binX, int binY);
+
+    /// Return the number of levels computed so far.
+    std::size_t getLevelCount() const { return _levels.size(); }
+
+private:
+    MaskedImageT const _mimage;
+    std::map<std::pair<int, int>, Level> _levels;
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_BinnedPyramid_h_INCLUDED
@@ -25,7 +25,12 @@
 #ifndef LSST_MEAS_BASE_Blendedness_h_INCLUDED
 #define LSST_MEAS_BASE_Blendedness_h_INCLUDED
 
+#include <memory>
+#include <vector>
+
 #include "lsst/pex/config.h"
+#include "lsst/geom/Box.h"
+#include "lsst/afw/geom/Span.h"
 #include "lsst/meas/base/Algorithm.h"
 #include "lsst/meas/base/ShapeUtilities.h"
 #include "lsst/afw/table/Source.h"
@@ -117,6 +122,38 @@ public:
     void measureParentPixels(afw::image::MaskedImage<float> const& image,
                              afw::table::SourceRecord& child) const;
 
+    struct ChildPixels;
+
+    /**
+     *  Capture the weighted pixels of a child from its noise-replaced image, instead of measuring them
+     *  with measureChildPixels.
+     *
+     *  The result is later passed to measureCapturedPixels, which measures both the child and the
+     *  parent moments in one pass.  Returns a null pointer if there is nothing to capture (because
+     *  neither flux nor shape is being measured, or the child has no usable centroid or shape); the
+     *  relevant flags are set on the child.
+     */
+    std::shared_ptr<ChildPixels> captureChildPixels(afw::image::MaskedImage<float> const& image,
+                                                    afw::table::SourceRecord& child) const;
+
+    /**
+     *  Measure all the child and parent quantities for a catalog of sources.
+     *
+     *  This is equivalent to calling measureChildPixels on the images the children were captured
+     *  from and then measureParentPixels on the given image, but the Gaussian weights are computed
+     *  only once for each source.  Null entries of childPixels are passed to measureParentPixels
+     *  alone.
+     *
+     *  @param[in] image        The image with all sources restored.
+     *  @param[in,out] catalog  The sources to measure.
+     *  @param[in] childPixels  The result of captureChildPixels for each record of the catalog.
+     *
+     *  @throws lsst::pex::exceptions::LengthError if childPixels and catalog differ in length.
+     */
+    void measureCapturedPixels(afw::image::MaskedImage<float> const& image,
+                               afw::table::SourceCatalog& catalog,
+                               std::vector<std::shared_ptr<ChildPixels const>> const& childPixels) const;
+
     virtual void measure(afw::table::SourceRecord& measRecord,
                          afw::image::Exposure<float> const& exposure) const {}
 
@@ -128,6 +165,14 @@ private:
                          afw::table::Key<double> const& instFluxAbsKey, ShapeResultKey const& _shapeRawKey,
                          ShapeResultKey const& _shapeAbsKey) const;
 
+    bool _checkInputs(afw::table::SourceRecord& child) const;
+
+    template <typename Accumulator>
+    void _measureCapturedMoments(ChildPixels const& childPixels, afw::image::MaskedImage<float> const& image,
+                                 afw::table::SourceRecord& child) const;
+
+    void _setBlendedness(afw::table::SourceRecord& child) const;
+
     Control const _ctrl;
     afw::table::Key<double> _old;
     afw::table::Key<double> _raw;
@@ -143,6 +188,24 @@ private:
     FlagHandler _flagHandler;
 };
 
+/**
+ *  The pixels within the weight function of a child, and their weights.
+ *
+ *  The spans cover the pixels within BlendednessControl::nSigmaWeightMax of the centroid, clipped to
+ *  the image the weights were computed for; the weights, image and variance vectors hold one value
+ *  for each of their pixels, in span order.  The image and variance vectors are only filled by
+ *  BlendednessAlgorithm::captureChildPixels.
+ */
+struct BlendednessAlgorithm::ChildPixels {
+    geom::Point2D centroid;              ///< Center of the weight function
+    geom::Box2I bbox;                    ///< Bounding box of the unclipped region
+    bool isClipped;                      ///< Whether the region was clipped to the image
+    std::vector<afw::geom::Span> spans;  ///< Pixels within the weight function
+    std::vector<float> weights;          ///< Gaussian weight of each pixel
+    std::vector<float> image;            ///< Image value of each pixel
+    std::vector<float> variance;         ///< Variance of each pixel
+};
+
 }  // namespace base
 }  // namespace meas
 }  // namespace lsst
@@ -0,0 +1,135 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2019 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_MEAS_BASE_CachingPsf_h_INCLUDED
+#define LSST_MEAS_BASE_CachingPsf_h_INCLUDED
+
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "lsst/geom/Box.h"
+#include "lsst/geom/Point.h"
+#include "lsst/afw/detection/Psf.h"
+#include "lsst/afw/geom/ellipses/Quadrupole.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  A Psf that memoizes the model products of another Psf at recently-used positions.
+ *
+ *  Most measurement plugins evaluate the PSF model at the centroid of the source being
+ *  measured (PsfFlux realizes the image, SdssCentroid needs the local kernel and shape,
+ *  ScaledApertureFlux and LocalBackground need the shape, ...).  For expensive models
+ *  (e.g. PSFEx or PCA) repeating that evaluation for every plugin dominates the cost.
+ *  The measurement framework therefore temporarily replaces the exposure's Psf with a
+ *  CachingPsf while it runs the plugins, so each product is computed once per position
+ *  and shared by all plugins without any change to their interfaces.
+ *
+ *  Realized and kernel images (and hence local kernels) are already cached by the Psf
+ *  base class; this class adds the same for shapes, bounding boxes and aperture fluxes,
+ *  which the base class recomputes on every call.  Those are cached for the most recent
+ *  `capacity` distinct positions only; products evaluated with a determinate color are
+ *  never cached.  Quantities plugins derive from the images, such as PsfFlux's effective
+ *  area, are not cached and are recomputed by each plugin.
+ */
+class CachingPsf : public afw::detection::Psf {
+public:
+    /**
+     *  Construct a cache around the given Psf.
+     *
+     *  @param[in] psf       Psf model to evaluate, must not be null.
+     *  @param[in] capacity  Number of distinct positions whose products are retained; must be > 0.
+     */
+    explicit CachingPsf(std::shared_ptr<afw::detection::Psf const> psf, std::size_t capacity = 8);
+
+    /// Return the Psf whose products are being cached.
+    std::shared_ptr<afw::detection::Psf const> getWrapped() const { return _psf; }
+
+    /// Return the number of distinct positions retained.
+    std::size_t getCapacity() const { return _capacity; }
+
+    /// Discard all cached products.
+    void clearCache();
+
+    //@{
+    /// Number of model products served from the cache, and evaluated by the wrapped Psf
+    std::size_t getHitCount() const;
+    std::size_t getMissCount() const;
+    //@}
+
+    std::shared_ptr<afw::detection::Psf> clone() const override;
+
+    std::shared_ptr<afw::detection::Psf> resized(int width, int height) const override;
+
+    geom::Point2D getAveragePosition() const override;
+
+protected:
+    std::shared_ptr<Image> doComputeImage(geom::Point2D const& position,
+                                          afw::image::Color const& color) const override;
+
+    std::shared_ptr<Image> doComputeKernelImage(geom::Point2D const& position,
+                                                afw::image::Color const& color) const override;
+
+    double doComputeApertureFlux(double radius, geom::Point2D const& position,
+                                 afw::image::Color const& color) const override;
+
+    afw::geom::ellipses::Quadrupole doComputeShape(geom::Point2D const& position,
+                                                   afw::image::Color const& color) const override;
+
+    geom::Box2I doComputeBBox(geom::Point2D const& position, afw::image::Color const& color) const override;
+
+private:
+    struct Entry {
+        explicit Entry(geom::Point2D const& position_)
+                : position(position_), hasShape(false), hasBBox(false) {}
+
+        geom::Point2D position;
+        bool hasShape;
+        afw::geom::ellipses::Quadrupole shape;
+        bool hasBBox;
+        geom::Box2I bbox;
+        std::map<double, double> apertureFlux;
+    };
+
+    // Return the entry for the given position, creating it (and evicting the oldest) if necessary.
+    // Must be called with _mutex held.
+    Entry& _getEntry(geom::Point2D const& position) const;
+
+    std::shared_ptr<afw::detection::Psf const> _psf;
+    std::size_t _capacity;
+    mutable std::mutex _mutex;
+    mutable std::deque<Entry> _entries;  // most recently created at the back
+    mutable std::size_t _hits;
+    mutable std::size_t _misses;
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_CachingPsf_h_INCLUDED
@@ -29,6 +29,7 @@
 #include "lsst/afw/geom/SkyWcs.h"
 #include "lsst/afw/image/PhotoCalib.h"
 #include "lsst/afw/table/aggregates.h"
+#include "lsst/afw/table/Source.h"
 #include "lsst/meas/base/Transform.h"
 
 namespace lsst {
@@ -149,6 +150,9 @@ public:
     /// Return a Key for the y coordinate
     afw::table::Key<CentroidElement> getY() const { return _centroid.getY(); }
 
+    /// Return the centroids of all records of a catalog, read from its column view if it is contiguous
+    std::vector<Centroid> extractCentroids(afw::table::SourceCatalog const& catalog) const;
+
 private:
     afw::table::PointKey<CentroidElement> _centroid;
     afw::table::CovarianceMatrixKey<ErrElement, 2> _centroidErr;
@@ -51,6 +51,18 @@ public:
      *  @param[in]     exposure    Image to be measured.
      */
     virtual void measure(afw::table::SourceRecord& record, afw::image::Exposure<float> const& exposure) const;
+
+    /**
+     *  Measure the configured apertures on many sources of one image.
+     *
+     *  This is equivalent to calling measure() on each record in turn, but the image is looked up
+     *  once for the whole batch.
+     */
+    virtual void measureBatch(afw::table::SourceCatalog& measCat, afw::image::Exposure<float> const& exposure,
+                              std::vector<std::size_t> const& indices) const;
+
+private:
+    void _measure(afw::table::SourceRecord& measRecord, afw::image::MaskedImage<float> const& image) const;
 };
 
 }  // namespace base
@@ -0,0 +1,91 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2019 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_MEAS_BASE_CounterBasedNoise_h_INCLUDED
+#define LSST_MEAS_BASE_CounterBasedNoise_h_INCLUDED
+
+#include <cstdint>
+
+#include "lsst/afw/geom/SpanSet.h"
+#include "lsst/afw/image/Image.h"
+#include "lsst/afw/table/BaseRecord.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  Gaussian noise that is a pure function of (seed, footprint ID, pixel position).
+ *
+ *  Each deviate is computed from a Philox4x32-10 counter-based random number generator, with the
+ *  seed as the key and the footprint ID and pixel coordinates as the counter, followed by a
+ *  Box-Muller transform.  No generator state is carried from one deviate to the next, so the noise
+ *  for a footprint can be regenerated whenever it is needed instead of being stored, and the values
+ *  do not depend on the order in which footprints or pixels are visited, or on how many threads
+ *  visit them.  The seed is the only state and cannot be changed after construction, so a single
+ *  instance can generate the noise for any number of threads.
+ */
+class CounterBasedNoise {
+public:
+    /// Construct from the seed (e.g. exposure ID times the noise seed multiplier).
+    explicit CounterBasedNoise(std::uint64_t seed) : _seed(seed) {}
+
+    /// Return the seed.
+    std::uint64_t getSeed() const { return _seed; }
+
+    /// Return the unit-variance, zero-mean Gaussian deviate for pixel (x, y) of the given footprint.
+    double getDeviate(afw::table::RecordId id, int x, int y) const;
+
+    /**
+     *  Set the pixels of an image within a SpanSet to Gaussian noise with constant mean and width.
+     *
+     *  @param[in]     id     ID of the footprint whose noise is generated.
+     *  @param[in]     spans  Pixels to set, in parent coordinates; must lie within the image.
+     *  @param[in,out] image  Image to modify.
+     *  @param[in]     mean   Mean of the noise.
+     *  @param[in]     std    Standard deviation of the noise.
+     */
+    void fillImage(afw::table::RecordId id, afw::geom::SpanSet const& spans, afw::image::Image<float>& image,
+                   double mean, double std) const;
+
+    /**
+     *  Set the pixels of an image within a SpanSet to Gaussian noise with a variance given per pixel.
+     *
+     *  @param[in]     id        ID of the footprint whose noise is generated.
+     *  @param[in]     spans     Pixels to set, in parent coordinates; must lie within both images.
+     *  @param[in,out] image     Image to modify.
+     *  @param[in]     variance  Variance of the noise in each pixel.
+     *  @param[in]     mean      Mean of the noise.
+     */
+    void fillImage(afw::table::RecordId id, afw::geom::SpanSet const& spans, afw::image::Image<float>& image,
+                   afw::image::Image<float> const& variance, double mean) const;
+
+private:
+    std::uint64_t _seed;
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_CounterBasedNoise_h_INCLUDED
@@ -0,0 +1,164 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2019 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_BASE_EllipticalApertureFlux_h_INCLUDED
+#define LSST_MEAS_BASE_EllipticalApertureFlux_h_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include "lsst/pex/config.h"
+#include "lsst/afw/image/Exposure.h"
+#include "lsst/meas/base/Algorithm.h"
+#include "lsst/meas/base/ApertureFlux.h"
+#include "lsst/meas/base/FluxUtilities.h"
+#include "lsst/meas/base/FlagHandler.h"
+#include "lsst/meas/base/InputUtilities.h"
+#include "lsst/meas/base/Transform.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  Configuration object for EllipticalApertureFluxAlgorithm
+ */
+class EllipticalApertureFluxControl {
+public:
+    LSST_CONTROL_FIELD(scales, std::vector<double>,
+                       "Factors by which the axes of the source ellipse are scaled to make the apertures.");
+
+    LSST_CONTROL_FIELD(useKronRadius, bool,
+                       "Scale the apertures by the Kron radius instead of the Shape slot ellipse: the "
+                       "source ellipse is then the Shape slot ellipse enlarged to the first moment of the "
+                       "light profile within kronMaxScale times that ellipse.");
+
+    LSST_CONTROL_FIELD(kronMaxScale, double,
+                       "Size (in units of the Shape slot ellipse) of the aperture within which the Kron "
+                       "radius is computed.");
+
+    LSST_CONTROL_FIELD(
+            maxSincRadius, double,
+            "Maximum minor axis radius (in pixels) for which the sinc algorithm should be used instead of "
+            "the faster naive algorithm.");
+
+    LSST_CONTROL_FIELD(
+            shiftKernel, std::string,
+            "Warping kernel used to shift Sinc photometry coefficients to different center positions");
+
+    LSST_CONTROL_FIELD(
+            ellipticalCacheTolerance, double,
+            "If positive, cache Sinc photometry coefficients, quantizing the logarithm of the major axis, "
+            "the axis ratio and the position angle (in radians) in steps of this size.  Measurements "
+            "that use quantized coefficients are flagged with flag_sincCoeffsApproximate.  Zero computes "
+            "the coefficients of every aperture exactly.");
+
+    EllipticalApertureFluxControl()
+            : scales({1.0, 2.0, 2.5, 3.0}),
+              useKronRadius(false),
+              kronMaxScale(6.0),
+              maxSincRadius(10.0),
+              shiftKernel("lanczos5"),
+              ellipticalCacheTolerance(0.01) {}
+};
+
+/**
+ *  Measure the instFlux in a set of elliptical apertures matched to the shape of each source.
+ *
+ *  The apertures are the Shape slot ellipse (or, if useKronRadius is set, that ellipse enlarged to the
+ *  Kron radius) scaled by each of the configured factors, centered on the Centroid slot.  They are
+ *  measured together by ApertureFluxAlgorithm::computeScaledFluxes, and results are saved in fields
+ *  prefixed by ApertureFluxAlgorithm::makeFieldPrefix(name, scale), with the same flags as
+ *  CircularApertureFlux.
+ */
+class EllipticalApertureFluxAlgorithm : public SimpleAlgorithm {
+public:
+    static FlagDefinitionList const& getFlagDefinitions();
+    static FlagDefinition const FAILURE;
+    static FlagDefinition const BAD_KRON_RADIUS;
+
+    typedef EllipticalApertureFluxControl Control;
+    typedef ApertureFluxResult Result;
+
+    EllipticalApertureFluxAlgorithm(Control const& ctrl, std::string const& name,
+                                    afw::table::Schema& schema);
+
+    /**
+     *  Compute the Kron radius of a source.
+     *
+     *  @param[in]  image     Image to be measured.
+     *  @param[in]  ellipse   Ellipse defining the shape of the source; pixels within maxScale times this
+     *                        ellipse are used.
+     *  @param[in]  maxScale  Size of the region used, in units of the ellipse.
+     *
+     *  @returns the first moment of the light profile, in units of the ellipse: the mean over pixels,
+     *  weighted by their values, of their radius in the metric of the ellipse.  This is NaN if the sum
+     *  of the pixel values is not positive.
+     */
+    template <typename T>
+    static double computeKronScale(afw::image::Image<T> const& image,
+                                   afw::geom::ellipses::Ellipse const& ellipse, double maxScale);
+
+    virtual void measure(afw::table::SourceRecord& measRecord,
+                         afw::image::Exposure<float> const& exposure) const override;
+
+    virtual void fail(afw::table::SourceRecord& measRecord, MeasurementError* error = nullptr) const override;
+
+private:
+    Control _ctrl;
+    ApertureFluxControl _apCtrl;
+    FlagHandler _flagHandler;
+    afw::table::Key<float> _kronRadiusKey;
+    std::vector<FluxResultKey> _instFluxKeys;
+    std::vector<FlagHandler> _apertureFlagHandlers;
+    SafeCentroidExtractor _centroidExtractor;
+    SafeShapeExtractor _shapeExtractor;
+};
+
+/**
+ *  Measurement transformation for elliptical aperture fluxes
+ *
+ *  Transforms the instFlux in each aperture to a magnitude, and propagates flags.
+ */
+class EllipticalApertureFluxTransform : public BaseTransform {
+public:
+    typedef EllipticalApertureFluxControl Control;
+
+    EllipticalApertureFluxTransform(Control const& ctrl, std::string const& name,
+                                    afw::table::SchemaMapper& mapper);
+
+    virtual void operator()(afw::table::SourceCatalog const& inputCatalog,
+                            afw::table::BaseCatalog& outputCatalog, afw::geom::SkyWcs const& wcs,
+                            afw::image::PhotoCalib const& photoCalib) const;
+
+private:
+    std::vector<FluxResultKey> _instFluxKeys;
+    std::vector<MagResultKey> _magKeys;
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_EllipticalApertureFlux_h_INCLUDED
@@ -0,0 +1,80 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_BASE_FPPosition_h_INCLUDED
+#define LSST_MEAS_BASE_FPPosition_h_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include "lsst/pex/config.h"
+#include "lsst/afw/image/Exposure.h"
+#include "lsst/afw/table/aggregates.h"
+#include "lsst/meas/base/Algorithm.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/// Configuration of FPPositionAlgorithm, which has no parameters
+class FPPositionControl {
+public:
+    FPPositionControl() {}
+};
+
+/**
+ *  @brief A measurement algorithm that records the position of the centroid of each source on the
+ *         focal plane.
+ *
+ *  If the exposure has no Detector, the position is NaN and the missingDetector flag is set.
+ *  measureBatch transforms all of the centroids to the focal plane in one call.
+ */
+class FPPositionAlgorithm : public SimpleAlgorithm {
+public:
+    typedef FPPositionControl Control;
+
+    FPPositionAlgorithm(Control const& ctrl, std::string const& name, afw::table::Schema& schema);
+
+    virtual void measure(afw::table::SourceRecord& measRecord,
+                         afw::image::Exposure<float> const& exposure) const;
+
+    /**
+     *  Measure a batch of records, transforming all of their centroids at once.
+     */
+    virtual void measureBatch(afw::table::SourceCatalog& measCat, afw::image::Exposure<float> const& exposure,
+                              std::vector<std::size_t> const& indices) const;
+
+    virtual void fail(afw::table::SourceRecord& measRecord, MeasurementError* error = nullptr) const;
+
+private:
+    afw::table::Point2DKey _focalKey;
+    afw::table::Key<afw::table::Flag> _failKey;
+    afw::table::Key<afw::table::Flag> _missingDetectorKey;
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_FPPosition_h_INCLUDED
@@ -23,6 +23,8 @@
 #ifndef LSST_MEAS_BASE_FlagHandler_h_INCLUDED
 #define LSST_MEAS_BASE_FlagHandler_h_INCLUDED
 
+#include <array>
+#include <cstdint>
 #include <vector>
 
 #include "lsst/afw/table/Schema.h"
@@ -56,6 +58,10 @@ struct FlagDefinition {
 
 /**
  *  @brief vector-type utility class to build a collection of FlagDefinitions
+ *
+ *  Lists are populated by add() during static initialization (or an algorithm's constructor), and are
+ *  only read once measurement starts; reading a list from several threads at once is safe, but adding
+ *  to it while it is read is not.
  */
 class FlagDefinitionList {
 public:
@@ -125,7 +131,7 @@ public:
     std::size_t size() const { return _vector.size(); }
 
 private:
-    mutable std::vector<FlagDefinition> _vector;
+    std::vector<FlagDefinition> _vector;
 };
 
 /**
@@ -278,12 +284,27 @@ public:
         }
         throw FatalAlgorithmError("No FlagHandler entry for " + flagName);
     }
+    /**
+     *  Return the key of the flag field corresponding to the given flag index.
+     *
+     *  The key is invalid if the flag was excluded from the schema.
+     */
+    afw::table::Key<afw::table::Flag> getFlagKey(std::size_t i) const {
+        if (i < _vector.size()) {
+            return _vector[i].second;
+        }
+        throw FatalAlgorithmError("No legal FlagHandler entry number " + std::to_string(i));
+    }
     /**
      *  Get the index of the General Failure flag, if one is defined.  This flag is defined
      *  by most algorithms, and if defined, is set whenever an error is caught by the FlagHandler.
      *  If no General Failure flag is defined, this routine will return FlagDefinition::number_undefined
      */
     std::size_t getFailureFlagNumber() const { return failureFlagNumber; }
+    /**
+     *  Return the number of flags, including any that were excluded from the schema.
+     */
+    std::size_t size() const { return _vector.size(); }
     /**
      *  Handle an expected or unexpected Exception thrown by a measurement algorithm.
      *
@@ -301,6 +322,149 @@ private:
     Vector _vector;
 };
 
+/**
+ *  A FlagHandler for algorithms whose flags are known at compile time.
+ *
+ *  The flags set while measuring a source are accumulated in a StaticFlagHandler::Flags bitset on the
+ *  stack, and committed to the record with commit(), which writes each of the record's flag words once.
+ *  The mapping from flag number to the bit of the word that stores it is resolved when the handler is
+ *  constructed, so no schema names are looked up while measuring.
+ *
+ *  The wrapped FlagHandler (see getFlagHandler()) is used for everything else, e.g. to pass to the
+ *  centroid and shape extractors.
+ *
+ *  @tparam N  Maximum number of flags (the size of the FlagDefinitionList); at most 64.
+ */
+template <std::size_t N>
+class StaticFlagHandler {
+public:
+    static_assert(N > 0 && N <= 64, "StaticFlagHandler supports between 1 and 64 flags");
+
+    /// A set of flags, indexed by their FlagDefinition number.
+    class Flags {
+    public:
+        Flags() : _bits(0) {}
+
+        void set(std::size_t i) { _bits |= (std::uint64_t(1) << i); }
+        void set(FlagDefinition const& flag) { set(flag.number); }
+
+        bool test(std::size_t i) const { return _bits & (std::uint64_t(1) << i); }
+        bool test(FlagDefinition const& flag) const { return test(flag.number); }
+
+        /// Return true if any flag is set.
+        bool any() const { return _bits != 0; }
+
+        std::uint64_t getBits() const { return _bits; }
+
+    private:
+        std::uint64_t _bits;
+    };
+
+    /// Default constructor for delayed initialization; see FlagHandler::FlagHandler().
+    StaticFlagHandler() : _validMask(0), _nWords(0) {}
+
+    /// Add flag fields to a schema; see FlagHandler::addFields.
+    static StaticFlagHandler addFields(
+            afw::table::Schema& schema, std::string const& prefix, FlagDefinitionList const& flagDefs,
+            FlagDefinitionList const& exclDefs = FlagDefinitionList::getEmptyList()) {
+        return StaticFlagHandler(FlagHandler::addFields(schema, prefix, flagDefs, exclDefs), flagDefs.size());
+    }
+
+    /// Manage flag fields already added to a schema; see FlagHandler::FlagHandler(SubSchema...).
+    StaticFlagHandler(afw::table::SubSchema const& s, FlagDefinitionList const& flagDefs,
+                      FlagDefinitionList const& exclDefs = FlagDefinitionList::getEmptyList())
+            : StaticFlagHandler(FlagHandler(s, flagDefs, exclDefs), flagDefs.size()) {}
+
+    /// Return the dynamic FlagHandler managing the same fields.
+    FlagHandler const& getFlagHandler() const { return _handler; }
+
+    std::size_t getFailureFlagNumber() const { return _handler.getFailureFlagNumber(); }
+
+    /**
+     *  Set all the flags in a bitset on a record.
+     *
+     *  Flags that are not set in the bitset are left unchanged, as are flags that were excluded from
+     *  the schema.
+     */
+    void commit(afw::table::BaseRecord& record, Flags const& flags) const {
+        std::uint64_t const bits = flags.getBits() & _validMask;
+        if (!bits) return;
+        for (std::size_t w = 0; w < _nWords; ++w) {
+            Word const& word = _words[w];
+            std::uint64_t const local = bits & word.mask;
+            if (!local) continue;
+            std::uint64_t value = 0;
+            if (word.shift >= 0) {
+                value = local << word.shift;
+            } else if (word.shift > -64) {
+                value = local >> -word.shift;
+            } else {
+                for (std::size_t i = 0; i < N; ++i) {
+                    if (local & (std::uint64_t(1) << i)) value |= std::uint64_t(1) << _bits[i];
+                }
+            }
+            *record.getElement(word.storage) |= static_cast<Element>(value);
+        }
+    }
+
+    bool getValue(afw::table::BaseRecord const& record, std::size_t i) const {
+        return _handler.getValue(record, i);
+    }
+
+    void setValue(afw::table::BaseRecord& record, std::size_t i, bool value) const {
+        _handler.setValue(record, i, value);
+    }
+
+    /// Handle a failure as in FlagHandler::handleFailure.
+    void handleFailure(afw::table::BaseRecord& record, MeasurementError const* error = nullptr) const {
+        _handler.handleFailure(record, error);
+    }
+
+private:
+    typedef afw::table::FieldBase<afw::table::Flag>::Element Element;
+
+    // One integer field of the record that holds some of our flags.
+    struct Word {
+        afw::table::Key<Element> storage;
+        std::uint64_t mask;  // flag numbers stored in this word
+        int shift;           // (bit - number) if the same for all flags in the word, else -64
+    };
+
+    StaticFlagHandler(FlagHandler const& handler, std::size_t nFlags)
+            : _handler(handler), _validMask(0), _nWords(0) {
+        if (nFlags > N) {
+            throw LSST_EXCEPT(FatalAlgorithmError,
+                              "StaticFlagHandler<" + std::to_string(N) + "> cannot hold " +
+                                      std::to_string(nFlags) + " flags");
+        }
+        _bits.fill(0);
+        for (std::size_t i = 0; i < nFlags; ++i) {
+            afw::table::Key<afw::table::Flag> const key = _handler.getFlagKey(i);
+            if (!key.isValid()) continue;
+            _bits[i] = key.getBit();
+            _validMask |= std::uint64_t(1) << i;
+            int const shift = static_cast<int>(key.getBit()) - static_cast<int>(i);
+            std::size_t w = 0;
+            while (w < _nWords && _words[w].storage.getOffset() != key.getStorage().getOffset()) ++w;
+            if (w == _nWords) {
+                _words[w].storage = key.getStorage();
+                _words[w].mask = 0;
+                _words[w].shift = shift;
+                ++_nWords;
+            } else if (_words[w].shift != shift) {
+                _words[w].shift = -64;
+            }
+            _words[w].mask |= std::uint64_t(1) << i;
+        }
+    }
+
+    FlagHandler _handler;
+    std::uint64_t _validMask;
+    std::array<std::size_t, N> _bits;
+    std::array<Word, N> _words;
+    std::size_t _nWords;
+};
+
 }  // namespace base
 }  // namespace meas
 }  // namespace lsst
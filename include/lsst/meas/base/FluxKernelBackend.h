@@ -0,0 +1,135 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_BASE_FluxKernelBackend_h_INCLUDED
+#define LSST_MEAS_BASE_FluxKernelBackend_h_INCLUDED
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lsst/geom/Box.h"
+#include "lsst/afw/detection/Psf.h"
+#include "lsst/afw/image/MaskedImage.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/// A model image and the box (contained in both the model and the data) over which it is fit.
+struct ModelStamp {
+    std::shared_ptr<afw::detection::Psf::Image const> model;
+    geom::Box2I bbox;
+};
+
+/// Sums of products of a model, the data and the variance over the unmasked pixels of a box.
+struct ModelFitSums {
+    ModelFitSums()
+            : modelSum(0.0),
+              modelNorm(0.0),
+              modelSquared(0.0),
+              modelData(0.0),
+              modelSquaredVariance(0.0),
+              area(0) {}
+
+    double modelSum;              ///< sum(model)
+    double modelNorm;             ///< sum(model^2)
+    double modelSquared;          ///< sum(weight*model^2)
+    double modelData;             ///< sum(weight*model*data)
+    double modelSquaredVariance;  ///< sum(weight^2*model^2*variance)
+    std::size_t area;             ///< number of pixels added
+};
+
+/// Pixel weighting for model fits that gives every pixel the same weight.
+struct UnitWeight {
+    double operator()(float) const { return 1.0; }
+};
+
+/// Pixel weighting for model fits that weights each pixel by its inverse variance.
+struct InverseVarianceWeight {
+    double operator()(float variance) const { return 1.0 / variance; }
+};
+
+/**
+ *  Accumulate the sums of one model over the pixels of bbox not masked by badBits, on the CPU.
+ *
+ *  The weight is the inverse variance if useWeights, and one otherwise.  bbox must be contained in the
+ *  bounding boxes of both the model and the image.
+ */
+ModelFitSums accumulateModelFit(afw::detection::Psf::Image const& model,
+                                afw::image::MaskedImage<float> const& image, geom::Box2I const& bbox,
+                                afw::image::MaskPixel badBits, bool useWeights);
+
+/**
+ *  An implementation of the dense per-source kernels of the flux algorithms, applied to a whole batch
+ *  of sources at once.
+ *
+ *  The batch entry points of the algorithms (e.g. PsfFluxAlgorithm::measureBatch) gather the stamps of
+ *  all the sources they can measure, hand them to the default backend in a single call, and measure the
+ *  remaining (flagged) sources one at a time on the CPU.  A backend for an accelerator can thus upload
+ *  the image planes once per batch and process all the stamps in a few launches; it may be registered
+ *  with setDefault() from another package, without changes to the algorithms.
+ *
+ *  Backends must be safe to call from several threads at once.
+ */
+class FluxKernelBackend {
+public:
+    /// Return a short name for the backend, for logging and diagnostics.
+    virtual std::string getName() const = 0;
+
+    /**
+     *  Accumulate the sums of each of a batch of models, as accumulateModelFit does.
+     *
+     *  @returns one ModelFitSums for each stamp, in order.
+     */
+    virtual std::vector<ModelFitSums> accumulateModelFits(std::vector<ModelStamp> const& stamps,
+                                                          afw::image::MaskedImage<float> const& image,
+                                                          afw::image::MaskPixel badBits,
+                                                          bool useWeights) const = 0;
+
+    /// Return the backend used by the batch entry points of the algorithms.
+    static std::shared_ptr<FluxKernelBackend const> getDefault();
+
+    /// Set the backend used by the batch entry points of the algorithms; null restores the CPU backend.
+    static void setDefault(std::shared_ptr<FluxKernelBackend const> backend);
+
+    virtual ~FluxKernelBackend() = default;
+};
+
+/// The reference backend, which runs the kernels one stamp at a time on the calling thread.
+class CpuFluxKernelBackend : public FluxKernelBackend {
+public:
+    std::string getName() const override { return "cpu"; }
+
+    std::vector<ModelFitSums> accumulateModelFits(std::vector<ModelStamp> const& stamps,
+                                                  afw::image::MaskedImage<float> const& image,
+                                                  afw::image::MaskPixel badBits,
+                                                  bool useWeights) const override;
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_FluxKernelBackend_h_INCLUDED
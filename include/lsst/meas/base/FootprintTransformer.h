@@ -0,0 +1,130 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_BASE_FootprintTransformer_h_INCLUDED
+#define LSST_MEAS_BASE_FootprintTransformer_h_INCLUDED
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "lsst/geom/AffineTransform.h"
+#include "lsst/geom/Box.h"
+#include "lsst/afw/detection/Footprint.h"
+#include "lsst/afw/geom/SkyWcs.h"
+#include "lsst/afw/geom/SpanSet.h"
+#include "lsst/afw/geom/Transform.h"
+#include "lsst/afw/table/Source.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  Transform the footprints of many reference sources from one WCS's pixel coordinates to another's.
+ *
+ *  afw::detection::Footprint::transform composes the two WCSs into a new mapping on every call and
+ *  evaluates it at every pixel of the transformed footprint.  A FootprintTransformer composes them
+ *  once, and if constructed with a positive tile size approximates the composed mapping by its local
+ *  affine transform at the center of each tileSize x tileSize tile of the source pixel grid.  The
+ *  affine approximation is used for a footprint only if it differs from the exact mapping by at most
+ *  maxError pixels at the corners of the footprint's bounding box (all corners of all footprints are
+ *  checked in a single evaluation of the mapping); otherwise, or with a tile size of zero, the exact
+ *  mapping is used, with results identical to those of Footprint::transform.  Peaks are always
+ *  transformed with the exact mapping.
+ *
+ *  As with Footprint::transform, heavy footprints are transformed to regular ones, and results are
+ *  clipped to the given region.  The affine approximations are cached, so a transformer may not be used
+ *  by several threads at once.
+ */
+class FootprintTransformer {
+public:
+    /**
+     *  Construct a transformer.
+     *
+     *  @param[in] source    WCS of the footprints to transform.
+     *  @param[in] target    WCS of the pixel grid to transform them to.
+     *  @param[in] region    Region of the target pixel grid to clip the results to.
+     *  @param[in] tileSize  Size (source pixels) of the tiles over which the mapping is approximated by
+     *                       an affine transform; zero to always use the exact mapping.
+     *  @param[in] maxError  Maximum error (target pixels) allowed of the affine approximation.
+     */
+    FootprintTransformer(afw::geom::SkyWcs const& source, afw::geom::SkyWcs const& target,
+                         geom::Box2I const& region, int tileSize = 0, double maxError = 0.01);
+
+    /// Transform a single footprint.
+    std::shared_ptr<afw::detection::Footprint> transform(afw::detection::Footprint const& footprint);
+
+    /**
+     *  Transform the footprints of all the records of a catalog.
+     *
+     *  @throws pex::exceptions::InvalidParameterError if a record has no footprint.
+     */
+    std::vector<std::shared_ptr<afw::detection::Footprint>> transformFootprints(
+            afw::table::SourceCatalog const& refCat);
+
+    /**
+     *  Transform only the spans of the footprints of all the records of a catalog, for callers that have
+     *  no need of peaks or Footprint objects.
+     *
+     *  @throws pex::exceptions::InvalidParameterError if a record has no footprint.
+     */
+    std::vector<std::shared_ptr<afw::geom::SpanSet>> transformSpans(
+            afw::table::SourceCatalog const& refCat);
+
+    /**
+     *  Attach the transformed footprint of each record of refCat to the corresponding record of
+     *  measCat.
+     *
+     *  @throws pex::exceptions::LengthError if the catalogs differ in length.
+     *  @throws pex::exceptions::InvalidParameterError if a record of refCat has no footprint.
+     */
+    void attachFootprints(afw::table::SourceCatalog& measCat, afw::table::SourceCatalog const& refCat);
+
+    /// Return the number of footprints transformed with the affine approximation so far.
+    std::size_t getApproximatedCount() const { return _approximated; }
+
+private:
+    // Return the affine approximation appropriate for each of the given footprints (or nullptr where
+    // the exact mapping must be used).
+    std::vector<geom::AffineTransform const*> _selectApproximations(
+            std::vector<afw::detection::Footprint const*> const& footprints);
+
+    std::shared_ptr<afw::geom::SpanSet> _transformSpans(afw::geom::SpanSet const& spans,
+                                                        geom::AffineTransform const* affine) const;
+
+    std::shared_ptr<afw::geom::TransformPoint2ToPoint2> _transform;
+    geom::Box2I _region;
+    int _tileSize;
+    double _maxError;
+    std::map<std::pair<int, int>, geom::AffineTransform> _tiles;
+    std::size_t _approximated;
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_FootprintTransformer_h_INCLUDED
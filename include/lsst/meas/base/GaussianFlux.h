@@ -24,6 +24,8 @@
 #ifndef LSST_MEAS_BASE_GaussianFlux_h_INCLUDED
 #define LSST_MEAS_BASE_GaussianFlux_h_INCLUDED
 
+#include <vector>
+
 #include "lsst/pex/config.h"
 #include "lsst/afw/image/Exposure.h"
 #include "lsst/meas/base/Algorithm.h"
@@ -43,13 +45,17 @@ namespace base {
 class GaussianFluxControl {
 public:
     LSST_CONTROL_FIELD(background, double, "FIXME! NEVER DOCUMENTED!");
+    LSST_CONTROL_FIELD(doReuseWeightedSum, bool,
+                       "Reuse the weighted sum recorded by the shape slot's SdssShape, if any?  Must be "
+                       "false if this instance measures a different image than SdssShape, as the "
+                       "undeblended instance of single-frame measurement does");
 
     /**
      *  @brief Default constructor
      *
      *  All control classes should define a default constructor that sets all fields to their default values.
      */
-    GaussianFluxControl() : background(0.0) {}
+    GaussianFluxControl() : background(0.0), doReuseWeightedSum(true) {}
 };
 
 /**
@@ -58,6 +64,11 @@ public:
  *  This algorithm computes instFlux as the dot product of an elliptical Gaussian weight function
  *  with the image.  The size and ellipticity of the weight function are determined using the
  *  SdssShape algorithm, or retreived from a named field.
+ *
+ *  When the shape slot is SdssShape run with doRecordWeightedSum and doReuseWeightedSum is set, the
+ *  weighted sum SdssShape computed with its final weight function is used instead of summing the pixels
+ *  again, for sources whose centroid is the one SdssShape was run at; the results are the same either way,
+ *  provided both measure the same image.
  */
 class GaussianFluxAlgorithm : public SimpleAlgorithm {
 public:
@@ -82,6 +93,10 @@ private:
     FlagHandler _flagHandler;
     SafeCentroidExtractor _centroidExtractor;
     SafeShapeExtractor _shapeExtractor;
+    // Fields recorded by the shape slot's SdssShape when doRecordWeightedSum is set; invalid otherwise.
+    afw::table::Key<double> _weightedSumKey;
+    afw::table::PointKey<double> _weightedSumCenterKey;
+    afw::table::QuadrupoleKey _weightedSumShapeKey;
 };
 
 class GaussianFluxTransform : public FluxTransform {
@@ -91,6 +106,84 @@ public:
             : FluxTransform{name, mapper} {}
 };
 
+/**
+ *  @brief A C++ control class to handle MultiScaleGaussianFluxAlgorithm's configuration
+ */
+class MultiScaleGaussianFluxControl {
+public:
+    LSST_CONTROL_FIELD(scales, std::vector<double>,
+                       "Factors by which the semi-axes of the shape are multiplied to form each Gaussian "
+                       "weight function");
+
+    /**
+     *  @brief Default constructor
+     *
+     *  All control classes should define a default constructor that sets all fields to their default values.
+     */
+    MultiScaleGaussianFluxControl() : scales{0.5, 1.0, 2.0, 4.0} {}
+};
+
+/**
+ *  @brief A measurement algorithm that estimates instFlux using elliptical Gaussian weights of several sizes.
+ *
+ *  This is equivalent to running GaussianFluxAlgorithm once for each scale with the shape scaled by that
+ *  factor, but all the fluxes are computed in a single pass over the pixels by
+ *  SdssShapeAlgorithm::computeFixedMomentsFluxes.  The results for each scale are saved in fields
+ *  prefixed by makeFieldPrefix(name, scale).
+ */
+class MultiScaleGaussianFluxAlgorithm : public SimpleAlgorithm {
+public:
+    // Structures and routines to manage flaghandler
+    static FlagDefinitionList const& getFlagDefinitions();
+    static FlagDefinition const FAILURE;
+
+    typedef MultiScaleGaussianFluxControl Control;
+
+    /**
+     *  @throws pex::exceptions::InvalidParameterError if two scales have the same field name prefix.
+     */
+    MultiScaleGaussianFluxAlgorithm(Control const& ctrl, std::string const& name, afw::table::Schema& schema);
+
+    /// Return the field name prefix used for the instFlux measured at the given scale (to one decimal place).
+    static std::string makeFieldPrefix(std::string const& name, double scale);
+
+    virtual void measure(afw::table::SourceRecord& measRecord,
+                         afw::image::Exposure<float> const& exposure) const;
+
+    virtual void fail(afw::table::SourceRecord& measRecord, MeasurementError* error = nullptr) const;
+
+private:
+    Control _ctrl;
+    std::vector<FluxResultKey> _instFluxResultKeys;
+    FlagHandler _flagHandler;
+    SafeCentroidExtractor _centroidExtractor;
+    SafeShapeExtractor _shapeExtractor;
+};
+
+class MultiScaleGaussianFluxTransform : public BaseTransform {
+public:
+    typedef MultiScaleGaussianFluxControl Control;
+    MultiScaleGaussianFluxTransform(Control const& ctrl, std::string const& name,
+                                    afw::table::SchemaMapper& mapper);
+
+    /*
+     * @brief Perform transformation from inputCatalog to outputCatalog.
+     *
+     * @param[in]     inputCatalog   Source of data to be transformed
+     * @param[in,out] outputCatalog  Container for transformed results
+     * @param[in]     wcs            World coordinate system under which transformation will take place
+     * @param[in]     photoCalib     Photometric calibration under which transformation will take place
+     * @throws        LengthError    Catalog sizes do not match
+     */
+    virtual void operator()(afw::table::SourceCatalog const& inputCatalog,
+                            afw::table::BaseCatalog& outputCatalog, afw::geom::SkyWcs const& wcs,
+                            afw::image::PhotoCalib const& photoCalib) const;
+
+private:
+    std::vector<MagResultKey> _magKeys;
+    Control _ctrl;
+};
+
 }  // namespace base
 }  // namespace meas
 }  // namespace lsst
@@ -24,8 +24,11 @@
 #ifndef LSST_MEAS_BASE_InputUtilities_h_INCLUDED
 #define LSST_MEAS_BASE_InputUtilities_h_INCLUDED
 
+#include "ndarray.h"
+
 #include "lsst/geom/Point.h"
 #include "lsst/afw/geom/ellipses/Quadrupole.h"
+#include "lsst/afw/table/Source.h"
 #include "lsst/meas/base/FlagHandler.h"
 
 namespace lsst {
@@ -78,6 +81,58 @@ public:
      */
     geom::Point2D operator()(afw::table::SourceRecord& record, FlagHandler const& flags) const;
 
+    /// A position extracted from a record.
+    struct Result {
+        geom::Point2D position;
+        bool usedPeak;  ///< Whether the position is that of the Footprint's Peak, not the Centroid slot
+    };
+
+    /**
+     *  A SafeCentroidExtractor bound to the Centroid slot of one table.
+     *
+     *  The slot keys are resolved and validated once, when the extractor is bound, instead of for
+     *  every record.  A Bound must not outlive the extractor it was obtained from, and must not be used
+     *  after the table's slots are redefined.
+     */
+    class Bound {
+    public:
+        /// Extract a position, as SafeCentroidExtractor::operator() does.
+        Result extract(afw::table::SourceRecord& record, FlagHandler const& flags) const;
+
+        geom::Point2D operator()(afw::table::SourceRecord& record, FlagHandler const& flags) const {
+            return extract(record, flags).position;
+        }
+
+    private:
+        friend class SafeCentroidExtractor;
+
+        Bound(SafeCentroidExtractor const& parent, afw::table::SourceTable const& table);
+
+        SafeCentroidExtractor const* _parent;
+        afw::table::CentroidSlotDefinition::MeasKey _measKey;
+        afw::table::Key<afw::table::Flag> _flagKey;
+    };
+
+    /**
+     *  Bind the extractor to the slots of a table.
+     *
+     *  Throws FatalAlgorithmError if the Centroid slot is not defined and this is not a centroider.
+     */
+    Bound bind(afw::table::SourceTable const& table) const { return Bound(*this, table); }
+
+    /**
+     *  Extract the positions of all the records in a catalog.
+     *
+     *  @param[in,out] catalog  Catalog to extract from; flags are set on its records as by operator().
+     *  @param[in]     flags    FlagHandler of the calling algorithm.
+     *
+     *  @returns an array of shape (catalog.size(), 2) holding (x, y) in each row.  Rows for records
+     *  from which operator() would throw a (non-fatal) exception are NaN; call operator() on those
+     *  records to obtain the error.
+     */
+    ndarray::Array<double, 2, 2> extractAll(afw::table::SourceCatalog& catalog,
+                                            FlagHandler const& flags) const;
+
 private:
     std::string _name;
     bool _isCentroider;
@@ -121,10 +176,48 @@ public:
     afw::geom::ellipses::Quadrupole operator()(afw::table::SourceRecord& record,
                                                FlagHandler const& flags) const;
 
+    /**
+     *  A SafeShapeExtractor bound to the Shape slot of one table.
+     *
+     *  See SafeCentroidExtractor::Bound.
+     */
+    class Bound {
+    public:
+        afw::geom::ellipses::Quadrupole operator()(afw::table::SourceRecord& record,
+                                                   FlagHandler const& flags) const;
+
+    private:
+        friend class SafeShapeExtractor;
+
+        Bound(SafeShapeExtractor const& parent, afw::table::SourceTable const& table);
+
+        SafeShapeExtractor const* _parent;
+        afw::table::ShapeSlotDefinition::MeasKey _measKey;
+        afw::table::Key<afw::table::Flag> _flagKey;
+    };
+
+    /**
+     *  Bind the extractor to the slots of a table.
+     *
+     *  Throws FatalAlgorithmError if the Shape slot is not defined.
+     */
+    Bound bind(afw::table::SourceTable const& table) const { return Bound(*this, table); }
+
 private:
     std::string _name;
 };
 
+/**
+ *  Return the number of pixels in the Footprint of each record of a catalog.
+ *
+ *  Records without a Footprint are given an area of zero.
+ *
+ *  @param[in]  catalog  Catalog whose Footprints are to be measured.
+ *
+ *  @returns an array of length catalog.size().
+ */
+ndarray::Array<int, 1, 1> extractFootprintAreas(afw::table::SourceCatalog const& catalog);
+
 }  // namespace base
 }  // namespace meas
 }  // namespace lsst
@@ -0,0 +1,83 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_BASE_Jacobian_h_INCLUDED
+#define LSST_MEAS_BASE_Jacobian_h_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include "lsst/pex/config.h"
+#include "lsst/afw/image/Exposure.h"
+#include "lsst/meas/base/Algorithm.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/// Configuration of JacobianAlgorithm
+class JacobianControl {
+public:
+    LSST_CONTROL_FIELD(pixelScale, double, "Nominal pixel size (arcsec)");
+
+    JacobianControl() : pixelScale(0.5) {}
+};
+
+/**
+ *  @brief A measurement algorithm that computes the ratio of the area of the pixel at the centroid of
+ *         each source with that of a nominal pixel.
+ *
+ *  This enables one to compare relative, rather than absolute, pixel areas.  The pixel areas are found
+ *  from the local, linear approximation of the WCS (see LocalWcsAlgorithm::computeLocalMatrices), which
+ *  measureBatch evaluates at all sources in one call.
+ */
+class JacobianAlgorithm : public SimpleAlgorithm {
+public:
+    typedef JacobianControl Control;
+
+    JacobianAlgorithm(Control const& ctrl, std::string const& name, afw::table::Schema& schema);
+
+    virtual void measure(afw::table::SourceRecord& measRecord,
+                         afw::image::Exposure<float> const& exposure) const;
+
+    /**
+     *  Measure a batch of records, evaluating the WCS at all of their centroids at once.
+     */
+    virtual void measureBatch(afw::table::SourceCatalog& measCat, afw::image::Exposure<float> const& exposure,
+                              std::vector<std::size_t> const& indices) const;
+
+    virtual void fail(afw::table::SourceRecord& measRecord, MeasurementError* error = nullptr) const;
+
+private:
+    Control _ctrl;
+    double _scale;  // one over the area of a nominal pixel, in 1/arcsec^2
+    afw::table::Key<double> _valueKey;
+    afw::table::Key<afw::table::Flag> _failKey;
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_Jacobian_h_INCLUDED
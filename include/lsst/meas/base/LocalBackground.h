@@ -25,7 +25,6 @@
 #define LSST_MEAS_BASE_LocalBackground_h_INCLUDED
 
 #include "lsst/pex/config.h"
-#include "lsst/afw/math/Statistics.h"
 #include "lsst/meas/base/Algorithm.h"
 #include "lsst/meas/base/FluxUtilities.h"
 #include "lsst/meas/base/FlagHandler.h"
@@ -77,6 +76,10 @@ public:
     virtual void measure(afw::table::SourceRecord& measRecord,
                          afw::image::Exposure<float> const& exposure) const;
 
+    /// Measure a single source, returning (instead of throwing) the routine failures of measure().
+    virtual MeasurementStatus tryMeasure(afw::table::SourceRecord& measRecord,
+                                         afw::image::Exposure<float> const& exposure) const;
+
     virtual void fail(afw::table::SourceRecord& measRecord, MeasurementError* error = nullptr) const;
 
 private:
@@ -84,7 +87,6 @@ private:
     FluxResultKey _resultKey;
     FlagHandler _flagHandler;
     SafeCentroidExtractor _centroidExtractor;
-    afw::math::StatisticsControl _stats;
 };
 
 class LocalBackgroundTransform : public FluxTransform {
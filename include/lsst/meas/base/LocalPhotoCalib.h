@@ -0,0 +1,79 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_BASE_LocalPhotoCalib_h_INCLUDED
+#define LSST_MEAS_BASE_LocalPhotoCalib_h_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include "lsst/pex/config.h"
+#include "lsst/afw/image/Exposure.h"
+#include "lsst/meas/base/Algorithm.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/// Configuration of LocalPhotoCalibAlgorithm, which has no parameters
+class LocalPhotoCalibControl {
+public:
+    LocalPhotoCalibControl() {}
+};
+
+/**
+ *  @brief A measurement algorithm that records the local value of the photometric calibration at the
+ *         centroid of each source.
+ *
+ *  The calibration factor is recorded in the field named for the algorithm itself, and its error in
+ *  that name with "Err" appended.
+ */
+class LocalPhotoCalibAlgorithm : public SimpleAlgorithm {
+public:
+    typedef LocalPhotoCalibControl Control;
+
+    LocalPhotoCalibAlgorithm(Control const& ctrl, std::string const& name, afw::table::Schema& schema);
+
+    virtual void measure(afw::table::SourceRecord& measRecord,
+                         afw::image::Exposure<float> const& exposure) const;
+
+    /**
+     *  Measure a batch of records, looking up the calibration and its error only once for all of them.
+     */
+    virtual void measureBatch(afw::table::SourceCatalog& measCat, afw::image::Exposure<float> const& exposure,
+                              std::vector<std::size_t> const& indices) const;
+
+    virtual void fail(afw::table::SourceRecord& measRecord, MeasurementError* error = nullptr) const;
+
+private:
+    afw::table::Key<double> _calibKey;
+    afw::table::Key<double> _calibErrKey;
+    afw::table::Key<afw::table::Flag> _failKey;
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_LocalPhotoCalib_h_INCLUDED
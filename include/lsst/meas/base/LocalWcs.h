@@ -0,0 +1,99 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_BASE_LocalWcs_h_INCLUDED
+#define LSST_MEAS_BASE_LocalWcs_h_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include "ndarray.h"
+
+#include "lsst/pex/config.h"
+#include "lsst/geom/Point.h"
+#include "lsst/afw/geom/SkyWcs.h"
+#include "lsst/afw/image/Exposure.h"
+#include "lsst/meas/base/Algorithm.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/// Configuration of LocalWcsAlgorithm, which has no parameters
+class LocalWcsControl {
+public:
+    LocalWcsControl() {}
+};
+
+/**
+ *  @brief A measurement algorithm that records the local, linear approximation of the WCS at the
+ *         centroid of each source.
+ *
+ *  The CD matrix elements are in radians per pixel, with the first axis increasing to the East, as for
+ *  a gnomonic WCS centered on the source.  measureBatch evaluates the WCS at all sources in one call.
+ */
+class LocalWcsAlgorithm : public SimpleAlgorithm {
+public:
+    typedef LocalWcsControl Control;
+
+    LocalWcsAlgorithm(Control const& ctrl, std::string const& name, afw::table::Schema& schema);
+
+    /**
+     *  Compute the local, linear approximation of a WCS at each of a number of points.
+     *
+     *  The WCS is evaluated at all points (and their neighbours) in a single call.
+     *
+     *  @param[in] wcs     WCS to approximate.
+     *  @param[in] points  Pixel positions at which to evaluate it.
+     *
+     *  @returns an array of shape (points.size(), 2, 2) holding the CD matrix at each point, in
+     *  radians per pixel.  Rows for non-finite points are NaN.
+     */
+    static ndarray::Array<double, 3, 3> computeLocalMatrices(afw::geom::SkyWcs const& wcs,
+                                                            std::vector<geom::Point2D> const& points);
+
+    virtual void measure(afw::table::SourceRecord& measRecord,
+                         afw::image::Exposure<float> const& exposure) const;
+
+    /**
+     *  Measure a batch of records, evaluating the WCS at all of their centroids at once.
+     */
+    virtual void measureBatch(afw::table::SourceCatalog& measCat, afw::image::Exposure<float> const& exposure,
+                              std::vector<std::size_t> const& indices) const;
+
+    virtual void fail(afw::table::SourceRecord& measRecord, MeasurementError* error = nullptr) const;
+
+private:
+    afw::table::Key<double> _cdMatrix11Key;
+    afw::table::Key<double> _cdMatrix12Key;
+    afw::table::Key<double> _cdMatrix21Key;
+    afw::table::Key<double> _cdMatrix22Key;
+    afw::table::Key<afw::table::Flag> _failKey;
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_LocalWcs_h_INCLUDED
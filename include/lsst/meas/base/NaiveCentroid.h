@@ -79,9 +79,23 @@ public:
     virtual void measure(afw::table::SourceRecord& measRecord,
                          afw::image::Exposure<float> const& exposure) const;
 
+    /// Measure a single source, returning (instead of throwing) the routine failures of measure().
+    virtual MeasurementStatus tryMeasure(afw::table::SourceRecord& measRecord,
+                                         afw::image::Exposure<float> const& exposure) const;
+
+    /**
+     *  Measure many sources of one image; equivalent to calling measure() on each record in turn,
+     *  but the image is looked up once for the whole batch.
+     */
+    virtual void measureBatch(afw::table::SourceCatalog& measCat, afw::image::Exposure<float> const& exposure,
+                              std::vector<std::size_t> const& indices) const;
+
     virtual void fail(afw::table::SourceRecord& measRecord, MeasurementError* error = nullptr) const;
 
 private:
+    MeasurementStatus _measure(afw::table::SourceRecord& measRecord,
+                               afw::image::Image<float> const& image) const;
+
     Control _ctrl;
     CentroidResultKey _centroidKey;
     FlagHandler _flagHandler;
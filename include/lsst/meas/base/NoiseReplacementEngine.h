@@ -0,0 +1,136 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2019 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_MEAS_BASE_NoiseReplacementEngine_h_INCLUDED
+#define LSST_MEAS_BASE_NoiseReplacementEngine_h_INCLUDED
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+
+#include "lsst/geom/Box.h"
+#include "lsst/afw/detection/Footprint.h"
+#include "lsst/afw/image/Exposure.h"
+#include "lsst/afw/table/BaseRecord.h"
+#include "lsst/meas/base/CounterBasedNoise.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  Build per-source scratch images with neighbors replaced by noise, leaving the input exposure untouched.
+ *
+ *  This implements the same replacement scheme as the Python NoiseReplacer (all top-level footprints
+ *  are replaced by noise, then the footprint of the source being measured, or of its nearest ancestor
+ *  with a HeavyFootprint, is put back), but instead of mutating the full exposure it materializes
+ *  a deep copy of only the region around one source: the source footprint's bounding box, grown by
+ *  a border and clipped to the exposure.  If requested, the THISDET and OTHERDET mask planes are set in
+ *  the scratch image only, so they must already be registered in the mask plane dictionary.
+ *
+ *  The noise used for each top-level footprint is generated by CounterBasedNoise, keyed by that
+ *  footprint's ID, so a neighbor's pixels receive the same noise no matter which source is being
+ *  measured or in which order sources are processed, and only the pixels actually copied are generated.
+ *  Because the input exposure is never written, scratch images for different sources can be made
+ *  concurrently from several threads.
+ */
+class NoiseReplacementEngine {
+public:
+    /// Map from source ID to (parent ID, footprint); parent is 0 for top-level sources.
+    typedef std::map<afw::table::RecordId,
+                     std::pair<afw::table::RecordId, std::shared_ptr<afw::detection::Footprint>>>
+            FootprintMap;
+
+    /**
+     *  Construct from an exposure and the footprints of all the sources to be measured on it.
+     *
+     *  @param[in] exposure          Exposure being measured; never modified.
+     *  @param[in] footprints        Footprints of all sources, keyed by source ID.
+     *  @param[in] noiseMean         Mean of the replacement noise.
+     *  @param[in] noiseStd          Standard deviation of the replacement noise; ignored if
+     *                               useVariancePlane is set.
+     *  @param[in] useVariancePlane  Use the exposure's variance plane for the per-pixel noise level.
+     *  @param[in] seed              Seed for the replacement noise.
+     *  @param[in] border            Number of pixels by which the scratch bounding box extends the
+     *                               source footprint's bounding box.
+     *  @param[in] noiseImage        If not null, use the pixels of this image (which must contain the
+     *                               exposure's bounding box) as the replacement noise instead of
+     *                               generating it.
+     *  @param[in] detectionMasks    Set the THISDET and OTHERDET mask planes in the scratch images;
+     *                               if false, those planes need not exist.
+     */
+    NoiseReplacementEngine(std::shared_ptr<afw::image::Exposure<float> const> exposure,
+                           FootprintMap const& footprints, double noiseMean, double noiseStd,
+                           bool useVariancePlane, std::uint64_t seed, int border,
+                           std::shared_ptr<afw::image::Image<float> const> noiseImage = nullptr,
+                           bool detectionMasks = true);
+
+    /// Return the region of the exposure copied into the scratch image for the given source.
+    geom::Box2I computeScratchBBox(afw::table::RecordId id) const;
+
+    /**
+     *  Return a deep copy of the region around the given source with all other top-level
+     *  footprints replaced by noise and, if enabled, the THISDET/OTHERDET mask planes set.
+     *
+     *  For a child source this contains the deblended pixels of the child, for a parent the
+     *  original pixels of the full family.
+     */
+    std::shared_ptr<afw::image::Exposure<float>> makeScratch(afw::table::RecordId id) const;
+
+    /// Return the exposure the scratch images are made from.
+    std::shared_ptr<afw::image::Exposure<float> const> getExposure() const { return _exposure; }
+
+    /// Return the border added around each source footprint.
+    int getBorder() const { return _border; }
+
+private:
+    typedef FootprintMap::value_type Item;
+
+    // Return the item for the given ID, throwing NotFoundError if there is none.
+    Item const& _getItem(afw::table::RecordId id) const;
+
+    // Return the item whose pixels are inserted for the given source: the source itself, or
+    // its nearest ancestor that has a HeavyFootprint, or the top-level parent.
+    Item const& _getInserted(afw::table::RecordId id) const;
+
+    // Set the pixels of image within spans to the replacement noise of the given top-level footprint.
+    void _fillNoise(Item const& parent, afw::geom::SpanSet const& spans,
+                    afw::image::Image<float>& image) const;
+
+    std::shared_ptr<afw::image::Exposure<float> const> _exposure;
+    FootprintMap _footprints;
+    double _noiseMean;
+    double _noiseStd;
+    bool _useVariancePlane;
+    CounterBasedNoise _noise;
+    int _border;
+    std::shared_ptr<afw::image::Image<float> const> _noiseImage;
+    bool _detectionMasks;
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_NoiseReplacementEngine_h_INCLUDED
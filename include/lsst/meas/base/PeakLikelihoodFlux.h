@@ -85,11 +85,15 @@ public:
 
     virtual void fail(afw::table::SourceRecord& measRecord, MeasurementError* error = nullptr) const;
 
+    /// Tabulated weights of the warping kernel; an implementation detail.
+    class ShiftTable;
+
 private:
     Control _ctrl;
     FluxResultKey _instFluxResultKey;
     FlagHandler _flagHandler;
     SafeCentroidExtractor _centroidExtractor;
+    std::shared_ptr<ShiftTable const> _shiftTable;
 };
 
 class PeakLikelihoodFluxTransform : public FluxTransform {
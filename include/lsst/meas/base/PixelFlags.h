@@ -28,6 +28,7 @@
  *  @file lsst/meas/base/PixelFlags.h
  *  This is the algorithm for PixelFlags
  */
+#include <utility>
 #include <vector>
 
 #include "lsst/pex/config.h"
@@ -72,11 +73,32 @@ public:
     virtual void measure(afw::table::SourceRecord& measRecord,
                          afw::image::Exposure<float> const& exposure) const;
 
+    /**
+     *  Measure a batch of records, looking up the mask planes' bitmasks only once for all of them.
+     */
+    virtual void measureBatch(afw::table::SourceCatalog& measCat, afw::image::Exposure<float> const& exposure,
+                              std::vector<std::size_t> const& indices) const;
+
     virtual void fail(afw::table::SourceRecord& measRecord, MeasurementError* error = nullptr) const;
 
     typedef std::map<std::string, afw::table::Key<afw::table::Flag>> KeyMap;
 
 private:
+    typedef std::vector<std::pair<afw::image::MaskPixel, afw::table::Key<afw::table::Flag>>> BitKeyList;
+
+    // Bitmasks of the mask planes that set each flag
+    struct MaskBits {
+        afw::image::MaskPixel noData;
+        BitKeyList anywhere;
+        BitKeyList center;
+    };
+
+    // Look up the bitmasks of all configured mask planes; throws FatalAlgorithmError if one is unknown.
+    MaskBits _getMaskBits() const;
+
+    void _measure(afw::table::SourceRecord& measRecord, afw::image::Exposure<float> const& exposure,
+                  MaskBits const& bits) const;
+
     Control _ctrl;
     KeyMap _centerKeys;
     KeyMap _anyKeys;
@@ -0,0 +1,176 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_BASE_PluginChain_h_INCLUDED
+#define LSST_MEAS_BASE_PluginChain_h_INCLUDED
+
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "lsst/meas/base/Algorithm.h"
+#include "lsst/meas/base/Preconditions.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  An ordered sequence of C++ algorithms that are run on each source with a single call.
+ *
+ *  The measurement framework calls each plugin on each source from Python, so the cost of crossing
+ *  into C++ is paid once per plugin per source.  When several consecutive plugins are simply wrapped
+ *  C++ algorithms, it instead assembles them into a PluginChain, and pays that cost once per source
+ *  for the whole chain.
+ *
+ *  Exceptions are handled as the framework does for individual plugins: a MeasurementError is passed
+ *  to the fail() method of the algorithm that threw it, any other std::exception results in a call to
+ *  fail() without an error, and FatalAlgorithmError and std::bad_alloc are propagated to the caller.
+ *
+ *  A chain contains either single-frame or forced algorithms, according to which of addSingleFrame and
+ *  addForced is first used to extend it; algorithms must be added in order of increasing execution order.
+ *
+ *  Algorithms may be given Preconditions, which are evaluated at most once per source for the whole
+ *  chain; an algorithm whose conditions do not hold is failed instead of being run.
+ */
+class PluginChain {
+public:
+    PluginChain() = default;
+
+    /**
+     *  Append a single-frame algorithm to the chain.
+     *
+     *  @param[in] algorithm       Algorithm to run.
+     *  @param[in] executionOrder  Execution order of the plugin wrapping the algorithm; must not be less
+     *                             than that of the last algorithm in the chain.
+     *
+     *  @throws pex::exceptions::LogicError if the chain already contains forced algorithms, or if the
+     *          execution order is out of sequence.
+     */
+    void addSingleFrame(std::shared_ptr<SingleFrameAlgorithm const> algorithm, double executionOrder);
+
+    /**
+     *  Append a forced algorithm to the chain.
+     *
+     *  @param[in] algorithm       Algorithm to run.
+     *  @param[in] executionOrder  Execution order of the plugin wrapping the algorithm; must not be less
+     *                             than that of the last algorithm in the chain.
+     *
+     *  @throws pex::exceptions::LogicError if the chain already contains single-frame algorithms, or if
+     *          the execution order is out of sequence.
+     */
+    void addForced(std::shared_ptr<ForcedAlgorithm const> algorithm, double executionOrder);
+
+    /**
+     *  Set the conditions a source must satisfy for an algorithm in the chain to be run on it.
+     *
+     *  @param[in] index          Position of the algorithm in the chain.
+     *  @param[in] preconditions  Conditions to check; if one does not hold, the algorithm's fail()
+     *                            method is called instead.
+     *
+     *  @throws pex::exceptions::OutOfRangeError if index >= size().
+     */
+    void setPreconditions(std::size_t index, Preconditions const& preconditions);
+
+    /**
+     *  Set the name of the log an algorithm's failures are reported to.
+     *
+     *  By default this is the algorithm's own getLogName(), which is empty (i.e. the root logger) unless
+     *  the algorithm was constructed with a log name; the measurement task sets it to the name it would
+     *  use for the plugin when calling it from Python.
+     *
+     *  @param[in] index    Position of the algorithm in the chain.
+     *  @param[in] logName  Name of the log.
+     *
+     *  @throws pex::exceptions::OutOfRangeError if index >= size().
+     */
+    void setLogName(std::size_t index, std::string const& logName);
+
+    /// Set the mask planes of the pixels that do not count as good for the GOOD_PIXELS precondition.
+    void setBadMaskPlanes(std::vector<std::string> const& badMaskPlanes);
+
+    /// Return the number of algorithms in the chain.
+    std::size_t size() const { return _entries.size(); }
+
+    /// Return true if the chain contains no algorithms.
+    bool empty() const { return _entries.empty(); }
+
+    //@{
+    /// Return the execution order of the first and last algorithms in the chain (NaN if it is empty).
+    double getMinExecutionOrder() const;
+    double getMaxExecutionOrder() const;
+    //@}
+
+    /**
+     *  Run the single-frame algorithms with beginOrder <= executionOrder < endOrder on a source.
+     *
+     *  @throws pex::exceptions::LogicError if the chain contains forced algorithms.
+     */
+    void measure(afw::table::SourceRecord& measRecord, afw::image::Exposure<float> const& exposure,
+                 double beginOrder = -std::numeric_limits<double>::infinity(),
+                 double endOrder = std::numeric_limits<double>::infinity()) const;
+
+    /**
+     *  Run the forced algorithms with beginOrder <= executionOrder < endOrder on a source.
+     *
+     *  @throws pex::exceptions::LogicError if the chain contains single-frame algorithms.
+     */
+    void measureForced(afw::table::SourceRecord& measRecord, afw::image::Exposure<float> const& exposure,
+                       afw::table::SourceRecord const& refRecord, afw::geom::SkyWcs const& refWcs,
+                       double beginOrder = -std::numeric_limits<double>::infinity(),
+                       double endOrder = std::numeric_limits<double>::infinity()) const;
+
+private:
+    struct Entry {
+        std::shared_ptr<SingleFrameAlgorithm const> singleFrame;
+        std::shared_ptr<ForcedAlgorithm const> forced;
+        BaseAlgorithm const* algorithm;
+        double executionOrder;
+        Preconditions preconditions;
+        std::string logName;
+    };
+
+    void _add(Entry entry);
+
+    void _checkIndex(std::size_t index) const;
+
+    // Return the bits of the bad mask planes in the exposure's mask, looking them up only when the mask
+    // differs from that of the last call.
+    afw::image::MaskPixel _getBadBits(afw::image::Exposure<float> const& exposure) const;
+
+    std::vector<Entry> _entries;
+    std::vector<std::string> _badMaskPlanes;
+    bool _needsGoodPixels = false;
+    mutable std::mutex _badBitsMutex;  //< Guards _badBitsMask and _badBits
+    mutable std::weak_ptr<afw::image::Mask<afw::image::MaskPixel> const> _badBitsMask;
+    mutable afw::image::MaskPixel _badBits = 0x0;
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_PluginChain_h_INCLUDED
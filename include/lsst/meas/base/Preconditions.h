@@ -0,0 +1,188 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_BASE_Preconditions_h_INCLUDED
+#define LSST_MEAS_BASE_Preconditions_h_INCLUDED
+
+#include <array>
+#include <string>
+
+#include "lsst/afw/image/Exposure.h"
+#include "lsst/afw/table/Source.h"
+#include "lsst/meas/base/Algorithm.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  The conditions a source must satisfy for an algorithm to be able to measure it.
+ *
+ *  An algorithm whose measurement is certain to fail without them (e.g. one that needs a usable centroid)
+ *  can declare them, so that the measurement framework can check them once per source for all
+ *  algorithms, and call fail() on those whose conditions do not hold instead of running them.  Each
+ *  condition may be given the number of the flag that fail() should set, in addition to the general
+ *  failure flag, when it does not hold.
+ *
+ *  Only conditions that make the measurement fail should be declared: a source for which they do not
+ *  hold is not measured at all, so any other outputs of the algorithm are left with their defaults.
+ */
+class Preconditions {
+public:
+    enum Condition {
+        NONE = 0x0,
+        CENTROID = 0x1,    ///< A position can be obtained from the centroid slot or the Footprint peak.
+        SHAPE = 0x2,       ///< The shape slot holds a usable (finite, nonsingular) ellipse.
+        ON_IMAGE = 0x4,    ///< The position lies within the exposure.
+        GOOD_PIXELS = 0x8  ///< Enough of the Footprint is on the exposure and not masked as bad.
+    };
+
+    /// Construct with no conditions.
+    Preconditions() = default;
+
+    Preconditions(Preconditions const&) = default;
+    Preconditions(Preconditions&&) = default;
+    Preconditions& operator=(Preconditions const&) = default;
+    Preconditions& operator=(Preconditions&&) = default;
+    ~Preconditions() = default;
+
+    /**
+     *  Require a condition.
+     *
+     *  @param[in] condition   Condition to require; for GOOD_PIXELS, at least one pixel must be good.
+     *  @param[in] flagBit     Number of the flag to set when it does not hold, or -1 to only set the
+     *                         general failure flag.
+     *
+     *  @return a reference to this, so calls may be chained.
+     */
+    Preconditions& require(Condition condition, int flagBit = -1);
+
+    /**
+     *  Require that at least a given fraction of the pixels of the Footprint be good.
+     *
+     *  Pixels are good if they are on the exposure and not masked with any of the bad mask planes given
+     *  to the framework.  A source without a Footprint satisfies this condition.
+     *
+     *  @throws pex::exceptions::InvalidParameterError if minFraction is not in [0, 1].
+     */
+    Preconditions& requireGoodPixelFraction(double minFraction, int flagBit = -1);
+
+    /// Return the bitwise OR of the conditions required.
+    int getConditions() const { return _conditions; }
+
+    /// Return true if the given condition is required.
+    bool isRequired(Condition condition) const { return _conditions & condition; }
+
+    /// Return true if no condition is required.
+    bool empty() const { return _conditions == NONE; }
+
+    /// Return the flag number to set when a condition does not hold (-1 for the general failure flag).
+    int getFlagBit(Condition condition) const;
+
+    /// Return the fraction of good Footprint pixels required by GOOD_PIXELS.
+    double getMinGoodPixelFraction() const { return _minGoodPixelFraction; }
+
+    /// Return the name of a condition, for messages.
+    static std::string getConditionName(Condition condition);
+
+private:
+    static std::size_t _index(Condition condition);
+
+    int _conditions = NONE;
+    std::array<int, 4> _flagBits = {{-1, -1, -1, -1}};
+    double _minGoodPixelFraction = 0.0;
+};
+
+/**
+ *  The Preconditions of a single source, each evaluated when first needed and then reused.
+ *
+ *  The centroid and shape conditions are those under which SafeCentroidExtractor and SafeShapeExtractor
+ *  throw; a slot that is not defined at all is a configuration error and makes no condition fail, so that
+ *  the algorithm can report it.  As the slots are read when first needed, only algorithms that run after
+ *  those filling them should declare the conditions that depend on them.
+ */
+class SourceConditions {
+public:
+    /**
+     *  Prepare to check the conditions of a source.
+     *
+     *  @param[in] record    Record of the source; must outlive this object.
+     *  @param[in] exposure  Exposure being measured; must outlive this object.
+     *  @param[in] badBits   Mask bits of the pixels that are not good, for GOOD_PIXELS.
+     */
+    SourceConditions(afw::table::SourceRecord const& record, afw::image::Exposure<float> const& exposure,
+                     afw::image::MaskPixel badBits = 0);
+
+    SourceConditions(SourceConditions const&) = delete;
+    SourceConditions& operator=(SourceConditions const&) = delete;
+
+    /// Return true if a position can be obtained for the source.
+    bool hasCentroid() const;
+
+    /// Return true if the shape slot holds a usable ellipse.
+    bool hasShape() const;
+
+    /// Return true if the source's position (if any) lies within the exposure.
+    bool isOnImage() const;
+
+    /// Return the fraction of the Footprint's pixels that are good (1 if there is no Footprint).
+    double getGoodPixelFraction() const;
+
+    /// Return the first of the required conditions that does not hold, or NONE.
+    Preconditions::Condition check(Preconditions const& preconditions) const;
+
+    /**
+     *  Check the conditions required by an algorithm, calling its fail() method if one does not hold.
+     *
+     *  @param[in]     preconditions  Conditions to check.
+     *  @param[in]     algorithm      Algorithm to fail if a condition does not hold.
+     *  @param[in,out] measRecord     Record to fail.
+     *  @param[in]     logName        Name of the log to report skipped records to; if empty, that of
+     *                                the algorithm.
+     *
+     *  @return true if the conditions hold and the algorithm should be run.
+     */
+    bool apply(Preconditions const& preconditions, BaseAlgorithm const& algorithm,
+               afw::table::SourceRecord& measRecord, std::string const& logName = "") const;
+
+private:
+    enum Evaluated { POSITION = 0x1, SHAPE_VALUE = 0x2, PIXELS = 0x4 };
+
+    void _evaluatePosition() const;
+
+    afw::table::SourceRecord const& _record;
+    afw::image::Exposure<float> const& _exposure;
+    afw::image::MaskPixel _badBits;
+    mutable int _evaluated = 0;
+    mutable bool _hasCentroid = false;
+    mutable bool _hasShape = false;
+    mutable bool _onImage = false;
+    mutable double _goodPixelFraction = 1.0;
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_Preconditions_h_INCLUDED
@@ -25,6 +25,7 @@
 #define LSST_MEAS_BASE_PsfFlux_h_INCLUDED
 
 #include "lsst/pex/config.h"
+#include "lsst/afw/detection/Psf.h"
 #include "lsst/meas/base/Algorithm.h"
 #include "lsst/meas/base/FluxUtilities.h"
 #include "lsst/meas/base/FlagHandler.h"
@@ -49,13 +50,16 @@ class PsfFluxControl {
 public:
     LSST_CONTROL_FIELD(badMaskPlanes, std::vector<std::string>,
                        "Mask planes that indicate pixels that should be excluded from the fit");
+    LSST_CONTROL_FIELD(useWeights, bool,
+                       "Weight each pixel by its inverse variance in the fit, instead of giving all pixels "
+                       "equal weight");
 
     /**
      *  @brief Default constructor
      *
      *  All control classes should define a default constructor that sets all fields to their default values.
      */
-    PsfFluxControl() {}
+    PsfFluxControl() : useWeights(false) {}
 };
 
 /**
@@ -63,8 +67,13 @@ public:
  *
  *  The PsfFlux algorithm is extremely simple: we do a least-squares fit of the Psf model (evaluated
  *  at a given position) to the data.  For point sources, this provides the optimal instFlux measurement
- *  in the limit where the Psf model is correct.  We do not use per-pixel weights in the fit, as this
- *  results in bright stars being fit with a different effective profile than faint stairs.
+ *  in the limit where the Psf model is correct.  By default we do not use per-pixel weights in the fit,
+ *  as this results in bright stars being fit with a different effective profile than faint stairs; the
+ *  useWeights option enables an inverse-variance weighted fit for background-dominated data.
+ *
+ *  measureN fits the amplitudes of the Psf models of all the sources in a catalog (normally the children
+ *  of one parent, with the parent's pixels in the image) simultaneously, instead of fitting each source
+ *  alone in an image in which all of the others have been replaced with noise.
  */
 class PsfFluxAlgorithm : public SimpleAlgorithm {
 public:
@@ -84,13 +93,50 @@ public:
     virtual void measure(afw::table::SourceRecord& measRecord,
                          afw::image::Exposure<float> const& exposure) const;
 
+    /// Measure a single source, returning (instead of throwing) the routine failures of measure().
+    virtual MeasurementStatus tryMeasure(afw::table::SourceRecord& measRecord,
+                                         afw::image::Exposure<float> const& exposure) const;
+
+    /**
+     *  Jointly fit the Psf model amplitudes of all the sources in a catalog.
+     *
+     *  The fit is a linear least-squares problem over the union of the sources' (clipped) Psf model
+     *  bounding boxes; its normal equations only couple sources whose boxes overlap.  With a single
+     *  source the results are the same as those of measure.  The uncertainties are the marginal ones,
+     *  from the diagonal of the covariance matrix of the amplitudes.
+     *
+     *  Sources for which no position can be obtained, or that have no usable pixels, are flagged as
+     *  failed and left out of the fit.  A MeasurementError is thrown if the models are degenerate
+     *  (e.g. two sources at the same position).
+     */
+    virtual void measureN(afw::table::SourceCatalog const& measCat,
+                          afw::image::Exposure<float> const& exposure) const;
+
+    /**
+     *  Measure many sources independently, with the same results as measure.
+     *
+     *  The Psf models of the sources whose models lie entirely within the image are fit by the default
+     *  FluxKernelBackend, a bounded chunk of sources per call; sources that are flagged (including those
+     *  on the edge of the image or without usable pixels) are measured one at a time, as by the base
+     *  class, as are all of them if a bad mask plane is unknown.
+     */
+    virtual void measureBatch(afw::table::SourceCatalog& measCat, afw::image::Exposure<float> const& exposure,
+                              std::vector<std::size_t> const& indices) const;
+
     virtual void fail(afw::table::SourceRecord& measRecord, MeasurementError* error = nullptr) const;
 
 private:
+    // tryMeasure, with the Psf model image at the source's centroid if it has already been computed.
+    MeasurementStatus _measure(afw::table::SourceRecord& measRecord,
+                               afw::image::Exposure<float> const& exposure,
+                               std::shared_ptr<afw::detection::Psf::Image const> psfImage) const;
+
+    afw::image::MaskPixel _getBadBits(afw::image::Mask<afw::image::MaskPixel> const& mask) const;
+
     Control _ctrl;
     FluxResultKey _instFluxResultKey;
     afw::table::Key<float> _areaKey;
-    FlagHandler _flagHandler;
+    StaticFlagHandler<3> _flagHandler;
     SafeCentroidExtractor _centroidExtractor;
 };
 
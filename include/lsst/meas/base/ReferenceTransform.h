@@ -0,0 +1,131 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_BASE_ReferenceTransform_h_INCLUDED
+#define LSST_MEAS_BASE_ReferenceTransform_h_INCLUDED
+
+#include <memory>
+#include <vector>
+
+#include "lsst/geom/Point.h"
+#include "lsst/geom/LinearTransform.h"
+#include "lsst/afw/geom/SkyWcs.h"
+#include "lsst/afw/geom/Transform.h"
+#include "lsst/afw/table/Source.h"
+#include "lsst/afw/table/aggregates.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  The transformation from the pixel frame of a reference catalog to that of an exposure, applied to
+ *  all the records of a forced measurement catalog at once.
+ *
+ *  This implements the base_TransformedCentroid, base_TransformedShape and base_PeakCentroid forced
+ *  plugins in batch: the two WCSs are composed once, and all the positions of a catalog (together with
+ *  the neighbours used to find the local linear transforms) are transformed in a single call, with the
+ *  results written to the output columns.
+ */
+class ReferenceTransform {
+public:
+    /**
+     *  Compose the transformation from the pixels of one WCS to those of another.
+     *
+     *  @param[in] refWcs   WCS of the reference catalog.
+     *  @param[in] measWcs  WCS of the exposure being measured.
+     */
+    ReferenceTransform(afw::geom::SkyWcs const& refWcs, afw::geom::SkyWcs const& measWcs);
+
+    /// Return true if the two WCSs are equal, in which case positions and shapes are copied unchanged.
+    bool isIdentity() const { return !_transform; }
+
+    /// Transform reference pixel positions to the pixel frame of the exposure.
+    std::vector<geom::Point2D> transformPoints(std::vector<geom::Point2D> const& points) const;
+
+    /**
+     *  Compute the local linear approximation of the transformation at each of a number of points.
+     *
+     *  The linear part is the Jacobian of the transformation, exactly as computed by
+     *  afw::geom::linearizeTransform.  Transforms at non-finite points are NaN.
+     */
+    std::vector<geom::LinearTransform> computeLocalLinearTransforms(
+            std::vector<geom::Point2D> const& points) const;
+
+    /**
+     *  Set the transformed reference centroid slot of each record.
+     *
+     *  @param[in,out] measCat      Catalog of the records to be measured.
+     *  @param[in]     refCat       Reference records, in the same order as measCat.
+     *  @param[in]     centroidKey  Output centroid fields.
+     *  @param[in]     flagKey      Output field for the reference centroid slot flag; ignored if invalid.
+     *
+     *  @throws pex::exceptions::LengthError if the catalogs have different lengths.
+     *  @throws pex::exceptions::LogicError if the reference catalog has no centroid slot.
+     */
+    void transformCentroids(afw::table::SourceCatalog& measCat, afw::table::SourceCatalog const& refCat,
+                            afw::table::Point2DKey const& centroidKey,
+                            afw::table::Key<afw::table::Flag> const& flagKey) const;
+
+    /**
+     *  Set the reference shape slot of each record, transformed by the local linear approximation of
+     *  the transformation at its reference centroid.
+     *
+     *  @param[in,out] measCat   Catalog of the records to be measured.
+     *  @param[in]     refCat    Reference records, in the same order as measCat.
+     *  @param[in]     shapeKey  Output shape fields.
+     *  @param[in]     flagKey   Output field for the reference shape slot flag; ignored if invalid.
+     *
+     *  @throws pex::exceptions::LengthError if the catalogs have different lengths.
+     *  @throws pex::exceptions::LogicError if the reference catalog has no centroid or shape slot.
+     */
+    void transformShapes(afw::table::SourceCatalog& measCat, afw::table::SourceCatalog const& refCat,
+                         afw::table::QuadrupoleKey const& shapeKey,
+                         afw::table::Key<afw::table::Flag> const& flagKey) const;
+
+    /**
+     *  Set the transformed position of the first footprint peak of each reference.
+     *
+     *  @param[in,out] measCat      Catalog of the records to be measured.
+     *  @param[in]     refCat       Reference records, in the same order as measCat; references without
+     *                              a footprint or peak yield NaN.
+     *  @param[in]     centroidKey  Output centroid fields.
+     *  @param[in]     flagKey      Output field set for references without a footprint or peak; ignored
+     *                              if invalid.
+     *
+     *  @throws pex::exceptions::LengthError if the catalogs have different lengths.
+     */
+    void transformPeaks(afw::table::SourceCatalog& measCat, afw::table::SourceCatalog const& refCat,
+                        afw::table::Point2DKey const& centroidKey,
+                        afw::table::Key<afw::table::Flag> const& flagKey) const;
+
+private:
+    std::shared_ptr<afw::geom::TransformPoint2ToPoint2> _transform;  // null for the identity
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_ReferenceTransform_h_INCLUDED
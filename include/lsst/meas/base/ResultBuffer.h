@@ -0,0 +1,184 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_MEAS_BASE_ResultBuffer_h_INCLUDED
+#define LSST_MEAS_BASE_ResultBuffer_h_INCLUDED
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "lsst/afw/table/Source.h"
+#include "lsst/meas/base/exceptions.h"
+#include "lsst/meas/base/FlagHandler.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  Columnar storage for the results of measuring a batch of records, committed to a catalog in bulk.
+ *
+ *  Algorithms that implement measureBatch may write their results into contiguous typed columns,
+ *  indexed by the position of the record in the batch, rather than into the wide rows of the catalog
+ *  one record at a time.  commit() then writes each column into the catalog in a single pass.
+ *
+ *  Value columns are initialized to NaN (floating-point types) or zero, and every row of them is written
+ *  by commit(), as a freshly-allocated record has those values too.  Flag columns are packed 64 rows to
+ *  a word; commit() only sets the flags that are set in the buffer, leaving the others unchanged, so
+ *  flags may also be set directly on the records (e.g. by fail()) before or after the commit.
+ *
+ *  Column handles remain valid for the lifetime of the buffer, even as other columns are added.
+ */
+class ResultBuffer {
+public:
+    /// A handle to a column of values of type T.
+    template <typename T>
+    class Column {
+    public:
+        T& operator[](std::size_t row) const { return _data[row]; }
+
+        /// Return a pointer to the first row; rows are contiguous.
+        T* getData() const { return _data; }
+
+    private:
+        friend class ResultBuffer;
+        explicit Column(T* data) : _data(data) {}
+        T* _data;
+    };
+
+    /// A handle to a column of flags.
+    class FlagColumn {
+    public:
+        /// A handle that ignores all operations, for flags that were excluded from the schema.
+        FlagColumn() : _bits(nullptr) {}
+
+        void set(std::size_t row) const {
+            if (_bits) _bits[row / 64] |= std::uint64_t(1) << (row % 64);
+        }
+
+        bool test(std::size_t row) const {
+            return _bits && (_bits[row / 64] & (std::uint64_t(1) << (row % 64)));
+        }
+
+    private:
+        friend class ResultBuffer;
+        explicit FlagColumn(std::uint64_t* bits) : _bits(bits) {}
+        std::uint64_t* _bits;
+    };
+
+    /// Handles to the columns of all the flags managed by a FlagHandler, indexed by flag number.
+    class FlagColumns {
+    public:
+        FlagColumn const& operator[](std::size_t number) const { return _columns.at(number); }
+        FlagColumn const& operator[](FlagDefinition const& flag) const { return _columns.at(flag.number); }
+
+        /// Set the flags of a row as FlagHandler::handleFailure would set them on a record.
+        void handleFailure(std::size_t row, MeasurementError const* error = nullptr) const;
+
+    private:
+        friend class ResultBuffer;
+        std::vector<FlagColumn> _columns;
+        std::size_t _failureFlagNumber = FlagDefinition::number_undefined;
+    };
+
+    /// Construct a buffer for a batch of nRows records, with no columns.
+    explicit ResultBuffer(std::size_t nRows) : _nRows(nRows) {}
+
+    ResultBuffer(ResultBuffer const&) = delete;
+    ResultBuffer& operator=(ResultBuffer const&) = delete;
+    ResultBuffer(ResultBuffer&&) = default;
+    ResultBuffer& operator=(ResultBuffer&&) = default;
+
+    /// Return the number of rows in the buffer.
+    std::size_t size() const { return _nRows; }
+
+    /// Add a column for a field of a numeric type.
+    template <typename T>
+    Column<T> addColumn(afw::table::Key<T> const& key) {
+        static_assert(std::is_arithmetic<T>::value, "ResultBuffer columns must hold numeric values");
+        T const initial = std::numeric_limits<T>::has_quiet_NaN ? std::numeric_limits<T>::quiet_NaN() : T(0);
+        auto column = std::make_unique<ValueColumn<T>>(key, _nRows, initial);
+        T* data = column->values.data();
+        _columns.push_back(std::move(column));
+        return Column<T>(data);
+    }
+
+    /// Add a column for a flag field; an invalid key yields a handle that ignores all operations.
+    FlagColumn addFlagColumn(afw::table::Key<afw::table::Flag> const& key);
+
+    /// Add columns for all the flags managed by a FlagHandler.
+    FlagColumns addFlagColumns(FlagHandler const& flagHandler);
+
+    /**
+     *  Write all columns to the records of a catalog.
+     *
+     *  @param[in,out] catalog  Catalog whose records are to be written.
+     *  @param[in]     indices  Index in catalog of the record for each row of the buffer.
+     *
+     *  @throws pex::exceptions::LengthError if indices does not have one element per row.
+     */
+    void commit(afw::table::SourceCatalog& catalog, std::vector<std::size_t> const& indices) const;
+
+private:
+    struct ColumnBase {
+        virtual void commit(std::vector<afw::table::BaseRecord*> const& records) const = 0;
+        virtual ~ColumnBase() {}
+    };
+
+    template <typename T>
+    struct ValueColumn : public ColumnBase {
+        ValueColumn(afw::table::Key<T> const& key_, std::size_t nRows, T initial)
+                : key(key_), values(nRows, initial) {}
+
+        void commit(std::vector<afw::table::BaseRecord*> const& records) const override {
+            for (std::size_t i = 0; i < records.size(); ++i) {
+                *records[i]->getElement(key) = values[i];
+            }
+        }
+
+        afw::table::Key<T> key;
+        std::vector<T> values;
+    };
+
+    struct BitColumn : public ColumnBase {
+        BitColumn(afw::table::Key<afw::table::Flag> const& key_, std::size_t nRows)
+                : key(key_), bits((nRows + 63) / 64, 0) {}
+
+        void commit(std::vector<afw::table::BaseRecord*> const& records) const override;
+
+        afw::table::Key<afw::table::Flag> key;
+        std::vector<std::uint64_t> bits;
+    };
+
+    std::size_t _nRows;
+    std::vector<std::unique_ptr<ColumnBase>> _columns;
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_ResultBuffer_h_INCLUDED
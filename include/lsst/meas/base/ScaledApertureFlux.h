@@ -43,13 +43,17 @@ public:
             shiftKernel, std::string,
             "Warping kernel used to shift Sinc photometry coefficients to different center positions");
     LSST_CONTROL_FIELD(scale, double, "Scaling factor of PSF FWHM for aperture radius.");
+    LSST_CONTROL_FIELD(radiusGridStep, double,
+                       "Step in ln(radius) of the grid of cached aperture radii; if positive, the instFlux "
+                       "is interpolated between the two grid radii that bracket the scaled radius, "
+                       "instead of being measured with coefficients synthesized for that radius");
 
     // The default scaling factor is chosen such that scaled aperture
     // magnitudes are expected to be equal to Kron magnitudes, based on
     // measurements performed by Stephen Gwyn on WIRCam. See:
     // http://www.cadc-ccda.hia-iha.nrc-cnrc.gc.ca/en/wirwolf/docs/proc.html#photcal
     // http://www.cfht.hawaii.edu/fr/news/UM2013/presentations/Session10-SGwyn.pdf
-    ScaledApertureFluxControl() : shiftKernel("lanczos5"), scale(3.14) {}
+    ScaledApertureFluxControl() : shiftKernel("lanczos5"), scale(3.14), radiusGridStep(0.0) {}
 };
 
 /**
@@ -58,6 +62,12 @@ public:
  *  This algorithm performs a sinc aperture instFlux measurement where they size
  *  of the aperture is determined by multiplying the FWHM of the PSF by the
  *  scaling factor specified in the algorithm configuration.
+ *
+ *  Because the scaled radius varies continuously with the PSF, the coefficients for every source are
+ *  normally synthesized afresh.  If radiusGridStep is positive, the instFlux is instead measured at the
+ *  two radii on a logarithmic grid that bracket the scaled radius, whose coefficients are cached, and
+ *  interpolated linearly in radius.  The difference between that and an interpolation linear in the
+ *  aperture area is recorded in an "instFluxInterpErr" field as an estimate of the interpolation error.
  */
 class ScaledApertureFluxAlgorithm : public SimpleAlgorithm {
 public:
@@ -82,6 +92,7 @@ public:
 private:
     Control _ctrl;
     FluxResultKey _instFluxResultKey;
+    afw::table::Key<meas::base::FluxErrElement> _interpErrKey;
     FlagHandler _flagHandler;
     SafeCentroidExtractor _centroidExtractor;
 };
@@ -0,0 +1,117 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_BASE_SceneRealizer_h_INCLUDED
+#define LSST_MEAS_BASE_SceneRealizer_h_INCLUDED
+
+#include <memory>
+#include <vector>
+
+#include "lsst/geom/Box.h"
+#include "lsst/geom/Point.h"
+#include "lsst/afw/geom/ellipses/Quadrupole.h"
+#include "lsst/afw/detection/Footprint.h"
+#include "lsst/afw/detection/HeavyFootprint.h"
+#include "lsst/afw/image/Image.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/// A source rendered by SceneRealizer: an elliptical Gaussian with the given total flux and moments.
+struct SceneSource {
+    SceneSource(double instFlux_, geom::Point2D const& center_, afw::geom::ellipses::Quadrupole const& shape_)
+            : instFlux(instFlux_), center(center_), shape(shape_) {}
+
+    double instFlux;                        ///< total flux of the source
+    geom::Point2D center;                   ///< position of the source
+    afw::geom::ellipses::Quadrupole shape;  ///< second moments of the source (after any PSF convolution)
+};
+
+/**
+ *  Render many synthetic sources, and their idealized Footprints, for tests and benchmarks.
+ *
+ *  Each source is an elliptical Gaussian evaluated at the pixel centers, as by TestDataset.drawGaussian.
+ *  Footprints are computed analytically: the pixels in which the source alone exceeds a threshold form
+ *  the inside of one of its isophotes, which is then grown isotropically and clipped to the image, as
+ *  detection on an image of the source alone would do.
+ */
+class SceneRealizer {
+public:
+    /**
+     *  Construct a realizer.
+     *
+     *  @param[in] threshold   Value a pixel of the noise-free image of a source must reach to be in its
+     *                         Footprint.
+     *  @param[in] growRadius  Radius by which Footprints are grown (isotropically) after thresholding.
+     *  @param[in] nSigma      Sources are rendered within this (Mahalanobis) radius of their centers, and
+     *                         neglected beyond it.
+     *  @param[in] tileHeight  Number of image rows rendered by a thread at a time.
+     */
+    explicit SceneRealizer(double threshold, int growRadius = 0, double nSigma = 8.0, int tileHeight = 64);
+
+    /**
+     *  Add the images of the sources to an image.
+     *
+     *  The image is divided into tiles of full rows, which are rendered in parallel; each pixel is the sum
+     *  (in double precision) of the sources that overlap it.
+     *
+     *  @param[in]     sources   Sources to render.
+     *  @param[in,out] image     Image to which the sources are added.
+     *  @param[in]     nThreads  Number of threads to use; zero uses one per hardware thread.
+     */
+    void render(std::vector<SceneSource> const& sources, afw::image::Image<float>& image,
+                int nThreads = 0) const;
+
+    /**
+     *  Return the Footprint of each source in an image with the given bounding box.
+     *
+     *  Each Footprint has a single Peak, at its brightest pixel before growing; sources that do not reach
+     *  the threshold anywhere in the image have empty Footprints, with no Peaks.
+     */
+    std::vector<std::shared_ptr<afw::detection::Footprint>> makeFootprints(
+            std::vector<SceneSource> const& sources, geom::Box2I const& bbox) const;
+
+    /**
+     *  Return a HeavyFootprint for each source, holding the (noise-free) image of the source alone within
+     *  its Footprint, as a perfect deblender would.
+     *
+     *  @throws pex::exceptions::LengthError if there is not one Footprint for each source.
+     */
+    std::vector<std::shared_ptr<afw::detection::HeavyFootprint<float>>> makeHeavyFootprints(
+            std::vector<SceneSource> const& sources,
+            std::vector<std::shared_ptr<afw::detection::Footprint>> const& footprints) const;
+
+private:
+    double _threshold;
+    int _growRadius;
+    double _nSigma;
+    int _tileHeight;
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_SceneRealizer_h_INCLUDED
@@ -0,0 +1,148 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_BASE_ScratchArena_h_INCLUDED
+#define LSST_MEAS_BASE_ScratchArena_h_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  A per-thread bump allocator for the scratch buffers used while measuring a single source.
+ *
+ *  Measurement algorithms need a handful of short-lived buffers for every source (pixel values to
+ *  take the median of, binned images, interpolation weights, ...).  Allocating them from the heap
+ *  each time is a measurable fraction of the cost of measuring in crowded fields; instead, they can
+ *  be drawn from the arena of the calling thread within a ScratchArena::Scope, which releases all
+ *  the buffers allocated within it when it ends.  The memory itself is kept for reuse by later
+ *  sources, so once the arena has grown to the largest working set it no longer touches the heap.
+ *
+ *  Buffers are uninitialized, suitably aligned arrays of trivially-destructible types; they must
+ *  not be used after the Scope in which they were allocated has ended.  Process-wide counts of the
+ *  buffers allocated and of the heap allocations made by all arenas are kept for instrumentation.
+ */
+class ScratchArena {
+public:
+    /**
+     *  Releases all the buffers allocated from an arena during its lifetime.
+     *
+     *  Scopes may be nested; each must end before the one enclosing it.
+     */
+    class Scope {
+    public:
+        /// Start a scope in the arena of the calling thread.
+        Scope() : Scope(ScratchArena::getThreadArena()) {}
+
+        /// Start a scope in the given arena.
+        explicit Scope(ScratchArena& arena);
+
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+
+        ~Scope();
+
+        /// Return the arena buffers are allocated from.
+        ScratchArena& getArena() const { return _arena; }
+
+        /// Allocate an uninitialized buffer of n elements, valid until the end of the scope.
+        template <typename T>
+        T* allocate(std::size_t n) const {
+            return _arena.allocate<T>(n);
+        }
+
+    private:
+        ScratchArena& _arena;
+        std::size_t _block;
+        std::size_t _offset;
+    };
+
+    /// Process-wide counts of arena activity.
+    struct Statistics {
+        std::uint64_t buffers;     ///< number of buffers allocated
+        std::uint64_t blocks;      ///< number of heap allocations made to hold them
+        std::uint64_t blockBytes;  ///< total size of those heap allocations
+    };
+
+    /// Return the arena of the calling thread.
+    static ScratchArena& getThreadArena();
+
+    /// Return the activity of all arenas since the last call to resetStatistics().
+    static Statistics getStatistics();
+
+    /// Reset the counts returned by getStatistics().
+    static void resetStatistics();
+
+    ScratchArena();
+
+    ScratchArena(ScratchArena const&) = delete;
+    ScratchArena& operator=(ScratchArena const&) = delete;
+
+    ~ScratchArena();
+
+    /**
+     *  Allocate an uninitialized buffer of n elements.
+     *
+     *  The buffer remains valid until the end of the innermost enclosing Scope; outside of any Scope
+     *  it is never released (though its memory is reused once a later Scope ends).
+     */
+    template <typename T>
+    T* allocate(std::size_t n) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "ScratchArena buffers are released without calling destructors");
+        return static_cast<T*>(_allocate(n * sizeof(T), alignof(T)));
+    }
+
+    /// Return the number of bytes currently allocated from the arena.
+    std::size_t getUsed() const;
+
+    /// Return the number of bytes the arena can hold without further heap allocations.
+    std::size_t getCapacity() const;
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        std::size_t size;
+    };
+
+    void* _allocate(std::size_t bytes, std::size_t alignment);
+    void _release(std::size_t block, std::size_t offset);
+
+    std::vector<Block> _blocks;
+    std::size_t _block;   // index of the block allocations are made from
+    std::size_t _offset;  // offset of the first free byte in that block
+    int _depth;           // number of open scopes
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_ScratchArena_h_INCLUDED
@@ -41,6 +41,8 @@ namespace lsst {
 namespace meas {
 namespace base {
 
+class BinnedPyramid;
+
 /**
  *  @brief A C++ control class to handle SdssCentroidAlgorithm's configuration
  *
@@ -53,6 +55,16 @@ public:
     LSST_CONTROL_FIELD(doFootprintCheck, bool, "Do check that the centroid is contained in footprint.");
     LSST_CONTROL_FIELD(maxDistToPeak, double,
                        "If set > 0, Centroid Check also checks distance from footprint peak.");
+    LSST_CONTROL_FIELD(psfCellSize, int,
+                       "If > 0, evaluate the PSF smoothing kernel at the center of square cells of this size "
+                       "(in pixels) and share it between all sources in a cell, instead of at each source");
+    LSST_CONTROL_FIELD(usePyramid, bool,
+                       "When measuring a batch of sources, read binned neighbourhoods from a pyramid of the "
+                       "image binned once for all sources (see BinnedPyramid); bins are then fixed to the "
+                       "image rather than to each source, which changes results slightly");
+    LSST_CONTROL_FIELD(uncertainty, std::string,
+                       "Uncertainty information to record: NO_UNCERTAINTY or SIGMA_ONLY (the x-y covariance "
+                       "is not computed, so FULL_COVARIANCE is not supported)");
     /**
      *  @brief Default constructor
      *
@@ -60,7 +72,14 @@ public:
      */
 
     SdssCentroidControl()
-            : binmax(16), peakMin(-1.0), wfac(1.5), doFootprintCheck(true), maxDistToPeak(-1.0) {}
+            : binmax(16),
+              peakMin(-1.0),
+              wfac(1.5),
+              doFootprintCheck(true),
+              maxDistToPeak(-1.0),
+              psfCellSize(0),
+              usePyramid(false),
+              uncertainty("SIGMA_ONLY") {}
 };
 
 /**
@@ -85,14 +104,58 @@ public:
     virtual void measure(afw::table::SourceRecord& measRecord,
                          afw::image::Exposure<float> const& exposure) const;
 
+    /**
+     *  Set an image already smoothed with (an approximation of) the PSF, such as the one computed for
+     *  detection, to read unbinned neighbourhoods from instead of smoothing each source's pixels.
+     *
+     *  Both image and variance must be the result of afw::math::convolve on the image being measured,
+     *  and the image is indexed in parent coordinates, so it may cover less than the exposures measured:
+     *  sources near its edges, and those that must be binned, are smoothed as usual.
+     *
+     *  @param[in] image           The smoothed image, or nullptr to stop using one.
+     *  @param[in] smoothingSigma  Gaussian sigma of the kernel the image was smoothed with, used to
+     *                             restore the per-pixel variance and to correct the widths for the
+     *                             smoothing.  If <= 0 the image is assumed to be smoothed with the PSF
+     *                             itself, and the determinant radius of the PSF at each source is used.
+     *  @param[in] useForChildren  Whether to use the image for deblended children.  Neighbours are not
+     *                             replaced with noise in it, so this should be false if the children
+     *                             are measured with their siblings replaced by noise.
+     *
+     *  The image must not be changed while measuring.
+     */
+    void setSmoothedImage(std::shared_ptr<afw::image::MaskedImage<float> const> image,
+                          double smoothingSigma = 0.0, bool useForChildren = true);
+
+    /// Return the image set by setSmoothedImage(), or nullptr.
+    std::shared_ptr<afw::image::MaskedImage<float> const> getSmoothedImage() const { return _smoothedImage; }
+
+    /// Measure a single source, returning (instead of throwing) the routine failures of measure().
+    virtual MeasurementStatus tryMeasure(afw::table::SourceRecord& measRecord,
+                                         afw::image::Exposure<float> const& exposure) const;
+
+    /**
+     *  Measure a batch of records, binning the image once for all of them if usePyramid is set.
+     *
+     *  The image must not change between sources, as is the case when neighbours are not replaced with
+     *  noise.
+     */
+    virtual void measureBatch(afw::table::SourceCatalog& measCat, afw::image::Exposure<float> const& exposure,
+                              std::vector<std::size_t> const& indices) const;
+
     virtual void fail(afw::table::SourceRecord& measRecord, MeasurementError* error = nullptr) const;
 
 private:
+    MeasurementStatus _measure(afw::table::SourceRecord& measRecord,
+                               afw::image::Exposure<float> const& exposure, BinnedPyramid* pyramid) const;
+
     Control _ctrl;
     CentroidResultKey _centroidKey;
     FlagHandler _flagHandler;
     SafeCentroidExtractor _centroidExtractor;
     CentroidChecker _centroidChecker;
+    std::shared_ptr<afw::image::MaskedImage<float> const> _smoothedImage;
+    double _smoothedSigma;
+    bool _smoothedForChildren;
 };
 
 class SdssCentroidTransform : public CentroidTransform {
@@ -25,6 +25,8 @@
 #define LSST_MEAS_BASE_SdssShape_h_INCLUDED
 
 #include <bitset>
+#include <string>
+#include <vector>
 
 #include "lsst/pex/config.h"
 #include "lsst/afw/geom/SkyWcs.h"
@@ -57,10 +59,31 @@ public:
     LSST_CONTROL_FIELD(tol1, float, "Convergence tolerance for e1,e2");
     LSST_CONTROL_FIELD(tol2, float, "Convergence tolerance for FWHM");
     LSST_CONTROL_FIELD(doMeasurePsf, bool, "Whether to also compute the shape of the PSF model");
+    LSST_CONTROL_FIELD(vectorize, bool,
+                       "Evaluate the weighted moments a row at a time with SIMD-vectorized arithmetic; "
+                       "results agree with the scalar loop only to single-precision rounding, so it is off "
+                       "by default");
+    LSST_CONTROL_FIELD(doWarmStart, bool,
+                       "Start the adaptive iteration from the shape slot (e.g. the transformed reference "
+                       "shape in forced mode) if it is usable, or else from the PSF model shape, instead "
+                       "of a fixed 1.5 pixel^2 circular weight");
+    LSST_CONTROL_FIELD(uncertainty, std::string,
+                       "Uncertainty information to compute and record: NO_UNCERTAINTY (no shape errors or "
+                       "instFlux-shape covariances; the instFlux error is still recorded), SIGMA_ONLY "
+                       "(shape errors and instFlux-shape covariances) or FULL_COVARIANCE (also the "
+                       "covariances between the moments)");
+    LSST_CONTROL_FIELD(doRecordWeightedSum, bool,
+                       "Record the Gaussian-weighted sum of the pixels for the final weight function and "
+                       "the center it was computed at, so GaussianFlux can reuse it for sources whose "
+                       "shape and centroid are the ones measured here instead of recomputing it");
 
     /// @copydoc SdssShapeControl::SdssShapeControl
     SdssShapeControl()
-            : background(0.0), maxIter(100), maxShift(), tol1(1E-5), tol2(1E-4), doMeasurePsf(true) {}
+            : background(0.0), maxIter(100), maxShift(), tol1(1E-5), tol2(1E-4), doMeasurePsf(true),
+              vectorize(false),
+              doWarmStart(false),
+              uncertainty("SIGMA_ONLY"),
+              doRecordWeightedSum(false) {}
 };
 
 /**
@@ -82,9 +105,11 @@ public:
      *                               doMeasurePsf is false.
      *  @param[in]     doMeasurePsf  Boolean indicating whether or not the Psf is being measured (as
      *                               set in the SdssShapeControl class).
+     *  @param[in]     uncertainty   Which uncertainty fields to add; with NO_UNCERTAINTY only the
+     *                               instFlux keeps an error field, and there are no covariance fields.
      */
     static SdssShapeResultKey addFields(afw::table::Schema& schema, std::string const& name,
-                                        bool doMeasurePsf);
+                                        bool doMeasurePsf, UncertaintyEnum uncertainty = SIGMA_ONLY);
 
     /// Default constructor; instance will not be usuable unless subsequently assigned to.
     SdssShapeResultKey() {}
@@ -133,6 +158,7 @@ private:
     afw::table::Key<ErrElement> _instFlux_xx_Cov;
     afw::table::Key<ErrElement> _instFlux_yy_Cov;
     afw::table::Key<ErrElement> _instFlux_xy_Cov;
+    afw::table::Key<int> _nIter;
     FlagHandler _flagHandler;
 };
 
@@ -184,6 +210,31 @@ public:
     static Result computeAdaptiveMoments(ImageT const& image, geom::Point2D const& position,
                                          bool negative = false, Control const& ctrl = Control());
 
+    /**
+     *  Compute the adaptive Gaussian-weighted moments of an image, starting the iteration from
+     *  the given weight function rather than the default returned by getDefaultInitialWeight().
+     *
+     *  A starting weight close to the final moments (e.g. the PSF model shape, or a reference
+     *  shape in forced measurement) typically reduces the number of iterations needed to converge;
+     *  the number actually performed is recorded in Result::nIter.
+     *
+     *  @param[in] image          An Image or MaskedImage instance with int, float, or double pixels.
+     *  @param[in] position       Center position of the object to be measured, in the image's PARENT
+     *                            coordinates.
+     *  @param[in] initialWeight  Second moments of the Gaussian weight for the first iteration.
+     *  @param[in] negative       Boolean, specify if the source is in negative instFlux space
+     *  @param[in] ctrl           Control object specifying the details of how the object is to be measured.
+     */
+    template <typename ImageT>
+    static Result computeAdaptiveMoments(ImageT const& image, geom::Point2D const& position,
+                                         afw::geom::ellipses::Quadrupole const& initialWeight,
+                                         bool negative = false, Control const& ctrl = Control());
+
+    /// Return the weight function used to start the adaptive iteration when none is supplied.
+    static afw::geom::ellipses::Quadrupole getDefaultInitialWeight() {
+        return afw::geom::ellipses::Quadrupole(1.5, 1.5, 0.0);
+    }
+
     /**
      *  Compute the instFlux within a fixed Gaussian aperture.
      *
@@ -192,11 +243,53 @@ public:
      *                       fit will be a subset of this image determined automatically).
      *  @param[in] shape     Ellipse object specifying the 1-sigma contour of the Gaussian.
      *  @param[in] position  Center position of the object to be measured, in the image's PARENT coordinates.
+     *  @param[in] ctrl      Control object; only the vectorize field is used.
      */
     template <typename ImageT>
     static FluxResult computeFixedMomentsFlux(ImageT const& image,
                                               afw::geom::ellipses::Quadrupole const& shape,
-                                              geom::Point2D const& position);
+                                              geom::Point2D const& position, Control const& ctrl = Control());
+
+    /**
+     *  Compute the instFlux within a fixed Gaussian aperture, given the Gaussian-weighted sum of the pixels.
+     *
+     *  This completes computeFixedMomentsFlux (with a default Control) for a weighted sum that has already
+     *  been evaluated, such as the one recorded by SdssShapeAlgorithm when doRecordWeightedSum is set;
+     *  only the center pixel's variance is read from the image.
+     *
+     *  @param[in] image        An Image or MaskedImage instance with int, float, or double pixels.
+     *  @param[in] shape        Ellipse object specifying the 1-sigma contour of the Gaussian.
+     *  @param[in] position     Center position of the object, in the image's PARENT coordinates.
+     *  @param[in] weightedSum  Sum of the pixels weighted by the (unnormalized) Gaussian.
+     */
+    template <typename ImageT>
+    static FluxResult computeFixedMomentsFluxFromSum(ImageT const& image,
+                                                     afw::geom::ellipses::Quadrupole const& shape,
+                                                     geom::Point2D const& position, double weightedSum);
+
+    /**
+     *  Compute the instFlux within several fixed Gaussian apertures that differ only in size.
+     *
+     *  The weight function for scales[k] is the Gaussian whose 1-sigma contour is @c shape scaled
+     *  (linearly) by scales[k], and each result is identical (up to round-off) to calling
+     *  computeFixedMomentsFlux with that scaled shape.  All the weights are evaluated in a single pass
+     *  over the pixels, sharing the distance computation; weights whose inverse squared scale is an
+     *  integer multiple of that of the largest scale are obtained by raising the largest-scale weight
+     *  to that power instead of calling exp.  Scales small enough to need sub-pixel interpolation
+     *  are delegated to computeFixedMomentsFlux.
+     *
+     *  @param[in] image     An Image or MaskedImage instance with int, float, or double pixels.
+     *  @param[in] shape     Ellipse object specifying the 1-sigma contour of the unscaled Gaussian.
+     *  @param[in] position  Center position of the object to be measured, in the image's PARENT coordinates.
+     *  @param[in] scales    Positive factors by which to scale the semi-axes of @c shape.
+     *  @param[in] ctrl      Control object; only used for scales delegated to computeFixedMomentsFlux.
+     */
+    template <typename ImageT>
+    static std::vector<FluxResult> computeFixedMomentsFluxes(ImageT const& image,
+                                                             afw::geom::ellipses::Quadrupole const& shape,
+                                                             geom::Point2D const& position,
+                                                             std::vector<double> const& scales,
+                                                             Control const& ctrl = Control());
 
     virtual void measure(afw::table::SourceRecord& measRecord,
                          afw::image::Exposure<float> const& exposure) const;
@@ -204,8 +297,22 @@ public:
     virtual void fail(afw::table::SourceRecord& measRecord, MeasurementError* error = nullptr) const;
 
 private:
+    // computeAdaptiveMoments, also returning the weighted sum for the final weights in *weightedSum
+    // (NaN if the iteration did not converge to a usable weight function) if it is not null.
+    template <typename ImageT>
+    static Result _computeAdaptiveMoments(ImageT const& image, geom::Point2D const& position,
+                                          afw::geom::ellipses::Quadrupole const& initialWeight,
+                                          bool negative, Control const& ctrl, double* weightedSum);
+
+    // Choose the starting weight for the adaptive iteration when doWarmStart is set.
+    afw::geom::ellipses::Quadrupole _computeInitialWeight(
+            afw::table::SourceRecord const& measRecord, afw::image::Exposure<float> const& exposure,
+            geom::Point2D const& center, afw::geom::ellipses::Quadrupole const& fallback) const;
+
     Control _ctrl;
     ResultKey _resultKey;
+    afw::table::Key<double> _weightedSumKey;  // only valid if doRecordWeightedSum
+    afw::table::PointKey<double> _weightedSumCenterKey;
     SafeCentroidExtractor _centroidExtractor;
 };
 
@@ -229,6 +336,8 @@ public:
 
     std::bitset<SdssShapeAlgorithm::N_FLAGS> flags;  ///< Status flags (see SdssShapeAlgorithm).
 
+    int nIter;  ///< Number of adaptive moments iterations performed
+
     /// Flag getter for Swig, which doesn't understand std::bitset
     // TODO is this workaround still needed?
     bool getFlag(unsigned int index) const { return flags[index]; }
@@ -24,7 +24,15 @@
 #ifndef LSST_MEAS_BASE_SincCoeffs_h_INCLUDED
 #define LSST_MEAS_BASE_SincCoeffs_h_INCLUDED
 
+#include <atomic>
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include "lsst/afw/image/Image.h"
 #include "lsst/afw/geom/ellipses/Axes.h"
@@ -39,13 +47,37 @@ namespace base {
  * Caching is only performed for circular apertures (because elliptical
  * apertures are assumed to be generated dynamically, and hence not expected
  * to recur).  Caching must be explicitly requested for a particular circular
- * aperture (using the 'cache' method).
+ * aperture (using the 'cache' method).  Elliptical apertures may be cached
+ * approximately, by quantizing their shape (see 'getQuantized').
+ *
+ * The cache may be used concurrently from multiple threads: lookups take a shared
+ * lock, while insertion and eviction take an exclusive one.  Coefficients are
+ * calculated outside the lock.  The total size of the cached coefficient images is
+ * bounded (see setMaxCacheBytes); when the bound is exceeded the least-recently-used
+ * entries are evicted, and will subsequently be recalculated on demand.
+ *
+ * Cached coefficients may be written to a file and read back (memory-mapped) by
+ * other processes, so that short-lived workers need not recalculate them.  Such
+ * files may also be opened as stores, which are consulted whenever coefficients
+ * are not cached, before calculating them; all processes that open the same store
+ * share a single copy of its pages.
  */
 template <typename PixelT>
 class SincCoeffs {
 public:
     typedef afw::image::Image<PixelT> CoeffT;
 
+    /// Snapshot of the cache usage counters
+    struct CacheStatistics {
+        std::size_t hits;       ///< Number of get() calls satisfied from the cache
+        std::size_t misses;     ///< Number of get() calls that were not satisfied from the cache
+        std::size_t loads;      ///< Number of misses satisfied from a coefficient store
+        std::size_t evictions;  ///< Number of entries evicted to respect the memory bound
+        std::size_t entries;    ///< Number of entries currently in the cache
+        std::size_t bytes;      ///< Memory used by the cached coefficient images
+        std::size_t maxBytes;   ///< Current bound on the memory used by the cache
+    };
+
     /**
      * Cache the coefficients for a particular aperture
      *
@@ -53,6 +85,75 @@ public:
      */
     static void cache(float rInner, float rOuter);
 
+    /**
+     * Cache the coefficients for several apertures
+     *
+     * Equivalent to calling 'cache' for each aperture, but the coefficients that are not already
+     * cached may be calculated concurrently.
+     *
+     * @param[in] radii     Inner and outer radius of each circular annulus.
+     * @param[in] nThreads  Number of threads to use (default 1); zero uses one per hardware thread.
+     */
+    static void cacheAll(std::vector<std::pair<float, float>> const& radii, int nThreads = 1);
+
+    /**
+     * Write the cached coefficients to a file
+     *
+     * The coefficients of circular and (quantized) elliptical apertures are written, keyed by their
+     * shape and inner radius factor; shifted coefficients are not.  The file is specific to the
+     * pixel type, and can only be read on machines with the same byte order.  It is written under a
+     * temporary name in the same directory and then renamed, so an existing file that is mapped by
+     * readCache or openStore (in any process) is replaced rather than modified.
+     */
+    static void writeCache(std::string const& filename);
+
+    /**
+     * Add the coefficients in a file written by 'writeCache' to the cache
+     *
+     * The file is memory-mapped, so the coefficient images share its pages instead of being
+     * copied.  Apertures that are already cached keep their existing coefficients.  The entries
+     * count toward the bound on the memory used by the cache.
+     */
+    static void readCache(std::string const& filename);
+
+    /**
+     * Open a file written by 'writeCache' as a store of coefficients
+     *
+     * The file is memory-mapped, and consulted (after any stores opened before it) whenever the
+     * coefficients for an aperture are not cached, before calculating them.  Circular and quantized
+     * coefficients found in a store are added to the cache, as if they had been calculated.
+     */
+    static void openStore(std::string const& filename);
+
+    /// Stop consulting the stores opened with 'openStore'
+    static void closeStores();
+
+    /**
+     * Measure the fastest FFTs for the apertures up to a given outer radius
+     *
+     * Coefficients are otherwise calculated with FFT plans estimated on first use.  Measuring takes
+     * much longer, but records the plans as FFTW wisdom, which may be exported with
+     * 'exportFftwWisdom' and imported by other processes.  Widths that have already been planned keep
+     * their plans.  Measured plans may round differently from estimated ones.
+     */
+    static void planFftw(double maxRadius);
+
+    /**
+     * Import FFTW wisdom from a file
+     *
+     * Widths planned subsequently use the wisdom's plans where there are any.
+     *
+     * @throws pex::exceptions::IoError if the file cannot be read.
+     */
+    static void importFftwWisdom(std::string const& filename);
+
+    /**
+     * Export the accumulated FFTW wisdom to a file
+     *
+     * @throws pex::exceptions::IoError if the file cannot be written.
+     */
+    static void exportFftwWisdom(std::string const& filename);
+
     /**
      * Get the coefficients for an aperture
      *
@@ -61,10 +162,71 @@ public:
     static PTR(CoeffT const)
             get(afw::geom::ellipses::Axes const& outerEllipse, float const innerRadiusFactor = 0.0);
 
+    /**
+     * Get the coefficients for an aperture whose shape has been quantized
+     *
+     * The major axis is quantized in steps of `tolerance` in its logarithm (so that one entry serves a
+     * fractional range of sizes), the axis ratio in steps of `tolerance`, and the position angle in
+     * steps of `tolerance` radians.  Coefficients for the quantized shape are calculated on first use
+     * and cached, subject to the same memory bound as circular apertures.
+     *
+     * @param[in] outerEllipse       Outer boundary of the aperture.
+     * @param[in] innerRadiusFactor  Ratio of the inner to the outer boundary.
+     * @param[in] tolerance          Quantization step; must be positive.
+     *
+     * The coefficients returned correspond to `quantize(outerEllipse, tolerance)`, not to
+     * `outerEllipse` itself.
+     */
+    static PTR(CoeffT const) getQuantized(afw::geom::ellipses::Axes const& outerEllipse,
+                                          float const innerRadiusFactor, double const tolerance);
+
+    /**
+     * Get the coefficients for an aperture, shifted by a fraction of a pixel
+     *
+     * The coefficients for the aperture (as returned by 'get') are shifted by
+     * (shiftX/nShift, shiftY/nShift) pixels with the named warping kernel.  Shifted coefficients are
+     * always cached, so that a bank of nShift x nShift images is built up for each aperture as it is
+     * used; callers are expected to round source positions onto the grid of shifts.
+     *
+     * @param[in] outerEllipse       Outer boundary of the aperture.
+     * @param[in] innerRadiusFactor  Ratio of the inner to the outer boundary.
+     * @param[in] shiftX             Shift in x, in units of 1/nShift pixels; 0 <= shiftX < nShift.
+     * @param[in] shiftY             Shift in y, in units of 1/nShift pixels; 0 <= shiftY < nShift.
+     * @param[in] nShift             Number of sub-pixel shifts per pixel.
+     * @param[in] warpingKernelName  Warping kernel used to shift the coefficients.
+     */
+    static PTR(CoeffT const) getShifted(afw::geom::ellipses::Axes const& outerEllipse,
+                                        float const innerRadiusFactor, int shiftX, int shiftY, int nShift,
+                                        std::string const& warpingKernelName);
+
+    /// Return the shape for which getQuantized will return coefficients
+    static afw::geom::ellipses::Axes quantize(afw::geom::ellipses::Axes const& outerEllipse,
+                                              double const tolerance);
+
     /// Calculate the coefficients for an aperture
     static PTR(CoeffT)
             calculate(afw::geom::ellipses::Axes const& outerEllipse, double const innerFactor = 0.0);
 
+    /**
+     * Set the bound on the memory used by cached coefficients
+     *
+     * Entries are evicted (least-recently-used first) until the cache fits.  A bound of
+     * zero disables caching altogether.
+     */
+    static void setMaxCacheBytes(std::size_t maxBytes);
+
+    /// Return the bound on the memory used by cached coefficients
+    static std::size_t getMaxCacheBytes();
+
+    /// Return a snapshot of the cache usage counters
+    static CacheStatistics getCacheStatistics();
+
+    /// Reset the hit, miss and eviction counters
+    static void resetCacheStatistics();
+
+    /// Remove all entries from the cache
+    static void clearCache();
+
 private:
     // A comparison function that doesn't require equality closer than machine epsilon
     template <typename T>
@@ -78,9 +240,67 @@ private:
         bool isEqual(T x, T y) const { return ::fabs(x - y) < std::numeric_limits<T>::epsilon(); }
     };
 
-    typedef std::map<float, PTR(CoeffT), FuzzyCompare<float> > CoeffMap;
-    typedef std::map<float, CoeffMap, FuzzyCompare<float> > CoeffMapMap;
-    SincCoeffs() : _cache(){};
+    // Cache key: outer major axis, inner radius factor, axis ratio and position angle of an annulus,
+    // and the sub-pixel shift applied to its coefficients.  Circular apertures have an axis ratio of
+    // one and a position angle of zero; unshifted coefficients have nShift == 0.
+    struct CacheKey {
+        CacheKey(float radius_, float innerFactor_, float axisRatio_ = 1.0, float theta_ = 0.0,
+                 int nShift_ = 0, int shiftX_ = 0, int shiftY_ = 0, std::string const& warpingKernel_ = "")
+                : radius(radius_),
+                  innerFactor(innerFactor_),
+                  axisRatio(axisRatio_),
+                  theta(theta_),
+                  nShift(nShift_),
+                  shiftX(shiftX_),
+                  shiftY(shiftY_),
+                  warpingKernel(warpingKernel_) {}
+
+        float radius;
+        float innerFactor;
+        float axisRatio;
+        float theta;
+        int nShift;
+        int shiftX;
+        int shiftY;
+        std::string warpingKernel;
+    };
+
+    struct CacheKeyCompare {
+        bool operator()(CacheKey const& x, CacheKey const& y) const {
+            FuzzyCompare<float> compare;
+            if (!compare.isEqual(x.radius, y.radius)) {
+                return compare(x.radius, y.radius);
+            }
+            if (!compare.isEqual(x.innerFactor, y.innerFactor)) {
+                return compare(x.innerFactor, y.innerFactor);
+            }
+            if (!compare.isEqual(x.axisRatio, y.axisRatio)) {
+                return compare(x.axisRatio, y.axisRatio);
+            }
+            if (!compare.isEqual(x.theta, y.theta)) {
+                return compare(x.theta, y.theta);
+            }
+            return std::tie(x.nShift, x.shiftX, x.shiftY, x.warpingKernel) <
+                   std::tie(y.nShift, y.shiftX, y.shiftY, y.warpingKernel);
+        }
+    };
+
+    struct CacheEntry {
+        CacheEntry(PTR(CoeffT) coeff_, std::size_t bytes_, std::uint64_t lastUsed_)
+                : coeff(coeff_), bytes(bytes_), lastUsed(lastUsed_) {}
+
+        PTR(CoeffT) coeff;
+        std::size_t bytes;
+        // Updated under the shared lock, hence atomic; only used to order evictions
+        mutable std::atomic<std::uint64_t> lastUsed;
+    };
+
+    typedef std::map<CacheKey, CacheEntry, CacheKeyCompare> CoeffMap;
+
+    // A memory-mapped coefficient file
+    class Store;
+
+    SincCoeffs();
     SincCoeffs(SincCoeffs const&);      // unimplemented: singleton
     void operator=(SincCoeffs const&);  // unimplemented: singleton
 
@@ -94,7 +314,29 @@ private:
     PTR(CoeffT const)
     _lookup(afw::geom::ellipses::Axes const& outerEllipse, double const innerRadiusFactor = 0.0) const;
 
-    CoeffMapMap _cache;  //< Cache of coefficients
+    // Search the cache for coefficients with the given key; null if not cached
+    PTR(CoeffT const) _find(CacheKey const& key) const;
+
+    // Search the stores for coefficients with the given key, adding them to the cache if doCache;
+    // null if not found
+    PTR(CoeffT) _load(CacheKey const& key, bool doCache);
+
+    // Insert coefficients into the cache and evict entries to respect the memory bound
+    void _insert(CacheKey const& key, PTR(CoeffT) coeff);
+
+    // Evict least-recently-used entries until the cache fits; caller must hold _mutex exclusively
+    void _evict();
+
+    mutable std::shared_timed_mutex _mutex;     //< Guards _cache, _bytes, _maxBytes and _stores
+    CoeffMap _cache;                            //< Cache of coefficients
+    std::size_t _bytes;                         //< Memory used by cached coefficients
+    std::size_t _maxBytes;                      //< Bound on _bytes
+    std::vector<std::shared_ptr<Store const>> _stores;  //< Stores consulted on a miss, in order
+    mutable std::atomic<std::uint64_t> _clock;  //< Source of lastUsed stamps
+    mutable std::atomic<std::size_t> _hits;
+    mutable std::atomic<std::size_t> _misses;
+    std::atomic<std::size_t> _loads;
+    std::atomic<std::size_t> _evictions;
 };
 
 }  // namespace base
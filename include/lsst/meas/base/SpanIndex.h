@@ -0,0 +1,92 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_BASE_SpanIndex_h_INCLUDED
+#define LSST_MEAS_BASE_SpanIndex_h_INCLUDED
+
+#include <memory>
+#include <vector>
+
+#include "lsst/geom/Point.h"
+#include "lsst/afw/geom/SpanSet.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  A row index of a SpanSet, for testing whether it contains points in logarithmic time.
+ *
+ *  SpanSet::contains scans all the spans; the index instead records, for each row of the bounding box,
+ *  the range of the (sorted and merged) spans on that row, and bisects them.  Building the index costs
+ *  about as much as one scan, so it only pays off for large SpanSets that are queried more than once,
+ *  such as the Footprint of a big parent checked by several centroiders: use get() to share an index
+ *  between the calls for the same SpanSet.
+ */
+class SpanIndex {
+public:
+    /// SpanSets with fewer spans than this are not worth indexing; see containsPoint.
+    static std::size_t const MIN_INDEXED_SPANS = 16;
+
+    /// Build the index of a SpanSet.
+    explicit SpanIndex(afw::geom::SpanSet const& spans);
+
+    SpanIndex(SpanIndex const&) = default;
+    SpanIndex(SpanIndex&&) = default;
+    SpanIndex& operator=(SpanIndex const&) = default;
+    SpanIndex& operator=(SpanIndex&&) = default;
+    ~SpanIndex() = default;
+
+    /// Return true if the SpanSet contains the given pixel.
+    bool contains(geom::Point2I const& point) const;
+
+    /**
+     *  Return the index of a SpanSet, building it if it is not among the few most recently indexed on
+     *  this thread.
+     *
+     *  The cache holds weak references, so it does not extend the lifetime of the SpanSets, and is per
+     *  thread, so it needs no locking.  SpanSets are immutable, so an index never becomes stale.
+     */
+    static std::shared_ptr<SpanIndex const> get(std::shared_ptr<afw::geom::SpanSet const> const& spans);
+
+private:
+    int _minY;
+    // The spans of row y are those in [_rowBegin[y - _minY], _rowBegin[y - _minY + 1]).
+    std::vector<std::size_t> _rowBegin;
+    std::vector<int> _minX;
+    std::vector<int> _maxX;
+};
+
+/**
+ *  Return true if a SpanSet contains the given pixel.
+ *
+ *  Large SpanSets are tested with their (shared, cached) SpanIndex, small ones with SpanSet::contains.
+ */
+bool containsPoint(std::shared_ptr<afw::geom::SpanSet const> const& spans, geom::Point2I const& point);
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_SpanIndex_h_INCLUDED
@@ -0,0 +1,179 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_MEAS_BASE_SpanKernels_h_INCLUDED
+#define LSST_MEAS_BASE_SpanKernels_h_INCLUDED
+
+#include "ndarray.h"
+
+#include "lsst/afw/geom/SpanSet.h"
+#include "lsst/afw/image/Image.h"
+#include "lsst/afw/image/Mask.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  Kernels over runs of consecutive pixels.
+ *
+ *  The sums are accumulated in several independent double-precision lanes so that the compiler can
+ *  vectorize the loops; results may therefore differ from a sequential sum in the last few bits.
+ */
+namespace spanKernels {
+
+/// Number of independent accumulators used by the row kernels.
+int const N_LANES = 4;
+
+/// Return the sum of a[i]*b[i] for 0 <= i < n.
+template <typename T, typename U>
+inline double dotRow(T const* a, U const* b, int n) {
+    int const nBlocked = n - n % N_LANES;
+    double sum[N_LANES] = {0.0, 0.0, 0.0, 0.0};
+    for (int i = 0; i < nBlocked; i += N_LANES) {
+        for (int k = 0; k < N_LANES; ++k) {
+            sum[k] += static_cast<double>(a[i + k]) * b[i + k];
+        }
+    }
+    for (int i = nBlocked; i < n; ++i) {
+        sum[0] += static_cast<double>(a[i]) * b[i];
+    }
+    return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+
+/// Return the sum of a[i]*(b[i] - a[i]) for 0 <= i < n; exactly zero where the two runs are equal.
+template <typename T, typename U>
+inline double dotResidualRow(T const* a, U const* b, int n) {
+    int const nBlocked = n - n % N_LANES;
+    double sum[N_LANES] = {0.0, 0.0, 0.0, 0.0};
+    for (int i = 0; i < nBlocked; i += N_LANES) {
+        for (int k = 0; k < N_LANES; ++k) {
+            sum[k] += static_cast<double>(a[i + k]) * (static_cast<double>(b[i + k]) - a[i + k]);
+        }
+    }
+    for (int i = nBlocked; i < n; ++i) {
+        sum[0] += static_cast<double>(a[i]) * (static_cast<double>(b[i]) - a[i]);
+    }
+    return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+
+/// Return the sum of a[i] for 0 <= i < n.
+template <typename T>
+inline double sumRow(T const* a, int n) {
+    int const nBlocked = n - n % N_LANES;
+    double sum[N_LANES] = {0.0, 0.0, 0.0, 0.0};
+    for (int i = 0; i < nBlocked; i += N_LANES) {
+        for (int k = 0; k < N_LANES; ++k) {
+            sum[k] += a[i + k];
+        }
+    }
+    for (int i = nBlocked; i < n; ++i) {
+        sum[0] += a[i];
+    }
+    return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+
+/// Return the sum of a[i]*a[i] for 0 <= i < n.
+template <typename T>
+inline double sumSquaresRow(T const* a, int n) {
+    return dotRow(a, a, n);
+}
+
+/// Return the bitwise OR of a[i] for 0 <= i < n.
+template <typename T>
+inline T orRow(T const* a, int n) {
+    T bits = 0;
+    for (int i = 0; i < n; ++i) {
+        bits |= a[i];
+    }
+    return bits;
+}
+
+}  // namespace spanKernels
+
+/**
+ *  Return the dot product of the packed pixel values of a SpanSet (as stored by a HeavyFootprint, span
+ *  by span and in order within each span) with the pixels of an image under the same spans.
+ *
+ *  @throws pex::exceptions::LengthError if packed does not have one element per pixel of spans.
+ *  @throws pex::exceptions::OutOfRangeError if spans are not contained by the image.
+ */
+template <typename T, typename U>
+double dotSpans(afw::geom::SpanSet const& spans, ndarray::Array<T const, 1, 1> const& packed,
+                afw::image::Image<U> const& image);
+
+/**
+ *  Return the dot product of the packed pixel values of a SpanSet with the difference between the pixels
+ *  of an image under the same spans and those values.
+ *
+ *  Unlike dotSpans(spans, packed, image) - sumSquares(packed), this is exactly zero when the image holds
+ *  the packed values.
+ *
+ *  @throws pex::exceptions::LengthError if packed does not have one element per pixel of spans.
+ *  @throws pex::exceptions::OutOfRangeError if spans are not contained by the image.
+ */
+template <typename T, typename U>
+double dotResidualSpans(afw::geom::SpanSet const& spans, ndarray::Array<T const, 1, 1> const& packed,
+                        afw::image::Image<U> const& image);
+
+/// Return the sum of the squares of packed pixel values.
+template <typename T>
+double sumSquares(ndarray::Array<T const, 1, 1> const& packed);
+
+/**
+ *  Return the sum of the pixels of an image under a SpanSet.
+ *
+ *  @throws pex::exceptions::OutOfRangeError if spans are not contained by the image.
+ */
+template <typename T>
+double sumSpans(afw::geom::SpanSet const& spans, afw::image::Image<T> const& image);
+
+/// Return the union of the mask bits set under the parts of a SpanSet that lie within a mask.
+afw::image::MaskPixel orSpans(afw::geom::SpanSet const& spans,
+                              afw::image::Mask<afw::image::MaskPixel> const& mask);
+
+/**
+ *  Copy packed pixel values into an image under a SpanSet.
+ *
+ *  @throws pex::exceptions::LengthError if packed does not have one element per pixel of spans.
+ *  @throws pex::exceptions::OutOfRangeError if spans are not contained by the image.
+ */
+template <typename T>
+void insertSpans(afw::geom::SpanSet const& spans, ndarray::Array<T const, 1, 1> const& packed,
+                 afw::image::Image<T>& image);
+
+/**
+ *  Copy the pixels of an image under a SpanSet into packed storage.
+ *
+ *  @throws pex::exceptions::LengthError if packed does not have one element per pixel of spans.
+ *  @throws pex::exceptions::OutOfRangeError if spans are not contained by the image.
+ */
+template <typename T>
+void extractSpans(afw::geom::SpanSet const& spans, afw::image::Image<T> const& image,
+                  ndarray::Array<T, 1, 1> const& packed);
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_SpanKernels_h_INCLUDED
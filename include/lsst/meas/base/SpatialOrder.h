@@ -0,0 +1,77 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_BASE_SpatialOrder_h_INCLUDED
+#define LSST_MEAS_BASE_SpatialOrder_h_INCLUDED
+
+#include <cstdint>
+#include <vector>
+
+#include "lsst/geom/Point.h"
+#include "lsst/afw/table/Source.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  Return the distance along a Hilbert curve of a cell of a square grid.
+ *
+ *  @param[in] x      Column of the cell, in [0, 2^level).
+ *  @param[in] y      Row of the cell, in [0, 2^level).
+ *  @param[in] level  Number of subdivisions of the grid; in [1, 31].
+ *
+ *  Cells that are close along the curve are close on the grid, so visiting them in order of their
+ *  distance keeps consecutive cells nearby.
+ *
+ *  @throws pex::exceptions::InvalidParameterError if level is out of range, or the cell is not on the
+ *          grid.
+ */
+std::uint64_t hilbertIndex(std::uint32_t x, std::uint32_t y, int level);
+
+/**
+ *  Return the order in which to visit points so that consecutive points are close together.
+ *
+ *  The points are sorted by their distance along a Hilbert curve over a 2^level x 2^level grid
+ *  covering their bounding box; points in the same cell, and points that are not finite (which come
+ *  last), keep their relative order.
+ *
+ *  @return the indices of the points, in the order in which they should be visited.
+ */
+std::vector<std::size_t> hilbertOrder(std::vector<geom::Point2D> const& points, int level = 16);
+
+/**
+ *  Return the order in which to visit the records of a catalog so that consecutive records are close
+ *  together, as for hilbertOrder(points).
+ *
+ *  The position of each record is the center of its Footprint's bounding box, or its centroid if it has
+ *  no (or an empty) Footprint.
+ */
+std::vector<std::size_t> hilbertOrder(afw::table::SourceCatalog const& catalog, int level = 16);
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_SpatialOrder_h_INCLUDED
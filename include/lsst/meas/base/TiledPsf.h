@@ -0,0 +1,169 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2019 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_BASE_TiledPsf_h_INCLUDED
+#define LSST_MEAS_BASE_TiledPsf_h_INCLUDED
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "lsst/geom/Box.h"
+#include "lsst/geom/Point.h"
+#include "lsst/afw/detection/Psf.h"
+#include "lsst/afw/geom/ellipses/Quadrupole.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  A Psf that approximates another Psf by its model products on a coarse grid of positions.
+ *
+ *  The nodes of the grid are spaced by at most `cellSize` pixels and span the given bounding
+ *  box (usually that of the exposure being measured), including its corners.  The kernel image,
+ *  shape, bounding box and aperture fluxes of the wrapped Psf are evaluated at a node the first
+ *  time a position near it is requested, and shared by all later requests, so in crowded fields
+ *  the number of evaluations of the wrapped Psf scales with the number of grid nodes rather than
+ *  with the number of sources.  Positions outside the bounding box use the nearest edge nodes.
+ *
+ *  Products at a position are served either from the nearest node, or (if `interpolate` is set)
+ *  by bilinear interpolation between the four surrounding nodes; bounding boxes always come from
+ *  the nearest node, and kernel images are only interpolated when all four nodes have the same
+ *  bounding box.  Realized images are the kernel image shifted to the position with
+ *  Psf::recenterKernelImage.
+ *
+ *  For a node spacing h and a product f that varies smoothly across the image, the error of the
+ *  nearest-node approximation is bounded by (h/sqrt(2)) max|grad f|, and that of bilinear
+ *  interpolation by (h^2/8) (max|d^2f/dx^2| + max|d^2f/dy^2|).  Spatially constant PSFs are
+ *  reproduced exactly by either mode (up to the resampling of realized images).  Products
+ *  evaluated with a determinate color are not approximated.
+ *
+ *  As for any afw Psf, the images computed through the base class are cached without locking, so
+ *  an instance must not be evaluated by several threads at once; give each thread its own clone().
+ */
+class TiledPsf : public afw::detection::Psf {
+public:
+    /**
+     *  Construct a tiled approximation of the given Psf.
+     *
+     *  @param[in] psf          Psf model to approximate, must not be null.
+     *  @param[in] bbox         Region covered by the grid of nodes; must not be empty.
+     *  @param[in] cellSize     Maximum spacing of the nodes, in pixels; must be > 0.
+     *  @param[in] interpolate  Interpolate bilinearly between nodes, instead of using the nearest.
+     */
+    TiledPsf(std::shared_ptr<afw::detection::Psf const> psf, geom::Box2I const& bbox, int cellSize,
+             bool interpolate = false);
+
+    /// Return the Psf being approximated.
+    std::shared_ptr<afw::detection::Psf const> getWrapped() const { return _psf; }
+
+    /// Return the region covered by the grid.
+    geom::Box2I getGridBBox() const { return _bbox; }
+
+    /// Return the maximum spacing of the grid nodes.
+    int getCellSize() const { return _cellSize; }
+
+    /// Return whether products are interpolated between nodes.
+    bool getInterpolate() const { return _interpolate; }
+
+    //@{
+    /// Number of grid nodes in x and y
+    int getNodeCountX() const { return _nx; }
+    int getNodeCountY() const { return _ny; }
+    //@}
+
+    /// Return the position of a grid node.
+    geom::Point2D getNodePosition(int ix, int iy) const;
+
+    /// Return the number of evaluations of the wrapped Psf's products so far.
+    std::size_t getEvaluationCount() const;
+
+    std::shared_ptr<afw::detection::Psf> clone() const override;
+
+    std::shared_ptr<afw::detection::Psf> resized(int width, int height) const override;
+
+    geom::Point2D getAveragePosition() const override;
+
+protected:
+    std::shared_ptr<Image> doComputeImage(geom::Point2D const& position,
+                                          afw::image::Color const& color) const override;
+
+    std::shared_ptr<Image> doComputeKernelImage(geom::Point2D const& position,
+                                                afw::image::Color const& color) const override;
+
+    double doComputeApertureFlux(double radius, geom::Point2D const& position,
+                                 afw::image::Color const& color) const override;
+
+    afw::geom::ellipses::Quadrupole doComputeShape(geom::Point2D const& position,
+                                                   afw::image::Color const& color) const override;
+
+    geom::Box2I doComputeBBox(geom::Point2D const& position, afw::image::Color const& color) const override;
+
+private:
+    struct Node {
+        Node() : hasShape(false), hasBBox(false) {}
+
+        std::shared_ptr<Image> kernelImage;
+        bool hasShape;
+        afw::geom::ellipses::Quadrupole shape;
+        bool hasBBox;
+        geom::Box2I bbox;
+        std::map<double, double> apertureFlux;
+    };
+
+    // Indices and bilinear weights of the up to four nodes surrounding a position; nodes with zero
+    // weight are omitted, and only the nearest node is returned when not interpolating.
+    struct Stencil {
+        int size;
+        int nodes[4];
+        double weights[4];
+    };
+
+    Stencil _getStencil(geom::Point2D const& position, bool nearestOnly) const;
+
+    geom::Point2D _getNodePosition(int node) const { return getNodePosition(node % _nx, node / _nx); }
+
+    // Return the kernel image at a node, evaluating it if necessary.  Must be called with _mutex held.
+    std::shared_ptr<Image> _getKernelImage(int node) const;
+
+    std::shared_ptr<afw::detection::Psf const> _psf;
+    geom::Box2I _bbox;
+    int _cellSize;
+    bool _interpolate;
+    int _nx;
+    int _ny;
+    double _stepX;
+    double _stepY;
+    mutable std::mutex _mutex;
+    mutable std::vector<Node> _nodes;
+    mutable std::size_t _evaluations;
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_TiledPsf_h_INCLUDED
@@ -0,0 +1,210 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_MEAS_BASE_TraceRecorder_h_INCLUDED
+#define LSST_MEAS_BASE_TraceRecorder_h_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lsst/afw/table/Source.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  Collect timestamped begin/end events from the measurement framework and write them as a
+ *  Chrome trace, for viewing as a per-thread timeline in Perfetto or chrome://tracing.
+ *
+ *  Events are recorded into a buffer private to the calling thread, so recording from several
+ *  threads at once takes no lock (except the first time each thread records).  Each event carries
+ *  the index of the thread that recorded it (see getThreadIndex), which is the same whether it was
+ *  recorded from Python or from C++, so events from the measurement tasks and from the algorithms
+ *  they call nest on one timeline.
+ *
+ *  To keep traces of full visits small, only a fraction of the parent families are traced: a family
+ *  is sampled or not according to a hash of its top-level ID (see isSampled), so that all events of
+ *  a family, from whichever thread or language, are either kept or dropped together.
+ *
+ *  Recording must not overlap with setFamilies(), size(), clear() or writeChromeTrace().
+ */
+class TraceRecorder {
+public:
+    /**
+     *  Records an event covering the lifetime of the scope, if the source's family is sampled.
+     *
+     *  A scope given a null recorder does nothing beyond a pointer test.
+     */
+    class Scope {
+    public:
+        /**
+         *  Start an event.
+         *
+         *  @param[in] recorder  Recorder to add the event to; may be null.
+         *  @param[in] name      Name of the event, e.g. the plugin name; must outlive the scope.
+         *  @param[in] category  Category of the event, e.g. "cpp"; must outlive the scope.
+         *  @param[in] record    Source being measured; its family decides whether the event is sampled.
+         */
+        Scope(TraceRecorder* recorder, std::string const& name, char const* category,
+              afw::table::SourceRecord const& record)
+                : _recorder(recorder && recorder->isSampled(recorder->getFamilyId(record)) ? recorder
+                                                                                           : nullptr),
+                  _name(name),
+                  _category(category),
+                  _id(record.getId()),
+                  _start(_recorder ? _recorder->now() : 0) {}
+
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+
+        ~Scope() {
+            if (_recorder) {
+                _recorder->record(_name, _category, _start, _recorder->now(), _id);
+            }
+        }
+
+    private:
+        TraceRecorder* _recorder;
+        std::string const& _name;
+        char const* _category;
+        afw::table::RecordId _id;
+        std::int64_t _start;
+    };
+
+    /// A single complete (begin/end) event.
+    struct Event {
+        std::string name;         ///< name of the event
+        std::string category;     ///< category of the event
+        std::int64_t start;       ///< start time, in nanoseconds since the recorder was constructed
+        std::int64_t duration;    ///< duration, in nanoseconds
+        int thread;               ///< index of the recording thread
+        afw::table::RecordId id;  ///< ID of the source the event concerns, or 0
+    };
+
+    /**
+     *  Construct an empty recorder.
+     *
+     *  @param[in] sampleFraction  Fraction of parent families to trace, in [0, 1].
+     *
+     *  @throws pex::exceptions::InvalidParameterError if sampleFraction is outside [0, 1].
+     */
+    explicit TraceRecorder(double sampleFraction = 1.0);
+
+    TraceRecorder(TraceRecorder const&) = delete;
+    TraceRecorder& operator=(TraceRecorder const&) = delete;
+
+    ~TraceRecorder();
+
+    /// Return the fraction of parent families traced.
+    double getSampleFraction() const { return _sampleFraction; }
+
+    /**
+     *  Return whether the events of a family are recorded.
+     *
+     *  The decision depends only on the family ID and the sample fraction, so it is the same for
+     *  every event of the family and in every run.
+     */
+    bool isSampled(afw::table::RecordId familyId) const;
+
+    /**
+     *  Set the catalog whose families are being measured.
+     *
+     *  Records only know their immediate parent, so the top-level parent of every record in the catalog
+     *  is looked up here, for getFamilyId to use.  The catalog need not stay alive.
+     */
+    void setFamilies(afw::table::SourceCatalog const& catalog);
+
+    /**
+     *  Return the ID that decides whether the events of a source are sampled: that of its top-level
+     *  parent, if it has a parent.
+     *
+     *  Sources not in the catalog last passed to setFamilies are assumed to be at most one level
+     *  below the top.
+     */
+    afw::table::RecordId getFamilyId(afw::table::SourceRecord const& record) const;
+
+    /// Return a small integer that identifies the calling thread in the events it records.
+    static int getThreadIndex();
+
+    /// Return the current time, in nanoseconds since the recorder was constructed.
+    std::int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                    _origin)
+                .count();
+    }
+
+    /**
+     *  Record an event on the calling thread's timeline.
+     *
+     *  @param[in] name      Name of the event.
+     *  @param[in] category  Category of the event.
+     *  @param[in] start     Start time, as returned by now().
+     *  @param[in] end       End time, as returned by now().
+     *  @param[in] id        ID of the source the event concerns, or 0.
+     *
+     *  Sampling is the caller's responsibility (see isSampled).
+     */
+    void record(std::string const& name, std::string const& category, std::int64_t start,
+                std::int64_t end, afw::table::RecordId id = 0);
+
+    /// Return all events recorded, grouped by the thread that recorded them.
+    std::vector<Event> getEvents() const;
+
+    /// Return the number of events recorded.
+    std::size_t size() const;
+
+    /// Remove all recorded events.
+    void clear();
+
+    /**
+     *  Write the recorded events to a file in the Chrome trace event format.
+     *
+     *  @throws pex::exceptions::IoError if the file cannot be written.
+     */
+    void writeChromeTrace(std::string const& filename) const;
+
+private:
+    typedef std::vector<Event> Buffer;
+
+    // Return the buffer of the calling thread, creating it if necessary.
+    Buffer& _getBuffer();
+
+    double _sampleFraction;
+    std::uint64_t _serial;  // distinguishes this recorder in the per-thread buffer caches
+    std::chrono::steady_clock::time_point _origin;
+    mutable std::mutex _mutex;  // guards _buffers
+    std::vector<std::pair<int, std::unique_ptr<Buffer>>> _buffers;
+    std::unordered_map<afw::table::RecordId, afw::table::RecordId> _families;  // top-level parent by ID
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_TraceRecorder_h_INCLUDED
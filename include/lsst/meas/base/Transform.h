@@ -30,6 +30,10 @@
  */
 
 #include <string>
+#include <vector>
+#include "ndarray.h"
+#include "lsst/geom/Point.h"
+#include "lsst/geom/SpherePoint.h"
 #include "lsst/afw/geom.h"
 #include "lsst/afw/image.h"
 #include "lsst/afw/image/PhotoCalib.h"
@@ -82,6 +86,13 @@ namespace base {
  *  `operator()` may throw `LengthError` if the transformation is impossible
  *  to complete. In this case, the contents of `outputCatalog` is not
  *  guaranteed.
+ *
+ *  Transformations should read their inputs through column views and
+ *  transform all records at once where they can (see for example
+ *  computePixelToSkyJacobians), rather than making a separate call to the
+ *  WCS or calibration for each record.  Column views are only available for
+ *  contiguous catalogs, so they should fall back to reading records one at
+ *  a time when `isContiguous()` is false (e.g. for a subset of a catalog).
  */
 class BaseTransform {
 public:
@@ -107,6 +118,24 @@ protected:
     std::string _name;
 };
 
+/**
+ *  Compute the local linear approximation of the pixel-to-sky transform of a WCS at many positions.
+ *
+ *  The result is the same as the linear part of `wcs.linearizePixelToSky(pixel, geom::radians)` for
+ *  each position, but the WCS is called only once, for all positions and the offsets the derivatives
+ *  are computed from.
+ *
+ *  @param[in]  wcs     World coordinate system to linearize.
+ *  @param[in]  pixels  Pixel positions at which to linearize it.
+ *  @param[out] coords  If not null, set to the celestial coordinates of the positions.
+ *
+ *  @returns An array of shape (N, 2, 2) holding the Jacobian matrix (in radians per pixel) at each
+ *           position.
+ */
+ndarray::Array<double, 3, 3> computePixelToSkyJacobians(afw::geom::SkyWcs const& wcs,
+                                                        std::vector<geom::Point2D> const& pixels,
+                                                        std::vector<geom::SpherePoint>* coords = nullptr);
+
 }  // namespace base
 }  // namespace meas
 }  // namespace lsst
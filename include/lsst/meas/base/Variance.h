@@ -0,0 +1,94 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#ifndef LSST_MEAS_BASE_Variance_h_INCLUDED
+#define LSST_MEAS_BASE_Variance_h_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include "lsst/pex/config.h"
+#include "lsst/afw/image/Exposure.h"
+#include "lsst/meas/base/Algorithm.h"
+#include "lsst/meas/base/FlagHandler.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/// Configuration of VarianceAlgorithm
+class VarianceControl {
+public:
+    LSST_CONTROL_FIELD(scale, double, "Scale factor to apply to shape for aperture");
+    LSST_CONTROL_FIELD(mask, std::vector<std::string>, "Mask planes to ignore");
+
+    VarianceControl() : scale(5.0), mask({"DETECTED", "DETECTED_NEGATIVE", "BAD", "SAT"}) {}
+};
+
+/**
+ *  @brief A measurement algorithm that computes the median variance in an aperture around a source.
+ *
+ *  The aim is to measure the background variance, rather than that of the object itself, so the
+ *  aperture is the source's shape ellipse scaled up by the configured factor.  Pixels with any of the
+ *  configured mask planes set are ignored.
+ *
+ *  The badCentroid flag is an alias to the flag of the target of the centroid slot at the time the
+ *  algorithm is constructed.
+ */
+class VarianceAlgorithm : public SimpleAlgorithm {
+public:
+    static FlagDefinitionList const& getFlagDefinitions();
+    static FlagDefinition const FAILURE;
+    static FlagDefinition const EMPTY_FOOTPRINT;
+
+    typedef VarianceControl Control;
+
+    VarianceAlgorithm(Control const& ctrl, std::string const& name, afw::table::Schema& schema);
+
+    virtual void measure(afw::table::SourceRecord& measRecord,
+                         afw::image::Exposure<float> const& exposure) const;
+
+    /**
+     *  Measure a batch of records, looking up the mask planes' bitmask only once for all of them.
+     */
+    virtual void measureBatch(afw::table::SourceCatalog& measCat, afw::image::Exposure<float> const& exposure,
+                              std::vector<std::size_t> const& indices) const;
+
+    virtual void fail(afw::table::SourceRecord& measRecord, MeasurementError* error = nullptr) const;
+
+private:
+    // Return the median variance around a record.
+    double _measure(afw::table::SourceRecord const& measRecord, afw::image::Exposure<float> const& exposure,
+                    afw::image::MaskPixel badMask) const;
+
+    Control _ctrl;
+    afw::table::Key<double> _valueKey;
+    FlagHandler _flagHandler;
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_Variance_h_INCLUDED
@@ -24,6 +24,8 @@
 #ifndef LSST_MEAS_BASE_constants_h_INCLUDED
 #define LSST_MEAS_BASE_constants_h_INCLUDED
 
+#include <string>
+
 #include "Eigen/Core"
 
 #include "lsst/pex/exceptions.h"
@@ -46,6 +48,27 @@ enum UncertaintyEnum {
     FULL_COVARIANCE = 2  ///< The full covariance matrix is provided
 };
 
+/**
+ *  @brief Return the UncertaintyEnum value with the given name.
+ *
+ *  This allows algorithms to expose the amount of uncertainty information they compute as a string
+ *  Control field ("NO_UNCERTAINTY", "SIGMA_ONLY" or "FULL_COVARIANCE").
+ *
+ *  @throws pex::exceptions::InvalidParameterError  if the name is not one of the above.
+ */
+inline UncertaintyEnum makeUncertaintyEnum(std::string const& name) {
+    if (name == "NO_UNCERTAINTY") {
+        return NO_UNCERTAINTY;
+    } else if (name == "SIGMA_ONLY") {
+        return SIGMA_ONLY;
+    } else if (name == "FULL_COVARIANCE") {
+        return FULL_COVARIANCE;
+    }
+    throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                      "Unknown uncertainty '" + name +
+                              "'; expected NO_UNCERTAINTY, SIGMA_ONLY or FULL_COVARIANCE");
+}
+
 //@{ Typedefs that define the C++ types we typically use for common measurements
 typedef int ElementCount;
 typedef double Flux;
@@ -76,7 +76,8 @@ typename std::enable_if<std::is_abstract<Algorithm>::value, void>::type declareA
  * Wrap the implicit API used by meas_base's algorithms.
  *
  * This function only initializes constructors, fields, and methods common to
- * all Algorithms.
+ * all Algorithms.  `measure` releases the GIL, so algorithms must be safe to
+ * call concurrently on distinct records (see BaseAlgorithm).
  *
  * @tparam Algorithm The algorithm class.
  * @tparam PyAlg The `pybind11::class_` class corresponding to `Algorithm`.
@@ -94,7 +95,8 @@ void declareAlgorithm(PyAlg &clsAlgorithm) {
 
     /* Members */
     clsAlgorithm.def("fail", &Algorithm::fail, "measRecord"_a, "error"_a = NULL);
-    clsAlgorithm.def("measure", &Algorithm::measure, "record"_a, "exposure"_a);
+    clsAlgorithm.def("measure", &Algorithm::measure, "record"_a, "exposure"_a,
+                     py::call_guard<py::gil_scoped_release>());
 }
 
 /**
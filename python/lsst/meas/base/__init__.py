@@ -26,25 +26,46 @@ from lsst.afw.geom import SkyWcs
 
 from .flagHandler import *
 from .centroidUtilities import *
+from .fluxKernelBackend import *
 from .fluxUtilities import *
 from .inputUtilities import *
 from .shapeUtilities import *
 from .algorithm import *
 from .apertureFlux import *
 from .blendedness import *
+from .cachingPsf import *
 from .circularApertureFlux import *
+from .counterBasedNoise import *
+from .ellipticalApertureFlux import *
 from .exceptions import *
+from .footprintTransformer import *
+from .fpPosition import *
 from .gaussianFlux import *
+from .jacobian import *
 from .localBackground import *
+from .localPhotoCalib import *
+from .localWcs import *
 from .naiveCentroid import *
+from .noiseReplacementEngine import *
 from .peakLikelihoodFlux import *
 from .pixelFlags import *
+from .pluginChain import *
+from .preconditions import *
 from .psfFlux import *
+from .referenceTransform import *
 from .scaledApertureFlux import *
+from .sceneRealizer import *
+from .scratchArena import *
 from .sdssCentroid import *
 from .sdssShape import *
 from .sincCoeffs import *
+from .spanIndex import *
+from .spanKernels import *
+from .spatialOrder import *
+from .tiledPsf import *
+from .traceRecorder import *
 from .transform import *
+from .variance import *
 
 from .apCorrRegistry import *
 from .applyApCorr import *
@@ -61,6 +82,7 @@ from .noiseReplacer import *
 from .pluginRegistry import *
 from .plugins import *
 from .pluginsBase import *
+from .pluginTiming import *
 from .references import *
 from .sfm import *
 from .transforms import *
@@ -21,6 +21,7 @@
  */
 
 #include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
 
 #include "lsst/afw/table/Source.h"
 #include "lsst/meas/base/Algorithm.h"
@@ -36,6 +37,13 @@ PYBIND11_MODULE(algorithm, mod) {
     py::module::import("lsst.afw.image");
     py::module::import("lsst.afw.table");
 
+    py::class_<MeasurementStatus> clsMeasurementStatus(mod, "MeasurementStatus");
+    clsMeasurementStatus.def(py::init<>());
+    clsMeasurementStatus.def("isSuccess", &MeasurementStatus::isSuccess);
+    clsMeasurementStatus.def("__bool__", &MeasurementStatus::isSuccess);
+    clsMeasurementStatus.def("getFlagNumber", &MeasurementStatus::getFlagNumber);
+    clsMeasurementStatus.def("getMessage", &MeasurementStatus::getMessage);
+
     py::class_<BaseAlgorithm, std::shared_ptr<BaseAlgorithm>> clsBaseAlgorithm(mod, "BaseAlgorithm");
     py::class_<SingleFrameAlgorithm, std::shared_ptr<SingleFrameAlgorithm>, BaseAlgorithm>
             clsSingleFrameAlgorithm(mod, "SingleFrameAlgorithm");
@@ -44,11 +52,62 @@ PYBIND11_MODULE(algorithm, mod) {
 
     clsBaseAlgorithm.def("fail", &BaseAlgorithm::fail, "measRecord"_a, "error"_a = NULL);
     clsBaseAlgorithm.def("getLogName", &SimpleAlgorithm::getLogName);
+    clsBaseAlgorithm.def("enableTiming", &BaseAlgorithm::enableTiming, "enable"_a);
+    clsBaseAlgorithm.def("isTimingEnabled", &BaseAlgorithm::isTimingEnabled);
+    clsBaseAlgorithm.def("getTimingSeconds", &BaseAlgorithm::getTimingSeconds);
+    clsBaseAlgorithm.def("getTimingCalls", &BaseAlgorithm::getTimingCalls);
+    clsBaseAlgorithm.def("enableTracing", &BaseAlgorithm::enableTracing, "recorder"_a, "name"_a = "");
+    clsBaseAlgorithm.def("isTracingEnabled", &BaseAlgorithm::isTracingEnabled);
 
-    clsSingleFrameAlgorithm.def("measure", &SingleFrameAlgorithm::measure, "record"_a, "exposure"_a);
+    clsSingleFrameAlgorithm.def("measure", &SingleFrameAlgorithm::measure, "record"_a, "exposure"_a,
+                                py::call_guard<py::gil_scoped_release>());
+    clsSingleFrameAlgorithm.def("tryMeasure", &SingleFrameAlgorithm::tryMeasure, "record"_a, "exposure"_a,
+                                py::call_guard<py::gil_scoped_release>());
+    clsSingleFrameAlgorithm.def("measureN", &SingleFrameAlgorithm::measureN, "measCat"_a, "exposure"_a,
+                                py::call_guard<py::gil_scoped_release>());
+    clsSingleFrameAlgorithm.def("measureBatch", &SingleFrameAlgorithm::measureBatch, "measCat"_a,
+                                "exposure"_a, "indices"_a, py::call_guard<py::gil_scoped_release>());
+    clsSingleFrameAlgorithm.def("measureTimed",
+                                [](SingleFrameAlgorithm const& self, afw::table::SourceRecord& record,
+                                   afw::image::Exposure<float> const& exposure) {
+                                    BaseAlgorithm::ScopedTimer timer(self);
+                                    TraceRecorder::Scope trace(self.getTraceRecorder(), self.getTraceName(),
+                                                               "cpp", record);
+                                    self.measure(record, exposure);
+                                },
+                                "record"_a, "exposure"_a, py::call_guard<py::gil_scoped_release>());
+    clsSingleFrameAlgorithm.def("measureBatchTimed",
+                                [](SingleFrameAlgorithm const& self, afw::table::SourceCatalog& measCat,
+                                   afw::image::Exposure<float> const& exposure,
+                                   std::vector<std::size_t> const& indices) {
+                                    BaseAlgorithm::ScopedTimer timer(self, indices.size());
+                                    if (indices.empty()) {
+                                        self.measureBatch(measCat, exposure, indices);
+                                        return;
+                                    }
+                                    // The batch is traced as one event, sampled by its first source.
+                                    TraceRecorder::Scope trace(self.getTraceRecorder(), self.getTraceName(),
+                                                               "cpp", measCat[indices.front()]);
+                                    self.measureBatch(measCat, exposure, indices);
+                                },
+                                "measCat"_a, "exposure"_a, "indices"_a,
+                                py::call_guard<py::gil_scoped_release>());
 
     clsSimpleAlgorithm.def("measureForced", &SimpleAlgorithm::measureForced, "measRecord"_a, "exposure"_a,
-                           "refRecord"_a, "refWcs"_a);
+                           "refRecord"_a, "refWcs"_a, py::call_guard<py::gil_scoped_release>());
+    clsSimpleAlgorithm.def("measureNForced", &SimpleAlgorithm::measureNForced, "measCat"_a, "exposure"_a,
+                           "refCat"_a, "refWcs"_a, py::call_guard<py::gil_scoped_release>());
+    clsSimpleAlgorithm.def("measureForcedTimed",
+                           [](SimpleAlgorithm const& self, afw::table::SourceRecord& measRecord,
+                              afw::image::Exposure<float> const& exposure,
+                              afw::table::SourceRecord const& refRecord, afw::geom::SkyWcs const& refWcs) {
+                               BaseAlgorithm::ScopedTimer timer(self);
+                               TraceRecorder::Scope trace(self.getTraceRecorder(), self.getTraceName(), "cpp",
+                                                          measRecord);
+                               self.measureForced(measRecord, exposure, refRecord, refWcs);
+                           },
+                           "measRecord"_a, "exposure"_a, "refRecord"_a, "refWcs"_a,
+                           py::call_guard<py::gil_scoped_release>());
 }
 
 }  // namespace base
@@ -52,7 +52,10 @@ PyFluxControl declareFluxControl(py::module &mod) {
 
     LSST_DECLARE_CONTROL_FIELD(cls, ApertureFluxControl, radii);
     LSST_DECLARE_CONTROL_FIELD(cls, ApertureFluxControl, maxSincRadius);
+    LSST_DECLARE_CONTROL_FIELD(cls, ApertureFluxControl, maxExactRadius);
     LSST_DECLARE_CONTROL_FIELD(cls, ApertureFluxControl, shiftKernel);
+    LSST_DECLARE_CONTROL_FIELD(cls, ApertureFluxControl, shiftBankSize);
+    LSST_DECLARE_CONTROL_FIELD(cls, ApertureFluxControl, ellipticalCacheTolerance);
 
     cls.def(py::init<>());
 
@@ -72,10 +75,23 @@ void declareComputeFluxes(PyClass &cls) {
                    (Result(*)(Image const &, afw::geom::ellipses::Ellipse const &, Control const &)) &
                            ApertureFluxAlgorithm::computeNaiveFlux,
                    "image"_a, "ellipse"_a, "ctrl"_a = Control());
+    cls.def_static("computeExactFlux",
+                   (Result(*)(Image const &, afw::geom::ellipses::Ellipse const &, Control const &)) &
+                           ApertureFluxAlgorithm::computeExactFlux,
+                   "image"_a, "ellipse"_a, "ctrl"_a = Control());
     cls.def_static("computeFlux",
                    (Result(*)(Image const &, afw::geom::ellipses::Ellipse const &, Control const &)) &
                            ApertureFluxAlgorithm::computeFlux,
                    "image"_a, "ellipse"_a, "ctrl"_a = Control());
+    cls.def_static("computeFluxes",
+                   (std::vector<Result>(*)(Image const &, geom::Point2D const &, Control const &)) &
+                           ApertureFluxAlgorithm::computeFluxes,
+                   "image"_a, "center"_a, "ctrl"_a = Control());
+    cls.def_static("computeScaledFluxes",
+                   (std::vector<Result>(*)(Image const &, afw::geom::ellipses::Ellipse const &,
+                                           std::vector<double> const &, Control const &)) &
+                           ApertureFluxAlgorithm::computeScaledFluxes,
+                   "image"_a, "ellipse"_a, "scales"_a, "ctrl"_a = Control());
 }
 
 PyFluxAlgorithm declareFluxAlgorithm(py::module &mod) {
@@ -84,6 +100,7 @@ PyFluxAlgorithm declareFluxAlgorithm(py::module &mod) {
     cls.attr("FAILURE") = py::cast(ApertureFluxAlgorithm::FAILURE);
     cls.attr("APERTURE_TRUNCATED") = py::cast(ApertureFluxAlgorithm::APERTURE_TRUNCATED);
     cls.attr("SINC_COEFFS_TRUNCATED") = py::cast(ApertureFluxAlgorithm::SINC_COEFFS_TRUNCATED);
+    cls.attr("SINC_COEFFS_APPROXIMATE") = py::cast(ApertureFluxAlgorithm::SINC_COEFFS_APPROXIMATE);
 
     // constructor not wrapped because class is abstract
 
@@ -92,7 +109,8 @@ PyFluxAlgorithm declareFluxAlgorithm(py::module &mod) {
     declareComputeFluxes<afw::image::Image<float>>(cls);
     declareComputeFluxes<afw::image::MaskedImage<float>>(cls);
 
-    cls.def("measure", &ApertureFluxAlgorithm::measure, "measRecord"_a, "exposure"_a);
+    cls.def("measure", &ApertureFluxAlgorithm::measure, "measRecord"_a, "exposure"_a,
+            py::call_guard<py::gil_scoped_release>());
     cls.def("fail", &ApertureFluxAlgorithm::fail, "measRecord"_a, "error"_a = nullptr);
     cls.def_static("makeFieldPrefix", &ApertureFluxAlgorithm::makeFieldPrefix, "name"_a, "radius"_a);
 
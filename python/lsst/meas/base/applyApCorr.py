@@ -23,6 +23,7 @@ import math
 
 import numpy as np
 
+import lsst.geom
 import lsst.pex.config
 import lsst.pex.exceptions
 import lsst.afw.image
@@ -183,6 +184,13 @@ class ApplyApCorrConfig(lsst.pex.config.Config):
         itemtype=str,
         default={},
     )
+    chunkSize = lsst.pex.config.RangeField(
+        doc="Number of sources to aperture correct at once, to bound the memory used for the "
+            "evaluated corrections on large catalogs; 0 to correct the whole catalog at once",
+        dtype=int,
+        default=0,
+        min=0,
+    )
 
 
 class ApplyApCorrTask(lsst.pipe.base.Task):
@@ -241,14 +249,145 @@ class ApplyApCorrTask(lsst.pipe.base.Task):
         else:
             self.log.debug("Use complex instFlux sigma computation that double-counts photon noise "
                            "and thus over-estimates instFlux uncertainty")
+        if not catalog.isContiguous():
+            self.log.debug("Catalog is not contiguous; aperture correcting source by source")
+            self._runPerSource(catalog, apCorrMap)
+            return
+
+        apCorrInfos = []
+        for apCorrInfo in self.apCorrInfoDict.values():
+            apCorrModel = apCorrMap.get(apCorrInfo.modelName)
+            apCorrErrModel = apCorrMap.get(apCorrInfo.modelSigmaName)
+            if None in (apCorrModel, apCorrErrModel):
+                self._warnMissing(apCorrInfo, apCorrModel, apCorrErrModel)
+                catalog[apCorrInfo.apCorrFlagKey] = True
+                continue
+            apCorrInfos.append(apCorrInfo)
+
+        chunkSize = self.config.chunkSize if self.config.chunkSize > 0 else max(len(catalog), 1)
+        for start in range(0, len(catalog), chunkSize):
+            chunk = catalog[start:start + chunkSize]
+            centroidKey = chunk.getCentroidSlot().getMeasKey()
+            x = chunk[centroidKey.getX()]
+            y = chunk[centroidKey.getY()]
+            evaluated = {}  # model name: (values, mask of successful evaluations)
+
+            def evaluate(name):
+                """Evaluate an aperture correction model at all positions in
+                the chunk, only once for all the fluxes that use it.
+                """
+                if name not in evaluated:
+                    evaluated[name] = self._evaluate(apCorrMap[name], x, y)
+                return evaluated[name]
+
+            for apCorrInfo in apCorrInfos:
+                apCorr, isGood = evaluate(apCorrInfo.modelName)
+                apCorrErr = np.zeros(len(chunk))
+                if not UseNaiveFluxErr:
+                    apCorrErr, isGoodErr = evaluate(apCorrInfo.modelSigmaName)
+                    isGood = isGood & isGoodErr
+                self._apply(chunk, apCorrInfo, apCorr, apCorrErr, isGood)
+
+        if self.log.getLevel() <= self.log.DEBUG:
+            for apCorrInfo in apCorrInfos:
+                self._logStatistics(catalog, apCorrInfo)
+
+    @staticmethod
+    def _evaluate(model, x, y):
+        """Evaluate an aperture correction model at many positions.
+
+        Parameters
+        ----------
+        model : `lsst.afw.math.BoundedField`
+            Aperture correction model.
+        x, y : `numpy.ndarray`
+            Positions at which to evaluate it.
+
+        Returns
+        -------
+        values : `numpy.ndarray`
+            Evaluated model; undefined where it could not be evaluated.
+        isGood : `numpy.ndarray` of `bool`
+            Whether the model could be evaluated at each position.
+        """
+        try:
+            return np.asarray(model.evaluate(x, y), dtype=np.float64), np.ones(len(x), dtype=bool)
+        except lsst.pex.exceptions.DomainError:
+            pass
+        # At least one position is outside the model's domain: find out which, one at a time.
+        values = np.ones(len(x), dtype=np.float64)
+        isGood = np.ones(len(x), dtype=bool)
+        for i, point in enumerate(zip(x, y)):
+            try:
+                values[i] = model.evaluate(lsst.geom.Point2D(*point))
+            except lsst.pex.exceptions.DomainError:
+                isGood[i] = False
+        return values, isGood
+
+    def _apply(self, catalog, apCorrInfo, apCorr, apCorrErr, isGood):
+        """Apply evaluated aperture corrections to one flux of a contiguous
+        catalog.
+
+        Parameters
+        ----------
+        catalog : `lsst.afw.table.SourceCatalog`
+            Contiguous catalog of sources. Will be updated in place.
+        apCorrInfo : `ApCorrInfo`
+            The flux to correct.
+        apCorr, apCorrErr : `numpy.ndarray`
+            Aperture correction and its error for each source.
+        isGood : `numpy.ndarray` of `bool`
+            Whether the aperture correction could be evaluated for each
+            source.
+        """
+        if apCorrInfo.doApCorrColumn:
+            catalog[apCorrInfo.apCorrKey] = np.where(isGood, apCorr, catalog[apCorrInfo.apCorrKey])
+            catalog[apCorrInfo.apCorrErrKey] = np.where(isGood, apCorrErr, catalog[apCorrInfo.apCorrErrKey])
+        isGood = isGood & (apCorr > 0.0) & (apCorrErr >= 0.0)
+
+        instFlux = catalog[apCorrInfo.instFluxKey]
+        instFluxErr = catalog[apCorrInfo.instFluxErrKey]
+        if UseNaiveFluxErr:
+            newInstFluxErr = instFluxErr*apCorr
+        else:
+            with np.errstate(divide="ignore", invalid="ignore"):
+                a = instFluxErr/instFlux
+                b = apCorrErr/apCorr
+                newInstFluxErr = np.abs(instFlux*apCorr)*np.sqrt(a*a + b*b)
+        catalog[apCorrInfo.instFluxErrKey] = np.where(isGood, newInstFluxErr, instFluxErr)
+        catalog[apCorrInfo.instFluxKey] = np.where(isGood, instFlux*apCorr, instFlux)
+        catalog[apCorrInfo.apCorrFlagKey] = ~isGood
+        if self.config.doFlagApCorrFailures:
+            oldFluxFlagState = catalog[apCorrInfo.fluxFlagKey]
+            catalog[apCorrInfo.fluxFlagKey] = np.where(isGood, oldFluxFlagState, True)
+
+    def _warnMissing(self, apCorrInfo, apCorrModel, apCorrErrModel):
+        """Log that an aperture correction model is missing.
+        """
+        missingNames = [(apCorrInfo.modelName, apCorrInfo.modelSigmaName)[i]
+                        for i, model in enumerate((apCorrModel, apCorrErrModel)) if model is None]
+        self.log.warn("Cannot aperture correct %s because could not find %s in apCorrMap" %
+                      (apCorrInfo.name, " or ".join(missingNames),))
+
+    def _logStatistics(self, catalog, apCorrInfo):
+        """Log statistics on the effects of aperture correction.
+        """
+        apCorrArr = np.array([s.get(apCorrInfo.apCorrKey) for s in catalog])
+        apCorrErrArr = np.array([s.get(apCorrInfo.apCorrErrKey) for s in catalog])
+        self.log.debug("For instFlux field %r: mean apCorr=%s, stdDev apCorr=%s, "
+                       "mean apCorrErr=%s, stdDev apCorrErr=%s for %s sources",
+                       apCorrInfo.name, apCorrArr.mean(), apCorrArr.std(),
+                       apCorrErrArr.mean(), apCorrErrArr.std(), len(catalog))
+
+    def _runPerSource(self, catalog, apCorrMap):
+        """Apply aperture corrections one source at a time, for catalogs that
+        are not contiguous.
+        """
         for apCorrInfo in self.apCorrInfoDict.values():
             apCorrModel = apCorrMap.get(apCorrInfo.modelName)
             apCorrErrModel = apCorrMap.get(apCorrInfo.modelSigmaName)
             if None in (apCorrModel, apCorrErrModel):
-                missingNames = [(apCorrInfo.modelName, apCorrInfo.modelSigmaName)[i]
-                                for i, model in enumerate((apCorrModel, apCorrErrModel)) if model is None]
-                self.log.warn("Cannot aperture correct %s because could not find %s in apCorrMap" %
-                              (apCorrInfo.name, " or ".join(missingNames),))
+                self._warnMissing(apCorrInfo, apCorrModel, apCorrErrModel)
                 for source in catalog:
                     source.set(apCorrInfo.apCorrFlagKey, True)
                 continue
@@ -292,10 +431,4 @@ class ApplyApCorrTask(lsst.pipe.base.Task):
                     source.set(apCorrInfo.fluxFlagKey, oldFluxFlagState)
 
             if self.log.getLevel() <= self.log.DEBUG:
-                # log statistics on the effects of aperture correction
-                apCorrArr = np.array([s.get(apCorrInfo.apCorrKey) for s in catalog])
-                apCorrErrArr = np.array([s.get(apCorrInfo.apCorrErrKey) for s in catalog])
-                self.log.debug("For instFlux field %r: mean apCorr=%s, stdDev apCorr=%s, "
-                               "mean apCorrErr=%s, stdDev apCorrErr=%s for %s sources",
-                               apCorrInfo.name, apCorrArr.mean(), apCorrArr.std(),
-                               apCorrErrArr.mean(), apCorrErrArr.std(), len(catalog))
+                self._logStatistics(catalog, apCorrInfo)
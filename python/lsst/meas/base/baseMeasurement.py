@@ -23,13 +23,30 @@
 measurement tasks.
 """
 
+import collections
+import contextlib
+import math
+import queue
+import time
+import weakref
+
+import lsst.geom
+import lsst.afw.detection
+import lsst.afw.table
 import lsst.pipe.base
 import lsst.pex.config
 
+from .cachingPsf import CachingPsf
+from .tiledPsf import TiledPsf
 from .pluginRegistry import PluginMap
+from .spatialOrder import hilbertOrder
+from .pluginChain import PluginChain
+from .preconditions import Preconditions, SourceConditions
 from .exceptions import FatalAlgorithmError, MeasurementError
 from .pluginsBase import BasePluginConfig, BasePlugin
 from .noiseReplacer import NoiseReplacerConfig
+from .pluginTiming import PluginTimer
+from .traceRecorder import TraceRecorder
 
 __all__ = ("BaseMeasurementPluginConfig", "BaseMeasurementPlugin",
            "BaseMeasurementConfig", "BaseMeasurementTask")
@@ -38,6 +55,41 @@ __all__ = ("BaseMeasurementPluginConfig", "BaseMeasurementPlugin",
 FATAL_EXCEPTIONS = (MemoryError, FatalAlgorithmError)
 
 
+class PsfClonePool:
+    """A fixed set of clones of a PSF model, lent to worker threads one at a
+    time.
+
+    Parameters
+    ----------
+    psf : `lsst.afw.detection.Psf` or `None`
+        PSF model to clone.  If `None`, `borrow` yields `None`.
+    size : `int`
+        Number of clones; at most this many threads may hold one at once.
+
+    Notes
+    -----
+    afw PSF models cache the last image they computed without any locking,
+    so a single instance may not be evaluated by several threads at once.
+    The clones are all made by the constructing thread, before any worker
+    starts using the PSF.
+    """
+
+    def __init__(self, psf, size):
+        self._clones = queue.Queue()
+        for _ in range(size):
+            self._clones.put(None if psf is None else psf.clone())
+
+    @contextlib.contextmanager
+    def borrow(self):
+        """Lend a clone to the calling thread for the duration of a block.
+        """
+        psf = self._clones.get()
+        try:
+            yield psf
+        finally:
+            self._clones.put(psf)
+
+
 class BaseMeasurementPluginConfig(BasePluginConfig):
     """Base config class for all measurement plugins.
 
@@ -175,6 +227,92 @@ class BaseMeasurementConfig(lsst.pex.config.Config):
         dtype=str, default="undeblended_",
         doc="Prefix to give undeblended plugins"
     )
+    doCachePsf = lsst.pex.config.Field(
+        dtype=bool, default=False,
+        doc="Share PSF model evaluations (image, kernel, shape, ...) at the same position between "
+            "plugins, by attaching a CachingPsf to the exposure while measuring?  Plugins then see "
+            "a CachingPsf rather than the exposure's own Psf type."
+    )
+    psfCacheSize = lsst.pex.config.RangeField(
+        dtype=int, default=8, min=1,
+        doc="Number of distinct positions whose PSF model products are retained when doCachePsf is set"
+    )
+    psfGridCellSize = lsst.pex.config.RangeField(
+        dtype=int, default=0, min=0,
+        doc="If > 0, approximate the PSF while measuring by its model products on a grid of nodes spaced "
+            "by at most this many pixels (see TiledPsf), so they are evaluated once per node rather than "
+            "once per source"
+    )
+    psfGridInterpolate = lsst.pex.config.Field(
+        dtype=bool, default=True,
+        doc="When psfGridCellSize > 0, interpolate PSF model products bilinearly between grid nodes "
+            "instead of using those of the nearest node?"
+    )
+    doTiming = lsst.pex.config.Field(
+        dtype=bool, default=False,
+        doc="Record the wall-clock time, call count and failure count of each plugin (and the time spent "
+            "in its compiled code) in the task's algMetadata?"
+    )
+    doPluginChain = lsst.pex.config.Field(
+        dtype=bool, default=False,
+        doc="Run each run of consecutive plugins that wrap C++ algorithms with a single call into C++ per "
+            "source, instead of one call per plugin?  Ignored while plugins are being timed or traced."
+    )
+    doPreconditions = lsst.pex.config.Field(
+        dtype=bool, default=False,
+        doc="Check the conditions plugins declare a source must satisfy for them to measure it (see "
+            "BasePlugin.getPreconditions) once per source, and fail the plugins whose conditions do not "
+            "hold instead of running them?  Their outputs other than flags are then left unset.  "
+            "Preconditions are not evaluated when sources are measured in batches (i.e. without noise "
+            "replacement, through measureBatch)."
+    )
+    preconditionBadMaskPlanes = lsst.pex.config.ListField(
+        dtype=str, default=["BAD", "SAT", "NO_DATA"],
+        doc="When doPreconditions is set, mask planes of the pixels that do not count as good for the "
+            "good-pixel fraction precondition"
+    )
+    doTimingHistogram = lsst.pex.config.Field(
+        dtype=bool, default=False,
+        doc="When doTiming is set, also record a histogram of the time taken for each source by each plugin?"
+    )
+    timingSlowSourceCount = lsst.pex.config.RangeField(
+        dtype=int, default=0, min=0,
+        doc="When doTiming is set, number of the slowest calls of a plugin on a single source to record, "
+            "with the source's footprint area and bounding box and the plugin's iteration count, in the "
+            "task's algMetadata (see measurementInvestigationLib.rerunSlowSources)"
+    )
+    traceFile = lsst.pex.config.Field(
+        dtype=str, default=None, optional=True,
+        doc="If set, record begin/end events for each parent family, noise replacement, source and plugin "
+            "(and the compiled code of C++ plugins), with the thread that ran them, and write them to "
+            "this file in the Chrome trace format (viewable in Perfetto) at the end of each run.  "
+            "Plugins are not chained while tracing."
+    )
+    traceSampleFraction = lsst.pex.config.RangeField(
+        dtype=float, default=1.0, min=0.0, max=1.0,
+        doc="When traceFile is set, fraction of parent families whose events are recorded"
+    )
+    sourceOrder = lsst.pex.config.ChoiceField(
+        dtype=str, default="catalog",
+        allowed={
+            "catalog": "Measure parent families in catalog order",
+            "hilbert": "Measure parent families (and pass sources to measureBatch) in order along a "
+                       "Hilbert curve over their footprint centers, so that consecutive sources share "
+                       "image rows and PSF and sinc coefficient cache entries; results are unchanged",
+        },
+        doc="Order in which sources are measured"
+    )
+    parallelTileSize = lsst.pex.config.RangeField(
+        dtype=int, default=1024, min=1,
+        doc="Size (pixels) of the square tiles parent families are grouped into by runTiled, and by "
+            "SingleFrameMeasurementTask when numThreads > 1"
+    )
+    parallelBorder = lsst.pex.config.RangeField(
+        dtype=int, default=100, min=0,
+        doc="Padding (pixels) around each tile's footprints included in the pixels read for it by "
+            "runTiled, or in its copy of the image when numThreads > 1; should cover the largest "
+            "aperture measured"
+    )
 
     def validate(self):
         lsst.pex.config.Config.validate(self)
@@ -228,8 +366,23 @@ class BaseMeasurementTask(lsst.pipe.base.Task):
     the output catalog. Will be filled by subclasses.
     """
 
+    timer = None
+    """Timing of the plugins while measuring, if enabled (`PluginTimer`).
+
+    Set only within a `pluginTiming` block.
+    """
+
+    tracer = None
+    """Recorder of trace events while measuring, if enabled (`TraceRecorder`).
+
+    Set only within a `pluginTracing` block.
+    """
+
     def __init__(self, algMetadata=None, **kwds):
         super(BaseMeasurementTask, self).__init__(**kwds)
+        self._measureSteps = None
+        self._preconditions = None
+        self._preconditionBadBits = None
         self.plugins = PluginMap()
         self.undeblendedPlugins = PluginMap()
         if algMetadata is None:
@@ -286,6 +439,291 @@ class BaseMeasurementTask(lsst.pipe.base.Task):
             self.undeblendedPlugins[name] = PluginClass(config, undeblendedName, metadata=self.algMetadata,
                                                         **kwds)
 
+    @contextlib.contextmanager
+    def cachedPsf(self, exposure):
+        """Attach a `CachingPsf` to an exposure for the duration of a block.
+
+        Parameters
+        ----------
+        exposure : `lsst.afw.image.Exposure`
+            Exposure whose PSF model should be cached. Its original PSF is
+            restored when the block exits, even if an exception is raised.
+
+        Notes
+        -----
+        If ``config.psfGridCellSize`` is positive, the PSF is first replaced
+        by a `TiledPsf` covering the exposure, which is then cached if
+        ``config.doCachePsf`` is set.  Does nothing if neither is enabled, if
+        the exposure has no PSF, or if its PSF is already a `CachingPsf` or
+        `TiledPsf`.
+        """
+        psf = exposure.getPsf()
+        useGrid = self.config.psfGridCellSize > 0
+        if ((not self.config.doCachePsf and not useGrid) or psf is None or
+                isinstance(psf, (CachingPsf, TiledPsf))):
+            yield
+            return
+        measPsf = psf
+        if useGrid:
+            measPsf = TiledPsf(measPsf, exposure.getBBox(), self.config.psfGridCellSize,
+                               self.config.psfGridInterpolate)
+        if self.config.doCachePsf:
+            measPsf = CachingPsf(measPsf, self.config.psfCacheSize)
+        exposure.setPsf(measPsf)
+        try:
+            yield
+        finally:
+            exposure.setPsf(psf)
+
+    def getSourceOrder(self, catalog, indices=None):
+        """Return the order in which to measure the records of a catalog.
+
+        Parameters
+        ----------
+        catalog : `lsst.afw.table.SourceCatalog`
+            Catalog of the records to be measured.
+        indices : iterable of `int`, optional
+            Indices of the records to be measured; all of them if `None`.
+
+        Returns
+        -------
+        order : `list` of `int`
+            The indices, in catalog order, or, if ``config.sourceOrder`` is
+            ``"hilbert"``, in order along a Hilbert curve over the centers of
+            the records' footprints (see `hilbertOrder`).
+        """
+        indices = list(range(len(catalog)) if indices is None else indices)
+        if self.config.sourceOrder != "hilbert" or len(indices) < 3:
+            return indices
+        if len(indices) == len(catalog) and indices == list(range(len(catalog))):
+            subset = catalog
+        else:
+            subset = lsst.afw.table.SourceCatalog(catalog.getTable())
+            for index in indices:
+                subset.append(catalog[index])
+        return [indices[i] for i in hilbertOrder(subset)]
+
+    def makeTiles(self, measParentCat, bbox, tileSize=None, halo=None, parentIndices=None):
+        """Group parent families into square spatial tiles.
+
+        Parameters
+        ----------
+        measParentCat : `lsst.afw.table.SourceCatalog`
+            Parent (top-level) sources, with footprints attached.
+        bbox : `lsst.geom.Box2I`
+            Bounding box of the full image; tile boxes are clipped to it.
+        tileSize : `int`, optional
+            Size of the tiles in pixels; ``config.parallelTileSize`` if
+            `None`.
+        halo : `int`, optional
+            Padding around each tile's footprints; ``config.parallelBorder``
+            if `None`.
+        parentIndices : iterable of `int`, optional
+            Indices into ``measParentCat`` of the families to group; all of
+            them if `None`.
+
+        Returns
+        -------
+        tiles : `list` of `lsst.pipe.base.Struct`
+            One entry per non-empty tile, with fields:
+
+            ``parentIndices``
+                Indices into ``measParentCat`` of the families in the tile
+                (`list` of `int`).
+            ``bbox``
+                Pixels needed to measure them: the union of their footprint
+                bounding boxes, grown by ``halo`` and clipped to ``bbox``
+                (`lsst.geom.Box2I`).
+
+        Notes
+        -----
+        Each family is assigned to exactly one tile, the one containing the
+        center of its parent footprint's bounding box, so families crossing a
+        tile boundary are measured once, in full.
+        """
+        if tileSize is None:
+            tileSize = self.config.parallelTileSize
+        if halo is None:
+            halo = self.config.parallelBorder
+        if parentIndices is None:
+            parentIndices = range(len(measParentCat))
+        tiles = collections.OrderedDict()
+        for parentIdx in parentIndices:
+            measParentRecord = measParentCat[parentIdx]
+            footprintBBox = measParentRecord.getFootprint().getBBox()
+            center = lsst.geom.Box2D(footprintBBox).getCenter()
+            key = (int(center.getX()//tileSize), int(center.getY()//tileSize))
+            tile = tiles.get(key)
+            if tile is None:
+                tile = lsst.pipe.base.Struct(parentIndices=[], bbox=lsst.geom.Box2I())
+                tiles[key] = tile
+            tile.parentIndices.append(parentIdx)
+            tile.bbox.include(footprintBBox)
+        for tile in tiles.values():
+            tile.bbox.grow(halo)
+            tile.bbox.clip(bbox)
+        return list(tiles.values())
+
+    @staticmethod
+    def makeTileFootprints(footprints, ownIds, bbox):
+        """Select the footprints a `NoiseReplacer` needs to measure one tile.
+
+        Parameters
+        ----------
+        footprints : `dict`
+            Mapping of source ID to (parent ID,
+            `~lsst.afw.detection.Footprint`) for all sources in the image.
+        ownIds : `set` of `int`
+            IDs of the sources measured in the tile.
+        bbox : `lsst.geom.Box2I`
+            Pixels available to the tile.
+
+        Returns
+        -------
+        tileFootprints : `dict`
+            The entries of ``footprints`` for ``ownIds``, plus those of all
+            other parents that overlap ``bbox``.  Those neighbors only need to
+            be covered with noise, so they are clipped, non-heavy copies.
+        """
+        tileFootprints = {}
+        for sourceId, (parentId, footprint) in footprints.items():
+            if sourceId in ownIds:
+                tileFootprints[sourceId] = (parentId, footprint)
+            elif parentId == 0 and footprint.getBBox().overlaps(bbox):
+                spans = footprint.getSpans().clippedTo(bbox)
+                if spans.getArea() > 0:
+                    tileFootprints[sourceId] = (0, lsst.afw.detection.Footprint(spans, bbox))
+        return tileFootprints
+
+    def needsDetectionMasks(self, beginOrder=None, endOrder=None):
+        """Return whether any plugin that will run reads the detection mask
+        planes.
+
+        Parameters
+        ----------
+        beginOrder : `float`, optional
+            Beginning execution order (inclusive) of the plugins to consider;
+            `None` for no limit.
+        endOrder : `float`, optional
+            Ending execution order (exclusive) of the plugins to consider;
+            `None` for no limit.
+
+        Returns
+        -------
+        needed : `bool`
+            Whether the noise replacer should maintain the ``THISDET`` and
+            ``OTHERDET`` mask planes (see `BasePlugin.needsDetectionMasks`).
+        """
+        for plugin in self.plugins.values():
+            if beginOrder is not None and plugin.getExecutionOrder() < beginOrder:
+                continue
+            if endOrder is not None and plugin.getExecutionOrder() >= endOrder:
+                continue
+            if plugin.needsDetectionMasks():
+                return True
+        return False
+
+    @contextlib.contextmanager
+    def pluginTiming(self):
+        """Time the plugins for the duration of a block.
+
+        Notes
+        -----
+        Does nothing if ``config.doTiming`` is `False`, or if plugins are
+        already being timed by an enclosing block.  Otherwise, every call
+        made through `doMeasurement` and `doMeasurementN` is timed, plugins
+        are asked to time their compiled code, and the results are written to
+        ``self.algMetadata`` (see `PluginTimer.writeMetadata`) when the block
+        exits.
+        """
+        if not self.config.doTiming or self.timer is not None:
+            yield
+            return
+        plugins = list(self.plugins.values()) + list(self.undeblendedPlugins.values())
+        self.timer = PluginTimer(doHistogram=self.config.doTimingHistogram,
+                                 nSlowest=self.config.timingSlowSourceCount)
+        for plugin in plugins:
+            plugin.enableTiming(True)
+        try:
+            yield
+        finally:
+            self.timer.writeMetadata(self.algMetadata, plugins)
+            for plugin in plugins:
+                plugin.enableTiming(False)
+            self.timer = None
+
+    @contextlib.contextmanager
+    def pluginTracing(self):
+        """Trace the measurement for the duration of a block.
+
+        Notes
+        -----
+        Does nothing if ``config.traceFile`` is `None`, or if measurement is
+        already being traced by an enclosing block.  Otherwise, the families,
+        noise replacements, sources and plugin calls of sampled families are
+        recorded (see `TraceRecorder`), plugins are asked to trace their
+        compiled code, and the events are written to ``config.traceFile``
+        when the block exits.
+        """
+        if self.config.traceFile is None or self.tracer is not None:
+            yield
+            return
+        plugins = list(self.plugins.values()) + list(self.undeblendedPlugins.values())
+        self.tracer = TraceRecorder(self.config.traceSampleFraction)
+        for plugin in plugins:
+            plugin.enableTracing(self.tracer)
+        try:
+            yield
+        finally:
+            for plugin in plugins:
+                plugin.enableTracing(None)
+            tracer, self.tracer = self.tracer, None
+            tracer.writeChromeTrace(self.config.traceFile)
+            self.log.info("Wrote %d trace events to %s", len(tracer), self.config.traceFile)
+
+    def _traceFamilies(self, catalog):
+        """Give the tracer, if any, the catalog whose families are about to
+        be measured, so sources are sampled by their top-level parent.
+        """
+        if self.tracer is not None:
+            self.tracer.setFamilies(catalog)
+
+    def _traceStart(self, record):
+        """Return the time at which a traced event concerning a source
+        starts, or `None` if the source's family is not sampled.
+        """
+        if not self.tracer.isSampled(self.tracer.getFamilyId(record)):
+            return None
+        return self.tracer.now()
+
+    def _traceEnd(self, name, category, start, record):
+        """Record a traced event started by `_traceStart`.
+        """
+        if start is not None:
+            self.tracer.record(name, category, start, self.tracer.now(), record.getId())
+
+    def _insertSource(self, noiseReplacer, id, traced):
+        """Insert a source with a noise replacer, tracing the insertion if
+        ``traced`` is set, and return the image to measure it on.
+        """
+        if not traced:
+            return noiseReplacer.insertSource(id)
+        start = self.tracer.now()
+        measExposure = noiseReplacer.insertSource(id)
+        self.tracer.record("insertSource", "noise", start, self.tracer.now(), id)
+        return measExposure
+
+    def _removeSource(self, noiseReplacer, id, traced):
+        """Remove a source with a noise replacer, tracing the removal if
+        ``traced`` is set.
+        """
+        if not traced:
+            noiseReplacer.removeSource(id)
+            return
+        start = self.tracer.now()
+        noiseReplacer.removeSource(id)
+        self.tracer.record("removeSource", "noise", start, self.tracer.now(), id)
+
     def callMeasure(self, measRecord, *args, **kwds):
         """Call ``measure`` on all plugins and consistently handle exceptions.
 
@@ -297,7 +735,7 @@ class BaseMeasurementTask(lsst.pipe.base.Task):
         *args
             Positional arguments forwarded to ``plugin.measure``
         **kwds
-            Keyword arguments. Two are handled locally:
+            Keyword arguments. Three are handled locally:
 
             beginOrder : `int`
                 Beginning execution order (inclusive). Measurements with
@@ -309,6 +747,10 @@ class BaseMeasurementTask(lsst.pipe.base.Task):
                 ``executionOrder`` >= ``endOrder`` are not executed. `None`
                 for no limit.
 
+            exclude : container of `str`
+                Names of plugins not to run, e.g. because they have already
+                measured all sources in a batch.
+
             Others are forwarded to ``plugin.measure()``.
 
         Notes
@@ -318,17 +760,164 @@ class BaseMeasurementTask(lsst.pipe.base.Task):
         Subsequent positional arguments and keyword arguments are forwarded
         directly to the plugin.
 
+        If ``config.doPluginChain`` is set, consecutive plugins that wrap C++
+        algorithms are run by a `PluginChain`, with the same results and
+        exception handling but a single call into C++ (see
+        `doMeasurementChain`).
+
+        If ``config.doPreconditions`` is set, plugins whose preconditions (see
+        `BasePlugin.getPreconditions`) do not hold are failed instead of
+        being run; the first positional argument must then be the exposure.
+        The conditions are evaluated at most once per source for all the
+        plugins run from Python, and once per `PluginChain`.
+
         This method should be considered "protected": it is intended for use by
         derived classes, not users.
         """
         beginOrder = kwds.pop("beginOrder", None)
         endOrder = kwds.pop("endOrder", None)
-        for plugin in self.plugins.iter():
-            if beginOrder is not None and plugin.getExecutionOrder() < beginOrder:
+        exclude = kwds.pop("exclude", ())
+        preconditions = self._getPreconditions()
+        conditions = None
+        traceStart = self._traceStart(measRecord) if self.tracer is not None else None
+        if self.config.doPluginChain and self.timer is None and self.tracer is None and not kwds:
+            steps = self._getMeasureSteps()
+        else:
+            steps = self.plugins.iter()
+        for step in steps:
+            if isinstance(step, PluginChain):
+                if beginOrder is not None and step.getMaxExecutionOrder() < beginOrder:
+                    continue
+                if endOrder is not None and step.getMinExecutionOrder() >= endOrder:
+                    break
+                self.doMeasurementChain(step, measRecord, *args,
+                                        beginOrder=-math.inf if beginOrder is None else beginOrder,
+                                        endOrder=math.inf if endOrder is None else endOrder)
                 continue
-            if endOrder is not None and plugin.getExecutionOrder() >= endOrder:
+            if beginOrder is not None and step.getExecutionOrder() < beginOrder:
+                continue
+            if endOrder is not None and step.getExecutionOrder() >= endOrder:
                 break
-            self.doMeasurement(plugin, measRecord, *args, **kwds)
+            if step.name in exclude:
+                continue
+            stepPreconditions = preconditions.get(step.name)
+            if stepPreconditions is not None:
+                if conditions is None:
+                    conditions = self._makeSourceConditions(measRecord, args[0])
+                if not self._applyPreconditions(step, stepPreconditions, conditions, measRecord):
+                    continue
+            self.doMeasurement(step, measRecord, *args, **kwds)
+        if traceStart is not None:
+            self._traceEnd("source", "source", traceStart, measRecord)
+
+    def _getPreconditions(self):
+        """Return a `dict` of the non-empty preconditions of the plugins, by
+        plugin name, or an empty `dict` if ``config.doPreconditions`` is not
+        set.
+        """
+        if not self.config.doPreconditions:
+            return {}
+        plugins = tuple(self.plugins.iter())
+        if self._preconditions is None or self._preconditions[0] != plugins:
+            preconditions = {}
+            for plugin in plugins:
+                pluginPreconditions = plugin.getPreconditions()
+                if pluginPreconditions is not None and not pluginPreconditions.empty():
+                    preconditions[plugin.name] = pluginPreconditions
+            self._preconditions = (plugins, preconditions)
+        return self._preconditions[1]
+
+    def _makeSourceConditions(self, measRecord, exposure):
+        """Return the `SourceConditions` with which to check the
+        preconditions of the plugins on a source.
+
+        The bits of the bad mask planes are looked up only once per exposure.
+        """
+        badBits = 0
+        if any(p.isRequired(Preconditions.GOOD_PIXELS) for p in self._getPreconditions().values()):
+            if self._preconditionBadBits is None or self._preconditionBadBits[0]() is not exposure:
+                badBits = exposure.getMaskedImage().getMask().getPlaneBitMask(
+                    self.config.preconditionBadMaskPlanes)
+                self._preconditionBadBits = (weakref.ref(exposure), badBits)
+            badBits = self._preconditionBadBits[1]
+        return SourceConditions(measRecord, exposure, badBits)
+
+    def _applyPreconditions(self, plugin, preconditions, conditions, measRecord):
+        """Check the preconditions of a plugin, calling its ``fail`` method if
+        one of them does not hold.
+
+        Returns
+        -------
+        measure : `bool`
+            Whether the conditions hold and the plugin should be run.
+        """
+        failed = conditions.check(preconditions)
+        if failed == Preconditions.NONE:
+            return True
+        message = "%s precondition not satisfied" % Preconditions.getConditionName(failed)
+        lsst.log.Log.getLogger(self.getPluginLogName(plugin.name)).debug(
+            "Skipping %s.measure on record %s: %s" % (plugin.name, measRecord.getId(), message))
+        flagBit = preconditions.getFlagBit(failed)
+        plugin.fail(measRecord, MeasurementError(message, flagBit) if flagBit >= 0 else None)
+        return False
+
+    def _getMeasureSteps(self):
+        """Return the plugins to run in single-object mode, with runs of
+        chainable plugins replaced by `PluginChain` objects.
+
+        The result is rebuilt whenever the set of plugins to be run changes.
+        """
+        plugins = tuple(self.plugins.iter())
+        key = (plugins, self.config.doPreconditions)
+        if self._measureSteps is None or self._measureSteps[0] != key:
+            preconditions = self._getPreconditions()
+            steps = []
+            chain = self._makeChain()
+            for plugin in plugins:
+                if plugin.addToChain(chain):
+                    # Report failures to the same log as doMeasurement would.
+                    chain.setLogName(len(chain) - 1, self.getPluginLogName(plugin.name))
+                    if plugin.name in preconditions:
+                        chain.setPreconditions(len(chain) - 1, preconditions[plugin.name])
+                    continue
+                if len(chain):
+                    steps.append(chain)
+                    chain = self._makeChain()
+                steps.append(plugin)
+            if len(chain):
+                steps.append(chain)
+            self._measureSteps = (key, steps)
+        return self._measureSteps[1]
+
+    def _makeChain(self):
+        """Return an empty `PluginChain` configured like the task.
+        """
+        chain = PluginChain()
+        chain.setBadMaskPlanes(list(self.config.preconditionBadMaskPlanes))
+        return chain
+
+    def doMeasurementChain(self, chain, measRecord, *args, **kwds):
+        """Run a `PluginChain` of single-frame algorithms on a record.
+
+        Parameters
+        ----------
+        chain : `lsst.meas.base.PluginChain`
+            Chain of algorithms to run.  Exceptions raised by the algorithms
+            are handled by the chain, in the same way as `doMeasurement`.
+        measRecord : `lsst.afw.table.SourceRecord`
+            The record corresponding to the object being measured. Will be
+            updated in-place with the results of measurement.
+        *args
+            Positional arguments forwarded to ``chain.measure()``.
+        **kwds
+            Keyword arguments forwarded to ``chain.measure()``.
+
+        Notes
+        -----
+        Derived classes whose plugins have a different signature should
+        override this method.
+        """
+        chain.measure(measRecord, *args, **kwds)
 
     def doMeasurement(self, plugin, measRecord, *args, **kwds):
         """Call ``measure`` on the specified plugin.
@@ -357,8 +946,14 @@ class BaseMeasurementTask(lsst.pipe.base.Task):
         This method should be considered "protected": it is intended for use by
         derived classes, not users.
         """
+        timer = self.timer
+        if timer is not None:
+            start = time.perf_counter()
+        traceStart = self._traceStart(measRecord) if self.tracer is not None else None
+        failed = True
         try:
             plugin.measure(measRecord, *args, **kwds)
+            failed = False
         except FATAL_EXCEPTIONS:
             raise
         except MeasurementError as error:
@@ -371,6 +966,11 @@ class BaseMeasurementTask(lsst.pipe.base.Task):
                 "Exception in %s.measure on record %s: %s"
                 % (plugin.name, measRecord.getId(), error))
             plugin.fail(measRecord)
+        if timer is not None:
+            timer.record(plugin.name, time.perf_counter() - start, nFailures=int(failed),
+                         measRecord=measRecord)
+        if traceStart is not None:
+            self._traceEnd(plugin.name, "plugin", traceStart, measRecord)
 
     def callMeasureN(self, measCat, *args, **kwds):
         """Call ``measureN`` on all plugins and consistently handle exceptions.
@@ -442,8 +1042,14 @@ class BaseMeasurementTask(lsst.pipe.base.Task):
         This method should be considered "protected": it is intended for use by
         derived classes, not users.
         """
+        timer = self.timer
+        if timer is not None:
+            start = time.perf_counter()
+        traceStart = self._traceStart(measCat[0]) if self.tracer is not None and len(measCat) else None
+        failed = True
         try:
             plugin.measureN(measCat, *args, **kwds)
+            failed = False
         except FATAL_EXCEPTIONS:
             raise
 
@@ -459,3 +1065,8 @@ class BaseMeasurementTask(lsst.pipe.base.Task):
                 lsst.log.Log.getLogger(self.getPluginLogName(plugin.name)).debug(
                     "Exception in %s.measureN on records %s-%s: %s"
                     % (plugin.name, measCat[0].getId(), measCat[-1].getId(), error))
+        if timer is not None:
+            timer.record(plugin.name, time.perf_counter() - start, nSources=len(measCat),
+                         nFailures=len(measCat) if failed else 0)
+        if traceStart is not None:
+            self._traceEnd(plugin.name, "plugin", traceStart, measCat[0])
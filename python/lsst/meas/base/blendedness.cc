@@ -21,8 +21,10 @@
  */
 
 #include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
 
 #include <memory>
+#include <vector>
 
 #include "lsst/pex/config/python.h"
 #include "lsst/meas/base/python.h"
@@ -58,6 +60,10 @@ PyBlendenessControl declareBlendednessControl(py::module &mod) {
 PyBlendenessAlgorithm declareBlendednessAlgorithm(py::module &mod) {
     PyBlendenessAlgorithm cls(mod, "BlendednessAlgorithm");
 
+    // Opaque: only passed from captureChildPixels to measureCapturedPixels.
+    py::class_<BlendednessAlgorithm::ChildPixels, std::shared_ptr<BlendednessAlgorithm::ChildPixels>>(
+            cls, "ChildPixels");
+
     cls.def(py::init<BlendednessAlgorithm::Control const &, std::string const &, afw::table::Schema &>(),
             "ctrl"_a, "name"_a, "schema"_a);
 
@@ -68,10 +74,25 @@ PyBlendenessAlgorithm declareBlendednessAlgorithm(py::module &mod) {
     cls.def_static("computeAbsExpectation", &BlendednessAlgorithm::computeAbsExpectation, "data"_a,
                    "variance"_a);
     cls.def_static("computeAbsBias", &BlendednessAlgorithm::computeAbsBias, "mu"_a, "variance"_a);
-    cls.def("measureChildPixels", &BlendednessAlgorithm::measureChildPixels, "image"_a, "child"_a);
-    cls.def("measureParentPixels", &BlendednessAlgorithm::measureParentPixels, "image"_a, "child"_a);
-    cls.def("measure", &BlendednessAlgorithm::measure, "measRecord"_a, "exposure"_a);
-    cls.def("fail", &BlendednessAlgorithm::measure, "measRecord"_a, "error"_a = nullptr);
+    cls.def("measureChildPixels", &BlendednessAlgorithm::measureChildPixels, "image"_a, "child"_a,
+            py::call_guard<py::gil_scoped_release>());
+    cls.def("measureParentPixels", &BlendednessAlgorithm::measureParentPixels, "image"_a, "child"_a,
+            py::call_guard<py::gil_scoped_release>());
+    cls.def("captureChildPixels", &BlendednessAlgorithm::captureChildPixels, "image"_a, "child"_a,
+            py::call_guard<py::gil_scoped_release>());
+    cls.def("measureCapturedPixels",
+            [](BlendednessAlgorithm const &self, afw::image::MaskedImage<float> const &image,
+               afw::table::SourceCatalog &catalog,
+               std::vector<std::shared_ptr<BlendednessAlgorithm::ChildPixels>> const &childPixels) {
+                std::vector<std::shared_ptr<BlendednessAlgorithm::ChildPixels const>> constPixels(
+                        childPixels.begin(), childPixels.end());
+                py::gil_scoped_release release;
+                self.measureCapturedPixels(image, catalog, constPixels);
+            },
+            "image"_a, "catalog"_a, "childPixels"_a);
+    cls.def("measure", &BlendednessAlgorithm::measure, "measRecord"_a, "exposure"_a,
+            py::call_guard<py::gil_scoped_release>());
+    cls.def("fail", &BlendednessAlgorithm::fail, "measRecord"_a, "error"_a = nullptr);
 
     return cls;
 }
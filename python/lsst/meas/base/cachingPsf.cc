@@ -0,0 +1,50 @@
+/*
+ * LSST Data Management System
+ * Copyright 2008-2017  AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "pybind11/pybind11.h"
+
+#include "lsst/meas/base/CachingPsf.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+PYBIND11_MODULE(cachingPsf, mod) {
+    py::module::import("lsst.afw.detection");
+
+    py::class_<CachingPsf, std::shared_ptr<CachingPsf>, afw::detection::Psf> cls(mod, "CachingPsf");
+
+    cls.def(py::init<std::shared_ptr<afw::detection::Psf const>, std::size_t>(), "psf"_a, "capacity"_a = 8);
+
+    cls.def("getWrapped", &CachingPsf::getWrapped);
+    cls.def("getCapacity", &CachingPsf::getCapacity);
+    cls.def("clearCache", &CachingPsf::clearCache);
+    cls.def("getHitCount", &CachingPsf::getHitCount);
+    cls.def("getMissCount", &CachingPsf::getMissCount);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
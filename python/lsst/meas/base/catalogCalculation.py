@@ -73,6 +73,11 @@ class CatalogCalculationPlugin(BasePlugin):
     plugin is of type ``"multi"``, the `fail` method must be implemented to
     accept the whole catalog. If the plugin is of type ``"single"``, `fail`
     should accept a single source record.
+
+    A plugin of type ``"columnar"`` is a ``"single"`` plugin that also
+    implements `calculateColumns` and `failColumns`, which operate on whole
+    columns of a contiguous catalog at once; `calculate` and `fail` are used
+    when the catalog is not contiguous.
     """
 
     def __init__(self, config, name, schema, metadata):
@@ -115,6 +120,33 @@ class CatalogCalculationPlugin(BasePlugin):
         """
         raise NotImplementedError()
 
+    def calculateColumns(self, catalog):
+        """Perform the calculation on all the records of a catalog at once.
+
+        Only called for plugins of type ``"columnar"``.
+
+        Parameters
+        ----------
+        catalog : `lsst.afw.table.SourceCatalog`
+            Contiguous catalog, whose columns may be read and assigned as
+            arrays. Must be updated exactly as calling `calculate` on each
+            record would.
+        """
+        raise NotImplementedError()
+
+    def failColumns(self, catalog, error=None):
+        """Record a failure of `calculateColumns` on every record.
+
+        Parameters
+        ----------
+        catalog : `lsst.afw.table.SourceCatalog`
+            Catalog passed to `calculateColumns`.
+        error : `MeasurementError`, optional
+            The error raised by `calculateColumns`.
+        """
+        for measRecord in catalog:
+            self.fail(measRecord, error)
+
 
 class CCContext:
     """Handle errors that are thrown by catalog calculation plugins.
@@ -131,11 +163,15 @@ class CCContext:
     log : `lsst.log.Log`
         A logger. Generally, this should be the logger of the object in which
         the context manager is being used.
+    fail : callable, optional
+        Called with ``cat`` and the error on `MeasurementError`; defaults to
+        ``plugin.fail``.
     """
-    def __init__(self, plugin, cat, log):
+    def __init__(self, plugin, cat, log, fail=None):
         self.plugin = plugin
         self.cat = cat
         self.log = log
+        self.failMethod = plugin.fail if fail is None else fail
 
     def __enter__(self):
         return
@@ -146,7 +182,7 @@ class CCContext:
         if exc_type in FATAL_EXCEPTIONS:
             raise exc_value
         elif exc_type is MeasurementError:
-            self.plugin.fail(self.cat, exc_value)
+            self.failMethod(self.cat, exc_value)
         else:
             self.log.warn("Error in {}.calculate: {}".format(self.plugin.name, exc_value))
         return True
@@ -204,7 +240,7 @@ class CatalogCalculationTask(lsst.pipe.base.Task):
         """Initialize the plugins according to the configuration.
         """
 
-        pluginType = namedtuple('pluginType', 'single multi')
+        pluginType = namedtuple('pluginType', 'single multi columnar')
         self.executionDict = {}
         # Read the properties for each plugin. Allocate a dictionary entry for each run level. Verify that
         # the plugins are above the minimum run level for an catalogCalculation plugin. For each run level,
@@ -212,7 +248,7 @@ class CatalogCalculationTask(lsst.pipe.base.Task):
         # appropriately
         for executionOrder, name, config, PluginClass in sorted(self.config.plugins.apply()):
             if executionOrder not in self.executionDict:
-                self.executionDict[executionOrder] = pluginType(single=[], multi=[])
+                self.executionDict[executionOrder] = pluginType(single=[], multi=[], columnar=[])
             if PluginClass.getExecutionOrder() >= BasePlugin.DEFAULT_CATALOGCALCULATION:
                 plug = PluginClass(config, name, self.schema, metadata=self.plugMetadata)
                 self.plugins[name] = plug
@@ -220,6 +256,8 @@ class CatalogCalculationTask(lsst.pipe.base.Task):
                     self.executionDict[executionOrder].single.append(plug)
                 elif plug.plugType == 'multi':
                     self.executionDict[executionOrder].multi.append(plug)
+                elif plug.plugType == 'columnar':
+                    self.executionDict[executionOrder].columnar.append(plug)
             else:
                 errorTuple = (PluginClass, PluginClass.getExecutionOrder(),
                               BasePlugin.DEFAULT_CATALOGCALCULATION)
@@ -245,13 +283,25 @@ class CatalogCalculationTask(lsst.pipe.base.Task):
         catalog : `lsst.afw.table.SourceCatalog`
             The catalog on which the plugins will operate.
         """
+        contiguous = catalog.isContiguous()
         for runlevel in sorted(self.executionDict):
             # Run all of the plugins which take a whole catalog first
             for plug in self.executionDict[runlevel].multi:
                 with CCContext(plug, catalog, self.log):
                     plug.calculate(catalog)
+            # Then the columnar plugins, which fall back to running record by
+            # record if the catalog's columns cannot be accessed as arrays
+            singlePlugins = list(self.executionDict[runlevel].single)
+            if contiguous:
+                for plug in self.executionDict[runlevel].columnar:
+                    with CCContext(plug, catalog, self.log, fail=plug.failColumns):
+                        plug.calculateColumns(catalog)
+            else:
+                singlePlugins += self.executionDict[runlevel].columnar
             # Run all the plugins which take single catalog entries
+            if not singlePlugins:
+                continue
             for measRecord in catalog:
-                for plug in self.executionDict[runlevel].single:
+                for plug in singlePlugins:
                     with CCContext(plug, measRecord, self.log):
                         plug.calculate(measRecord)
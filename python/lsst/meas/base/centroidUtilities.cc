@@ -115,6 +115,8 @@ void declareUncertaintyEnum(py::module &mod) {
     enm.value("NO_UNCERTAINTY", UncertaintyEnum::NO_UNCERTAINTY);
     enm.value("SIGMA_ONLY", UncertaintyEnum::SIGMA_ONLY);
     enm.value("FULL_COVARIANCE", UncertaintyEnum::FULL_COVARIANCE);
+
+    mod.def("makeUncertaintyEnum", &makeUncertaintyEnum, "name"_a);
 }
 
 }  // namespace
@@ -50,7 +50,8 @@ PYBIND11_MODULE(circularApertureFlux, mod) {
                      afw::table::Schema &, daf::base::PropertySet &>(),
             "ctrl"_a, "name"_a, "schema"_a, "metadata"_a);
 
-    cls.def("measure", &CircularApertureFluxAlgorithm::measure, "measRecord"_a, "exposure"_a);
+    cls.def("measure", &CircularApertureFluxAlgorithm::measure, "measRecord"_a, "exposure"_a,
+            py::call_guard<py::gil_scoped_release>());
 }
 
 }  // namespace base
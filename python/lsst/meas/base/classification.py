@@ -65,6 +65,8 @@ class CatalogCalculationClassificationPlugin(CatalogCalculationPlugin):
 
     ConfigClass = CatalogCalculationClassificationConfig
 
+    plugType = "columnar"
+
     @classmethod
     def getExecutionOrder(cls):
         return cls.DEFAULT_CATALOGCALCULATION
@@ -100,5 +102,30 @@ class CatalogCalculationClassificationPlugin(CatalogCalculationPlugin):
         else:
             measRecord.set(self.keyProbability, 0.0 if flux1 < flux2 else 1.0)
 
+    def calculateColumns(self, catalog):
+        table = catalog.getTable()
+        modelSlot = table.getModelFluxSlot()
+        psfSlot = table.getPsfFluxSlot()
+        modelFlux = catalog[modelSlot.getMeasKey()]
+        psfFlux = catalog[psfSlot.getMeasKey()]
+        bad = np.zeros(len(catalog), dtype=bool)
+        for slot in (modelSlot, psfSlot):
+            if slot.isValid() and slot.getFlagKey().isValid():
+                bad |= catalog[slot.getFlagKey()]
+        flux1 = self.config.fluxRatio*modelFlux
+        if self.config.modelErrFactor != 0:
+            flux1 = flux1 + self.config.modelErrFactor*catalog[modelSlot.getErrKey()]
+        flux2 = psfFlux
+        if not self.config.psfErrFactor == 0:
+            flux2 = flux2 + self.config.psfErrFactor*catalog[psfSlot.getErrKey()]
+
+        # Failures are as in calculate: either slot flag is set or either
+        # calculated flux is NaN.
+        bad |= np.isnan(flux1) | np.isnan(flux2)
+        with np.errstate(invalid="ignore"):
+            value = np.where(flux1 < flux2, 0.0, 1.0)
+        catalog[self.keyProbability] = np.where(bad, catalog[self.keyProbability], value)
+        catalog[self.keyFlag] = catalog[self.keyFlag] | bad
+
     def fail(self, measRecord, error=None):
         measRecord.set(self.keyFlag, True)
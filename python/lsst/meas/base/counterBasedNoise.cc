@@ -0,0 +1,59 @@
+/*
+ * LSST Data Management System
+ * Copyright 2008-2019 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "pybind11/pybind11.h"
+
+#include "lsst/meas/base/CounterBasedNoise.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+PYBIND11_MODULE(counterBasedNoise, mod) {
+    py::module::import("lsst.afw.geom");
+    py::module::import("lsst.afw.image");
+
+    py::class_<CounterBasedNoise, std::shared_ptr<CounterBasedNoise>> cls(mod, "CounterBasedNoise");
+
+    cls.def(py::init<std::uint64_t>(), "seed"_a);
+
+    cls.def("getSeed", &CounterBasedNoise::getSeed);
+    cls.def("getDeviate", &CounterBasedNoise::getDeviate, "id"_a, "x"_a, "y"_a);
+    cls.def("fillImage",
+            (void (CounterBasedNoise::*)(afw::table::RecordId, afw::geom::SpanSet const &,
+                                         afw::image::Image<float> &, double, double) const) &
+                    CounterBasedNoise::fillImage,
+            "id"_a, "spans"_a, "image"_a, "mean"_a, "std"_a);
+    cls.def("fillImage",
+            (void (CounterBasedNoise::*)(afw::table::RecordId, afw::geom::SpanSet const &,
+                                         afw::image::Image<float> &, afw::image::Image<float> const &,
+                                         double) const) &
+                    CounterBasedNoise::fillImage,
+            "id"_a, "spans"_a, "image"_a, "variance"_a, "mean"_a);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
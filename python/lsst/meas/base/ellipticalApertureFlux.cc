@@ -0,0 +1,130 @@
+/*
+ * LSST Data Management System
+ * Copyright 2008-2019 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+
+#include <memory>
+
+#include "lsst/pex/config/python.h"
+#include "lsst/meas/base/python.h"
+
+#include "lsst/meas/base/EllipticalApertureFlux.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+namespace {
+
+using PyFluxAlgorithm = py::class_<EllipticalApertureFluxAlgorithm,
+                                   std::shared_ptr<EllipticalApertureFluxAlgorithm>, SimpleAlgorithm>;
+using PyFluxControl = py::class_<EllipticalApertureFluxControl>;
+using PyFluxTransform = py::class_<EllipticalApertureFluxTransform,
+                                   std::shared_ptr<EllipticalApertureFluxTransform>, BaseTransform>;
+
+PyFluxControl declareFluxControl(py::module &mod) {
+    PyFluxControl cls(mod, "EllipticalApertureFluxControl");
+
+    LSST_DECLARE_CONTROL_FIELD(cls, EllipticalApertureFluxControl, scales);
+    LSST_DECLARE_CONTROL_FIELD(cls, EllipticalApertureFluxControl, useKronRadius);
+    LSST_DECLARE_CONTROL_FIELD(cls, EllipticalApertureFluxControl, kronMaxScale);
+    LSST_DECLARE_CONTROL_FIELD(cls, EllipticalApertureFluxControl, maxSincRadius);
+    LSST_DECLARE_CONTROL_FIELD(cls, EllipticalApertureFluxControl, shiftKernel);
+    LSST_DECLARE_CONTROL_FIELD(cls, EllipticalApertureFluxControl, ellipticalCacheTolerance);
+
+    cls.def(py::init<>());
+
+    return cls;
+}
+
+PyFluxAlgorithm declareFluxAlgorithm(py::module &mod) {
+    PyFluxAlgorithm cls(mod, "EllipticalApertureFluxAlgorithm");
+
+    cls.attr("FAILURE") = py::cast(EllipticalApertureFluxAlgorithm::FAILURE);
+    cls.attr("BAD_KRON_RADIUS") = py::cast(EllipticalApertureFluxAlgorithm::BAD_KRON_RADIUS);
+
+    cls.def(py::init<EllipticalApertureFluxAlgorithm::Control const &, std::string const &,
+                     afw::table::Schema &>(),
+            "ctrl"_a, "name"_a, "schema"_a);
+
+    cls.def_static("computeKronScale",
+                   (double (*)(afw::image::Image<float> const &, afw::geom::ellipses::Ellipse const &,
+                               double)) &
+                           EllipticalApertureFluxAlgorithm::computeKronScale,
+                   "image"_a, "ellipse"_a, "maxScale"_a);
+    cls.def_static("computeKronScale",
+                   (double (*)(afw::image::Image<double> const &, afw::geom::ellipses::Ellipse const &,
+                               double)) &
+                           EllipticalApertureFluxAlgorithm::computeKronScale,
+                   "image"_a, "ellipse"_a, "maxScale"_a);
+    cls.def("measure", &EllipticalApertureFluxAlgorithm::measure, "measRecord"_a, "exposure"_a,
+            py::call_guard<py::gil_scoped_release>());
+    cls.def("fail", &EllipticalApertureFluxAlgorithm::fail, "measRecord"_a, "error"_a = nullptr);
+
+    return cls;
+}
+
+PyFluxTransform declareFluxTransform(py::module &mod) {
+    PyFluxTransform cls(mod, "EllipticalApertureFluxTransform");
+
+    cls.def(py::init<EllipticalApertureFluxTransform::Control const &, std::string const &,
+                     afw::table::SchemaMapper &>(),
+            "ctrl"_a, "name"_a, "mapper"_a);
+
+    cls.def("__call__", &EllipticalApertureFluxTransform::operator(), "inputCatalog"_a, "outputCatalog"_a,
+            "wcs"_a, "photoCalib"_a);
+
+    return cls;
+}
+
+}  // namespace
+
+PYBIND11_MODULE(ellipticalApertureFlux, mod) {
+    py::module::import("lsst.afw.geom");
+    py::module::import("lsst.afw.image");
+    py::module::import("lsst.afw.table");
+    py::module::import("lsst.meas.base.algorithm");
+    py::module::import("lsst.meas.base.apertureFlux");
+    py::module::import("lsst.meas.base.flagHandler");
+    py::module::import("lsst.meas.base.fluxUtilities");
+    py::module::import("lsst.meas.base.transform");
+
+    auto clsFluxControl = declareFluxControl(mod);
+    auto clsFluxAlgorithm = declareFluxAlgorithm(mod);
+    auto clsFluxTransform = declareFluxTransform(mod);
+
+    clsFluxAlgorithm.attr("Control") = clsFluxControl;
+    clsFluxTransform.attr("Control") = clsFluxControl;
+
+    python::declareAlgorithm<EllipticalApertureFluxAlgorithm, EllipticalApertureFluxControl,
+                             EllipticalApertureFluxTransform>(clsFluxAlgorithm, clsFluxControl,
+                                                              clsFluxTransform);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -0,0 +1,69 @@
+/*
+ * LSST Data Management System
+ * Copyright 2008-2017  AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "pybind11/pybind11.h"
+
+#include <memory>
+
+#include "lsst/meas/base/FluxKernelBackend.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+PYBIND11_MODULE(fluxKernelBackend, mod) {
+    py::module::import("lsst.geom");
+    py::module::import("lsst.afw.image");
+
+    py::class_<ModelFitSums> clsSums(mod, "ModelFitSums");
+    clsSums.def_readonly("modelSum", &ModelFitSums::modelSum);
+    clsSums.def_readonly("modelNorm", &ModelFitSums::modelNorm);
+    clsSums.def_readonly("modelSquared", &ModelFitSums::modelSquared);
+    clsSums.def_readonly("modelData", &ModelFitSums::modelData);
+    clsSums.def_readonly("modelSquaredVariance", &ModelFitSums::modelSquaredVariance);
+    clsSums.def_readonly("area", &ModelFitSums::area);
+
+    mod.def("accumulateModelFit", &accumulateModelFit, "model"_a, "image"_a, "bbox"_a, "badBits"_a,
+            "useWeights"_a);
+
+    py::class_<FluxKernelBackend, std::shared_ptr<FluxKernelBackend>> clsBackend(mod, "FluxKernelBackend");
+    clsBackend.def("getName", &FluxKernelBackend::getName);
+    clsBackend.def_static("getDefault", [] {
+        return std::const_pointer_cast<FluxKernelBackend>(FluxKernelBackend::getDefault());
+    });
+    clsBackend.def_static("setDefault",
+                          [](std::shared_ptr<FluxKernelBackend> backend) {
+                              FluxKernelBackend::setDefault(backend);
+                          },
+                          "backend"_a);
+
+    py::class_<CpuFluxKernelBackend, std::shared_ptr<CpuFluxKernelBackend>, FluxKernelBackend> clsCpu(
+            mod, "CpuFluxKernelBackend");
+    clsCpu.def(py::init<>());
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
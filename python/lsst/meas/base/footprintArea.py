@@ -23,6 +23,7 @@ import numpy as np
 
 from .catalogCalculation import (CatalogCalculationPluginConfig,
                                  CatalogCalculationPlugin)
+from .inputUtilities import extractFootprintAreas
 from .pluginRegistry import register
 
 __all__ = (
@@ -45,6 +46,8 @@ class CatalogCalculationFootprintAreaPlugin(CatalogCalculationPlugin):
 
     ConfigClass = CatalogCalculationFootprintAreaConfig
 
+    plugType = "columnar"
+
     @classmethod
     def getExecutionOrder(cls):
         return cls.DEFAULT_CATALOGCALCULATION
@@ -61,6 +64,9 @@ class CatalogCalculationFootprintAreaPlugin(CatalogCalculationPlugin):
     def calculate(self, measRecord):
         measRecord.set(self.key, measRecord.getFootprint().getArea())
 
+    def calculateColumns(self, catalog):
+        catalog[self.key] = extractFootprintAreas(catalog)
+
     def fail(self, measRecord, error=None):
         # Should be impossible for this algorithm to fail unless there is no
         # Footprint (and that's a precondition for measurement).
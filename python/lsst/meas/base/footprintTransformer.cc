@@ -0,0 +1,56 @@
+/*
+ * LSST Data Management System
+ * Copyright 2008-2017  AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+
+#include "lsst/meas/base/FootprintTransformer.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+PYBIND11_MODULE(footprintTransformer, mod) {
+    py::module::import("lsst.geom");
+    py::module::import("lsst.afw.detection");
+    py::module::import("lsst.afw.geom");
+    py::module::import("lsst.afw.table");
+
+    py::class_<FootprintTransformer, std::shared_ptr<FootprintTransformer>> cls(mod, "FootprintTransformer");
+
+    cls.def(py::init<afw::geom::SkyWcs const &, afw::geom::SkyWcs const &, geom::Box2I const &, int,
+                     double>(),
+            "source"_a, "target"_a, "region"_a, "tileSize"_a = 0, "maxError"_a = 0.01);
+
+    cls.def("transform", &FootprintTransformer::transform, "footprint"_a);
+    cls.def("transformFootprints", &FootprintTransformer::transformFootprints, "refCat"_a);
+    cls.def("transformSpans", &FootprintTransformer::transformSpans, "refCat"_a);
+    cls.def("attachFootprints", &FootprintTransformer::attachFootprints, "measCat"_a, "refCat"_a);
+    cls.def("getApproximatedCount", &FootprintTransformer::getApproximatedCount);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -54,13 +54,20 @@ Command-line driver tasks for forced measurement include
 `ForcedPhotImageTask`, `ForcedPhotCcdTask`, and `ForcedPhotCoaddTask`.
 """
 
+import collections
+import concurrent.futures
+import time
+
 import lsst.pex.config
 import lsst.pipe.base
+import lsst.afw.image
+import lsst.afw.table
 
 from .pluginRegistry import PluginRegistry
 from .baseMeasurement import (BaseMeasurementPluginConfig, BaseMeasurementPlugin,
-                              BaseMeasurementConfig, BaseMeasurementTask)
-from .noiseReplacer import NoiseReplacer, DummyNoiseReplacer
+                              BaseMeasurementConfig, BaseMeasurementTask, FATAL_EXCEPTIONS)
+from .noiseReplacer import NoiseReplacer, ScratchNoiseReplacer, DummyNoiseReplacer
+from .footprintTransformer import FootprintTransformer
 
 __all__ = ("ForcedPluginConfig", "ForcedPlugin",
            "ForcedMeasurementConfig", "ForcedMeasurementTask")
@@ -101,6 +108,32 @@ class ForcedPlugin(BaseMeasurementPlugin):
     def __init__(self, config, name, schemaMapper, metadata, logName=None):
         BaseMeasurementPlugin.__init__(self, config, name, logName=logName)
 
+    @classmethod
+    def getReferenceColumns(cls, config, refSchema):
+        """Return the reference columns this plugin reads directly.
+
+        Parameters
+        ----------
+        config : `ForcedPluginConfig`
+            Configuration of the plugin.
+        refSchema : `lsst.afw.table.Schema`
+            Schema of the reference catalog.
+
+        Returns
+        -------
+        columns : `list` of `str`
+            Names or glob patterns of reference fields, beyond the minimal
+            schema and the centroid and shape slots, that `measure` and
+            `measureN` read from the reference record.
+
+        Notes
+        -----
+        Used to load only the needed reference columns (see
+        `ForcedMeasurementTask.getReferenceColumns`); the default reads
+        nothing more.
+        """
+        return []
+
     def measure(self, measRecord, exposure, refRecord, refWcs):
         """Measure the properties of a source given an image and a reference.
 
@@ -197,6 +230,29 @@ class ForcedMeasurementConfig(BaseMeasurementConfig):
                  "coord_ra": "coord_ra", "coord_dec": "coord_dec"}
     )
 
+    numThreads = lsst.pex.config.RangeField(
+        dtype=int, default=1, min=1,
+        doc="Number of exposures to measure concurrently in ForcedMeasurementTask.runMultiple"
+    )
+
+    doMeasureBatch = lsst.pex.config.Field(
+        dtype=bool, default=False,
+        doc="Run the plugins that only transform reference quantities (e.g. base_TransformedCentroid and "
+            "base_TransformedShape) over all sources in a single call, for plugins that support it and "
+            "are only preceded in execution order by such plugins?"
+    )
+
+    footprintTransformTileSize = lsst.pex.config.RangeField(
+        dtype=int, default=0, min=0,
+        doc="If > 0, attachTransformedFootprints approximates the reference-to-exposure pixel mapping by "
+            "an affine transform on square tiles of this many reference pixels (see FootprintTransformer) "
+            "wherever it is accurate to within footprintTransformMaxError; if 0, the exact mapping is used"
+    )
+    footprintTransformMaxError = lsst.pex.config.RangeField(
+        dtype=float, default=0.01, min=0.0,
+        doc="Maximum error (pixels) of the affine approximation used when footprintTransformTileSize > 0"
+    )
+
     checkUnitsParseStrict = lsst.pex.config.Field(
         doc="Strictness of Astropy unit compatibility check, can be 'raise', 'warn' or 'silent'",
         dtype=str,
@@ -259,6 +315,35 @@ class ForcedMeasurementTask(BaseMeasurementTask):
         self.schema = self.mapper.getOutputSchema()
         self.schema.checkUnits(parse_strict=self.config.checkUnitsParseStrict)
 
+    @staticmethod
+    def getReferenceColumns(config, refSchema):
+        """Return the reference columns needed to measure with a config.
+
+        Parameters
+        ----------
+        config : `ForcedMeasurementConfig`
+            Configuration of the measurement task.
+        refSchema : `lsst.afw.table.Schema`
+            Schema of the reference catalog.
+
+        Returns
+        -------
+        columns : `list` of `str`
+            Names and glob patterns of the reference fields read by the task
+            and its plugins, beyond the minimal source schema: the copied
+            columns, the reference centroid and shape slots, and the columns
+            declared by each plugin's `ForcedPlugin.getReferenceColumns`.
+            Suitable for the ``columns`` argument of
+            `~lsst.meas.base.references.BaseReferencesTask`.
+        """
+        columns = list(config.copyColumns.keys())
+        columns += ["slot_Centroid_*", "slot_Shape_*"]
+        for plugins in (config.plugins, config.undeblended):
+            for executionOrder, name, pluginConfig, PluginClass in plugins.apply():
+                if hasattr(PluginClass, "getReferenceColumns"):
+                    columns += PluginClass.getReferenceColumns(pluginConfig, refSchema)
+        return columns
+
     def run(self, measCat, exposure, refCat, refWcs, exposureId=None, beginOrder=None, endOrder=None):
         r"""Perform forced measurement.
 
@@ -318,15 +403,7 @@ class ForcedMeasurementTask(BaseMeasurementTask):
         #
         # I.e. this code checks that this precondition is satisfied by
         # whatever reference catalog provider is being paired with it.
-        refCatIdDict = {ref.getId(): ref.getParent() for ref in refCat}
-        for ref in refCat:
-            refId = ref.getId()
-            topId = refId
-            while(topId > 0):
-                if topId not in refCatIdDict:
-                    raise RuntimeError("Reference catalog contains a child for which at least "
-                                       "one parent in its parent chain is not in the catalog.")
-                topId = refCatIdDict[topId]
+        self._checkReferenceFamilies(refCat)
 
         # Construct a footprints dict which looks like
         # {ref.getId(): (ref.getParent(), source.getFootprint())}
@@ -338,44 +415,172 @@ class ForcedMeasurementTask(BaseMeasurementTask):
                       "" if len(refCat) == 1 else "s")
 
         if self.config.doReplaceWithNoise:
-            noiseReplacer = NoiseReplacer(self.config.noiseReplacer, exposure,
-                                          footprints, log=self.log, exposureId=exposureId)
-            algMetadata = measCat.getTable().getMetadata()
-            if algMetadata is not None:
-                algMetadata.addInt("NOISE_SEED_MULTIPLIER", self.config.noiseReplacer.noiseSeedMultiplier)
-                algMetadata.addString("NOISE_SOURCE", self.config.noiseReplacer.noiseSource)
-                algMetadata.addDouble("NOISE_OFFSET", self.config.noiseReplacer.noiseOffset)
-                if exposureId is not None:
-                    algMetadata.addLong("NOISE_EXPOSURE_ID", exposureId)
+            NoiseReplacerClass = (ScratchNoiseReplacer if self.config.noiseReplacer.useScratchImages
+                                  else NoiseReplacer)
+            noiseReplacer = NoiseReplacerClass(self.config.noiseReplacer, exposure,
+                                               footprints, log=self.log, exposureId=exposureId,
+                                               detectionMasks=self.needsDetectionMasks(beginOrder, endOrder))
+            self._recordNoiseMetadata(measCat, exposureId)
         else:
             noiseReplacer = DummyNoiseReplacer()
 
-        # Create parent cat which slices both the refCat and measCat (sources)
-        # first, get the reference and source records which have no parent
+        with self.pluginTiming(), self.pluginTracing():
+            self._runPlugins(noiseReplacer, measCat, exposure, refCat, refWcs, beginOrder, endOrder)
+
+    @staticmethod
+    def _checkReferenceFamilies(refCat):
+        """Check that every parent in the parent chain of each reference is
+        in the catalog, and return a mapping of reference ID to parent ID.
+        """
+        refCatIdDict = {ref.getId(): ref.getParent() for ref in refCat}
+        for ref in refCat:
+            refId = ref.getId()
+            topId = refId
+            while(topId > 0):
+                if topId not in refCatIdDict:
+                    raise RuntimeError("Reference catalog contains a child for which at least "
+                                       "one parent in its parent chain is not in the catalog.")
+                topId = refCatIdDict[topId]
+        return refCatIdDict
+
+    def _recordNoiseMetadata(self, measCat, exposureId):
+        """Record the noise replacement configuration in the catalog metadata.
+        """
+        algMetadata = measCat.getTable().getMetadata()
+        if algMetadata is not None:
+            algMetadata.addInt("NOISE_SEED_MULTIPLIER", self.config.noiseReplacer.noiseSeedMultiplier)
+            algMetadata.addString("NOISE_SOURCE", self.config.noiseReplacer.noiseSource)
+            algMetadata.addDouble("NOISE_OFFSET", self.config.noiseReplacer.noiseOffset)
+            if exposureId is not None:
+                algMetadata.addLong("NOISE_EXPOSURE_ID", exposureId)
+
+    def runTiled(self, measCat, bbox, getExposure, refCat, refWcs, tiles=None, exposureId=None,
+                 beginOrder=None, endOrder=None):
+        r"""Perform forced measurement tile by tile, reading only the pixels
+        each tile needs.
+
+        Parameters
+        ----------
+        measCat : `lsst.afw.table.SourceCatalog`
+            Source catalog for measurement results, as for `run`.
+        bbox : `lsst.geom.Box2I`
+            Bounding box of the full image.
+        getExposure : callable
+            Called with the `lsst.geom.Box2I` of each tile in turn; must
+            return an `lsst.afw.image.ExposureF` covering exactly those pixels
+            (e.g. a sub-region read from the butler), with at least a
+            `lsst.afw.geom.SkyWcs` attached.  It is modified while measuring,
+            and dropped once the tile is done.
+        refCat : `lsst.afw.table.SourceCatalog`
+            Reference sources, as for `run`.
+        refWcs : `lsst.afw.geom.SkyWcs`
+            Defines the X,Y coordinate system of ``refCat``.
+        tiles : `list` of `lsst.pipe.base.Struct`, optional
+            Tiles to measure, as returned by `makeTiles` for the parents of
+            ``measCat`` (``refCat.getChildren(0, measCat)[1]``); all tiles if
+            `None`.  Tiles are independent, so a subset may be passed to each
+            of several processes.
+        exposureId : `int`, optional
+            Unique exposure identifier used to seed noise replacement.
+        beginOrder : `int`, optional
+            Beginning execution order (inclusive).
+        endOrder : `int`, optional
+            Ending execution order (exclusive).
+
+        Notes
+        -----
+        Parent families are grouped into tiles as by
+        `SingleFrameMeasurementTask.runTiled`, and each tile is measured on
+        its own pixels with a noise replacer of its own, so peak memory
+        scales with ``config.parallelTileSize`` rather than with the image.  The
+        replacement noise is drawn per tile, so results are not bit-for-bit
+        identical to those from `run`.
+        """
+        refCatIdDict = self._checkReferenceFamilies(refCat)
+        footprints = {ref.getId(): (ref.getParent(), measRecord.getFootprint())
+                      for (ref, measRecord) in zip(refCat, measCat)}
         refParentCat, measParentCat = refCat.getChildren(0, measCat)
-        for parentIdx, (refParentRecord, measParentRecord) in enumerate(zip(refParentCat, measParentCat)):
-
-            # first process the records which have the current parent as children
-            refChildCat, measChildCat = refCat.getChildren(refParentRecord.getId(), measCat)
-            # TODO: skip this loop if there are no plugins configured for single-object mode
-            for refChildRecord, measChildRecord in zip(refChildCat, measChildCat):
-                noiseReplacer.insertSource(refChildRecord.getId())
-                self.callMeasure(measChildRecord, exposure, refChildRecord, refWcs,
-                                 beginOrder=beginOrder, endOrder=endOrder)
-                noiseReplacer.removeSource(refChildRecord.getId())
-
-            # then process the parent record
-            noiseReplacer.insertSource(refParentRecord.getId())
-            self.callMeasure(measParentRecord, exposure, refParentRecord, refWcs,
-                             beginOrder=beginOrder, endOrder=endOrder)
-            self.callMeasureN(measParentCat[parentIdx:parentIdx+1], exposure,
-                              refParentCat[parentIdx:parentIdx+1],
-                              beginOrder=beginOrder, endOrder=endOrder)
-            # measure all the children simultaneously
-            self.callMeasureN(measChildCat, exposure, refChildCat,
-                              beginOrder=beginOrder, endOrder=endOrder)
-            noiseReplacer.removeSource(refParentRecord.getId())
-        noiseReplacer.end()
+        if tiles is None:
+            tiles = self.makeTiles(measParentCat, bbox)
+        if self.config.doReplaceWithNoise:
+            self._recordNoiseMetadata(measCat, exposureId)
+        detectionMasks = self.needsDetectionMasks(beginOrder, endOrder)
+
+        def getTopId(refId):
+            while refCatIdDict[refId] != 0:
+                refId = refCatIdDict[refId]
+            return refId
+
+        # Index the records of each family once, in catalog order, so each tile only visits its own.
+        families = collections.defaultdict(list)
+        for index, ref in enumerate(refCat):
+            families[getTopId(ref.getId())].append(index)
+        self.log.info("Performing forced measurement on %d source%s in %d tile%s", len(refCat),
+                      "" if len(refCat) == 1 else "s", len(tiles), "" if len(tiles) == 1 else "s")
+        with self.pluginTiming(), self.pluginTracing():
+            for tile in tiles:
+                indices = sorted(index for parentIdx in tile.parentIndices
+                                 for index in families[refParentCat[parentIdx].getId()])
+                refTileCat = lsst.afw.table.SourceCatalog(refCat.getTable())
+                measTileCat = lsst.afw.table.SourceCatalog(measCat.getTable())
+                for index in indices:
+                    refTileCat.append(refCat[index])
+                    measTileCat.append(measCat[index])
+                ownIds = {refRecord.getId() for refRecord in refTileCat}
+                tileExposure = getExposure(tile.bbox)
+                if self.config.doReplaceWithNoise:
+                    NoiseReplacerClass = (ScratchNoiseReplacer if self.config.noiseReplacer.useScratchImages
+                                          else NoiseReplacer)
+                    noiseReplacer = NoiseReplacerClass(self.config.noiseReplacer, tileExposure,
+                                                       self.makeTileFootprints(footprints, ownIds, tile.bbox),
+                                                       log=self.log, exposureId=exposureId,
+                                                       detectionMasks=detectionMasks)
+                else:
+                    noiseReplacer = DummyNoiseReplacer()
+                self._runPlugins(noiseReplacer, measTileCat, tileExposure, refTileCat, refWcs,
+                                 beginOrder, endOrder)
+
+    def _runPlugins(self, noiseReplacer, measCat, exposure, refCat, refWcs, beginOrder, endOrder):
+        """Implementation of `run`, called once the noise replacer has been constructed.
+        """
+        self._traceFamilies(refCat)
+        with self.cachedPsf(exposure):
+            batched = self._runBatchPlugins(measCat, exposure, refCat, refWcs, beginOrder, endOrder)
+            # Create parent cat which slices both the refCat and measCat (sources)
+            # first, get the reference and source records which have no parent
+            refParentCat, measParentCat = refCat.getChildren(0, measCat)
+            for parentIdx in self.getSourceOrder(measParentCat):
+                refParentRecord, measParentRecord = refParentCat[parentIdx], measParentCat[parentIdx]
+                traced = self.tracer is not None and self.tracer.isSampled(measParentRecord.getId())
+                traceStart = self.tracer.now() if traced else None
+
+                # first process the records which have the current parent as children
+                refChildCat, measChildCat = refCat.getChildren(refParentRecord.getId(), measCat)
+                # TODO: skip this loop if there are no plugins configured for single-object mode
+                for refChildRecord, measChildRecord in zip(refChildCat, measChildCat):
+                    measExposure = self._insertSource(noiseReplacer, refChildRecord.getId(), traced)
+                    if measExposure is None:
+                        measExposure = exposure
+                    self.callMeasure(measChildRecord, measExposure, refChildRecord, refWcs,
+                                     beginOrder=beginOrder, endOrder=endOrder, exclude=batched)
+                    self._removeSource(noiseReplacer, refChildRecord.getId(), traced)
+
+                # then process the parent record
+                measExposure = self._insertSource(noiseReplacer, refParentRecord.getId(), traced)
+                if measExposure is None:
+                    measExposure = exposure
+                self.callMeasure(measParentRecord, measExposure, refParentRecord, refWcs,
+                                 beginOrder=beginOrder, endOrder=endOrder, exclude=batched)
+                self.callMeasureN(measParentCat[parentIdx:parentIdx+1], measExposure,
+                                  refParentCat[parentIdx:parentIdx+1],
+                                  beginOrder=beginOrder, endOrder=endOrder)
+                # measure all the children simultaneously
+                self.callMeasureN(measChildCat, measExposure, refChildCat,
+                                  beginOrder=beginOrder, endOrder=endOrder)
+                self._removeSource(noiseReplacer, refParentRecord.getId(), traced)
+                if traced:
+                    self._traceEnd("family", "family", traceStart, measParentRecord)
+            noiseReplacer.end()
 
         # Undeblended plugins only fire if we're running everything
         if endOrder is None:
@@ -383,6 +588,203 @@ class ForcedMeasurementTask(BaseMeasurementTask):
                 for plugin in self.undeblendedPlugins.iter():
                     self.doMeasurement(plugin, measRecord, exposure, refRecord, refWcs)
 
+    def _runBatchPlugins(self, measCat, exposure, refCat, refWcs, beginOrder, endOrder):
+        """Run the plugins that measure all sources at once.
+
+        Returns
+        -------
+        batched : `frozenset` of `str`
+            Names of the plugins run, which are to be skipped by the
+            per-source loop.
+
+        Notes
+        -----
+        Plugins that define ``measureBatch(measCat, exposure, refCat,
+        refWcs)`` are those whose outputs depend only on the reference
+        catalog and the WCSs, not on the pixels or on other plugins (e.g.
+        ``base_TransformedCentroid``), so they need no noise replacement.
+        To keep the execution order, only the plugins that precede every
+        plugin without ``measureBatch`` are run here.  If ``measureBatch``
+        raises, the plugin measures the sources one at a time instead, so
+        failures are handled per record as in the per-source loop.
+        """
+        if not self.config.doMeasureBatch:
+            return frozenset()
+        batched = set()
+        for plugin in self.plugins.iter():
+            if beginOrder is not None and plugin.getExecutionOrder() < beginOrder:
+                continue
+            if endOrder is not None and plugin.getExecutionOrder() >= endOrder:
+                break
+            if not hasattr(plugin, "measureBatch"):
+                break
+            if self.timer is not None:
+                start = time.perf_counter()
+            try:
+                plugin.measureBatch(measCat, exposure, refCat, refWcs)
+            except FATAL_EXCEPTIONS:
+                raise
+            except Exception as error:
+                self.log.debug("Exception in %s.measureBatch; measuring sources one at a time: %s",
+                               plugin.name, error)
+                for measRecord, refRecord in zip(measCat, refCat):
+                    self.doMeasurement(plugin, measRecord, exposure, refRecord, refWcs)
+            else:
+                if self.timer is not None:
+                    self.timer.record(plugin.name, time.perf_counter() - start, nSources=len(measCat))
+            batched.add(plugin.name)
+        return frozenset(batched)
+
+    def doMeasurementChain(self, chain, measRecord, *args, **kwds):
+        # Forced plugins also take the reference record and WCS.
+        chain.measureForced(measRecord, *args, **kwds)
+
+    def runMultiple(self, exposures, refCat, refWcs, exposureIds=None, idFactory=None,
+                    beginOrder=None, endOrder=None, attachFootprints=None):
+        r"""Perform forced measurement of one reference catalog on several exposures.
+
+        Parameters
+        ----------
+        exposures : sequence of `lsst.afw.image.ExposureF`
+            Images to be measured, e.g. all the visits contributing to a light
+            curve. Each must have a `lsst.afw.geom.SkyWcs` attached.
+        refCat : `lsst.afw.table.SourceCatalog`
+            Reference catalog, measured on every exposure.
+        refWcs : `lsst.afw.geom.SkyWcs`
+            Defines the X,Y coordinate system of ``refCat``.
+        exposureIds : sequence of `int`, optional
+            Unique IDs of the exposures, used to seed the noise replacement.
+        idFactory : `lsst.afw.table.IdFactory`, optional
+            Factory for creating IDs for sources.  IDs are only allocated for
+            the first output catalog; record ``i`` of every catalog has the
+            same ID, as when each exposure is measured with its own copy of
+            the factory.
+        beginOrder : `int`, optional
+            Beginning execution order (inclusive); see `run`.
+        endOrder : `int`, optional
+            Ending execution order (exclusive); see `run`.
+        attachFootprints : callable, optional
+            Called with the index of each exposure and its newly generated
+            output catalog to attach its Footprints (e.g. per-band deblended
+            Footprints), instead of `attachTransformedFootprints`.
+
+        Returns
+        -------
+        measCats : `list` of `lsst.afw.table.SourceCatalog`
+            One catalog of measurements per exposure, in the order of
+            ``exposures``. All have the same schema, with one record per
+            reference source, so they can be concatenated into a single
+            long-format table.
+
+        Notes
+        -----
+        This is equivalent to calling `generateMeasCat`,
+        `attachTransformedFootprints` and `run` for each exposure in turn,
+        but the plugins and schema are shared by all exposures, and the
+        output catalog and transformed footprints are only generated once for
+        each distinct combination of WCS and bounding box (e.g. for a stack of
+        warped or difference images on the same pixel grid).  Catalogs are
+        not shared if ``attachFootprints`` is given.
+
+        If ``config.numThreads`` is greater than one and every plugin can
+        measure concurrently (see `BasePlugin.canMeasureConcurrently`), that
+        many exposures are measured concurrently, each with its own clone of
+        its PSF; C++ plugins release the GIL while measuring.  The results are
+        identical to serial measurement.
+        """
+        exposures = list(exposures)
+        if exposureIds is None:
+            exposureIds = [None]*len(exposures)
+        if len(exposureIds) != len(exposures):
+            raise ValueError("Got %d exposure IDs for %d exposures" % (len(exposureIds), len(exposures)))
+        if idFactory is None:
+            idFactory = lsst.afw.table.IdFactory.makeSimple()
+
+        ids = []
+
+        def generateMeasCat(exposure):
+            measCat = self.generateMeasCat(exposure, refCat, refWcs, idFactory=idFactory)
+            if not ids:
+                ids.extend(measRecord.getId() for measRecord in measCat)
+            else:
+                for measRecord, sourceId in zip(measCat, ids):
+                    measRecord.setId(sourceId)
+            return measCat
+
+        templates = []  # (wcs, bbox, measCat with footprints attached) for each distinct pixel grid
+        measCats = []
+        for index, exposure in enumerate(exposures):
+            if attachFootprints is not None:
+                measCat = generateMeasCat(exposure)
+                attachFootprints(index, measCat)
+                measCats.append(measCat)
+                continue
+            wcs = exposure.getWcs()
+            bbox = exposure.getBBox(lsst.afw.image.PARENT)
+            for templateWcs, templateBBox, template in templates:
+                if templateBBox == bbox and templateWcs == wcs:
+                    # Footprints are not modified by measurement, so they can be shared.
+                    measCat = template.copy(deep=True)
+                    break
+            else:
+                measCat = generateMeasCat(exposure)
+                self.attachTransformedFootprints(measCat, refCat, exposure, refWcs)
+                templates.append((wcs, bbox, measCat))
+                measCat = measCat.copy(deep=True)
+            measCats.append(measCat)
+
+        def measure(index, exposure):
+            self.run(measCats[index], exposure, refCat, refWcs, exposureId=exposureIds[index],
+                     beginOrder=beginOrder, endOrder=endOrder)
+
+        with self.pluginTiming(), self.pluginTracing():
+            # A single timer accumulates over all exposures.
+            self._runMultiple(measure, exposures)
+        return measCats
+
+    def _runMultiple(self, measure, exposures):
+        """Implementation of `runMultiple`: call ``measure`` on the index of
+        each exposure and the exposure, serially or in parallel.
+        """
+        if self.config.numThreads == 1 or len(exposures) < 2:
+            for index, exposure in enumerate(exposures):
+                measure(index, exposure)
+            return
+        serialPlugins = [plugin.name for plugin in self.plugins.iter() if not plugin.canMeasureConcurrently()]
+        if serialPlugins:
+            self.log.info("Measuring exposures serially, because plugins %s cannot measure concurrently",
+                          ", ".join(serialPlugins))
+            for index, exposure in enumerate(exposures):
+                measure(index, exposure)
+            return
+        # PSF models may not be evaluated concurrently, and the same PSF may
+        # be attached to several exposures, so each exposure is measured on a
+        # shallow copy with its own clone.
+        measExposures = []
+        for exposure in exposures:
+            psf = exposure.getPsf()
+            if psf is not None:
+                exposure = exposure.Factory(exposure, False)
+                exposure.setPsf(psf.clone())
+            measExposures.append(exposure)
+
+        # The temporary mask planes used by NoiseReplacer are shared by all
+        # masks; add them up front so no worker removes them while another
+        # is still using them.
+        mask = exposures[0].getMaskedImage().getMask()
+        addedPlanes = []
+        for maskName in (("THISDET", "OTHERDET") if self.needsDetectionMasks() else ()):
+            if maskName not in mask.getMaskPlaneDict():
+                mask.addMaskPlane(maskName)
+                addedPlanes.append(maskName)
+        try:
+            with concurrent.futures.ThreadPoolExecutor(max_workers=self.config.numThreads) as pool:
+                # Consume the results to propagate any exception raised by a worker.
+                list(pool.map(measure, range(len(exposures)), measExposures))
+        finally:
+            for maskName in addedPlanes:
+                mask.removeAndClearMaskPlane(maskName, True)
+
     def generateMeasCat(self, exposure, refCat, refWcs, idFactory=None):
         r"""Initialize an output catalog from the reference catalog.
 
@@ -443,8 +845,13 @@ class ForcedMeasurementTask(BaseMeasurementTask):
         See the documentation for `run` for information about the
         relationships between `run`, `generateMeasCat`, and
         `attachTransformedFootprints`.
+
+        The two WCSs are composed once for all sources, and the footprints
+        are all transformed in a single call to a `FootprintTransformer`
+        configured by ``config.footprintTransformTileSize`` and
+        ``config.footprintTransformMaxError``.
         """
-        exposureWcs = exposure.getWcs()
-        region = exposure.getBBox(lsst.afw.image.PARENT)
-        for srcRecord, refRecord in zip(sources, refCat):
-            srcRecord.setFootprint(refRecord.getFootprint().transform(refWcs, exposureWcs, region))
+        transformer = FootprintTransformer(refWcs, exposure.getWcs(), exposure.getBBox(lsst.afw.image.PARENT),
+                                           tileSize=self.config.footprintTransformTileSize,
+                                           maxError=self.config.footprintTransformMaxError)
+        transformer.attachFootprints(sources, refCat)
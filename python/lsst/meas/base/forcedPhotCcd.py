@@ -33,7 +33,7 @@ import lsst.sphgeom
 
 from lsst.pipe.base import PipelineTaskConnections
 import lsst.pipe.base.connectionTypes as cT
-from .forcedPhotImage import ForcedPhotImageTask, ForcedPhotImageConfig
+from .forcedPhotImage import ForcedPhotImageTask, ForcedPhotImageConfig, ForcedPhotImageRunner
 
 try:
     from lsst.meas.mosaic import applyMosaicResults
@@ -269,7 +269,7 @@ class ForcedPhotCcdTask(ForcedPhotImageTask):
     """
 
     ConfigClass = ForcedPhotCcdConfig
-    RunnerClass = lsst.pipe.base.ButlerInitializedTaskRunner
+    RunnerClass = ForcedPhotImageRunner
     _DefaultName = "forcedPhotCcd"
     dataPrefix = ""
 
@@ -25,7 +25,8 @@ import lsst.coadd.utils
 import lsst.afw.table
 
 
-from .forcedPhotImage import ForcedPhotImageConfig, ForcedPhotImageTask, ForcedPhotImageConnections
+from .forcedPhotImage import (ForcedPhotImageConfig, ForcedPhotImageTask, ForcedPhotImageConnections,
+                              ForcedPhotImageRunner)
 
 
 __all__ = ("ForcedPhotCoaddConfig", "ForcedPhotCoaddTask")
@@ -47,6 +48,13 @@ class ForcedPhotCoaddConfig(ForcedPhotImageConfig, pipelineConnections=ForcedPho
         doc="Should be set to True if fake sources have been inserted into the input data."
     )
 
+    doMultiBand = lsst.pex.config.Field(
+        dtype=bool,
+        default=False,
+        doc="Have the command-line runner measure all the bands of each patch in one call to runDataRefs, "
+            "reading the references once, instead of calling runDataRef on each band."
+    )
+
     def setDefaults(self):
         ForcedPhotImageTask.ConfigClass.setDefaults(self)
         # Copy 'id' and 'parent' columns without renaming them; since these are
@@ -67,14 +75,38 @@ class ForcedPhotCoaddConfig(ForcedPhotImageConfig, pipelineConnections=ForcedPho
                 and self.references.removePatchOverlaps):
             raise ValueError("Cannot use removePatchOverlaps=True with deblended footprints, as parent "
                              "sources may be rejected while their children are not.")
+        if self.doMultiBand and self.doPipelined:
+            raise ValueError("Cannot use both doMultiBand and doPipelined.")
 
 
-class ForcedPhotCoaddRunner(lsst.pipe.base.ButlerInitializedTaskRunner):
-    """Get the psfCache setting into ForcedPhotCoaddTask"""
+class ForcedPhotCoaddRunner(ForcedPhotImageRunner):
+    """Get the psfCache setting into ForcedPhotCoaddTask, and group the data
+    references by patch if ``config.doMultiBand`` is `True`.
+
+    Notes
+    -----
+    With ``config.doMultiBand``, each target is the list of data references
+    to the bands of one patch, which is passed to
+    `ForcedPhotCoaddTask.runDataRefs`; otherwise the data references are
+    passed on as by `ForcedPhotImageRunner`.
+    """
     @staticmethod
     def getTargetList(parsedCmd, **kwargs):
-        return lsst.pipe.base.ButlerInitializedTaskRunner.getTargetList(parsedCmd,
-                                                                        psfCache=parsedCmd.psfCache)
+        targets = ForcedPhotImageRunner.getTargetList(parsedCmd, psfCache=parsedCmd.psfCache)
+        if not parsedCmd.config.doMultiBand:
+            return targets
+        patches = {}
+        for dataRef, targetKwargs in targets:
+            key = (dataRef.dataId["tract"], dataRef.dataId["patch"])
+            if key not in patches:
+                patches[key] = ([], targetKwargs)
+            patches[key][0].append(dataRef)
+        return list(patches.values())
+
+    def runTask(self, task, dataRef, kwargs):
+        if isinstance(dataRef, list) and task.config.doMultiBand:
+            return task.runDataRefs(dataRef, **kwargs)
+        return ForcedPhotImageRunner.runTask(self, task, dataRef, kwargs)
 
 
 class ForcedPhotCoaddTask(ForcedPhotImageTask):
@@ -91,7 +123,7 @@ class ForcedPhotCoaddTask(ForcedPhotImageTask):
     """
 
     ConfigClass = ForcedPhotCoaddConfig
-    RunnerClass = lsst.pipe.base.ButlerInitializedTaskRunner
+    RunnerClass = ForcedPhotCoaddRunner
     _DefaultName = "forcedPhotCoadd"
     dataPrefix = "deepCoadd_"
 
@@ -182,6 +214,114 @@ class ForcedPhotCoaddTask(ForcedPhotImageTask):
                                    self.config.footprintDatasetName))
             srcRecord.setFootprint(fpRecord.getFootprint())
 
+    def runMultiBand(self, exposures, refCat, refWcs, exposureIds=None, idFactory=None,
+                     attachFootprints=None):
+        """Perform forced measurement on coadds of one patch in several bands.
+
+        Parameters
+        ----------
+        exposures : sequence of `lsst.afw.image.Exposure`
+            Coadds to measure, one per band, normally on the same pixel grid.
+        refCat : `lsst.afw.table.SourceCatalog`
+            The reference catalog of sources to measure.
+        refWcs : `lsst.afw.image.SkyWcs`
+            The WCS for the references.
+        exposureIds : sequence of `int`, optional
+            Unique IDs of the coadds, used to seed noise replacement.
+        idFactory : `lsst.afw.table.IdFactory`, optional
+            Factory for creating IDs for sources; shared by all bands.
+        attachFootprints : callable, optional
+            Called with the index of each coadd and its output catalog to
+            attach per-band Footprints; if `None`, the transformed reference
+            Footprints are used.
+
+        Returns
+        -------
+        result : `lsst.pipe.base.Struct`
+            Structure with fields:
+
+            ``measCats``
+                Catalogs of forced measurement results, one per element of
+                ``exposures`` (`list` of `lsst.afw.table.SourceCatalog`).
+
+        Notes
+        -----
+        Equivalent to calling `run` on each band in turn, but measurement is
+        delegated to `ForcedMeasurementTask.runMultiple`: the output catalog
+        and transformed Footprints are generated once for all bands on the
+        same pixel grid, the plugins and their cached aperture and sinc
+        coefficient geometry are shared, and the bands are measured
+        concurrently if ``measurement.numThreads`` is greater than one.
+        """
+        exposures = list(exposures)
+        measCats = self.measurement.runMultiple(exposures, refCat, refWcs, exposureIds=exposureIds,
+                                                idFactory=idFactory, attachFootprints=attachFootprints)
+        for measCat, exposure in zip(measCats, exposures):
+            if self.config.doApCorr:
+                self.applyApCorr.run(
+                    catalog=measCat,
+                    apCorrMap=exposure.getInfo().getApCorrMap()
+                )
+            self.catalogCalculation.run(measCat)
+        return lsst.pipe.base.Struct(measCats=measCats)
+
+    def runDataRefs(self, dataRefs, psfCache=None):
+        """Perform forced measurement on the coadds of one patch in several
+        bands, loading the references once.
+
+        Parameters
+        ----------
+        dataRefs : iterable of `lsst.daf.persistence.ButlerDataRef`
+            Data references to the coadds to measure, differing only in
+            filter.
+        psfCache : `int`, optional
+            Size of PSF cache, or `None`.
+
+        Notes
+        -----
+        The reference WCS and catalog are read for the first data reference
+        only, and the source ID factory of the first band is used for all of
+        them, which makes no difference with the default configuration where
+        IDs are copied from the references.  Bands whose coadd does not exist
+        are skipped.  As for `runDataRef`, the outputs are written by
+        `writeOutput`.
+
+        This is called by the command-line runner with the data references
+        to each patch if ``config.doMultiBand`` is `True`.
+        """
+        dataRefs = list(dataRefs)
+        if not dataRefs:
+            return
+        refWcs = self.references.getWcs(dataRefs[0])
+        refCat = self.fetchReferences(dataRefs[0], None)
+        measured = []
+        exposures = []
+        for dataRef in dataRefs:
+            exposure = self.getExposure(dataRef)
+            if exposure is None:
+                self.log.warn("No coadd to measure for %s; skipping." % (dataRef.dataId,))
+                continue
+            if psfCache is not None:
+                exposure.getPsf().setCacheSize(psfCache)
+            measured.append(dataRef)
+            exposures.append(exposure)
+        if not measured:
+            return
+        self.log.info("Performing forced measurement on %d bands of %s" %
+                      (len(measured), measured[0].dataId))
+
+        attachFootprints = None
+        if self.config.footprintDatasetName is not None:
+            def attachFootprints(index, measCat):
+                self.attachFootprints(measCat, refCat, exposures[index], refWcs, measured[index])
+
+        result = self.runMultiBand(exposures, refCat, refWcs,
+                                   exposureIds=[self.getExposureId(dataRef) for dataRef in measured],
+                                   idFactory=self.makeIdFactory(measured[0]),
+                                   attachFootprints=attachFootprints)
+        for dataRef, measCat in zip(measured, result.measCats):
+            self.writeOutput(dataRef, measCat)
+
     @classmethod
     def _makeArgumentParser(cls):
         parser = lsst.pipe.base.ArgumentParser(name=cls._DefaultName)
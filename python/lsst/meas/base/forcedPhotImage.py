@@ -25,6 +25,9 @@ Must be inherited to specialize for a specific dataset to be used (see
 `ForcedPhotCcdTask`, `ForcedPhotCoaddTask`).
 """
 
+import collections
+import concurrent.futures
+
 import lsst.afw.table
 import lsst.pex.config
 import lsst.daf.base
@@ -42,6 +45,31 @@ from .catalogCalculation import CatalogCalculationTask
 __all__ = ("ForcedPhotImageConfig", "ForcedPhotImageTask", "ForcedPhotImageConnections")
 
 
+class ForcedPhotImageRunner(lsst.pipe.base.ButlerInitializedTaskRunner):
+    """Pass all the data references to
+    `ForcedPhotImageTask.runDataRefsPipelined` in one call if
+    ``config.doPipelined`` is `True`.
+
+    Notes
+    -----
+    Otherwise each data reference is passed to
+    `ForcedPhotImageTask.runDataRef`, as with
+    `~lsst.pipe.base.ButlerInitializedTaskRunner`.  A pipelined run is a
+    single target, so it is not spread over several processes.
+    """
+    @staticmethod
+    def getTargetList(parsedCmd, **kwargs):
+        targets = lsst.pipe.base.ButlerInitializedTaskRunner.getTargetList(parsedCmd, **kwargs)
+        if not parsedCmd.config.doPipelined or not targets:
+            return targets
+        return [([dataRef for dataRef, targetKwargs in targets], kwargs)]
+
+    def runTask(self, task, dataRef, kwargs):
+        if isinstance(dataRef, list):
+            return task.runDataRefsPipelined(dataRef, **kwargs)
+        return task.runDataRef(dataRef, **kwargs)
+
+
 class ForcedPhotImageConnections(PipelineTaskConnections,
                                  dimensions=("band", "skymap", "tract", "patch"),
                                  defaultTemplates={"inputCoaddName": "deep",
@@ -98,11 +126,30 @@ class ForcedPhotImageConfig(PipelineTaskConfig, pipelineConnections=ForcedPhotIm
         dtype=str,
         default="deep",
     )
+    loadNeededReferenceColumns = lsst.pex.config.Field(
+        doc="Have the references subtask load only the reference columns read by the measurement "
+            "subtask and its plugins, when it reads references itself.",
+        dtype=bool,
+        default=False,
+    )
     doApCorr = lsst.pex.config.Field(
         dtype=bool,
         default=True,
         doc="Run subtask to apply aperture corrections"
     )
+    doPipelined = lsst.pex.config.Field(
+        dtype=bool,
+        default=False,
+        doc="Have the command-line runner pass all the data references to runDataRefsPipelined in one call, "
+            "overlapping the measurement of each exposure with reading the next ones."
+    )
+    readAhead = lsst.pex.config.RangeField(
+        dtype=int,
+        default=1,
+        min=0,
+        doc="Number of exposures runDataRefsPipelined reads ahead while an earlier one is measured in a "
+            "background thread; 0 reads each one after the previous one is measured and written."
+    )
     applyApCorr = lsst.pex.config.ConfigurableField(
         target=ApplyApCorrTask,
         doc="Subtask to apply aperture corrections"
@@ -163,6 +210,10 @@ class ForcedPhotImageTask(lsst.pipe.base.PipelineTask, lsst.pipe.base.CmdLineTas
             refSchema = initInputs['inputSchema'].schema
 
         self.makeSubtask("references", butler=butler, schema=refSchema)
+        if refSchema is None and self.config.loadNeededReferenceColumns:
+            self.references.setColumns(
+                ForcedMeasurementTask.getReferenceColumns(self.config.measurement, self.references.schema)
+            )
         if refSchema is None:
             refSchema = self.references.schema
         self.makeSubtask("measurement", refSchema=refSchema)
@@ -236,22 +287,131 @@ class ForcedPhotImageTask(lsst.pipe.base.PipelineTask, lsst.pipe.base.CmdLineTas
         sources are then passed to the ``writeOutputs`` method (implemented by
         derived classes) which writes the outputs.
         """
+        inputs = self.readDataRef(dataRef, psfCache=psfCache)
+        self.writeOutput(dataRef, self.measureDataRef(dataRef, inputs))
+
+    def runDataRefsPipelined(self, dataRefList, psfCache=None):
+        """Perform forced measurement on a sequence of exposures, reading the
+        next ones and writing the results while one is measured.
+
+        Parameters
+        ----------
+        dataRefList : iterable of `lsst.daf.persistence.ButlerDataRef`
+            Data references of the exposures to measure, as for
+            `runDataRef`.
+        psfCache : `int`, optional
+            Size of PSF cache, or `None`.
+
+        Notes
+        -----
+        The results are those of calling `runDataRef` on each data reference
+        in turn, but `run` is called in a background thread, so that up to
+        ``config.readAhead`` of the next exposures are read, with their
+        references, by `readDataRef` and `makeMeasCat`, and the results of
+        the previous ones are written by ``writeOutput``, while it runs.
+        Measurement releases the GIL in C++, so the I/O proceeds alongside
+        it.  All butler access stays in the calling thread; `run` must only
+        use its arguments and the measurement subtasks.
+
+        If an exposure fails, the results measured before it are written
+        before the exception is raised, and no further exposures are read.
+
+        This is called by the command-line runner with all the data
+        references if ``config.doPipelined`` is `True`.
+        """
+        pending = collections.deque()
+
+        def writeNext():
+            dataRef, result = pending.popleft()
+            if result.exception() is not None:
+                # Drop the results of the exposures after the failed one.
+                pending.clear()
+            self.writeOutput(dataRef, result.result().measCat)
+
+        with concurrent.futures.ThreadPoolExecutor(max_workers=1) as executor:
+            try:
+                for dataRef in dataRefList:
+                    inputs = self.readDataRef(dataRef, psfCache=psfCache)
+                    measCat = self.makeMeasCat(dataRef, inputs)
+                    exposureId = self.getExposureId(dataRef)
+                    self.log.info("Performing forced measurement on %s" % (dataRef.dataId,))
+                    pending.append((dataRef, executor.submit(self.run, measCat, inputs.exposure,
+                                                             inputs.refCat, inputs.refWcs,
+                                                             exposureId=exposureId)))
+                    del inputs, measCat
+                    while len(pending) > self.config.readAhead:
+                        writeNext()
+            except Exception:
+                while pending and pending[0][1].exception() is None:
+                    writeNext()
+                raise
+            while pending:
+                writeNext()
+
+    def readDataRef(self, dataRef, psfCache=None):
+        """Read the exposure and references to measure for a data reference.
+
+        Parameters
+        ----------
+        dataRef : `lsst.daf.persistence.ButlerDataRef`
+            Data reference, as for `runDataRef`.
+        psfCache : `int`, optional
+            Size of PSF cache, or `None`.
+
+        Returns
+        -------
+        inputs : `lsst.pipe.base.Struct`
+            Structure with fields ``refWcs``, ``exposure`` and ``refCat``.
+        """
         refWcs = self.references.getWcs(dataRef)
         exposure = self.getExposure(dataRef)
         if psfCache is not None:
             exposure.getPsf().setCacheSize(psfCache)
         refCat = self.fetchReferences(dataRef, exposure)
+        return lsst.pipe.base.Struct(refWcs=refWcs, exposure=exposure, refCat=refCat)
 
-        measCat = self.measurement.generateMeasCat(exposure, refCat, refWcs,
+    def makeMeasCat(self, dataRef, inputs):
+        """Generate the catalog of sources to measure for a data reference,
+        with their Footprints attached.
+
+        Parameters
+        ----------
+        dataRef : `lsst.daf.persistence.ButlerDataRef`
+            Data reference, as for `runDataRef`.
+        inputs : `lsst.pipe.base.Struct`
+            Inputs returned by `readDataRef`.
+
+        Returns
+        -------
+        measCat : `lsst.afw.table.SourceCatalog`
+            Catalog of forced sources to measure.
+        """
+        measCat = self.measurement.generateMeasCat(inputs.exposure, inputs.refCat, inputs.refWcs,
                                                    idFactory=self.makeIdFactory(dataRef))
-        self.log.info("Performing forced measurement on %s" % (dataRef.dataId,))
-        self.attachFootprints(measCat, refCat, exposure, refWcs, dataRef)
+        self.attachFootprints(measCat, inputs.refCat, inputs.exposure, inputs.refWcs, dataRef)
+        return measCat
 
-        exposureId = self.getExposureId(dataRef)
+    def measureDataRef(self, dataRef, inputs):
+        """Measure the sources of a data reference.
 
-        forcedPhotResult = self.run(measCat, exposure, refCat, refWcs, exposureId=exposureId)
+        Parameters
+        ----------
+        dataRef : `lsst.daf.persistence.ButlerDataRef`
+            Data reference, as for `runDataRef`.
+        inputs : `lsst.pipe.base.Struct`
+            Inputs returned by `readDataRef`.
 
-        self.writeOutput(dataRef, forcedPhotResult.measCat)
+        Returns
+        -------
+        measCat : `lsst.afw.table.SourceCatalog`
+            Catalog of forced measurement results.
+        """
+        measCat = self.makeMeasCat(dataRef, inputs)
+        exposureId = self.getExposureId(dataRef)
+        self.log.info("Performing forced measurement on %s" % (dataRef.dataId,))
+        forcedPhotResult = self.run(measCat, inputs.exposure, inputs.refCat, inputs.refWcs,
+                                    exposureId=exposureId)
+        return forcedPhotResult.measCat
 
     def run(self, measCat, exposure, refCat, refWcs, exposureId=None):
         """Perform forced measurement on a single exposure.
@@ -385,3 +545,19 @@ class ForcedPhotImageTask(lsst.pipe.base.PipelineTask, lsst.pipe.base.CmdLineTas
     def _getMetadataName(self):
         # Documented in superclass
         return self.dataPrefix + "forced_metadata"
+
+    def writeMetadata(self, dataRef):
+        """Write the metadata produced from processing the data.
+
+        Parameters
+        ----------
+        dataRef : `lsst.daf.persistence.ButlerDataRef` or `list` thereof
+            Butler data reference, or the data references a command-line
+            runner passed to the task in a single call; the metadata is
+            written for each of them.
+        """
+        if isinstance(dataRef, (list, tuple)):
+            for ref in dataRef:
+                super().writeMetadata(ref)
+        else:
+            super().writeMetadata(dataRef)
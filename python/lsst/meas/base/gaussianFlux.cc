@@ -21,6 +21,7 @@
  */
 
 #include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
 
 #include <memory>
 
@@ -43,11 +44,19 @@ using PyFluxAlgorithm =
 using PyFluxControl = py::class_<GaussianFluxControl>;
 using PyFluxTransform =
         py::class_<GaussianFluxTransform, std::shared_ptr<GaussianFluxTransform>, BaseTransform>;
+using PyMultiScaleFluxAlgorithm =
+        py::class_<MultiScaleGaussianFluxAlgorithm, std::shared_ptr<MultiScaleGaussianFluxAlgorithm>,
+                   SimpleAlgorithm>;
+using PyMultiScaleFluxControl = py::class_<MultiScaleGaussianFluxControl>;
+using PyMultiScaleFluxTransform =
+        py::class_<MultiScaleGaussianFluxTransform, std::shared_ptr<MultiScaleGaussianFluxTransform>,
+                   BaseTransform>;
 
 PyFluxControl declareFluxControl(py::module &mod) {
     PyFluxControl cls(mod, "GaussianFluxControl");
 
     LSST_DECLARE_CONTROL_FIELD(cls, GaussianFluxControl, background);
+    LSST_DECLARE_CONTROL_FIELD(cls, GaussianFluxControl, doReuseWeightedSum);
 
     return cls;
 }
@@ -60,7 +69,8 @@ PyFluxAlgorithm declareFluxAlgorithm(py::module &mod) {
 
     cls.attr("FAILURE") = py::cast(GaussianFluxAlgorithm::FAILURE);
 
-    cls.def("measure", &GaussianFluxAlgorithm::measure, "measRecord"_a, "exposure"_a);
+    cls.def("measure", &GaussianFluxAlgorithm::measure, "measRecord"_a, "exposure"_a,
+            py::call_guard<py::gil_scoped_release>());
     cls.def("fail", &GaussianFluxAlgorithm::fail, "measRecord"_a, "error"_a = nullptr);
 
     return cls;
@@ -76,6 +86,45 @@ PyFluxTransform declareFluxTransform(py::module &mod) {
     return cls;
 }
 
+PyMultiScaleFluxControl declareMultiScaleFluxControl(py::module &mod) {
+    PyMultiScaleFluxControl cls(mod, "MultiScaleGaussianFluxControl");
+
+    LSST_DECLARE_CONTROL_FIELD(cls, MultiScaleGaussianFluxControl, scales);
+
+    return cls;
+}
+
+PyMultiScaleFluxAlgorithm declareMultiScaleFluxAlgorithm(py::module &mod) {
+    PyMultiScaleFluxAlgorithm cls(mod, "MultiScaleGaussianFluxAlgorithm");
+
+    cls.def(py::init<MultiScaleGaussianFluxAlgorithm::Control const &, std::string const &,
+                     afw::table::Schema &>(),
+            "ctrl"_a, "name"_a, "schema"_a);
+
+    cls.attr("FAILURE") = py::cast(MultiScaleGaussianFluxAlgorithm::FAILURE);
+
+    cls.def("measure", &MultiScaleGaussianFluxAlgorithm::measure, "measRecord"_a, "exposure"_a,
+            py::call_guard<py::gil_scoped_release>());
+    cls.def("fail", &MultiScaleGaussianFluxAlgorithm::fail, "measRecord"_a, "error"_a = nullptr);
+    cls.def_static("makeFieldPrefix", &MultiScaleGaussianFluxAlgorithm::makeFieldPrefix, "name"_a,
+                   "scale"_a);
+
+    return cls;
+}
+
+PyMultiScaleFluxTransform declareMultiScaleFluxTransform(py::module &mod) {
+    PyMultiScaleFluxTransform cls(mod, "MultiScaleGaussianFluxTransform");
+
+    cls.def(py::init<MultiScaleGaussianFluxTransform::Control const &, std::string const &,
+                     afw::table::SchemaMapper &>(),
+            "ctrl"_a, "name"_a, "mapper"_a);
+
+    cls.def("__call__", &MultiScaleGaussianFluxTransform::operator(), "inputCatalog"_a, "outputCatalog"_a,
+            "wcs"_a, "photoCalib"_a);
+
+    return cls;
+}
+
 }  // namespace
 
 PYBIND11_MODULE(gaussianFlux, mod) {
@@ -93,6 +142,17 @@ PYBIND11_MODULE(gaussianFlux, mod) {
 
     python::declareAlgorithm<GaussianFluxAlgorithm, GaussianFluxControl, GaussianFluxTransform>(
             clsFluxAlgorithm, clsFluxControl, clsFluxTransform);
+
+    auto clsMultiScaleFluxControl = declareMultiScaleFluxControl(mod);
+    auto clsMultiScaleFluxAlgorithm = declareMultiScaleFluxAlgorithm(mod);
+    auto clsMultiScaleFluxTransform = declareMultiScaleFluxTransform(mod);
+
+    clsMultiScaleFluxAlgorithm.attr("Control") = clsMultiScaleFluxControl;
+    clsMultiScaleFluxTransform.attr("Control") = clsMultiScaleFluxControl;
+
+    python::declareAlgorithm<MultiScaleGaussianFluxAlgorithm, MultiScaleGaussianFluxControl,
+                             MultiScaleGaussianFluxTransform>(
+            clsMultiScaleFluxAlgorithm, clsMultiScaleFluxControl, clsMultiScaleFluxTransform);
 }
 
 }  // namespace base
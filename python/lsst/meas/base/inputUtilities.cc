@@ -22,6 +22,8 @@
 
 #include "pybind11/pybind11.h"
 
+#include "ndarray/pybind11.h"
+
 #include "lsst/afw/table/Source.h"
 #include "lsst/meas/base/InputUtilities.h"
 
@@ -33,6 +35,7 @@ namespace meas {
 namespace base {
 
 PYBIND11_MODULE(inputUtilities, mod) {
+    py::module::import("lsst.afw.geom");
     py::module::import("lsst.afw.table");
 
     py::class_<SafeCentroidExtractor> clsSafeCentroidExtractor(mod, "SafeCentroidExtractor");
@@ -44,6 +47,18 @@ PYBIND11_MODULE(inputUtilities, mod) {
                                  [](SafeCentroidExtractor const &self, afw::table::SourceRecord &record,
                                     FlagHandler const &flags) { return self(record, flags); },
                                  "record"_a, "flags"_a);
+    clsSafeCentroidExtractor.def("extractAll", &SafeCentroidExtractor::extractAll, "catalog"_a, "flags"_a);
+
+    py::class_<SafeShapeExtractor> clsSafeShapeExtractor(mod, "SafeShapeExtractor");
+
+    clsSafeShapeExtractor.def(py::init<afw::table::Schema &, std::string const &>(), "schema"_a, "name"_a);
+
+    clsSafeShapeExtractor.def("__call__",
+                              [](SafeShapeExtractor const &self, afw::table::SourceRecord &record,
+                                 FlagHandler const &flags) { return self(record, flags); },
+                              "record"_a, "flags"_a);
+
+    mod.def("extractFootprintAreas", &extractFootprintAreas, "catalog"_a);
 }
 
 }  // namespace base
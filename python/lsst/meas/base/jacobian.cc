@@ -0,0 +1,80 @@
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018  AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+
+#include <memory>
+
+#include "lsst/pex/config/python.h"
+#include "lsst/meas/base/python.h"
+
+#include "lsst/meas/base/Jacobian.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+namespace {
+
+using PyAlgorithm = py::class_<JacobianAlgorithm, std::shared_ptr<JacobianAlgorithm>, SimpleAlgorithm>;
+using PyControl = py::class_<JacobianControl>;
+
+PyControl declareControl(py::module &mod) {
+    PyControl cls(mod, "JacobianControl");
+
+    LSST_DECLARE_CONTROL_FIELD(cls, JacobianControl, pixelScale);
+
+    cls.def(py::init<>());
+
+    return cls;
+}
+
+PyAlgorithm declareAlgorithm(py::module &mod) {
+    PyAlgorithm cls(mod, "JacobianAlgorithm");
+
+    cls.def(py::init<JacobianAlgorithm::Control const &, std::string const &, afw::table::Schema &>(),
+            "ctrl"_a, "name"_a, "schema"_a);
+
+    return cls;
+}
+
+}  // namespace
+
+PYBIND11_MODULE(jacobian, mod) {
+    py::module::import("lsst.afw.table");
+    py::module::import("lsst.meas.base.algorithm");
+
+    auto clsControl = declareControl(mod);
+    auto clsAlgorithm = declareAlgorithm(mod);
+
+    clsAlgorithm.attr("Control") = clsControl;
+
+    python::declareAlgorithm<JacobianAlgorithm, JacobianControl>(clsAlgorithm, clsControl);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -19,12 +19,22 @@
 # You should have received a copy of the GNU General Public License
 # along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
+import collections
+import time
 from collections.abc import Iterable
 
 from lsst.afw.table import Schema, SourceCatalog
-from lsst.meas.base import NoiseReplacer, NoiseReplacerConfig
+from lsst.meas.base import NoiseReplacer, NoiseReplacerConfig, ScratchNoiseReplacer, DummyNoiseReplacer
 from lsst.meas.base import SingleFrameMeasurementTask as SFMT  # noqa N814
 
+SlowSourceRerun = collections.namedtuple("SlowSourceRerun", ("id", "plugin", "wallTimes", "record"))
+SlowSourceRerun.__doc__ = """Result of re-measuring one slow source with `rerunSlowSources`.
+
+The fields are the source ID (`int`), the plugin name (`str`), the wall
+time of each repeat in seconds (`list` of `float`) and a copy of the source
+record holding the new measurement (`lsst.afw.table.SourceRecord`).
+"""
+
 
 def rebuildNoiseReplacer(exposure, measCat):
     """Recreate the `NoiseReplacer` used in measurement.
@@ -156,3 +166,112 @@ def makeRerunCatalog(schema, oldCatalog, idList, fields=None,
         for entry in fields:
             src[entry] = oldSrc[entry]
     return measCat
+
+
+def getSlowSources(metadata):
+    """Return the slowest (source, plugin) calls recorded by a measurement
+    task.
+
+    Parameters
+    ----------
+    metadata : `lsst.daf.base.PropertySet`
+        Metadata written by a measurement task run with ``doTiming`` set and
+        ``timingSlowSourceCount`` > 0 (normally the task's ``algMetadata``).
+
+    Returns
+    -------
+    slowSources : `list` of `tuple` of (`int`, `str`)
+        Source ID and plugin name of each call, slowest first; empty if no
+        slow calls were recorded.
+    """
+    if not metadata.exists("TIMING_SLOW_IDS"):
+        return []
+    return list(zip(metadata.getArray("TIMING_SLOW_IDS"), metadata.getArray("TIMING_SLOW_PLUGINS")))
+
+
+def rerunSlowSources(task, exposure, measCat, metadata=None, exposureId=None, nRepeats=1):
+    """Re-measure the slowest (source, plugin) calls of a single-frame
+    measurement run in isolation, for profiling.
+
+    Parameters
+    ----------
+    task : `SingleFrameMeasurementTask`
+        The task that made the measurements, with the same configuration.
+    exposure : `lsst.afw.image.Exposure`
+        The image on which measurements were made.
+    measCat : `lsst.afw.table.SourceCatalog`
+        Catalog containing the results of the measurement; its records are
+        not modified.
+    metadata : `lsst.daf.base.PropertySet`, optional
+        Metadata containing the slow calls (see `getSlowSources`); defaults
+        to ``task.algMetadata``.
+    exposureId : `int`, optional
+        Exposure ID used to seed the noise replacement; defaults to the one
+        recorded in the metadata of ``measCat``, if any.
+    nRepeats : `int`, optional
+        Number of times to measure each source with its plugin.
+
+    Returns
+    -------
+    reruns : `list` of `SlowSourceRerun`
+        The results, slowest (in the original run) first.
+
+    Notes
+    -----
+    Neighbors are replaced by noise exactly as in the original run (with the
+    noise replacer configured by ``task.config.noiseReplacer``, all the
+    footprints in ``measCat`` and the same seed), and each slow source is
+    then inserted and measured with only the plugin that was slow on it.
+    Undeblended plugins (see ``task.config.undeblended``) are instead re-run
+    on the restored image once the noise replacer is done, as in the original
+    run.  The measurement is made on a copy of the source's record, which
+    keeps the slot values the plugin originally read.
+    """
+    if metadata is None:
+        metadata = task.algMetadata
+    if exposureId is None:
+        catMetadata = measCat.getMetadata()
+        if catMetadata is not None and catMetadata.exists(SFMT.NOISE_EXPOSURE_ID):
+            exposureId = catMetadata.getScalar(SFMT.NOISE_EXPOSURE_ID)
+    records = {record.getId(): record for record in measCat}
+    undeblendedPlugins = {plugin.name: plugin for plugin in task.undeblendedPlugins.iter()}
+    slowSources = getSlowSources(metadata)
+    for srcId, pluginName in slowSources:
+        if pluginName not in task.plugins and pluginName not in undeblendedPlugins:
+            raise KeyError("Plugin %s is not run by the task" % (pluginName,))
+    reruns = [None]*len(slowSources)
+
+    def rerun(index, plugin, measExposure):
+        srcId, pluginName = slowSources[index]
+        record = measCat.table.copyRecord(records[srcId])
+        wallTimes = []
+        for repeat in range(nRepeats):
+            start = time.perf_counter()
+            task.doMeasurement(plugin, record, measExposure)
+            wallTimes.append(time.perf_counter() - start)
+        reruns[index] = SlowSourceRerun(srcId, pluginName, wallTimes, record)
+
+    if task.config.doReplaceWithNoise:
+        footprints = {record.getId(): (record.getParent(), record.getFootprint()) for record in measCat}
+        NoiseReplacerClass = (ScratchNoiseReplacer if task.config.noiseReplacer.useScratchImages
+                              else NoiseReplacer)
+        noiseReplacer = NoiseReplacerClass(task.config.noiseReplacer, exposure, footprints,
+                                           exposureId=exposureId, detectionMasks=task.needsDetectionMasks())
+    else:
+        noiseReplacer = DummyNoiseReplacer()
+    try:
+        for index, (srcId, pluginName) in enumerate(slowSources):
+            if pluginName not in task.plugins:
+                continue
+            measExposure = noiseReplacer.insertSource(srcId)
+            if measExposure is None:
+                measExposure = exposure
+            rerun(index, task.plugins[pluginName], measExposure)
+            noiseReplacer.removeSource(srcId)
+    finally:
+        noiseReplacer.end()
+    # The undeblended plugins measure the restored image, without noise replacement.
+    for index, (srcId, pluginName) in enumerate(slowSources):
+        if pluginName in undeblendedPlugins:
+            rerun(index, undeblendedPlugins[pluginName], exposure)
+    return reruns
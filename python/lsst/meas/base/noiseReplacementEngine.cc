@@ -0,0 +1,57 @@
+/*
+ * LSST Data Management System
+ * Copyright 2008-2019 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+
+#include "lsst/meas/base/NoiseReplacementEngine.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+PYBIND11_MODULE(noiseReplacementEngine, mod) {
+    py::module::import("lsst.afw.detection");
+    py::module::import("lsst.afw.image");
+
+    py::class_<NoiseReplacementEngine, std::shared_ptr<NoiseReplacementEngine>> cls(mod,
+                                                                                   "NoiseReplacementEngine");
+
+    cls.def(py::init<std::shared_ptr<afw::image::Exposure<float> const>,
+                     NoiseReplacementEngine::FootprintMap const&, double, double, bool, std::uint64_t, int,
+                     std::shared_ptr<afw::image::Image<float> const>, bool>(),
+            "exposure"_a, "footprints"_a, "noiseMean"_a, "noiseStd"_a, "useVariancePlane"_a, "seed"_a,
+            "border"_a, "noiseImage"_a = nullptr, "detectionMasks"_a = true);
+
+    cls.def("computeScratchBBox", &NoiseReplacementEngine::computeScratchBBox, "id"_a);
+    cls.def("makeScratch", &NoiseReplacementEngine::makeScratch, "id"_a,
+            py::call_guard<py::gil_scoped_release>());
+    cls.def("getExposure", &NoiseReplacementEngine::getExposure);
+    cls.def("getBorder", &NoiseReplacementEngine::getBorder);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
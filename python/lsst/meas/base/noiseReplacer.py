@@ -26,7 +26,10 @@ import lsst.afw.image as afwImage
 import lsst.afw.math as afwMath
 import lsst.pex.config
 
-__all__ = ("NoiseReplacerConfig", "NoiseReplacer", "DummyNoiseReplacer")
+from .counterBasedNoise import CounterBasedNoise
+from .noiseReplacementEngine import NoiseReplacementEngine
+
+__all__ = ("NoiseReplacerConfig", "NoiseReplacer", "ScratchNoiseReplacer", "DummyNoiseReplacer")
 
 
 class NoiseReplacerConfig(lsst.pex.config.Config):
@@ -52,6 +55,29 @@ class NoiseReplacerConfig(lsst.pex.config.Config):
             ">= 1: set the seed deterministically based on exposureId\n"
             "0: fall back to the afw.math.Random default constructor (which uses a seed value of 1)"
     )
+    noiseRng = lsst.pex.config.ChoiceField(
+        doc="How to generate the Gaussian noise (ignored when a noise image is supplied)?",
+        dtype=str,
+        allowed={
+            'sequential': "Draw the noise for all footprints up front from a single random sequence "
+                          "and keep it for the whole run; depends on the order of the footprints",
+            'counter': "Compute the noise for each pixel from a counter-based generator keyed by the "
+                       "seed, the top-level footprint ID and the pixel position, regenerating it "
+                       "whenever it is needed; independent of source order and thread count",
+        },
+        default='sequential', optional=False
+    )
+    useScratchImages = lsst.pex.config.Field(
+        dtype=bool, default=False,
+        doc="Measure each source on a small copy of the pixels around it, with its neighbors replaced "
+            "by noise (ScratchNoiseReplacer), instead of replacing all sources with noise in the "
+            "exposure itself (NoiseReplacer).  The exposure is then never modified."
+    )
+    scratchBorder = lsst.pex.config.RangeField(
+        dtype=int, default=100, min=0,
+        doc="Number of pixels by which the scratch images used when useScratchImages is set extend the "
+            "source footprint's bounding box; should cover the largest region any plugin examines."
+    )
 
 
 class NoiseReplacer:
@@ -76,6 +102,12 @@ class NoiseReplacer:
     log : `lsst.log.log.log.Log`, optional
         Logger to use for status messages; no status messages will be recorded
         if `None`.
+    detectionMasks : `bool`, optional
+        Maintain the ``THISDET`` and ``OTHERDET`` mask planes, marking the
+        source being measured and the neighbors replaced by noise.  The
+        measurement tasks only set this if an active plugin needs the planes
+        (see `~lsst.meas.base.BasePlugin.needsDetectionMasks`); if `False`
+        the mask is never written.
 
     Notes
     -----
@@ -116,6 +148,11 @@ class NoiseReplacer:
     reproduced here. In that case, the topmost parent in the objects parent
     chain must be used. The heavy footprint for that source is created in
     this class from the masked image.
+
+    If ``detectionMasks`` is set, the ``THISDET`` and ``OTHERDET`` planes
+    of the exposure's own mask are updated for every source inserted and
+    removed, since the plugins measure on the full exposure.
+    `ScratchNoiseReplacer` provides them as a per-source overlay instead.
     """
 
     ConfigClass = NoiseReplacerConfig
@@ -132,14 +169,17 @@ class NoiseReplacer:
     """Logger used for status messages.
     """
 
-    def __init__(self, config, exposure, footprints, noiseImage=None, exposureId=None, log=None):
+    def __init__(self, config, exposure, footprints, noiseImage=None, exposureId=None, log=None,
+                 detectionMasks=True):
         noiseMeanVar = None
         self.noiseSource = config.noiseSource
         self.noiseOffset = config.noiseOffset
         self.noiseSeedMultiplier = config.noiseSeedMultiplier
+        self.noiseRng = config.noiseRng
         self.noiseGenMean = None
         self.noiseGenStd = None
         self.log = log
+        self.detectionMasks = detectionMasks
 
         # creates heavies, replaces all footprints with noise
         # We need the source table to be sorted by ID to do the parent lookups
@@ -151,7 +191,7 @@ class NoiseReplacer:
         # Add temporary Mask planes for THISDET and OTHERDET
         self.removeplanes = []
         bitmasks = []
-        for maskname in ['THISDET', 'OTHERDET']:
+        for maskname in (['THISDET', 'OTHERDET'] if detectionMasks else []):
             try:
                 # does it already exist?
                 plane = mask.getMaskPlane(maskname)
@@ -167,7 +207,7 @@ class NoiseReplacer:
             if self.log:
                 self.log.debug('Mask plane "%s": plane %i, bitmask %i = 0x%x',
                                maskname, plane, bitmask, bitmask)
-        self.thisbitmask, self.otherbitmask = bitmasks
+        self.thisbitmask, self.otherbitmask = bitmasks if detectionMasks else (0, 0)
         del bitmasks
         self.heavies = {}
         # Start by creating HeavyFootprints for each source which has no parent
@@ -193,23 +233,38 @@ class NoiseReplacer:
 
         # We now create a noise HeavyFootprint for each source with has a heavy footprint.
         # We'll put the noise footprints in a dict heavyNoise = {id:heavyNoiseFootprint}
+        # A counter-based generator can recreate the same noise at any time, so
+        # in that case nothing is stored and the noise is regenerated in
+        # removeSource instead.
         self.heavyNoise = {}
         noisegen = self.getNoiseGenerator(exposure, noiseImage, noiseMeanVar, exposureId=exposureId)
+        self.noiseGenerator = noisegen
         #  The noiseGenMean and Std are used by the unit tests
         self.noiseGenMean = noisegen.mean
-        self.noiseGenStd = noisegen.std
+        self.noiseGenStd = getattr(noisegen, "std", None)
         if self.log:
             self.log.debug('Using noise generator: %s', str(noisegen))
         for id in self.heavies:
             fp = footprints[id][1]
-            noiseFp = noisegen.getHeavyFootprint(fp)
-            self.heavyNoise[id] = noiseFp
-            # Also insert the noisy footprint into the image now.
-            # Notice that we're just inserting it into "im", ie,
-            # the Image, not the MaskedImage.
-            noiseFp.insert(im)
+            if noisegen.isCounterBased():
+                noisegen.insertNoise(self._getTopId(id), fp, im)
+            else:
+                noiseFp = noisegen.getHeavyFootprint(fp)
+                self.heavyNoise[id] = noiseFp
+                # Also insert the noisy footprint into the image now.
+                # Notice that we're just inserting it into "im", ie,
+                # the Image, not the MaskedImage.
+                noiseFp.insert(im)
             # Also set the OTHERDET bit
-            fp.spans.setMask(mask, self.otherbitmask)
+            if self.detectionMasks:
+                fp.spans.setMask(mask, self.otherbitmask)
+
+    def _getTopId(self, id):
+        """Return the ID of the top-level parent of a source.
+        """
+        while self.footprints[id][0] != 0:
+            id = self.footprints[id][0]
+        return id
 
     def insertSource(self, id):
         """Insert the heavy footprint of a given source into the exposure.
@@ -235,8 +290,9 @@ class NoiseReplacer:
             usedid = self.footprints[usedid][0]
         fp = self.heavies[usedid]
         fp.insert(im)
-        fp.spans.setMask(mask, self.thisbitmask)
-        fp.spans.clearMask(mask, self.otherbitmask)
+        if self.detectionMasks:
+            fp.spans.setMask(mask, self.thisbitmask)
+            fp.spans.clearMask(mask, self.otherbitmask)
 
     def removeSource(self, id):
         """Replace the heavy footprint of a given source with noise.
@@ -265,11 +321,16 @@ class NoiseReplacer:
         while self.footprints[usedid][0] != 0 and usedid not in self.heavies:
             usedid = self.footprints[usedid][0]
         # Re-insert the noise pixels
-        fp = self.heavyNoise[usedid]
-        fp.insert(im)
+        if self.noiseGenerator.isCounterBased():
+            fp = self.footprints[usedid][1]
+            self.noiseGenerator.insertNoise(self._getTopId(usedid), fp, im)
+        else:
+            fp = self.heavyNoise[usedid]
+            fp.insert(im)
         # Clear the THISDET mask plane.
-        fp.spans.clearMask(mask, self.thisbitmask)
-        fp.spans.setMask(mask, self.otherbitmask)
+        if self.detectionMasks:
+            fp.spans.clearMask(mask, self.thisbitmask)
+            fp.spans.setMask(mask, self.otherbitmask)
 
     def end(self):
         """End the NoiseReplacer.
@@ -294,6 +355,23 @@ class NoiseReplacer:
         del self.otherbitmask
         del self.heavies
         del self.heavyNoise
+        del self.noiseGenerator
+
+    def getNoiseSeed(self, exposureId=None):
+        """Return the seed for the noise generator.
+
+        Returns
+        -------
+        seed : `int` or `None`
+            ``exposureId*noiseSeedMultiplier``, or just the multiplier if
+            there is no exposure ID; `None` if ``noiseSeedMultiplier`` is 0.
+        """
+        if not self.noiseSeedMultiplier:
+            return None
+        # default plugin, our seed
+        if exposureId is not None and exposureId != 0:
+            return exposureId*self.noiseSeedMultiplier
+        return self.noiseSeedMultiplier
 
     def getNoiseGenerator(self, exposure, noiseImage, noiseMeanVar, exposureId=None):
         """Return a generator of artificial noise.
@@ -305,12 +383,10 @@ class NoiseReplacer:
         if noiseImage is not None:
             return ImageNoiseGenerator(noiseImage)
         rand = None
-        if self.noiseSeedMultiplier:
-            # default plugin, our seed
-            if exposureId is not None and exposureId != 0:
-                seed = exposureId*self.noiseSeedMultiplier
-            else:
-                seed = self.noiseSeedMultiplier
+        seed = self.getNoiseSeed(exposureId)
+        if self.noiseRng == 'counter':
+            rand = CounterBasedNoise(seed if seed is not None else 1)
+        elif seed is not None:
             rand = afwMath.Random(afwMath.Random.MT19937, seed)
         if noiseMeanVar is not None:
             try:
@@ -363,6 +439,121 @@ class NoiseReplacer:
         return FixedGaussianNoiseGenerator(noiseMean + offset, noiseStd, rand=rand)
 
 
+class ScratchNoiseReplacer(NoiseReplacer):
+    """Replace sources with noise in per-source copies of the image.
+
+    Parameters
+    ----------
+    config : `NoiseReplacerConfig`
+        Configuration.
+    exposure : `lsst.afw.image.Exposure`
+        Image containing the sources to be measured.  Its pixels are never
+        modified; only the ``THISDET`` and ``OTHERDET`` planes are added to
+        its mask plane dictionary for the lifetime of the replacer, if
+        ``detectionMasks`` is set.
+    footprints : `dict`
+        Mapping of ``id`` to a tuple of ``(parent, Footprint)``, as for
+        `NoiseReplacer`.
+    noiseImage : `lsst.afw.image.ImageF`, optional
+        An image used as a predictable noise replacement source. Used during
+        testing only.
+    exposureId : `int`, optional
+        Used to seed the noise, as for `NoiseReplacer`.
+    log : `lsst.log.log.log.Log`, optional
+        Logger to use for status messages.
+    detectionMasks : `bool`, optional
+        Set the ``THISDET`` and ``OTHERDET`` planes in each scratch image.
+        They are an overlay private to the source being measured: the mask of
+        the exposure is never written.
+
+    Notes
+    -----
+    This has the same interface as `NoiseReplacer`, except that
+    `insertSource` returns the image the source should be measured on: a
+    copy of the region around the source (its footprint's bounding box
+    grown by ``config.scratchBorder``) in which all other sources are
+    replaced by noise, exactly as `NoiseReplacer` would have left the full
+    exposure.  Because only that small region is ever copied and the
+    exposure itself is left untouched, there is nothing to restore after
+    each source or at the end, and nothing that prevents several sources
+    being measured at once.
+
+    The noise that replaces each neighbor depends only on the seed, the
+    neighbor's ID and the pixel position, so it is the same for every
+    source, and the same as a `NoiseReplacer` with ``noiseRng='counter'``
+    draws.  Plugins that look
+    further than ``scratchBorder`` pixels beyond the footprint will see
+    the edge of the scratch image instead of the rest of the exposure.
+    """
+
+    def __init__(self, config, exposure, footprints, noiseImage=None, exposureId=None, log=None,
+                 detectionMasks=True):
+        self.noiseSource = config.noiseSource
+        self.noiseOffset = config.noiseOffset
+        self.noiseSeedMultiplier = config.noiseSeedMultiplier
+        # The engine always generates its noise on demand.
+        self.noiseRng = 'counter'
+        self.log = log
+        self.exposure = exposure
+        self.footprints = footprints
+
+        mask = exposure.getMaskedImage().getMask()
+        self.removeplanes = []
+        for maskname in (['THISDET', 'OTHERDET'] if detectionMasks else []):
+            try:
+                mask.getMaskPlane(maskname)
+            except Exception:
+                mask.addMaskPlane(maskname)
+                self.removeplanes.append(maskname)
+
+        noisegen = self.getNoiseGenerator(exposure, noiseImage, None, exposureId=exposureId)
+        #  The noiseGenMean and Std are used by the unit tests
+        self.noiseGenMean = noisegen.mean
+        self.noiseGenStd = getattr(noisegen, "std", None)
+        if self.log:
+            self.log.debug('Using noise generator: %s', str(noisegen))
+        seed = noisegen.rand.getSeed() if noisegen.isCounterBased() else 0
+        if isinstance(noisegen, ImageNoiseGenerator):
+            self.engine = NoiseReplacementEngine(exposure, footprints, 0.0, 0.0, False, seed,
+                                                 config.scratchBorder, noiseImage=noiseImage,
+                                                 detectionMasks=detectionMasks)
+        elif isinstance(noisegen, VariancePlaneNoiseGenerator):
+            self.engine = NoiseReplacementEngine(exposure, footprints, noisegen.mean or 0.0, 0.0, True, seed,
+                                                 config.scratchBorder, detectionMasks=detectionMasks)
+        else:
+            self.engine = NoiseReplacementEngine(exposure, footprints, noisegen.mean, noisegen.std, False,
+                                                 seed, config.scratchBorder, detectionMasks=detectionMasks)
+
+    def insertSource(self, id):
+        """Return a copy of the region around a source with its neighbors replaced by noise.
+
+        Parameters
+        ----------
+        id : `int`
+            ID of the source from the original dictionary of footprints.
+
+        Returns
+        -------
+        scratch : `lsst.afw.image.ExposureF`
+            Image on which the source should be measured.
+        """
+        return self.engine.makeScratch(id)
+
+    def removeSource(self, id):
+        """Mark the end of the measurement of a source (does nothing).
+        """
+        pass
+
+    def end(self):
+        """End the ScratchNoiseReplacer, removing any mask planes it added.
+        """
+        mask = self.exposure.getMaskedImage().getMask()
+        for maskname in self.removeplanes:
+            mask.removeAndClearMaskPlane(maskname, True)
+        del self.removeplanes
+        del self.engine
+
+
 class NoiseReplacerList(list):
     """Make a list of NoiseReplacers behave like a single one.
 
@@ -418,6 +609,25 @@ class NoiseGenerator:
         mim = self.getMaskedImage(bb)
         return afwDet.makeHeavyFootprint(fp, mim)
 
+    def isCounterBased(self):
+        """Return whether `insertNoise` can regenerate identical noise on demand.
+        """
+        return False
+
+    def insertNoise(self, id, fp, image):
+        """Set the pixels of ``image`` within a footprint to noise.
+
+        Parameters
+        ----------
+        id : `int`
+            ID keying the noise; only used by counter-based generators.
+        fp : `lsst.afw.detection.Footprint`
+            Footprint whose pixels are replaced.
+        image : `lsst.afw.image.ImageF`
+            Image to modify.
+        """
+        self.getHeavyFootprint(fp).insert(image)
+
     def getMaskedImage(self, bb):
         im = self.getImage(bb)
         return afwImage.MaskedImageF(im)
@@ -446,6 +656,9 @@ class ImageNoiseGenerator(NoiseGenerator):
 
 class GaussianNoiseGenerator(NoiseGenerator):
     """Abstract base for Gaussian noise generators.
+
+    ``rand`` is either an `lsst.afw.math.Random`, or a `CounterBasedNoise`,
+    in which case the noise is only available through `insertNoise`.
     """
 
     def __init__(self, rand=None):
@@ -453,6 +666,9 @@ class GaussianNoiseGenerator(NoiseGenerator):
             rand = afwMath.Random()
         self.rand = rand
 
+    def isCounterBased(self):
+        return isinstance(self.rand, CounterBasedNoise)
+
     def getRandomImage(self, bb):
         # Create an Image and fill it with Gaussian noise.
         rim = afwImage.ImageF(bb.getWidth(), bb.getHeight())
@@ -479,6 +695,11 @@ class FixedGaussianNoiseGenerator(GaussianNoiseGenerator):
         rim += self.mean
         return rim
 
+    def insertNoise(self, id, fp, image):
+        if not self.isCounterBased():
+            return super().insertNoise(id, fp, image)
+        self.rand.fillImage(id, fp.spans.clippedTo(image.getBBox()), image, self.mean, self.std)
+
 
 class VariancePlaneNoiseGenerator(GaussianNoiseGenerator):
     """Generates Gaussian noise with variance matching an image variance plane.
@@ -511,6 +732,12 @@ class VariancePlaneNoiseGenerator(GaussianNoiseGenerator):
             rim += self.mean
         return rim
 
+    def insertNoise(self, id, fp, image):
+        if not self.isCounterBased():
+            return super().insertNoise(id, fp, image)
+        spans = fp.spans.clippedTo(image.getBBox()).clippedTo(self.var.getBBox())
+        self.rand.fillImage(id, spans, image, self.var, self.mean if self.mean is not None else 0.0)
+
 
 class DummyNoiseReplacer:
     """A noise replacer which does nothing.
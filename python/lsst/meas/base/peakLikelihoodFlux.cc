@@ -59,7 +59,8 @@ PyFluxAlgorithm declareFluxAlgorithm(py::module &mod) {
                      afw::table::Schema &>(),
             "ctrl"_a, "name"_a, "schema"_a);
 
-    cls.def("measure", &PeakLikelihoodFluxAlgorithm::measure, "measRecord"_a, "exposure"_a);
+    cls.def("measure", &PeakLikelihoodFluxAlgorithm::measure, "measRecord"_a, "exposure"_a,
+            py::call_guard<py::gil_scoped_release>());
     cls.def("fail", &PeakLikelihoodFluxAlgorithm::fail, "measRecord"_a, "error"_a = nullptr);
 
     return cls;
@@ -50,7 +50,8 @@ PYBIND11_MODULE(pixelFlags, mod) {
 
     clsPixelFlagsControl.def(py::init<>());
 
-    clsPixelFlagsAlgorithm.def("measure", &PixelFlagsAlgorithm::measure, "measRecord"_a, "exposure"_a);
+    clsPixelFlagsAlgorithm.def("measure", &PixelFlagsAlgorithm::measure, "measRecord"_a, "exposure"_a,
+                               py::call_guard<py::gil_scoped_release>());
     clsPixelFlagsAlgorithm.def("fail", &PixelFlagsAlgorithm::fail, "measRecord"_a, "error"_a = nullptr);
 
     LSST_DECLARE_CONTROL_FIELD(clsPixelFlagsControl, PixelFlagsControl, masksFpAnywhere);
@@ -0,0 +1,72 @@
+/*
+ * LSST Data Management System
+ * Copyright 2008-2017  AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+
+#include <limits>
+
+#include "lsst/meas/base/PluginChain.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+PYBIND11_MODULE(pluginChain, mod) {
+    py::module::import("lsst.afw.geom");
+    py::module::import("lsst.afw.image");
+    py::module::import("lsst.afw.table");
+    py::module::import("lsst.meas.base.algorithm");
+    py::module::import("lsst.meas.base.preconditions");
+
+    double const inf = std::numeric_limits<double>::infinity();
+
+    py::class_<PluginChain, std::shared_ptr<PluginChain>> cls(mod, "PluginChain");
+
+    cls.def(py::init<>());
+
+    cls.def("addSingleFrame", &PluginChain::addSingleFrame, "algorithm"_a, "executionOrder"_a);
+    // ForcedAlgorithm is not itself wrapped, so forced algorithms are accepted as SimpleAlgorithms.
+    cls.def("addForced",
+            [](PluginChain &self, std::shared_ptr<SimpleAlgorithm const> algorithm, double executionOrder) {
+                self.addForced(algorithm, executionOrder);
+            },
+            "algorithm"_a, "executionOrder"_a);
+    cls.def("setPreconditions", &PluginChain::setPreconditions, "index"_a, "preconditions"_a);
+    cls.def("setLogName", &PluginChain::setLogName, "index"_a, "logName"_a);
+    cls.def("setBadMaskPlanes", &PluginChain::setBadMaskPlanes, "badMaskPlanes"_a);
+    cls.def("__len__", &PluginChain::size);
+    cls.def("empty", &PluginChain::empty);
+    cls.def("getMinExecutionOrder", &PluginChain::getMinExecutionOrder);
+    cls.def("getMaxExecutionOrder", &PluginChain::getMaxExecutionOrder);
+    cls.def("measure", &PluginChain::measure, "measRecord"_a, "exposure"_a, "beginOrder"_a = -inf,
+            "endOrder"_a = inf, py::call_guard<py::gil_scoped_release>());
+    cls.def("measureForced", &PluginChain::measureForced, "measRecord"_a, "exposure"_a, "refRecord"_a,
+            "refWcs"_a, "beginOrder"_a = -inf, "endOrder"_a = inf, py::call_guard<py::gil_scoped_release>());
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
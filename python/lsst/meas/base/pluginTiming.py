@@ -0,0 +1,290 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""Accumulation of per-plugin measurement timing.
+"""
+
+import bisect
+import heapq
+import itertools
+import threading
+
+import lsst.geom
+
+from .scratchArena import ScratchArena
+
+__all__ = ("PluginTiming", "SlowSource", "PluginTimer")
+
+
+class PluginTiming:
+    """Accumulated cost of running one measurement plugin.
+
+    Parameters
+    ----------
+    nBins : `int`
+        Number of bins in the per-source time histogram; zero if no histogram
+        is being accumulated.
+    """
+
+    __slots__ = ("calls", "failures", "wallTime", "histogram")
+
+    def __init__(self, nBins=0):
+        self.calls = 0
+        """Number of sources measured (`int`)."""
+        self.failures = 0
+        """Number of sources for which the plugin failed (`int`)."""
+        self.wallTime = 0.0
+        """Total wall-clock time in seconds, including Python overhead (`float`)."""
+        self.histogram = [0]*nBins
+        """Number of sources in each per-source time bin (`list` of `int`)."""
+
+
+class SlowSource:
+    """One slow call of a plugin on a source, as kept by `PluginTimer`.
+
+    Parameters
+    ----------
+    plugin : `str`
+        Name of the plugin.
+    wallTime : `float`
+        Elapsed time of the call, in seconds.
+    measRecord : `lsst.afw.table.SourceRecord`
+        Record that was measured, after the call.
+    """
+
+    __slots__ = ("id", "plugin", "wallTime", "area", "bbox", "nIter")
+
+    def __init__(self, plugin, wallTime, measRecord):
+        footprint = measRecord.getFootprint()
+        self.id = measRecord.getId()
+        """ID of the source (`int`)."""
+        self.plugin = plugin
+        """Name of the plugin (`str`)."""
+        self.wallTime = wallTime
+        """Elapsed time of the call, in seconds (`float`)."""
+        self.area = footprint.getArea() if footprint is not None else 0
+        """Number of pixels in the source's footprint (`int`)."""
+        self.bbox = footprint.getBBox() if footprint is not None else None
+        """Bounding box of the source's footprint (`lsst.geom.Box2I` or `None`)."""
+        nIterName = plugin + "_nIter"
+        self.nIter = measRecord.get(nIterName) if nIterName in measRecord.schema.getNames() else -1
+        """Number of iterations, for plugins that record it in a ``_nIter``
+        field, or -1 (`int`)."""
+
+
+class PluginTimer:
+    """Record the wall-clock time, call count and failure count of
+    measurement plugins.
+
+    Parameters
+    ----------
+    doHistogram : `bool`, optional
+        Also accumulate a histogram of the time taken to measure each source
+        with each plugin.
+    nSlowest : `int`, optional
+        Number of the slowest calls of a plugin on a single source to keep
+        (see `SlowSource`).
+
+    Notes
+    -----
+    `record` may be called from several threads at once.
+
+    The timer also counts the scratch buffers allocated by compiled plugins
+    (see `ScratchArena`) between its construction and `writeMetadata`.
+    """
+
+    HISTOGRAM_EDGES = (1E-6, 1E-5, 1E-4, 1E-3, 1E-2, 1E-1, 1.0, 10.0)
+    """Inner edges (in seconds) of the per-source time histogram bins.
+
+    The first bin holds all times below the first edge, and the last all
+    times above the last edge.
+    """
+
+    def __init__(self, doHistogram=False, nSlowest=0):
+        self.doHistogram = doHistogram
+        self.nSlowest = nSlowest
+        self._timings = {}
+        self._families = []
+        # Min-heap of (wall time, sequence number, SlowSource); the sequence
+        # number breaks ties without comparing SlowSources.
+        self._slowest = []
+        self._sequence = itertools.count()
+        self._lock = threading.Lock()
+        self._scratchStart = ScratchArena.getStatistics()
+
+    def record(self, name, wallTime, nSources=1, nFailures=0, measRecord=None):
+        """Add one call to a plugin.
+
+        Parameters
+        ----------
+        name : `str`
+            Name of the plugin.
+        wallTime : `float`
+            Elapsed time of the call, in seconds.
+        nSources : `int`, optional
+            Number of sources measured by the call; for the histogram, the time
+            is split evenly between them.
+        nFailures : `int`, optional
+            Number of those sources for which the plugin failed.
+        measRecord : `lsst.afw.table.SourceRecord`, optional
+            Record measured by a call on a single source; the call is kept if
+            it is among the ``nSlowest`` slowest.
+        """
+        if measRecord is not None and self.nSlowest > 0:
+            self._recordSlow(name, wallTime, measRecord)
+        with self._lock:
+            timing = self._timings.get(name)
+            if timing is None:
+                timing = PluginTiming(len(self.HISTOGRAM_EDGES) + 1 if self.doHistogram else 0)
+                self._timings[name] = timing
+            timing.calls += nSources
+            timing.failures += nFailures
+            timing.wallTime += wallTime
+            if self.doHistogram and nSources > 0:
+                timing.histogram[bisect.bisect(self.HISTOGRAM_EDGES, wallTime/nSources)] += nSources
+
+    def _recordSlow(self, name, wallTime, measRecord):
+        """Keep a call on a single source if it is among the slowest.
+        """
+        with self._lock:
+            if len(self._slowest) >= self.nSlowest and wallTime <= self._slowest[0][0]:
+                return
+        # Only the (rare) candidates pay for reading the footprint.
+        slow = SlowSource(name, wallTime, measRecord)
+        with self._lock:
+            entry = (wallTime, next(self._sequence), slow)
+            if len(self._slowest) < self.nSlowest:
+                heapq.heappush(self._slowest, entry)
+            elif wallTime > self._slowest[0][0]:
+                heapq.heapreplace(self._slowest, entry)
+
+    def getSlowest(self):
+        """Return the slowest calls kept, slowest first (`list` of
+        `SlowSource`).
+        """
+        with self._lock:
+            return [entry[2] for entry in sorted(self._slowest, reverse=True)]
+
+    def recordFamily(self, parentId, cost, wallTime):
+        """Add the measurement of one parent family.
+
+        Parameters
+        ----------
+        parentId : `int`
+            ID of the parent source.
+        cost : `float`
+            Estimated relative cost of the family, as used to schedule it.
+        wallTime : `float`
+            Elapsed time taken to measure the parent and all its children, in
+            seconds.
+        """
+        with self._lock:
+            self._families.append((parentId, cost, wallTime))
+
+    def getFamilies(self):
+        """Return the (parent ID, estimated cost, wall time) of every family
+        recorded, in the order they finished (`list` of `tuple`).
+        """
+        return list(self._families)
+
+    def getTiming(self, name):
+        """Return the accumulated timing of a plugin.
+
+        Parameters
+        ----------
+        name : `str`
+            Name of the plugin.
+
+        Returns
+        -------
+        timing : `PluginTiming` or `None`
+            Accumulated timing, or `None` if the plugin has not been called.
+        """
+        return self._timings.get(name)
+
+    def getNames(self):
+        """Return the names of all plugins called, in the order of their first
+        call (`list` of `str`).
+        """
+        return list(self._timings.keys())
+
+    def writeMetadata(self, metadata, plugins=()):
+        """Write the accumulated timing to a metadata object.
+
+        Parameters
+        ----------
+        metadata : `lsst.daf.base.PropertySet`
+            Metadata to fill; keys are ``TIMING_<plugin>_<quantity>``, with
+            ``WALLTIME``, ``CALLS`` and ``FAILURES`` for every plugin called,
+            ``CPPTIME`` and ``CPPCALLS`` for those that time their compiled
+            code, and ``HISTOGRAM`` if a histogram was accumulated.  The
+            histogram bin edges are written to ``TIMING_HISTOGRAM_EDGES``.
+            The numbers of scratch buffers allocated, of heap blocks allocated
+            to hold them, and the total size of those blocks in bytes are
+            written to ``TIMING_SCRATCH_BUFFERS``, ``TIMING_SCRATCH_BLOCKS``
+            and ``TIMING_SCRATCH_BLOCKBYTES``.  If any parent families were
+            recorded, their parent IDs, estimated costs and wall times are
+            written as arrays to ``TIMING_FAMILY_IDS``,
+            ``TIMING_FAMILY_COSTS`` and ``TIMING_FAMILY_WALLTIMES``.  If any
+            slow calls were kept, their source IDs, plugin names, wall times,
+            footprint areas, footprint bounding boxes and iteration counts
+            are written, slowest first, as arrays to ``TIMING_SLOW_IDS``,
+            ``TIMING_SLOW_PLUGINS``, ``TIMING_SLOW_WALLTIMES``,
+            ``TIMING_SLOW_AREAS``, ``TIMING_SLOW_MINX``, ``TIMING_SLOW_MINY``,
+            ``TIMING_SLOW_MAXX``, ``TIMING_SLOW_MAXY`` and
+            ``TIMING_SLOW_NITER``.
+        plugins : iterable of `BasePlugin`, optional
+            Plugins from which to read the time spent in compiled code.
+        """
+        for plugin in plugins:
+            cppTiming = plugin.getTiming()
+            if cppTiming is not None and plugin.name in self._timings:
+                metadata.set("TIMING_%s_CPPTIME" % plugin.name, cppTiming[0])
+                metadata.set("TIMING_%s_CPPCALLS" % plugin.name, cppTiming[1])
+        for name, timing in self._timings.items():
+            metadata.set("TIMING_%s_WALLTIME" % name, timing.wallTime)
+            metadata.set("TIMING_%s_CALLS" % name, timing.calls)
+            metadata.set("TIMING_%s_FAILURES" % name, timing.failures)
+            if self.doHistogram:
+                metadata.set("TIMING_%s_HISTOGRAM" % name, timing.histogram)
+        if self.doHistogram:
+            metadata.set("TIMING_HISTOGRAM_EDGES", list(self.HISTOGRAM_EDGES))
+        if self._families:
+            parentIds, costs, wallTimes = zip(*self._families)
+            metadata.set("TIMING_FAMILY_IDS", list(parentIds))
+            metadata.set("TIMING_FAMILY_COSTS", [float(cost) for cost in costs])
+            metadata.set("TIMING_FAMILY_WALLTIMES", list(wallTimes))
+        slowest = self.getSlowest()
+        if slowest:
+            boxes = [slow.bbox if slow.bbox is not None else lsst.geom.Box2I() for slow in slowest]
+            metadata.set("TIMING_SLOW_IDS", [slow.id for slow in slowest])
+            metadata.set("TIMING_SLOW_PLUGINS", [slow.plugin for slow in slowest])
+            metadata.set("TIMING_SLOW_WALLTIMES", [slow.wallTime for slow in slowest])
+            metadata.set("TIMING_SLOW_AREAS", [slow.area for slow in slowest])
+            metadata.set("TIMING_SLOW_MINX", [box.getMinX() for box in boxes])
+            metadata.set("TIMING_SLOW_MINY", [box.getMinY() for box in boxes])
+            metadata.set("TIMING_SLOW_MAXX", [box.getMaxX() for box in boxes])
+            metadata.set("TIMING_SLOW_MAXY", [box.getMaxY() for box in boxes])
+            metadata.set("TIMING_SLOW_NITER", [slow.nIter for slow in slowest])
+        scratch = ScratchArena.getStatistics()
+        metadata.set("TIMING_SCRATCH_BUFFERS", scratch.buffers - self._scratchStart.buffers)
+        metadata.set("TIMING_SCRATCH_BLOCKS", scratch.blocks - self._scratchStart.blocks)
+        metadata.set("TIMING_SCRATCH_BLOCKBYTES", scratch.blockBytes - self._scratchStart.blockBytes)
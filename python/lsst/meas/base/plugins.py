@@ -30,7 +30,6 @@ import numpy as np
 
 import lsst.pex.exceptions
 import lsst.geom
-import lsst.afw.detection
 import lsst.afw.geom
 
 from .pluginRegistry import register
@@ -38,25 +37,35 @@ from .pluginsBase import BasePlugin
 from .baseMeasurement import BaseMeasurementPluginConfig
 from .sfm import SingleFramePluginConfig, SingleFramePlugin
 from .forcedMeasurement import ForcedPluginConfig, ForcedPlugin
-from .wrappers import wrapSimpleAlgorithm, wrapTransform, GenericPlugin
+from .wrappers import wrapSingleFrameAlgorithm, wrapSimpleAlgorithm, wrapTransform, GenericPlugin
 from .transforms import SimpleCentroidTransform
 
 from .apertureFlux import ApertureFluxControl, ApertureFluxTransform
 from .transform import BaseTransform
 from .blendedness import BlendednessAlgorithm, BlendednessControl
 from .circularApertureFlux import CircularApertureFluxAlgorithm
-from .gaussianFlux import GaussianFluxAlgorithm, GaussianFluxControl, GaussianFluxTransform
+from .ellipticalApertureFlux import EllipticalApertureFluxAlgorithm, EllipticalApertureFluxControl, \
+    EllipticalApertureFluxTransform
+from .gaussianFlux import GaussianFluxAlgorithm, GaussianFluxControl, GaussianFluxTransform, \
+    MultiScaleGaussianFluxAlgorithm, MultiScaleGaussianFluxControl, MultiScaleGaussianFluxTransform
 from .exceptions import MeasurementError
+from .fpPosition import FPPositionAlgorithm, FPPositionControl
+from .jacobian import JacobianAlgorithm, JacobianControl
 from .localBackground import LocalBackgroundControl, LocalBackgroundAlgorithm, LocalBackgroundTransform
+from .localPhotoCalib import LocalPhotoCalibAlgorithm, LocalPhotoCalibControl
+from .localWcs import LocalWcsAlgorithm, LocalWcsControl
 from .naiveCentroid import NaiveCentroidAlgorithm, NaiveCentroidControl, NaiveCentroidTransform
 from .peakLikelihoodFlux import PeakLikelihoodFluxAlgorithm, PeakLikelihoodFluxControl, \
     PeakLikelihoodFluxTransform
 from .pixelFlags import PixelFlagsAlgorithm, PixelFlagsControl
+from .preconditions import Preconditions
 from .psfFlux import PsfFluxAlgorithm, PsfFluxControl, PsfFluxTransform
+from .referenceTransform import ReferenceTransform
 from .scaledApertureFlux import ScaledApertureFluxAlgorithm, ScaledApertureFluxControl, \
     ScaledApertureFluxTransform
 from .sdssCentroid import SdssCentroidAlgorithm, SdssCentroidControl, SdssCentroidTransform
 from .sdssShape import SdssShapeAlgorithm, SdssShapeControl, SdssShapeTransform
+from .variance import VarianceAlgorithm, VarianceControl
 
 __all__ = (
     "SingleFrameFPPositionConfig", "SingleFrameFPPositionPlugin",
@@ -68,255 +77,123 @@ __all__ = (
     "ForcedPeakCentroidConfig", "ForcedPeakCentroidPlugin",
     "ForcedTransformedCentroidConfig", "ForcedTransformedCentroidPlugin",
     "ForcedTransformedShapeConfig", "ForcedTransformedShapePlugin",
-    "EvaluateLocalPhotoCalibPlugin", "EvaluateLocalPhotoCalibPluginConfig",
-    "EvaluateLocalWcsPlugin", "EvaluateLocalWcsPluginConfig",
+    "EvaluateLocalPhotoCalibPluginConfig", "SingleFrameEvaluateLocalPhotoCalibPlugin",
+    "ForcedEvaluateLocalPhotoCalibPlugin",
+    "EvaluateLocalWcsPluginConfig", "SingleFrameEvaluateLocalWcsPlugin", "ForcedEvaluateLocalWcsPlugin",
 )
 
 
 wrapSimpleAlgorithm(PsfFluxAlgorithm, Control=PsfFluxControl,
                     TransformClass=PsfFluxTransform, executionOrder=BasePlugin.FLUX_ORDER,
-                    shouldApCorr=True, hasLogName=True)
+                    shouldApCorr=True, hasLogName=True, hasMeasureN=True, doMeasureNDefault=False,
+                    preconditions=Preconditions().require(Preconditions.CENTROID),
+                    needsDetectionMasks=False)
 wrapSimpleAlgorithm(PeakLikelihoodFluxAlgorithm, Control=PeakLikelihoodFluxControl,
-                    TransformClass=PeakLikelihoodFluxTransform, executionOrder=BasePlugin.FLUX_ORDER)
+                    TransformClass=PeakLikelihoodFluxTransform, executionOrder=BasePlugin.FLUX_ORDER,
+                    preconditions=Preconditions().require(Preconditions.CENTROID)
+                    .require(Preconditions.ON_IMAGE),
+                    needsDetectionMasks=False)
 wrapSimpleAlgorithm(GaussianFluxAlgorithm, Control=GaussianFluxControl,
                     TransformClass=GaussianFluxTransform, executionOrder=BasePlugin.FLUX_ORDER,
-                    shouldApCorr=True)
+                    shouldApCorr=True,
+                    preconditions=Preconditions().require(Preconditions.CENTROID)
+                    .require(Preconditions.SHAPE),
+                    needsDetectionMasks=False)
+wrapSimpleAlgorithm(MultiScaleGaussianFluxAlgorithm, Control=MultiScaleGaussianFluxControl,
+                    TransformClass=MultiScaleGaussianFluxTransform, executionOrder=BasePlugin.FLUX_ORDER,
+                    needsDetectionMasks=False)
 wrapSimpleAlgorithm(NaiveCentroidAlgorithm, Control=NaiveCentroidControl,
-                    TransformClass=NaiveCentroidTransform, executionOrder=BasePlugin.CENTROID_ORDER)
+                    TransformClass=NaiveCentroidTransform, executionOrder=BasePlugin.CENTROID_ORDER,
+                    needsDetectionMasks=False)
 wrapSimpleAlgorithm(SdssCentroidAlgorithm, Control=SdssCentroidControl,
-                    TransformClass=SdssCentroidTransform, executionOrder=BasePlugin.CENTROID_ORDER)
+                    TransformClass=SdssCentroidTransform, executionOrder=BasePlugin.CENTROID_ORDER,
+                    needsDetectionMasks=False)
 wrapSimpleAlgorithm(PixelFlagsAlgorithm, Control=PixelFlagsControl,
-                    executionOrder=BasePlugin.FLUX_ORDER)
+                    executionOrder=BasePlugin.FLUX_ORDER,
+                    needsDetectionMasks=False)
 wrapSimpleAlgorithm(SdssShapeAlgorithm, Control=SdssShapeControl,
-                    TransformClass=SdssShapeTransform, executionOrder=BasePlugin.SHAPE_ORDER)
+                    TransformClass=SdssShapeTransform, executionOrder=BasePlugin.SHAPE_ORDER,
+                    needsDetectionMasks=False)
 wrapSimpleAlgorithm(ScaledApertureFluxAlgorithm, Control=ScaledApertureFluxControl,
-                    TransformClass=ScaledApertureFluxTransform, executionOrder=BasePlugin.FLUX_ORDER)
+                    TransformClass=ScaledApertureFluxTransform, executionOrder=BasePlugin.FLUX_ORDER,
+                    needsDetectionMasks=False)
 
 wrapSimpleAlgorithm(CircularApertureFluxAlgorithm, needsMetadata=True, Control=ApertureFluxControl,
-                    TransformClass=ApertureFluxTransform, executionOrder=BasePlugin.FLUX_ORDER)
+                    TransformClass=ApertureFluxTransform, executionOrder=BasePlugin.FLUX_ORDER,
+                    needsDetectionMasks=False)
+wrapSimpleAlgorithm(EllipticalApertureFluxAlgorithm, Control=EllipticalApertureFluxControl,
+                    TransformClass=EllipticalApertureFluxTransform, executionOrder=BasePlugin.FLUX_ORDER,
+                    needsDetectionMasks=False)
 wrapSimpleAlgorithm(BlendednessAlgorithm, Control=BlendednessControl,
-                    TransformClass=BaseTransform, executionOrder=BasePlugin.SHAPE_ORDER)
+                    TransformClass=BaseTransform, executionOrder=BasePlugin.SHAPE_ORDER,
+                    needsDetectionMasks=False)
 
 wrapSimpleAlgorithm(LocalBackgroundAlgorithm, Control=LocalBackgroundControl,
-                    TransformClass=LocalBackgroundTransform, executionOrder=BasePlugin.FLUX_ORDER)
+                    TransformClass=LocalBackgroundTransform, executionOrder=BasePlugin.FLUX_ORDER,
+                    needsDetectionMasks=False)
 
-wrapTransform(PsfFluxTransform)
-wrapTransform(PeakLikelihoodFluxTransform)
-wrapTransform(GaussianFluxTransform)
-wrapTransform(NaiveCentroidTransform)
-wrapTransform(SdssCentroidTransform)
-wrapTransform(SdssShapeTransform)
-wrapTransform(ScaledApertureFluxTransform)
-wrapTransform(ApertureFluxTransform)
-wrapTransform(LocalBackgroundTransform)
-
-
-class SingleFrameFPPositionConfig(SingleFramePluginConfig):
-    """Configuration for the focal plane position measurment algorithm.
-    """
-
-    pass
-
-
-@register("base_FPPosition")
-class SingleFrameFPPositionPlugin(SingleFramePlugin):
-    """Algorithm to calculate the position of a centroid on the focal plane.
-
-    Parameters
-    ----------
-    config : `SingleFrameFPPositionConfig`
-        Plugin configuraion.
-    name : `str`
-        Plugin name.
-    schema : `lsst.afw.table.Schema`
-        The schema for the measurement output catalog. New fields will be
-        added to hold measurements produced by this plugin.
-    metadata : `lsst.daf.base.PropertySet`
-        Plugin metadata that will be attached to the output catalog
-    """
-
-    ConfigClass = SingleFrameFPPositionConfig
-
-    @classmethod
-    def getExecutionOrder(cls):
-        return cls.SHAPE_ORDER
-
-    def __init__(self, config, name, schema, metadata):
-        SingleFramePlugin.__init__(self, config, name, schema, metadata)
-        self.focalValue = lsst.afw.table.Point2DKey.addFields(schema, name, "Position on the focal plane",
-                                                              "mm")
-        self.focalFlag = schema.addField(name + "_flag", type="Flag", doc="Set to True for any fatal failure")
-        self.detectorFlag = schema.addField(name + "_missingDetector_flag", type="Flag",
-                                            doc="Set to True if detector object is missing")
-
-    def measure(self, measRecord, exposure):
-        det = exposure.getDetector()
-        if not det:
-            measRecord.set(self.detectorFlag, True)
-            fp = lsst.geom.Point2D(np.nan, np.nan)
-        else:
-            center = measRecord.getCentroid()
-            fp = det.transform(center, lsst.afw.cameraGeom.PIXELS, lsst.afw.cameraGeom.FOCAL_PLANE)
-        measRecord.set(self.focalValue, fp)
-
-    def fail(self, measRecord, error=None):
-        measRecord.set(self.focalFlag, True)
-
-
-class SingleFrameJacobianConfig(SingleFramePluginConfig):
-    """Configuration for the Jacobian calculation plugin.
-    """
-
-    pixelScale = lsst.pex.config.Field(dtype=float, default=0.5, doc="Nominal pixel size (arcsec)")
-
-
-@register("base_Jacobian")
-class SingleFrameJacobianPlugin(SingleFramePlugin):
-    """Compute the Jacobian and its ratio with a nominal pixel area.
-
-    This enables one to compare relative, rather than absolute, pixel areas.
-
-    Parameters
-    ----------
-    config : `SingleFrameJacobianConfig`
-        Plugin configuraion.
-    name : `str`
-        Plugin name.
-    schema : `lsst.afw.table.Schema`
-        The schema for the measurement output catalog. New fields will be
-        added to hold measurements produced by this plugin.
-    metadata : `lsst.daf.base.PropertySet`
-        Plugin metadata that will be attached to the output catalog
-    """
-
-    ConfigClass = SingleFrameJacobianConfig
-
-    @classmethod
-    def getExecutionOrder(cls):
-        return cls.SHAPE_ORDER
-
-    def __init__(self, config, name, schema, metadata):
-        SingleFramePlugin.__init__(self, config, name, schema, metadata)
-        self.jacValue = schema.addField(name + '_value', type="D", doc="Jacobian correction")
-        self.jacFlag = schema.addField(name + '_flag', type="Flag", doc="Set to 1 for any fatal failure")
-        # Calculate one over the area of a nominal reference pixel, where area is in arcsec^2
-        self.scale = pow(self.config.pixelScale, -2)
-
-    def measure(self, measRecord, exposure):
-        center = measRecord.getCentroid()
-        # Compute the area of a pixel at a source record's centroid, and take
-        # the ratio of that with the defined reference pixel area.
-        result = np.abs(self.scale*exposure.getWcs().linearizePixelToSky(
-            center,
-            lsst.geom.arcseconds).getLinear().computeDeterminant())
-        measRecord.set(self.jacValue, result)
-
-    def fail(self, measRecord, error=None):
-        measRecord.set(self.jacFlag, True)
-
-
-class VarianceConfig(BaseMeasurementPluginConfig):
-    """Configuration for the variance calculation plugin.
-    """
-    scale = lsst.pex.config.Field(dtype=float, default=5.0, optional=True,
-                                  doc="Scale factor to apply to shape for aperture")
-    mask = lsst.pex.config.ListField(doc="Mask planes to ignore", dtype=str,
-                                     default=["DETECTED", "DETECTED_NEGATIVE", "BAD", "SAT"])
-
-
-class VariancePlugin(GenericPlugin):
-    """Compute the median variance corresponding to a footprint.
-
-    The aim here is to measure the background variance, rather than that of
-    the object itself. In order to achieve this, the variance is calculated
-    over an area scaled up from the shape of the input footprint.
-
-    Parameters
-    ----------
-    config : `VarianceConfig`
-        Plugin configuraion.
-    name : `str`
-        Plugin name.
-    schema : `lsst.afw.table.Schema`
-        The schema for the measurement output catalog. New fields will be
-        added to hold measurements produced by this plugin.
-    metadata : `lsst.daf.base.PropertySet`
-        Plugin metadata that will be attached to the output catalog
-    """
-
-    ConfigClass = VarianceConfig
-
-    FAILURE_BAD_CENTROID = 1
-    """Denotes failures due to bad centroiding (`int`).
-    """
+SingleFrameVariancePlugin, ForcedVariancePlugin = wrapSimpleAlgorithm(
+    VarianceAlgorithm, Control=VarianceControl, executionOrder=BasePlugin.FLUX_ORDER, name="base_Variance",
+    needsDetectionMasks=False)
+"""Single-frame and forced versions of the median variance plugin.
+"""
 
-    FAILURE_EMPTY_FOOTPRINT = 2
-    """Denotes failures due to a lack of usable pixels (`int`).
-    """
+VarianceConfig = SingleFrameVariancePlugin.ConfigClass
+"""Configuration for the variance calculation plugin.
+"""
 
-    @classmethod
-    def getExecutionOrder(cls):
-        return BasePlugin.FLUX_ORDER
+SingleFrameFPPositionPlugin = wrapSingleFrameAlgorithm(
+    FPPositionAlgorithm, Control=FPPositionControl, executionOrder=BasePlugin.SHAPE_ORDER,
+    name="base_FPPosition", needsDetectionMasks=False)
+"""Algorithm to calculate the position of a centroid on the focal plane.
+"""
 
-    def __init__(self, config, name, schema, metadata):
-        GenericPlugin.__init__(self, config, name, schema, metadata)
-        self.varValue = schema.addField(name + '_value', type="D", doc="Variance at object position")
-        self.emptyFootprintFlag = schema.addField(name + '_flag_emptyFootprint', type="Flag",
-                                                  doc="Set to True when the footprint has no usable pixels")
+SingleFrameFPPositionConfig = SingleFrameFPPositionPlugin.ConfigClass
+"""Configuration for the focal plane position measurment algorithm.
+"""
 
-        # Alias the badCentroid flag to that which is defined for the target
-        # of the centroid slot.  We do not simply rely on the alias because
-        # that could be changed post-measurement.
-        schema.getAliasMap().set(name + '_flag_badCentroid', schema.getAliasMap().apply("slot_Centroid_flag"))
+SingleFrameJacobianPlugin = wrapSingleFrameAlgorithm(
+    JacobianAlgorithm, Control=JacobianControl, executionOrder=BasePlugin.SHAPE_ORDER,
+    name="base_Jacobian", needsDetectionMasks=False)
+"""Compute the Jacobian and its ratio with a nominal pixel area.
+"""
 
-    def measure(self, measRecord, exposure, center):
-        # Create an aperture and grow it by scale value defined in config to
-        # ensure there are enough pixels around the object to get decent
-        # statistics
-        if not np.all(np.isfinite(measRecord.getCentroid())):
-            raise MeasurementError("Bad centroid and/or shape", self.FAILURE_BAD_CENTROID)
-        aperture = lsst.afw.geom.Ellipse(measRecord.getShape(), measRecord.getCentroid())
-        aperture.scale(self.config.scale)
-        ellipse = lsst.afw.geom.SpanSet.fromShape(aperture)
-        foot = lsst.afw.detection.Footprint(ellipse)
-        foot.clipTo(exposure.getBBox(lsst.afw.image.PARENT))
-        # Filter out any pixels which have mask bits set corresponding to the
-        # planes to be excluded (defined in config.mask)
-        maskedImage = exposure.getMaskedImage()
-        pixels = lsst.afw.detection.makeHeavyFootprint(foot, maskedImage)
-        maskBits = maskedImage.getMask().getPlaneBitMask(self.config.mask)
-        logicalMask = np.logical_not(pixels.getMaskArray() & maskBits)
-        # Compute the median variance value for each pixel not excluded by the
-        # mask and write the record.  Numpy median is used here instead of
-        # afw.math makeStatistics because of an issue with data types being
-        # passed into the C++ layer (DM-2379).
-        if np.any(logicalMask):
-            medVar = np.median(pixels.getVarianceArray()[logicalMask])
-            measRecord.set(self.varValue, medVar)
-        else:
-            raise MeasurementError("Footprint empty, or all pixels are masked, can't compute median",
-                                   self.FAILURE_EMPTY_FOOTPRINT)
+SingleFrameJacobianConfig = SingleFrameJacobianPlugin.ConfigClass
+"""Configuration for the Jacobian calculation plugin.
+"""
 
-    def fail(self, measRecord, error=None):
-        # Check that we have an error object and that it is of type
-        # MeasurementError
-        if isinstance(error, MeasurementError):
-            assert error.getFlagBit() in (self.FAILURE_BAD_CENTROID, self.FAILURE_EMPTY_FOOTPRINT)
-            # FAILURE_BAD_CENTROID handled by alias to centroid record.
-            if error.getFlagBit() == self.FAILURE_EMPTY_FOOTPRINT:
-                measRecord.set(self.emptyFootprintFlag, True)
-        measRecord.set(self.varValue, np.nan)
-        GenericPlugin.fail(self, measRecord, error)
+SingleFrameEvaluateLocalPhotoCalibPlugin, ForcedEvaluateLocalPhotoCalibPlugin = wrapSimpleAlgorithm(
+    LocalPhotoCalibAlgorithm, Control=LocalPhotoCalibControl, executionOrder=BasePlugin.FLUX_ORDER,
+    name="base_LocalPhotoCalib", needsDetectionMasks=False)
+"""Single-frame and forced versions of the local photometric calibration plugin.
+"""
 
+EvaluateLocalPhotoCalibPluginConfig = SingleFrameEvaluateLocalPhotoCalibPlugin.ConfigClass
+"""Configuration for the local photometric calibration plugin.
+"""
 
-SingleFrameVariancePlugin = VariancePlugin.makeSingleFramePlugin("base_Variance")
-"""Single-frame version of `VariancePlugin`.
+SingleFrameEvaluateLocalWcsPlugin, ForcedEvaluateLocalWcsPlugin = wrapSimpleAlgorithm(
+    LocalWcsAlgorithm, Control=LocalWcsControl, executionOrder=BasePlugin.FLUX_ORDER,
+    name="base_LocalWcs", needsDetectionMasks=False)
+"""Single-frame and forced versions of the local, linear WCS approximation plugin.
 """
 
-ForcedVariancePlugin = VariancePlugin.makeForcedPlugin("base_Variance")
-"""Forced version of `VariancePlugin`.
+EvaluateLocalWcsPluginConfig = SingleFrameEvaluateLocalWcsPlugin.ConfigClass
+"""Configuration for the local WCS plugin.
 """
 
+wrapTransform(PsfFluxTransform)
+wrapTransform(PeakLikelihoodFluxTransform)
+wrapTransform(GaussianFluxTransform)
+wrapTransform(MultiScaleGaussianFluxTransform)
+wrapTransform(NaiveCentroidTransform)
+wrapTransform(SdssCentroidTransform)
+wrapTransform(SdssShapeTransform)
+wrapTransform(ScaledApertureFluxTransform)
+wrapTransform(ApertureFluxTransform)
+wrapTransform(EllipticalApertureFluxTransform)
+wrapTransform(LocalBackgroundTransform)
+
 
 class InputCountConfig(BaseMeasurementPluginConfig):
     """Configuration for the input image counting plugin.
@@ -392,6 +269,9 @@ class InputCountPlugin(GenericPlugin):
                 measRecord.set(self.noInputsFlag, True)
         GenericPlugin.fail(self, measRecord, error)
 
+    def needsDetectionMasks(self):
+        return False
+
 
 SingleFrameInputCountPlugin = InputCountPlugin.makeSingleFramePlugin("base_InputCount")
 """Single-frame version of `InputCoutPlugin`.
@@ -402,149 +282,6 @@ ForcedInputCountPlugin = InputCountPlugin.makeForcedPlugin("base_InputCount")
 """
 
 
-class EvaluateLocalPhotoCalibPluginConfig(BaseMeasurementPluginConfig):
-    """Configuration for the variance calculation plugin.
-    """
-    pass
-
-
-class EvaluateLocalPhotoCalibPlugin(GenericPlugin):
-    """Evaluate the local value of the Photometric Calibration in the exposure.
-
-    The aim is to store the local calib value within the catalog for later
-    use in the Science Data Model functors.
-    """
-    ConfigClass = EvaluateLocalPhotoCalibPluginConfig
-
-    @classmethod
-    def getExecutionOrder(cls):
-        return BasePlugin.FLUX_ORDER
-
-    def __init__(self, config, name, schema, metadata):
-        GenericPlugin.__init__(self, config, name, schema, metadata)
-        self.photoKey = schema.addField(
-            name,
-            type="D",
-            doc="Local approximation of the PhotoCalib calibration factor at "
-                "the location of the src.")
-        self.photoErrKey = schema.addField(
-            "%sErr" % name,
-            type="D",
-            doc="Error on the local approximation of the PhotoCalib "
-                "calibration factor at the location of the src.")
-
-    def measure(self, measRecord, exposure, center):
-
-        photoCalib = exposure.getPhotoCalib()
-        calib = photoCalib.getLocalCalibration(center)
-        measRecord.set(self.photoKey, calib)
-
-        calibErr = photoCalib.getCalibrationErr()
-        measRecord.set(self.photoErrKey, calibErr)
-
-
-SingleFrameEvaluateLocalPhotoCalibPlugin = EvaluateLocalPhotoCalibPlugin.makeSingleFramePlugin(
-    "base_LocalPhotoCalib")
-"""Single-frame version of `EvaluatePhotoCalibPlugin`.
-"""
-
-ForcedEvaluateLocalPhotoCalibPlugin = EvaluateLocalPhotoCalibPlugin.makeForcedPlugin(
-    "base_LocalPhotoCalib")
-"""Forced version of `EvaluatePhotoCalibPlugin`.
-"""
-
-
-class EvaluateLocalWcsPluginConfig(BaseMeasurementPluginConfig):
-    """Configuration for the variance calculation plugin.
-    """
-    pass
-
-
-class EvaluateLocalWcsPlugin(GenericPlugin):
-    """Evaluate the local, linear approximation of the Wcs.
-
-    The aim is to store the local calib value within the catalog for later
-    use in the Science Data Model functors.
-    """
-    ConfigClass = EvaluateLocalWcsPluginConfig
-    _scale = (1.0 * lsst.geom.arcseconds).asDegrees()
-
-    @classmethod
-    def getExecutionOrder(cls):
-        return BasePlugin.FLUX_ORDER
-
-    def __init__(self, config, name, schema, metadata):
-        GenericPlugin.__init__(self, config, name, schema, metadata)
-        self.cdMatrix11Key = schema.addField(
-            f"{name}_CDMatrix_1_1",
-            type="D",
-            doc=f"(1, 1) element of the CDMatrix for the linear approximation "
-                 "of the WCS at the src location. Gives units in radians.")
-        self.cdMatrix12Key = schema.addField(
-            f"{name}_CDMatrix_1_2",
-            type="D",
-            doc=f"(1, 2) element of the CDMatrix for the linear approximation "
-                 "of the WCS at the src location. Gives units in radians.")
-        self.cdMatrix21Key = schema.addField(
-            f"{name}_CDMatrix_2_1",
-            type="D",
-            doc=f"(2, 1) element of the CDMatrix for the linear approximation "
-                 "of the WCS at the src location. Gives units in radians.")
-        self.cdMatrix22Key = schema.addField(
-            f"{name}_CDMatrix_2_2",
-            type="D",
-            doc=f"(2, 2) element of the CDMatrix for the linear approximation "
-                 "of the WCS at the src location. Gives units in radians.")
-
-    def measure(self, measRecord, exposure, center):
-        wcs = exposure.getWcs()
-        localMatrix = self.makeLocalTransformMatrix(wcs, center)
-        measRecord.set(self.cdMatrix11Key, localMatrix[0, 0])
-        measRecord.set(self.cdMatrix12Key, localMatrix[0, 1])
-        measRecord.set(self.cdMatrix21Key, localMatrix[1, 0])
-        measRecord.set(self.cdMatrix22Key, localMatrix[1, 1])
-
-    def makeLocalTransformMatrix(self, wcs, center):
-        """Create a local, linear approximation of the wcs transformation
-        matrix.
-
-        The approximation is created as if the center is at RA=0, DEC=0. All
-        comparing x,y coordinate are relative to the position of center. Matrix
-        is initially calculated with units arcseconds and then converted to
-        radians. This yields higher precision results due to quirks in AST.
-
-        Parameters
-        ----------
-        wcs : `lsst.afw.geom.SkyWcs`
-            Wcs to approximate
-        center : `lsst.geom.Point2D`
-            Point at which to evaluate the LocalWcs.
-
-        Returns
-        -------
-        localMatrix : `numpy.ndarray`
-            Matrix representation the local wcs approximation with units
-            radians.
-        """
-        skyCenter = wcs.pixelToSky(center)
-        localGnomonicWcs = lsst.afw.geom.makeSkyWcs(
-            center, skyCenter, np.diag((self._scale, self._scale)))
-        measurementToLocalGnomonic = wcs.getTransform().then(
-            localGnomonicWcs.getTransform().inverted()
-        )
-        localMatrix = measurementToLocalGnomonic.getJacobian(center)
-        return np.radians(localMatrix / 3600)
-
-
-SingleFrameEvaluateLocalWcsPlugin = EvaluateLocalWcsPlugin.makeSingleFramePlugin("base_LocalWcs")
-"""Single-frame version of `EvaluateLocalWcsPlugin`.
-"""
-
-ForcedEvaluateLocalWcsPlugin = EvaluateLocalWcsPlugin.makeForcedPlugin("base_LocalWcs")
-"""Forced version of `EvaluateLocalWcsPlugin`.
-"""
-
-
 class SingleFramePeakCentroidConfig(SingleFramePluginConfig):
     """Configuration for the single frame peak centroiding algorithm.
     """
@@ -595,6 +332,9 @@ class SingleFramePeakCentroidPlugin(SingleFramePlugin):
     def getTransformClass():
         return SimpleCentroidTransform
 
+    def needsDetectionMasks(self):
+        return False
+
 
 class SingleFrameSkyCoordConfig(SingleFramePluginConfig):
     """Configuration for the sky coordinates algorithm.
@@ -643,6 +383,9 @@ class SingleFrameSkyCoordPlugin(SingleFramePlugin):
         # DM-1011
         pass
 
+    def needsDetectionMasks(self):
+        return False
+
 
 class ForcedPeakCentroidConfig(ForcedPluginConfig):
     """Configuration for the forced peak centroid algorithm.
@@ -685,19 +428,40 @@ class ForcedPeakCentroidPlugin(ForcedPlugin):
         schema = schemaMapper.editOutputSchema()
         self.keyX = schema.addField(name + "_x", type="D", doc="peak centroid", units="pixel")
         self.keyY = schema.addField(name + "_y", type="D", doc="peak centroid", units="pixel")
+        self.flagKey = schema.addField(name + "_flag", type="Flag",
+                                       doc="reference has no footprint or no peak")
 
     def measure(self, measRecord, exposure, refRecord, refWcs):
         targetWcs = exposure.getWcs()
-        peak = refRecord.getFootprint().getPeaks()[0]
+        footprint = refRecord.getFootprint()
+        if footprint is None or len(footprint.getPeaks()) == 0:
+            raise MeasurementError("Reference %d has no peak" % (refRecord.getId(),), 0)
+        peak = footprint.getPeaks()[0]
         result = lsst.geom.Point2D(peak.getFx(), peak.getFy())
         result = targetWcs.skyToPixel(refWcs.pixelToSky(result))
         measRecord.set(self.keyX, result.getX())
         measRecord.set(self.keyY, result.getY())
+        measRecord.set(self.flagKey, False)
+
+    def fail(self, measRecord, error=None):
+        measRecord.set(self.flagKey, True)
+
+    def canMeasureConcurrently(self):
+        # Only reads the reference record and the WCSs, and holds no mutable state.
+        return True
+
+    def measureBatch(self, measCat, exposure, refCat, refWcs):
+        # Transform the peaks of all the references in a single call.
+        ReferenceTransform(refWcs, exposure.getWcs()).transformPeaks(
+            measCat, refCat, lsst.afw.table.Point2DKey(self.keyX, self.keyY), self.flagKey)
 
     @staticmethod
     def getTransformClass():
         return SimpleCentroidTransform
 
+    def needsDetectionMasks(self):
+        return False
+
 
 class ForcedTransformedCentroidConfig(ForcedPluginConfig):
     """Configuration for the forced transformed centroid algorithm.
@@ -765,6 +529,19 @@ class ForcedTransformedCentroidPlugin(ForcedPlugin):
         if self.flagKey is not None:
             measRecord.set(self.flagKey, refRecord.getCentroidFlag())
 
+    def canMeasureConcurrently(self):
+        # Only reads the reference record and the WCSs, and holds no mutable state.
+        return True
+
+    def measureBatch(self, measCat, exposure, refCat, refWcs):
+        # Transform the centroids of all the references in a single call.
+        flagKey = self.flagKey if self.flagKey is not None else lsst.afw.table.Key["Flag"]()
+        ReferenceTransform(refWcs, exposure.getWcs()).transformCentroids(measCat, refCat, self.centroidKey,
+                                                                         flagKey)
+
+    def needsDetectionMasks(self):
+        return False
+
 
 class ForcedTransformedShapeConfig(ForcedPluginConfig):
     """Configuration for the forced transformed shape algorithm.
@@ -834,3 +611,15 @@ class ForcedTransformedShapePlugin(ForcedPlugin):
             measRecord.set(self.shapeKey, refRecord.getShape())
         if self.flagKey is not None:
             measRecord.set(self.flagKey, refRecord.getShapeFlag())
+
+    def canMeasureConcurrently(self):
+        # Only reads the reference record and the WCSs, and holds no mutable state.
+        return True
+
+    def measureBatch(self, measCat, exposure, refCat, refWcs):
+        # Compute the local linear transforms at all the reference centroids in a single call.
+        flagKey = self.flagKey if self.flagKey is not None else lsst.afw.table.Key["Flag"]()
+        ReferenceTransform(refWcs, exposure.getWcs()).transformShapes(measCat, refCat, self.shapeKey, flagKey)
+
+    def needsDetectionMasks(self):
+        return False
@@ -165,6 +165,140 @@ class BasePlugin:
                    % (self.__class__.__name__,))
         raise NotImplementedError(message)
 
+    def addToChain(self, chain):
+        """Append the plugin's compiled algorithm to a `PluginChain`.
+
+        Parameters
+        ----------
+        chain : `lsst.meas.base.PluginChain`
+            Chain to which the algorithm should be added.
+
+        Returns
+        -------
+        added : `bool`
+            Whether the plugin was added.  If `False`, the measurement
+            framework calls the plugin's ``measure`` method from Python.
+
+        Notes
+        -----
+        Only plugins whose ``measure`` and ``fail`` methods simply forward to
+        a C++ algorithm can be chained.  The default implementation does not
+        add the plugin.
+        """
+        return False
+
+    def canMeasureConcurrently(self):
+        """Return whether several threads may call the plugin at once.
+
+        Returns
+        -------
+        concurrent : `bool`
+            Whether the plugin may measure different sources from several
+            threads simultaneously, each with its own exposure and PSF.
+
+        Notes
+        -----
+        Only plugins that forward to a C++ algorithm release the GIL while
+        measuring, and only they are written to be called concurrently.  The
+        default implementation returns `False`, so the measurement framework
+        calls other plugins from a single thread.
+        """
+        return False
+
+    def getPreconditions(self):
+        """Return the conditions a source must satisfy for the plugin to
+        measure it.
+
+        Returns
+        -------
+        preconditions : `lsst.meas.base.Preconditions` or `None`
+            Conditions (e.g. a usable centroid, or a position on the image)
+            without which the measurement is certain to fail, or `None` if
+            there are none.
+
+        Notes
+        -----
+        If ``doPreconditions`` is set in the task config, the measurement
+        framework evaluates the conditions of all plugins once per source,
+        and calls `fail` (with a `MeasurementError` carrying the flag given
+        for the condition, if any) instead of ``measure`` on the plugins
+        whose conditions do not hold.  Outputs other than the failure flags
+        are then left unset, so only conditions under which ``measure``
+        would fail, setting the same flags, should be declared; e.g. a
+        centroid off the image must not be declared for plugins that still
+        measure (and only flag) sources on the edge.  Sources measured in
+        batches (without noise replacement, through ``measureBatch``) are
+        not checked.  The default implementation returns `None`.
+        """
+        return None
+
+    def needsDetectionMasks(self):
+        """Return whether the plugin reads the ``THISDET`` and ``OTHERDET``
+        mask planes.
+
+        Returns
+        -------
+        needed : `bool`
+            Whether the noise replacer must mark the pixels of the source
+            being measured (``THISDET``) and of its replaced neighbors
+            (``OTHERDET``) in the mask.
+
+        Notes
+        -----
+        Maintaining these planes costs a pass over the mask of every
+        footprint for every source measured, so the noise replacer only does
+        so if at least one active plugin returns `True`.  The default
+        implementation returns `True`, so that plugins written before this
+        method existed keep seeing the planes; plugins that inspect neither
+        plane should override it to return `False`.
+        """
+        return True
+
+    def enableTiming(self, enable):
+        """Enable or disable timing of the plugin's compiled code.
+
+        Parameters
+        ----------
+        enable : `bool`
+            Whether to record the time spent inside compiled code when the
+            plugin measures.  Enabling timing resets any recorded time.
+
+        Notes
+        -----
+        This is called by the measurement framework when
+        ``doTiming`` is set in the task config.  Pure-Python plugins have no
+        compiled code to time, so the default implementation does nothing.
+        """
+        pass
+
+    def enableTracing(self, recorder):
+        """Trace the plugin's compiled code to a recorder.
+
+        Parameters
+        ----------
+        recorder : `lsst.meas.base.TraceRecorder` or `None`
+            Recorder to which each call into compiled code on a sampled
+            source adds an event, or `None` to disable tracing.
+
+        Notes
+        -----
+        This is called by the measurement framework when ``traceFile`` is
+        set in the task config.  The framework records the time spent in
+        each plugin itself; the default implementation does nothing.
+        """
+        pass
+
+    def getTiming(self):
+        """Return the time spent inside compiled code since timing was enabled.
+
+        Returns
+        -------
+        timing : `tuple` of (`float`, `int`) or `None`
+            Wall-clock time in seconds and number of sources measured, or
+            `None` if the plugin does not record its own timing.
+        """
+        return None
+
     @staticmethod
     def getTransformClass():
         """Get the measurement transformation appropriate to this plugin.
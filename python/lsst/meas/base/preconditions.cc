@@ -0,0 +1,76 @@
+/*
+ * LSST Data Management System
+ * Copyright 2008-2017  AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "pybind11/pybind11.h"
+
+#include "lsst/meas/base/Preconditions.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+PYBIND11_MODULE(preconditions, mod) {
+    py::module::import("lsst.afw.image");
+    py::module::import("lsst.afw.table");
+    py::module::import("lsst.meas.base.algorithm");
+
+    py::class_<Preconditions, std::shared_ptr<Preconditions>> clsPreconditions(mod, "Preconditions");
+
+    py::enum_<Preconditions::Condition>(clsPreconditions, "Condition")
+            .value("NONE", Preconditions::NONE)
+            .value("CENTROID", Preconditions::CENTROID)
+            .value("SHAPE", Preconditions::SHAPE)
+            .value("ON_IMAGE", Preconditions::ON_IMAGE)
+            .value("GOOD_PIXELS", Preconditions::GOOD_PIXELS)
+            .export_values();
+
+    clsPreconditions.def(py::init<>());
+    clsPreconditions.def("require", &Preconditions::require, "condition"_a, "flagBit"_a = -1,
+                         py::return_value_policy::reference_internal);
+    clsPreconditions.def("requireGoodPixelFraction", &Preconditions::requireGoodPixelFraction,
+                         "minFraction"_a, "flagBit"_a = -1, py::return_value_policy::reference_internal);
+    clsPreconditions.def("getConditions", &Preconditions::getConditions);
+    clsPreconditions.def("isRequired", &Preconditions::isRequired, "condition"_a);
+    clsPreconditions.def("empty", &Preconditions::empty);
+    clsPreconditions.def("getFlagBit", &Preconditions::getFlagBit, "condition"_a);
+    clsPreconditions.def("getMinGoodPixelFraction", &Preconditions::getMinGoodPixelFraction);
+    clsPreconditions.def_static("getConditionName", &Preconditions::getConditionName, "condition"_a);
+
+    py::class_<SourceConditions> clsSourceConditions(mod, "SourceConditions");
+    // The record and exposure are referenced, not copied, so they are kept alive with the object.
+    clsSourceConditions.def(py::init<afw::table::SourceRecord const &, afw::image::Exposure<float> const &,
+                                     afw::image::MaskPixel>(),
+                            "record"_a, "exposure"_a, "badBits"_a = 0, py::keep_alive<1, 2>(),
+                            py::keep_alive<1, 3>());
+    clsSourceConditions.def("hasCentroid", &SourceConditions::hasCentroid);
+    clsSourceConditions.def("hasShape", &SourceConditions::hasShape);
+    clsSourceConditions.def("isOnImage", &SourceConditions::isOnImage);
+    clsSourceConditions.def("getGoodPixelFraction", &SourceConditions::getGoodPixelFraction);
+    clsSourceConditions.def("check", &SourceConditions::check, "preconditions"_a);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -48,6 +48,7 @@ PyFluxControl declareFluxControl(py::module &mod) {
     PyFluxControl cls(mod, "PsfFluxControl");
 
     LSST_DECLARE_CONTROL_FIELD(cls, PsfFluxControl, badMaskPlanes);
+    LSST_DECLARE_CONTROL_FIELD(cls, PsfFluxControl, useWeights);
 
     cls.def(py::init<>());
 
@@ -67,6 +68,13 @@ PyFluxAlgorithm declareFluxAlgorithm(py::module &mod) {
     cls.def(py::init<PsfFluxAlgorithm::Control const &, std::string const &, afw::table::Schema &,
                      std::string const &>(),
             "ctrl"_a, "name"_a, "schema"_a, "logName"_a);
+    // The plugin factory passes doMeasureN positionally; the algorithm supports both entry points
+    // regardless, so the flag only decides which one the framework calls.
+    cls.def(py::init([](PsfFluxAlgorithm::Control const &ctrl, std::string const &name,
+                        afw::table::Schema &schema, bool doMeasureN, std::string const &logName) {
+                return std::make_shared<PsfFluxAlgorithm>(ctrl, name, schema, logName);
+            }),
+            "ctrl"_a, "name"_a, "schema"_a, "doMeasureN"_a, "logName"_a = "");
     return cls;
 }
 
@@ -0,0 +1,57 @@
+/*
+ * LSST Data Management System
+ * Copyright 2008-2017  AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+
+#include "lsst/meas/base/ReferenceTransform.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+PYBIND11_MODULE(referenceTransform, mod) {
+    py::module::import("lsst.geom");
+    py::module::import("lsst.afw.geom");
+    py::module::import("lsst.afw.table");
+
+    py::class_<ReferenceTransform, std::shared_ptr<ReferenceTransform>> cls(mod, "ReferenceTransform");
+
+    cls.def(py::init<afw::geom::SkyWcs const &, afw::geom::SkyWcs const &>(), "refWcs"_a, "measWcs"_a);
+
+    cls.def("isIdentity", &ReferenceTransform::isIdentity);
+    cls.def("transformPoints", &ReferenceTransform::transformPoints, "points"_a);
+    cls.def("computeLocalLinearTransforms", &ReferenceTransform::computeLocalLinearTransforms, "points"_a);
+    cls.def("transformCentroids", &ReferenceTransform::transformCentroids, "measCat"_a, "refCat"_a,
+            "centroidKey"_a, "flagKey"_a, py::call_guard<py::gil_scoped_release>());
+    cls.def("transformShapes", &ReferenceTransform::transformShapes, "measCat"_a, "refCat"_a, "shapeKey"_a,
+            "flagKey"_a, py::call_guard<py::gil_scoped_release>());
+    cls.def("transformPeaks", &ReferenceTransform::transformPeaks, "measCat"_a, "refCat"_a, "centroidKey"_a,
+            "flagKey"_a, py::call_guard<py::gil_scoped_release>());
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -23,11 +23,322 @@
 Subtasks for creating the reference catalogs used in forced measurement.
 """
 
+import collections
+import math
+import threading
+
+import numpy as np
+
 import lsst.geom
+import lsst.afw.table
 import lsst.pex.config
 import lsst.pipe.base
 
-__all__ = ("BaseReferencesTask", "CoaddSrcReferencesTask")
+__all__ = ("BaseReferencesTask", "CoaddSrcReferencesTask", "ReferenceIndex", "ReferenceCatalogCache")
+
+
+class ReferenceIndex:
+    """A spatial index over the parent objects of a reference catalog.
+
+    Parent coordinates are bucketed into declination zones of fixed height
+    and sorted by right ascension within each zone, so the parents near a
+    sky position can be found with a handful of binary searches instead of
+    a test on every record.
+
+    Parameters
+    ----------
+    sources : iterable of `~lsst.afw.table.SourceRecord`
+        Reference sources to index. Children are indexed through their
+        parents.
+    schema : `lsst.afw.table.Schema`
+        Schema of ``sources``.
+    zoneHeight : `lsst.geom.Angle`, optional
+        Height of each declination zone.
+
+    Notes
+    -----
+    The index only returns candidates: `query` may return parents outside
+    the requested circle near its edges, and `subset` applies the exact
+    pixel-coordinate test of `BaseReferencesTask.subset` to those
+    candidates only.
+
+    Children whose parent is not among ``sources`` (as happens when a
+    family straddles a patch boundary and patch overlaps are removed) are
+    kept in `orphans`, keyed by parent ID, so that indices built over
+    neighbouring patches can be combined with `subset`.
+    """
+
+    def __init__(self, sources, schema, zoneHeight=1.0*lsst.geom.arcminutes):
+        catalog = lsst.afw.table.SourceCatalog(schema)
+        catalog.extend(sources)
+        # catalog must be sorted by parent ID for lsst.afw.table.getChildren
+        # to work
+        catalog.sort(lsst.afw.table.SourceTable.getParentKey())
+        self.catalog = catalog
+        self.zoneHeight = zoneHeight.asRadians()
+        self.nZones = max(1, int(math.ceil(math.pi/self.zoneHeight)))
+        parents = catalog.getChildren(0)
+        ra = np.array([parent.getCoord().getRa().wrap().asRadians() for parent in parents], dtype=float)
+        dec = np.array([parent.getCoord().getDec().asRadians() for parent in parents], dtype=float)
+        zones = self._getZone(dec)
+        order = np.lexsort((ra, zones))
+        self._parents = [parents[int(i)] for i in order]
+        self._ra = ra[order]
+        self._dec = dec[order]
+        self._zoneStart = np.searchsorted(zones[order], np.arange(self.nZones + 1))
+        ids = set(record.getId() for record in catalog)
+        self.orphans = {}
+        for record in catalog:
+            if record.getParent() != 0 and record.getParent() not in ids:
+                self.orphans.setdefault(record.getParent(), []).append(record)
+
+    def __len__(self):
+        return len(self._parents)
+
+    def _getZone(self, dec):
+        zones = np.floor((np.asarray(dec) + 0.5*math.pi)/self.zoneHeight).astype(int)
+        return np.clip(zones, 0, self.nZones - 1)
+
+    def query(self, center, radius):
+        """Return the indices of parents that may lie within a circle.
+
+        Parameters
+        ----------
+        center : `lsst.geom.SpherePoint`
+            Center of the circle.
+        radius : `lsst.geom.Angle`
+            Radius of the circle.
+
+        Returns
+        -------
+        indices : `numpy.ndarray` of `int`
+            Candidate indices into the parents held by the index, in
+            zone order. Every parent within ``radius`` of ``center`` is
+            included.
+        """
+        ra0 = center.getRa().wrap().asRadians()
+        dec0 = center.getDec().asRadians()
+        r = radius.asRadians()
+        decMin = max(dec0 - r, -0.5*math.pi)
+        decMax = min(dec0 + r, 0.5*math.pi)
+        maxAbsDec = max(abs(decMin), abs(decMax))
+        # Half-width in RA of the circle at the declination furthest from
+        # the equator; the whole zone is used if the circle covers a pole.
+        if math.sin(r) < math.cos(maxAbsDec):
+            halfWidth = math.asin(math.sin(r)/math.cos(maxAbsDec))
+        else:
+            halfWidth = math.pi
+        if halfWidth >= math.pi:
+            intervals = [(0.0, 2.0*math.pi)]
+        else:
+            raMin = (ra0 - halfWidth) % (2.0*math.pi)
+            raMax = (ra0 + halfWidth) % (2.0*math.pi)
+            if raMin <= raMax:
+                intervals = [(raMin, raMax)]
+            else:
+                intervals = [(raMin, 2.0*math.pi), (0.0, raMax)]
+        pieces = []
+        for zone in range(int(self._getZone(decMin)), int(self._getZone(decMax)) + 1):
+            begin, end = self._zoneStart[zone], self._zoneStart[zone + 1]
+            if begin == end:
+                continue
+            zoneRa = self._ra[begin:end]
+            for low, high in intervals:
+                first = np.searchsorted(zoneRa, low, side="left")
+                last = np.searchsorted(zoneRa, high, side="right")
+                if last > first:
+                    pieces.append(np.arange(begin + first, begin + last))
+        if not pieces:
+            return np.zeros(0, dtype=int)
+        return np.concatenate(pieces)
+
+    def subset(self, bbox, wcs, orphans=None):
+        """Return the indexed sources whose parents lie within a bounding box.
+
+        Parameters
+        ----------
+        bbox : `lsst.afw.geom.Box2I` or `lsst.afw.geom.Box2D`
+            Defines the selection region in pixel coordinates.
+        wcs : `lsst.afw.image.SkyWcs`
+            Maps ``bbox`` to sky coordinates.
+        orphans : `dict`, optional
+            Children held by other indices, keyed by parent ID; those of a
+            selected parent are returned with its own children unless
+            already among them.
+
+        Returns
+        -------
+        sources : iterable of `~lsst.afw.table.SourceRecord`
+            Parents within ``bbox``, each followed by its children, as in
+            `BaseReferencesTask.subset`.
+        """
+        boxD = lsst.geom.Box2D(bbox)
+        center, radius = self.makeBoundingCircle(boxD, wcs)
+        candidates = [self._parents[int(i)] for i in self.query(center, radius)]
+        if not candidates:
+            return
+        pixelPosList = wcs.skyToPixel([parent.getCoord() for parent in candidates])
+        for parent, pixel in zip(candidates, pixelPosList):
+            if boxD.contains(pixel):
+                yield parent
+                children = self.catalog.getChildren(parent.getId())
+                for child in children:
+                    yield child
+                if orphans and parent.getId() in orphans:
+                    childIds = set(child.getId() for child in children)
+                    for child in orphans[parent.getId()]:
+                        if child.getId() not in childIds:
+                            yield child
+
+    @staticmethod
+    def makeBoundingCircle(bbox, wcs, nPerEdge=4, margin=1.05):
+        """Return a sky circle that contains a pixel bounding box.
+
+        Parameters
+        ----------
+        bbox : `lsst.geom.Box2D`
+            Pixel-coordinate bounding box.
+        wcs : `lsst.afw.image.SkyWcs`
+            Maps ``bbox`` to sky coordinates.
+        nPerEdge : `int`, optional
+            Number of points sampled along each edge of ``bbox``.
+        margin : `float`, optional
+            Factor by which the radius through the furthest sampled point is
+            enlarged, to allow for curvature of the edges between samples.
+
+        Returns
+        -------
+        center : `lsst.geom.SpherePoint`
+            Sky position of the center of ``bbox``.
+        radius : `lsst.geom.Angle`
+            Radius of the circle.
+        """
+        xs = np.linspace(bbox.getMinX(), bbox.getMaxX(), nPerEdge + 1)
+        ys = np.linspace(bbox.getMinY(), bbox.getMaxY(), nPerEdge + 1)
+        boundary = ([lsst.geom.Point2D(x, bbox.getMinY()) for x in xs]
+                    + [lsst.geom.Point2D(x, bbox.getMaxY()) for x in xs]
+                    + [lsst.geom.Point2D(bbox.getMinX(), y) for y in ys]
+                    + [lsst.geom.Point2D(bbox.getMaxX(), y) for y in ys])
+        center = wcs.pixelToSky(bbox.getCenter())
+        radius = max(center.separation(coord).asRadians() for coord in wcs.pixelToSky(boundary))
+        return center, radius*margin*lsst.geom.radians
+
+
+class ReferenceCatalogCache:
+    """A memory-bounded cache of patch reference catalogs.
+
+    Entries are evicted in least-recently-used order once the estimated
+    memory of the cached catalogs exceeds the bound.
+
+    Parameters
+    ----------
+    maxSize : `float`, optional
+        Maximum estimated memory of the cached entries, in megabytes.
+
+    Notes
+    -----
+    `CoaddSrcReferencesTask` caches the `ReferenceIndex` of each patch it
+    reads, after applying ``removePatchOverlaps`` and column selection. All
+    tasks in a process share the instance returned by `getDefault` unless
+    constructed with their own, so a driver that measures many CCDs of a
+    visit in one process reads each patch once. Access is thread-safe.
+    """
+
+    _default = None
+    _defaultLock = threading.Lock()
+
+    def __init__(self, maxSize=0.0):
+        self.maxSize = maxSize
+        self.size = 0
+        self.hits = 0
+        self.misses = 0
+        self._entries = collections.OrderedDict()
+        self._lock = threading.Lock()
+
+    @classmethod
+    def getDefault(cls):
+        """Return the process-level cache, creating it if necessary.
+        """
+        with cls._defaultLock:
+            if cls._default is None:
+                cls._default = cls()
+            return cls._default
+
+    def __len__(self):
+        with self._lock:
+            return len(self._entries)
+
+    def __contains__(self, key):
+        with self._lock:
+            return key in self._entries
+
+    def get(self, key):
+        """Return a cached value, or `None` if ``key`` is not cached.
+        """
+        with self._lock:
+            if key not in self._entries:
+                self.misses += 1
+                return None
+            self.hits += 1
+            self._entries.move_to_end(key)
+            return self._entries[key][0]
+
+    def put(self, key, value, size):
+        """Add a value, evicting old entries to stay within the bound.
+
+        Parameters
+        ----------
+        key : hashable
+            Key of the entry.
+        value : `object`
+            Value to cache.
+        size : `int`
+            Estimated memory of ``value``, in bytes. Values larger than the
+            bound are not cached.
+        """
+        with self._lock:
+            if key in self._entries:
+                self.size -= self._entries.pop(key)[1]
+            maxBytes = self.maxSize*1024**2
+            if size > maxBytes:
+                return
+            while self._entries and self.size + size > maxBytes:
+                self.size -= self._entries.popitem(last=False)[1][1]
+            self._entries[key] = (value, size)
+            self.size += size
+
+    def clear(self):
+        """Remove all entries.
+        """
+        with self._lock:
+            self._entries.clear()
+            self.size = 0
+
+    @staticmethod
+    def estimateSize(catalog):
+        """Estimate the memory held by a catalog and its Footprints.
+
+        Parameters
+        ----------
+        catalog : `lsst.afw.table.SourceCatalog`
+            Catalog to measure.
+
+        Returns
+        -------
+        size : `int`
+            Estimated memory in bytes.
+        """
+        size = len(catalog)*catalog.getSchema().getRecordSize()
+        for record in catalog:
+            footprint = record.getFootprint()
+            if footprint is None:
+                continue
+            # Spans are three ints; HeavyFootprints also hold an image,
+            # mask and variance value for every pixel.
+            size += 12*len(footprint.getSpans()) + 32*len(footprint.getPeaks())
+            if footprint.isHeavy():
+                size += 10*footprint.getArea()
+        return size
 
 
 class BaseReferencesConfig(lsst.pex.config.Config):
@@ -44,6 +355,18 @@ class BaseReferencesConfig(lsst.pex.config.Config):
         dtype=str,
         optional=True
     )
+    indexZoneHeight = lsst.pex.config.Field(
+        doc="Height (arcseconds) of the declination zones of the spatial index used to select "
+            "reference sources within an exposure.",
+        dtype=float,
+        default=60.0,
+    )
+    columns = lsst.pex.config.ListField(
+        doc="Names or glob patterns of the reference columns to load, in addition to the minimal schema; "
+            "aliases are resolved. If empty, all columns are loaded.",
+        dtype=str,
+        default=[],
+    )
 
 
 class BaseReferencesTask(lsst.pipe.base.Task):
@@ -55,6 +378,8 @@ class BaseReferencesTask(lsst.pipe.base.Task):
         The schema of the reference catalog.
     butler : `lsst.daf.persistence.butler.Butler`, optional
         A butler that will allow the task to load its schema from disk.
+    columns : iterable of `str`, optional
+        Reference columns to load, overriding ``config.columns``.
 
     Notes
     -----
@@ -77,8 +402,58 @@ class BaseReferencesTask(lsst.pipe.base.Task):
     """Configuration class associated with this task (`lsst.pex.config.Config`).
     """
 
-    def __init__(self, butler=None, schema=None, **kwargs):
+    def __init__(self, butler=None, schema=None, columns=None, **kwargs):
         lsst.pipe.base.Task.__init__(self, **kwargs)
+        self.columns = list(self.config.columns) if columns is None else list(columns)
+
+    def setColumns(self, columns):
+        """Set the reference columns to load.
+
+        Parameters
+        ----------
+        columns : iterable of `str`
+            Names or glob patterns of reference fields, as for
+            ``config.columns``; loaded in addition to the minimal schema.
+
+        Notes
+        -----
+        Subclasses that restrict ``self.schema`` to the loaded columns must
+        update it here; callers should read ``schema`` again afterwards.
+        """
+        self.columns = list(columns)
+
+    def makeColumnMapper(self, schema):
+        """Make a mapper that selects the reference columns to load.
+
+        Parameters
+        ----------
+        schema : `lsst.afw.table.Schema`
+            Schema of the reference catalogs as stored.
+
+        Returns
+        -------
+        mapper : `lsst.afw.table.SchemaMapper` or `None`
+            Mapper from ``schema`` to one with the minimal source schema and
+            the fields matching `columns`, with the aliases whose targets
+            remain; `None` if all columns are loaded.
+        """
+        if not self.columns:
+            return None
+        mapper = lsst.afw.table.SchemaMapper(schema)
+        mapper.addMinimalSchema(lsst.afw.table.SourceTable.makeMinimalSchema(), True)
+        aliases = schema.getAliasMap()
+        names = set()
+        for pattern in self.columns:
+            names.update(schema.extract(aliases.apply(pattern)).keys())
+        names -= mapper.getOutputSchema().getNames()
+        for name in sorted(names):
+            mapper.addMapping(schema.find(name).key, True)
+        outputNames = mapper.getOutputSchema().getNames()
+        outputAliases = mapper.editOutputSchema().getAliasMap()
+        for alias, target in aliases.items():
+            if any(name == target or name.startswith(target + "_") for name in outputNames):
+                outputAliases.set(alias, target)
+        return mapper
 
     def getSchema(self, butler):
         """Return the schema for the reference sources.
@@ -189,24 +564,31 @@ class BaseReferencesTask(lsst.pipe.base.Task):
         This is not a part of the required `BaseReferencesTask` interface;
         it's a convenience function used in implementing `fetchInBox` that may
         be of use to subclasses.
+
+        The sources are indexed with `ReferenceIndex`, so only parents near
+        the region are transformed to pixel coordinates; subclasses that
+        select from the same sources repeatedly should keep the index (see
+        `makeIndex`).
         """
-        boxD = lsst.geom.Box2D(bbox)
-        # We're passed an arbitrary iterable, but we need a catalog so we can
-        # iterate over parents and then children.
-        catalog = lsst.afw.table.SourceCatalog(self.schema)
-        catalog.extend(sources)
-        # catalog must be sorted by parent ID for lsst.afw.table.getChildren
-        # to work
-        catalog.sort(lsst.afw.table.SourceTable.getParentKey())
-        # Iterate over objects that have no parent.
-        parentSources = catalog.getChildren(0)
-        skyCoordList = [source.getCoord() for source in parentSources]
-        pixelPosList = wcs.skyToPixel(skyCoordList)
-        for parent, pixel in zip(parentSources, pixelPosList):
-            if boxD.contains(pixel):
-                yield parent
-                for child in catalog.getChildren(parent.getId()):
-                    yield child
+        return self.makeIndex(sources).subset(bbox, wcs)
+
+    def makeIndex(self, sources):
+        """Build a spatial index over reference sources.
+
+        Parameters
+        ----------
+        sources : iterable of `~lsst.afw.table.SourceRecord`
+            Reference sources. May be any Python iterable, including a lazy
+            iterator.
+
+        Returns
+        -------
+        index : `ReferenceIndex`
+            Index whose `ReferenceIndex.subset` method selects sources as
+            `subset` does.
+        """
+        return ReferenceIndex(sources, self.schema,
+                              zoneHeight=self.config.indexZoneHeight*lsst.geom.arcseconds)
 
 
 class CoaddSrcReferencesConfig(BaseReferencesTask.ConfigClass):
@@ -223,6 +605,18 @@ class CoaddSrcReferencesConfig(BaseReferencesTask.ConfigClass):
         dtype=bool,
         default=False
     )
+    keepIndices = lsst.pex.config.Field(
+        doc="Keep the spatial index of each patch read by fetchInBox until a call that does not "
+            "overlap that patch, so consecutive exposures on the same patches reuse it.",
+        dtype=bool,
+        default=True
+    )
+    cacheSize = lsst.pex.config.Field(
+        doc="Maximum memory (MB) used by the process-level cache of patch reference catalogs shared "
+            "by all references tasks; 0 disables the cache.",
+        dtype=float,
+        default=0.0
+    )
 
     def validate(self):
         if (self.coaddName == "chiSquared") != (self.filter is None):
@@ -247,11 +641,16 @@ class CoaddSrcReferencesTask(BaseReferencesTask):
     butler : `lsst.daf.persistence.butler.Butler`, optional
         A Butler used to read the input schema from disk. Required if
         ``schema`` is `None`.
+    columns : iterable of `str`, optional
+        Reference columns to load, overriding ``config.columns``.
+    cache : `ReferenceCatalogCache`, optional
+        Cache of patch reference catalogs; defaults to the process-level
+        cache if ``config.cacheSize`` is nonzero.
 
     Notes
     -----
     The task will set its own ``self.schema`` attribute to the schema of the
-    output merged catalog.
+    output merged catalog, restricted to the selected columns.
     """
 
     ConfigClass = CoaddSrcReferencesConfig
@@ -262,13 +661,28 @@ class CoaddSrcReferencesTask(BaseReferencesTask):
     """Suffix to append to ``Coadd_`` to generate the dataset name (`str`).
     """
 
-    def __init__(self, butler=None, schema=None, **kwargs):
-        BaseReferencesTask.__init__(self, butler=butler, schema=schema, **kwargs)
+    def __init__(self, butler=None, schema=None, columns=None, cache=None, **kwargs):
+        BaseReferencesTask.__init__(self, butler=butler, schema=schema, columns=columns, **kwargs)
         if schema is None:
             assert butler is not None, "No butler nor schema provided"
             schema = butler.get("{}Coadd_{}_schema".format(self.config.coaddName, self.datasetSuffix),
                                 immediate=True).getSchema()
-        self.schema = schema
+        self._fullSchema = schema
+        self.setColumns(self.columns)
+        if cache is None and self.config.cacheSize > 0:
+            cache = ReferenceCatalogCache.getDefault()
+            cache.maxSize = max(cache.maxSize, self.config.cacheSize)
+        self.cache = cache
+
+    def setColumns(self, columns):
+        # Docstring inherited.
+        BaseReferencesTask.setColumns(self, columns)
+        self.columnMapper = self.makeColumnMapper(self._fullSchema)
+        if self.columnMapper is None:
+            self.schema = self._fullSchema
+        else:
+            self.schema = self.columnMapper.getOutputSchema()
+        self._patchIndices = {}
 
     def getWcs(self, dataRef):
         """Return the WCS for reference sources.
@@ -303,28 +717,97 @@ class CoaddSrcReferencesTask(BaseReferencesTask):
         An implementation of `BaseReferencesTask.fetchInPatches` that loads
         ``Coadd_`` + `datasetSuffix` catalogs using the butler.
         """
+        for patch in patchList:
+            if self.cache is not None:
+                index = self._loadPatchIndex(dataRef, patch)
+                if index is not None:
+                    yield from index.catalog
+                continue
+            catalog = self._readPatch(dataRef, patch)
+            if catalog is not None:
+                yield from catalog
+
+    def _readPatch(self, dataRef, patch):
+        """Read the reference sources of one patch.
+
+        Parameters
+        ----------
+        dataRef : `lsst.daf.persistence.ButlerDataRef`
+            Butler data reference. The implied data ID must contain the
+            ``tract`` key.
+        patch : `lsst.skymap.PatchInfo`
+            Patch for which to fetch reference sources.
+
+        Returns
+        -------
+        sources : iterable of `~lsst.afw.table.SourceRecord` or `None`
+            Reference sources, restricted to the patch's inner bounding box
+            if ``config.removePatchOverlaps`` is `True`, or `None` if the
+            catalog does not exist and ``config.skipMissing`` is `True`.
+        """
         dataset = "{}Coadd_{}".format(self.config.coaddName, self.datasetSuffix)
-        tract = dataRef.dataId["tract"]
         butler = dataRef.butlerSubset.butler
-        for patch in patchList:
-            dataId = {'tract': tract, 'patch': "%d,%d" % patch.getIndex()}
-            if self.config.filter is not None:
-                dataId['filter'] = self.config.filter
-
-            if not butler.datasetExists(dataset, dataId):
-                if self.config.skipMissing:
-                    continue
-                raise lsst.pipe.base.TaskError("Reference %s doesn't exist" % (dataId,))
-            self.log.info("Getting references in %s" % (dataId,))
-            catalog = butler.get(dataset, dataId, immediate=True)
-            if self.config.removePatchOverlaps:
-                bbox = lsst.geom.Box2D(patch.getInnerBBox())
-                for source in catalog:
-                    if bbox.contains(source.getCentroid()):
-                        yield source
-            else:
-                for source in catalog:
-                    yield source
+        dataId = {'tract': dataRef.dataId["tract"], 'patch': "%d,%d" % patch.getIndex()}
+        if self.config.filter is not None:
+            dataId['filter'] = self.config.filter
+
+        if not butler.datasetExists(dataset, dataId):
+            if self.config.skipMissing:
+                return None
+            raise lsst.pipe.base.TaskError("Reference %s doesn't exist" % (dataId,))
+        self.log.info("Getting references in %s" % (dataId,))
+        catalog = butler.get(dataset, dataId, immediate=True)
+        if self.config.removePatchOverlaps:
+            bbox = lsst.geom.Box2D(patch.getInnerBBox())
+            catalog = [source for source in catalog if bbox.contains(source.getCentroid())]
+        if self.columnMapper is not None:
+            selected = lsst.afw.table.SourceCatalog(self.schema)
+            selected.extend(catalog, mapper=self.columnMapper)
+            catalog = selected
+        return catalog
+
+    def _getPatchIndex(self, dataRef, patch):
+        """Return the spatial index of the reference sources of one patch.
+
+        Parameters
+        ----------
+        dataRef : `lsst.daf.persistence.ButlerDataRef`
+            Butler data reference. The implied data ID must contain the
+            ``tract`` key.
+        patch : `lsst.skymap.PatchInfo`
+            Patch for which to fetch reference sources.
+
+        Returns
+        -------
+        index : `ReferenceIndex` or `None`
+            Index over the patch's reference sources, or `None` if the
+            catalog is missing and ``config.skipMissing`` is `True`.
+        """
+        key = (dataRef.dataId["tract"], tuple(patch.getIndex()))
+        if key not in self._patchIndices:
+            self._patchIndices[key] = self._loadPatchIndex(dataRef, patch)
+        return self._patchIndices[key]
+
+    def _loadPatchIndex(self, dataRef, patch):
+        """Return the spatial index of one patch from the cache, reading and
+        indexing the patch on a cache miss.
+
+        Parameters are as for `_getPatchIndex`.
+        """
+        if self.cache is None:
+            catalog = self._readPatch(dataRef, patch)
+            return self.makeIndex(catalog) if catalog is not None else None
+        cacheKey = (dataRef.butlerSubset.butler, self.config.coaddName, self.datasetSuffix,
+                    self.config.filter, self.config.removePatchOverlaps, tuple(self.columns),
+                    self.config.indexZoneHeight, dataRef.dataId["tract"], tuple(patch.getIndex()))
+        index = self.cache.get(cacheKey)
+        if index is None:
+            catalog = self._readPatch(dataRef, patch)
+            if catalog is None:
+                return None
+            index = self.makeIndex(catalog)
+            self.cache.put(cacheKey, index, ReferenceCatalogCache.estimateSize(index.catalog))
+        return index
 
     def fetchInBox(self, dataRef, bbox, wcs, pad=0):
         """Return reference sources within a given bounding box.
@@ -361,7 +844,32 @@ class CoaddSrcReferencesTask(BaseReferencesTask):
         # But don't add any new patches while padding
         if pad:
             bbox.grow(pad)
-        return self.subset(self.fetchInPatches(dataRef, patchList), bbox, wcs)
+        tractId = dataRef.dataId["tract"]
+        if self.config.keepIndices:
+            requested = set((tractId, tuple(patch.getIndex())) for patch in patchList)
+            self._patchIndices = {key: index for key, index in self._patchIndices.items()
+                                  if key in requested}
+        else:
+            self._patchIndices = {}
+        indices = [self._getPatchIndex(dataRef, patch) for patch in patchList]
+        return self._subsetIndices([index for index in indices if index is not None], bbox, wcs)
+
+    def _subsetIndices(self, indices, bbox, wcs):
+        """Select the sources within a bounding box from several indices.
+
+        Each patch is indexed separately, so a child whose parent was read
+        from another patch is an orphan of its own index; orphans are
+        returned with their parent, as if the patches had been merged.
+        """
+        orphans = {}
+        for index in indices:
+            for parentId, children in index.orphans.items():
+                merged = orphans.setdefault(parentId, {})
+                for child in children:
+                    merged.setdefault(child.getId(), child)
+        orphans = {parentId: list(children.values()) for parentId, children in orphans.items()}
+        for index in indices:
+            yield from index.subset(bbox, wcs, orphans=orphans)
 
 
 class MultiBandReferencesConfig(CoaddSrcReferencesTask.ConfigClass):
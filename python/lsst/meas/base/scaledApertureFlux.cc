@@ -47,6 +47,7 @@ using PyFluxTransform =
 PyFluxControl declareFluxControl(py::module &mod) {
     PyFluxControl cls(mod, "ScaledApertureFluxControl");
 
+    LSST_DECLARE_CONTROL_FIELD(cls, ScaledApertureFluxControl, radiusGridStep);
     LSST_DECLARE_CONTROL_FIELD(cls, ScaledApertureFluxControl, scale);
     LSST_DECLARE_CONTROL_FIELD(cls, ScaledApertureFluxControl, shiftKernel);
 
@@ -62,7 +63,8 @@ PyFluxAlgorithm declareFluxAlgorithm(py::module &mod) {
                      afw::table::Schema &>(),
             "ctrl"_a, "name"_a, "schema"_a);
 
-    cls.def("measure", &ScaledApertureFluxAlgorithm::measure, "measRecord"_a, "exposure"_a);
+    cls.def("measure", &ScaledApertureFluxAlgorithm::measure, "measRecord"_a, "exposure"_a,
+            py::call_guard<py::gil_scoped_release>());
     cls.def("fail", &ScaledApertureFluxAlgorithm::fail, "measRecord"_a, "error"_a = nullptr);
 
     return cls;
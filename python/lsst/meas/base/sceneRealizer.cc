@@ -0,0 +1,61 @@
+/*
+ * LSST Data Management System
+ * Copyright 2008-2017  AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+
+#include <memory>
+
+#include "lsst/meas/base/SceneRealizer.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+PYBIND11_MODULE(sceneRealizer, mod) {
+    py::module::import("lsst.geom");
+    py::module::import("lsst.afw.geom");
+    py::module::import("lsst.afw.detection");
+    py::module::import("lsst.afw.image");
+
+    py::class_<SceneSource> clsSource(mod, "SceneSource");
+    clsSource.def(py::init<double, geom::Point2D const &, afw::geom::ellipses::Quadrupole const &>(),
+                  "instFlux"_a, "center"_a, "shape"_a);
+    clsSource.def_readonly("instFlux", &SceneSource::instFlux);
+    clsSource.def_readonly("center", &SceneSource::center);
+    clsSource.def_readonly("shape", &SceneSource::shape);
+
+    py::class_<SceneRealizer, std::shared_ptr<SceneRealizer>> cls(mod, "SceneRealizer");
+    cls.def(py::init<double, int, double, int>(), "threshold"_a, "growRadius"_a = 0, "nSigma"_a = 8.0,
+            "tileHeight"_a = 64);
+    cls.def("render", &SceneRealizer::render, "sources"_a, "image"_a, "nThreads"_a = 0,
+            py::call_guard<py::gil_scoped_release>());
+    cls.def("makeFootprints", &SceneRealizer::makeFootprints, "sources"_a, "bbox"_a);
+    cls.def("makeHeavyFootprints", &SceneRealizer::makeHeavyFootprints, "sources"_a, "footprints"_a);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
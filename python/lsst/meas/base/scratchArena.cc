@@ -0,0 +1,48 @@
+/*
+ * LSST Data Management System
+ * Copyright 2008-2017  AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "pybind11/pybind11.h"
+
+#include "lsst/meas/base/ScratchArena.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+PYBIND11_MODULE(scratchArena, mod) {
+    py::class_<ScratchArena> cls(mod, "ScratchArena");
+
+    py::class_<ScratchArena::Statistics> clsStatistics(cls, "Statistics");
+    clsStatistics.def_readonly("buffers", &ScratchArena::Statistics::buffers);
+    clsStatistics.def_readonly("blocks", &ScratchArena::Statistics::blocks);
+    clsStatistics.def_readonly("blockBytes", &ScratchArena::Statistics::blockBytes);
+
+    cls.def_static("getStatistics", &ScratchArena::getStatistics);
+    cls.def_static("resetStatistics", &ScratchArena::resetStatistics);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -52,6 +52,9 @@ PyCentroidControl declareCentroidControl(py::module &mod) {
     LSST_DECLARE_CONTROL_FIELD(cls, SdssCentroidControl, wfac);
     LSST_DECLARE_CONTROL_FIELD(cls, SdssCentroidControl, doFootprintCheck);
     LSST_DECLARE_CONTROL_FIELD(cls, SdssCentroidControl, maxDistToPeak);
+    LSST_DECLARE_CONTROL_FIELD(cls, SdssCentroidControl, psfCellSize);
+    LSST_DECLARE_CONTROL_FIELD(cls, SdssCentroidControl, usePyramid);
+    LSST_DECLARE_CONTROL_FIELD(cls, SdssCentroidControl, uncertainty);
 
     cls.def(py::init<>());
 
@@ -70,8 +73,12 @@ PyCentroidAlgorithm declareCentroidAlgorithm(py::module &mod) {
     cls.def(py::init<SdssCentroidAlgorithm::Control const &, std::string const &, afw::table::Schema &>(),
             "ctrl"_a, "name"_a, "schema"_a);
 
-    cls.def("measure", &SdssCentroidAlgorithm::measure, "measRecord"_a, "exposure"_a);
+    cls.def("measure", &SdssCentroidAlgorithm::measure, "measRecord"_a, "exposure"_a,
+            py::call_guard<py::gil_scoped_release>());
     cls.def("fail", &SdssCentroidAlgorithm::fail, "measRecord"_a, "error"_a = nullptr);
+    cls.def("setSmoothedImage", &SdssCentroidAlgorithm::setSmoothedImage, "image"_a,
+            "smoothingSigma"_a = 0.0, "useForChildren"_a = true);
+    cls.def("getSmoothedImage", &SdssCentroidAlgorithm::getSmoothedImage);
 
     return cls;
 }
@@ -89,6 +96,7 @@ PyCentroidTransform declareCentroidTransform(py::module &mod) {
 }  // namespace
 
 PYBIND11_MODULE(sdssCentroid, mod) {
+    py::module::import("lsst.afw.image");
     py::module::import("lsst.afw.table");
     py::module::import("lsst.meas.base.algorithm");
     py::module::import("lsst.meas.base.flagHandler");
@@ -21,6 +21,7 @@
  */
 
 #include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
 
 #include <memory>
 
@@ -58,6 +59,10 @@ PyShapeControl declareShapeControl(py::module &mod) {
     LSST_DECLARE_CONTROL_FIELD(cls, SdssShapeControl, tol1);
     LSST_DECLARE_CONTROL_FIELD(cls, SdssShapeControl, tol2);
     LSST_DECLARE_CONTROL_FIELD(cls, SdssShapeControl, doMeasurePsf);
+    LSST_DECLARE_CONTROL_FIELD(cls, SdssShapeControl, vectorize);
+    LSST_DECLARE_CONTROL_FIELD(cls, SdssShapeControl, doWarmStart);
+    LSST_DECLARE_CONTROL_FIELD(cls, SdssShapeControl, uncertainty);
+    LSST_DECLARE_CONTROL_FIELD(cls, SdssShapeControl, doRecordWeightedSum);
 
     cls.def(py::init<>());
 
@@ -70,7 +75,8 @@ void declareShapeResultKey(py::module &mod) {
     // TODO decide whether to wrap default constructor and do it or document why not
     cls.def(py::init<afw::table::SubSchema const &>(), "subSchema"_a);
 
-    cls.def_static("addFields", &FluxResultKey::addFields, "schema"_a, "name"_a, "doMeasurePsf"_a);
+    cls.def_static("addFields", &SdssShapeResultKey::addFields, "schema"_a, "name"_a, "doMeasurePsf"_a,
+                   "uncertainty"_a = SIGMA_ONLY);
 
     cls.def("__eq__", &SdssShapeResultKey::operator==, py::is_operator());
     cls.def("__ne__", &SdssShapeResultKey::operator!=, py::is_operator());
@@ -90,11 +96,28 @@ static void declareComputeMethods(PyShapeAlgorithm &cls) {
             (SdssShapeResult(*)(ImageT const &, geom::Point2D const &, bool, SdssShapeControl const &)) &
                     SdssShapeAlgorithm::computeAdaptiveMoments,
             "image"_a, "position"_a, "negative"_a = false, "ctrl"_a = SdssShapeControl());
+    cls.def_static("computeAdaptiveMoments",
+                   (SdssShapeResult(*)(ImageT const &, geom::Point2D const &,
+                                       afw::geom::ellipses::Quadrupole const &, bool,
+                                       SdssShapeControl const &)) &
+                           SdssShapeAlgorithm::computeAdaptiveMoments,
+                   "image"_a, "position"_a, "initialWeight"_a, "negative"_a = false,
+                   "ctrl"_a = SdssShapeControl());
     cls.def_static(
             "computeFixedMomentsFlux",
-            (FluxResult(*)(ImageT const &, afw::geom::ellipses::Quadrupole const &, geom::Point2D const &)) &
+            (FluxResult(*)(ImageT const &, afw::geom::ellipses::Quadrupole const &, geom::Point2D const &,
+                           SdssShapeControl const &)) &
                     SdssShapeAlgorithm::computeFixedMomentsFlux,
-            "image"_a, "shape"_a, "position"_a);
+            "image"_a, "shape"_a, "position"_a, "ctrl"_a = SdssShapeControl());
+    cls.def_static("computeFixedMomentsFluxFromSum",
+                   &SdssShapeAlgorithm::computeFixedMomentsFluxFromSum<ImageT>, "image"_a, "shape"_a,
+                   "position"_a, "weightedSum"_a);
+    cls.def_static("computeFixedMomentsFluxes",
+                   (std::vector<FluxResult>(*)(ImageT const &, afw::geom::ellipses::Quadrupole const &,
+                                               geom::Point2D const &, std::vector<double> const &,
+                                               SdssShapeControl const &)) &
+                           SdssShapeAlgorithm::computeFixedMomentsFluxes,
+                   "image"_a, "shape"_a, "position"_a, "scales"_a, "ctrl"_a = SdssShapeControl());
 }
 
 PyShapeAlgorithm declareShapeAlgorithm(py::module &mod) {
@@ -110,6 +133,8 @@ PyShapeAlgorithm declareShapeAlgorithm(py::module &mod) {
     cls.def(py::init<SdssShapeAlgorithm::Control const &, std::string const &, afw::table::Schema &>(),
             "ctrl"_a, "name"_a, "schema"_a);
 
+    cls.def_static("getDefaultInitialWeight", &SdssShapeAlgorithm::getDefaultInitialWeight);
+
     declareComputeMethods<afw::image::Image<int>>(cls);
     declareComputeMethods<afw::image::Image<float>>(cls);
     declareComputeMethods<afw::image::Image<double>>(cls);
@@ -117,7 +142,8 @@ PyShapeAlgorithm declareShapeAlgorithm(py::module &mod) {
     declareComputeMethods<afw::image::MaskedImage<float>>(cls);
     declareComputeMethods<afw::image::MaskedImage<double>>(cls);
 
-    cls.def("measure", &SdssShapeAlgorithm::measure, "measRecord"_a, "exposure"_a);
+    cls.def("measure", &SdssShapeAlgorithm::measure, "measRecord"_a, "exposure"_a,
+            py::call_guard<py::gil_scoped_release>());
     cls.def("fail", &SdssShapeAlgorithm::fail, "measRecord"_a, "error"_a = nullptr);
 
     return cls;
@@ -132,6 +158,7 @@ void declareShapeResult(py::module &mod) {
     cls.def_readwrite("instFlux_yy_Cov", &SdssShapeResult::instFlux_yy_Cov);
     cls.def_readwrite("instFlux_xy_Cov", &SdssShapeResult::instFlux_xy_Cov);
     cls.def_readwrite("flags", &SdssShapeResult::flags);
+    cls.def_readwrite("nIter", &SdssShapeResult::nIter);
 
     // TODO this method says it's a workaround for Swig which doesn't understand std::bitset
     cls.def("getFlag", (bool (SdssShapeResult::*)(unsigned int) const) & SdssShapeResult::getFlag, "index"_a);
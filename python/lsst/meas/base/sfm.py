@@ -31,12 +31,20 @@ systems if necessary to avoid information loss (this should, of course, be
 indicated in the field documentation).
 """
 
+import concurrent.futures
+import contextlib
+import math
+import time
+
+import lsst.afw.image
+import lsst.afw.table
+import lsst.pex.config
 import lsst.pipe.base as pipeBase
 
-from .pluginRegistry import PluginRegistry
+from .pluginRegistry import PluginRegistry, PluginMap
 from .baseMeasurement import (BaseMeasurementPluginConfig, BaseMeasurementPlugin,
-                              BaseMeasurementConfig, BaseMeasurementTask)
-from .noiseReplacer import NoiseReplacer, DummyNoiseReplacer
+                              BaseMeasurementConfig, BaseMeasurementTask, PsfClonePool)
+from .noiseReplacer import NoiseReplacer, ScratchNoiseReplacer, DummyNoiseReplacer
 
 __all__ = ("SingleFramePluginConfig", "SingleFramePlugin",
            "SingleFrameMeasurementConfig", "SingleFrameMeasurementTask")
@@ -127,6 +135,12 @@ class SingleFramePlugin(BaseMeasurementPlugin):
         """
         raise NotImplementedError()
 
+    # Plugins may additionally define ``measureBatch(measCat, exposure, indices)``,
+    # which must be equivalent to calling `measure` on ``measCat[i]`` for each
+    # of ``indices`` and handling failures as `BaseMeasurementTask.doMeasurement`
+    # does.  It is used instead of `measure` when neighbors are not being
+    # replaced with noise (see `SingleFrameMeasurementConfig.doMeasureBatch`).
+
 
 class SingleFrameMeasurementConfig(BaseMeasurementConfig):
     """Config class for single frame measurement driver task.
@@ -154,6 +168,29 @@ class SingleFrameMeasurementConfig(BaseMeasurementConfig):
         default=[],
         doc="Plugins to run on undeblended image"
     )
+    numThreads = lsst.pex.config.RangeField(
+        dtype=int, default=1, min=1,
+        doc="Number of threads to measure parent families with when replacing neighbors with noise "
+            "(see SingleFrameMeasurementTask.runPluginsParallel), and to run the undeblended and "
+            "blendedness passes over the restored image with"
+    )
+    doMeasureBatch = lsst.pex.config.Field(
+        dtype=bool, default=True,
+        doc="When neighbors are not replaced with noise, measure all sources with each plugin "
+            "in a single call, for plugins that support it (e.g. those implemented in C++)?"
+    )
+    doFuseBlendedness = lsst.pex.config.Field(
+        dtype=bool, default=False,
+        doc="Capture the noise-replaced pixels of each source for base_Blendedness as it is measured, "
+            "and measure the child and parent blendedness moments together once all sources are "
+            "restored, instead of in two passes?  Results are unchanged."
+    )
+
+    def setDefaults(self):
+        super().setDefaults()
+        # The undeblended instance measures the restored image, so it must not reuse the weighted sum
+        # SdssShape recorded on the image with neighbors replaced by noise.
+        self.undeblended["base_GaussianFlux"].doReuseWeightedSum = False
 
 
 class SingleFrameMeasurementTask(BaseMeasurementTask):
@@ -202,9 +239,11 @@ class SingleFrameMeasurementTask(BaseMeasurementTask):
             self.blendPlugin = self.plugins['base_Blendedness']
         else:
             self.doBlendedness = False
+        self._blendednessPixels = None
 
     @pipeBase.timeMethod
-    def run(self, measCat, exposure, noiseImage=None, exposureId=None, beginOrder=None, endOrder=None):
+    def run(self, measCat, exposure, noiseImage=None, exposureId=None, beginOrder=None, endOrder=None,
+            smoothedImage=None, smoothingSigma=0.0):
         r"""Run single frame measurement over an exposure and source catalog.
 
         Parameters
@@ -231,6 +270,12 @@ class SingleFrameMeasurementTask(BaseMeasurementTask):
             Final execution order (exclusive): measurements with
             ``executionOrder >= endOrder`` are not executed. `None` for no
             limit.
+        smoothedImage : `lsst.afw.image.MaskedImageF`, optional
+            The image already smoothed with the PSF, e.g. by detection; see
+            `usePresmoothedImage`.
+        smoothingSigma : `float`, optional
+            Gaussian sigma of the kernel ``smoothedImage`` was smoothed with;
+            see `usePresmoothedImage`.
         """
         assert measCat.getSchema().contains(self.schema)
         footprints = {measRecord.getId(): (measRecord.getParent(), measRecord.getFootprint())
@@ -243,19 +288,78 @@ class SingleFrameMeasurementTask(BaseMeasurementTask):
         # belong to objects in measCat will be replaced with noise
 
         if self.config.doReplaceWithNoise:
-            noiseReplacer = NoiseReplacer(self.config.noiseReplacer, exposure, footprints,
-                                          noiseImage=noiseImage, log=self.log, exposureId=exposureId)
-            algMetadata = measCat.getMetadata()
-            if algMetadata is not None:
-                algMetadata.addInt(self.NOISE_SEED_MULTIPLIER, self.config.noiseReplacer.noiseSeedMultiplier)
-                algMetadata.addString(self.NOISE_SOURCE, self.config.noiseReplacer.noiseSource)
-                algMetadata.addDouble(self.NOISE_OFFSET, self.config.noiseReplacer.noiseOffset)
-                if exposureId is not None:
-                    algMetadata.addLong(self.NOISE_EXPOSURE_ID, exposureId)
+            if self.config.numThreads > 1:
+                # Each worker replaces neighbors with noise in its own copy of the pixels.
+                noiseReplacer = None
+            else:
+                NoiseReplacerClass = (ScratchNoiseReplacer if self.config.noiseReplacer.useScratchImages
+                                      else NoiseReplacer)
+                noiseReplacer = NoiseReplacerClass(self.config.noiseReplacer, exposure, footprints,
+                                                   noiseImage=noiseImage, log=self.log, exposureId=exposureId,
+                                                   detectionMasks=self.needsDetectionMasks(beginOrder,
+                                                                                           endOrder))
+            self._recordNoiseMetadata(measCat, exposureId)
         else:
             noiseReplacer = DummyNoiseReplacer()
 
-        self.runPlugins(noiseReplacer, measCat, exposure, beginOrder, endOrder)
+        presmoothed = self.usePresmoothedImage(smoothedImage, smoothingSigma)
+        with self.pluginTiming(), self.pluginTracing(), presmoothed:
+            if noiseReplacer is None:
+                self.runPluginsParallel(measCat, exposure, footprints, noiseImage=noiseImage,
+                                        exposureId=exposureId, beginOrder=beginOrder, endOrder=endOrder)
+            else:
+                self.runPlugins(noiseReplacer, measCat, exposure, beginOrder, endOrder)
+
+    @contextlib.contextmanager
+    def usePresmoothedImage(self, smoothedImage, smoothingSigma=0.0):
+        """Let plugins read a PSF-smoothed image for the duration of a block.
+
+        Parameters
+        ----------
+        smoothedImage : `lsst.afw.image.MaskedImageF` or `None`
+            The image being measured (or a subimage of it) convolved with the
+            PSF, with its variance propagated, as computed by
+            `lsst.afw.math.convolve`; the detection stage computes one. Does
+            nothing if `None`.
+        smoothingSigma : `float`, optional
+            Gaussian sigma of the smoothing kernel, e.g. the ``sigma`` returned
+            by `lsst.meas.algorithms.SourceDetectionTask.convolveImage`.  If
+            not positive, the image is assumed to have been smoothed with the
+            PSF model itself.
+
+        Notes
+        -----
+        The image is given to every plugin whose algorithm has a
+        ``setSmoothedImage`` method (e.g. ``base_SdssCentroid``, which then
+        reads the neighbourhood of unbinned sources from it instead of
+        smoothing them), and withdrawn when the block exits.  Neighbours are
+        not replaced with noise in it, so if ``config.doReplaceWithNoise`` is
+        set it is only used for sources that are not deblended children.
+        """
+        if smoothedImage is None:
+            yield
+            return
+        algorithms = [plugin.cpp for plugin in self.plugins.values()
+                      if hasattr(getattr(plugin, "cpp", None), "setSmoothedImage")]
+        for algorithm in algorithms:
+            algorithm.setSmoothedImage(smoothedImage, smoothingSigma,
+                                       useForChildren=not self.config.doReplaceWithNoise)
+        try:
+            yield
+        finally:
+            for algorithm in algorithms:
+                algorithm.setSmoothedImage(None)
+
+    def _recordNoiseMetadata(self, measCat, exposureId):
+        """Record the noise replacement configuration in the catalog metadata.
+        """
+        algMetadata = measCat.getMetadata()
+        if algMetadata is not None:
+            algMetadata.addInt(self.NOISE_SEED_MULTIPLIER, self.config.noiseReplacer.noiseSeedMultiplier)
+            algMetadata.addString(self.NOISE_SOURCE, self.config.noiseReplacer.noiseSource)
+            algMetadata.addDouble(self.NOISE_OFFSET, self.config.noiseReplacer.noiseOffset)
+            if exposureId is not None:
+                algMetadata.addLong(self.NOISE_EXPOSURE_ID, exposureId)
 
     def runPlugins(self, noiseReplacer, measCat, exposure, beginOrder=None, endOrder=None):
         r"""Call the configured measument plugins on an image.
@@ -281,6 +385,12 @@ class SingleFrameMeasurementTask(BaseMeasurementTask):
             ``executionOrder >= endOrder`` are not executed. `None` for no
             limit.
         """
+        with self.cachedPsf(exposure):
+            self._runPlugins(noiseReplacer, measCat, exposure, beginOrder, endOrder)
+
+    def _runPlugins(self, noiseReplacer, measCat, exposure, beginOrder, endOrder):
+        """Implementation of `runPlugins`, called with any PSF cache in place.
+        """
         # First, create a catalog of all parentless sources. Loop through all
         # the parent sources, first processing the children, then the parent.
         measParentCat = measCat.getChildren(0)
@@ -292,47 +402,671 @@ class SingleFrameMeasurementTask(BaseMeasurementTask):
                       nMeasParentCat, ("" if nMeasParentCat == 1 else "s"),
                       nMeasCat - nMeasParentCat, ("" if nMeasCat - nMeasParentCat == 1 else "ren"))
 
-        for parentIdx, measParentRecord in enumerate(measParentCat):
-            # first get all the children of this parent, insert footprint in
-            # turn, and measure
-            measChildCat = measCat.getChildren(measParentRecord.getId())
-            # TODO: skip this loop if there are no plugins configured for
-            # single-object mode
-            for measChildRecord in measChildCat:
-                noiseReplacer.insertSource(measChildRecord.getId())
-                self.callMeasure(measChildRecord, exposure, beginOrder=beginOrder, endOrder=endOrder)
+        self._traceFamilies(measCat)
+        if (self.config.doMeasureBatch and isinstance(noiseReplacer, DummyNoiseReplacer) and
+                not self.doBlendedness):
+            self._runPluginsBatch(measCat, measParentCat, exposure, beginOrder, endOrder)
+            self._runUnmodifiedPasses(measCat, exposure, endOrder)
+            return
+
+        self._startBlendedness()
+        for parentIdx in self.getSourceOrder(measParentCat):
+            self._runFamily(noiseReplacer, measCat, measParentCat, parentIdx, exposure, beginOrder, endOrder)
+
+        # When done, restore the exposure to its original state
+        noiseReplacer.end()
+
+        self._runUnmodifiedPasses(measCat, exposure, endOrder)
+
+    def _runFamily(self, noiseReplacer, measCat, measParentCat, parentIdx, exposure, beginOrder, endOrder):
+        """Measure one parent and all of its children.
+        """
+        measParentRecord = measParentCat[parentIdx]
+        # first get all the children of this parent, insert footprint in
+        # turn, and measure
+        measChildCat = measCat.getChildren(measParentRecord.getId())
+        start = time.perf_counter() if self.timer is not None else None
+        traced = self.tracer is not None and self.tracer.isSampled(measParentRecord.getId())
+        traceStart = self.tracer.now() if traced else None
+        # TODO: skip this loop if there are no plugins configured for
+        # single-object mode
+        # A noise replacer that does not modify the exposure in place returns
+        # the (scratch) image to measure the inserted source on.
+        for measChildRecord in measChildCat:
+            measExposure = self._insertSource(noiseReplacer, measChildRecord.getId(), traced)
+            if measExposure is None:
+                measExposure = exposure
+            self.callMeasure(measChildRecord, measExposure, beginOrder=beginOrder, endOrder=endOrder)
+            self._runBlendednessChild(measExposure, measChildRecord)
+
+            self._removeSource(noiseReplacer, measChildRecord.getId(), traced)
 
-                if self.doBlendedness:
-                    self.blendPlugin.cpp.measureChildPixels(exposure.getMaskedImage(), measChildRecord)
+        # Then insert the parent footprint, and measure that
+        measExposure = self._insertSource(noiseReplacer, measParentRecord.getId(), traced)
+        if measExposure is None:
+            measExposure = exposure
+        self.callMeasure(measParentRecord, measExposure, beginOrder=beginOrder, endOrder=endOrder)
+        self._runBlendednessChild(measExposure, measParentRecord)
 
-                noiseReplacer.removeSource(measChildRecord.getId())
+        # Finally, process both parent and child set through measureN
+        self.callMeasureN(measParentCat[parentIdx:parentIdx+1], measExposure,
+                          beginOrder=beginOrder, endOrder=endOrder)
+        self.callMeasureN(measChildCat, measExposure, beginOrder=beginOrder, endOrder=endOrder)
+        self._removeSource(noiseReplacer, measParentRecord.getId(), traced)
+        if start is not None:
+            self.timer.recordFamily(measParentRecord.getId(),
+                                    self.estimateFamilyCost(measParentRecord, len(measChildCat)),
+                                    time.perf_counter() - start)
+        if traced:
+            self._traceEnd("family", "family", traceStart, measParentRecord)
 
-            # Then insert the parent footprint, and measure that
-            noiseReplacer.insertSource(measParentRecord.getId())
-            self.callMeasure(measParentRecord, exposure, beginOrder=beginOrder, endOrder=endOrder)
+    def estimateFamilyCost(self, measParentRecord, nChildren):
+        """Estimate the relative cost of measuring a parent family.
 
-            if self.doBlendedness:
-                self.blendPlugin.cpp.measureChildPixels(exposure.getMaskedImage(), measParentRecord)
+        Parameters
+        ----------
+        measParentRecord : `lsst.afw.table.SourceRecord`
+            Parent source, with its footprint attached.
+        nChildren : `int`
+            Number of children of the parent.
+
+        Returns
+        -------
+        cost : `int`
+            Parent footprint area times the number of sources in the family
+            times the number of plugins; only the ratios between families are
+            meaningful.  When plugins are timed, the cost of each family is
+            recorded together with its wall time (see
+            `PluginTimer.recordFamily`) so the model can be checked.
+        """
+        return measParentRecord.getFootprint().getArea()*(1 + nChildren)*max(len(self.plugins), 1)
+
+    def _startBlendedness(self):
+        """Prepare to capture the child pixels for blendedness, if configured
+        to do so.
+        """
+        self._blendednessPixels = {} if self.doBlendedness and self.config.doFuseBlendedness else None
+
+    def _runBlendednessChild(self, measExposure, measRecord):
+        """Measure (or capture) the blendedness child pixels of a source
+        inserted into a noise-replaced image.
+        """
+        if not self.doBlendedness:
+            return
+        if self._blendednessPixels is not None:
+            self._blendednessPixels[measRecord.getId()] = \
+                self.blendPlugin.cpp.captureChildPixels(measExposure.getMaskedImage(), measRecord)
+        else:
+            self.blendPlugin.cpp.measureChildPixels(measExposure.getMaskedImage(), measRecord)
 
-            # Finally, process both parent and child set through measureN
+    def _runBlendednessParents(self, measCat, exposure, start, stop, childPixels):
+        """Compute the blendedness metrics of ``measCat[start:stop]`` from
+        the parent pixels.
+        """
+        if childPixels is not None:
+            self.blendPlugin.cpp.measureCapturedPixels(exposure.getMaskedImage(), measCat[start:stop],
+                                                       childPixels[start:stop])
+        else:
+            for i in range(start, stop):
+                self.blendPlugin.cpp.measureParentPixels(exposure.getMaskedImage(), measCat[i])
+
+    def runPluginsParallel(self, measCat, exposure, footprints, noiseImage=None, exposureId=None,
+                           beginOrder=None, endOrder=None):
+        r"""Call the configured measurement plugins on an image, using several threads.
+
+        Parameters
+        ----------
+        measCat : `lsst.afw.table.SourceCatalog`
+            Catalog to be filled with the results of measurement.
+        exposure : `lsst.afw.image.ExposureF`
+            Image containing the pixel data to be measured together with
+            associated PSF, WCS, etc. It is not modified.
+        footprints : `dict`
+            Mapping of source ID to (parent ID, `~lsst.afw.detection.Footprint`)
+            for all sources in ``measCat``.
+        noiseImage : `lsst.afw.image.ImageF`, optional
+            Predictable noise replacement field, for testing.
+        exposureId : `int`, optional
+            Unique exposure identifier used to seed noise replacement.
+        beginOrder : `float`, optional
+            Start execution order (inclusive).
+        endOrder : `float`, optional
+            Final execution order (exclusive).
+
+        Notes
+        -----
+        Parent families are grouped into square tiles of
+        ``config.parallelTileSize`` pixels by the center of the parent
+        footprint bbox, except that families estimated to cost more than an
+        average tile (see `estimateFamilyCost`) are measured on their own.
+        Tiles are queued most expensive first, and each worker takes the next
+        one as soon as it is idle, so a few very large families do not leave
+        the other workers waiting at the end.  Each tile is measured by one of
+        ``config.numThreads`` workers on a private copy of the pixels covering
+        its families (grown by ``config.parallelBorder``), in which all
+        overlapping footprints are replaced with noise by a `NoiseReplacer`
+        of its own.  Each record is
+        measured by exactly one worker, so results are written to disjoint
+        catalog rows.  C++ plugins release the GIL while measuring, so they
+        run concurrently.  PSF models are not safe to evaluate from several
+        threads at once, so each worker measures with its own clone of the
+        exposure's PSF (see `PsfClonePool`).
+
+        The replacement noise is drawn per tile, so results are not
+        bit-for-bit identical to those from the serial loop.
+        """
+        measParentCat = measCat.getChildren(0)
+        self.log.info("Measuring %d source%s (%d parent%s) with %d threads",
+                      len(measCat), ("" if len(measCat) == 1 else "s"),
+                      len(measParentCat), ("" if len(measParentCat) == 1 else "s"),
+                      self.config.numThreads)
+
+        tiles = self._scheduleTiles(measCat, measParentCat, exposure.getBBox())
+        self._traceFamilies(measCat)
+
+        # The temporary mask planes used by NoiseReplacer are shared by all
+        # masks; add them up front so no worker removes them while another
+        # is still using them.
+        detectionMasks = self.needsDetectionMasks(beginOrder, endOrder)
+        mask = exposure.getMaskedImage().getMask()
+        addedPlanes = []
+        for maskName in (("THISDET", "OTHERDET") if detectionMasks else ()):
+            if maskName not in mask.getMaskPlaneDict():
+                mask.addMaskPlane(maskName)
+                addedPlanes.append(maskName)
+
+        def measureTile(tile):
+            with psfClones.borrow() as psf:
+                measureTileWithPsf(tile, psf)
+
+        def measureTileWithPsf(tile, psf):
+            bbox = tile.bbox
+            tileExposure = exposure.Factory(exposure, bbox, lsst.afw.image.PARENT, True)
+            if psf is not None:
+                tileExposure.setPsf(psf)
+            tileNoiseImage = None
+            if noiseImage is not None:
+                tileNoiseImage = noiseImage.Factory(noiseImage, bbox, lsst.afw.image.PARENT)
+            ownIds = self._getFamilyIds(measCat, measParentCat, tile.parentIndices)
+            tileFootprints = self.makeTileFootprints(footprints, ownIds, bbox)
+            noiseReplacer = NoiseReplacer(self.config.noiseReplacer, tileExposure, tileFootprints,
+                                          noiseImage=tileNoiseImage, exposureId=exposureId,
+                                          detectionMasks=detectionMasks)
+            for parentIdx in self.getSourceOrder(measParentCat, tile.parentIndices):
+                self._runFamily(noiseReplacer, measCat, measParentCat, parentIdx, tileExposure,
+                                beginOrder, endOrder)
+            noiseReplacer.end()
+
+        self._startBlendedness()
+        try:
+            with self.cachedPsf(exposure):
+                psfClones = PsfClonePool(exposure.getPsf(), self.config.numThreads)
+                with concurrent.futures.ThreadPoolExecutor(max_workers=self.config.numThreads) as pool:
+                    # Consume the results to propagate any exception raised by a worker.
+                    list(pool.map(measureTile, tiles))
+        finally:
+            for maskName in addedPlanes:
+                mask.removeAndClearMaskPlane(maskName, True)
+
+        self._runUnmodifiedPasses(measCat, exposure, endOrder)
+
+    def _scheduleTiles(self, measCat, measParentCat, bbox):
+        """Group parent families into the units of work of
+        `runPluginsParallel`, most expensive first.
+        """
+        tileSize = self.config.parallelTileSize
+        halo = self.config.parallelBorder
+        costs = [self.estimateFamilyCost(measParentRecord,
+                                         len(measCat.getChildren(measParentRecord.getId())))
+                 for measParentRecord in measParentCat]
+        tiles = []
+        gridTiles = self.makeTiles(measParentCat, bbox, tileSize=tileSize, halo=halo)
+        meanCost = sum(costs)/max(len(gridTiles), 1)
+        for tile in gridTiles:
+            large = [parentIdx for parentIdx in tile.parentIndices if costs[parentIdx] > meanCost]
+            if not large or len(tile.parentIndices) == 1:
+                tiles.append(tile)
+                continue
+            for parentIdx in large:
+                tiles.extend(self.makeTiles(measParentCat, bbox, tileSize=tileSize, halo=halo,
+                                            parentIndices=[parentIdx]))
+            rest = [parentIdx for parentIdx in tile.parentIndices if costs[parentIdx] <= meanCost]
+            tiles.extend(self.makeTiles(measParentCat, bbox, tileSize=tileSize, halo=halo,
+                                        parentIndices=rest))
+        for tile in tiles:
+            tile.cost = sum(costs[parentIdx] for parentIdx in tile.parentIndices)
+        tiles.sort(key=lambda tile: tile.cost, reverse=True)
+        return tiles
+
+    @pipeBase.timeMethod
+    def runTiled(self, measCat, bbox, getExposure, tiles=None, noiseImage=None, exposureId=None,
+                 beginOrder=None, endOrder=None):
+        r"""Run single frame measurement tile by tile, reading only the pixels
+        each tile needs.
+
+        Parameters
+        ----------
+        measCat : `lsst.afw.table.SourceCatalog`
+            Catalog to be filled with the results of measurement, as for
+            `run`.
+        bbox : `lsst.geom.Box2I`
+            Bounding box of the full image.
+        getExposure : callable
+            Called with the `lsst.geom.Box2I` of each tile in turn; must
+            return an `lsst.afw.image.ExposureF` covering exactly those pixels
+            (e.g. a sub-region read from the butler).  It is modified while
+            measuring, and dropped once the tile is done.
+        tiles : `list` of `lsst.pipe.base.Struct`, optional
+            Tiles to measure, as returned by `makeTiles` for
+            ``measCat.getChildren(0)``; all tiles if `None`.  Tiles are
+            independent, so a subset may be passed to each of several
+            processes.
+        noiseImage : `lsst.afw.image.ImageF`, optional
+            Predictable noise replacement field covering ``bbox``, for
+            testing.
+        exposureId : `int`, optional
+            Unique exposure identifier used to seed noise replacement.
+        beginOrder : `float`, optional
+            Start execution order (inclusive).
+        endOrder : `float`, optional
+            Final execution order (exclusive).
+
+        Notes
+        -----
+        Parent families are grouped into square tiles of
+        ``config.parallelTileSize`` pixels (see `makeTiles`), and each tile is
+        measured on the pixels covering its families grown by
+        ``config.parallelBorder``, with all
+        overlapping footprints replaced with noise by a noise replacer of its
+        own.  Only one tile's pixels and noise copies are held at a time, so
+        peak memory scales with the tile size rather than with the image.
+
+        The replacement noise is drawn per tile, and blendedness parent
+        moments are measured on the tile's pixels, so results are not
+        bit-for-bit identical to those from `run`.
+        """
+        assert measCat.getSchema().contains(self.schema)
+        measParentCat = measCat.getChildren(0)
+        if tiles is None:
+            tiles = self.makeTiles(measParentCat, bbox)
+        footprints = {measRecord.getId(): (measRecord.getParent(), measRecord.getFootprint())
+                      for measRecord in measCat}
+        children = self._makeChildIndex(measCat, measParentCat)
+        if self.config.doReplaceWithNoise:
+            self._recordNoiseMetadata(measCat, exposureId)
+        detectionMasks = self.needsDetectionMasks(beginOrder, endOrder)
+        nParents = sum(len(tile.parentIndices) for tile in tiles)
+        self.log.info("Measuring %d parent%s in %d tile%s", nParents, "" if nParents == 1 else "s",
+                      len(tiles), "" if len(tiles) == 1 else "s")
+        with self.pluginTiming(), self.pluginTracing():
+            for tile in tiles:
+                tileCat = self._makeFamilyCatalog(measCat, measParentCat, tile.parentIndices, children)
+                ownIds = {measRecord.getId() for measRecord in tileCat}
+                tileExposure = getExposure(tile.bbox)
+                if self.config.doReplaceWithNoise:
+                    tileNoiseImage = None
+                    if noiseImage is not None:
+                        tileNoiseImage = noiseImage.Factory(noiseImage, tile.bbox, lsst.afw.image.PARENT)
+                    NoiseReplacerClass = (ScratchNoiseReplacer if self.config.noiseReplacer.useScratchImages
+                                          else NoiseReplacer)
+                    noiseReplacer = NoiseReplacerClass(self.config.noiseReplacer, tileExposure,
+                                                       self.makeTileFootprints(footprints, ownIds, tile.bbox),
+                                                       noiseImage=tileNoiseImage, log=self.log,
+                                                       exposureId=exposureId, detectionMasks=detectionMasks)
+                else:
+                    noiseReplacer = DummyNoiseReplacer()
+                self.runPlugins(noiseReplacer, tileCat, tileExposure, beginOrder, endOrder)
+
+    @pipeBase.timeMethod
+    def remeasure(self, measCat, exposure, pluginNames, previousCat=None, noiseImage=None, exposureId=None):
+        r"""Recompute the columns of only some plugins on a catalog that has
+        already been measured.
+
+        Parameters
+        ----------
+        measCat : `lsst.afw.table.SourceCatalog`
+            Catalog measured by this task (or one with the same
+            configuration), with `lsst.afw.detection.Footprint`\ s attached.
+            The columns of the plugins in ``pluginNames`` are overwritten;
+            all others are left as they are and read as inputs.
+        exposure : `lsst.afw.image.ExposureF`
+            Image on which ``measCat`` was measured.
+        pluginNames : iterable of `str`
+            Names of the plugins (in ``config.plugins`` or
+            ``config.undeblended``) to run again.
+        previousCat : `lsst.afw.table.SourceCatalog`, optional
+            An earlier version of ``measCat``.  If given, only the families
+            in which the centroid or shape slot of some source differs from
+            ``previousCat`` (or which are not in it) are measured again.
+        noiseImage : `lsst.afw.image.ImageF`, optional
+            Predictable noise replacement field, for testing.
+        exposureId : `int`, optional
+            Unique exposure identifier used to seed noise replacement;
+            defaults to the one recorded in the metadata of ``measCat`` by
+            the original run, if any.
+
+        Returns
+        -------
+        nFamilies : `int`
+            Number of parent families measured.
+
+        Notes
+        -----
+        The floating-point fields and flags of the plugins are reset (to NaN
+        and False) on the sources of the families measured before the plugins
+        run, so none of the earlier results of those sources survive.
+
+        Only the footprints of the families measured and of the parents that
+        overlap them (within ``config.parallelBorder``) are given to the noise
+        replacer, so only those heavy footprints and noise pixels are made.
+        The heavy footprints of deblended children attached to ``measCat``
+        are used as they are.  With ``config.noiseReplacer.noiseRng`` set to
+        ``"counter"`` the noise replacing each neighbor does not depend on
+        which other footprints are replaced, so the results are identical to
+        those of `run`; with the default sequential generator they are not.
+        """
+        pluginNames = set(pluginNames)
+        unknown = pluginNames - set(self.plugins) - set(self.undeblendedPlugins)
+        if unknown:
+            raise ValueError("Plugins %s are not configured in this task." % ", ".join(sorted(unknown)))
+        assert measCat.getSchema().contains(self.schema)
+        measParentCat = measCat.getChildren(0)
+        if previousCat is None:
+            parentIndices = list(range(len(measParentCat)))
+        else:
+            parentIndices = self._getChangedFamilies(measCat, measParentCat, previousCat)
+        subCat = self._makeFamilyCatalog(measCat, measParentCat, parentIndices,
+                                         self._makeChildIndex(measCat, measParentCat, parentIndices))
+        ownIds = {measRecord.getId() for measRecord in subCat}
+        self.log.info("Re-measuring %d of %d parent%s with %s", len(parentIndices), len(measParentCat),
+                      "" if len(measParentCat) == 1 else "s", ", ".join(sorted(pluginNames)))
+        if not parentIndices:
+            return 0
+
+        footprints = {measRecord.getId(): (measRecord.getParent(), measRecord.getFootprint())
+                      for measRecord in subCat}
+        bboxes = [tile.bbox for tile in self.makeTiles(measParentCat, exposure.getBBox(),
+                                                       parentIndices=parentIndices)]
+        for measParentRecord in measParentCat:
+            footprint = measParentRecord.getFootprint()
+            if (measParentRecord.getId() not in ownIds and
+                    any(footprint.getBBox().overlaps(bbox) for bbox in bboxes)):
+                footprints[measParentRecord.getId()] = (0, footprint)
+        if exposureId is None:
+            catMetadata = measCat.getMetadata()
+            if catMetadata is not None and catMetadata.exists(self.NOISE_EXPOSURE_ID):
+                exposureId = catMetadata.getScalar(self.NOISE_EXPOSURE_ID)
+
+        self._resetPluginFields(subCat, pluginNames)
+        with self._selectPlugins(pluginNames):
+            if self.config.doReplaceWithNoise:
+                if self.config.numThreads > 1:
+                    noiseReplacer = None
+                else:
+                    NoiseReplacerClass = (ScratchNoiseReplacer if self.config.noiseReplacer.useScratchImages
+                                          else NoiseReplacer)
+                    noiseReplacer = NoiseReplacerClass(self.config.noiseReplacer, exposure, footprints,
+                                                       noiseImage=noiseImage, log=self.log,
+                                                       exposureId=exposureId,
+                                                       detectionMasks=self.needsDetectionMasks())
+            else:
+                noiseReplacer = DummyNoiseReplacer()
+            with self.pluginTiming(), self.pluginTracing():
+                if noiseReplacer is None:
+                    self.runPluginsParallel(subCat, exposure, footprints, noiseImage=noiseImage,
+                                            exposureId=exposureId)
+                else:
+                    self.runPlugins(noiseReplacer, subCat, exposure)
+        return len(parentIndices)
+
+    @contextlib.contextmanager
+    def _selectPlugins(self, pluginNames):
+        """Run only the named plugins for the duration of a block.
+        """
+        plugins, undeblendedPlugins, doBlendedness = self.plugins, self.undeblendedPlugins, self.doBlendedness
+        self.plugins = PluginMap((name, plugin) for name, plugin in plugins.items() if name in pluginNames)
+        self.undeblendedPlugins = PluginMap((name, plugin) for name, plugin in undeblendedPlugins.items()
+                                            if name in pluginNames)
+        self.doBlendedness = doBlendedness and self.blendPlugin.name in self.plugins
+        try:
+            yield
+        finally:
+            self.plugins, self.undeblendedPlugins, self.doBlendedness = \
+                plugins, undeblendedPlugins, doBlendedness
+
+    def _resetPluginFields(self, catalog, pluginNames):
+        """Reset the fields of the named plugins on every record of a catalog.
+
+        Floating-point fields are set to NaN, integer fields to zero and flags
+        to False, so that no result of an earlier measurement (such as a
+        failure flag, which plugins only ever set) survives a plugin that does
+        not set it again.
+        A plugin's fields are those whose names start with its name, except
+        those that also start with the longer name of another plugin.
+        """
+        owned = {plugin.name + "_": name in pluginNames
+                 for plugins in (self.plugins, self.undeblendedPlugins)
+                 for name, plugin in plugins.items()}
+        resets = []
+        for item in catalog.getSchema():
+            fieldName = item.field.getName()
+            prefixes = [prefix for prefix in owned if fieldName.startswith(prefix)]
+            if not prefixes or not owned[max(prefixes, key=len)]:
+                continue
+            if item.field.getTypeString() == "Flag":
+                resets.append((item.key, False))
+            elif item.field.getTypeString() in ("F", "D"):
+                resets.append((item.key, math.nan))
+            elif item.field.getTypeString() in ("B", "U", "I", "L"):
+                resets.append((item.key, 0))
+        for measRecord in catalog:
+            for key, value in resets:
+                measRecord.set(key, value)
+
+    @staticmethod
+    def _getChangedFamilies(measCat, measParentCat, previousCat):
+        """Return the indices into ``measParentCat`` of the families in which
+        the centroid or shape slot of some source differs from
+        ``previousCat``.
+        """
+        def getInputs(record):
+            inputs = []
+            if record.getTable().getCentroidSlot().isValid():
+                centroid = record.getCentroid()
+                inputs += [centroid.getX(), centroid.getY(), record.getCentroidFlag()]
+            if record.getTable().getShapeSlot().isValid():
+                shape = record.getShape()
+                inputs += [shape.getIxx(), shape.getIyy(), shape.getIxy(), record.getShapeFlag()]
+            # NaN values compare equal to each other.
+            return [None if value != value else value for value in inputs]
+
+        parents = {record.getId(): record.getParent() for record in measCat}
+
+        def getTopId(id):
+            # Deblended children may themselves have children, so walk up to
+            # the top-level parent (without looping forever on a cycle).
+            for _ in range(len(parents)):
+                if not parents.get(id):
+                    break
+                id = parents[id]
+            return id
+
+        previous = {record.getId(): record for record in previousCat}
+        changed = set()
+        for measRecord in measCat:
+            previousRecord = previous.get(measRecord.getId())
+            if previousRecord is None or getInputs(measRecord) != getInputs(previousRecord):
+                changed.add(getTopId(measRecord.getId()))
+        return [parentIdx for parentIdx, measParentRecord in enumerate(measParentCat)
+                if measParentRecord.getId() in changed]
+
+    @staticmethod
+    def _getFamilyIds(measCat, measParentCat, parentIndices):
+        """Return the IDs of the given parents and all of their children.
+        """
+        ids = set()
+        for parentIdx in parentIndices:
+            parentId = measParentCat[parentIdx].getId()
+            ids.add(parentId)
+            ids.update(child.getId() for child in measCat.getChildren(parentId))
+        return ids
+
+    @staticmethod
+    def _makeChildIndex(measCat, measParentCat, parentIndices=None):
+        """Return a `dict` of the children of each parent, by parent ID.
+
+        ``measCat`` must be sorted by parent, so each lookup is a binary
+        search rather than a scan of the catalog.  Only the parents at
+        ``parentIndices`` in ``measParentCat`` are included, if given.
+        """
+        if parentIndices is None:
+            parentIndices = range(len(measParentCat))
+        children = {}
+        for parentIdx in parentIndices:
+            parentId = measParentCat[parentIdx].getId()
+            children[parentId] = measCat.getChildren(parentId)
+        return children
+
+    @staticmethod
+    def _makeFamilyCatalog(measCat, measParentCat, parentIndices, children):
+        """Return a catalog of the given parents and all of their children,
+        sorted by parent like ``measCat``.
+
+        ``children`` is an index of the children of (at least) those parents,
+        as returned by `_makeChildIndex`.
+        """
+        familyCat = lsst.afw.table.SourceCatalog(measCat.getTable())
+        parentIndices = sorted(parentIndices)
+        familyCat.extend(measParentCat[parentIdx] for parentIdx in parentIndices)
+        for parentId in sorted(measParentCat[parentIdx].getId() for parentIdx in parentIndices):
+            familyCat.extend(children[parentId])
+        return familyCat
+
+    def _runPluginsBatch(self, measCat, measParentCat, exposure, beginOrder, endOrder):
+        """Run the plugins one at a time over all sources, without noise replacement.
+
+        Plugins that define ``measureBatch`` measure every source in a single
+        call; the rest are called once per source as usual.  Because plugins
+        run in execution order, every source has been measured by a plugin's
+        dependencies before that plugin runs, just as in the per-source loop.
+        """
+        indices = self.getSourceOrder(measCat)
+        for plugin in self.plugins.iter():
+            if beginOrder is not None and plugin.getExecutionOrder() < beginOrder:
+                continue
+            if endOrder is not None and plugin.getExecutionOrder() >= endOrder:
+                break
+            if hasattr(plugin, "measureBatch"):
+                if self.timer is not None:
+                    start = time.perf_counter()
+                plugin.measureBatch(measCat, exposure, indices)
+                if self.timer is not None:
+                    # Failures are handled inside measureBatch, so they are not counted.
+                    self.timer.record(plugin.name, time.perf_counter() - start, nSources=len(indices))
+            else:
+                for index in indices:
+                    self.doMeasurement(plugin, measCat[index], exposure)
+        for parentIdx in self.getSourceOrder(measParentCat):
+            measParentRecord = measParentCat[parentIdx]
+            measChildCat = measCat.getChildren(measParentRecord.getId())
             self.callMeasureN(measParentCat[parentIdx:parentIdx+1], exposure,
                               beginOrder=beginOrder, endOrder=endOrder)
             self.callMeasureN(measChildCat, exposure, beginOrder=beginOrder, endOrder=endOrder)
-            noiseReplacer.removeSource(measParentRecord.getId())
 
-        # When done, restore the exposure to its original state
-        noiseReplacer.end()
+    def _runUndeblendedPlugins(self, measCat, exposure, start, stop, plugins):
+        """Run the undeblended ``plugins`` on ``measCat[start:stop]``.
 
-        # Undeblended plugins only fire if we're running everything
-        if endOrder is None:
-            for source in measCat:
-                for plugin in self.undeblendedPlugins.iter():
-                    self.doMeasurement(plugin, source, exposure)
-        # Now we loop over all of the sources one more time to compute the
-        # blendedness metrics
+        Plugins run one at a time over all the sources, using
+        ``measureBatch`` where available, as in `_runPluginsBatch`.
+        """
+        indices = list(range(start, stop))
+        for plugin in plugins:
+            if self.config.doMeasureBatch and hasattr(plugin, "measureBatch"):
+                if self.timer is not None:
+                    begin = time.perf_counter()
+                plugin.measureBatch(measCat, exposure, indices)
+                if self.timer is not None:
+                    self.timer.record(plugin.name, time.perf_counter() - begin, nSources=len(indices))
+            else:
+                for i in indices:
+                    self.doMeasurement(plugin, measCat[i], exposure)
+
+    def _runUnmodifiedPasses(self, measCat, exposure, endOrder):
+        """Run the passes that measure the restored, unmodified image: the
+        undeblended plugins (which only fire if we're running everything)
+        and the blendedness parent metrics.
+
+        Notes
+        -----
+        Every source is independent in these passes, so with
+        ``config.numThreads > 1`` the catalog is split into contiguous chunks
+        measured concurrently.  Only plugins that can measure concurrently
+        (see `BasePlugin.canMeasureConcurrently`) are threaded; the others
+        run over the whole catalog in the calling thread.  Each chunk is
+        measured on a shallow copy of the exposure carrying its own clone of
+        the PSF.  The plugins run in execution order in stages of
+        consecutive threaded or unthreaded plugins, and a stage starts only
+        when the previous one is complete, so a record is only ever written
+        by one thread at a time (flags of different plugins may share
+        storage).
+        """
+        doUndeblended = endOrder is None and len(self.undeblendedPlugins) > 0
+        childPixels = None
+        if self.doBlendedness:
+            if self._blendednessPixels is not None:
+                childPixels = [self._blendednessPixels.get(source.getId()) for source in measCat]
+                self._blendednessPixels = None
+        elif not doUndeblended:
+            return
+
+        nThreads = self.config.numThreads
+        threaded = nThreads > 1 and len(measCat) > 1
+        # Each stage is (parallel, plugins); plugins is None for the
+        # blendedness parent metrics, which are computed in C++.
+        stages = []
+        for plugin in (self.undeblendedPlugins.iter() if doUndeblended else ()):
+            parallel = threaded and plugin.canMeasureConcurrently()
+            if stages and stages[-1][0] == parallel:
+                stages[-1][1].append(plugin)
+            else:
+                stages.append((parallel, [plugin]))
         if self.doBlendedness:
-            for source in measCat:
-                self.blendPlugin.cpp.measureParentPixels(exposure.getMaskedImage(), source)
+            stages.append((threaded, None))
+
+        def measureChunk(start, stop, chunkExposure, plugins):
+            if plugins is None:
+                self._runBlendednessParents(measCat, chunkExposure, start, stop, childPixels)
+            else:
+                self._runUndeblendedPlugins(measCat, chunkExposure, start, stop, plugins)
+
+        if not any(parallel for parallel, _ in stages):
+            for _, plugins in stages:
+                measureChunk(0, len(measCat), exposure, plugins)
+            return
+
+        psfClones = PsfClonePool(exposure.getPsf(), nThreads)
+
+        def measureChunkWithPsf(start, stop, plugins):
+            with psfClones.borrow() as psf:
+                chunkExposure = exposure
+                if psf is not None:
+                    chunkExposure = exposure.Factory(exposure, False)
+                    chunkExposure.setPsf(psf)
+                measureChunk(start, stop, chunkExposure, plugins)
+
+        # Use several chunks per thread so a few expensive sources do not
+        # leave the other threads idle.
+        chunkSize = max(1, -(-len(measCat)//(4*nThreads)))
+        starts = range(0, len(measCat), chunkSize)
+        with concurrent.futures.ThreadPoolExecutor(max_workers=nThreads) as pool:
+            for parallel, plugins in stages:
+                if not parallel:
+                    measureChunk(0, len(measCat), exposure, plugins)
+                    continue
+                # Consume the results to propagate any exception raised by a worker.
+                list(pool.map(lambda start: measureChunkWithPsf(start, min(start + chunkSize, len(measCat)),
+                                                                plugins),
+                              starts))
 
     def measure(self, measCat, exposure):
         """Backwards-compatibility alias for `run`.
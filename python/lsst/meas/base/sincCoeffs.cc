@@ -21,6 +21,7 @@
  */
 
 #include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
 
 #include "lsst/meas/base/SincCoeffs.h"
 
@@ -37,8 +38,38 @@ template <typename T>
 void declareSincCoeffs(py::module& mod, std::string const& suffix) {
     py::class_<SincCoeffs<T>> cls(mod, ("SincCoeffs" + suffix).c_str());
 
+    py::class_<typename SincCoeffs<T>::CacheStatistics> clsStats(cls, "CacheStatistics");
+    clsStats.def_readonly("hits", &SincCoeffs<T>::CacheStatistics::hits);
+    clsStats.def_readonly("misses", &SincCoeffs<T>::CacheStatistics::misses);
+    clsStats.def_readonly("loads", &SincCoeffs<T>::CacheStatistics::loads);
+    clsStats.def_readonly("evictions", &SincCoeffs<T>::CacheStatistics::evictions);
+    clsStats.def_readonly("entries", &SincCoeffs<T>::CacheStatistics::entries);
+    clsStats.def_readonly("bytes", &SincCoeffs<T>::CacheStatistics::bytes);
+    clsStats.def_readonly("maxBytes", &SincCoeffs<T>::CacheStatistics::maxBytes);
+
     cls.def_static("cache", &SincCoeffs<T>::cache, "rInner"_a, "rOuter"_a);
+    cls.def_static("cacheAll", &SincCoeffs<T>::cacheAll, "radii"_a, "nThreads"_a = 1,
+                   py::call_guard<py::gil_scoped_release>());
+    cls.def_static("writeCache", &SincCoeffs<T>::writeCache, "filename"_a);
+    cls.def_static("readCache", &SincCoeffs<T>::readCache, "filename"_a);
+    cls.def_static("openStore", &SincCoeffs<T>::openStore, "filename"_a);
+    cls.def_static("closeStores", &SincCoeffs<T>::closeStores);
+    cls.def_static("planFftw", &SincCoeffs<T>::planFftw, "maxRadius"_a,
+                   py::call_guard<py::gil_scoped_release>());
+    cls.def_static("importFftwWisdom", &SincCoeffs<T>::importFftwWisdom, "filename"_a);
+    cls.def_static("exportFftwWisdom", &SincCoeffs<T>::exportFftwWisdom, "filename"_a);
     cls.def_static("get", &SincCoeffs<T>::get, "outerEllipse"_a, "innerRadiusFactor"_a);
+    cls.def_static("getQuantized", &SincCoeffs<T>::getQuantized, "outerEllipse"_a, "innerRadiusFactor"_a,
+                   "tolerance"_a);
+    cls.def_static("getShifted", &SincCoeffs<T>::getShifted, "outerEllipse"_a, "innerRadiusFactor"_a,
+                   "shiftX"_a, "shiftY"_a, "nShift"_a, "warpingKernelName"_a);
+    cls.def_static("calculate", &SincCoeffs<T>::calculate, "outerEllipse"_a, "innerFactor"_a = 0.0);
+    cls.def_static("quantize", &SincCoeffs<T>::quantize, "outerEllipse"_a, "tolerance"_a);
+    cls.def_static("setMaxCacheBytes", &SincCoeffs<T>::setMaxCacheBytes, "maxBytes"_a);
+    cls.def_static("getMaxCacheBytes", &SincCoeffs<T>::getMaxCacheBytes);
+    cls.def_static("getCacheStatistics", &SincCoeffs<T>::getCacheStatistics);
+    cls.def_static("resetCacheStatistics", &SincCoeffs<T>::resetCacheStatistics);
+    cls.def_static("clearCache", &SincCoeffs<T>::clearCache);
 }
 
 }  // namespace
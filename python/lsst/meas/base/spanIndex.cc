@@ -0,0 +1,54 @@
+/*
+ * LSST Data Management System
+ * Copyright 2008-2017  AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "pybind11/pybind11.h"
+
+#include <memory>
+
+#include "lsst/meas/base/SpanIndex.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+PYBIND11_MODULE(spanIndex, mod) {
+    py::module::import("lsst.geom");
+    py::module::import("lsst.afw.geom");
+
+    py::class_<SpanIndex, std::shared_ptr<SpanIndex>> cls(mod, "SpanIndex");
+    cls.attr("MIN_INDEXED_SPANS") = py::cast(SpanIndex::MIN_INDEXED_SPANS);
+    cls.def(py::init<afw::geom::SpanSet const &>(), "spans"_a);
+    cls.def("contains", &SpanIndex::contains, "point"_a);
+
+    mod.def("containsPoint",
+            [](std::shared_ptr<afw::geom::SpanSet> const &spans, geom::Point2I const &point) {
+                return containsPoint(spans, point);
+            },
+            "spans"_a, "point"_a);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -0,0 +1,62 @@
+/*
+ * LSST Data Management System
+ * Copyright 2008-2017  AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "pybind11/pybind11.h"
+
+#include "ndarray/pybind11.h"
+
+#include "lsst/meas/base/SpanKernels.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace base {
+namespace {
+
+template <typename T>
+void declareSpanKernels(py::module& mod) {
+    mod.def("dotSpans", &dotSpans<T, float>, "spans"_a, "packed"_a, "image"_a);
+    mod.def("dotSpans", &dotSpans<T, double>, "spans"_a, "packed"_a, "image"_a);
+    mod.def("dotResidualSpans", &dotResidualSpans<T, float>, "spans"_a, "packed"_a, "image"_a);
+    mod.def("dotResidualSpans", &dotResidualSpans<T, double>, "spans"_a, "packed"_a, "image"_a);
+    mod.def("sumSquares", &sumSquares<T>, "packed"_a);
+    mod.def("sumSpans", &sumSpans<T>, "spans"_a, "image"_a);
+    mod.def("insertSpans", &insertSpans<T>, "spans"_a, "packed"_a, "image"_a);
+    mod.def("extractSpans", &extractSpans<T>, "spans"_a, "image"_a, "packed"_a);
+}
+
+}  // namespace
+
+PYBIND11_MODULE(spanKernels, mod) {
+    py::module::import("lsst.afw.geom");
+    py::module::import("lsst.afw.image");
+
+    declareSpanKernels<float>(mod);
+    declareSpanKernels<double>(mod);
+    mod.def("orSpans", &orSpans, "spans"_a, "mask"_a);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -0,0 +1,50 @@
+/*
+ * LSST Data Management System
+ * Copyright 2008-2017  AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+
+#include "lsst/meas/base/SpatialOrder.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+PYBIND11_MODULE(spatialOrder, mod) {
+    py::module::import("lsst.geom");
+    py::module::import("lsst.afw.table");
+
+    mod.def("hilbertIndex", &hilbertIndex, "x"_a, "y"_a, "level"_a);
+    mod.def("hilbertOrder",
+            (std::vector<std::size_t>(*)(afw::table::SourceCatalog const &, int)) & hilbertOrder,
+            "catalog"_a, "level"_a = 16);
+    mod.def("hilbertOrder",
+            (std::vector<std::size_t>(*)(std::vector<geom::Point2D> const &, int)) & hilbertOrder,
+            "points"_a, "level"_a = 16);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
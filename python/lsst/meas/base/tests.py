@@ -31,6 +31,7 @@ import lsst.pex.exceptions
 from .sfm import SingleFrameMeasurementTask
 from .forcedMeasurement import ForcedMeasurementTask
 from . import CentroidResultKey
+from . import SceneRealizer, SceneSource
 
 __all__ = ("BlendContext", "TestDataset", "AlgorithmTestCase", "TransformTestCase",
            "SingleFramePluginTransformSetupHelper", "ForcedPluginTransformSetupHelper",
@@ -447,6 +448,75 @@ class TestDataset:
         self.exposure.getMaskedImage().getImage().getArray()[:, :] += image.getArray()
         return record, image
 
+    def addSources(self, instFluxes, centroids, shapes=None, nThreads=0):
+        """Add many isolated sources to the simulation at once.
+
+        This is a fast path for repeated calls to `addSource`, for large or
+        crowded fields such as those of benchmarks: the sources are rendered
+        in parallel, and their Footprints computed analytically, by
+        `SceneRealizer`, instead of evaluating each source over the whole
+        image and running detection on it.  The truth values are those
+        `addSource` would set, and the Footprints those detection would find
+        (up to pixels that lie on the threshold isophote); the source profiles
+        are neglected beyond eight standard deviations from their centers.
+
+        Parameters
+        ----------
+        instFluxes : sequence of `float`
+            Total instFlux of each source to be added.
+        centroids : sequence of `lsst.geom.Point2D`
+            Position of each source to be added.
+        shapes : sequence of `lsst.afw.geom.Quadrupole` or `None`, optional
+            Second moments of each source before PSF convolution.  Point
+            sources are added for `None` elements, or for all the sources if
+            ``shapes`` is `None`.
+        nThreads : `int`, optional
+            Number of threads used to render the sources; zero uses one per
+            hardware thread.
+
+        Returns
+        -------
+        records : `list` of `lsst.afw.table.SourceRecord`
+            The truth catalog records of the new sources.
+
+        Raises
+        ------
+        RuntimeError
+            Raised if a source does not reach the detection threshold
+            anywhere in the image; no sources are added in that case.
+        """
+        if shapes is None:
+            shapes = [None]*len(instFluxes)
+        if not len(instFluxes) == len(centroids) == len(shapes):
+            raise ValueError("instFluxes, centroids and shapes must have the same length")
+        sources = []
+        for instFlux, centroid, shape in zip(instFluxes, centroids, shapes):
+            fullShape = self.psfShape if shape is None else shape.convolve(self.psfShape)
+            sources.append(SceneSource(instFlux, centroid, fullShape))
+        realizer = SceneRealizer(self.threshold.getValue(), int(self.psfShape.getDeterminantRadius() + 1.0))
+        footprints = realizer.makeFootprints(sources, self.exposure.getBBox())
+        for n, footprint in enumerate(footprints):
+            if len(footprint.getPeaks()) == 0:
+                raise RuntimeError("Threshold value results in zero Footprints for source %d" % n)
+        realizer.render(sources, self.exposure.getMaskedImage().getImage(), nThreads=nThreads)
+        mask = self.exposure.getMaskedImage().getMask()
+        detected = mask.getPlaneBitMask("DETECTED")
+        # The same random draws as one addSource call per source.
+        covariances = np.random.normal(0, 0.1, 4*len(sources)).reshape(len(sources), 2, 2)
+        covariances[:, 0, 1] = covariances[:, 1, 0]
+        records = []
+        for source, shape, footprint, covariance in zip(sources, shapes, footprints, covariances):
+            record = self.catalog.addNew()
+            record.set(self.keys["instFlux"], source.instFlux)
+            record.set(self.keys["centroid"], source.center)
+            record.set(self.keys["centroid_sigma"], covariance.astype(np.float32))
+            record.set(self.keys["isStar"], shape is None)
+            record.set(self.keys["shape"], source.shape)
+            footprint.spans.setMask(mask, detected)
+            record.setFootprint(footprint)
+            records.append(record)
+        return records
+
     def addBlend(self):
         """Return a context manager which can add a blend of multiple sources.
 
@@ -840,6 +910,29 @@ class TransformTestCase:
         self._runTransform()
         self._checkOutput(baseNames)
 
+    def testTransformNonContiguous(self, baseNames=None):
+        """Test the transformation of a non-contiguous subset of a catalog.
+
+        Parameters
+        ----------
+        baseNames : iterable of `str`
+            Iterable of the initial parts of measurement field names (see
+            `testTransform`).
+
+        Notes
+        -----
+        Column views are not available for non-contiguous catalogs, so this
+        checks that a transformation which reads its inputs column-wise falls
+        back to reading them record by record.
+        """
+        baseNames = baseNames or [self.name]
+        self._populateCatalog(baseNames)
+        self._populateCatalog(baseNames)
+        self.inputCat = self.inputCat.subset(np.array([True, False, False, True]))
+        self.assertFalse(self.inputCat.isContiguous())
+        self._runTransform()
+        self._checkOutput(baseNames)
+
     def _checkRegisteredTransform(self, registry, name):
         # If this is a Python-based transform, we can compare directly; if
         # it's wrapped C++, we need to compare the wrapped class.
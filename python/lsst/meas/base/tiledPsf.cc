@@ -0,0 +1,55 @@
+/*
+ * LSST Data Management System
+ * Copyright 2008-2017  AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "pybind11/pybind11.h"
+
+#include "lsst/meas/base/TiledPsf.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+PYBIND11_MODULE(tiledPsf, mod) {
+    py::module::import("lsst.geom");
+    py::module::import("lsst.afw.detection");
+
+    py::class_<TiledPsf, std::shared_ptr<TiledPsf>, afw::detection::Psf> cls(mod, "TiledPsf");
+
+    cls.def(py::init<std::shared_ptr<afw::detection::Psf const>, geom::Box2I const &, int, bool>(), "psf"_a,
+            "bbox"_a, "cellSize"_a, "interpolate"_a = false);
+
+    cls.def("getWrapped", &TiledPsf::getWrapped);
+    cls.def("getGridBBox", &TiledPsf::getGridBBox);
+    cls.def("getCellSize", &TiledPsf::getCellSize);
+    cls.def("getInterpolate", &TiledPsf::getInterpolate);
+    cls.def("getNodeCountX", &TiledPsf::getNodeCountX);
+    cls.def("getNodeCountY", &TiledPsf::getNodeCountY);
+    cls.def("getNodePosition", &TiledPsf::getNodePosition, "ix"_a, "iy"_a);
+    cls.def("getEvaluationCount", &TiledPsf::getEvaluationCount);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -0,0 +1,65 @@
+/*
+ * LSST Data Management System
+ * Copyright 2008-2017  AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+
+#include "lsst/meas/base/TraceRecorder.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+PYBIND11_MODULE(traceRecorder, mod) {
+    py::module::import("lsst.afw.table");
+
+    py::class_<TraceRecorder, std::shared_ptr<TraceRecorder>> cls(mod, "TraceRecorder");
+
+    py::class_<TraceRecorder::Event> clsEvent(cls, "Event");
+    clsEvent.def_readonly("name", &TraceRecorder::Event::name);
+    clsEvent.def_readonly("category", &TraceRecorder::Event::category);
+    clsEvent.def_readonly("start", &TraceRecorder::Event::start);
+    clsEvent.def_readonly("duration", &TraceRecorder::Event::duration);
+    clsEvent.def_readonly("thread", &TraceRecorder::Event::thread);
+    clsEvent.def_readonly("id", &TraceRecorder::Event::id);
+
+    cls.def(py::init<double>(), "sampleFraction"_a = 1.0);
+    cls.def("getSampleFraction", &TraceRecorder::getSampleFraction);
+    cls.def("isSampled", &TraceRecorder::isSampled, "familyId"_a);
+    cls.def("setFamilies", &TraceRecorder::setFamilies, "catalog"_a);
+    cls.def("getFamilyId", &TraceRecorder::getFamilyId, "record"_a);
+    cls.def_static("getThreadIndex", &TraceRecorder::getThreadIndex);
+    cls.def("now", &TraceRecorder::now);
+    cls.def("record", &TraceRecorder::record, "name"_a, "category"_a, "start"_a, "end"_a, "id"_a = 0);
+    cls.def("getEvents", &TraceRecorder::getEvents);
+    cls.def("size", &TraceRecorder::size);
+    cls.def("__len__", &TraceRecorder::size);
+    cls.def("clear", &TraceRecorder::clear);
+    cls.def("writeChromeTrace", &TraceRecorder::writeChromeTrace, "filename"_a);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
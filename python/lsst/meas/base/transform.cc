@@ -21,9 +21,12 @@
  */
 
 #include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
 
 #include <memory>
 
+#include "ndarray/pybind11.h"
+
 #include "lsst/meas/base/Transform.h"
 
 namespace py = pybind11;
@@ -34,10 +37,18 @@ namespace meas {
 namespace base {
 
 PYBIND11_MODULE(transform, mod) {
+    py::module::import("lsst.afw.geom");
+
     py::class_<BaseTransform, std::shared_ptr<BaseTransform>> cls(mod, "BaseTransform");
 
     cls.def("__call__", &BaseTransform::operator(), "inputCatalog"_a, "outputCatalog"_a, "wcs"_a,
             "photoCalib"_a);
+
+    mod.def("computePixelToSkyJacobians",
+            [](afw::geom::SkyWcs const &wcs, std::vector<geom::Point2D> const &pixels) {
+                return computePixelToSkyJacobians(wcs, pixels);
+            },
+            "wcs"_a, "pixels"_a);
 }
 
 }  // namespace base
@@ -45,6 +45,7 @@ Transformations can be defined in Python or in C++. Python code should inherit
 from `MeasurementTransform`, following its interface.
 """
 
+import lsst.geom
 from lsst.afw.table import CoordKey
 from lsst.pex.exceptions import LengthError
 from . import CentroidResultKey
@@ -157,5 +158,12 @@ class SimpleCentroidTransform(MeasurementTransform):
     def __call__(self, inputCatalog, outputCatalog, wcs, photoCalib):
         self._checkCatalogSize(inputCatalog, outputCatalog)
         centroidResultKey = CentroidResultKey(inputCatalog.schema[self.name])
-        for inSrc, outSrc in zip(inputCatalog, outputCatalog):
-            self.coordKey.set(outSrc, wcs.pixelToSky(centroidResultKey.get(inSrc).getCentroid()))
+        # Transform all the centroids with a single call to the WCS; column
+        # access is only possible on a contiguous catalog.
+        if inputCatalog.isContiguous():
+            pixels = [lsst.geom.Point2D(x, y) for x, y in zip(inputCatalog[centroidResultKey.getX()],
+                                                              inputCatalog[centroidResultKey.getY()])]
+        else:
+            pixels = [centroidResultKey.get(inSrc).getCentroid() for inSrc in inputCatalog]
+        for coord, outSrc in zip(wcs.pixelToSky(pixels), outputCatalog):
+            self.coordKey.set(outSrc, coord)
@@ -20,6 +20,7 @@
 # along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 import lsst.pex.config
+from .algorithm import SimpleAlgorithm
 from .pluginsBase import BasePlugin
 from .pluginRegistry import generateAlgorithmName, register
 from .apCorrRegistry import addApCorrName
@@ -38,9 +39,14 @@ class WrappedSingleFramePlugin(SingleFramePlugin):
             self.cpp = self.factory(config, name, schema, metadata, logName=logName)
         else:
             self.cpp = self.factory(config, name, schema, metadata)
+        self._measure = self.cpp.measure
+        self._measureBatch = getattr(self.cpp, "measureBatch", None)
 
     def measure(self, measRecord, exposure):
-        self.cpp.measure(measRecord, exposure)
+        self._measure(measRecord, exposure)
+
+    def measureBatch(self, measCat, exposure, indices):
+        self._measureBatch(measCat, exposure, indices)
 
     def measureN(self, measCat, exposure):
         self.cpp.measureN(measCat, exposure)
@@ -48,6 +54,42 @@ class WrappedSingleFramePlugin(SingleFramePlugin):
     def fail(self, measRecord, error=None):
         self.cpp.fail(measRecord, error.cpp if error is not None else None)
 
+    def addToChain(self, chain):
+        # Subclasses that customize measurement or failure handling must be called from Python.
+        if (type(self).measure is not WrappedSingleFramePlugin.measure or
+                type(self).fail is not WrappedSingleFramePlugin.fail):
+            return False
+        chain.addSingleFrame(self.cpp, self.getExecutionOrder())
+        return True
+
+    def canMeasureConcurrently(self):
+        # Overridden methods may run Python code that is not safe to call concurrently.
+        return (type(self).measure is WrappedSingleFramePlugin.measure and
+                type(self).fail is WrappedSingleFramePlugin.fail)
+
+    def enableTiming(self, enable):
+        if not hasattr(self.cpp, "enableTiming"):
+            return
+        self.cpp.enableTiming(enable)
+        self._selectMeasure()
+
+    def enableTracing(self, recorder):
+        if not hasattr(self.cpp, "enableTracing"):
+            return
+        self.cpp.enableTracing(recorder, self.name)
+        self._selectMeasure()
+
+    def _selectMeasure(self):
+        # The timed variants also record trace events.
+        timed = self.cpp.isTimingEnabled() or self.cpp.isTracingEnabled()
+        self._measure = self.cpp.measureTimed if timed else self.cpp.measure
+        self._measureBatch = self.cpp.measureBatchTimed if timed else self.cpp.measureBatch
+
+    def getTiming(self):
+        if not hasattr(self.cpp, "isTimingEnabled") or not self.cpp.isTimingEnabled():
+            return None
+        return self.cpp.getTimingSeconds(), self.cpp.getTimingCalls()
+
 
 class WrappedForcedPlugin(ForcedPlugin):
 
@@ -57,9 +99,10 @@ class WrappedForcedPlugin(ForcedPlugin):
             self.cpp = self.factory(config, name, schemaMapper, metadata, logName=logName)
         else:
             self.cpp = self.factory(config, name, schemaMapper, metadata)
+        self._measureForced = self.cpp.measureForced
 
     def measure(self, measRecord, exposure, refRecord, refWcs):
-        self.cpp.measureForced(measRecord, exposure, refRecord, refWcs)
+        self._measureForced(measRecord, exposure, refRecord, refWcs)
 
     def measureN(self, measCat, exposure, refCat, refWcs):
         self.cpp.measureNForced(measCat, exposure, refCat, refWcs)
@@ -67,8 +110,45 @@ class WrappedForcedPlugin(ForcedPlugin):
     def fail(self, measRecord, error=None):
         self.cpp.fail(measRecord, error.cpp if error is not None else None)
 
-
-def wrapAlgorithmControl(Base, Control, module=None, hasMeasureN=False):
+    def addToChain(self, chain):
+        # Subclasses that customize measurement or failure handling must be called from Python, as
+        # must algorithms that are not wrapped as SimpleAlgorithms.
+        if (type(self).measure is not WrappedForcedPlugin.measure or
+                type(self).fail is not WrappedForcedPlugin.fail or
+                not isinstance(self.cpp, SimpleAlgorithm)):
+            return False
+        chain.addForced(self.cpp, self.getExecutionOrder())
+        return True
+
+    def canMeasureConcurrently(self):
+        # Overridden methods may run Python code that is not safe to call concurrently.
+        return (type(self).measure is WrappedForcedPlugin.measure and
+                type(self).fail is WrappedForcedPlugin.fail)
+
+    def enableTiming(self, enable):
+        if not hasattr(self.cpp, "measureForcedTimed"):
+            return
+        self.cpp.enableTiming(enable)
+        self._selectMeasure()
+
+    def enableTracing(self, recorder):
+        if not hasattr(self.cpp, "measureForcedTimed"):
+            return
+        self.cpp.enableTracing(recorder, self.name)
+        self._selectMeasure()
+
+    def _selectMeasure(self):
+        # The timed variant also records trace events.
+        timed = self.cpp.isTimingEnabled() or self.cpp.isTracingEnabled()
+        self._measureForced = self.cpp.measureForcedTimed if timed else self.cpp.measureForced
+
+    def getTiming(self):
+        if not hasattr(self.cpp, "isTimingEnabled") or not self.cpp.isTimingEnabled():
+            return None
+        return self.cpp.getTimingSeconds(), self.cpp.getTimingCalls()
+
+
+def wrapAlgorithmControl(Base, Control, module=None, hasMeasureN=False, doMeasureNDefault=True):
     """Wrap a C++ algorithm's control class into a Python config class.
 
     Parameters
@@ -88,6 +168,9 @@ def wrapAlgorithmControl(Base, Control, module=None, hasMeasureN=False):
     hasMeasureN : `bool`, optional
         Whether the plugin supports fitting multiple objects at once (if so, a
         config option to enable/disable this will be added).
+    doMeasureNDefault : `bool`, optional
+        Default value of the ``doMeasureN`` config option; ignored unless
+        ``hasMeasureN`` is `True`.
 
     Returns
     -------
@@ -108,7 +191,7 @@ def wrapAlgorithmControl(Base, Control, module=None, hasMeasureN=False):
         cls = type(
             Control.__name__.replace("Control", "Config"),
             (Base,),
-            {"doMeasureN": lsst.pex.config.Field(dtype=bool, default=True,
+            {"doMeasureN": lsst.pex.config.Field(dtype=bool, default=doMeasureNDefault,
                                                  doc="whether to run this plugin in multi-object mode")}
         )
         ConfigClass = lsst.pex.config.makeConfigClass(Control, module=module, cls=cls)
@@ -121,7 +204,7 @@ def wrapAlgorithmControl(Base, Control, module=None, hasMeasureN=False):
 
 def wrapAlgorithm(Base, AlgClass, factory, executionOrder, name=None, Control=None,
                   ConfigClass=None, TransformClass=None, doRegister=True, shouldApCorr=False,
-                  apCorrList=(), hasLogName=False, **kwds):
+                  apCorrList=(), hasLogName=False, preconditions=None, needsDetectionMasks=True, **kwds):
     """Wrap a C++ algorithm class to create a measurement plugin.
 
     Parameters
@@ -177,6 +260,15 @@ def wrapAlgorithm(Base, AlgClass, factory, executionOrder, name=None, Control=No
     hasLogName : `bool`, optional
         `True` if the C++ algorithm supports ``logName`` as a constructor
         argument.
+    preconditions : `lsst.meas.base.Preconditions`, optional
+        Conditions a source must satisfy for the algorithm to measure it,
+        returned by the plugin's ``getPreconditions`` method (see
+        `BasePlugin.getPreconditions`).
+    needsDetectionMasks : `bool`, optional
+        Whether the algorithm reads the ``THISDET`` and ``OTHERDET`` mask
+        planes, returned by the plugin's ``needsDetectionMasks`` method (see
+        `BasePlugin.needsDetectionMasks`).  Algorithms that do not should
+        pass `False`.
     **kwds
         Additional keyword arguments passed to generateAlgorithmControl, which
         may include:
@@ -184,6 +276,8 @@ def wrapAlgorithm(Base, AlgClass, factory, executionOrder, name=None, Control=No
         - ``hasMeasureN``:  Whether the plugin supports fitting multiple
           objects at once ;if so, a config option to enable/disable this will
           be added (`bool`).
+        - ``doMeasureNDefault``: The default value of that config option
+          (`bool`).
         - ``executionOrder``: If not `None`, an override for the default
           execution order for this plugin (the default is ``2.0``, which is
           usually appropriate for fluxes; `bool`).
@@ -204,6 +298,9 @@ def wrapAlgorithm(Base, AlgClass, factory, executionOrder, name=None, Control=No
                     getExecutionOrder=staticmethod(getExecutionOrder))
     if TransformClass:
         typeDict['getTransformClass'] = staticmethod(lambda: TransformClass)
+    if preconditions is not None:
+        typeDict['getPreconditions'] = lambda self: preconditions
+    typeDict['needsDetectionMasks'] = lambda self: needsDetectionMasks
     PluginClass = type(AlgClass.__name__ + Base.__name__, (Base,), typeDict)
     if doRegister:
         if name is None:
@@ -373,7 +470,7 @@ def wrapForcedAlgorithm(AlgClass, executionOrder, name=None, needsMetadata=False
                 return AlgClass(config.makeControl(), name, extractSchemaArg(schemaMapper), **kwargs)
 
     return wrapAlgorithm(WrappedForcedPlugin, AlgClass, executionOrder=executionOrder, name=name,
-                         factory=factory, hasLogName=hasLogName, **kwds)
+                         factory=factory, hasMeasureN=hasMeasureN, hasLogName=hasLogName, **kwds)
 
 
 def wrapSimpleAlgorithm(AlgClass, executionOrder, name=None, needsMetadata=False, hasMeasureN=False,
@@ -435,10 +532,11 @@ def wrapSimpleAlgorithm(AlgClass, executionOrder, name=None, needsMetadata=False
     three.
     """
     return (wrapSingleFrameAlgorithm(AlgClass, executionOrder=executionOrder, name=name,
-                                     needsMetadata=needsMetadata, hasLogName=hasLogName, **kwds),
+                                     needsMetadata=needsMetadata, hasMeasureN=hasMeasureN,
+                                     hasLogName=hasLogName, **kwds),
             wrapForcedAlgorithm(AlgClass, executionOrder=executionOrder, name=name,
-                                needsMetadata=needsMetadata, hasLogName=hasLogName,
-                                needsSchemaOnly=True, **kwds))
+                                needsMetadata=needsMetadata, hasMeasureN=hasMeasureN,
+                                hasLogName=hasLogName, needsSchemaOnly=True, **kwds))
 
 
 def wrapTransform(transformClass, hasLogName=False):
@@ -617,6 +715,9 @@ class GenericPlugin(BasePlugin):
             def getTransformClass(self):
                 return self._generic.getTransformClass()
 
+            def needsDetectionMasks(self):
+                return self._generic.needsDetectionMasks()
+
         return SingleFrameFromGenericPlugin
 
     @classmethod
@@ -659,4 +760,7 @@ class GenericPlugin(BasePlugin):
             def getTransformClass(self):
                 return self._generic.getTransformClass()
 
+            def needsDetectionMasks(self):
+                return self._generic.needsDetectionMasks()
+
         return ForcedFromGenericPlugin
@@ -21,6 +21,8 @@
  * see <http://www.lsstcorp.org/LegalNotices/>.
  */
 
+#include <new>
+
 #include "lsst/afw/table/Source.h"
 #include "lsst/meas/base/Algorithm.h"
 
@@ -28,11 +30,64 @@ namespace lsst {
 namespace meas {
 namespace base {
 
+MeasurementStatus SingleFrameAlgorithm::tryMeasure(afw::table::SourceRecord& measRecord,
+                                                   afw::image::Exposure<float> const& exposure) const {
+    measure(measRecord, exposure);
+    return MeasurementStatus();
+}
+
 void SingleFrameAlgorithm::measureN(afw::table::SourceCatalog const& measCat,
                                     afw::image::Exposure<float> const& exposure) const {
     throw LSST_EXCEPT(pex::exceptions::LogicError, "measureN not implemented for this algorithm");
 }
 
+void SingleFrameAlgorithm::measureBatch(afw::table::SourceCatalog& measCat,
+                                        afw::image::Exposure<float> const& exposure,
+                                        std::vector<std::size_t> const& indices) const {
+    measureEach(measCat, indices,
+                [this, &exposure](afw::table::SourceRecord& measRecord) {
+                    return tryMeasure(measRecord, exposure);
+                });
+}
+
+void SingleFrameAlgorithm::measureEach(
+        afw::table::SourceCatalog& measCat, std::vector<std::size_t> const& indices,
+        std::function<MeasurementStatus(afw::table::SourceRecord&)> const& measureOne) const {
+    for (std::size_t index : indices) {
+        afw::table::SourceRecord& measRecord = measCat.at(index);
+        try {
+            MeasurementStatus const status = measureOne(measRecord);
+            if (!status) {
+                LOGL_DEBUG(getLogName(), "MeasurementError in measure on record %lld: %s",
+                           measRecord.getId(), status.getMessage().c_str());
+                MeasurementError error = status.makeError();
+                fail(measRecord, &error);
+            }
+        } catch (FatalAlgorithmError&) {
+            throw;
+        } catch (std::bad_alloc&) {
+            throw;
+        } catch (MeasurementError& error) {
+            LOGL_DEBUG(getLogName(), "MeasurementError in measure on record %lld: %s", measRecord.getId(),
+                       error.what());
+            fail(measRecord, &error);
+        } catch (std::exception& error) {
+            // Not a routine failure, so it may be a bug; make sure it is seen.
+            LOGL_WARN(getLogName(), "Exception in measure on record %lld: %s", measRecord.getId(),
+                      error.what());
+            fail(measRecord);
+        }
+    }
+}
+
+MeasurementStatus ForcedAlgorithm::tryMeasureForced(afw::table::SourceRecord& measRecord,
+                                                    afw::image::Exposure<float> const& exposure,
+                                                    afw::table::SourceRecord const& refRecord,
+                                                    afw::geom::SkyWcs const& refWcs) const {
+    measureForced(measRecord, exposure, refRecord, refWcs);
+    return MeasurementStatus();
+}
+
 void ForcedAlgorithm::measureNForced(afw::table::SourceCatalog const& measCat,
                                      afw::image::Exposure<float> const& exposure,
                                      afw::table::SourceCatalog const& refRecord,
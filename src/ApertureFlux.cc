@@ -21,7 +21,8 @@
  * see <http://www.lsstcorp.org/LegalNotices/>.
  */
 
-#include <numeric>
+#include <algorithm>
+#include <cmath>
 
 #include "boost/algorithm/string.hpp"
 
@@ -32,6 +33,7 @@
 #include "lsst/afw/table/Source.h"
 #include "lsst/meas/base/SincCoeffs.h"
 #include "lsst/meas/base/ApertureFlux.h"
+#include "lsst/meas/base/SpanKernels.h"
 
 namespace lsst {
 namespace meas {
@@ -45,10 +47,18 @@ FlagDefinition const ApertureFluxAlgorithm::APERTURE_TRUNCATED =
         flagDefinitions.add("flag_apertureTruncated", "aperture did not fit within measurement image");
 FlagDefinition const ApertureFluxAlgorithm::SINC_COEFFS_TRUNCATED = flagDefinitions.add(
         "flag_sincCoeffsTruncated", "full sinc coefficient image did not fit within measurement image");
+FlagDefinition const ApertureFluxAlgorithm::SINC_COEFFS_APPROXIMATE = flagDefinitions.add(
+        "flag_sincCoeffsApproximate", "sinc coefficients were computed for a quantized aperture shape");
 
 FlagDefinitionList const &ApertureFluxAlgorithm::getFlagDefinitions() { return flagDefinitions; }
 
-ApertureFluxControl::ApertureFluxControl() : radii(10), maxSincRadius(10.0), shiftKernel("lanczos5") {
+ApertureFluxControl::ApertureFluxControl()
+        : radii(10),
+          maxSincRadius(10.0),
+          maxExactRadius(0.0),
+          shiftKernel("lanczos5"),
+          shiftBankSize(0),
+          ellipticalCacheTolerance(0.0) {
     // defaults here stolen from HSC pipeline defaults
     static std::array<double, 10> defaultRadii = {{3.0, 4.5, 6.0, 9.0, 12.0, 17.0, 25.0, 35.0, 50.0, 70.0}};
     std::copy(defaultRadii.begin(), defaultRadii.end(), radii.begin());
@@ -60,13 +70,15 @@ std::string ApertureFluxAlgorithm::makeFieldPrefix(std::string const &name, doub
 }
 
 ApertureFluxAlgorithm::Keys::Keys(afw::table::Schema &schema, std::string const &prefix,
-                                  std::string const &doc, bool isSinc)
+                                  std::string const &doc, bool isSinc, bool isApproximate)
         : instFluxKey(FluxResultKey::addFields(schema, prefix, doc)),
           flags(
-                  //  The exclusion List can either be empty, or constain the sinc coeffs flag
+                  //  The exclusion List may contain the sinc coeffs flags
                   FlagHandler::addFields(
                           schema, prefix, ApertureFluxAlgorithm::getFlagDefinitions(),
-                          isSinc ? FlagDefinitionList() : FlagDefinitionList({{SINC_COEFFS_TRUNCATED}}))) {}
+                          isSinc ? (isApproximate ? FlagDefinitionList()
+                                                  : FlagDefinitionList({{SINC_COEFFS_APPROXIMATE}}))
+                                 : FlagDefinitionList({{SINC_COEFFS_TRUNCATED, SINC_COEFFS_APPROXIMATE}}))) {}
 
 ApertureFluxAlgorithm::ApertureFluxAlgorithm(Control const &ctrl, std::string const &name,
                                              afw::table::Schema &schema, daf::base::PropertySet &metadata
@@ -80,7 +92,8 @@ ApertureFluxAlgorithm::ApertureFluxAlgorithm(Control const &ctrl, std::string co
         metadata.add(upperName + "_RADII", ctrl.radii[i]);
         std::string prefix = ApertureFluxAlgorithm::makeFieldPrefix(name, ctrl.radii[i]);
         std::string doc = (boost::format("instFlux within %f-pixel aperture") % ctrl.radii[i]).str();
-        _keys.push_back(Keys(schema, prefix, doc, ctrl.radii[i] <= ctrl.maxSincRadius));
+        _keys.push_back(Keys(schema, prefix, doc, ctrl.radii[i] <= ctrl.maxSincRadius,
+                             ctrl.ellipticalCacheTolerance > 0.0));
     }
 }
 
@@ -105,6 +118,9 @@ void ApertureFluxAlgorithm::copyResultToRecord(Result const &result, afw::table:
     if (result.getFlag(SINC_COEFFS_TRUNCATED.number)) {
         _keys[index].flags.setValue(record, SINC_COEFFS_TRUNCATED.number, true);
     }
+    if (result.getFlag(SINC_COEFFS_APPROXIMATE.number)) {
+        _keys[index].flags.setValue(record, SINC_COEFFS_APPROXIMATE.number, true);
+    }
 }
 
 namespace {
@@ -118,9 +134,44 @@ getSincCoeffs(geom::Box2I const &bbox,                      // measurement image
               ApertureFluxAlgorithm::Result &result,        // result object where we set flags if we do clip
               ApertureFluxAlgorithm::Control const &ctrl    // configuration
 ) {
-    CONST_PTR(afw::image::Image<T>) cImage = SincCoeffs<T>::get(ellipse.getCore(), 0.0);
-    cImage = afw::math::offsetImage(*cImage, ellipse.getCenter().getX(), ellipse.getCenter().getY(),
-                                    ctrl.shiftKernel);
+    afw::geom::ellipses::Axes const axes(ellipse.getCore());
+    CONST_PTR(afw::image::Image<T>) cImage;
+    if (ctrl.shiftBankSize > 0 && axes.getA() == axes.getB()) {
+        // Round the center onto the grid of pre-shifted coefficients; the integer part of
+        // the shift is applied by moving the origin of a shallow copy.
+        int const nShift = ctrl.shiftBankSize;
+        int ix = static_cast<int>(std::floor(ellipse.getCenter().getX()));
+        int iy = static_cast<int>(std::floor(ellipse.getCenter().getY()));
+        int shiftX = static_cast<int>(std::round((ellipse.getCenter().getX() - ix) * nShift));
+        int shiftY = static_cast<int>(std::round((ellipse.getCenter().getY() - iy) * nShift));
+        if (shiftX == nShift) {
+            shiftX = 0;
+            ++ix;
+        }
+        if (shiftY == nShift) {
+            shiftY = 0;
+            ++iy;
+        }
+        CONST_PTR(afw::image::Image<T>) shifted =
+                SincCoeffs<T>::getShifted(axes, 0.0, shiftX, shiftY, nShift, ctrl.shiftKernel);
+        PTR(afw::image::Image<T>) moved = std::make_shared<afw::image::Image<T> >(*shifted, false);
+        moved->setXY0(shifted->getXY0() + geom::Extent2I(ix, iy));
+        cImage = moved;
+    } else if (ctrl.ellipticalCacheTolerance > 0.0 && axes.getA() != axes.getB()) {
+        cImage = SincCoeffs<T>::getQuantized(axes, 0.0, ctrl.ellipticalCacheTolerance);
+        afw::geom::ellipses::Axes const quantized =
+                SincCoeffs<T>::quantize(axes, ctrl.ellipticalCacheTolerance);
+        if (quantized.getA() != axes.getA() || quantized.getB() != axes.getB() ||
+            quantized.getTheta() != axes.getTheta()) {
+            result.setFlag(ApertureFluxAlgorithm::SINC_COEFFS_APPROXIMATE.number);
+        }
+        cImage = afw::math::offsetImage(*cImage, ellipse.getCenter().getX(), ellipse.getCenter().getY(),
+                                        ctrl.shiftKernel);
+    } else {
+        cImage = SincCoeffs<T>::get(axes, 0.0);
+        cImage = afw::math::offsetImage(*cImage, ellipse.getCenter().getX(), ellipse.getCenter().getY(),
+                                        ctrl.shiftKernel);
+    }
     if (!bbox.contains(cImage->getBBox())) {
         // We had to clip out at least part part of the coeff image,
         // but since that's much larger than the aperture (and close
@@ -140,6 +191,234 @@ getSincCoeffs(geom::Box2I const &bbox,                      // measurement image
     return cImage;
 }
 
+// Add the sum of n consecutive pixels (and, if variance is not null, of their variances) to instFlux
+// (and instFluxVar).
+template <typename T>
+void accumulatePixels(T const *image, afw::image::VariancePixel const *variance, int n, double &instFlux,
+                      double &instFluxVar) {
+    instFlux += spanKernels::sumRow(image, n);
+    if (variance) {
+        instFluxVar += spanKernels::sumRow(variance, n);
+    }
+}
+
+// Sum the pixels of an image (and optionally of its variance) within a PixelRegion that is known to be
+// contained by the image.
+template <typename T>
+void accumulateRegion(afw::image::Image<T> const &image,
+                      afw::image::Image<afw::image::VariancePixel> const *variance,
+                      afw::geom::ellipses::PixelRegion const &region, double &instFlux, double &instFluxVar) {
+    for (afw::geom::ellipses::PixelRegion::Iterator spanIter = region.begin(), spanEnd = region.end();
+         spanIter != spanEnd; ++spanIter) {
+        int const x = spanIter->getBeginX() - image.getX0();
+        int const y = spanIter->getY() - image.getY0();
+        accumulatePixels(&*image.x_at(x, y), variance ? &*variance->x_at(x, y) : nullptr,
+                         spanIter->getWidth(), instFlux, instFluxVar);
+    }
+}
+
+// Return the signed area of the intersection of the unit disk with the triangle formed by the origin and
+// the points a and b, by splitting the segment ab where it crosses the circle: pieces inside the circle
+// contribute a triangle and pieces outside it a circular sector.
+double computeTriangleDiskArea(double ax, double ay, double bx, double by) {
+    double const dx = bx - ax;
+    double const dy = by - ay;
+    double const qa = dx * dx + dy * dy;
+    if (qa == 0.0) {
+        return 0.0;
+    }
+    double const qb = ax * dx + ay * dy;
+    double const qc = ax * ax + ay * ay - 1.0;
+    double const disc = qb * qb - qa * qc;
+    double t[4] = {0.0, 1.0, 1.0, 1.0};
+    int n = 1;
+    if (disc > 0.0) {
+        double const root = std::sqrt(disc);
+        double const t1 = (-qb - root) / qa;
+        double const t2 = (-qb + root) / qa;
+        if (t1 > 0.0 && t1 < 1.0) t[n++] = t1;
+        if (t2 > 0.0 && t2 < 1.0) t[n++] = t2;
+    }
+    t[n++] = 1.0;
+    double area = 0.0;
+    for (int i = 1; i < n; ++i) {
+        double const px = ax + t[i - 1] * dx;
+        double const py = ay + t[i - 1] * dy;
+        double const qx = ax + t[i] * dx;
+        double const qy = ay + t[i] * dy;
+        double const cross = px * qy - py * qx;
+        double const mx = 0.5 * (px + qx);
+        double const my = 0.5 * (py + qy);
+        if (mx * mx + my * my <= 1.0) {
+            area += 0.5 * cross;
+        } else {
+            area += 0.5 * std::atan2(cross, px * qx + py * qy);
+        }
+    }
+    return area;
+}
+
+// The pixels of an aperture, weighted by the area of their overlap with it: the rows of pixels that lie
+// entirely within the aperture, and a table of the pixels crossed by its boundary with their overlap
+// fractions.  The table is computed once and applied to both the image and its variance.
+class ExactOverlap {
+public:
+    explicit ExactOverlap(afw::geom::ellipses::Ellipse const &ellipse);
+
+    /// Bounding box of the pixels with nonzero weight.
+    geom::Box2I const &getBBox() const { return _bbox; }
+
+    // Add the weighted sum of the pixels (and, if variance is not null, the sum of their variances,
+    // weighted by the squares of the weights) to instFlux (and instFluxVar).  The image must contain
+    // getBBox().
+    template <typename T>
+    void apply(afw::image::Image<T> const &image,
+               afw::image::Image<afw::image::VariancePixel> const *variance, double &instFlux,
+               double &instFluxVar) const;
+
+private:
+    struct Span {
+        int y;
+        int x0;
+        int x1;
+    };
+    struct EdgePixel {
+        int x;
+        int y;
+        double weight;
+    };
+
+    std::vector<Span> _spans;
+    std::vector<EdgePixel> _edges;
+    geom::Box2I _bbox;
+};
+
+ExactOverlap::ExactOverlap(afw::geom::ellipses::Ellipse const &ellipse) {
+    afw::geom::ellipses::Axes const axes(ellipse.getCore());
+    double const a = axes.getA();
+    double const b = axes.getB();
+    double const cosTheta = std::cos(axes.getTheta());
+    double const sinTheta = std::sin(axes.getTheta());
+    double const cx = ellipse.getCenter().getX();
+    double const cy = ellipse.getCenter().getY();
+
+    // Pixels lie entirely within the (convex) aperture when all of their corners do, which we find from
+    // the chords of the rows of pixel corners, where r2 = cxx dx^2 + cxy dx dy + cyy dy^2 is one.
+    afw::geom::ellipses::Quadrupole const moments(axes);
+    double const det = moments.getDeterminant();
+    double const cxx = moments.getIyy() / det;
+    double const cyy = moments.getIxx() / det;
+    double const cxy = -2.0 * moments.getIxy() / det;
+    auto const chord = [=](double y, double &xMin, double &xMax) {
+        double const dy = y - cy;
+        double const disc = (0.5 * cxy * dy) * (0.5 * cxy * dy) - cxx * (cyy * dy * dy - 1.0);
+        if (!(disc > 0.0)) {
+            return false;
+        }
+        double const xv = cx - 0.5 * cxy * dy / cxx;
+        double const halfWidth = std::sqrt(disc) / cxx;
+        xMin = xv - halfWidth;
+        xMax = xv + halfWidth;
+        return true;
+    };
+
+    // The overlaps of the other pixels are computed in the frame in which the aperture is the unit disk;
+    // that transform preserves orientation, and scales areas by 1/(a*b).  Pixels whose centers are
+    // further than 1 + reach from the center there cannot overlap the aperture.
+    auto const toUnit = [=](double x, double y, double &u, double &v) {
+        u = (cosTheta * (x - cx) + sinTheta * (y - cy)) / a;
+        v = (-sinTheta * (x - cx) + cosTheta * (y - cy)) / b;
+    };
+    double const reach = std::sqrt(0.5) / b;
+    // Pixel corners, counter-clockwise.
+    static double const cornerX[4] = {-0.5, 0.5, 0.5, -0.5};
+    static double const cornerY[4] = {-0.5, -0.5, 0.5, 0.5};
+
+    geom::Box2I const bbox(ellipse.computeBBox());  // every pixel that may overlap the aperture
+    for (int y = bbox.getMinY(); y <= bbox.getMaxY(); ++y) {
+        int interiorMin = bbox.getMaxX() + 1;
+        int interiorMax = bbox.getMaxX();
+        double bottomMin, bottomMax, topMin, topMax;
+        if (chord(y - 0.5, bottomMin, bottomMax) && chord(y + 0.5, topMin, topMax)) {
+            interiorMin = std::max(static_cast<int>(std::ceil(std::max(bottomMin, topMin) + 0.5)),
+                                   bbox.getMinX());
+            interiorMax = std::min(static_cast<int>(std::floor(std::min(bottomMax, topMax) - 0.5)),
+                                   bbox.getMaxX());
+        }
+        if (interiorMin <= interiorMax) {
+            _spans.push_back(Span{y, interiorMin, interiorMax});
+            _bbox.include(geom::Point2I(interiorMin, y));
+            _bbox.include(geom::Point2I(interiorMax, y));
+        }
+        for (int x = bbox.getMinX(); x <= bbox.getMaxX(); ++x) {
+            if (x == interiorMin && interiorMin <= interiorMax) {
+                x = interiorMax;
+                continue;
+            }
+            double u, v;
+            toUnit(x, y, u, v);
+            if (std::sqrt(u * u + v * v) >= 1.0 + reach) {
+                continue;
+            }
+            double cornerU[4], cornerV[4];
+            for (int k = 0; k < 4; ++k) {
+                toUnit(x + cornerX[k], y + cornerY[k], cornerU[k], cornerV[k]);
+            }
+            double area = 0.0;
+            for (int k = 0; k < 4; ++k) {
+                area += computeTriangleDiskArea(cornerU[k], cornerV[k], cornerU[(k + 1) % 4],
+                                                cornerV[(k + 1) % 4]);
+            }
+            double const weight = std::min(std::max(area * a * b, 0.0), 1.0);
+            if (weight > 0.0) {
+                _edges.push_back(EdgePixel{x, y, weight});
+                _bbox.include(geom::Point2I(x, y));
+            }
+        }
+    }
+}
+
+template <typename T>
+void ExactOverlap::apply(afw::image::Image<T> const &image,
+                         afw::image::Image<afw::image::VariancePixel> const *variance, double &instFlux,
+                         double &instFluxVar) const {
+    for (Span const &span : _spans) {
+        int const x = span.x0 - image.getX0();
+        int const y = span.y - image.getY0();
+        accumulatePixels(&*image.x_at(x, y), variance ? &*variance->x_at(x, y) : nullptr,
+                         span.x1 - span.x0 + 1, instFlux, instFluxVar);
+    }
+    for (EdgePixel const &edge : _edges) {
+        int const x = edge.x - image.getX0();
+        int const y = edge.y - image.getY0();
+        instFlux += edge.weight * *image.x_at(x, y);
+        if (variance) {
+            instFluxVar += edge.weight * edge.weight * *variance->x_at(x, y);
+        }
+    }
+}
+
+// Compute an exact-overlap instFlux (and, if variance is not null, its uncertainty).
+template <typename T>
+ApertureFluxAlgorithm::Result computeExactOverlapFlux(
+        afw::image::Image<T> const &image, afw::image::Image<afw::image::VariancePixel> const *variance,
+        afw::geom::ellipses::Ellipse const &ellipse) {
+    ApertureFluxAlgorithm::Result result;
+    ExactOverlap const overlap(ellipse);
+    if (!image.getBBox().contains(overlap.getBBox())) {
+        result.setFlag(ApertureFluxAlgorithm::APERTURE_TRUNCATED.number);
+        result.setFlag(ApertureFluxAlgorithm::FAILURE.number);
+        return result;
+    }
+    result.instFlux = 0.0;
+    double instFluxVar = 0.0;
+    overlap.apply(image, variance, result.instFlux, instFluxVar);
+    if (variance) {
+        result.instFluxErr = std::sqrt(instFluxVar);
+    }
+    return result;
+}
+
 }  // namespace
 
 template <typename T>
@@ -182,13 +461,9 @@ ApertureFluxAlgorithm::Result ApertureFluxAlgorithm::computeNaiveFlux(
         result.setFlag(FAILURE.number);
         return result;
     }
-    result.instFlux = 0;
-    for (afw::geom::ellipses::PixelRegion::Iterator spanIter = region.begin(), spanEnd = region.end();
-         spanIter != spanEnd; ++spanIter) {
-        typename afw::image::Image<T>::x_iterator pixIter =
-                image.x_at(spanIter->getBeginX() - image.getX0(), spanIter->getY() - image.getY0());
-        result.instFlux += std::accumulate(pixIter, pixIter + spanIter->getWidth(), 0.0);
-    }
+    result.instFlux = 0.0;
+    double instFluxVar = 0.0;
+    accumulateRegion(image, nullptr, region, result.instFlux, instFluxVar);
     return result;
 }
 
@@ -204,38 +479,296 @@ ApertureFluxAlgorithm::Result ApertureFluxAlgorithm::computeNaiveFlux(
         return result;
     }
     result.instFlux = 0.0;
-    result.instFluxErr = 0.0;
-    for (afw::geom::ellipses::PixelRegion::Iterator spanIter = region.begin(), spanEnd = region.end();
-         spanIter != spanEnd; ++spanIter) {
-        typename afw::image::MaskedImage<T>::Image::x_iterator pixIter = image.getImage()->x_at(
-                spanIter->getBeginX() - image.getX0(), spanIter->getY() - image.getY0());
-        typename afw::image::MaskedImage<T>::Variance::x_iterator varIter = image.getVariance()->x_at(
-                spanIter->getBeginX() - image.getX0(), spanIter->getY() - image.getY0());
-        result.instFlux += std::accumulate(pixIter, pixIter + spanIter->getWidth(), 0.0);
-        // we use this to hold variance as we accumulate...
-        result.instFluxErr += std::accumulate(varIter, varIter + spanIter->getWidth(), 0.0);
-    }
-    result.instFluxErr = std::sqrt(result.instFluxErr);  // ...and switch back to sigma here.
+    double instFluxVar = 0.0;
+    accumulateRegion(*image.getImage(), image.getVariance().get(), region, result.instFlux, instFluxVar);
+    result.instFluxErr = std::sqrt(instFluxVar);
     return result;
 }
 
+template <typename T>
+ApertureFluxAlgorithm::Result ApertureFluxAlgorithm::computeExactFlux(
+        afw::image::Image<T> const &image, afw::geom::ellipses::Ellipse const &ellipse, Control const &) {
+    return computeExactOverlapFlux(image, nullptr, ellipse);
+}
+
+template <typename T>
+ApertureFluxAlgorithm::Result ApertureFluxAlgorithm::computeExactFlux(
+        afw::image::MaskedImage<T> const &image, afw::geom::ellipses::Ellipse const &ellipse,
+        Control const &) {
+    return computeExactOverlapFlux(*image.getImage(), image.getVariance().get(), ellipse);
+}
+
 template <typename T>
 ApertureFluxAlgorithm::Result ApertureFluxAlgorithm::computeFlux(afw::image::Image<T> const &image,
                                                                  afw::geom::ellipses::Ellipse const &ellipse,
                                                                  Control const &ctrl) {
-    return (afw::geom::ellipses::Axes(ellipse.getCore()).getB() <= ctrl.maxSincRadius)
-                   ? computeSincFlux(image, ellipse, ctrl)
-                   : computeNaiveFlux(image, ellipse, ctrl);
+    double const minorAxis = afw::geom::ellipses::Axes(ellipse.getCore()).getB();
+    if (minorAxis <= ctrl.maxSincRadius) {
+        return computeSincFlux(image, ellipse, ctrl);
+    }
+    return (minorAxis <= ctrl.maxExactRadius) ? computeExactFlux(image, ellipse, ctrl)
+                                              : computeNaiveFlux(image, ellipse, ctrl);
 }
 
 template <typename T>
 ApertureFluxAlgorithm::Result ApertureFluxAlgorithm::computeFlux(afw::image::MaskedImage<T> const &image,
                                                                  afw::geom::ellipses::Ellipse const &ellipse,
                                                                  Control const &ctrl) {
-    return (afw::geom::ellipses::Axes(ellipse.getCore()).getB() <= ctrl.maxSincRadius)
-                   ? computeSincFlux(image, ellipse, ctrl)
-                   : computeNaiveFlux(image, ellipse, ctrl);
+    double const minorAxis = afw::geom::ellipses::Axes(ellipse.getCore()).getB();
+    if (minorAxis <= ctrl.maxSincRadius) {
+        return computeSincFlux(image, ellipse, ctrl);
+    }
+    return (minorAxis <= ctrl.maxExactRadius) ? computeExactFlux(image, ellipse, ctrl)
+                                              : computeNaiveFlux(image, ellipse, ctrl);
 }
+namespace {
+
+// Compute naive instFluxes for the apertures obtained by scaling the unit ellipse core by the given
+// scales (indices into scales, sorted by increasing scale) in a single pass over the rows of the
+// largest aperture, summing the pixels of each row into the smallest aperture that contains them and
+// summing the bins afterwards.
+template <typename T>
+void computeNaiveFluxes(afw::image::Image<T> const &image,
+                        afw::image::Image<afw::image::VariancePixel> const *variance,
+                        geom::Point2D const &center, afw::geom::ellipses::Axes const &unit,
+                        std::vector<double> const &scales, std::vector<std::size_t> const &indices,
+                        std::vector<ApertureFluxAlgorithm::Result> &results) {
+    if (indices.empty()) {
+        return;
+    }
+    std::size_t const nBins = indices.size();
+    std::vector<double> scales2(nBins);
+    for (std::size_t j = 0; j < nBins; ++j) {
+        scales2[j] = scales[indices[j]] * scales[indices[j]];
+    }
+    std::vector<double> instFlux(nBins, 0.0);
+    std::vector<double> instFluxVar(nBins, 0.0);
+
+    // The squared radius of a pixel, in units of the unit ellipse, is (dx, dy) Q^{-1} (dx, dy)^T; for
+    // a circular unit ellipse this is just dx^2 + dy^2.
+    afw::geom::ellipses::Quadrupole const moments(unit);
+    double const det = moments.getDeterminant();
+    double const cxx = moments.getIyy() / det;
+    double const cyy = moments.getIxx() / det;
+    double const cxy = -2.0 * moments.getIxy() / det;
+
+    geom::Box2I const bbox = image.getBBox();
+    auto const scaled = [&unit](double scale) {
+        return afw::geom::ellipses::Axes(unit.getA() * scale, unit.getB() * scale, unit.getTheta());
+    };
+    // A pixel is in aperture j if r2 <= scales2[j]; in each row the pixels of an aperture form an
+    // interval, which we find by solving the quadratic in dx, and then correct by evaluating the
+    // inequality itself at its ends, so that pixels are assigned exactly as a per-pixel test would.
+    auto const inside = [cxx, cxy, cyy, &center](int x, double dy, double scale2) {
+        double const dx = x - center.getX();
+        return (cxx * dx * dx + cxy * dx * dy + cyy * dy * dy) <= scale2;
+    };
+    std::vector<int> lo(nBins);
+    std::vector<int> hi(nBins);
+    afw::geom::ellipses::PixelRegion region(
+            afw::geom::ellipses::Ellipse(scaled(scales[indices.back()]), center));
+    for (afw::geom::ellipses::PixelRegion::Iterator spanIter = region.begin(), spanEnd = region.end();
+         spanIter != spanEnd; ++spanIter) {
+        int const y = spanIter->getY();
+        if (y < bbox.getMinY() || y > bbox.getMaxY()) {
+            continue;
+        }
+        int const x0 = std::max(spanIter->getMinX(), bbox.getMinX());
+        int const x1 = std::min(spanIter->getMaxX(), bbox.getMaxX());
+        if (x0 > x1) {
+            continue;
+        }
+        double const dy = y - center.getY();
+        // Pointers to the pixel at x0, so the pixel at x is at offset (x - x0).
+        T const *pixels = &*image.x_at(x0 - image.getX0(), y - image.getY0());
+        afw::image::VariancePixel const *variances =
+                variance ? &*variance->x_at(x0 - image.getX0(), y - image.getY0()) : nullptr;
+        // Vertex and half-width of the interval of real dx within the aperture of unit scale.
+        double const xv = center.getX() - 0.5 * cxy * dy / cxx;
+        for (std::size_t j = 0; j < nBins; ++j) {
+            double const disc = (0.5 * cxy * dy) * (0.5 * cxy * dy) - cxx * (cyy * dy * dy - scales2[j]);
+            int const mid = static_cast<int>(std::lround(xv));
+            if (!inside(mid, dy, scales2[j])) {
+                lo[j] = 1;
+                hi[j] = 0;
+                continue;
+            }
+            double const halfWidth = disc > 0.0 ? std::sqrt(disc) / cxx : 0.0;
+            int l = std::min(mid, static_cast<int>(std::ceil(xv - halfWidth)));
+            int h = std::max(mid, static_cast<int>(std::floor(xv + halfWidth)));
+            if (inside(l, dy, scales2[j])) {
+                while (inside(l - 1, dy, scales2[j])) --l;
+            } else {
+                while (!inside(l, dy, scales2[j])) ++l;
+            }
+            if (inside(h, dy, scales2[j])) {
+                while (inside(h + 1, dy, scales2[j])) ++h;
+            } else {
+                while (!inside(h, dy, scales2[j])) --h;
+            }
+            lo[j] = std::max(l, x0);
+            hi[j] = std::min(h, x1);
+        }
+        // Sum the ring of each aperture outside the largest smaller aperture with pixels in this row
+        // (intervals are nested, so if an aperture has none, neither do the smaller ones).
+        int innerLo = 1;
+        int innerHi = 0;
+        for (std::size_t j = 0; j < nBins; ++j) {
+            if (lo[j] > hi[j]) {
+                continue;
+            }
+            int const begin = lo[j] - x0;
+            if (innerLo > innerHi) {
+                accumulatePixels(pixels + begin, variances ? variances + begin : nullptr,
+                                 hi[j] - lo[j] + 1, instFlux[j], instFluxVar[j]);
+            } else {
+                int const resume = innerHi + 1 - x0;
+                accumulatePixels(pixels + begin, variances ? variances + begin : nullptr, innerLo - lo[j],
+                                 instFlux[j], instFluxVar[j]);
+                accumulatePixels(pixels + resume, variances ? variances + resume : nullptr,
+                                 hi[j] - innerHi, instFlux[j], instFluxVar[j]);
+            }
+            innerLo = lo[j];
+            innerHi = hi[j];
+        }
+    }
+
+    double cumulativeFlux = 0.0;
+    double cumulativeVar = 0.0;
+    for (std::size_t j = 0; j < nBins; ++j) {
+        cumulativeFlux += instFlux[j];
+        cumulativeVar += instFluxVar[j];
+        ApertureFluxAlgorithm::Result &result = results[indices[j]];
+        afw::geom::ellipses::PixelRegion aperture(
+                afw::geom::ellipses::Ellipse(scaled(scales[indices[j]]), center));
+        if (!bbox.contains(aperture.getBBox())) {
+            result.setFlag(ApertureFluxAlgorithm::APERTURE_TRUNCATED.number);
+            result.setFlag(ApertureFluxAlgorithm::FAILURE.number);
+            continue;
+        }
+        result.instFlux = cumulativeFlux;
+        if (variance) {
+            result.instFluxErr = std::sqrt(cumulativeVar);
+        }
+    }
+}
+
+// Compute sinc instFluxes for the apertures obtained by scaling the unit ellipse core by the given scales:
+// the coefficient images for all apertures are evaluated against blocks of a single view of the union of
+// their bounding boxes.
+template <typename T>
+void computeSincFluxes(afw::image::Image<T> const &image,
+                       afw::image::Image<afw::image::VariancePixel> const *variance,
+                       geom::Point2D const &center, afw::geom::ellipses::Axes const &unit,
+                       std::vector<double> const &scales, std::vector<std::size_t> const &indices,
+                       ApertureFluxAlgorithm::Control const &ctrl,
+                       std::vector<ApertureFluxAlgorithm::Result> &results) {
+    std::vector<CONST_PTR(afw::image::Image<T>)> coeffs(indices.size());
+    geom::Box2I bbox;
+    for (std::size_t j = 0; j < indices.size(); ++j) {
+        double const scale = scales[indices[j]];
+        ApertureFluxAlgorithm::Result &result = results[indices[j]];
+        coeffs[j] = getSincCoeffs<T>(
+                image.getBBox(),
+                afw::geom::ellipses::Ellipse(
+                        afw::geom::ellipses::Axes(unit.getA() * scale, unit.getB() * scale, unit.getTheta()),
+                        center),
+                result, ctrl);
+        if (!result.getFlag(ApertureFluxAlgorithm::APERTURE_TRUNCATED.number)) {
+            bbox.include(coeffs[j]->getBBox());
+        }
+    }
+    if (bbox.isEmpty()) {
+        return;
+    }
+    afw::image::Image<T> subImage(image, bbox);
+    auto data = ndarray::asEigenArray(subImage.getArray());
+    std::shared_ptr<afw::image::Image<afw::image::VariancePixel>> subVariance;
+    if (variance) {
+        subVariance = std::make_shared<afw::image::Image<afw::image::VariancePixel>>(*variance, bbox);
+    }
+    for (std::size_t j = 0; j < indices.size(); ++j) {
+        ApertureFluxAlgorithm::Result &result = results[indices[j]];
+        if (result.getFlag(ApertureFluxAlgorithm::APERTURE_TRUNCATED.number)) {
+            continue;
+        }
+        geom::Box2I const cBox = coeffs[j]->getBBox();
+        int const dx = cBox.getMinX() - bbox.getMinX();
+        int const dy = cBox.getMinY() - bbox.getMinY();
+        auto c = ndarray::asEigenArray(coeffs[j]->getArray());
+        result.instFlux = (data.block(dy, dx, cBox.getHeight(), cBox.getWidth()) * c).sum();
+        if (subVariance) {
+            auto var = ndarray::asEigenArray(subVariance->getArray());
+            result.instFluxErr = std::sqrt(
+                    (var.block(dy, dx, cBox.getHeight(), cBox.getWidth()).template cast<T>() * c.square())
+                            .sum());
+        }
+    }
+}
+
+template <typename T>
+std::vector<ApertureFluxAlgorithm::Result> computeAllFluxes(
+        afw::image::Image<T> const &image, afw::image::Image<afw::image::VariancePixel> const *variance,
+        geom::Point2D const &center, afw::geom::ellipses::Axes const &unit,
+        std::vector<double> const &scales, ApertureFluxAlgorithm::Control const &ctrl) {
+    std::vector<ApertureFluxAlgorithm::Result> results(scales.size());
+    std::vector<std::size_t> sincIndices;
+    std::vector<std::size_t> naiveIndices;
+    for (std::size_t i = 0; i < scales.size(); ++i) {
+        double const minorAxis = unit.getB() * scales[i];
+        if (minorAxis <= ctrl.maxSincRadius) {
+            sincIndices.push_back(i);
+        } else if (minorAxis <= ctrl.maxExactRadius) {
+            results[i] = computeExactOverlapFlux(
+                    image, variance,
+                    afw::geom::ellipses::Ellipse(afw::geom::ellipses::Axes(unit.getA() * scales[i],
+                                                                           minorAxis, unit.getTheta()),
+                                                 center));
+        } else {
+            naiveIndices.push_back(i);
+        }
+    }
+    std::sort(naiveIndices.begin(), naiveIndices.end(),
+              [&scales](std::size_t a, std::size_t b) { return scales[a] < scales[b]; });
+    computeSincFluxes(image, variance, center, unit, scales, sincIndices, ctrl, results);
+    computeNaiveFluxes(image, variance, center, unit, scales, naiveIndices, results);
+    return results;
+}
+
+// The unit ellipse core of circular apertures, whose scales are their radii.
+afw::geom::ellipses::Axes const CIRCLE(1.0, 1.0, 0.0);
+
+}  // namespace
+
+template <typename T>
+std::vector<ApertureFluxAlgorithm::Result> ApertureFluxAlgorithm::computeFluxes(
+        afw::image::Image<T> const &image, geom::Point2D const &center, Control const &ctrl) {
+    return computeAllFluxes<T>(image, nullptr, center, CIRCLE, ctrl.radii, ctrl);
+}
+
+template <typename T>
+std::vector<ApertureFluxAlgorithm::Result> ApertureFluxAlgorithm::computeFluxes(
+        afw::image::MaskedImage<T> const &image, geom::Point2D const &center, Control const &ctrl) {
+    return computeAllFluxes<T>(*image.getImage(), image.getVariance().get(), center, CIRCLE, ctrl.radii,
+                               ctrl);
+}
+
+template <typename T>
+std::vector<ApertureFluxAlgorithm::Result> ApertureFluxAlgorithm::computeScaledFluxes(
+        afw::image::Image<T> const &image, afw::geom::ellipses::Ellipse const &ellipse,
+        std::vector<double> const &scales, Control const &ctrl) {
+    return computeAllFluxes<T>(image, nullptr, ellipse.getCenter(),
+                               afw::geom::ellipses::Axes(ellipse.getCore()), scales, ctrl);
+}
+
+template <typename T>
+std::vector<ApertureFluxAlgorithm::Result> ApertureFluxAlgorithm::computeScaledFluxes(
+        afw::image::MaskedImage<T> const &image, afw::geom::ellipses::Ellipse const &ellipse,
+        std::vector<double> const &scales, Control const &ctrl) {
+    return computeAllFluxes<T>(*image.getImage(), image.getVariance().get(), ellipse.getCenter(),
+                               afw::geom::ellipses::Axes(ellipse.getCore()), scales, ctrl);
+}
+
 #define INSTANTIATE(T)                                                                                  \
     template ApertureFluxAlgorithm::Result ApertureFluxAlgorithm::computeFlux(                          \
             afw::image::Image<T> const &, afw::geom::ellipses::Ellipse const &, Control const &);       \
@@ -248,7 +781,21 @@ ApertureFluxAlgorithm::Result ApertureFluxAlgorithm::computeFlux(afw::image::Mas
     template ApertureFluxAlgorithm::Result ApertureFluxAlgorithm::computeNaiveFlux(                     \
             afw::image::Image<T> const &, afw::geom::ellipses::Ellipse const &, Control const &);       \
     template ApertureFluxAlgorithm::Result ApertureFluxAlgorithm::computeNaiveFlux(                     \
-            afw::image::MaskedImage<T> const &, afw::geom::ellipses::Ellipse const &, Control const &)
+            afw::image::MaskedImage<T> const &, afw::geom::ellipses::Ellipse const &, Control const &); \
+    template ApertureFluxAlgorithm::Result ApertureFluxAlgorithm::computeExactFlux(                     \
+            afw::image::Image<T> const &, afw::geom::ellipses::Ellipse const &, Control const &);       \
+    template ApertureFluxAlgorithm::Result ApertureFluxAlgorithm::computeExactFlux(                     \
+            afw::image::MaskedImage<T> const &, afw::geom::ellipses::Ellipse const &, Control const &); \
+    template std::vector<ApertureFluxAlgorithm::Result> ApertureFluxAlgorithm::computeFluxes(           \
+            afw::image::Image<T> const &, geom::Point2D const &, Control const &);                      \
+    template std::vector<ApertureFluxAlgorithm::Result> ApertureFluxAlgorithm::computeFluxes(           \
+            afw::image::MaskedImage<T> const &, geom::Point2D const &, Control const &);                \
+    template std::vector<ApertureFluxAlgorithm::Result> ApertureFluxAlgorithm::computeScaledFluxes(     \
+            afw::image::Image<T> const &, afw::geom::ellipses::Ellipse const &,                         \
+            std::vector<double> const &, Control const &);                                              \
+    template std::vector<ApertureFluxAlgorithm::Result> ApertureFluxAlgorithm::computeScaledFluxes(     \
+            afw::image::MaskedImage<T> const &, afw::geom::ellipses::Ellipse const &,                   \
+            std::vector<double> const &, Control const &)
 
 INSTANTIATE(float);
 INSTANTIATE(double);
@@ -260,7 +807,12 @@ ApertureFluxTransform::ApertureFluxTransform(Control const &ctrl, std::string co
         for (std::size_t j = 0; j < ApertureFluxAlgorithm::getFlagDefinitions().size(); j++) {
             FlagDefinition const &flag = ApertureFluxAlgorithm::getFlagDefinitions()[j];
             if (_ctrl.radii[i] > _ctrl.maxSincRadius &&
-                flag == ApertureFluxAlgorithm::SINC_COEFFS_TRUNCATED) {
+                (flag == ApertureFluxAlgorithm::SINC_COEFFS_TRUNCATED ||
+                 flag == ApertureFluxAlgorithm::SINC_COEFFS_APPROXIMATE)) {
+                continue;
+            }
+            if (!(_ctrl.ellipticalCacheTolerance > 0.0) &&
+                flag == ApertureFluxAlgorithm::SINC_COEFFS_APPROXIMATE) {
                 continue;
             }
             mapper.addMapping(
@@ -280,14 +832,14 @@ void ApertureFluxTransform::operator()(afw::table::SourceCatalog const &inputCat
                                        afw::table::BaseCatalog &outputCatalog, afw::geom::SkyWcs const &wcs,
                                        afw::image::PhotoCalib const &photoCalib) const {
     checkCatalogSize(inputCatalog, outputCatalog);
-    std::vector<FluxResultKey> instFluxKeys;
-    for (std::size_t i = 0; i < _ctrl.radii.size(); ++i) {
-        instFluxKeys.push_back(FluxResultKey(
-                inputCatalog.getSchema()[ApertureFluxAlgorithm::makeFieldPrefix(_name, _ctrl.radii[i])]));
-    }
-    afw::table::SourceCatalog::const_iterator inSrc = inputCatalog.begin();
-    afw::table::BaseCatalog::iterator outSrc = outputCatalog.begin();
-    {
+    if (!inputCatalog.isContiguous()) {
+        std::vector<FluxResultKey> instFluxKeys;
+        for (std::size_t i = 0; i < _ctrl.radii.size(); ++i) {
+            instFluxKeys.push_back(FluxResultKey(
+                    inputCatalog.getSchema()[ApertureFluxAlgorithm::makeFieldPrefix(_name, _ctrl.radii[i])]));
+        }
+        afw::table::SourceCatalog::const_iterator inSrc = inputCatalog.begin();
+        afw::table::BaseCatalog::iterator outSrc = outputCatalog.begin();
         for (; inSrc != inputCatalog.end() && outSrc != outputCatalog.end(); ++inSrc, ++outSrc) {
             for (std::size_t i = 0; i < _ctrl.radii.size(); ++i) {
                 FluxResult instFluxResult = instFluxKeys[i].get(*inSrc);
@@ -295,6 +847,18 @@ void ApertureFluxTransform::operator()(afw::table::SourceCatalog const &inputCat
                                                                         instFluxResult.instFluxErr));
             }
         }
+        return;
+    }
+    afw::table::SourceColumnView const columns = inputCatalog.getColumnView();
+    for (std::size_t i = 0; i < _ctrl.radii.size(); ++i) {
+        FluxResultKey instFluxKey(
+                inputCatalog.getSchema()[ApertureFluxAlgorithm::makeFieldPrefix(_name, _ctrl.radii[i])]);
+        ndarray::Array<Flux const, 1> const instFlux = columns[instFluxKey.getInstFlux()];
+        ndarray::Array<FluxErrElement const, 1> const instFluxErr = columns[instFluxKey.getInstFluxErr()];
+        afw::table::BaseCatalog::iterator outSrc = outputCatalog.begin();
+        for (std::size_t j = 0; outSrc != outputCatalog.end(); ++j, ++outSrc) {
+            _magKeys[i].set(*outSrc, photoCalib.instFluxToMagnitude(instFlux[j], instFluxErr[j]));
+        }
     }
 }
 
@@ -0,0 +1,109 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include "boost/format.hpp"
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/meas/base/BinnedPyramid.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+namespace {
+
+bool isPowerOfTwo(int n) { return n > 0 && (n & (n - 1)) == 0; }
+
+}  // namespace
+
+BinnedPyramid::Level const& BinnedPyramid::getLevel(int binX, int binY) {
+    if (!isPowerOfTwo(binX) || !isPowerOfTwo(binY) || (binX == 1 && binY == 1)) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("Invalid pyramid binning %dx%d") % binX % binY).str());
+    }
+    auto const key = std::make_pair(binX, binY);
+    auto iter = _levels.find(key);
+    if (iter != _levels.end()) {
+        return iter->second;
+    }
+
+    // Halve the larger of the two binning factors to find the level this one is computed from; the
+    // only level never stored is the unbinned image itself.
+    bool const alongX = binX >= binY;
+    int const fineBinX = alongX ? binX / 2 : binX;
+    int const fineBinY = alongX ? binY : binY / 2;
+
+    Level level;
+    level.binX = binX;
+    level.binY = binY;
+    level.width = _mimage.getWidth() / binX;
+    level.height = _mimage.getHeight() / binY;
+    level.image.resize(static_cast<std::size_t>(level.width) * level.height);
+    level.variance.resize(level.image.size());
+    if (fineBinX == 1 && fineBinY == 1) {
+        // Pairs of adjacent pixels of the image, along x or along y.
+        for (int j = 0; j < level.height; ++j) {
+            int const y = alongX ? j : 2 * j;
+            auto imageIter = _mimage.getImage()->row_begin(y);
+            auto varianceIter = _mimage.getVariance()->row_begin(y);
+            float* imageOut = &level.image[static_cast<std::size_t>(j) * level.width];
+            float* varianceOut = &level.variance[static_cast<std::size_t>(j) * level.width];
+            if (alongX) {
+                for (int i = 0; i < level.width; ++i, imageIter += 2, varianceIter += 2) {
+                    imageOut[i] = 0.5 * (static_cast<double>(imageIter[0]) + imageIter[1]);
+                    varianceOut[i] = 0.25 * (static_cast<double>(varianceIter[0]) + varianceIter[1]);
+                }
+            } else {
+                auto imageNext = _mimage.getImage()->row_begin(y + 1);
+                auto varianceNext = _mimage.getVariance()->row_begin(y + 1);
+                for (int i = 0; i < level.width; ++i) {
+                    imageOut[i] = 0.5 * (static_cast<double>(imageIter[i]) + imageNext[i]);
+                    varianceOut[i] = 0.25 * (static_cast<double>(varianceIter[i]) + varianceNext[i]);
+                }
+            }
+        }
+    } else {
+        // Pairs of adjacent pixels of the finer level.  A std::map does not invalidate references to
+        // its elements on insertion, so the finer level may be held while this one is added.
+        Level const& fine = getLevel(fineBinX, fineBinY);
+        for (int j = 0; j < level.height; ++j) {
+            int const fineJ = alongX ? j : 2 * j;
+            float const* imageIn = &fine.image[static_cast<std::size_t>(fineJ) * fine.width];
+            float const* varianceIn = &fine.variance[static_cast<std::size_t>(fineJ) * fine.width];
+            float* imageOut = &level.image[static_cast<std::size_t>(j) * level.width];
+            float* varianceOut = &level.variance[static_cast<std::size_t>(j) * level.width];
+            int const step = alongX ? 1 : fine.width;
+            for (int i = 0; i < level.width; ++i) {
+                int const fineI = alongX ? 2 * i : i;
+                imageOut[i] = 0.5 * (static_cast<double>(imageIn[fineI]) + imageIn[fineI + step]);
+                varianceOut[i] = 0.25 * (static_cast<double>(varianceIn[fineI]) + varianceIn[fineI + step]);
+            }
+        }
+    }
+    return _levels.emplace(key, std::move(level)).first->second;
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -22,13 +22,16 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cmath>
 
+#include "boost/format.hpp"
 #include "boost/math/constants/constants.hpp"
 
 #include "lsst/meas/base/Blendedness.h"
 #include "lsst/afw/detection/HeavyFootprint.h"
 #include "lsst/meas/base/exceptions.h"
+#include "lsst/meas/base/SpanKernels.h"
 #include "lsst/afw/geom/ellipses/Ellipse.h"
 #include "lsst/afw/geom/ellipses/PixelRegion.h"
 #include "lsst/afw/geom/ellipses/GridTransform.h"
@@ -67,28 +70,13 @@ double computeOldBlendedness(PTR(afw::detection::Footprint const) childFootprint
         throw LSST_EXCEPT(pex::exceptions::LogicError, "Child footprint extends beyond image.");
     }
 
-    // Iterate over all the spans in the child HeavyFootprint,
-    // along with iterators for the child pixels (from the HeavyFootprint)
-    // and parent pixels (from the Exposure).
-    typedef afw::image::Image<float>::const_x_iterator ParentPixIter;
-    typedef ndarray::Array<float const, 1, 1>::Iterator ChildPixIter;
-    auto spanIter = childHeavy->getSpans()->begin();
-    auto const spanEnd = childHeavy->getSpans()->end();
-    ChildPixIter childPixIter = childHeavy->getImageArray().begin();
-    double cp = 0.0;  // child.dot(parent)
-    double cc = 0.0;  // child.dot(child)
-    while (spanIter != spanEnd) {
-        afw::geom::Span const& span = *spanIter;
-        ParentPixIter parentPixIter =
-                parentImage.x_at(span.getBeginX() - parentImage.getX0(), span.getY() - parentImage.getY0());
-        int const width = span.getWidth();
-        // Iterate over the pixels within the span, updating the dot products.
-        for (int x = 0; x < width; ++parentPixIter, ++childPixIter, ++x) {
-            cp += (*childPixIter) * ((*parentPixIter) - (*childPixIter));
-            cc += (*childPixIter) * (*childPixIter);
-        }
-        ++spanIter;
-    }
+    // The child is subtracted from the parent pixel by pixel (not as child.dot(parent) - cc, which
+    // leaves a rounding residual), so a child with no siblings, whose pixels are those of its parent,
+    // gets exactly zero.
+    ndarray::Array<float const, 1, 1> const childPixels = childHeavy->getImageArray();
+    double const cc = sumSquares(childPixels);  // child.dot(child)
+    // child.dot(parent - child)
+    double const cp = dotResidualSpans(*childHeavy->getSpans(), childPixels, parentImage);
     if (cc > 0.0) {
         return cp / cc;
     }
@@ -140,30 +128,34 @@ private:
     double _wdxy;
 };
 
-template <typename Accumulator>
-void computeMoments(afw::image::MaskedImage<float> const& image, geom::Point2D const& centroid,
+/*
+ * Compute the Gaussian weights of the pixels within nSigmaWeightMax of the centroid (in the metric of
+ * the shape), clipped to the given bounding box, and store them with their spans in the given ChildPixels.
+ *
+ * The weights are evaluated a span at a time: the exponent is linear along the span in the transformed
+ * coordinates, so it is filled in with additions before a tight loop of exponentials.
+ */
+void computeWeights(geom::Box2I const& bbox, geom::Point2D const& centroid,
                     afw::geom::ellipses::Quadrupole const& shape, double nSigmaWeightMax,
-                    Accumulator& accumulatorRaw, Accumulator& accumulatorAbs) {
-    geom::Box2I bbox = image.getBBox(afw::image::PARENT);
-
+                    BlendednessAlgorithm::ChildPixels& region) {
     afw::geom::ellipses::Ellipse ellipse(shape, centroid);
     ellipse.getCore().scale(nSigmaWeightMax);
 
     // To evaluate an elliptically-symmetric function, we transform points
     // by the following transform, then evaluate a circularly-symmetric function
     // at the transformed positions.
-    geom::LinearTransform transform = shape.getGridTransform();
-
-    typedef afw::geom::ellipses::PixelRegion::Iterator SpanIter;         // yields Spans
-    typedef afw::geom::Span::Iterator PointIter;                         // yields Point2I positions
-    typedef afw::image::MaskedImage<float>::const_x_iterator PixelIter;  // yields pixel values
-
-    afw::geom::ellipses::PixelRegion region(ellipse);
-    bool isContained = bbox.contains(region.getBBox());
-    SpanIter const spanEnd = region.end();
-    for (SpanIter spanIter = region.begin(); spanIter != spanEnd; ++spanIter) {
+    geom::LinearTransform const gridTransform = shape.getGridTransform();
+    geom::LinearTransform::Matrix const& transform = gridTransform.getMatrix();
+
+    afw::geom::ellipses::PixelRegion pixelRegion(ellipse);
+    region.centroid = centroid;
+    region.bbox = pixelRegion.getBBox();
+    region.isClipped = !bbox.contains(region.bbox);
+    region.spans.clear();
+    region.weights.clear();
+    for (auto spanIter = pixelRegion.begin(); spanIter != pixelRegion.end(); ++spanIter) {
         afw::geom::Span span = *spanIter;
-        if (!isContained) {
+        if (region.isClipped) {
             if (span.getY() < bbox.getMinY() || span.getY() > bbox.getMaxY()) {
                 continue;
             }
@@ -173,23 +165,133 @@ void computeMoments(afw::image::MaskedImage<float> const& image, geom::Point2D c
                 continue;
             }
         }
-        PixelIter pixelIter = image.x_at(span.getBeginX() - image.getX0(), span.getY() - image.getY0());
-        PointIter const pointEnd = span.end();
-        for (PointIter pointIter = span.begin(); pointIter != pointEnd; ++pointIter, ++pixelIter) {
-            geom::Extent2D d = geom::Point2D(*pointIter) - centroid;
-            geom::Extent2D td = transform(d);
-            // use single precision for faster exp, erf
-            float weight = std::exp(static_cast<float>(-0.5 * td.computeSquaredNorm()));
-            float data = pixelIter.image();
-            accumulatorRaw(d.getX(), d.getY(), weight, data);
-            float variance = pixelIter.variance();
-            float mu = BlendednessAlgorithm::computeAbsExpectation(data, variance);
-            float bias = BlendednessAlgorithm::computeAbsBias(mu, variance);
-            accumulatorAbs(d.getX(), d.getY(), weight, std::abs(data) - bias);
+        region.spans.push_back(span);
+        int const width = span.getWidth();
+        std::size_t const offset = region.weights.size();
+        region.weights.resize(offset + width);
+        float* const weights = region.weights.data() + offset;
+        double const dx = span.getMinX() - centroid.getX();
+        double const dy = span.getY() - centroid.getY();
+        double const u0 = transform(0, 0) * dx + transform(0, 1) * dy;
+        double const v0 = transform(1, 0) * dx + transform(1, 1) * dy;
+        for (int i = 0; i < width; ++i) {
+            double const u = u0 + transform(0, 0) * i;
+            double const v = v0 + transform(1, 0) * i;
+            weights[i] = static_cast<float>(-0.5 * (u * u + v * v));
+        }
+        // use single precision for faster exp, erf
+        for (int i = 0; i < width; ++i) {
+            weights[i] = std::exp(weights[i]);
         }
     }
 }
 
+/*
+ * Add the pixels of one span to the raw and absolute-value accumulators.
+ */
+template <typename Accumulator>
+void accumulateSpan(afw::geom::Span const& span, geom::Point2D const& centroid, float const* weights,
+                    float const* image, float const* variance, Accumulator& accumulatorRaw,
+                    Accumulator& accumulatorAbs) {
+    double const dy = span.getY() - centroid.getY();
+    int const width = span.getWidth();
+    for (int i = 0; i < width; ++i) {
+        double const dx = span.getMinX() + i - centroid.getX();
+        float const data = image[i];
+        accumulatorRaw(dx, dy, weights[i], data);
+        float const mu = BlendednessAlgorithm::computeAbsExpectation(data, variance[i]);
+        float const bias = BlendednessAlgorithm::computeAbsBias(mu, variance[i]);
+        accumulatorAbs(dx, dy, weights[i], std::abs(data) - bias);
+    }
+}
+
+// Pointer to the first pixel of a span in an image.
+float const* getSpanPixels(ndarray::Array<float const, 2, 1> const& array, geom::Point2I const& xy0,
+                           afw::geom::Span const& span) {
+    return array[span.getY() - xy0.getY()].getData() + (span.getMinX() - xy0.getX());
+}
+
+/*
+ * Accumulate the weighted moments of the pixels of a region in an image which contains it.
+ */
+template <typename Accumulator>
+void computeMoments(BlendednessAlgorithm::ChildPixels const& region,
+                    afw::image::MaskedImage<float> const& image, Accumulator& accumulatorRaw,
+                    Accumulator& accumulatorAbs) {
+    ndarray::Array<float const, 2, 1> const imageArray = image.getImage()->getArray();
+    ndarray::Array<float const, 2, 1> const varianceArray = image.getVariance()->getArray();
+    geom::Point2I const xy0 = image.getXY0();
+    float const* weights = region.weights.data();
+    for (auto const& span : region.spans) {
+        accumulateSpan(span, region.centroid, weights, getSpanPixels(imageArray, xy0, span),
+                       getSpanPixels(varianceArray, xy0, span), accumulatorRaw, accumulatorAbs);
+        weights += span.getWidth();
+    }
+}
+
+/*
+ * Accumulate the weighted moments of the pixels captured with a region.
+ */
+template <typename Accumulator>
+void computeMoments(BlendednessAlgorithm::ChildPixels const& region, Accumulator& accumulatorRaw,
+                    Accumulator& accumulatorAbs) {
+    std::size_t offset = 0;
+    for (auto const& span : region.spans) {
+        accumulateSpan(span, region.centroid, region.weights.data() + offset, region.image.data() + offset,
+                       region.variance.data() + offset, accumulatorRaw, accumulatorAbs);
+        offset += span.getWidth();
+    }
+}
+
+/*
+ * Accumulate the weighted moments of the pixels captured with a region and, with the same weights, of the
+ * same pixels in an image which contains the region.
+ */
+template <typename Accumulator>
+void computeMoments(BlendednessAlgorithm::ChildPixels const& region,
+                    afw::image::MaskedImage<float> const& image, Accumulator& childRaw,
+                    Accumulator& childAbs, Accumulator& parentRaw, Accumulator& parentAbs) {
+    ndarray::Array<float const, 2, 1> const imageArray = image.getImage()->getArray();
+    ndarray::Array<float const, 2, 1> const varianceArray = image.getVariance()->getArray();
+    geom::Point2I const xy0 = image.getXY0();
+    std::size_t offset = 0;
+    for (auto const& span : region.spans) {
+        float const* weights = region.weights.data() + offset;
+        accumulateSpan(span, region.centroid, weights, region.image.data() + offset,
+                       region.variance.data() + offset, childRaw, childAbs);
+        accumulateSpan(span, region.centroid, weights, getSpanPixels(imageArray, xy0, span),
+                       getSpanPixels(varianceArray, xy0, span), parentRaw, parentAbs);
+        offset += span.getWidth();
+    }
+}
+
+void setMoments(afw::table::SourceRecord& record, FluxAccumulator const& accumulatorRaw,
+                FluxAccumulator const& accumulatorAbs, afw::table::Key<double> const& instFluxRawKey,
+                afw::table::Key<double> const& instFluxAbsKey, ShapeResultKey const&, ShapeResultKey const&,
+                bool) {
+    record.set(instFluxRawKey, accumulatorRaw.getFlux());
+    record.set(instFluxAbsKey, std::max(accumulatorAbs.getFlux(), 0.0));
+}
+
+void setMoments(afw::table::SourceRecord& record, ShapeAccumulator const& accumulatorRaw,
+                ShapeAccumulator const& accumulatorAbs, afw::table::Key<double> const& instFluxRawKey,
+                afw::table::Key<double> const& instFluxAbsKey, ShapeResultKey const& shapeRawKey,
+                ShapeResultKey const& shapeAbsKey, bool doFlux) {
+    if (doFlux) {
+        setMoments(record, static_cast<FluxAccumulator const&>(accumulatorRaw),
+                   static_cast<FluxAccumulator const&>(accumulatorAbs), instFluxRawKey, instFluxAbsKey,
+                   shapeRawKey, shapeAbsKey, doFlux);
+    }
+    shapeRawKey.set(record, accumulatorRaw.getShape());
+    shapeAbsKey.set(record, accumulatorAbs.getShape());
+}
+
+// Regions for sources measured by a thread, reused to avoid allocating for each.
+BlendednessAlgorithm::ChildPixels& getRegionBuffer() {
+    thread_local BlendednessAlgorithm::ChildPixels region;
+    return region;
+}
+
 }  // namespace
 
 BlendednessAlgorithm::BlendednessAlgorithm(Control const& ctrl, std::string const& name,
@@ -273,12 +375,7 @@ float BlendednessAlgorithm::computeAbsBias(float mu, float variance) {
            mu * std::erfc(mu / std::sqrt(2.0f * variance));
 }
 
-void BlendednessAlgorithm::_measureMoments(afw::image::MaskedImage<float> const& image,
-                                           afw::table::SourceRecord& child,
-                                           afw::table::Key<double> const& instFluxRawKey,
-                                           afw::table::Key<double> const& instFluxAbsKey,
-                                           ShapeResultKey const& _shapeRawKey,
-                                           ShapeResultKey const& _shapeAbsKey) const {
+bool BlendednessAlgorithm::_checkInputs(afw::table::SourceRecord& child) const {
     if (_ctrl.doFlux || _ctrl.doShape) {
         if (!child.getTable()->getCentroidSlot().getMeasKey().isValid()) {
             throw LSST_EXCEPT(pex::exceptions::LogicError,
@@ -319,27 +416,71 @@ void BlendednessAlgorithm::_measureMoments(afw::image::MaskedImage<float> const&
             _flagHandler.setValue(child, FAILURE.number, true);
             fatal = true;
         }
-        if (fatal) return;
+        if (fatal) return false;
     }
+    return true;
+}
 
+void BlendednessAlgorithm::_measureMoments(afw::image::MaskedImage<float> const& image,
+                                           afw::table::SourceRecord& child,
+                                           afw::table::Key<double> const& instFluxRawKey,
+                                           afw::table::Key<double> const& instFluxAbsKey,
+                                           ShapeResultKey const& _shapeRawKey,
+                                           ShapeResultKey const& _shapeAbsKey) const {
+    if (!_checkInputs(child) || !(_ctrl.doShape || _ctrl.doFlux)) {
+        return;
+    }
+    ChildPixels& region = getRegionBuffer();
+    computeWeights(image.getBBox(afw::image::PARENT), child.getCentroid(), child.getShape(),
+                   _ctrl.nSigmaWeightMax, region);
     if (_ctrl.doShape) {
         ShapeAccumulator accumulatorRaw;
         ShapeAccumulator accumulatorAbs;
-        computeMoments(image, child.getCentroid(), child.getShape(), _ctrl.nSigmaWeightMax, accumulatorRaw,
-                       accumulatorAbs);
-        if (_ctrl.doFlux) {
-            child.set(instFluxRawKey, accumulatorRaw.getFlux());
-            child.set(instFluxAbsKey, std::max(accumulatorAbs.getFlux(), 0.0));
-        }
-        _shapeRawKey.set(child, accumulatorRaw.getShape());
-        _shapeAbsKey.set(child, accumulatorAbs.getShape());
-    } else if (_ctrl.doFlux) {
+        computeMoments(region, image, accumulatorRaw, accumulatorAbs);
+        setMoments(child, accumulatorRaw, accumulatorAbs, instFluxRawKey, instFluxAbsKey, _shapeRawKey,
+                   _shapeAbsKey, _ctrl.doFlux);
+    } else {
         FluxAccumulator accumulatorRaw;
         FluxAccumulator accumulatorAbs;
-        computeMoments(image, child.getCentroid(), child.getShape(), _ctrl.nSigmaWeightMax, accumulatorRaw,
-                       accumulatorAbs);
-        child.set(instFluxRawKey, accumulatorRaw.getFlux());
-        child.set(instFluxAbsKey, std::max(accumulatorAbs.getFlux(), 0.0));
+        computeMoments(region, image, accumulatorRaw, accumulatorAbs);
+        setMoments(child, accumulatorRaw, accumulatorAbs, instFluxRawKey, instFluxAbsKey, _shapeRawKey,
+                   _shapeAbsKey, _ctrl.doFlux);
+    }
+}
+
+template <typename Accumulator>
+void BlendednessAlgorithm::_measureCapturedMoments(ChildPixels const& childPixels,
+                                                   afw::image::MaskedImage<float> const& image,
+                                                   afw::table::SourceRecord& child) const {
+    Accumulator childRaw;
+    Accumulator childAbs;
+    if (!childPixels.isClipped && image.getBBox(afw::image::PARENT).contains(childPixels.bbox)) {
+        // The parent is measured over exactly the child's region, so both can share one pass.
+        Accumulator parentRaw;
+        Accumulator parentAbs;
+        computeMoments(childPixels, image, childRaw, childAbs, parentRaw, parentAbs);
+        setMoments(child, parentRaw, parentAbs, _instFluxParentRaw, _instFluxParentAbs, _shapeParentRaw,
+                   _shapeParentAbs, _ctrl.doFlux);
+    } else {
+        // The child's region was clipped to a smaller image than the parent's.
+        computeMoments(childPixels, childRaw, childAbs);
+        _measureMoments(image, child, _instFluxParentRaw, _instFluxParentAbs, _shapeParentRaw,
+                        _shapeParentAbs);
+    }
+    setMoments(child, childRaw, childAbs, _instFluxChildRaw, _instFluxChildAbs, _shapeChildRaw,
+               _shapeChildAbs, _ctrl.doFlux);
+}
+
+void BlendednessAlgorithm::_setBlendedness(afw::table::SourceRecord& child) const {
+    if (_ctrl.doFlux) {
+        child.set(_raw, 1.0 - child.get(_instFluxChildRaw) / child.get(_instFluxParentRaw));
+        child.set(_abs, 1.0 - child.get(_instFluxChildAbs) / child.get(_instFluxParentAbs));
+        if (child.get(_instFluxParentAbs) == 0.0) {
+            // We can get NaNs in the absolute measure if both parent and child have only negative
+            // biased-corrected instFluxes (which we clip to zero).  We can't really recover from this,
+            // so we should set the flag.
+            _flagHandler.setValue(child, FAILURE.number, true);
+        }
     }
 }
 
@@ -354,15 +495,58 @@ void BlendednessAlgorithm::measureParentPixels(afw::image::MaskedImage<float> co
         child.set(_old, computeOldBlendedness(child.getFootprint(), *image.getImage()));
     }
     _measureMoments(image, child, _instFluxParentRaw, _instFluxParentAbs, _shapeParentRaw, _shapeParentAbs);
-    if (_ctrl.doFlux) {
-        child.set(_raw, 1.0 - child.get(_instFluxChildRaw) / child.get(_instFluxParentRaw));
-        child.set(_abs, 1.0 - child.get(_instFluxChildAbs) / child.get(_instFluxParentAbs));
-        if (child.get(_instFluxParentAbs) == 0.0) {
-            // We can get NaNs in the absolute measure if both parent and child have only negative
-            // biased-corrected instFluxes (which we clip to zero).  We can't really recover from this,
-            // so we should set the flag.
-            _flagHandler.setValue(child, FAILURE.number, true);
+    _setBlendedness(child);
+}
+
+std::shared_ptr<BlendednessAlgorithm::ChildPixels> BlendednessAlgorithm::captureChildPixels(
+        afw::image::MaskedImage<float> const& image, afw::table::SourceRecord& child) const {
+    if (!(_ctrl.doShape || _ctrl.doFlux) || !_checkInputs(child)) {
+        return nullptr;
+    }
+    auto childPixels = std::make_shared<ChildPixels>();
+    computeWeights(image.getBBox(afw::image::PARENT), child.getCentroid(), child.getShape(),
+                   _ctrl.nSigmaWeightMax, *childPixels);
+    childPixels->image.resize(childPixels->weights.size());
+    childPixels->variance.resize(childPixels->weights.size());
+    ndarray::Array<float const, 2, 1> const imageArray = image.getImage()->getArray();
+    ndarray::Array<float const, 2, 1> const varianceArray = image.getVariance()->getArray();
+    geom::Point2I const xy0 = image.getXY0();
+    std::size_t offset = 0;
+    for (auto const& span : childPixels->spans) {
+        float const* imagePixels = getSpanPixels(imageArray, xy0, span);
+        float const* variancePixels = getSpanPixels(varianceArray, xy0, span);
+        std::copy(imagePixels, imagePixels + span.getWidth(), childPixels->image.begin() + offset);
+        std::copy(variancePixels, variancePixels + span.getWidth(), childPixels->variance.begin() + offset);
+        offset += span.getWidth();
+    }
+    return childPixels;
+}
+
+void BlendednessAlgorithm::measureCapturedPixels(
+        afw::image::MaskedImage<float> const& image, afw::table::SourceCatalog& catalog,
+        std::vector<std::shared_ptr<ChildPixels const>> const& childPixels) const {
+    if (childPixels.size() != catalog.size()) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("Number of captured children (%d) does not match catalog (%d)") %
+                           childPixels.size() % catalog.size())
+                                  .str());
+    }
+    for (std::size_t i = 0; i < catalog.size(); ++i) {
+        afw::table::SourceRecord& child = catalog[i];
+        if (!childPixels[i]) {
+            // Nothing to share: either there are no moments to measure, or the inputs are unusable.
+            measureParentPixels(image, child);
+            continue;
+        }
+        if (_ctrl.doOld) {
+            child.set(_old, computeOldBlendedness(child.getFootprint(), *image.getImage()));
+        }
+        if (_ctrl.doShape) {
+            _measureCapturedMoments<ShapeAccumulator>(*childPixels[i], image, child);
+        } else {
+            _measureCapturedMoments<FluxAccumulator>(*childPixels[i], image, child);
         }
+        _setBlendedness(child);
     }
 }
 
@@ -0,0 +1,145 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2019 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/meas/base/CachingPsf.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+CachingPsf::CachingPsf(std::shared_ptr<afw::detection::Psf const> psf, std::size_t capacity)
+        : afw::detection::Psf(false), _psf(psf), _capacity(capacity), _hits(0), _misses(0) {
+    if (!_psf) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "CachingPsf requires a Psf to wrap");
+    }
+    if (_capacity == 0) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "CachingPsf capacity must be positive");
+    }
+}
+
+void CachingPsf::clearCache() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+}
+
+std::size_t CachingPsf::getHitCount() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _hits;
+}
+
+std::size_t CachingPsf::getMissCount() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _misses;
+}
+
+std::shared_ptr<afw::detection::Psf> CachingPsf::clone() const {
+    return std::make_shared<CachingPsf>(_psf->clone(), _capacity);
+}
+
+std::shared_ptr<afw::detection::Psf> CachingPsf::resized(int width, int height) const {
+    return std::make_shared<CachingPsf>(_psf->resized(width, height), _capacity);
+}
+
+geom::Point2D CachingPsf::getAveragePosition() const { return _psf->getAveragePosition(); }
+
+CachingPsf::Entry &CachingPsf::_getEntry(geom::Point2D const &position) const {
+    // Search from the back: the most recently created entry is by far the most likely match.
+    for (auto iter = _entries.rbegin(); iter != _entries.rend(); ++iter) {
+        if (iter->position == position) {
+            return *iter;
+        }
+    }
+    if (_entries.size() >= _capacity) {
+        _entries.pop_front();
+    }
+    _entries.emplace_back(position);
+    return _entries.back();
+}
+
+// Realized and kernel images are already memoized by the base class (see Psf::setCacheSize), both here
+// and in the wrapped Psf, so we just forward those.
+std::shared_ptr<CachingPsf::Image> CachingPsf::doComputeImage(geom::Point2D const &position,
+                                                              afw::image::Color const &color) const {
+    return _psf->computeImage(position, color);
+}
+
+std::shared_ptr<CachingPsf::Image> CachingPsf::doComputeKernelImage(geom::Point2D const &position,
+                                                                    afw::image::Color const &color) const {
+    return _psf->computeKernelImage(position, color);
+}
+
+double CachingPsf::doComputeApertureFlux(double radius, geom::Point2D const &position,
+                                         afw::image::Color const &color) const {
+    if (!color.isIndeterminate()) {
+        return _psf->computeApertureFlux(radius, position, color);
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    Entry &entry = _getEntry(position);
+    auto iter = entry.apertureFlux.find(radius);
+    if (iter != entry.apertureFlux.end()) {
+        ++_hits;
+        return iter->second;
+    }
+    ++_misses;
+    double const flux = _psf->computeApertureFlux(radius, position, color);
+    entry.apertureFlux.emplace(radius, flux);
+    return flux;
+}
+
+afw::geom::ellipses::Quadrupole CachingPsf::doComputeShape(geom::Point2D const &position,
+                                                           afw::image::Color const &color) const {
+    if (!color.isIndeterminate()) {
+        return _psf->computeShape(position, color);
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    Entry &entry = _getEntry(position);
+    if (entry.hasShape) {
+        ++_hits;
+    } else {
+        ++_misses;
+        entry.shape = _psf->computeShape(position, color);
+        entry.hasShape = true;
+    }
+    return entry.shape;
+}
+
+geom::Box2I CachingPsf::doComputeBBox(geom::Point2D const &position, afw::image::Color const &color) const {
+    if (!color.isIndeterminate()) {
+        return _psf->computeBBox(position, color);
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    Entry &entry = _getEntry(position);
+    if (entry.hasBBox) {
+        ++_hits;
+    } else {
+        ++_misses;
+        entry.bbox = _psf->computeBBox(position, color);
+        entry.hasBBox = true;
+    }
+    return entry.bbox;
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
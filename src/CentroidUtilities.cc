@@ -25,7 +25,9 @@
 #include "lsst/geom/Angle.h"
 #include "lsst/geom/Point.h"
 #include "lsst/meas/base/CentroidUtilities.h"
+#include "lsst/meas/base/SpanIndex.h"
 #include "lsst/afw/table/BaseRecord.h"
+#include "lsst/afw/table/BaseColumnView.h"
 
 namespace lsst {
 namespace meas {
@@ -118,6 +120,24 @@ void CentroidResultKey::set(afw::table::BaseRecord &record, CentroidResult const
     }
 }
 
+std::vector<Centroid> CentroidResultKey::extractCentroids(afw::table::SourceCatalog const &catalog) const {
+    std::vector<Centroid> centroids;
+    centroids.reserve(catalog.size());
+    if (!catalog.isContiguous()) {
+        for (auto const &record : catalog) {
+            centroids.emplace_back(record.get(getX()), record.get(getY()));
+        }
+        return centroids;
+    }
+    afw::table::SourceColumnView const columns = catalog.getColumnView();
+    ndarray::Array<CentroidElement const, 1> const x = columns[getX()];
+    ndarray::Array<CentroidElement const, 1> const y = columns[getY()];
+    for (std::size_t i = 0; i < catalog.size(); ++i) {
+        centroids.emplace_back(x[i], y[i]);
+    }
+    return centroids;
+}
+
 CentroidTransform::CentroidTransform(std::string const &name, afw::table::SchemaMapper &mapper)
         : BaseTransform{name} {
     // Map the flag through to the output
@@ -146,23 +166,31 @@ void CentroidTransform::operator()(afw::table::SourceCatalog const &inputCatalog
                                    afw::image::PhotoCalib const &photoCalib) const {
     checkCatalogSize(inputCatalog, outputCatalog);
     CentroidResultKey centroidResultKey(inputCatalog.getSchema()[_name]);
+    bool const hasErr = centroidResultKey.getCentroidErr().isValid();
 
+    // Transform all the centroids (and linearize the WCS at them, if there are errors to transform)
+    // with a single call to the WCS.
+    std::vector<Centroid> const centroids = centroidResultKey.extractCentroids(inputCatalog);
+    std::vector<geom::SpherePoint> coords;
+    ndarray::Array<double, 3, 3> jacobians;
+    if (hasErr) {
+        jacobians = computePixelToSkyJacobians(wcs, centroids, &coords);
+    } else {
+        coords = wcs.pixelToSky(centroids);
+    }
+
+    std::size_t i = 0;
     afw::table::SourceCatalog::const_iterator inSrc = inputCatalog.begin();
     afw::table::BaseCatalog::iterator outSrc = outputCatalog.begin();
+    for (; inSrc != inputCatalog.end() && outSrc != outputCatalog.end(); ++inSrc, ++outSrc, ++i) {
+        _coordKey.set(*outSrc, coords[i]);
 
-    for (; inSrc != inputCatalog.end() && outSrc != outputCatalog.end(); ++inSrc, ++outSrc) {
-        CentroidResult centroidResult = centroidResultKey.get(*inSrc);
-
-        _coordKey.set(*outSrc, wcs.pixelToSky(centroidResult.getCentroid()));
-
-        if (centroidResultKey.getCentroidErr().isValid()) {
-            CentroidCov centroidCov = centroidResult.getCentroidErr();
+        if (hasErr) {
+            CentroidCov centroidCov = centroidResultKey.getCentroidErr().get(*inSrc);
             if (!(std::isnan(centroidCov(0, 0)) || std::isnan(centroidCov(1, 1)))) {
-                auto transform = wcs.linearizePixelToSky(centroidResult.getCentroid(), geom::radians)
-                                         .getLinear()
-                                         .getMatrix();
-                _coordErrKey.set(*outSrc, (transform * centroidResult.getCentroidErr().cast<double>() *
-                                           transform.transpose())
+                Eigen::Matrix2d transform;
+                transform << jacobians[i][0][0], jacobians[i][0][1], jacobians[i][1][0], jacobians[i][1][1];
+                _coordErrKey.set(*outSrc, (transform * centroidCov.cast<double>() * transform.transpose())
                                                   .cast<ErrElement>());
             }
         }
@@ -224,7 +252,8 @@ bool CentroidChecker::operator()(afw::table::SourceRecord &record) const {
     CentroidElement footX = footprint->getPeaks().front().getFx();
     CentroidElement footY = footprint->getPeaks().front().getFy();
     double distsq = (x - footX) * (x - footX) + (y - footY) * (y - footY);
-    if ((_doFootprintCheck && !footprint->contains(geom::Point2I(geom::Point2D(x, y)))) ||
+    // Large footprints are tested with an index shared by all the checkers of the record.
+    if ((_doFootprintCheck && !containsPoint(footprint->getSpans(), geom::Point2I(geom::Point2D(x, y)))) ||
         ((_maxDistFromPeak > 0) && (distsq > _maxDistFromPeak * _maxDistFromPeak))) {
         record.set(_xKey, footX);
         record.set(_yKey, footY);
@@ -34,26 +34,42 @@ CircularApertureFluxAlgorithm::CircularApertureFluxAlgorithm(Control const& ctrl
                                                              afw::table::Schema& schema,
                                                              daf::base::PropertySet& metadata)
         : ApertureFluxAlgorithm(ctrl, name, schema, metadata) {
+    std::vector<std::pair<float, float>> sincRadii;
     for (std::size_t i = 0; i < ctrl.radii.size(); ++i) {
         if (ctrl.radii[i] > ctrl.maxSincRadius) break;
-        SincCoeffs<float>::cache(0.0, ctrl.radii[i]);
+        sincRadii.emplace_back(0.0, ctrl.radii[i]);
     }
+    SincCoeffs<float>::cacheAll(sincRadii);
 }
 
 void CircularApertureFluxAlgorithm::measure(afw::table::SourceRecord& measRecord,
                                             afw::image::Exposure<float> const& exposure) const {
-    afw::geom::ellipses::Ellipse ellipse(afw::geom::ellipses::Axes(1.0, 1.0, 0.0));
-    PTR(afw::geom::ellipses::Axes)
-    axes = std::static_pointer_cast<afw::geom::ellipses::Axes>(ellipse.getCorePtr());
+    _measure(measRecord, exposure.getMaskedImage());
+}
+
+void CircularApertureFluxAlgorithm::measureBatch(afw::table::SourceCatalog& measCat,
+                                                 afw::image::Exposure<float> const& exposure,
+                                                 std::vector<std::size_t> const& indices) const {
+    afw::image::MaskedImage<float> const image = exposure.getMaskedImage();
+    measureEach(measCat, indices, [this, &image](afw::table::SourceRecord& measRecord) {
+        _measure(measRecord, image);
+        return MeasurementStatus();
+    });
+}
+
+void CircularApertureFluxAlgorithm::_measure(afw::table::SourceRecord& measRecord,
+                                             afw::image::MaskedImage<float> const& image) const {
+    // The centroid extractor sets the general failure flag of the FlagHandler it is given when
+    // it has to fall back to the footprint peak; we propagate that to the other radii.
+    geom::Point2D const center = _centroidExtractor(measRecord, getFlagHandler(0));
+    bool const centroidFailed = getFlagHandler(0).getValue(measRecord, FAILURE.number);
+    std::vector<ApertureFluxAlgorithm::Result> results =
+            computeFluxes(image, center, _ctrl);
     for (std::size_t i = 0; i < _ctrl.radii.size(); ++i) {
-        // Each call to _centroidExtractor within this loop goes through exactly the same error-checking
-        // logic and returns the same result, but it's not expensive logic, so we just call it repeatedly
-        // instead of coming up with a new interface that would allow us to move it outside the loop.
-        ellipse.setCenter(_centroidExtractor(measRecord, getFlagHandler(i)));
-        axes->setA(_ctrl.radii[i]);
-        axes->setB(_ctrl.radii[i]);
-        ApertureFluxAlgorithm::Result result = computeFlux(exposure.getMaskedImage(), ellipse, _ctrl);
-        copyResultToRecord(result, measRecord, i);
+        if (centroidFailed) {
+            getFlagHandler(i).setValue(measRecord, FAILURE.number, true);
+        }
+        copyResultToRecord(results[i], measRecord, i);
     }
 }
 
@@ -0,0 +1,105 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2019 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include <array>
+#include <cmath>
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/meas/base/CounterBasedNoise.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+namespace {
+
+typedef std::array<std::uint32_t, 4> Counter;
+
+// Philox4x32 with 10 rounds (Salmon et al. 2011, "Parallel random numbers: as easy as 1, 2, 3").
+Counter philox4x32(Counter ctr, std::uint32_t k0, std::uint32_t k1) {
+    std::uint64_t const M0 = 0xD2511F53;
+    std::uint64_t const M1 = 0xCD9E8D57;
+    std::uint32_t const W0 = 0x9E3779B9;
+    std::uint32_t const W1 = 0xBB67AE85;
+    for (int round = 0; round < 10; ++round) {
+        std::uint64_t const p0 = M0 * ctr[0];
+        std::uint64_t const p1 = M1 * ctr[2];
+        ctr = {static_cast<std::uint32_t>(p1 >> 32) ^ ctr[1] ^ k0, static_cast<std::uint32_t>(p1),
+               static_cast<std::uint32_t>(p0 >> 32) ^ ctr[3] ^ k1, static_cast<std::uint32_t>(p0)};
+        k0 += W0;
+        k1 += W1;
+    }
+    return ctr;
+}
+
+void checkContains(geom::Box2I const& outer, afw::geom::SpanSet const& spans) {
+    if (!spans.empty() && !outer.contains(spans.getBBox())) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError, "SpanSet extends beyond the image to be filled");
+    }
+}
+
+}  // namespace
+
+double CounterBasedNoise::getDeviate(afw::table::RecordId id, int x, int y) const {
+    std::uint64_t const uid = static_cast<std::uint64_t>(id);
+    Counter const r = philox4x32({static_cast<std::uint32_t>(x), static_cast<std::uint32_t>(y),
+                                  static_cast<std::uint32_t>(uid), static_cast<std::uint32_t>(uid >> 32)},
+                                 static_cast<std::uint32_t>(_seed), static_cast<std::uint32_t>(_seed >> 32));
+    // Box-Muller; u1 is in (0, 1) so the logarithm is always finite.
+    double const u1 = (r[0] + 0.5) * (1.0 / 4294967296.0);
+    double const u2 = r[1] * (1.0 / 4294967296.0);
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+}
+
+void CounterBasedNoise::fillImage(afw::table::RecordId id, afw::geom::SpanSet const& spans,
+                                  afw::image::Image<float>& image, double mean, double std) const {
+    checkContains(image.getBBox(), spans);
+    auto array = image.getArray();
+    for (auto const& span : spans) {
+        int const y = span.getY();
+        auto row = array[y - image.getY0()];
+        for (int x = span.getMinX(); x <= span.getMaxX(); ++x) {
+            row[x - image.getX0()] = mean + std * getDeviate(id, x, y);
+        }
+    }
+}
+
+void CounterBasedNoise::fillImage(afw::table::RecordId id, afw::geom::SpanSet const& spans,
+                                  afw::image::Image<float>& image, afw::image::Image<float> const& variance,
+                                  double mean) const {
+    checkContains(image.getBBox(), spans);
+    checkContains(variance.getBBox(), spans);
+    auto array = image.getArray();
+    auto varArray = variance.getArray();
+    for (auto const& span : spans) {
+        int const y = span.getY();
+        auto row = array[y - image.getY0()];
+        auto varRow = varArray[y - variance.getY0()];
+        for (int x = span.getMinX(); x <= span.getMaxX(); ++x) {
+            row[x - image.getX0()] = mean + std::sqrt(varRow[x - variance.getX0()]) * getDeviate(id, x, y);
+        }
+    }
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
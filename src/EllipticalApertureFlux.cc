@@ -0,0 +1,224 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2019 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "boost/format.hpp"
+
+#include "lsst/afw/geom/ellipses/PixelRegion.h"
+#include "lsst/afw/table/Source.h"
+#include "lsst/meas/base/EllipticalApertureFlux.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+namespace {
+FlagDefinitionList flagDefinitions;
+}  // namespace
+
+FlagDefinition const EllipticalApertureFluxAlgorithm::FAILURE = flagDefinitions.addFailureFlag();
+FlagDefinition const EllipticalApertureFluxAlgorithm::BAD_KRON_RADIUS =
+        flagDefinitions.add("flag_badKronRadius", "Kron radius could not be computed");
+
+FlagDefinitionList const& EllipticalApertureFluxAlgorithm::getFlagDefinitions() { return flagDefinitions; }
+
+EllipticalApertureFluxAlgorithm::EllipticalApertureFluxAlgorithm(Control const& ctrl,
+                                                                 std::string const& name,
+                                                                 afw::table::Schema& schema)
+        : _ctrl(ctrl), _centroidExtractor(schema, name), _shapeExtractor(schema, name) {
+    _apCtrl.maxSincRadius = _ctrl.maxSincRadius;
+    _apCtrl.shiftKernel = _ctrl.shiftKernel;
+    _apCtrl.ellipticalCacheTolerance = _ctrl.ellipticalCacheTolerance;
+    _flagHandler = FlagHandler::addFields(
+            schema, name, getFlagDefinitions(),
+            _ctrl.useKronRadius ? FlagDefinitionList() : FlagDefinitionList({{BAD_KRON_RADIUS}}));
+    if (_ctrl.useKronRadius) {
+        _kronRadiusKey = schema.addField<float>(schema.join(name, "kronRadius"),
+                                                "determinant radius of the Kron ellipse", "pixel");
+    }
+    std::string const ellipseName = _ctrl.useKronRadius ? "Kron" : "Shape slot";
+    for (std::size_t i = 0; i < _ctrl.scales.size(); ++i) {
+        std::string const prefix = ApertureFluxAlgorithm::makeFieldPrefix(name, _ctrl.scales[i]);
+        std::string const doc =
+                (boost::format("instFlux within %g times the %s ellipse") % _ctrl.scales[i] % ellipseName)
+                        .str();
+        _instFluxKeys.push_back(FluxResultKey::addFields(schema, prefix, doc));
+        // Whether the sinc algorithm is used depends on the size of each source, so its flags are
+        // always present.
+        _apertureFlagHandlers.push_back(FlagHandler::addFields(
+                schema, prefix, ApertureFluxAlgorithm::getFlagDefinitions(),
+                _ctrl.ellipticalCacheTolerance > 0.0
+                        ? FlagDefinitionList()
+                        : FlagDefinitionList({{ApertureFluxAlgorithm::SINC_COEFFS_APPROXIMATE}})));
+    }
+}
+
+template <typename T>
+double EllipticalApertureFluxAlgorithm::computeKronScale(afw::image::Image<T> const& image,
+                                                         afw::geom::ellipses::Ellipse const& ellipse,
+                                                         double maxScale) {
+    afw::geom::ellipses::Axes const axes(ellipse.getCore());
+    afw::geom::ellipses::Quadrupole const moments(axes);
+    double const det = moments.getDeterminant();
+    double const cxx = moments.getIyy() / det;
+    double const cyy = moments.getIxx() / det;
+    double const cxy = -2.0 * moments.getIxy() / det;
+    geom::Point2D const center = ellipse.getCenter();
+    geom::Box2I const bbox = image.getBBox();
+    afw::geom::ellipses::PixelRegion region(afw::geom::ellipses::Ellipse(
+            afw::geom::ellipses::Axes(axes.getA() * maxScale, axes.getB() * maxScale, axes.getTheta()),
+            center));
+    double sum = 0.0;
+    double sumR = 0.0;
+    for (afw::geom::ellipses::PixelRegion::Iterator spanIter = region.begin(), spanEnd = region.end();
+         spanIter != spanEnd; ++spanIter) {
+        int const y = spanIter->getY();
+        if (y < bbox.getMinY() || y > bbox.getMaxY()) {
+            continue;
+        }
+        int const x0 = std::max(spanIter->getMinX(), bbox.getMinX());
+        int const x1 = std::min(spanIter->getMaxX(), bbox.getMaxX());
+        if (x0 > x1) {
+            continue;
+        }
+        double const dy = y - center.getY();
+        typename afw::image::Image<T>::x_iterator pixIter = image.x_at(x0 - image.getX0(), y - image.getY0());
+        for (int x = x0; x <= x1; ++x, ++pixIter) {
+            double const dx = x - center.getX();
+            double const r = std::sqrt(cxx * dx * dx + cxy * dx * dy + cyy * dy * dy);
+            sum += *pixIter;
+            sumR += r * (*pixIter);
+        }
+    }
+    return sum > 0.0 ? sumR / sum : std::numeric_limits<double>::quiet_NaN();
+}
+
+void EllipticalApertureFluxAlgorithm::measure(afw::table::SourceRecord& measRecord,
+                                              afw::image::Exposure<float> const& exposure) const {
+    geom::Point2D const center = _centroidExtractor(measRecord, _flagHandler);
+    afw::geom::ellipses::Axes axes(_shapeExtractor(measRecord, _flagHandler));
+    if (_ctrl.useKronRadius) {
+        double const kronScale = computeKronScale(*exposure.getMaskedImage().getImage(),
+                                                  afw::geom::ellipses::Ellipse(axes, center),
+                                                  _ctrl.kronMaxScale);
+        if (!(kronScale > 0.0)) {
+            throw LSST_EXCEPT(MeasurementError, BAD_KRON_RADIUS.doc, BAD_KRON_RADIUS.number);
+        }
+        axes = afw::geom::ellipses::Axes(axes.getA() * kronScale, axes.getB() * kronScale, axes.getTheta());
+        measRecord.set(_kronRadiusKey, axes.getDeterminantRadius());
+    }
+    std::vector<Result> const results = ApertureFluxAlgorithm::computeScaledFluxes(
+            exposure.getMaskedImage(), afw::geom::ellipses::Ellipse(axes, center), _ctrl.scales, _apCtrl);
+    // The extractors set our general failure flag if their inputs are flagged; we propagate that to
+    // every aperture.
+    bool const inputFailed = _flagHandler.getValue(measRecord, FAILURE.number);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        measRecord.set(_instFluxKeys[i], results[i]);
+        FlagHandler const& flags = _apertureFlagHandlers[i];
+        if (inputFailed || results[i].getFlag(ApertureFluxAlgorithm::FAILURE.number)) {
+            flags.setValue(measRecord, ApertureFluxAlgorithm::FAILURE.number, true);
+        }
+        if (results[i].getFlag(ApertureFluxAlgorithm::APERTURE_TRUNCATED.number)) {
+            flags.setValue(measRecord, ApertureFluxAlgorithm::APERTURE_TRUNCATED.number, true);
+        }
+        if (results[i].getFlag(ApertureFluxAlgorithm::SINC_COEFFS_TRUNCATED.number)) {
+            flags.setValue(measRecord, ApertureFluxAlgorithm::SINC_COEFFS_TRUNCATED.number, true);
+        }
+        if (results[i].getFlag(ApertureFluxAlgorithm::SINC_COEFFS_APPROXIMATE.number)) {
+            flags.setValue(measRecord, ApertureFluxAlgorithm::SINC_COEFFS_APPROXIMATE.number, true);
+        }
+    }
+}
+
+void EllipticalApertureFluxAlgorithm::fail(afw::table::SourceRecord& measRecord,
+                                           MeasurementError* error) const {
+    _flagHandler.handleFailure(measRecord, error);
+    for (std::size_t i = 0; i < _apertureFlagHandlers.size(); ++i) {
+        _apertureFlagHandlers[i].handleFailure(measRecord);
+    }
+}
+
+template double EllipticalApertureFluxAlgorithm::computeKronScale(afw::image::Image<float> const&,
+                                                                  afw::geom::ellipses::Ellipse const&,
+                                                                  double);
+template double EllipticalApertureFluxAlgorithm::computeKronScale(afw::image::Image<double> const&,
+                                                                  afw::geom::ellipses::Ellipse const&,
+                                                                  double);
+
+EllipticalApertureFluxTransform::EllipticalApertureFluxTransform(Control const& ctrl,
+                                                                 std::string const& name,
+                                                                 afw::table::SchemaMapper& mapper)
+        : BaseTransform(name) {
+    afw::table::Schema const& inputSchema = mapper.getInputSchema();
+    auto const mapFlags = [&mapper, &inputSchema](std::string const& prefix,
+                                                  FlagDefinitionList const& flagDefs) {
+        for (std::size_t j = 0; j < flagDefs.size(); ++j) {
+            std::string const flagName = inputSchema.join(prefix, flagDefs[j].name);
+            if (inputSchema.getNames().count(flagName)) {
+                mapper.addMapping(inputSchema.find<afw::table::Flag>(flagName).key);
+            }
+        }
+    };
+    mapFlags(name, EllipticalApertureFluxAlgorithm::getFlagDefinitions());
+    for (std::size_t i = 0; i < ctrl.scales.size(); ++i) {
+        std::string const prefix = ApertureFluxAlgorithm::makeFieldPrefix(name, ctrl.scales[i]);
+        mapFlags(prefix, ApertureFluxAlgorithm::getFlagDefinitions());
+        _instFluxKeys.push_back(FluxResultKey(inputSchema[prefix]));
+        _magKeys.push_back(MagResultKey::addFields(mapper.editOutputSchema(), prefix));
+    }
+}
+
+void EllipticalApertureFluxTransform::operator()(afw::table::SourceCatalog const& inputCatalog,
+                                                 afw::table::BaseCatalog& outputCatalog,
+                                                 afw::geom::SkyWcs const& wcs,
+                                                 afw::image::PhotoCalib const& photoCalib) const {
+    checkCatalogSize(inputCatalog, outputCatalog);
+    if (!inputCatalog.isContiguous()) {
+        afw::table::SourceCatalog::const_iterator inSrc = inputCatalog.begin();
+        afw::table::BaseCatalog::iterator outSrc = outputCatalog.begin();
+        for (; inSrc != inputCatalog.end() && outSrc != outputCatalog.end(); ++inSrc, ++outSrc) {
+            for (std::size_t i = 0; i < _instFluxKeys.size(); ++i) {
+                FluxResult instFluxResult = _instFluxKeys[i].get(*inSrc);
+                _magKeys[i].set(*outSrc, photoCalib.instFluxToMagnitude(instFluxResult.instFlux,
+                                                                        instFluxResult.instFluxErr));
+            }
+        }
+        return;
+    }
+    afw::table::SourceColumnView const columns = inputCatalog.getColumnView();
+    for (std::size_t i = 0; i < _instFluxKeys.size(); ++i) {
+        ndarray::Array<Flux const, 1> const instFlux = columns[_instFluxKeys[i].getInstFlux()];
+        ndarray::Array<FluxErrElement const, 1> const instFluxErr =
+                columns[_instFluxKeys[i].getInstFluxErr()];
+        afw::table::BaseCatalog::iterator outSrc = outputCatalog.begin();
+        for (std::size_t j = 0; outSrc != outputCatalog.end(); ++j, ++outSrc) {
+            _magKeys[i].set(*outSrc, photoCalib.instFluxToMagnitude(instFlux[j], instFluxErr[j]));
+        }
+    }
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -0,0 +1,95 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include <limits>
+#include <vector>
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/afw/cameraGeom/CameraSys.h"
+#include "lsst/afw/cameraGeom/Detector.h"
+#include "lsst/afw/table/Source.h"
+#include "lsst/meas/base/FPPosition.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+FPPositionAlgorithm::FPPositionAlgorithm(Control const& ctrl, std::string const& name,
+                                         afw::table::Schema& schema)
+        : _focalKey(afw::table::Point2DKey::addFields(schema, name, "Position on the focal plane", "mm")),
+          _failKey(schema.addField<afw::table::Flag>(schema.join(name, "flag"),
+                                                     "Set to True for any fatal failure")),
+          _missingDetectorKey(
+                  schema.addField<afw::table::Flag>(schema.join(name, "missingDetector", "flag"),
+                                                    "Set to True if detector object is missing")) {
+    _logName = name;
+}
+
+void FPPositionAlgorithm::measure(afw::table::SourceRecord& measRecord,
+                                  afw::image::Exposure<float> const& exposure) const {
+    auto const detector = exposure.getDetector();
+    if (!detector) {
+        measRecord.set(_missingDetectorKey, true);
+        measRecord.set(_focalKey, geom::Point2D(std::numeric_limits<double>::quiet_NaN(),
+                                                std::numeric_limits<double>::quiet_NaN()));
+        return;
+    }
+    measRecord.set(_focalKey, detector->transform(measRecord.getCentroid(), afw::cameraGeom::PIXELS,
+                                                  afw::cameraGeom::FOCAL_PLANE));
+}
+
+void FPPositionAlgorithm::measureBatch(afw::table::SourceCatalog& measCat,
+                                       afw::image::Exposure<float> const& exposure,
+                                       std::vector<std::size_t> const& indices) const {
+    auto const detector = exposure.getDetector();
+    auto const centroidKey = measCat.getTable()->getCentroidSlot().getMeasKey();
+    if (!detector || !centroidKey.isValid()) {
+        SingleFrameAlgorithm::measureBatch(measCat, exposure, indices);
+        return;
+    }
+    std::vector<geom::Point2D> centers;
+    centers.reserve(indices.size());
+    for (std::size_t index : indices) {
+        centers.push_back(measCat[index].get(centroidKey));
+    }
+    std::vector<geom::Point2D> focalPlane;
+    try {
+        focalPlane = detector->transform(centers, afw::cameraGeom::PIXELS, afw::cameraGeom::FOCAL_PLANE);
+    } catch (pex::exceptions::Exception&) {
+        // Find out which records cannot be transformed, one at a time.
+        SingleFrameAlgorithm::measureBatch(measCat, exposure, indices);
+        return;
+    }
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        measCat[indices[i]].set(_focalKey, focalPlane[i]);
+    }
+}
+
+void FPPositionAlgorithm::fail(afw::table::SourceRecord& measRecord, MeasurementError* error) const {
+    measRecord.set(_failKey, true);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
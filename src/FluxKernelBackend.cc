@@ -0,0 +1,116 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include <mutex>
+
+#include "lsst/meas/base/FluxKernelBackend.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+namespace {
+
+// Add the unmasked pixels among n consecutive pixels of a row, given pointers to the first of them;
+// if mask is null, all of the pixels are added.
+template <typename WeightingT>
+void addRow(ModelFitSums& sums, afw::detection::Psf::Pixel const* model, float const* data,
+            float const* variance, afw::image::MaskPixel const* mask, afw::image::MaskPixel badBits, int n,
+            WeightingT weighting) {
+    for (int i = 0; i < n; ++i) {
+        if (mask && (mask[i] & badBits)) {
+            continue;
+        }
+        double const m = model[i];
+        double const w = weighting(variance[i]);
+        sums.modelSum += m;
+        sums.modelNorm += m * m;
+        sums.modelSquared += w * m * m;
+        sums.modelData += w * m * data[i];
+        sums.modelSquaredVariance += w * w * m * m * variance[i];
+        ++sums.area;
+    }
+}
+
+// Accumulate the sums directly from the image rows, without building the fit region or flattening it
+// into intermediate arrays.
+template <typename WeightingT>
+ModelFitSums accumulate(afw::detection::Psf::Image const& psfImage,
+                        afw::image::MaskedImage<float> const& image, geom::Box2I const& bbox,
+                        afw::image::MaskPixel badBits, WeightingT weighting) {
+    ModelFitSums sums;
+    auto const model = psfImage.getArray();
+    auto const data = image.getImage()->getArray();
+    auto const variance = image.getVariance()->getArray();
+    auto const mask = image.getMask()->getArray();
+    int const mx = bbox.getMinX() - psfImage.getX0();
+    int const ix = bbox.getMinX() - image.getX0();
+    for (int y = bbox.getMinY(); y <= bbox.getMaxY(); ++y) {
+        int const my = y - psfImage.getY0();
+        int const iy = y - image.getY0();
+        addRow(sums, model[my].getData() + mx, data[iy].getData() + ix, variance[iy].getData() + ix,
+               badBits ? mask[iy].getData() + ix : nullptr, badBits, bbox.getWidth(), weighting);
+    }
+    return sums;
+}
+
+std::mutex defaultBackendMutex;
+std::shared_ptr<FluxKernelBackend const> defaultBackend = std::make_shared<CpuFluxKernelBackend>();
+
+}  // namespace
+
+ModelFitSums accumulateModelFit(afw::detection::Psf::Image const& model,
+                                afw::image::MaskedImage<float> const& image, geom::Box2I const& bbox,
+                                afw::image::MaskPixel badBits, bool useWeights) {
+    return useWeights ? accumulate(model, image, bbox, badBits, InverseVarianceWeight())
+                      : accumulate(model, image, bbox, badBits, UnitWeight());
+}
+
+std::shared_ptr<FluxKernelBackend const> FluxKernelBackend::getDefault() {
+    std::lock_guard<std::mutex> lock(defaultBackendMutex);
+    return defaultBackend;
+}
+
+void FluxKernelBackend::setDefault(std::shared_ptr<FluxKernelBackend const> backend) {
+    if (!backend) {
+        backend = std::make_shared<CpuFluxKernelBackend>();
+    }
+    std::lock_guard<std::mutex> lock(defaultBackendMutex);
+    defaultBackend.swap(backend);
+}
+
+std::vector<ModelFitSums> CpuFluxKernelBackend::accumulateModelFits(
+        std::vector<ModelStamp> const& stamps, afw::image::MaskedImage<float> const& image,
+        afw::image::MaskPixel badBits, bool useWeights) const {
+    std::vector<ModelFitSums> result;
+    result.reserve(stamps.size());
+    for (auto const& stamp : stamps) {
+        result.push_back(accumulateModelFit(*stamp.model, image, stamp.bbox, badBits, useWeights));
+    }
+    return result;
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -90,14 +90,22 @@ void FluxTransform::operator()(afw::table::SourceCatalog const& inputCatalog,
                                afw::image::PhotoCalib const& photoCalib) const {
     checkCatalogSize(inputCatalog, outputCatalog);
     FluxResultKey instFluxKey(inputCatalog.getSchema()[_name]);
-    afw::table::SourceCatalog::const_iterator inSrc = inputCatalog.begin();
-    afw::table::BaseCatalog::iterator outSrc = outputCatalog.begin();
-    {
+    if (!inputCatalog.isContiguous()) {
+        afw::table::SourceCatalog::const_iterator inSrc = inputCatalog.begin();
+        afw::table::BaseCatalog::iterator outSrc = outputCatalog.begin();
         for (; inSrc != inputCatalog.end() && outSrc != outputCatalog.end(); ++inSrc, ++outSrc) {
             FluxResult instFluxResult = instFluxKey.get(*inSrc);
             _magKey.set(*outSrc,
                         photoCalib.instFluxToMagnitude(instFluxResult.instFlux, instFluxResult.instFluxErr));
         }
+        return;
+    }
+    afw::table::SourceColumnView const columns = inputCatalog.getColumnView();
+    ndarray::Array<Flux const, 1> const instFlux = columns[instFluxKey.getInstFlux()];
+    ndarray::Array<FluxErrElement const, 1> const instFluxErr = columns[instFluxKey.getInstFluxErr()];
+    afw::table::BaseCatalog::iterator outSrc = outputCatalog.begin();
+    for (std::size_t i = 0; outSrc != outputCatalog.end(); ++i, ++outSrc) {
+        _magKey.set(*outSrc, photoCalib.instFluxToMagnitude(instFlux[i], instFluxErr[i]));
     }
 }
 
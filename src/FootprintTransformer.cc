@@ -0,0 +1,264 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "boost/format.hpp"
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/afw/geom/transformFactory.h"
+#include "lsst/meas/base/FootprintTransformer.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+namespace {
+
+afw::detection::Footprint const& getFootprint(afw::table::SourceRecord const& record) {
+    std::shared_ptr<afw::detection::Footprint const> footprint = record.getFootprint();
+    if (!footprint) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("Record %d has no footprint") % record.getId()).str());
+    }
+    return *footprint;
+}
+
+std::vector<afw::detection::Footprint const*> getFootprints(afw::table::SourceCatalog const& catalog) {
+    std::vector<afw::detection::Footprint const*> footprints;
+    footprints.reserve(catalog.size());
+    for (auto const& record : catalog) {
+        footprints.push_back(&getFootprint(record));
+    }
+    return footprints;
+}
+
+}  // namespace
+
+FootprintTransformer::FootprintTransformer(afw::geom::SkyWcs const& source, afw::geom::SkyWcs const& target,
+                                           geom::Box2I const& region, int tileSize, double maxError)
+        : _transform(afw::geom::makeWcsPairTransform(source, target)),
+          _region(region),
+          _tileSize(tileSize),
+          _maxError(maxError),
+          _approximated(0) {
+    if (tileSize < 0) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("Tile size %d is negative") % tileSize).str());
+    }
+}
+
+std::shared_ptr<afw::detection::Footprint> FootprintTransformer::transform(
+        afw::detection::Footprint const& footprint) {
+    std::vector<afw::detection::Footprint const*> footprints(1, &footprint);
+    geom::AffineTransform const* affine = _selectApproximations(footprints).front();
+    if (!affine) {
+        return footprint.transform(_transform, _region);
+    }
+    auto result = std::make_shared<afw::detection::Footprint>(_transformSpans(footprint.getSpans(), affine),
+                                                              _region);
+    for (auto const& peak : footprint.getPeaks()) {
+        geom::Point2D const point = _transform->applyForward(geom::Point2D(peak.getFx(), peak.getFy()));
+        if (_region.contains(geom::Point2I(point))) {
+            result->addPeak(point.getX(), point.getY(), peak.getPeakValue());
+        }
+    }
+    return result;
+}
+
+std::vector<std::shared_ptr<afw::detection::Footprint>> FootprintTransformer::transformFootprints(
+        afw::table::SourceCatalog const& refCat) {
+    std::vector<afw::detection::Footprint const*> const footprints = getFootprints(refCat);
+    std::vector<geom::AffineTransform const*> const affines = _selectApproximations(footprints);
+
+    // Transform the peaks of all the approximated footprints with a single call to the exact mapping.
+    std::vector<geom::Point2D> peaks;
+    for (std::size_t i = 0; i < footprints.size(); ++i) {
+        if (affines[i]) {
+            for (auto const& peak : footprints[i]->getPeaks()) {
+                peaks.emplace_back(peak.getFx(), peak.getFy());
+            }
+        }
+    }
+    std::vector<geom::Point2D> const transformedPeaks = _transform->applyForward(peaks);
+
+    std::vector<std::shared_ptr<afw::detection::Footprint>> results;
+    results.reserve(footprints.size());
+    auto peakIter = transformedPeaks.begin();
+    for (std::size_t i = 0; i < footprints.size(); ++i) {
+        if (!affines[i]) {
+            results.push_back(footprints[i]->transform(_transform, _region));
+            continue;
+        }
+        auto result = std::make_shared<afw::detection::Footprint>(
+                _transformSpans(footprints[i]->getSpans(), affines[i]), _region);
+        for (auto const& peak : footprints[i]->getPeaks()) {
+            geom::Point2D const point = *peakIter++;
+            if (_region.contains(geom::Point2I(point))) {
+                result->addPeak(point.getX(), point.getY(), peak.getPeakValue());
+            }
+        }
+        results.push_back(std::move(result));
+    }
+    return results;
+}
+
+std::vector<std::shared_ptr<afw::geom::SpanSet>> FootprintTransformer::transformSpans(
+        afw::table::SourceCatalog const& refCat) {
+    std::vector<afw::detection::Footprint const*> const footprints = getFootprints(refCat);
+    std::vector<geom::AffineTransform const*> const affines = _selectApproximations(footprints);
+    std::vector<std::shared_ptr<afw::geom::SpanSet>> results;
+    results.reserve(footprints.size());
+    for (std::size_t i = 0; i < footprints.size(); ++i) {
+        std::shared_ptr<afw::geom::SpanSet> spans;
+        if (affines[i]) {
+            spans = _transformSpans(footprints[i]->getSpans(), affines[i]);
+        } else {
+            spans = footprints[i]->getSpans()->transformedBy(*_transform)->clippedTo(_region);
+        }
+        results.push_back(std::move(spans));
+    }
+    return results;
+}
+
+void FootprintTransformer::attachFootprints(afw::table::SourceCatalog& measCat,
+                                            afw::table::SourceCatalog const& refCat) {
+    if (measCat.size() != refCat.size()) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("Catalogs differ in length (%d != %d)") % measCat.size() %
+                           refCat.size())
+                                  .str());
+    }
+    std::vector<std::shared_ptr<afw::detection::Footprint>> const footprints = transformFootprints(refCat);
+    for (std::size_t i = 0; i < footprints.size(); ++i) {
+        measCat[i].setFootprint(footprints[i]);
+    }
+}
+
+std::vector<geom::AffineTransform const*> FootprintTransformer::_selectApproximations(
+        std::vector<afw::detection::Footprint const*> const& footprints) {
+    std::vector<geom::AffineTransform const*> affines(footprints.size(), nullptr);
+    if (_tileSize == 0) {
+        return affines;
+    }
+
+    // Evaluate the exact mapping at the corners of all the footprints' bounding boxes at once.
+    std::vector<geom::Point2D> corners;
+    corners.reserve(4 * footprints.size());
+    for (auto const* footprint : footprints) {
+        for (auto const& corner : geom::Box2D(footprint->getSpans()->getBBox()).getCorners()) {
+            corners.push_back(corner);
+        }
+    }
+    std::vector<geom::Point2D> const exact = _transform->applyForward(corners);
+
+    for (std::size_t i = 0; i < footprints.size(); ++i) {
+        geom::Box2I const bbox = footprints[i]->getSpans()->getBBox();
+        if (bbox.isEmpty()) {
+            continue;
+        }
+        geom::Point2D const center = geom::Box2D(bbox).getCenter();
+        std::pair<int, int> const key(static_cast<int>(std::floor(center.getX() / _tileSize)),
+                                      static_cast<int>(std::floor(center.getY() / _tileSize)));
+        auto iter = _tiles.find(key);
+        if (iter == _tiles.end()) {
+            geom::Point2D const tileCenter((key.first + 0.5) * _tileSize, (key.second + 0.5) * _tileSize);
+            iter = _tiles.emplace(key, afw::geom::linearizeTransform(*_transform, tileCenter)).first;
+        }
+        geom::AffineTransform const& affine = iter->second;
+        bool accurate = true;
+        for (std::size_t j = 0; j < 4 && accurate; ++j) {
+            accurate = (affine(corners[4 * i + j]) - exact[4 * i + j]).computeNorm() <= _maxError;
+        }
+        if (accurate) {
+            affines[i] = &affine;
+            ++_approximated;
+        }
+    }
+    return affines;
+}
+
+std::shared_ptr<afw::geom::SpanSet> FootprintTransformer::_transformSpans(
+        afw::geom::SpanSet const& spans, geom::AffineTransform const* affine) const {
+    // Index the spans of each source row; they are sorted by row and then by column.
+    geom::Box2I const sourceBBox = spans.getBBox();
+    int const y0 = sourceBBox.getMinY();
+    std::vector<afw::geom::Span> const sourceSpans(spans.begin(), spans.end());
+    std::vector<std::size_t> rowStart(sourceBBox.getHeight() + 1, 0);
+    for (auto const& span : sourceSpans) {
+        ++rowStart[span.getY() - y0 + 1];
+    }
+    std::partial_sum(rowStart.begin(), rowStart.end(), rowStart.begin());
+    auto contains = [&](geom::Point2I const& point) {
+        int const row = point.getY() - y0;
+        if (row < 0 || row >= sourceBBox.getHeight()) {
+            return false;
+        }
+        for (std::size_t k = rowStart[row]; k < rowStart[row + 1]; ++k) {
+            if (point.getX() >= sourceSpans[k].getX0() && point.getX() <= sourceSpans[k].getX1()) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // As SpanSet::transformedBy does, include each target pixel whose center maps back into the spans,
+    // over the target pixels covered by the transformed bounding box.
+    geom::Box2D targetBBoxD;
+    for (auto const& corner : geom::Box2D(sourceBBox).getCorners()) {
+        targetBBoxD.include((*affine)(corner));
+    }
+    geom::Box2I targetBBox(targetBBoxD);
+    targetBBox.clip(_region);
+    std::vector<afw::geom::Span> result;
+    if (targetBBox.isEmpty()) {
+        return std::make_shared<afw::geom::SpanSet>(std::move(result));
+    }
+    geom::AffineTransform const inverse = affine->inverted();
+    geom::Extent2D const step = inverse.getLinear()(geom::Extent2D(1.0, 0.0));
+    for (int y = targetBBox.getMinY(); y <= targetBBox.getMaxY(); ++y) {
+        geom::Point2D point = inverse(geom::Point2D(targetBBox.getMinX(), y));
+        int start = 0;
+        bool inSpan = false;
+        for (int x = targetBBox.getMinX(); x <= targetBBox.getMaxX(); ++x, point += step) {
+            bool const inside = contains(geom::Point2I(point));
+            if (inside && !inSpan) {
+                start = x;
+            } else if (!inside && inSpan) {
+                result.emplace_back(y, start, x - 1);
+            }
+            inSpan = inside;
+        }
+        if (inSpan) {
+            result.emplace_back(y, start, targetBBox.getMaxX());
+        }
+    }
+    return std::make_shared<afw::geom::SpanSet>(std::move(result));
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
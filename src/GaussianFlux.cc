@@ -21,6 +21,12 @@
  * see <http://www.lsstcorp.org/LegalNotices/>.
  */
 
+#include <cmath>
+#include <limits>
+#include <set>
+
+#include "boost/algorithm/string/replace.hpp"
+#include "boost/format.hpp"
 #include "ndarray/eigen.h"
 
 #include "lsst/afw/detection/Psf.h"
@@ -35,6 +41,7 @@ namespace meas {
 namespace base {
 namespace {
 FlagDefinitionList flagDefinitions;
+FlagDefinitionList multiScaleFlagDefinitions;
 }  // namespace
 
 FlagDefinition const GaussianFluxAlgorithm::FAILURE = flagDefinitions.addFailureFlag();
@@ -48,6 +55,20 @@ GaussianFluxAlgorithm::GaussianFluxAlgorithm(Control const& ctrl, std::string co
           _centroidExtractor(schema, name),
           _shapeExtractor(schema, name) {
     _flagHandler = FlagHandler::addFields(schema, name, getFlagDefinitions());
+    if (!_ctrl.doReuseWeightedSum) {
+        return;
+    }
+    // Like the extractors, look up the algorithm behind the shape slot now, so later changes to the
+    // slots don't change what we reuse.
+    std::string shapeName = schema.getAliasMap()->apply(schema.join("slot", "Shape"));
+    try {
+        _weightedSumKey = schema.find<double>(schema.join(shapeName, "weightedSum")).key;
+        _weightedSumCenterKey =
+                afw::table::PointKey<double>(schema[schema.join(shapeName, "weightedSumCenter")]);
+        _weightedSumShapeKey = afw::table::QuadrupoleKey(schema[shapeName]);
+    } catch (pex::exceptions::NotFoundError&) {
+        _weightedSumKey = afw::table::Key<double>();
+    }
 }
 
 void GaussianFluxAlgorithm::measure(afw::table::SourceRecord& measRecord,
@@ -55,8 +76,16 @@ void GaussianFluxAlgorithm::measure(afw::table::SourceRecord& measRecord,
     geom::Point2D centroid = _centroidExtractor(measRecord, _flagHandler);
     afw::geom::ellipses::Quadrupole shape = _shapeExtractor(measRecord, _flagHandler);
 
-    FluxResult result =
-            SdssShapeAlgorithm::computeFixedMomentsFlux(exposure.getMaskedImage(), shape, centroid);
+    FluxResult result;
+    double const weightedSum = _weightedSumKey.isValid() ? measRecord.get(_weightedSumKey)
+                                                         : std::numeric_limits<double>::quiet_NaN();
+    if (std::isfinite(weightedSum) && measRecord.get(_weightedSumCenterKey) == centroid &&
+        measRecord.get(_weightedSumShapeKey) == shape) {
+        result = SdssShapeAlgorithm::computeFixedMomentsFluxFromSum(exposure.getMaskedImage(), shape,
+                                                                    centroid, weightedSum);
+    } else {
+        result = SdssShapeAlgorithm::computeFixedMomentsFlux(exposure.getMaskedImage(), shape, centroid);
+    }
 
     measRecord.set(_instFluxResultKey, result);
     _flagHandler.setValue(measRecord, FAILURE.number, false);
@@ -66,6 +95,108 @@ void GaussianFluxAlgorithm::fail(afw::table::SourceRecord& measRecord, Measureme
     _flagHandler.handleFailure(measRecord, error);
 }
 
+FlagDefinition const MultiScaleGaussianFluxAlgorithm::FAILURE = multiScaleFlagDefinitions.addFailureFlag();
+
+FlagDefinitionList const& MultiScaleGaussianFluxAlgorithm::getFlagDefinitions() {
+    return multiScaleFlagDefinitions;
+}
+
+std::string MultiScaleGaussianFluxAlgorithm::makeFieldPrefix(std::string const& name, double scale) {
+    std::string prefix = (boost::format("%s_%.1f") % name % scale).str();
+    return boost::replace_all_copy(prefix, ".", "_");
+}
+
+MultiScaleGaussianFluxAlgorithm::MultiScaleGaussianFluxAlgorithm(Control const& ctrl,
+                                                                 std::string const& name,
+                                                                 afw::table::Schema& schema)
+        : _ctrl(ctrl), _centroidExtractor(schema, name), _shapeExtractor(schema, name) {
+    // The prefixes only keep one decimal place, so check that the scales don't share fields before
+    // adding any of them.
+    std::set<std::string> prefixes;
+    for (double scale : ctrl.scales) {
+        std::string const prefix = makeFieldPrefix(name, scale);
+        if (!prefixes.insert(prefix).second) {
+            throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                              (boost::format("Scale %g has the same field name prefix (%s) as another scale; "
+                                             "scales must differ by at least 0.1") %
+                               scale % prefix)
+                                      .str());
+        }
+    }
+    _instFluxResultKeys.reserve(ctrl.scales.size());
+    for (double scale : ctrl.scales) {
+        std::string doc =
+                (boost::format("instFlux from a Gaussian weight with the shape scaled by %g") % scale).str();
+        _instFluxResultKeys.push_back(FluxResultKey::addFields(schema, makeFieldPrefix(name, scale), doc));
+    }
+    _flagHandler = FlagHandler::addFields(schema, name, getFlagDefinitions());
+}
+
+void MultiScaleGaussianFluxAlgorithm::measure(afw::table::SourceRecord& measRecord,
+                                              afw::image::Exposure<float> const& exposure) const {
+    geom::Point2D centroid = _centroidExtractor(measRecord, _flagHandler);
+    afw::geom::ellipses::Quadrupole shape = _shapeExtractor(measRecord, _flagHandler);
+
+    std::vector<FluxResult> results = SdssShapeAlgorithm::computeFixedMomentsFluxes(
+            exposure.getMaskedImage(), shape, centroid, _ctrl.scales);
+
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        measRecord.set(_instFluxResultKeys[i], results[i]);
+    }
+    _flagHandler.setValue(measRecord, FAILURE.number, false);
+}
+
+void MultiScaleGaussianFluxAlgorithm::fail(afw::table::SourceRecord& measRecord,
+                                           MeasurementError* error) const {
+    _flagHandler.handleFailure(measRecord, error);
+}
+
+MultiScaleGaussianFluxTransform::MultiScaleGaussianFluxTransform(Control const& ctrl,
+                                                                 std::string const& name,
+                                                                 afw::table::SchemaMapper& mapper)
+        : BaseTransform(name), _ctrl(ctrl) {
+    mapper.addMapping(mapper.getInputSchema().find<afw::table::Flag>(name + "_flag").key);
+    for (double scale : _ctrl.scales) {
+        std::string const prefix = MultiScaleGaussianFluxAlgorithm::makeFieldPrefix(name, scale);
+        _magKeys.push_back(MagResultKey::addFields(mapper.editOutputSchema(), prefix));
+    }
+}
+
+void MultiScaleGaussianFluxTransform::operator()(afw::table::SourceCatalog const& inputCatalog,
+                                                 afw::table::BaseCatalog& outputCatalog,
+                                                 afw::geom::SkyWcs const& wcs,
+                                                 afw::image::PhotoCalib const& photoCalib) const {
+    checkCatalogSize(inputCatalog, outputCatalog);
+    if (!inputCatalog.isContiguous()) {
+        std::vector<FluxResultKey> instFluxKeys;
+        for (double scale : _ctrl.scales) {
+            std::string const prefix = MultiScaleGaussianFluxAlgorithm::makeFieldPrefix(_name, scale);
+            instFluxKeys.push_back(FluxResultKey(inputCatalog.getSchema()[prefix]));
+        }
+        afw::table::SourceCatalog::const_iterator inSrc = inputCatalog.begin();
+        afw::table::BaseCatalog::iterator outSrc = outputCatalog.begin();
+        for (; inSrc != inputCatalog.end() && outSrc != outputCatalog.end(); ++inSrc, ++outSrc) {
+            for (std::size_t i = 0; i < instFluxKeys.size(); ++i) {
+                FluxResult instFluxResult = instFluxKeys[i].get(*inSrc);
+                _magKeys[i].set(*outSrc, photoCalib.instFluxToMagnitude(instFluxResult.instFlux,
+                                                                        instFluxResult.instFluxErr));
+            }
+        }
+        return;
+    }
+    afw::table::SourceColumnView const columns = inputCatalog.getColumnView();
+    for (std::size_t i = 0; i < _ctrl.scales.size(); ++i) {
+        FluxResultKey instFluxKey(inputCatalog.getSchema()[MultiScaleGaussianFluxAlgorithm::makeFieldPrefix(
+                _name, _ctrl.scales[i])]);
+        ndarray::Array<Flux const, 1> const instFlux = columns[instFluxKey.getInstFlux()];
+        ndarray::Array<FluxErrElement const, 1> const instFluxErr = columns[instFluxKey.getInstFluxErr()];
+        afw::table::BaseCatalog::iterator outSrc = outputCatalog.begin();
+        for (std::size_t j = 0; outSrc != outputCatalog.end(); ++j, ++outSrc) {
+            _magKeys[i].set(*outSrc, photoCalib.instFluxToMagnitude(instFlux[j], instFluxErr[j]));
+        }
+    }
+}
+
 }  // namespace base
 }  // namespace meas
 }  // namespace lsst
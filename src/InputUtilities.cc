@@ -22,6 +22,7 @@
  */
 
 #include <cmath>
+#include <limits>
 
 #include "lsst/afw/table/Source.h"
 #include "lsst/afw/detection/Footprint.h"
@@ -83,46 +84,61 @@ geom::Point2D extractPeak(afw::table::SourceRecord const& record, std::string co
 
 geom::Point2D SafeCentroidExtractor::operator()(afw::table::SourceRecord& record,
                                                 FlagHandler const& flags) const {
-    if (!record.getTable()->getCentroidSlot().getMeasKey().isValid()) {
-        if (_isCentroider) {
-            return extractPeak(record, _name);
-        } else {
-            throw LSST_EXCEPT(
-                    FatalAlgorithmError,
-                    (boost::format("%s requires a centroid, but the centroid slot is not defined") % _name)
-                            .str());
-        }
+    return bind(*record.getTable())(record, flags);
+}
+
+SafeCentroidExtractor::Bound::Bound(SafeCentroidExtractor const& parent,
+                                    afw::table::SourceTable const& table)
+        : _parent(&parent),
+          _measKey(table.getCentroidSlot().getMeasKey()),
+          _flagKey(table.getCentroidSlot().getFlagKey()) {
+    if (!_measKey.isValid() && !_parent->_isCentroider) {
+        throw LSST_EXCEPT(
+                FatalAlgorithmError,
+                (boost::format("%s requires a centroid, but the centroid slot is not defined") %
+                 _parent->_name)
+                        .str());
+    }
+}
+
+SafeCentroidExtractor::Result SafeCentroidExtractor::Bound::extract(afw::table::SourceRecord& record,
+                                                                    FlagHandler const& flags) const {
+    std::string const& name = _parent->_name;
+    bool const isCentroider = _parent->_isCentroider;
+    if (!_measKey.isValid()) {
+        // only possible for centroiders; see the constructor
+        return Result{extractPeak(record, name), true};
     }
-    geom::Point2D result = record.getCentroid();
-    if (std::isnan(result.getX()) || std::isnan(result.getY())) {
-        if (!record.getTable()->getCentroidSlot().getFlagKey().isValid()) {
-            if (_isCentroider) {
-                return extractPeak(record, _name);
+    Result result{record.get(_measKey), false};
+    if (std::isnan(result.position.getX()) || std::isnan(result.position.getY())) {
+        if (!_flagKey.isValid()) {
+            if (isCentroider) {
+                return Result{extractPeak(record, name), true};
             } else {
                 throw LSST_EXCEPT(
                         pex::exceptions::RuntimeError,
                         (boost::format(
                                  "%s: Centroid slot value is NaN, but there is no Centroid slot flag "
                                  "(is the executionOrder for %s lower than that of the slot Centroid?)") %
-                         _name % _name)
+                         name % name)
                                 .str());
             }
         }
-        if (!record.getCentroidFlag() && !_isCentroider) {
+        if (!record.get(_flagKey) && !isCentroider) {
             throw LSST_EXCEPT(
                     pex::exceptions::RuntimeError,
                     (boost::format("%s: Centroid slot value is NaN, but the Centroid slot flag is not set "
                                    "(is the executionOrder for %s lower than that of the slot Centroid?)") %
-                     _name % _name)
+                     name % name)
                             .str());
         }
-        result = extractPeak(record, _name);
-        if (!_isCentroider) {
+        result.position = extractPeak(record, name);
+        result.usedPeak = true;
+        if (!isCentroider) {
             // set the general flag, because using the Peak might affect the current measurement
             flags.setValue(record, flags.getFailureFlagNumber(), true);
         }
-    } else if (!_isCentroider && record.getTable()->getCentroidSlot().getFlagKey().isValid() &&
-               record.getCentroidFlag()) {
+    } else if (!isCentroider && _flagKey.isValid() && record.get(_flagKey)) {
         // we got a usable value, but the centroid flag is still be set, and that might affect
         // the current measurement
         flags.setValue(record, flags.getFailureFlagNumber(), true);
@@ -130,6 +146,27 @@ geom::Point2D SafeCentroidExtractor::operator()(afw::table::SourceRecord& record
     return result;
 }
 
+ndarray::Array<double, 2, 2> SafeCentroidExtractor::extractAll(afw::table::SourceCatalog& catalog,
+                                                               FlagHandler const& flags) const {
+    Bound const bound = bind(*catalog.getTable());
+    ndarray::Array<double, 2, 2> result = ndarray::allocate(catalog.size(), 2);
+    std::size_t i = 0;
+    for (afw::table::SourceCatalog::iterator record = catalog.begin(); record != catalog.end();
+         ++record, ++i) {
+        try {
+            geom::Point2D const position = bound(*record, flags);
+            result[i][0] = position.getX();
+            result[i][1] = position.getY();
+        } catch (FatalAlgorithmError&) {
+            throw;
+        } catch (pex::exceptions::RuntimeError&) {
+            result[i][0] = std::numeric_limits<double>::quiet_NaN();
+            result[i][1] = std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+    return result;
+}
+
 SafeShapeExtractor::SafeShapeExtractor(afw::table::Schema& schema, std::string const& name) : _name(name) {
     // Instead of aliasing e.g. MyAlgorithm_flag_badShape->slot_Shape_flag, we actually
     // look up the target of slot_Shape_flag, and alias that to MyAlgorithm_flag_badCentroid.
@@ -148,39 +185,52 @@ SafeShapeExtractor::SafeShapeExtractor(afw::table::Schema& schema, std::string c
 
 afw::geom::ellipses::Quadrupole SafeShapeExtractor::operator()(afw::table::SourceRecord& record,
                                                                FlagHandler const& flags) const {
-    if (!record.getTable()->getCentroidSlot().getMeasKey().isValid()) {
+    return bind(*record.getTable())(record, flags);
+}
+
+SafeShapeExtractor::Bound::Bound(SafeShapeExtractor const& parent, afw::table::SourceTable const& table)
+        : _parent(&parent),
+          _measKey(table.getShapeSlot().getMeasKey()),
+          _flagKey(table.getShapeSlot().getFlagKey()) {
+    if (!_measKey.isValid()) {
         throw LSST_EXCEPT(
                 FatalAlgorithmError,
-                (boost::format("%s requires a shape, but the shape slot is not defined") % _name).str());
+                (boost::format("%s requires a shape, but the shape slot is not defined") % _parent->_name)
+                        .str());
     }
-    afw::geom::ellipses::Quadrupole result = record.getShape();
+}
+
+afw::geom::ellipses::Quadrupole SafeShapeExtractor::Bound::operator()(afw::table::SourceRecord& record,
+                                                                      FlagHandler const& flags) const {
+    std::string const& name = _parent->_name;
+    afw::geom::ellipses::Quadrupole result = record.get(_measKey);
     if (std::isnan(result.getIxx()) || std::isnan(result.getIyy()) || std::isnan(result.getIxy()) ||
         result.getIxx() * result.getIyy() < (1.0 + 1.0e-6) * result.getIxy() * result.getIxy()
         // We are checking that Ixx*Iyy > (1 + epsilon)*Ixy*Ixy where epsilon is suitably small. The
         // value of epsilon used here is a magic number. DM-5801 is supposed to figure out if we are
         // to keep this value.
     ) {
-        if (!record.getTable()->getShapeSlot().getFlagKey().isValid()) {
+        if (!_flagKey.isValid()) {
             throw LSST_EXCEPT(
                     pex::exceptions::RuntimeError,
                     (boost::format("%s: Shape slot value is NaN, but there is no Shape slot flag "
                                    "(is the executionOrder for %s lower than that of the slot Shape?)") %
-                     _name % _name)
+                     name % name)
                             .str());
         }
-        if (!record.getShapeFlag()) {
+        if (!record.get(_flagKey)) {
             throw LSST_EXCEPT(
                     pex::exceptions::RuntimeError,
                     (boost::format("%s: Shape slot value is NaN, but the Shape slot flag is not set "
                                    "(is the executionOrder for %s lower than that of the slot Shape?)") %
-                     _name % _name)
+                     name % name)
                             .str());
         }
         throw LSST_EXCEPT(
                 MeasurementError,
-                (boost::format("%s: Shape needed, and Shape slot measurement failed.") % _name).str(),
+                (boost::format("%s: Shape needed, and Shape slot measurement failed.") % name).str(),
                 flags.getFailureFlagNumber());
-    } else if (record.getTable()->getShapeSlot().getFlagKey().isValid() && record.getShapeFlag()) {
+    } else if (_flagKey.isValid() && record.get(_flagKey)) {
         // we got a usable value, but the shape flag might still be set, and that might affect
         // the current measurement
         flags.setValue(record, flags.getFailureFlagNumber(), true);
@@ -188,6 +238,17 @@ afw::geom::ellipses::Quadrupole SafeShapeExtractor::operator()(afw::table::Sourc
     return result;
 }
 
+ndarray::Array<int, 1, 1> extractFootprintAreas(afw::table::SourceCatalog const& catalog) {
+    ndarray::Array<int, 1, 1> result = ndarray::allocate(catalog.size());
+    std::size_t i = 0;
+    for (afw::table::SourceCatalog::const_iterator record = catalog.begin(); record != catalog.end();
+         ++record, ++i) {
+        std::shared_ptr<afw::detection::Footprint> footprint = record->getFootprint();
+        result[i] = footprint ? static_cast<int>(footprint->getArea()) : 0;
+    }
+    return result;
+}
+
 }  // namespace base
 }  // namespace meas
 }  // namespace lsst
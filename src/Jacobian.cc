@@ -0,0 +1,109 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include <cmath>
+#include <vector>
+
+#include "lsst/geom/Angle.h"
+#include "lsst/pex/exceptions.h"
+#include "lsst/afw/table/Source.h"
+#include "lsst/meas/base/Jacobian.h"
+#include "lsst/meas/base/LocalWcs.h"
+#include "lsst/meas/base/ResultBuffer.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+JacobianAlgorithm::JacobianAlgorithm(Control const& ctrl, std::string const& name,
+                                     afw::table::Schema& schema)
+        : _ctrl(ctrl),
+          _scale(std::pow(ctrl.pixelScale, -2)),
+          _valueKey(schema.addField<double>(schema.join(name, "value"), "Jacobian correction")),
+          _failKey(schema.addField<afw::table::Flag>(schema.join(name, "flag"),
+                                                     "Set to 1 for any fatal failure")) {
+    _logName = name;
+}
+
+namespace {
+
+// Area of the pixel described by a local CD matrix in radians, in arcsec^2.
+double computePixelArea(ndarray::ArrayRef<double, 2, 2> const& matrix) {
+    double const radToArcsec = (1.0 * geom::radians).asArcseconds();
+    return std::abs(matrix[0][0] * matrix[1][1] - matrix[0][1] * matrix[1][0]) * radToArcsec * radToArcsec;
+}
+
+}  // namespace
+
+void JacobianAlgorithm::measure(afw::table::SourceRecord& measRecord,
+                                afw::image::Exposure<float> const& exposure) const {
+    auto const wcs = exposure.getWcs();
+    if (!wcs) {
+        throw LSST_EXCEPT(pex::exceptions::RuntimeError, "No WCS attached to exposure");
+    }
+    // Compute the area of a pixel at a source record's centroid, and take the ratio of that with the
+    // defined reference pixel area.
+    ndarray::Array<double, 3, 3> const matrix =
+            LocalWcsAlgorithm::computeLocalMatrices(*wcs, {measRecord.getCentroid()});
+    measRecord.set(_valueKey, _scale * computePixelArea(matrix[0]));
+}
+
+void JacobianAlgorithm::measureBatch(afw::table::SourceCatalog& measCat,
+                                     afw::image::Exposure<float> const& exposure,
+                                     std::vector<std::size_t> const& indices) const {
+    auto const wcs = exposure.getWcs();
+    auto const centroidKey = measCat.getTable()->getCentroidSlot().getMeasKey();
+    if (!wcs || !centroidKey.isValid()) {
+        // Every record fails; let the per-record loop report it.
+        SingleFrameAlgorithm::measureBatch(measCat, exposure, indices);
+        return;
+    }
+    std::vector<geom::Point2D> centers;
+    centers.reserve(indices.size());
+    for (std::size_t index : indices) {
+        centers.push_back(measCat[index].get(centroidKey));
+    }
+    ndarray::Array<double, 3, 3> matrices;
+    try {
+        matrices = LocalWcsAlgorithm::computeLocalMatrices(*wcs, centers);
+    } catch (pex::exceptions::Exception&) {
+        // Find out which records the WCS cannot be evaluated at, one at a time.
+        SingleFrameAlgorithm::measureBatch(measCat, exposure, indices);
+        return;
+    }
+    ResultBuffer results(indices.size());
+    ResultBuffer::Column<double> const values = results.addColumn(_valueKey);
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        values[i] = _scale * computePixelArea(matrices[i]);
+    }
+    results.commit(measCat, indices);
+}
+
+void JacobianAlgorithm::fail(afw::table::SourceRecord& measRecord, MeasurementError* error) const {
+    measRecord.set(_failKey, true);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
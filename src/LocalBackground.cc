@@ -21,21 +21,81 @@
  * see <http://www.lsstcorp.org/LegalNotices/>.
  */
 
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
 
-#include "lsst/afw/math/Statistics.h"
 #include "lsst/afw/table/Source.h"
 #include "lsst/log/Log.h"
-#include "lsst/afw/geom/SpanSet.h"
+#include "lsst/afw/geom/ellipses/PixelRegion.h"
 #include "lsst/afw/detection/Psf.h"
 #include "lsst/meas/base/LocalBackground.h"
+#include "lsst/meas/base/ScratchArena.h"
 
 namespace lsst {
 namespace meas {
 namespace base {
 namespace {
 FlagDefinitionList flagDefinitions;
+
+// Linearly-interpolated value at the given fraction of the sorted values, as computed by
+// afw::math::Statistics; reorders the values.
+double percentile(float* values, std::size_t n, double fraction) {
+    if (n == 1) {
+        return values[0];
+    }
+    double const idx = fraction * (n - 1);
+    std::size_t const q1 = static_cast<std::size_t>(idx);
+    std::nth_element(values, values + q1, values + n);
+    double const value1 = values[q1];
+    if (q1 + 1 >= n) {
+        return value1;
+    }
+    // The next value is the smallest of those above q1.
+    double const value2 = *std::min_element(values + q1 + 1, values + n);
+    return value1 + (idx - q1) * (value2 - value1);
+}
+
+/*
+ * Compute the sigma-clipped mean and standard deviation of the values, following the same procedure
+ * as afw::math::Statistics MEANCLIP/STDEVCLIP: start from the median, with a clipping width based on
+ * the interquartile range, then iteratively replace them with the mean and rms of the values within
+ * the clipping limits.  The values are reordered.
+ */
+std::pair<double, double> computeClippedStatistics(float* values, std::size_t nValues, double numSigmaClip,
+                                                   int numIter) {
+    double const IQ_TO_STDEV = 0.741301109252802;  // 1 sigma in units of the interquartile range
+    double const q1 = percentile(values, nValues, 0.25);
+    double const q3 = percentile(values, nValues, 0.75);
+    double center = percentile(values, nValues, 0.5);
+    double hwidth = numSigmaClip * IQ_TO_STDEV * (q3 - q1);
+    double variance = std::numeric_limits<double>::quiet_NaN();
+    for (int iter = 0; iter < numIter; ++iter) {
+        double const lower = center - hwidth;
+        double const upper = center + hwidth;
+        double sum = 0.0;
+        double sumSquares = 0.0;
+        std::size_t n = 0;
+        for (float const* value = values; value != values + nValues; ++value) {
+            if (*value >= lower && *value <= upper) {
+                sum += *value;
+                sumSquares += static_cast<double>(*value) * *value;
+                ++n;
+            }
+        }
+        if (n == 0) {
+            break;
+        }
+        center = sum / n;
+        variance = (n > 1) ? (sumSquares - center * sum) / (n - 1) : std::numeric_limits<double>::quiet_NaN();
+        hwidth = numSigmaClip * std::sqrt(variance);
+    }
+    return std::make_pair(center, std::sqrt(variance));
+}
+
 }  // namespace
 
 FlagDefinition const LocalBackgroundAlgorithm::FAILURE = flagDefinitions.addFailureFlag();
@@ -50,13 +110,17 @@ LocalBackgroundAlgorithm::LocalBackgroundAlgorithm(Control const& ctrl, std::str
         : _ctrl(ctrl),
           _resultKey(FluxResultKey::addFields(schema, name, "background in annulus around source")),
           _flagHandler(FlagHandler::addFields(schema, name, getFlagDefinitions())),
-          _centroidExtractor(schema, name),
-          _stats(ctrl.bgRej, ctrl.bgIter) {
+          _centroidExtractor(schema, name) {
     _logName = logName.size() ? logName : name;
 }
 
 void LocalBackgroundAlgorithm::measure(afw::table::SourceRecord& measRecord,
                                        afw::image::Exposure<float> const& exposure) const {
+    tryMeasure(measRecord, exposure).throwIfFailed();
+}
+
+MeasurementStatus LocalBackgroundAlgorithm::tryMeasure(afw::table::SourceRecord& measRecord,
+                                                       afw::image::Exposure<float> const& exposure) const {
     geom::Point2D const center = _centroidExtractor(measRecord, _flagHandler);
     afw::image::MaskedImage<float> const& image = exposure.getMaskedImage();
     afw::image::Mask<afw::image::MaskPixel> const& mask = *image.getMask();
@@ -65,41 +129,71 @@ void LocalBackgroundAlgorithm::measure(afw::table::SourceRecord& measRecord,
     // Define pixels in annulus
     auto const psf = exposure.getPsf();
     if (!psf) {
-        throw LSST_EXCEPT(MeasurementError, NO_PSF.doc, NO_PSF.number);
+        return MeasurementStatus(NO_PSF);
     }
     float const psfSigma = psf->computeShape().getDeterminantRadius();
 
+    // Collect the good pixels of the annulus row by row: the outer circle's span at each row, clipped to
+    // the image, less the inner circle's span at that row, if any.  No SpanSets are built and the values
+    // go into scratch buffers from the thread's arena.
     float const innerRadius = _ctrl.annulusInner * psfSigma;
-    afw::geom::ellipses::Axes const innerCircle{innerRadius, innerRadius};
-    auto const& inner = afw::geom::SpanSet::fromShape(afw::geom::ellipses::Ellipse(innerCircle, center));
-
+    afw::geom::ellipses::PixelRegion const inner(
+            afw::geom::ellipses::Ellipse(afw::geom::ellipses::Axes(innerRadius, innerRadius), center));
     float const outerRadius = _ctrl.annulusOuter * psfSigma;
-    afw::geom::ellipses::Axes const outerCircle{outerRadius, outerRadius};
-    auto const& outer = afw::geom::SpanSet::fromShape(afw::geom::ellipses::Ellipse(outerCircle, center));
-
-    auto const& annulus = outer->clippedTo(image.getBBox())->intersectNot(*inner);
-    auto const& imageValues = annulus->flatten(image.getImage()->getArray(), image.getXY0());
-    auto const& maskValues = annulus->flatten(image.getMask()->getArray(), image.getXY0());
-
-    // Extract from ndarray::Array into std::vector because of limitations in afw::math::makeStatistics
-    std::vector<float> values;
-    values.reserve(imageValues.getNumElements());
-    assert(imageValues.getNumElements() == maskValues.getNumElements());  // constructed from the same spans
-    auto maskIter = maskValues.begin();
-    for (auto imageIter = imageValues.begin(); imageIter != imageValues.end(); ++imageIter, ++maskIter) {
-        if ((*maskIter & badMask) == 0) {
-            values.push_back(*imageIter);
+    afw::geom::ellipses::PixelRegion const outer(
+            afw::geom::ellipses::Ellipse(afw::geom::ellipses::Axes(outerRadius, outerRadius), center));
+
+    ScratchArena::Scope scratch;
+    std::size_t const innerHeight = inner.getBBox().getHeight();
+    // [begin, end) of the inner span in each row
+    std::pair<int, int>* const innerRows = scratch.allocate<std::pair<int, int>>(innerHeight);
+    std::fill_n(innerRows, innerHeight, std::make_pair(0, 0));
+    for (auto const& span : inner) {
+        innerRows[span.getY() - inner.getBBox().getMinY()] =
+                std::make_pair(span.getMinX(), span.getMaxX() + 1);
+    }
+
+    float* const values = scratch.allocate<float>(outer.getBBox().getArea());
+    std::size_t nValues = 0;
+    geom::Box2I const bbox = image.getBBox();
+    auto const imageArray = image.getImage()->getArray();
+    auto const maskArray = mask.getArray();
+    auto addValues = [&](int y, int xBegin, int xEnd) {
+        auto const imageRow = imageArray[y - image.getY0()];
+        auto const maskRow = maskArray[y - image.getY0()];
+        for (int x = xBegin - image.getX0(); x < xEnd - image.getX0(); ++x) {
+            if ((maskRow[x] & badMask) == 0 && std::isfinite(imageRow[x])) {
+                values[nValues++] = imageRow[x];
+            }
+        }
+    };
+    for (auto const& span : outer) {
+        int const y = span.getY();
+        if (y < bbox.getMinY() || y > bbox.getMaxY()) {
+            continue;
+        }
+        int const xBegin = std::max(span.getMinX(), bbox.getMinX());
+        int const xEnd = std::min(span.getMaxX() + 1, bbox.getMaxX() + 1);
+        int const innerRow = y - inner.getBBox().getMinY();
+        if (innerRow >= 0 && innerRow < inner.getBBox().getHeight() &&
+            innerRows[innerRow].first < innerRows[innerRow].second) {
+            addValues(y, xBegin, std::min(xEnd, innerRows[innerRow].first));
+            addValues(y, std::max(xBegin, innerRows[innerRow].second), xEnd);
+        } else {
+            addValues(y, xBegin, xEnd);
         }
     }
 
-    if (values.size() == 0) {
-        throw LSST_EXCEPT(MeasurementError, NO_GOOD_PIXELS.doc, NO_GOOD_PIXELS.number);
+    if (nValues == 0) {
+        return MeasurementStatus(NO_GOOD_PIXELS);
     }
 
     // Measure the background
-    auto const stats = afw::math::makeStatistics(values, afw::math::MEANCLIP | afw::math::STDEVCLIP, _stats);
-    FluxResult const result(stats.getValue(afw::math::MEANCLIP), stats.getValue(afw::math::STDEVCLIP));
+    std::pair<double, double> const stats =
+            computeClippedStatistics(values, nValues, _ctrl.bgRej, _ctrl.bgIter);
+    FluxResult const result(stats.first, stats.second);
     measRecord.set(_resultKey, result);
+    return MeasurementStatus();
 }
 
 void LocalBackgroundAlgorithm::fail(afw::table::SourceRecord& measRecord, MeasurementError* error) const {
@@ -0,0 +1,87 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include <vector>
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/afw/image/PhotoCalib.h"
+#include "lsst/afw/table/Source.h"
+#include "lsst/meas/base/LocalPhotoCalib.h"
+#include "lsst/meas/base/ResultBuffer.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+LocalPhotoCalibAlgorithm::LocalPhotoCalibAlgorithm(Control const& ctrl, std::string const& name,
+                                                   afw::table::Schema& schema)
+        : _calibKey(schema.addField<double>(name,
+                                            "Local approximation of the PhotoCalib calibration factor at "
+                                            "the location of the src.")),
+          _calibErrKey(schema.addField<double>(name + "Err",
+                                               "Error on the local approximation of the PhotoCalib "
+                                               "calibration factor at the location of the src.")),
+          _failKey(schema.addField<afw::table::Flag>(schema.join(name, "flag"),
+                                                     "Set for any fatal failure")) {
+    _logName = name;
+}
+
+void LocalPhotoCalibAlgorithm::measure(afw::table::SourceRecord& measRecord,
+                                       afw::image::Exposure<float> const& exposure) const {
+    auto const photoCalib = exposure.getPhotoCalib();
+    if (!photoCalib) {
+        throw LSST_EXCEPT(pex::exceptions::RuntimeError, "No PhotoCalib attached to exposure");
+    }
+    measRecord.set(_calibKey, photoCalib->getLocalCalibration(measRecord.getCentroid()));
+    measRecord.set(_calibErrKey, photoCalib->getCalibrationErr());
+}
+
+void LocalPhotoCalibAlgorithm::measureBatch(afw::table::SourceCatalog& measCat,
+                                            afw::image::Exposure<float> const& exposure,
+                                            std::vector<std::size_t> const& indices) const {
+    auto const photoCalib = exposure.getPhotoCalib();
+    auto const centroidKey = measCat.getTable()->getCentroidSlot().getMeasKey();
+    if (!photoCalib || !centroidKey.isValid()) {
+        // Every record fails; let the per-record loop report it.
+        SingleFrameAlgorithm::measureBatch(measCat, exposure, indices);
+        return;
+    }
+    double const calibErr = photoCalib->getCalibrationErr();
+    ResultBuffer results(indices.size());
+    ResultBuffer::Column<double> const calib = results.addColumn(_calibKey);
+    ResultBuffer::Column<double> const calibErrs = results.addColumn(_calibErrKey);
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        calib[i] = photoCalib->getLocalCalibration(measCat[indices[i]].get(centroidKey));
+        calibErrs[i] = calibErr;
+    }
+    results.commit(measCat, indices);
+}
+
+void LocalPhotoCalibAlgorithm::fail(afw::table::SourceRecord& measRecord, MeasurementError* error) const {
+    measRecord.set(_failKey, true);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
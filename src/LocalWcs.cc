@@ -0,0 +1,158 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "lsst/geom/SpherePoint.h"
+#include "lsst/pex/exceptions.h"
+#include "lsst/afw/table/Source.h"
+#include "lsst/meas/base/LocalWcs.h"
+#include "lsst/meas/base/ResultBuffer.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+namespace {
+
+afw::table::Key<double> addMatrixField(afw::table::Schema& schema, std::string const& name,
+                                       std::string const& row, std::string const& col) {
+    return schema.addField<double>(schema.join(name, "CDMatrix", row, col),
+                                   "(" + row + ", " + col + ") element of the CDMatrix for the linear "
+                                   "approximation of the WCS at the src location. Gives units in radians.");
+}
+
+}  // namespace
+
+LocalWcsAlgorithm::LocalWcsAlgorithm(Control const& ctrl, std::string const& name,
+                                     afw::table::Schema& schema)
+        : _cdMatrix11Key(addMatrixField(schema, name, "1", "1")),
+          _cdMatrix12Key(addMatrixField(schema, name, "1", "2")),
+          _cdMatrix21Key(addMatrixField(schema, name, "2", "1")),
+          _cdMatrix22Key(addMatrixField(schema, name, "2", "2")),
+          _failKey(schema.addField<afw::table::Flag>(schema.join(name, "flag"),
+                                                     "Set for any fatal failure")) {
+    _logName = name;
+}
+
+ndarray::Array<double, 3, 3> LocalWcsAlgorithm::computeLocalMatrices(
+        afw::geom::SkyWcs const& wcs, std::vector<geom::Point2D> const& points) {
+    // The matrix is the derivative of the gnomonic projection centered on each point, found by central
+    // differences of the tangent-plane offsets of its neighbours; the second-order terms of the
+    // projection cancel.  All the neighbours are transformed to the sky in a single call.
+    double const step = 1.0;  // pixels
+    std::vector<geom::Point2D> samples;
+    samples.reserve(5 * points.size());
+    for (auto const& point : points) {
+        if (!std::isfinite(point.getX()) || !std::isfinite(point.getY())) {
+            continue;
+        }
+        samples.push_back(point);
+        samples.push_back(point + geom::Extent2D(step, 0.0));
+        samples.push_back(point - geom::Extent2D(step, 0.0));
+        samples.push_back(point + geom::Extent2D(0.0, step));
+        samples.push_back(point - geom::Extent2D(0.0, step));
+    }
+    std::vector<geom::SpherePoint> const sky = wcs.pixelToSky(samples);
+
+    ndarray::Array<double, 3, 3> result = ndarray::allocate(points.size(), 2, 2);
+    std::size_t sample = 0;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        if (!std::isfinite(points[i].getX()) || !std::isfinite(points[i].getY())) {
+            result[i].deep() = std::numeric_limits<double>::quiet_NaN();
+            continue;
+        }
+        geom::SpherePoint const& center = sky[sample];
+        auto const plusX = center.getTangentPlaneOffset(sky[sample + 1]);
+        auto const minusX = center.getTangentPlaneOffset(sky[sample + 2]);
+        auto const plusY = center.getTangentPlaneOffset(sky[sample + 3]);
+        auto const minusY = center.getTangentPlaneOffset(sky[sample + 4]);
+        result[i][0][0] = (plusX.first - minusX.first).asRadians() / (2.0 * step);
+        result[i][0][1] = (plusY.first - minusY.first).asRadians() / (2.0 * step);
+        result[i][1][0] = (plusX.second - minusX.second).asRadians() / (2.0 * step);
+        result[i][1][1] = (plusY.second - minusY.second).asRadians() / (2.0 * step);
+        sample += 5;
+    }
+    return result;
+}
+
+void LocalWcsAlgorithm::measure(afw::table::SourceRecord& measRecord,
+                                afw::image::Exposure<float> const& exposure) const {
+    auto const wcs = exposure.getWcs();
+    if (!wcs) {
+        throw LSST_EXCEPT(pex::exceptions::RuntimeError, "No WCS attached to exposure");
+    }
+    ndarray::Array<double, 3, 3> const matrix = computeLocalMatrices(*wcs, {measRecord.getCentroid()});
+    measRecord.set(_cdMatrix11Key, matrix[0][0][0]);
+    measRecord.set(_cdMatrix12Key, matrix[0][0][1]);
+    measRecord.set(_cdMatrix21Key, matrix[0][1][0]);
+    measRecord.set(_cdMatrix22Key, matrix[0][1][1]);
+}
+
+void LocalWcsAlgorithm::measureBatch(afw::table::SourceCatalog& measCat,
+                                     afw::image::Exposure<float> const& exposure,
+                                     std::vector<std::size_t> const& indices) const {
+    auto const wcs = exposure.getWcs();
+    auto const centroidKey = measCat.getTable()->getCentroidSlot().getMeasKey();
+    if (!wcs || !centroidKey.isValid()) {
+        // Every record fails; let the per-record loop report it.
+        SingleFrameAlgorithm::measureBatch(measCat, exposure, indices);
+        return;
+    }
+    std::vector<geom::Point2D> centers;
+    centers.reserve(indices.size());
+    for (std::size_t index : indices) {
+        centers.push_back(measCat[index].get(centroidKey));
+    }
+    ndarray::Array<double, 3, 3> matrices;
+    try {
+        matrices = computeLocalMatrices(*wcs, centers);
+    } catch (pex::exceptions::Exception&) {
+        // Find out which records the WCS cannot be evaluated at, one at a time.
+        SingleFrameAlgorithm::measureBatch(measCat, exposure, indices);
+        return;
+    }
+    ResultBuffer results(indices.size());
+    ResultBuffer::Column<double> const cd11 = results.addColumn(_cdMatrix11Key);
+    ResultBuffer::Column<double> const cd12 = results.addColumn(_cdMatrix12Key);
+    ResultBuffer::Column<double> const cd21 = results.addColumn(_cdMatrix21Key);
+    ResultBuffer::Column<double> const cd22 = results.addColumn(_cdMatrix22Key);
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        cd11[i] = matrices[i][0][0];
+        cd12[i] = matrices[i][0][1];
+        cd21[i] = matrices[i][1][0];
+        cd22[i] = matrices[i][1][1];
+    }
+    results.commit(measCat, indices);
+}
+
+void LocalWcsAlgorithm::fail(afw::table::SourceRecord& measRecord, MeasurementError* error) const {
+    measRecord.set(_failKey, true);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -50,6 +50,25 @@ NaiveCentroidAlgorithm::NaiveCentroidAlgorithm(Control const& ctrl, std::string
 
 void NaiveCentroidAlgorithm::measure(afw::table::SourceRecord& measRecord,
                                      afw::image::Exposure<float> const& exposure) const {
+    tryMeasure(measRecord, exposure).throwIfFailed();
+}
+
+MeasurementStatus NaiveCentroidAlgorithm::tryMeasure(afw::table::SourceRecord& measRecord,
+                                                     afw::image::Exposure<float> const& exposure) const {
+    return _measure(measRecord, *exposure.getMaskedImage().getImage());
+}
+
+void NaiveCentroidAlgorithm::measureBatch(afw::table::SourceCatalog& measCat,
+                                          afw::image::Exposure<float> const& exposure,
+                                          std::vector<std::size_t> const& indices) const {
+    std::shared_ptr<afw::image::Image<float> const> image = exposure.getMaskedImage().getImage();
+    measureEach(measCat, indices, [this, &image](afw::table::SourceRecord& measRecord) {
+        return _measure(measRecord, *image);
+    });
+}
+
+MeasurementStatus NaiveCentroidAlgorithm::_measure(afw::table::SourceRecord& measRecord,
+                                                   afw::image::Image<float> const& image) const {
     geom::Point2D center = _centroidExtractor(measRecord, _flagHandler);
     CentroidResult result;
     result.x = center.getX();
@@ -57,7 +76,6 @@ void NaiveCentroidAlgorithm::measure(afw::table::SourceRecord& measRecord,
     measRecord.set(_centroidKey, result);  // better than NaN
 
     typedef afw::image::Image<float> ImageT;
-    ImageT const& image = *exposure.getMaskedImage().getImage();
 
     int x = center.getX();  // FIXME: this is different from GaussianCentroid and SdssCentroid here,
     int y = center.getY();  //        and probably shouldn't be.
@@ -66,7 +84,7 @@ void NaiveCentroidAlgorithm::measure(afw::table::SourceRecord& measRecord,
     y -= image.getY0();
 
     if (x < 1 || x >= image.getWidth() - 1 || y < 1 || y >= image.getHeight() - 1) {
-        throw LSST_EXCEPT(MeasurementError, EDGE.doc, EDGE.number);
+        return MeasurementStatus(EDGE);
     }
 
     ImageT::xy_locator im = image.xy_at(x, y);
@@ -76,7 +94,7 @@ void NaiveCentroidAlgorithm::measure(afw::table::SourceRecord& measRecord,
                        9 * _ctrl.background;
 
     if (sum == 0.0) {
-        throw LSST_EXCEPT(MeasurementError, NO_COUNTS.doc, NO_COUNTS.number);
+        return MeasurementStatus(NO_COUNTS);
     }
 
     double const sum_x = -im(-1, 1) + im(1, 1) + -im(-1, 0) + im(1, 0) + -im(-1, -1) + im(1, -1);
@@ -86,6 +104,7 @@ void NaiveCentroidAlgorithm::measure(afw::table::SourceRecord& measRecord,
     result.y = afw::image::indexToPosition(y + image.getY0()) + sum_y / sum;
     measRecord.set(_centroidKey, result);
     _centroidChecker(measRecord);
+    return MeasurementStatus();
 }
 
 void NaiveCentroidAlgorithm::fail(afw::table::SourceRecord& measRecord, MeasurementError* error) const {
@@ -0,0 +1,156 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2019 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "boost/format.hpp"
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/afw/detection/HeavyFootprint.h"
+#include "lsst/afw/geom/SpanSet.h"
+#include "lsst/meas/base/NoiseReplacementEngine.h"
+#include "lsst/meas/base/SpanKernels.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+NoiseReplacementEngine::NoiseReplacementEngine(std::shared_ptr<afw::image::Exposure<float> const> exposure,
+                                               FootprintMap const& footprints, double noiseMean,
+                                               double noiseStd, bool useVariancePlane, std::uint64_t seed,
+                                               int border,
+                                               std::shared_ptr<afw::image::Image<float> const> noiseImage,
+                                               bool detectionMasks)
+        : _exposure(exposure),
+          _footprints(footprints),
+          _noiseMean(noiseMean),
+          _noiseStd(noiseStd),
+          _useVariancePlane(useVariancePlane),
+          _noise(seed),
+          _border(border),
+          _noiseImage(noiseImage),
+          _detectionMasks(detectionMasks) {
+    if (!_exposure) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          "NoiseReplacementEngine requires an exposure");
+    }
+    if (_border < 0) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("Scratch border must be non-negative, not %d") % _border).str());
+    }
+    if (_noiseImage && !_noiseImage->getBBox().contains(_exposure->getBBox())) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          "Noise image does not contain the exposure's bounding box");
+    }
+    for (auto const& item : _footprints) {
+        if (!item.second.second) {
+            throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                              (boost::format("No footprint for source %d") % item.first).str());
+        }
+    }
+}
+
+NoiseReplacementEngine::Item const& NoiseReplacementEngine::_getItem(afw::table::RecordId id) const {
+    auto iter = _footprints.find(id);
+    if (iter == _footprints.end()) {
+        throw LSST_EXCEPT(pex::exceptions::NotFoundError,
+                          (boost::format("No footprint for source %d") % id).str());
+    }
+    return *iter;
+}
+
+NoiseReplacementEngine::Item const& NoiseReplacementEngine::_getInserted(afw::table::RecordId id) const {
+    Item const* item = &_getItem(id);
+    while (item->second.first != 0 && !item->second.second->isHeavy()) {
+        item = &_getItem(item->second.first);
+    }
+    return *item;
+}
+
+geom::Box2I NoiseReplacementEngine::computeScratchBBox(afw::table::RecordId id) const {
+    geom::Box2I bbox = _getItem(id).second.second->getBBox();
+    bbox.include(_getInserted(id).second.second->getBBox());
+    bbox.grow(_border);
+    bbox.clip(_exposure->getBBox());
+    return bbox;
+}
+
+void NoiseReplacementEngine::_fillNoise(Item const& parent, afw::geom::SpanSet const& spans,
+                                        afw::image::Image<float>& image) const {
+    if (_noiseImage) {
+        spans.copyImage(*_noiseImage, image);
+        return;
+    }
+    if (_useVariancePlane) {
+        _noise.fillImage(parent.first, spans, image, *_exposure->getMaskedImage().getVariance(),
+                         _noiseMean);
+    } else {
+        _noise.fillImage(parent.first, spans, image, _noiseMean, _noiseStd);
+    }
+}
+
+std::shared_ptr<afw::image::Exposure<float>> NoiseReplacementEngine::makeScratch(
+        afw::table::RecordId id) const {
+    Item const& inserted = _getInserted(id);
+    geom::Box2I const bbox = computeScratchBBox(id);
+    auto scratch = std::make_shared<afw::image::Exposure<float>>(*_exposure, bbox, afw::image::PARENT, true);
+    // Share the exposure's Psf rather than a copy, so any cache it holds is shared by all scratch images.
+    scratch->setPsf(_exposure->getPsf());
+    afw::image::Image<float>& image = *scratch->getMaskedImage().getImage();
+    afw::image::Mask<afw::image::MaskPixel>& mask = *scratch->getMaskedImage().getMask();
+    afw::image::MaskPixel const thisBitMask =
+            _detectionMasks ? afw::image::Mask<afw::image::MaskPixel>::getPlaneBitMask("THISDET") : 0;
+    afw::image::MaskPixel const otherBitMask =
+            _detectionMasks ? afw::image::Mask<afw::image::MaskPixel>::getPlaneBitMask("OTHERDET") : 0;
+    if (_detectionMasks) {
+        mask &= static_cast<afw::image::MaskPixel>(~(thisBitMask | otherBitMask));
+    }
+
+    for (auto const& item : _footprints) {
+        if (item.second.first != 0 || !item.second.second->getBBox().overlaps(bbox)) {
+            continue;
+        }
+        auto const spans = item.second.second->getSpans()->clippedTo(bbox);
+        _fillNoise(item, *spans, image);
+        if (_detectionMasks) {
+            spans->setMask(mask, otherBitMask);
+        }
+    }
+
+    std::shared_ptr<afw::detection::Footprint> const& footprint = inserted.second.second;
+    auto const spans = footprint->getSpans()->clippedTo(bbox);
+    auto heavy = std::dynamic_pointer_cast<afw::detection::HeavyFootprint<float>>(footprint);
+    if (heavy && image.getBBox(afw::image::PARENT).contains(heavy->getBBox())) {
+        insertSpans(*heavy->getSpans(), ndarray::Array<float const, 1, 1>(heavy->getImageArray()), image);
+    } else if (heavy) {
+        heavy->insert(image);
+    } else {
+        spans->copyImage(*_exposure->getMaskedImage().getImage(), image);
+    }
+    if (_detectionMasks) {
+        spans->setMask(mask, thisBitMask);
+        spans->clearMask(mask, otherBitMask);
+    }
+    return scratch;
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -21,7 +21,11 @@
  * see <http://www.lsstcorp.org/LegalNotices/>.
  */
 
-#include "ndarray/eigen.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <vector>
 
 #include "lsst/afw/detection/Psf.h"
 #include "lsst/geom/Box.h"
@@ -31,6 +35,7 @@
 #include "lsst/afw/math.h"
 
 #include "lsst/meas/base/PeakLikelihoodFlux.h"
+#include "lsst/meas/base/ScratchArena.h"
 #include "lsst/afw/table/Source.h"
 
 namespace lsst {
@@ -46,74 +51,15 @@ FlagDefinitionList const &PeakLikelihoodFluxAlgorithm::getFlagDefinitions() { re
 
 namespace {
 
-/************************************************************************************************************/
-/**
- * @class PsfAttributes
- *
- * A class to contain various attributes of the Psf
- * - most notably, a width (1-D RMS size) to be used to
- *   make a single gaussian psf for fast convolution.
- *
- * \deprecated
- * This class is deprecated in favour of virtual methods on Psf
- *
- * An example of the new API is:
- * \code
- * afw::geom::ellipses::Quadrupole shape = psf->computeShape();
- * double const smoothingSigma = shape.getDeterminantRadius();
- * \endcode
- */
-class PsfAttributes {
-public:
-    enum Method {
-        ADAPTIVE_MOMENT,   ///< Calculate width using adaptive Gaussian weights
-        FIRST_MOMENT,      ///< Calculate width using \<r>
-        SECOND_MOMENT,     ///< Calculate width using \<r^2>
-        NOISE_EQUIVALENT,  ///< Calculate width as sqrt(n_eff/(4 pi))
-        BICKERTON          ///< Weight \<r^2> by I^2 to avoid negative instFluxes
-    };
-
-    PsfAttributes(CONST_PTR(afw::detection::Psf) psf, int const iX, int const iY);
-    PsfAttributes(CONST_PTR(afw::detection::Psf) psf, geom::Point2I const &cen);
-
-    double computeGaussianWidth(Method how = ADAPTIVE_MOMENT) const;
-    double computeEffectiveArea() const;
-
-private:
-    PTR(afw::image::Image<double>) _psfImage;
-};
-
-/**
- * @brief Constructor for PsfAttributes
- */
-PsfAttributes::PsfAttributes(CONST_PTR(afw::detection::Psf) psf,  ///< The psf whose attributes we want
-                             int const iX,  ///< the x position in the frame we want the attributes at
-                             int const iY   ///< the y position in the frame we want the attributes at
-                             ) {
-    // N.b. (iX, iY) are ints so that we know this image is centered in the central pixel of _psfImage
-    _psfImage = psf->computeImage(geom::PointD(iX, iY));
-}
-
-/**
- * @brief Constructor for PsfAttributes
- */
-PsfAttributes::PsfAttributes(
-        CONST_PTR(afw::detection::Psf) psf,  ///< The psf whose attributes we want
-        geom::Point2I const &cen             ///< the position in the frame we want the attributes at
-        )
-        :  // N.b. cen is a PointI so that we know this image is centered in the central pixel of _psfImage
-          _psfImage(psf->computeImage(geom::PointD(cen))) {}
-
-/**
- * @brief Compute the effective area of the psf ( sum(I)^2/sum(I^2) )
- *
+/*
+ * Compute the effective area of a PSF image: sum(I)^2/sum(I^2)
  */
-double PsfAttributes::computeEffectiveArea() const {
+double computeEffectiveArea(afw::image::Image<double> const &psfImage) {
     double sum = 0.0;
     double sumsqr = 0.0;
-    for (int iY = 0; iY != _psfImage->getHeight(); ++iY) {
-        afw::image::Image<double>::x_iterator end = _psfImage->row_end(iY);
-        for (afw::image::Image<double>::x_iterator ptr = _psfImage->row_begin(iY); ptr != end; ++ptr) {
+    for (int iY = 0; iY != psfImage.getHeight(); ++iY) {
+        afw::image::Image<double>::const_x_iterator end = psfImage.row_end(iY);
+        for (afw::image::Image<double>::const_x_iterator ptr = psfImage.row_begin(iY); ptr != end; ++ptr) {
             sum += *ptr;
             sumsqr += (*ptr) * (*ptr);
         }
@@ -121,67 +67,144 @@ double PsfAttributes::computeEffectiveArea() const {
     return sum * sum / sumsqr;
 }
 
+int const SHIFT_TABLE_STEPS = 1024;  // table entries per pixel of fractional shift
+
 }  // end anonymous namespace
 
-/**
-Compute the value of one pixel of an image after a fractional pixel shift
-Since we only want the value at one pixel, there is no need to shift the entire image;
-instead we simply convolve at one point.
+/*
+ * The 1-D weights of the separable warping kernel, tabulated at SHIFT_TABLE_STEPS fractional shifts per
+ * pixel over [-1, 0] (with the kernel center moved one pixel right, as warping kernels have even
+ * dimension and want the peak to the right of center) and over [0, 1] (with the default center).
+ *
+ * Weights for other shifts are interpolated linearly between the table entries and renormalized, so a
+ * shifted pixel value costs two short dot products and no kernel evaluations.
+ */
+class PeakLikelihoodFluxAlgorithm::ShiftTable {
+public:
+    explicit ShiftTable(std::string const &warpingKernelName) {
+        std::shared_ptr<afw::math::SeparableKernel> kernel = afw::math::makeWarpingKernel(warpingKernelName);
+        _width = kernel->getWidth();
+        _ctr = kernel->getCtr().getX();
+        if (kernel->getHeight() != _width || kernel->getCtr().getY() != _ctr) {
+            throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                              "Warping kernel " + warpingKernelName + " is not symmetric in x and y");
+        }
+        std::vector<double> colList(_width);
+        std::vector<double> rowList(_width);
+        for (int negative = 0; negative < 2; ++negative) {
+            kernel->setCtr(geom::Point2I(_ctr + negative, _ctr + negative));
+            std::vector<double> &table = negative ? _negative : _positive;
+            table.resize((SHIFT_TABLE_STEPS + 1) * _width);
+            for (int i = 0; i <= SHIFT_TABLE_STEPS; ++i) {
+                double const shift = (negative ? -1.0 : 1.0) * i / SHIFT_TABLE_STEPS;
+                kernel->setKernelParameters(std::make_pair(shift, 0.0));
+                kernel->computeVectors(colList, rowList, false);
+                std::copy(colList.begin(), colList.end(), table.begin() + i * _width);
+            }
+        }
+    }
 
-@throw pex::exceptions::RangeError if abs(fracShift) > 1 in either dimension
-*/
-template <typename T>
-typename afw::image::MaskedImage<T>::SinglePixel computeShiftedValue(
-        afw::image::MaskedImage<T> const &maskedImage,  ///< masked image
-        std::string const &warpingKernelName,           ///< warping kernel name
-        geom::Point2D const &fracShift,                 ///< amount of sub-pixel shift (pixels)
-        geom::Point2I const &parentInd                  ///< parent index at which to compute pixel
-        ) {
-    typedef typename afw::image::Exposure<T>::MaskedImageT MaskedImageT;
-    typedef typename afw::image::Image<double> KernelImageT;
+    /// Width of each set of weights.
+    int getWidth() const { return _width; }
 
-    PTR(afw::math::SeparableKernel) warpingKernelPtr = afw::math::makeWarpingKernel(warpingKernelName);
+    /// Offset of the first weight from the pixel being interpolated to, for the given shift.
+    int getOffset(double shift) const { return _ctr + (shift < 0 ? 1 : 0); }
 
+    /// Compute the normalized weights for a fractional shift with abs(shift) < 1.
+    void computeWeights(double shift, double *weights) const {
+        std::vector<double> const &table = shift < 0 ? _negative : _positive;
+        double const position = std::abs(shift) * SHIFT_TABLE_STEPS;
+        int const i = std::min(static_cast<int>(position), SHIFT_TABLE_STEPS - 1);
+        double const t = position - i;
+        double const *lower = &table[i * _width];
+        double const *upper = lower + _width;
+        double sum = 0.0;
+        for (int k = 0; k < _width; ++k) {
+            weights[k] = (1.0 - t) * lower[k] + t * upper[k];
+            sum += weights[k];
+        }
+        for (int k = 0; k < _width; ++k) {
+            weights[k] /= sum;
+        }
+    }
+
+private:
+    int _width;
+    int _ctr;
+    std::vector<double> _positive;
+    std::vector<double> _negative;
+};
+
+namespace {
+
+/*
+ * Compute the value of one pixel of an image after a fractional pixel shift
+ * Since we only want the value at one pixel, there is no need to shift the entire image;
+ * instead we simply convolve at one point, with the separable kernel applied as one dot product
+ * along each row and one across the rows.
+ *
+ * Returns the (image, variance) pair; the variance is weighted by the square of the kernel.
+ *
+ * @throw pex::exceptions::RangeError if abs(fracShift) > 1 in either dimension
+ */
+template <typename T>
+std::pair<double, double> computeShiftedValue(
+        afw::image::MaskedImage<T> const &maskedImage,         ///< masked image
+        PeakLikelihoodFluxAlgorithm::ShiftTable const &table,  ///< warping kernel weights
+        geom::Point2D const &fracShift,                        ///< amount of sub-pixel shift (pixels)
+        geom::Point2I const &parentInd                         ///< parent index at which to compute pixel
+        ) {
     if ((std::abs(fracShift[0]) >= 1) || (std::abs(fracShift[1]) >= 1)) {
         std::ostringstream os;
         os << "fracShift = " << fracShift << " too large; abs value must be < 1 in both axes";
         throw LSST_EXCEPT(pex::exceptions::RangeError, os.str());
     }
 
-    // warping kernels have even dimension and want the peak to the right of center
-    if (fracShift[0] < 0) {
-        warpingKernelPtr->setCtr(warpingKernelPtr->getCtr() + geom::Extent2I(1, 0));
-    }
-    if (fracShift[1] < 0) {
-        warpingKernelPtr->setCtr(warpingKernelPtr->getCtr() + geom::Extent2I(0, 1));
-    }
-    geom::Box2I warpingOverlapBBox(parentInd - geom::Extent2I(warpingKernelPtr->getCtr()),
-                                   warpingKernelPtr->getDimensions());
+    int const width = table.getWidth();
+    geom::Box2I warpingOverlapBBox(
+            parentInd - geom::Extent2I(table.getOffset(fracShift[0]), table.getOffset(fracShift[1])),
+            geom::Extent2I(width, width));
     if (!maskedImage.getBBox().contains(warpingOverlapBBox)) {
         std::ostringstream os;
         os << "Warping kernel extends off the edge"
            << "; kernel bbox = " << warpingOverlapBBox << "; exposure bbox = " << maskedImage.getBBox();
         throw LSST_EXCEPT(pex::exceptions::RangeError, os.str());
     }
-    warpingKernelPtr->setKernelParameters(std::make_pair(fracShift[0], fracShift[1]));
-    KernelImageT warpingKernelImage(warpingKernelPtr->getDimensions());
-    warpingKernelPtr->computeImage(warpingKernelImage, true);
-    typename KernelImageT::const_xy_locator const warpingKernelLoc = warpingKernelImage.xy_at(0, 0);
-
-    // Compute imLoc: an image locator that matches kernel locator (0,0) such that
-    // image ctrPix overlaps center of warping kernel
-    geom::Point2I subimMin = warpingOverlapBBox.getMin();
-    typename MaskedImageT::const_xy_locator const mimageLoc =
-            maskedImage.xy_at(subimMin.getX(), subimMin.getY());
-    return afw::math::convolveAtAPoint<MaskedImageT, MaskedImageT>(
-            mimageLoc, warpingKernelLoc, warpingKernelPtr->getWidth(), warpingKernelPtr->getHeight());
+
+    ScratchArena::Scope scratch;
+    double *const xWeights = scratch.allocate<double>(2 * width);
+    double *const yWeights = xWeights + width;
+    table.computeWeights(fracShift[0], xWeights);
+    table.computeWeights(fracShift[1], yWeights);
+
+    int const x0 = warpingOverlapBBox.getMinX() - maskedImage.getX0();
+    int const y0 = warpingOverlapBBox.getMinY() - maskedImage.getY0();
+    double value = 0.0;
+    double variance = 0.0;
+    for (int j = 0; j < width; ++j) {
+        auto imageIter = maskedImage.getImage()->row_begin(y0 + j) + x0;
+        auto varianceIter = maskedImage.getVariance()->row_begin(y0 + j) + x0;
+        double rowValue = 0.0;
+        double rowVariance = 0.0;
+        for (int i = 0; i < width; ++i) {
+            rowValue += xWeights[i] * imageIter[i];
+            rowVariance += xWeights[i] * xWeights[i] * varianceIter[i];
+        }
+        value += yWeights[j] * rowValue;
+        variance += yWeights[j] * yWeights[j] * rowVariance;
+    }
+    return std::make_pair(value, variance);
 }
+
+}  // end anonymous namespace
+
 PeakLikelihoodFluxAlgorithm::PeakLikelihoodFluxAlgorithm(Control const &ctrl, std::string const &name,
                                                          afw::table::Schema &schema)
         : _ctrl(ctrl),
           _instFluxResultKey(
                   FluxResultKey::addFields(schema, name, "instFlux from PeakLikelihood Flux algorithm")),
-          _centroidExtractor(schema, name) {
+          _centroidExtractor(schema, name),
+          _shiftTable(std::make_shared<ShiftTable>(ctrl.warpingKernelName)) {
     _flagHandler = FlagHandler::addFields(schema, name, getFlagDefinitions());
 }
 
@@ -222,19 +245,20 @@ void PeakLikelihoodFluxAlgorithm::measure(afw::table::SourceRecord &measRecord,
     geom::Point2D ctrPixPos(afw::image::indexToPosition(ctrPixParentInd[0]),
                             afw::image::indexToPosition(ctrPixParentInd[1]));
 
-    // compute weight = 1/sum(PSF^2) for PSF at ctrPix, where PSF is normalized to a sum of 1
-    PsfAttributes psfAttr(psfPtr, ctrPixParentInd);
-    double weight = psfAttr.computeEffectiveArea();
+    // compute weight = 1/sum(PSF^2) for PSF at ctrPix, where PSF is normalized to a sum of 1.
+    // N.b. ctrPixParentInd is integer so that we know this image is centered in its central pixel;
+    // the image comes through the Psf's own cache (and the framework's CachingPsf, if any).
+    double weight = computeEffectiveArea(*psfPtr->computeImage(geom::Point2D(ctrPixParentInd)));
 
     /*
      * Compute value of image at center of source, as shifted by a fractional pixel to center the source
      * on ctrPix.
      */
-    MaskedImageT::SinglePixel mimageCtrPix = computeShiftedValue(
-            mimage, _ctrl.warpingKernelName,
-            geom::Point2D(xCtrPixParentIndFrac.second, yCtrPixParentIndFrac.second), ctrPixParentInd);
-    double instFlux = mimageCtrPix.image() * weight;
-    double var = mimageCtrPix.variance() * weight * weight;
+    std::pair<double, double> const mimageCtrPix = computeShiftedValue(
+            mimage, *_shiftTable, geom::Point2D(xCtrPixParentIndFrac.second, yCtrPixParentIndFrac.second),
+            ctrPixParentInd);
+    double instFlux = mimageCtrPix.first * weight;
+    double var = mimageCtrPix.second * weight * weight;
     result.instFlux = instFlux;
     result.instFluxErr = std::sqrt(var);
     measRecord.set(_instFluxResultKey, result);
@@ -22,7 +22,7 @@
  */
 
 #include <cctype>     // ::tolower
-#include <algorithm>  // std::transform
+#include <algorithm>  // std::transform, std::min, std::max
 #include <cmath>
 
 #include "ndarray/eigen.h"
@@ -33,44 +33,40 @@
 #include "lsst/afw/table/Source.h"
 #include "lsst/afw/geom/SpanSet.h"
 #include "lsst/meas/base/PixelFlags.h"
+#include "lsst/meas/base/SpanKernels.h"
 
 namespace lsst {
 namespace meas {
 namespace base {
 namespace {
-template <typename MaskedImageT>
-class FootprintBits {
-public:
-    explicit FootprintBits() : _bits(0) {}
 
-    /// \brief Reset everything for a new Footprint
-    void reset() { _bits = 0x0; }
+typedef afw::image::Mask<afw::image::MaskPixel> Mask;
 
-    void operator()(geom::Point2I const& point, typename MaskedImageT::Mask::Pixel const& value) {
-        _bits |= value;
+afw::image::MaskPixel getPlaneBitMask(std::string const& name) {
+    try {
+        return Mask::getPlaneBitMask(name);
+    } catch (pex::exceptions::InvalidParameterError& err) {
+        throw LSST_EXCEPT(FatalAlgorithmError, err.what());
     }
+}
 
-    /// Return the union of the bits set anywhere in the Footprint
-    typename MaskedImageT::Mask::Pixel getBits() const { return _bits; }
-
-private:
-    typename MaskedImageT::Mask::Pixel _bits;
-};
-
-typedef afw::image::MaskedImage<float> MaskedImageF;
-
-void updateFlags(PixelFlagsAlgorithm::KeyMap const& maskFlagToPixelFlag,
-                 const FootprintBits<MaskedImageF>& func, afw::table::SourceRecord& measRecord) {
-    for (auto const& i : maskFlagToPixelFlag) {
-        try {
-            if (func.getBits() & MaskedImageF::Mask::getPlaneBitMask(i.first)) {
-                measRecord.set(i.second, true);
-            }
-        } catch (pex::exceptions::InvalidParameterError& err) {
-            throw LSST_EXCEPT(FatalAlgorithmError, err.what());
+// Return the union of the mask bits set in the 3x3 box around the given pixel within the mask.
+afw::image::MaskPixel orCenterBits(geom::Point2I const& center, Mask const& mask) {
+    int const xBegin = std::max(center.getX() - 1 - mask.getX0(), 0);
+    int const xEnd = std::min(center.getX() + 2 - mask.getX0(), mask.getWidth());
+    int const yBegin = std::max(center.getY() - 1 - mask.getY0(), 0);
+    int const yEnd = std::min(center.getY() + 2 - mask.getY0(), mask.getHeight());
+    auto array = mask.getArray();
+    afw::image::MaskPixel bits = 0;
+    for (int y = yBegin; y < yEnd; ++y) {
+        afw::image::MaskPixel const* row = array[y].getData();
+        for (int x = xBegin; x < xEnd; ++x) {
+            bits |= row[x];
         }
     }
+    return bits;
 }
+
 }  // end anonymous namespace
 
 PixelFlagsAlgorithm::PixelFlagsAlgorithm(Control const& ctrl, std::string const& name,
@@ -120,11 +116,37 @@ PixelFlagsAlgorithm::PixelFlagsAlgorithm(Control const& ctrl, std::string const&
     }
 }
 
+PixelFlagsAlgorithm::MaskBits PixelFlagsAlgorithm::_getMaskBits() const {
+    MaskBits bits;
+    bits.noData = getPlaneBitMask("NO_DATA");
+    for (auto const& i : _anyKeys) {
+        bits.anywhere.emplace_back(getPlaneBitMask(i.first), i.second);
+    }
+    for (auto const& i : _centerKeys) {
+        bits.center.emplace_back(getPlaneBitMask(i.first), i.second);
+    }
+    return bits;
+}
+
 void PixelFlagsAlgorithm::measure(afw::table::SourceRecord& measRecord,
                                   afw::image::Exposure<float> const& exposure) const {
-    MaskedImageF mimage = exposure.getMaskedImage();
-    FootprintBits<MaskedImageF> func;
+    _measure(measRecord, exposure, _getMaskBits());
+}
 
+void PixelFlagsAlgorithm::measureBatch(afw::table::SourceCatalog& measCat,
+                                       afw::image::Exposure<float> const& exposure,
+                                       std::vector<std::size_t> const& indices) const {
+    // The plane bits are looked up once for the whole batch.
+    MaskBits const bits = _getMaskBits();
+    measureEach(measCat, indices, [this, &exposure, &bits](afw::table::SourceRecord& measRecord) {
+        _measure(measRecord, exposure, bits);
+        return MeasurementStatus();
+    });
+}
+
+void PixelFlagsAlgorithm::_measure(afw::table::SourceRecord& measRecord,
+                                   afw::image::Exposure<float> const& exposure, MaskBits const& bits) const {
+    Mask const& mask = *exposure.getMaskedImage().getMask();
     // Check if the measRecord has a valid centroid key, i.e. it was centroided
     geom::Point2D center;
     if (measRecord.getTable()->getCentroidSlot().getMeasKey().isValid()) {
@@ -155,38 +177,37 @@ void PixelFlagsAlgorithm::measure(afw::table::SourceRecord& measRecord,
     }
 
     //  Catch centroids off the image
-    if (!mimage.getBBox().contains(geom::Point2I(center))) {
+    if (!mask.getBBox().contains(geom::Point2I(center))) {
         measRecord.set(_offImageKey, true);
         measRecord.set(_anyKeys.at("EDGE"), true);
     }
 
     // Check for bits set in the source's Footprint
-    afw::detection::Footprint const& footprint(*measRecord.getFootprint());
-    footprint.getSpans()->clippedTo(mimage.getBBox())->applyFunctor(func, *(mimage.getMask()));
+    afw::image::MaskPixel const footprintBits = orSpans(*measRecord.getFootprint()->getSpans(), mask);
 
     // Set the EDGE flag if the bitmask has NO_DATA set
-    try {
-        if (func.getBits() & MaskedImageF::Mask::getPlaneBitMask("NO_DATA")) {
-            measRecord.set(_anyKeys.at("EDGE"), true);
-        }
-    } catch (pex::exceptions::InvalidParameterError& err) {
-        throw LSST_EXCEPT(FatalAlgorithmError, err.what());
+    if (footprintBits & bits.noData) {
+        measRecord.set(_anyKeys.at("EDGE"), true);
     }
 
     // update the source record for the any keys
-    updateFlags(_anyKeys, func, measRecord);
+    for (auto const& i : bits.anywhere) {
+        if (footprintBits & i.first) {
+            measRecord.set(i.second, true);
+        }
+    }
 
     // Check for bits set in the 3x3 box around the center
-    geom::Point2I llc(afw::image::positionToIndex(center.getX()) - 1,
-                      afw::image::positionToIndex(center.getY()) - 1);
-
-    func.reset();
-    auto spans = std::make_shared<afw::geom::SpanSet>(geom::Box2I(llc, geom::ExtentI(3)));
-    afw::detection::Footprint const middle(spans);  // central 3x3
-    middle.getSpans()->clippedTo(mimage.getBBox())->applyFunctor(func, *(mimage.getMask()));
+    geom::Point2I const centerPixel(afw::image::positionToIndex(center.getX()),
+                                    afw::image::positionToIndex(center.getY()));
+    afw::image::MaskPixel const centerBits = orCenterBits(centerPixel, mask);
 
     // Update the flags which have to do with the center of the footprint
-    updateFlags(_centerKeys, func, measRecord);
+    for (auto const& i : bits.center) {
+        if (centerBits & i.first) {
+            measRecord.set(i.second, true);
+        }
+    }
 }
 
 void PixelFlagsAlgorithm::fail(afw::table::SourceRecord& measRecord, MeasurementError* error) const {
@@ -0,0 +1,193 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include <new>
+
+#include "boost/format.hpp"
+
+#include "lsst/log/Log.h"
+#include "lsst/pex/exceptions.h"
+#include "lsst/afw/table/Source.h"
+#include "lsst/meas/base/PluginChain.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+namespace {
+
+// Call func for the entries of a chain in [beginOrder, endOrder) whose preconditions hold, isolating
+// failures (whether thrown or returned as a MeasurementStatus) to the algorithm and record that caused them.
+template <typename EntryT, typename Func>
+void runChain(std::vector<EntryT> const& entries, afw::table::SourceRecord& measRecord,
+              SourceConditions const& conditions, double beginOrder, double endOrder, Func func) {
+    for (auto const& entry : entries) {
+        if (entry.executionOrder < beginOrder) {
+            continue;
+        }
+        if (entry.executionOrder >= endOrder) {
+            break;
+        }
+        if (!conditions.apply(entry.preconditions, *entry.algorithm, measRecord, entry.logName)) {
+            continue;
+        }
+        try {
+            MeasurementStatus const status = func(entry);
+            if (!status) {
+                LOGL_DEBUG(entry.logName, "MeasurementError in measure on record %lld: %s",
+                           measRecord.getId(), status.getMessage().c_str());
+                MeasurementError error = status.makeError();
+                entry.algorithm->fail(measRecord, &error);
+            }
+        } catch (FatalAlgorithmError&) {
+            throw;
+        } catch (std::bad_alloc&) {
+            throw;
+        } catch (MeasurementError& error) {
+            LOGL_DEBUG(entry.logName, "MeasurementError in measure on record %lld: %s", measRecord.getId(),
+                       error.what());
+            entry.algorithm->fail(measRecord, &error);
+        } catch (std::exception& error) {
+            LOGL_DEBUG(entry.logName, "Exception in measure on record %lld: %s", measRecord.getId(),
+                       error.what());
+            entry.algorithm->fail(measRecord);
+        }
+    }
+}
+
+}  // namespace
+
+void PluginChain::addSingleFrame(std::shared_ptr<SingleFrameAlgorithm const> algorithm,
+                                 double executionOrder) {
+    if (!_entries.empty() && !_entries.front().singleFrame) {
+        throw LSST_EXCEPT(pex::exceptions::LogicError,
+                          "Cannot add a single-frame algorithm to a chain of forced algorithms");
+    }
+    BaseAlgorithm const* base = algorithm.get();
+    _add(Entry{std::move(algorithm), nullptr, base, executionOrder, Preconditions(), std::string()});
+}
+
+void PluginChain::addForced(std::shared_ptr<ForcedAlgorithm const> algorithm, double executionOrder) {
+    if (!_entries.empty() && !_entries.front().forced) {
+        throw LSST_EXCEPT(pex::exceptions::LogicError,
+                          "Cannot add a forced algorithm to a chain of single-frame algorithms");
+    }
+    BaseAlgorithm const* base = algorithm.get();
+    _add(Entry{nullptr, std::move(algorithm), base, executionOrder, Preconditions(), std::string()});
+}
+
+void PluginChain::_add(Entry entry) {
+    if (!entry.algorithm) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "Algorithm must not be null");
+    }
+    if (!_entries.empty() && entry.executionOrder < _entries.back().executionOrder) {
+        throw LSST_EXCEPT(pex::exceptions::LogicError,
+                          (boost::format("Execution order %g precedes that of the last algorithm (%g)") %
+                           entry.executionOrder % _entries.back().executionOrder)
+                                  .str());
+    }
+    entry.logName = entry.algorithm->getLogName();
+    _entries.push_back(std::move(entry));
+}
+
+void PluginChain::_checkIndex(std::size_t index) const {
+    if (index >= _entries.size()) {
+        throw LSST_EXCEPT(pex::exceptions::OutOfRangeError,
+                          (boost::format("Index %d out of range for a chain of %d algorithms") % index %
+                           _entries.size())
+                                  .str());
+    }
+}
+
+void PluginChain::setPreconditions(std::size_t index, Preconditions const& preconditions) {
+    _checkIndex(index);
+    _entries[index].preconditions = preconditions;
+    _needsGoodPixels = false;
+    for (auto const& entry : _entries) {
+        _needsGoodPixels |= entry.preconditions.isRequired(Preconditions::GOOD_PIXELS);
+    }
+}
+
+void PluginChain::setBadMaskPlanes(std::vector<std::string> const& badMaskPlanes) {
+    std::lock_guard<std::mutex> lock(_badBitsMutex);
+    _badMaskPlanes = badMaskPlanes;
+    _badBitsMask.reset();
+}
+
+afw::image::MaskPixel PluginChain::_getBadBits(afw::image::Exposure<float> const& exposure) const {
+    if (!_needsGoodPixels) {
+        return 0x0;
+    }
+    auto const mask = exposure.getMaskedImage().getMask();
+    std::lock_guard<std::mutex> lock(_badBitsMutex);
+    if (_badBitsMask.lock() != mask) {
+        afw::image::MaskPixel badBits = 0x0;
+        for (auto const& plane : _badMaskPlanes) {
+            badBits |= mask->getPlaneBitMask(plane);
+        }
+        _badBits = badBits;
+        _badBitsMask = mask;
+    }
+    return _badBits;
+}
+
+void PluginChain::setLogName(std::size_t index, std::string const& logName) {
+    _checkIndex(index);
+    _entries[index].logName = logName;
+}
+
+double PluginChain::getMinExecutionOrder() const {
+    return _entries.empty() ? std::numeric_limits<double>::quiet_NaN() : _entries.front().executionOrder;
+}
+
+double PluginChain::getMaxExecutionOrder() const {
+    return _entries.empty() ? std::numeric_limits<double>::quiet_NaN() : _entries.back().executionOrder;
+}
+
+void PluginChain::measure(afw::table::SourceRecord& measRecord, afw::image::Exposure<float> const& exposure,
+                          double beginOrder, double endOrder) const {
+    if (!_entries.empty() && !_entries.front().singleFrame) {
+        throw LSST_EXCEPT(pex::exceptions::LogicError, "Chain contains forced algorithms");
+    }
+    SourceConditions const conditions(measRecord, exposure, _getBadBits(exposure));
+    runChain(_entries, measRecord, conditions, beginOrder, endOrder,
+             [&](Entry const& entry) { return entry.singleFrame->tryMeasure(measRecord, exposure); });
+}
+
+void PluginChain::measureForced(afw::table::SourceRecord& measRecord,
+                                afw::image::Exposure<float> const& exposure,
+                                afw::table::SourceRecord const& refRecord, afw::geom::SkyWcs const& refWcs,
+                                double beginOrder, double endOrder) const {
+    if (!_entries.empty() && !_entries.front().forced) {
+        throw LSST_EXCEPT(pex::exceptions::LogicError, "Chain contains single-frame algorithms");
+    }
+    SourceConditions const conditions(measRecord, exposure, _getBadBits(exposure));
+    runChain(_entries, measRecord, conditions, beginOrder, endOrder, [&](Entry const& entry) {
+        return entry.forced->tryMeasureForced(measRecord, exposure, refRecord, refWcs);
+    });
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
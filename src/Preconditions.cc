@@ -0,0 +1,219 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include <cmath>
+#include <limits>
+
+#include "boost/format.hpp"
+
+#include "lsst/log/Log.h"
+#include "lsst/pex/exceptions.h"
+#include "lsst/afw/detection/Footprint.h"
+#include "lsst/meas/base/exceptions.h"
+#include "lsst/meas/base/Preconditions.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+std::size_t Preconditions::_index(Condition condition) {
+    switch (condition) {
+        case CENTROID:
+            return 0;
+        case SHAPE:
+            return 1;
+        case ON_IMAGE:
+            return 2;
+        case GOOD_PIXELS:
+            return 3;
+        default:
+            throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                              (boost::format("Invalid precondition %d") % condition).str());
+    }
+}
+
+Preconditions& Preconditions::require(Condition condition, int flagBit) {
+    _flagBits[_index(condition)] = flagBit;
+    _conditions |= condition;
+    return *this;
+}
+
+Preconditions& Preconditions::requireGoodPixelFraction(double minFraction, int flagBit) {
+    if (!(minFraction >= 0.0 && minFraction <= 1.0)) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("Good pixel fraction %g is not in [0, 1]") % minFraction).str());
+    }
+    _minGoodPixelFraction = minFraction;
+    return require(GOOD_PIXELS, flagBit);
+}
+
+int Preconditions::getFlagBit(Condition condition) const { return _flagBits[_index(condition)]; }
+
+std::string Preconditions::getConditionName(Condition condition) {
+    switch (condition) {
+        case NONE:
+            return "none";
+        case CENTROID:
+            return "centroid";
+        case SHAPE:
+            return "shape";
+        case ON_IMAGE:
+            return "on-image";
+        case GOOD_PIXELS:
+            return "good-pixels";
+    }
+    return "unknown";
+}
+
+SourceConditions::SourceConditions(afw::table::SourceRecord const& record,
+                                   afw::image::Exposure<float> const& exposure,
+                                   afw::image::MaskPixel badBits)
+        : _record(record), _exposure(exposure), _badBits(badBits) {}
+
+void SourceConditions::_evaluatePosition() const {
+    if (_evaluated & POSITION) {
+        return;
+    }
+    _evaluated |= POSITION;
+    // As in SafeCentroidExtractor, a NaN centroid is replaced by the Footprint peak only if it is flagged.
+    afw::table::CentroidSlotDefinition const& slot = _record.getTable()->getCentroidSlot();
+    auto const measKey = slot.getMeasKey();
+    auto const flagKey = slot.getFlagKey();
+    geom::Point2D position(std::numeric_limits<double>::quiet_NaN());
+    bool usePeak = !measKey.isValid();
+    if (!usePeak) {
+        position = _record.get(measKey);
+        usePeak = (std::isnan(position.getX()) || std::isnan(position.getY())) && flagKey.isValid() &&
+                  _record.get(flagKey);
+    }
+    if (usePeak) {
+        auto const footprint = _record.getFootprint();
+        if (footprint && !footprint->getPeaks().empty()) {
+            position = geom::Point2D(footprint->getPeaks().front().getFx(),
+                                     footprint->getPeaks().front().getFy());
+        }
+    }
+    bool const finite = std::isfinite(position.getX()) && std::isfinite(position.getY());
+    // An undefined slot is a configuration error, which is left for the algorithm to report.
+    _hasCentroid = finite || !measKey.isValid();
+    _onImage = !finite || _exposure.getBBox().contains(
+                                  geom::Point2I(static_cast<int>(std::floor(position.getX() + 0.5)),
+                                                static_cast<int>(std::floor(position.getY() + 0.5))));
+}
+
+bool SourceConditions::hasCentroid() const {
+    _evaluatePosition();
+    return _hasCentroid;
+}
+
+bool SourceConditions::hasShape() const {
+    if (!(_evaluated & SHAPE_VALUE)) {
+        _evaluated |= SHAPE_VALUE;
+        auto const measKey = _record.getTable()->getShapeSlot().getMeasKey();
+        if (!measKey.isValid()) {
+            _hasShape = true;
+        } else {
+            afw::geom::ellipses::Quadrupole const shape = _record.get(measKey);
+            // The same test as SafeShapeExtractor's; written so that it is false if any moment is NaN.
+            _hasShape = shape.getIxx() * shape.getIyy() >= (1.0 + 1.0e-6) * shape.getIxy() * shape.getIxy();
+        }
+    }
+    return _hasShape;
+}
+
+bool SourceConditions::isOnImage() const {
+    _evaluatePosition();
+    return _onImage;
+}
+
+double SourceConditions::getGoodPixelFraction() const {
+    if (!(_evaluated & PIXELS)) {
+        _evaluated |= PIXELS;
+        auto const footprint = _record.getFootprint();
+        if (footprint && footprint->getArea() > 0) {
+            auto const clipped = footprint->getSpans()->clippedTo(_exposure.getBBox());
+            std::size_t nGood = clipped->getArea();
+            if (_badBits && nGood > 0) {
+                afw::image::Mask<afw::image::MaskPixel> const& mask = *_exposure.getMaskedImage().getMask();
+                for (auto const& span : *clipped) {
+                    auto iter = mask.x_at(span.getMinX() - mask.getX0(), span.getY() - mask.getY0());
+                    for (int x = span.getMinX(); x <= span.getMaxX(); ++x, ++iter) {
+                        if (*iter & _badBits) {
+                            --nGood;
+                        }
+                    }
+                }
+            }
+            _goodPixelFraction = static_cast<double>(nGood) / footprint->getArea();
+        }
+    }
+    return _goodPixelFraction;
+}
+
+Preconditions::Condition SourceConditions::check(Preconditions const& preconditions) const {
+    if (preconditions.isRequired(Preconditions::CENTROID) && !hasCentroid()) {
+        return Preconditions::CENTROID;
+    }
+    if (preconditions.isRequired(Preconditions::SHAPE) && !hasShape()) {
+        return Preconditions::SHAPE;
+    }
+    if (preconditions.isRequired(Preconditions::ON_IMAGE) && !isOnImage()) {
+        return Preconditions::ON_IMAGE;
+    }
+    if (preconditions.isRequired(Preconditions::GOOD_PIXELS)) {
+        double const fraction = getGoodPixelFraction();
+        if (fraction <= 0.0 || fraction < preconditions.getMinGoodPixelFraction()) {
+            return Preconditions::GOOD_PIXELS;
+        }
+    }
+    return Preconditions::NONE;
+}
+
+bool SourceConditions::apply(Preconditions const& preconditions, BaseAlgorithm const& algorithm,
+                             afw::table::SourceRecord& measRecord, std::string const& logName) const {
+    if (preconditions.empty()) {
+        return true;
+    }
+    Preconditions::Condition const failed = check(preconditions);
+    if (failed == Preconditions::NONE) {
+        return true;
+    }
+    std::string const message = (boost::format("%s precondition not satisfied") %
+                                 Preconditions::getConditionName(failed))
+                                        .str();
+    std::string const log = logName.empty() ? algorithm.getLogName() : logName;
+    LOGL_DEBUG(log, "Skipping measurement of record %lld: %s", measRecord.getId(), message.c_str());
+    int const flagBit = preconditions.getFlagBit(failed);
+    if (flagBit < 0) {
+        algorithm.fail(measRecord);
+    } else {
+        MeasurementError error(message, flagBit);
+        algorithm.fail(measRecord, &error);
+    }
+    return false;
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -22,16 +22,22 @@
  * see <http://www.lsstcorp.org/LegalNotices/>.
  */
 
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <limits>
+#include <vector>
 
-#include "ndarray/eigen.h"
+#include "boost/format.hpp"
+#include "Eigen/Core"
+#include "Eigen/Cholesky"
 
 #include "lsst/afw/table/Source.h"
 #include "lsst/afw/detection/Psf.h"
 #include "lsst/log/Log.h"
-#include "lsst/afw/geom/SpanSet.h"
 #include "lsst/meas/base/PsfFlux.h"
+#include "lsst/meas/base/FluxKernelBackend.h"
+#include "lsst/meas/base/ResultBuffer.h"
 
 namespace lsst {
 namespace meas {
@@ -48,7 +54,120 @@ FlagDefinition const PsfFluxAlgorithm::EDGE = flagDefinitions.add(
 
 FlagDefinitionList const& PsfFluxAlgorithm::getFlagDefinitions() { return flagDefinitions; }
 
-namespace {}  // namespace
+namespace {
+
+// The number of records whose Psf model images measureBatch holds at once.
+std::size_t const BATCH_CHUNK_SIZE = 1024;
+
+// A source whose amplitude is fit by PsfFluxAlgorithm::measureN.
+struct FamilyMember {
+    afw::table::SourceRecord* record;
+    std::shared_ptr<afw::detection::Psf::Image> model;
+    geom::Box2I bbox;  // bbox of the model, clipped to the image
+    StaticFlagHandler<3>::Flags flags;
+    double modelSum;   // sum(model)
+    double modelNorm;  // sum(model^2)
+    std::size_t area;  // number of unmasked pixels in bbox
+};
+
+// The normal equations of a family fit, and the matrix that propagates the variance through them.
+struct FamilySums {
+    explicit FamilySums(std::size_t n)
+            : modelSquared(Eigen::MatrixXd::Zero(n, n)),
+              modelSquaredVariance(Eigen::MatrixXd::Zero(n, n)),
+              modelData(Eigen::VectorXd::Zero(n)) {}
+
+    Eigen::MatrixXd modelSquared;          // sum(weight*model_k*model_l)
+    Eigen::MatrixXd modelSquaredVariance;  // sum(weight^2*model_k*model_l*variance)
+    Eigen::VectorXd modelData;             // sum(weight*model_k*data)
+};
+
+// Accumulate the sums of products of the models of members k and l over the unmasked pixels of the
+// intersection of their boxes; for k == l, also accumulate the sums that involve a single model.
+template <typename WeightingT>
+void accumulatePair(FamilyMember& a, FamilyMember const& b, std::size_t k, std::size_t l,
+                    afw::image::MaskedImage<float> const& image, afw::image::MaskPixel badBits,
+                    WeightingT weighting, FamilySums& sums) {
+    geom::Box2I overlap(a.bbox);
+    overlap.clip(b.bbox);
+    if (overlap.isEmpty()) {
+        return;
+    }
+    bool const diagonal = (k == l);
+    auto const modelA = a.model->getArray();
+    auto const modelB = b.model->getArray();
+    auto const data = image.getImage()->getArray();
+    auto const variance = image.getVariance()->getArray();
+    auto const mask = image.getMask()->getArray();
+    double sumAB = 0.0, sumABV = 0.0, sumAD = 0.0, sumA = 0.0, sumAA = 0.0;
+    std::size_t area = 0;
+    int const width = overlap.getWidth();
+    for (int y = overlap.getMinY(); y <= overlap.getMaxY(); ++y) {
+        int const ix = overlap.getMinX() - image.getX0();
+        int const iy = y - image.getY0();
+        afw::detection::Psf::Pixel const* rowA =
+                modelA[y - a.model->getY0()].getData() + (overlap.getMinX() - a.model->getX0());
+        afw::detection::Psf::Pixel const* rowB =
+                modelB[y - b.model->getY0()].getData() + (overlap.getMinX() - b.model->getX0());
+        float const* dataRow = data[iy].getData() + ix;
+        float const* varianceRow = variance[iy].getData() + ix;
+        afw::image::MaskPixel const* maskRow = mask[iy].getData() + ix;
+        for (int i = 0; i < width; ++i) {
+            if (maskRow[i] & badBits) {
+                continue;
+            }
+            double const ma = rowA[i];
+            double const mb = rowB[i];
+            double const w = weighting(varianceRow[i]);
+            sumAB += w * ma * mb;
+            sumABV += w * w * ma * mb * varianceRow[i];
+            if (diagonal) {
+                sumAD += w * ma * dataRow[i];
+                sumA += ma;
+                sumAA += ma * ma;
+                ++area;
+            }
+        }
+    }
+    sums.modelSquared(k, l) = sums.modelSquared(l, k) = sumAB;
+    sums.modelSquaredVariance(k, l) = sums.modelSquaredVariance(l, k) = sumABV;
+    if (diagonal) {
+        sums.modelData[k] = sumAD;
+        a.modelSum = sumA;
+        a.modelNorm = sumAA;
+        a.area = area;
+    }
+}
+
+// Accumulate the normal equations of a family fit.  The diagonal is done first, and members with no
+// unmasked pixels are removed (and returned) before the off-diagonal terms are accumulated.
+template <typename WeightingT>
+FamilySums accumulateFamily(std::vector<FamilyMember>& members, std::vector<FamilyMember>& empty,
+                            afw::image::MaskedImage<float> const& image, afw::image::MaskPixel badBits,
+                            WeightingT weighting) {
+    {
+        FamilySums diagonal(members.size());
+        for (std::size_t k = 0; k < members.size(); ++k) {
+            accumulatePair(members[k], members[k], k, k, image, badBits, weighting, diagonal);
+        }
+        std::vector<FamilyMember> usable;
+        usable.reserve(members.size());
+        for (auto& member : members) {
+            (member.area > 0 ? usable : empty).push_back(member);
+        }
+        members.swap(usable);
+    }
+    std::size_t const n = members.size();
+    FamilySums sums(n);
+    for (std::size_t k = 0; k < n; ++k) {
+        for (std::size_t l = k; l < n; ++l) {
+            accumulatePair(members[k], members[l], k, l, image, badBits, weighting, sums);
+        }
+    }
+    return sums;
+}
+
+}  // namespace
 
 PsfFluxAlgorithm::PsfFluxAlgorithm(Control const& ctrl, std::string const& name, afw::table::Schema& schema,
                                    std::string const& logName)
@@ -58,62 +177,266 @@ PsfFluxAlgorithm::PsfFluxAlgorithm(Control const& ctrl, std::string const& name,
           _areaKey(schema.addField<float>(name + "_area", "effective area of PSF", "pixel")),
           _centroidExtractor(schema, name) {
     _logName = logName.size() ? logName : name;
-    _flagHandler = FlagHandler::addFields(schema, name, getFlagDefinitions());
+    _flagHandler = StaticFlagHandler<3>::addFields(schema, name, getFlagDefinitions());
 }
 
 void PsfFluxAlgorithm::measure(afw::table::SourceRecord& measRecord,
                                afw::image::Exposure<float> const& exposure) const {
-    PTR(afw::detection::Psf const) psf = exposure.getPsf();
-    if (!psf) {
-        LOGL_ERROR(getLogName(), "PsfFlux: no psf attached to exposure");
-        throw LSST_EXCEPT(FatalAlgorithmError, "PsfFlux algorithm requires a Psf with every exposure");
+    tryMeasure(measRecord, exposure).throwIfFailed();
+}
+
+MeasurementStatus PsfFluxAlgorithm::tryMeasure(afw::table::SourceRecord& measRecord,
+                                               afw::image::Exposure<float> const& exposure) const {
+    return _measure(measRecord, exposure, nullptr);
+}
+
+MeasurementStatus PsfFluxAlgorithm::_measure(
+        afw::table::SourceRecord& measRecord, afw::image::Exposure<float> const& exposure,
+        std::shared_ptr<afw::detection::Psf::Image const> psfImage) const {
+    if (!psfImage) {
+        PTR(afw::detection::Psf const) psf = exposure.getPsf();
+        if (!psf) {
+            LOGL_ERROR(getLogName(), "PsfFlux: no psf attached to exposure");
+            throw LSST_EXCEPT(FatalAlgorithmError, "PsfFlux algorithm requires a Psf with every exposure");
+        }
+        geom::Point2D position = _centroidExtractor(measRecord, _flagHandler.getFlagHandler());
+        psfImage = psf->computeImage(position);
     }
-    geom::Point2D position = _centroidExtractor(measRecord, _flagHandler);
-    PTR(afw::detection::Psf::Image) psfImage = psf->computeImage(position);
     geom::Box2I fitBBox = psfImage->getBBox();
     fitBBox.clip(exposure.getBBox());
+    // Flags are accumulated here and written to the record once, before any return or throw.
+    StaticFlagHandler<3>::Flags flags;
     if (fitBBox != psfImage->getBBox()) {
-        _flagHandler.setValue(measRecord, FAILURE.number,
-                              true);  // if we had a suspect flag, we'd set that instead
-        _flagHandler.setValue(measRecord, EDGE.number, true);
-    }
-    auto fitRegionSpans = std::make_shared<afw::geom::SpanSet>(fitBBox);
-    afw::detection::Footprint fitRegion(fitRegionSpans);
-    if (!_ctrl.badMaskPlanes.empty()) {
-        afw::image::MaskPixel badBits = 0x0;
-        for (std::vector<std::string>::const_iterator i = _ctrl.badMaskPlanes.begin();
-             i != _ctrl.badMaskPlanes.end(); ++i) {
-            badBits |= exposure.getMaskedImage().getMask()->getPlaneBitMask(*i);
-        }
-        fitRegion.setSpans(fitRegion.getSpans()
-                                   ->intersectNot(*exposure.getMaskedImage().getMask(), badBits)
-                                   ->clippedTo(exposure.getMaskedImage().getMask()->getBBox()));
-    }
-    if (fitRegion.getArea() == 0) {
-        throw LSST_EXCEPT(MeasurementError, NO_GOOD_PIXELS.doc, NO_GOOD_PIXELS.number);
-    }
-    typedef afw::detection::Psf::Pixel PsfPixel;
-    // SpanSet::flatten returns a new ndarray::Array, which must stay in scope
-    // while we use an Eigen::Map view of it
-    auto modelNdArray = fitRegion.getSpans()->flatten(psfImage->getArray(), psfImage->getXY0());
-    auto dataNdArray = fitRegion.getSpans()->flatten(exposure.getMaskedImage().getImage()->getArray(),
-                                                     exposure.getXY0());
-    auto varianceNdArray = fitRegion.getSpans()->flatten(exposure.getMaskedImage().getVariance()->getArray(),
-                                                         exposure.getXY0());
-    auto model = ndarray::asEigenMatrix(modelNdArray);
-    auto data = ndarray::asEigenMatrix(dataNdArray);
-    auto variance = ndarray::asEigenMatrix(varianceNdArray);
-    PsfPixel alpha = model.squaredNorm();
+        flags.set(FAILURE);  // if we had a suspect flag, we'd set that instead
+        flags.set(EDGE);
+    }
+    afw::image::MaskPixel badBits = 0;
+    try {
+        badBits = _ctrl.badMaskPlanes.empty() ? 0 : _getBadBits(*exposure.getMaskedImage().getMask());
+    } catch (...) {
+        // e.g. an unknown mask plane; keep the edge flags, as measure always has.
+        _flagHandler.commit(measRecord, flags);
+        throw;
+    }
+    afw::image::MaskedImage<float> const& image = exposure.getMaskedImage();
+    ModelFitSums const sums = accumulateModelFit(*psfImage, image, fitBBox, badBits, _ctrl.useWeights);
+    if (sums.area == 0) {
+        _flagHandler.commit(measRecord, flags);
+        return MeasurementStatus(NO_GOOD_PIXELS);
+    }
+    double const alpha = sums.modelSquared;
     FluxResult result;
-    result.instFlux = model.dot(data.cast<PsfPixel>()) / alpha;
+    result.instFlux = sums.modelData / alpha;
     // If we're not using per-pixel weights to compute the instFlux, we'll still want to compute the
-    // variance as if we had, so we'll apply the weights to the model now, and update alpha.
-    result.instFluxErr = std::sqrt(model.array().square().matrix().dot(variance.cast<PsfPixel>())) / alpha;
-    measRecord.set(_areaKey, model.sum() / alpha);
+    // variance as if we had, so we propagate the variance through the (weighted) model.
+    result.instFluxErr = std::sqrt(sums.modelSquaredVariance) / alpha;
+    // The effective area is a property of the PSF model, regardless of the weighting.
+    measRecord.set(_areaKey, sums.modelSum / sums.modelNorm);
+    _flagHandler.commit(measRecord, flags);
     if (!std::isfinite(result.instFlux) || !std::isfinite(result.instFluxErr)) {
         throw LSST_EXCEPT(PixelValueError, "Invalid pixel value detected in image.");
     }
     measRecord.set(_instFluxResultKey, result);
+    return MeasurementStatus();
+}
+
+void PsfFluxAlgorithm::measureBatch(afw::table::SourceCatalog& measCat,
+                                    afw::image::Exposure<float> const& exposure,
+                                    std::vector<std::size_t> const& indices) const {
+    PTR(afw::detection::Psf const) psf = exposure.getPsf();
+    if (!psf || indices.empty()) {
+        // Let the per-record loop report the missing Psf.
+        SingleFrameAlgorithm::measureBatch(measCat, exposure, indices);
+        return;
+    }
+    afw::image::MaskedImage<float> const& image = exposure.getMaskedImage();
+    afw::image::MaskPixel badBits = 0;
+    try {
+        badBits = _ctrl.badMaskPlanes.empty() ? 0 : _getBadBits(*image.getMask());
+    } catch (std::exception&) {
+        // e.g. an unknown mask plane; let the per-record loop fail the records one at a time.
+        SingleFrameAlgorithm::measureBatch(measCat, exposure, indices);
+        return;
+    }
+    auto const centroidExtractor = _centroidExtractor.bind(*measCat.getTable());
+    // The Psf model images are gathered and fit a chunk of records at a time, so that only a bounded
+    // number of them are held at once however large the batch is.
+    for (std::size_t begin = 0; begin < indices.size(); begin += BATCH_CHUNK_SIZE) {
+        std::size_t const end = std::min(indices.size(), begin + BATCH_CHUNK_SIZE);
+        // Records that are flagged at any point are measured one at a time afterwards, by the per-record
+        // loop, which sets their flags and reports their errors exactly as measure does; only the stamps
+        // of the others are handed to the backend.
+        std::vector<std::size_t> stampIndices;
+        std::vector<ModelStamp> stamps;
+        std::vector<std::size_t> fallbackIndices;
+        // The Psf model image of each fallback record, if it has already been computed (null otherwise).
+        std::vector<std::shared_ptr<afw::detection::Psf::Image const>> fallbackModels;
+        stampIndices.reserve(end - begin);
+        stamps.reserve(end - begin);
+        for (std::size_t i = begin; i < end; ++i) {
+            afw::table::SourceRecord& measRecord = measCat.at(indices[i]);
+            ModelStamp stamp;
+            try {
+                geom::Point2D const position = centroidExtractor(measRecord, _flagHandler.getFlagHandler());
+                if (_flagHandler.getValue(measRecord, FAILURE.number)) {
+                    fallbackIndices.push_back(indices[i]);
+                    fallbackModels.push_back(nullptr);
+                    continue;
+                }
+                stamp.model = psf->computeImage(position);
+            } catch (std::exception&) {
+                fallbackIndices.push_back(indices[i]);
+                fallbackModels.push_back(nullptr);
+                continue;
+            }
+            stamp.bbox = stamp.model->getBBox();
+            stamp.bbox.clip(exposure.getBBox());
+            if (stamp.bbox != stamp.model->getBBox()) {
+                fallbackIndices.push_back(indices[i]);
+                fallbackModels.push_back(stamp.model);
+                continue;
+            }
+            stampIndices.push_back(indices[i]);
+            stamps.push_back(stamp);
+        }
+
+        std::vector<ModelFitSums> const sums = FluxKernelBackend::getDefault()->accumulateModelFits(
+                stamps, image, badBits, _ctrl.useWeights);
+        if (sums.size() != stamps.size()) {
+            throw LSST_EXCEPT(pex::exceptions::LogicError,
+                              (boost::format("Flux kernel backend returned %d results for %d stamps") %
+                               sums.size() % stamps.size())
+                                      .str());
+        }
+
+        std::vector<std::size_t> resultIndices;
+        std::vector<FluxResult> fluxes;
+        std::vector<double> areas;
+        resultIndices.reserve(stamps.size());
+        fluxes.reserve(stamps.size());
+        areas.reserve(stamps.size());
+        for (std::size_t i = 0; i < stamps.size(); ++i) {
+            FluxResult result;
+            double const alpha = sums[i].modelSquared;
+            result.instFlux = sums[i].modelData / alpha;
+            result.instFluxErr = std::sqrt(sums[i].modelSquaredVariance) / alpha;
+            if (sums[i].area == 0 || !std::isfinite(result.instFlux) || !std::isfinite(result.instFluxErr)) {
+                fallbackIndices.push_back(stampIndices[i]);
+                fallbackModels.push_back(stamps[i].model);
+                continue;
+            }
+            resultIndices.push_back(stampIndices[i]);
+            fluxes.push_back(result);
+            areas.push_back(sums[i].modelSum / sums[i].modelNorm);
+        }
+        ResultBuffer results(resultIndices.size());
+        ResultBuffer::Column<Flux> const instFlux = results.addColumn(_instFluxResultKey.getInstFlux());
+        ResultBuffer::Column<FluxErrElement> const instFluxErr =
+                results.addColumn(_instFluxResultKey.getInstFluxErr());
+        ResultBuffer::Column<float> const area = results.addColumn(_areaKey);
+        for (std::size_t i = 0; i < resultIndices.size(); ++i) {
+            instFlux[i] = fluxes[i].instFlux;
+            instFluxErr[i] = fluxes[i].instFluxErr;
+            area[i] = areas[i];
+        }
+        results.commit(measCat, resultIndices);
+
+        // measureEach visits the fallback records in order, so the models can be taken in turn.
+        std::size_t next = 0;
+        measureEach(measCat, fallbackIndices,
+                    [this, &exposure, &fallbackModels, &next](afw::table::SourceRecord& measRecord) {
+                        return _measure(measRecord, exposure, fallbackModels[next++]);
+                    });
+    }
+}
+
+void PsfFluxAlgorithm::measureN(afw::table::SourceCatalog const& measCat,
+                                afw::image::Exposure<float> const& exposure) const {
+    if (measCat.empty()) {
+        return;
+    }
+    PTR(afw::detection::Psf const) psf = exposure.getPsf();
+    if (!psf) {
+        LOGL_ERROR(getLogName(), "PsfFlux: no psf attached to exposure");
+        throw LSST_EXCEPT(FatalAlgorithmError, "PsfFlux algorithm requires a Psf with every exposure");
+    }
+    auto const centroidExtractor = _centroidExtractor.bind(*measCat.getTable());
+    std::vector<FamilyMember> members;
+    members.reserve(measCat.size());
+    for (auto& measRecord : measCat) {
+        FamilyMember member;
+        member.record = &measRecord;
+        geom::Point2D position;
+        try {
+            position = centroidExtractor(measRecord, _flagHandler.getFlagHandler());
+        } catch (pex::exceptions::RuntimeError& error) {
+            LOGL_DEBUG(getLogName(), "Exception in measureN on record %lld: %s", measRecord.getId(),
+                       error.what());
+            fail(measRecord);
+            continue;
+        }
+        member.model = psf->computeImage(position);
+        member.bbox = member.model->getBBox();
+        member.bbox.clip(exposure.getBBox());
+        if (member.bbox != member.model->getBBox()) {
+            member.flags.set(FAILURE);  // if we had a suspect flag, we'd set that instead
+            member.flags.set(EDGE);
+        }
+        member.area = 0;
+        members.push_back(member);
+    }
+
+    afw::image::MaskedImage<float> const& image = exposure.getMaskedImage();
+    afw::image::MaskPixel const badBits = _getBadBits(*image.getMask());
+    std::vector<FamilyMember> empty;
+    FamilySums const sums =
+            _ctrl.useWeights ? accumulateFamily(members, empty, image, badBits, InverseVarianceWeight())
+                             : accumulateFamily(members, empty, image, badBits, UnitWeight());
+    for (auto& member : empty) {
+        member.flags.set(FAILURE);
+        member.flags.set(NO_GOOD_PIXELS);
+        _flagHandler.commit(*member.record, member.flags);
+    }
+    if (members.empty()) {
+        return;
+    }
+
+    // Solve the normal equations; for the uncertainties, propagate the variance through the (weighted)
+    // models, as in measure.
+    Eigen::LLT<Eigen::MatrixXd> const solver(sums.modelSquared);
+    if (solver.info() != Eigen::Success) {
+        for (auto const& member : members) {
+            _flagHandler.commit(*member.record, member.flags);
+        }
+        throw LSST_EXCEPT(MeasurementError, "Psf models of the sources are degenerate", FAILURE.number);
+    }
+    Eigen::VectorXd const instFlux = solver.solve(sums.modelData);
+    Eigen::MatrixXd const inverse = solver.solve(Eigen::MatrixXd::Identity(members.size(), members.size()));
+    Eigen::MatrixXd const covariance = inverse * sums.modelSquaredVariance * inverse;
+    for (std::size_t k = 0; k < members.size(); ++k) {
+        FamilyMember const& member = members[k];
+        afw::table::SourceRecord& measRecord = *member.record;
+        measRecord.set(_areaKey, member.modelSum / member.modelNorm);
+        _flagHandler.commit(measRecord, member.flags);
+        FluxResult const result(instFlux[k], std::sqrt(covariance(k, k)));
+        if (!std::isfinite(result.instFlux) || !std::isfinite(result.instFluxErr)) {
+            LOGL_DEBUG(getLogName(), "Invalid pixel value in measureN fit of record %lld",
+                       measRecord.getId());
+            fail(measRecord);
+            continue;
+        }
+        measRecord.set(_instFluxResultKey, result);
+    }
+}
+
+afw::image::MaskPixel PsfFluxAlgorithm::_getBadBits(
+        afw::image::Mask<afw::image::MaskPixel> const& mask) const {
+    afw::image::MaskPixel badBits = 0x0;
+    for (std::vector<std::string>::const_iterator i = _ctrl.badMaskPlanes.begin();
+         i != _ctrl.badMaskPlanes.end(); ++i) {
+        badBits |= mask.getPlaneBitMask(*i);
+    }
+    return badBits;
 }
 
 void PsfFluxAlgorithm::fail(afw::table::SourceRecord& measRecord, MeasurementError* error) const {
@@ -0,0 +1,214 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include <cmath>
+#include <limits>
+
+#include "boost/format.hpp"
+#include "ndarray.h"
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/afw/geom/ellipses/Quadrupole.h"
+#include "lsst/meas/base/ReferenceTransform.h"
+#include "lsst/meas/base/ResultBuffer.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+namespace {
+
+void checkLengths(afw::table::SourceCatalog const& measCat, afw::table::SourceCatalog const& refCat) {
+    if (measCat.size() != refCat.size()) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("Measurement catalog has %d records, reference catalog %d") %
+                           measCat.size() % refCat.size())
+                                  .str());
+    }
+}
+
+std::vector<std::size_t> makeIndices(std::size_t n) {
+    std::vector<std::size_t> indices(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        indices[i] = i;
+    }
+    return indices;
+}
+
+}  // namespace
+
+ReferenceTransform::ReferenceTransform(afw::geom::SkyWcs const& refWcs, afw::geom::SkyWcs const& measWcs) {
+    if (!(refWcs == measWcs)) {
+        _transform = afw::geom::makeWcsPairTransform(refWcs, measWcs);
+    }
+}
+
+std::vector<geom::Point2D> ReferenceTransform::transformPoints(
+        std::vector<geom::Point2D> const& points) const {
+    if (!_transform || points.empty()) {
+        return points;
+    }
+    ndarray::Array<double, 2, 2> input = ndarray::allocate(2, points.size());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        input[0][i] = points[i].getX();
+        input[1][i] = points[i].getY();
+    }
+    ndarray::Array<double, 2, 2> const output = _transform->applyForward(input);
+    std::vector<geom::Point2D> result;
+    result.reserve(points.size());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        result.emplace_back(output[0][i], output[1][i]);
+    }
+    return result;
+}
+
+std::vector<geom::LinearTransform> ReferenceTransform::computeLocalLinearTransforms(
+        std::vector<geom::Point2D> const& points) const {
+    if (!_transform) {
+        return std::vector<geom::LinearTransform>(points.size());
+    }
+    // The Jacobian of the transform itself, as used by afw::geom::linearizeTransform, so the results
+    // are identical to those of the per-source plugins.
+    std::vector<geom::LinearTransform> result;
+    result.reserve(points.size());
+    geom::LinearTransform const invalid(
+            geom::LinearTransform::Matrix::Constant(std::numeric_limits<double>::quiet_NaN()));
+    for (auto const& point : points) {
+        if (!std::isfinite(point.getX()) || !std::isfinite(point.getY())) {
+            result.push_back(invalid);
+            continue;
+        }
+        result.emplace_back(_transform->getJacobian(point));
+    }
+    return result;
+}
+
+void ReferenceTransform::transformCentroids(afw::table::SourceCatalog& measCat,
+                                            afw::table::SourceCatalog const& refCat,
+                                            afw::table::Point2DKey const& centroidKey,
+                                            afw::table::Key<afw::table::Flag> const& flagKey) const {
+    checkLengths(measCat, refCat);
+    auto const& refSlot = refCat.getTable()->getCentroidSlot();
+    if (!refSlot.getMeasKey().isValid()) {
+        throw LSST_EXCEPT(pex::exceptions::LogicError, "Reference catalog has no centroid slot");
+    }
+    std::vector<geom::Point2D> refPoints;
+    refPoints.reserve(refCat.size());
+    for (auto const& refRecord : refCat) {
+        refPoints.push_back(refRecord.get(refSlot.getMeasKey()));
+    }
+    std::vector<geom::Point2D> const points = transformPoints(refPoints);
+
+    ResultBuffer results(measCat.size());
+    ResultBuffer::Column<double> const x = results.addColumn(centroidKey.getX());
+    ResultBuffer::Column<double> const y = results.addColumn(centroidKey.getY());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        x[i] = points[i].getX();
+        y[i] = points[i].getY();
+    }
+    results.commit(measCat, makeIndices(measCat.size()));
+    if (flagKey.isValid() && refSlot.getFlagKey().isValid()) {
+        for (std::size_t i = 0; i < measCat.size(); ++i) {
+            measCat[i].set(flagKey, refCat[i].get(refSlot.getFlagKey()));
+        }
+    }
+}
+
+void ReferenceTransform::transformShapes(afw::table::SourceCatalog& measCat,
+                                         afw::table::SourceCatalog const& refCat,
+                                         afw::table::QuadrupoleKey const& shapeKey,
+                                         afw::table::Key<afw::table::Flag> const& flagKey) const {
+    checkLengths(measCat, refCat);
+    auto const& refCentroidSlot = refCat.getTable()->getCentroidSlot();
+    auto const& refShapeSlot = refCat.getTable()->getShapeSlot();
+    if (!refShapeSlot.getMeasKey().isValid() || (_transform && !refCentroidSlot.getMeasKey().isValid())) {
+        throw LSST_EXCEPT(pex::exceptions::LogicError, "Reference catalog has no centroid or shape slot");
+    }
+    std::vector<geom::LinearTransform> linear;
+    if (_transform) {
+        std::vector<geom::Point2D> refPoints;
+        refPoints.reserve(refCat.size());
+        for (auto const& refRecord : refCat) {
+            refPoints.push_back(refRecord.get(refCentroidSlot.getMeasKey()));
+        }
+        linear = computeLocalLinearTransforms(refPoints);
+    }
+
+    ResultBuffer results(measCat.size());
+    ResultBuffer::Column<double> const xx = results.addColumn(shapeKey.getIxx());
+    ResultBuffer::Column<double> const yy = results.addColumn(shapeKey.getIyy());
+    ResultBuffer::Column<double> const xy = results.addColumn(shapeKey.getIxy());
+    for (std::size_t i = 0; i < refCat.size(); ++i) {
+        afw::geom::ellipses::Quadrupole shape = refCat[i].get(refShapeSlot.getMeasKey());
+        if (_transform) {
+            shape.transform(linear[i]).inPlace();
+        }
+        xx[i] = shape.getIxx();
+        yy[i] = shape.getIyy();
+        xy[i] = shape.getIxy();
+    }
+    results.commit(measCat, makeIndices(measCat.size()));
+    if (flagKey.isValid() && refShapeSlot.getFlagKey().isValid()) {
+        for (std::size_t i = 0; i < measCat.size(); ++i) {
+            measCat[i].set(flagKey, refCat[i].get(refShapeSlot.getFlagKey()));
+        }
+    }
+}
+
+void ReferenceTransform::transformPeaks(afw::table::SourceCatalog& measCat,
+                                        afw::table::SourceCatalog const& refCat,
+                                        afw::table::Point2DKey const& centroidKey,
+                                        afw::table::Key<afw::table::Flag> const& flagKey) const {
+    checkLengths(measCat, refCat);
+    double const nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<geom::Point2D> refPoints;
+    refPoints.reserve(refCat.size());
+    for (auto const& refRecord : refCat) {
+        auto const footprint = refRecord.getFootprint();
+        if (!footprint || footprint->getPeaks().empty()) {
+            refPoints.emplace_back(nan, nan);
+        } else {
+            refPoints.push_back(footprint->getPeaks().front().getF());
+        }
+    }
+    std::vector<geom::Point2D> const points = transformPoints(refPoints);
+
+    ResultBuffer results(measCat.size());
+    ResultBuffer::Column<double> const x = results.addColumn(centroidKey.getX());
+    ResultBuffer::Column<double> const y = results.addColumn(centroidKey.getY());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        x[i] = points[i].getX();
+        y[i] = points[i].getY();
+    }
+    results.commit(measCat, makeIndices(measCat.size()));
+    if (flagKey.isValid()) {
+        for (std::size_t i = 0; i < measCat.size(); ++i) {
+            measCat[i].set(flagKey, !std::isfinite(refPoints[i].getX()));
+        }
+    }
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
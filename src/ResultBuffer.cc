@@ -0,0 +1,95 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "boost/format.hpp"
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/meas/base/ResultBuffer.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+void ResultBuffer::FlagColumns::handleFailure(std::size_t row, MeasurementError const* error) const {
+    if (_failureFlagNumber != FlagDefinition::number_undefined) {
+        _columns[_failureFlagNumber].set(row);
+    }
+    if (error && error->getFlagBit() != FlagDefinition::number_undefined) {
+        _columns.at(error->getFlagBit()).set(row);
+    }
+}
+
+ResultBuffer::FlagColumn ResultBuffer::addFlagColumn(afw::table::Key<afw::table::Flag> const& key) {
+    if (!key.isValid()) {
+        return FlagColumn();
+    }
+    auto column = std::make_unique<BitColumn>(key, _nRows);
+    std::uint64_t* bits = column->bits.data();
+    _columns.push_back(std::move(column));
+    return FlagColumn(bits);
+}
+
+ResultBuffer::FlagColumns ResultBuffer::addFlagColumns(FlagHandler const& flagHandler) {
+    FlagColumns result;
+    result._failureFlagNumber = flagHandler.getFailureFlagNumber();
+    for (std::size_t i = 0; i < flagHandler.size(); ++i) {
+        result._columns.push_back(addFlagColumn(flagHandler.getFlagKey(i)));
+    }
+    return result;
+}
+
+void ResultBuffer::BitColumn::commit(std::vector<afw::table::BaseRecord*> const& records) const {
+    typedef afw::table::FieldBase<afw::table::Flag>::Element Element;
+    afw::table::Key<Element> const storage = key.getStorage();
+    Element const mask = Element(1) << key.getBit();
+    for (std::size_t w = 0; w < bits.size(); ++w) {
+        // Most flags are rarely set, so whole words of rows are usually skipped.
+        std::size_t row = 64 * w;
+        for (std::uint64_t word = bits[w]; word; word >>= 1, ++row) {
+            if (word & 1) {
+                *records[row]->getElement(storage) |= mask;
+            }
+        }
+    }
+}
+
+void ResultBuffer::commit(afw::table::SourceCatalog& catalog, std::vector<std::size_t> const& indices) const {
+    if (indices.size() != _nRows) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("Number of indices (%d) does not match the buffer (%d rows)") %
+                           indices.size() % _nRows)
+                                  .str());
+    }
+    std::vector<afw::table::BaseRecord*> records;
+    records.reserve(_nRows);
+    for (std::size_t index : indices) {
+        records.push_back(&catalog.at(index));
+    }
+    for (auto const& column : _columns) {
+        column->commit(records);
+    }
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
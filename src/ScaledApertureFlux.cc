@@ -21,6 +21,11 @@
  * see <http://www.lsstcorp.org/LegalNotices/>.
  */
 
+#include <cmath>
+
+#include "boost/format.hpp"
+
+#include "lsst/pex/exceptions.h"
 #include "lsst/afw/table/Source.h"
 #include "lsst/meas/base/ApertureFlux.h"
 #include "lsst/meas/base/ScaledApertureFlux.h"
@@ -37,7 +42,17 @@ ScaledApertureFluxAlgorithm::ScaledApertureFluxAlgorithm(Control const& ctrl, st
           _instFluxResultKey(
                   FluxResultKey::addFields(schema, name, "instFlux derived from PSF-scaled aperture")),
           _centroidExtractor(schema, name) {
-    _flagHandler = FlagHandler::addFields(schema, name, ApertureFluxAlgorithm::getFlagDefinitions());
+    // Scaled apertures are always circular, so their coefficients are never approximated.
+    _flagHandler = FlagHandler::addFields(schema, name, ApertureFluxAlgorithm::getFlagDefinitions(),
+                                          {ApertureFluxAlgorithm::SINC_COEFFS_APPROXIMATE});
+    if (_ctrl.radiusGridStep > 0.0) {
+        _interpErrKey = schema.addField<meas::base::FluxErrElement>(
+                schema.join(name, "instFluxInterpErr"),
+                "estimate of the error in instFlux due to interpolating between grid radii", "count");
+    } else if (_ctrl.radiusGridStep < 0.0) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("radiusGridStep = %f is negative") % _ctrl.radiusGridStep).str());
+    }
 }
 
 void ScaledApertureFluxAlgorithm::measure(afw::table::SourceRecord& measRecord,
@@ -53,8 +68,37 @@ void ScaledApertureFluxAlgorithm::measure(afw::table::SourceRecord& measRecord,
     ApertureFluxControl apCtrl;
     apCtrl.shiftKernel = _ctrl.shiftKernel;
 
-    Result result = ApertureFluxAlgorithm::computeSincFlux(
-            exposure.getMaskedImage(), afw::geom::ellipses::Ellipse(axes, center), apCtrl);
+    Result result;
+    if (_ctrl.radiusGridStep > 0.0) {
+        // Bracket the scaled radius with two radii on the logarithmic grid; their coefficients are
+        // circular, so once cached they are reused by every source whose radius falls in the same cell.
+        double const k = std::floor(std::log(size) / _ctrl.radiusGridStep);
+        float const rLo = std::exp(k * _ctrl.radiusGridStep);
+        float const rHi = std::exp((k + 1.0) * _ctrl.radiusGridStep);
+        SincCoeffs<float>::cache(0.0, rLo);
+        SincCoeffs<float>::cache(0.0, rHi);
+        Result const lo = ApertureFluxAlgorithm::computeSincFlux(
+                exposure.getMaskedImage(),
+                afw::geom::ellipses::Ellipse(afw::geom::ellipses::Axes(rLo, rLo), center), apCtrl);
+        Result const hi = ApertureFluxAlgorithm::computeSincFlux(
+                exposure.getMaskedImage(),
+                afw::geom::ellipses::Ellipse(afw::geom::ellipses::Axes(rHi, rHi), center), apCtrl);
+        // Interpolating linearly in radius or in area are equally plausible across a grid cell; the
+        // spread between the two is our estimate of the error of the one we report.
+        double const t = (size - rLo) / (rHi - rLo);
+        double const tArea = (size * size - rLo * rLo) / (static_cast<double>(rHi) * rHi - rLo * rLo);
+        result.instFlux = lo.instFlux + t * (hi.instFlux - lo.instFlux);
+        result.instFluxErr = lo.instFluxErr + t * (hi.instFluxErr - lo.instFluxErr);
+        for (unsigned int i = 0; i < ApertureFluxAlgorithm::N_FLAGS; ++i) {
+            if (lo.getFlag(i) || hi.getFlag(i)) {
+                result.setFlag(i);
+            }
+        }
+        measRecord.set(_interpErrKey, std::abs((tArea - t) * (hi.instFlux - lo.instFlux)));
+    } else {
+        result = ApertureFluxAlgorithm::computeSincFlux(
+                exposure.getMaskedImage(), afw::geom::ellipses::Ellipse(axes, center), apCtrl);
+    }
     measRecord.set(_instFluxResultKey, result);
 
     for (std::size_t i = 0; i < ApertureFluxAlgorithm::getFlagDefinitions().size(); i++) {
@@ -74,6 +118,9 @@ ScaledApertureFluxTransform::ScaledApertureFluxTransform(Control const& ctrl, st
         : FluxTransform{name, mapper} {
     for (std::size_t i = 0; i < ApertureFluxAlgorithm::getFlagDefinitions().size(); i++) {
         std::string flagName = ApertureFluxAlgorithm::getFlagDefinitions()[i].name;
+        if (mapper.getInputSchema().getNames().count(mapper.getInputSchema().join(name, flagName)) == 0) {
+            continue;
+        }
         afw::table::Key<afw::table::Flag> key =
                 mapper.getInputSchema().find<afw::table::Flag>(name + "_" + flagName).key;
         if (key.isValid()) {
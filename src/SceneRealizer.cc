@@ -0,0 +1,289 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <thread>
+
+#include "boost/format.hpp"
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/afw/geom/SpanSet.h"
+#include "lsst/meas/base/SceneRealizer.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+namespace {
+
+// An elliptical Gaussian, evaluated at pixel centers.
+class Profile {
+public:
+    explicit Profile(SceneSource const& source)
+            : _cx(source.center.getX()), _cy(source.center.getY()) {
+        double const ixx = source.shape.getIxx();
+        double const iyy = source.shape.getIyy();
+        double const ixy = source.shape.getIxy();
+        _det = ixx * iyy - ixy * ixy;
+        if (!(_det > 0.0) || !(ixx > 0.0) || !std::isfinite(_det)) {
+            throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                              (boost::format("Source moments (%g, %g, %g) are not positive definite") % ixx %
+                               iyy % ixy)
+                                      .str());
+        }
+        if (!std::isfinite(_cx) || !std::isfinite(_cy) || !std::isfinite(source.instFlux)) {
+            throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                              "Source center and flux must be finite");
+        }
+        _ixx = ixx;
+        _iyy = iyy;
+        _ixy = ixy;
+        _peak = source.instFlux / (2.0 * M_PI * std::sqrt(_det));
+    }
+
+    // Squared Mahalanobis distance of a pixel from the center.
+    double distanceSquared(int x, int y) const {
+        double const dx = x - _cx;
+        double const dy = y - _cy;
+        return (_iyy * dx * dx - 2.0 * _ixy * dx * dy + _ixx * dy * dy) / _det;
+    }
+
+    double operator()(int x, int y) const { return _peak * std::exp(-0.5 * distanceSquared(x, y)); }
+
+    double getPeak() const { return _peak; }
+
+    // The smallest box containing the ellipse of the given Mahalanobis radius.
+    geom::Box2I getBBox(double radius) const {
+        double const hx = radius * std::sqrt(_ixx);
+        double const hy = radius * std::sqrt(_iyy);
+        return geom::Box2I(geom::Point2I(std::floor(_cx - hx), std::floor(_cy - hy)),
+                           geom::Point2I(std::ceil(_cx + hx), std::ceil(_cy + hy)));
+    }
+
+    // The spans of the ellipse of the given squared Mahalanobis radius, clipped to bbox.
+    std::vector<afw::geom::Span> getSpans(double radiusSquared, geom::Box2I const& bbox) const {
+        std::vector<afw::geom::Span> spans;
+        double const hy = std::sqrt(_iyy * radiusSquared);
+        int const minY = std::max(static_cast<int>(std::ceil(_cy - hy)), bbox.getMinY());
+        int const maxY = std::min(static_cast<int>(std::floor(_cy + hy)), bbox.getMaxY());
+        for (int y = minY; y <= maxY; ++y) {
+            double const dy = y - _cy;
+            double const disc = _det * (_iyy * radiusSquared - dy * dy);
+            if (disc < 0.0) {
+                continue;
+            }
+            double const root = std::sqrt(disc);
+            int const x0 = std::max(static_cast<int>(std::ceil(_cx + (_ixy * dy - root) / _iyy)),
+                                    bbox.getMinX());
+            int const x1 = std::min(static_cast<int>(std::floor(_cx + (_ixy * dy + root) / _iyy)),
+                                    bbox.getMaxX());
+            if (x0 <= x1) {
+                spans.emplace_back(y, x0, x1);
+            }
+        }
+        return spans;
+    }
+
+private:
+    double _cx, _cy;
+    double _ixx, _iyy, _ixy;
+    double _det;
+    double _peak;
+};
+
+}  // namespace
+
+SceneRealizer::SceneRealizer(double threshold, int growRadius, double nSigma, int tileHeight)
+        : _threshold(threshold), _growRadius(growRadius), _nSigma(nSigma), _tileHeight(tileHeight) {
+    if (!(threshold > 0.0) || growRadius < 0 || !(nSigma > 0.0) || tileHeight <= 0) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("Invalid SceneRealizer parameters: threshold=%g, growRadius=%d, "
+                                         "nSigma=%g, tileHeight=%d") %
+                           threshold % growRadius % nSigma % tileHeight)
+                                  .str());
+    }
+}
+
+void SceneRealizer::render(std::vector<SceneSource> const& sources, afw::image::Image<float>& image,
+                           int nThreads) const {
+    geom::Box2I const bbox = image.getBBox();
+    if (bbox.isEmpty() || sources.empty()) {
+        return;
+    }
+    // Assign each source to the tiles its (truncated) profile overlaps.
+    int const nTiles = (bbox.getHeight() + _tileHeight - 1) / _tileHeight;
+    std::vector<Profile> profiles;
+    std::vector<geom::Box2I> boxes;
+    std::vector<std::vector<std::size_t>> tileSources(nTiles);
+    profiles.reserve(sources.size());
+    boxes.reserve(sources.size());
+    for (auto const& source : sources) {
+        profiles.emplace_back(source);
+        geom::Box2I box = profiles.back().getBBox(_nSigma);
+        box.clip(bbox);
+        boxes.push_back(box);
+        if (box.isEmpty()) {
+            continue;
+        }
+        int const first = (box.getMinY() - bbox.getMinY()) / _tileHeight;
+        int const last = (box.getMaxY() - bbox.getMinY()) / _tileHeight;
+        for (int tile = first; tile <= last; ++tile) {
+            tileSources[tile].push_back(profiles.size() - 1);
+        }
+    }
+
+    if (nThreads <= 0) {
+        nThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    nThreads = std::min(nThreads, nTiles);
+    double const radiusSquared = _nSigma * _nSigma;
+    int const width = bbox.getWidth();
+    auto const array = image.getArray();
+
+    // Each thread takes the next tile to render until there are none left; tiles do not share rows, so
+    // the threads never write the same pixels.
+    std::atomic<int> next(0);
+    std::vector<std::exception_ptr> errors(nThreads);
+    auto const work = [&](int thread) {
+        try {
+            std::vector<double> buffer;
+            for (int tile = next++; tile < nTiles; tile = next++) {
+                int const tileMinY = bbox.getMinY() + tile * _tileHeight;
+                int const tileMaxY = std::min(tileMinY + _tileHeight - 1, bbox.getMaxY());
+                buffer.assign(static_cast<std::size_t>(width) * (tileMaxY - tileMinY + 1), 0.0);
+                for (std::size_t i : tileSources[tile]) {
+                    Profile const& profile = profiles[i];
+                    geom::Box2I const& box = boxes[i];
+                    int const minY = std::max(box.getMinY(), tileMinY);
+                    int const maxY = std::min(box.getMaxY(), tileMaxY);
+                    for (int y = minY; y <= maxY; ++y) {
+                        double* row = buffer.data() + static_cast<std::size_t>(y - tileMinY) * width;
+                        for (int x = box.getMinX(); x <= box.getMaxX(); ++x) {
+                            double const q = profile.distanceSquared(x, y);
+                            if (q <= radiusSquared) {
+                                row[x - bbox.getMinX()] += profile.getPeak() * std::exp(-0.5 * q);
+                            }
+                        }
+                    }
+                }
+                for (int y = tileMinY; y <= tileMaxY; ++y) {
+                    float* pixels = array[y - bbox.getMinY()].getData();
+                    double const* row = buffer.data() + static_cast<std::size_t>(y - tileMinY) * width;
+                    for (int x = 0; x < width; ++x) {
+                        pixels[x] += row[x];
+                    }
+                }
+            }
+        } catch (...) {
+            errors[thread] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int thread = 1; thread < nThreads; ++thread) {
+        threads.emplace_back(work, thread);
+    }
+    work(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (std::exception_ptr const& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+std::vector<std::shared_ptr<afw::detection::Footprint>> SceneRealizer::makeFootprints(
+        std::vector<SceneSource> const& sources, geom::Box2I const& bbox) const {
+    std::vector<std::shared_ptr<afw::detection::Footprint>> result;
+    result.reserve(sources.size());
+    for (auto const& source : sources) {
+        Profile const profile(source);
+        std::shared_ptr<afw::geom::SpanSet> spans;
+        if (profile.getPeak() > _threshold) {
+            // The pixels above the threshold are those inside the isophote at the threshold.
+            spans = std::make_shared<afw::geom::SpanSet>(
+                    profile.getSpans(2.0 * std::log(profile.getPeak() / _threshold), bbox));
+        } else {
+            spans = std::make_shared<afw::geom::SpanSet>();
+        }
+        if (spans->empty()) {
+            result.push_back(std::make_shared<afw::detection::Footprint>(spans, bbox));
+            continue;
+        }
+        // Detection puts the Peak at the brightest pixel, which need not be the one nearest the center.
+        geom::Point2I peak;
+        double peakValue = -1.0;
+        for (auto const& span : *spans) {
+            for (int x = span.getMinX(); x <= span.getMaxX(); ++x) {
+                double const value = profile(x, span.getY());
+                if (value > peakValue) {
+                    peakValue = value;
+                    peak = geom::Point2I(x, span.getY());
+                }
+            }
+        }
+        if (_growRadius > 0) {
+            spans = spans->dilated(_growRadius, afw::geom::Stencil::CIRCLE)->clippedTo(bbox);
+        }
+        auto footprint = std::make_shared<afw::detection::Footprint>(spans, bbox);
+        footprint->addPeak(peak.getX(), peak.getY(), peakValue);
+        result.push_back(footprint);
+    }
+    return result;
+}
+
+std::vector<std::shared_ptr<afw::detection::HeavyFootprint<float>>> SceneRealizer::makeHeavyFootprints(
+        std::vector<SceneSource> const& sources,
+        std::vector<std::shared_ptr<afw::detection::Footprint>> const& footprints) const {
+    if (sources.size() != footprints.size()) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("Number of sources (%d) does not match number of Footprints (%d)") %
+                           sources.size() % footprints.size())
+                                  .str());
+    }
+    std::vector<std::shared_ptr<afw::detection::HeavyFootprint<float>>> result;
+    result.reserve(sources.size());
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        Profile const profile(sources[i]);
+        auto heavy = std::make_shared<afw::detection::HeavyFootprint<float>>(*footprints[i]);
+        // HeavyFootprints hold their pixels span by span, in order within each span.
+        auto pixels = heavy->getImageArray();
+        std::size_t n = 0;
+        for (auto const& span : *footprints[i]->getSpans()) {
+            for (int x = span.getMinX(); x <= span.getMaxX(); ++x) {
+                pixels[n++] = profile(x, span.getY());
+            }
+        }
+        result.push_back(heavy);
+    }
+    return result;
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
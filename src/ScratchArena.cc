@@ -0,0 +1,130 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include <algorithm>
+#include <atomic>
+
+#include "lsst/meas/base/ScratchArena.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+namespace {
+
+std::size_t const MIN_BLOCK_SIZE = 1 << 16;
+
+std::atomic<std::uint64_t> bufferCount{0};
+std::atomic<std::uint64_t> blockCount{0};
+std::atomic<std::uint64_t> blockBytes{0};
+
+}  // namespace
+
+ScratchArena::Scope::Scope(ScratchArena& arena)
+        : _arena(arena), _block(arena._block), _offset(arena._offset) {
+    ++_arena._depth;
+}
+
+ScratchArena::Scope::~Scope() {
+    --_arena._depth;
+    _arena._release(_block, _offset);
+}
+
+ScratchArena& ScratchArena::getThreadArena() {
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+ScratchArena::Statistics ScratchArena::getStatistics() {
+    return Statistics{bufferCount.load(), blockCount.load(), blockBytes.load()};
+}
+
+void ScratchArena::resetStatistics() {
+    bufferCount = 0;
+    blockCount = 0;
+    blockBytes = 0;
+}
+
+ScratchArena::ScratchArena() : _block(0), _offset(0), _depth(0) {}
+
+ScratchArena::~ScratchArena() = default;
+
+void* ScratchArena::_allocate(std::size_t bytes, std::size_t alignment) {
+    ++bufferCount;
+    // Use the first block, from the current one on, with room for the buffer.
+    for (; _block < _blocks.size(); ++_block, _offset = 0) {
+        Block& block = _blocks[_block];
+        std::uintptr_t const base = reinterpret_cast<std::uintptr_t>(block.data.get());
+        std::size_t const start = ((base + _offset + alignment - 1) / alignment) * alignment - base;
+        if (start + bytes <= block.size) {
+            _offset = start + bytes;
+            return block.data.get() + start;
+        }
+    }
+    // Blocks are allocated by operator new[], so they are aligned for any fundamental type.
+    std::size_t const size =
+            std::max({bytes, MIN_BLOCK_SIZE, _blocks.empty() ? std::size_t(0) : 2 * _blocks.back().size});
+    _blocks.push_back(Block{std::unique_ptr<char[]>(new char[size]), size});
+    ++blockCount;
+    blockBytes += size;
+    _block = _blocks.size() - 1;
+    _offset = bytes;
+    return _blocks.back().data.get();
+}
+
+void ScratchArena::_release(std::size_t block, std::size_t offset) {
+    _block = block;
+    _offset = offset;
+    // When the outermost scope ends with the working set spread over several blocks, replace them
+    // with a single block that can hold it all, so later sources need only one.
+    if (_depth == 0 && block == 0 && offset == 0 && _blocks.size() > 1) {
+        std::size_t size = 0;
+        for (auto const& b : _blocks) {
+            size += b.size;
+        }
+        _blocks.clear();
+        _blocks.push_back(Block{std::unique_ptr<char[]>(new char[size]), size});
+        ++blockCount;
+        blockBytes += size;
+    }
+}
+
+std::size_t ScratchArena::getUsed() const {
+    std::size_t used = 0;
+    for (std::size_t i = 0; i < _block && i < _blocks.size(); ++i) {
+        used += _blocks[i].size;
+    }
+    return used + _offset;
+}
+
+std::size_t ScratchArena::getCapacity() const {
+    std::size_t capacity = 0;
+    for (auto const& block : _blocks) {
+        capacity += block.size;
+    }
+    return capacity;
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
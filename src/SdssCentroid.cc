@@ -20,16 +20,20 @@
  * the GNU General Public License along with this program.  If not,
  * see <http://www.lsstcorp.org/LegalNotices/>.
  */
+#include <algorithm>
 #include <iostream>
 #include <cmath>
+#include <memory>
 #include <numeric>
+#include <vector>
 #include "ndarray/eigen.h"
 #include "lsst/geom/Angle.h"
 #include "lsst/afw/detection/Psf.h"
 #include "lsst/pex/exceptions.h"
-#include "lsst/afw/math/ConvolveImage.h"
-#include "lsst/afw/math/offsetImage.h"
+#include "lsst/afw/math/Kernel.h"
 #include "lsst/afw/table/Source.h"
+#include "lsst/meas/base/BinnedPyramid.h"
+#include "lsst/meas/base/ScratchArena.h"
 #include "lsst/meas/base/SdssCentroid.h"
 
 namespace lsst {
@@ -241,15 +245,16 @@ void doMeasureCentroidImpl(double *xCenter,                 // output; x-positio
 }
 
 template <typename MaskedImageXy_locatorT>
-void doMeasureCentroidImpl(double *xCenter,                 // output; x-position of object
-                           double *dxc,                     // output; error in xCenter
-                           double *yCenter,                 // output; y-position of object
-                           double *dyc,                     // output; error in yCenter
-                           double *sizeX2, double *sizeY2,  // output; object widths^2 in x and y directions
-                           double *peakVal,                 // output; peak of object
-                           MaskedImageXy_locatorT mim,      // Locator for the pixel values
-                           double smoothingSigma,  // Gaussian sigma of already-applied smoothing filter
-                           bool negative, FlagHandler flagHandler) {
+MeasurementStatus doMeasureCentroidImpl(
+        double *xCenter,                 // output; x-position of object
+        double *dxc,                     // output; error in xCenter
+        double *yCenter,                 // output; y-position of object
+        double *dyc,                     // output; error in yCenter
+        double *sizeX2, double *sizeY2,  // output; object widths^2 in x and y directions
+        double *peakVal,                 // output; peak of object
+        MaskedImageXy_locatorT mim,      // Locator for the pixel values
+        double smoothingSigma,           // Gaussian sigma of already-applied smoothing filter
+        bool negative, FlagHandler flagHandler) {
     /*
      * find a first quadratic estimate
      */
@@ -259,25 +264,20 @@ void doMeasureCentroidImpl(double *xCenter,                 // output; x-positio
     double const sy = 0.5 * (mim.image(0, 1) - mim.image(0, -1));
 
     if (d2x == 0.0 || d2y == 0.0) {
-        throw LSST_EXCEPT(MeasurementError, SdssCentroidAlgorithm::NO_SECOND_DERIVATIVE.doc,
-                          SdssCentroidAlgorithm::NO_SECOND_DERIVATIVE.number);
+        return MeasurementStatus(SdssCentroidAlgorithm::NO_SECOND_DERIVATIVE);
     }
     if ((!negative && (d2x < 0.0 || d2y < 0.0)) || (negative && (d2x > 0.0 || d2y > 0.0))) {
-        throw LSST_EXCEPT(MeasurementError,
-                          SdssCentroidAlgorithm::NOT_AT_MAXIMUM.doc +
-                                  (boost::format(": d2I/dx2, d2I/dy2 = %g %g") % d2x % d2y).str(),
-                          SdssCentroidAlgorithm::NOT_AT_MAXIMUM.number);
+        return MeasurementStatus(SdssCentroidAlgorithm::NOT_AT_MAXIMUM,
+                                 (boost::format(": d2I/dx2, d2I/dy2 = %g %g") % d2x % d2y).str());
     }
 
     double const dx0 = sx / d2x;
     double const dy0 = sy / d2y;  // first guess
 
     if (fabs(dx0) > 10.0 || fabs(dy0) > 10.0) {
-        throw LSST_EXCEPT(
-                MeasurementError,
-                SdssCentroidAlgorithm::NO_SECOND_DERIVATIVE.doc +
-                        (boost::format(": sx, d2x, sy, d2y = %f %f %f %f") % sx % d2x % sy % d2y).str(),
-                SdssCentroidAlgorithm::ALMOST_NO_SECOND_DERIVATIVE.number);
+        return MeasurementStatus(
+                SdssCentroidAlgorithm::ALMOST_NO_SECOND_DERIVATIVE,
+                (boost::format(": sx, d2x, sy, d2y = %f %f %f %f") % sx % d2x % sy % d2y).str());
     }
 
     double vpk = mim.image(0, 0) + 0.5 * (sx * dx0 + sy * dy0);  // height of peak in image
@@ -354,48 +354,224 @@ void doMeasureCentroidImpl(double *xCenter,                 // output; x-positio
     *sizeY2 = tauY2;
 
     *peakVal = vpk;
+    return MeasurementStatus();
+}
+
+/*
+ * The PSF kernel used to smooth the image, normalized to unit sum as afw::math::convolve would.
+ */
+struct SmoothingKernel {
+    std::weak_ptr<afw::detection::Psf const> psf;  // PSF the kernel was computed from
+    geom::Point2D position;                        // position the kernel was computed at
+    int width = 0;
+    int height = 0;
+    int ctrX = 0;
+    int ctrY = 0;
+    double smoothingSigma = 0.0;  // determinant radius of the PSF
+    std::vector<double> values;   // row-major kernel pixels
+    std::vector<double> squares;  // squared kernel pixels, for the variance
+};
+
+/*
+ * Return the smoothing kernel for a source, reusing the last one computed on this thread if it was
+ * computed from the same PSF at the same position.
+ *
+ * If cellSize > 0 the kernel is evaluated at the center of the cellSize x cellSize cell containing
+ * the source, so all sources in a cell share it.
+ */
+SmoothingKernel const &getSmoothingKernel(std::shared_ptr<afw::detection::Psf const> const &psf,
+                                          geom::Point2D const &center, int cellSize) {
+    thread_local SmoothingKernel cache;
+    geom::Point2D position = center;
+    if (cellSize > 0) {
+        position = geom::Point2D((std::floor(center.getX() / cellSize) + 0.5) * cellSize,
+                                 (std::floor(center.getY() / cellSize) + 0.5) * cellSize);
+    }
+    bool const samePsf = !cache.psf.expired() && !cache.psf.owner_before(psf) && !psf.owner_before(cache.psf);
+    if (samePsf && cache.position == position) {
+        return cache;
+    }
+    std::shared_ptr<afw::math::Kernel const> kernel = psf->getLocalKernel(position);
+    afw::image::Image<double> kernelImage(kernel->getDimensions());
+    kernel->computeImage(kernelImage, true);
+    cache.psf = psf;
+    cache.position = position;
+    cache.width = kernel->getWidth();
+    cache.height = kernel->getHeight();
+    cache.ctrX = kernel->getCtr().getX();
+    cache.ctrY = kernel->getCtr().getY();
+    cache.smoothingSigma = psf->computeShape(position).getDeterminantRadius();
+    cache.values.resize(cache.width * cache.height);
+    cache.squares.resize(cache.width * cache.height);
+    for (int v = 0; v < cache.height; ++v) {
+        auto kIter = kernelImage.row_begin(v);
+        for (int u = 0; u < cache.width; ++u, ++kIter) {
+            cache.values[v * cache.width + u] = *kIter;
+            cache.squares[v * cache.width + u] = (*kIter) * (*kIter);
+        }
+    }
+    return cache;
 }
 
+/*
+ * The 3x3 neighbourhood of the central pixel of the binned, smoothed image, as read by
+ * doMeasureCentroidImpl through a MaskedImage-locator-like interface.
+ */
+struct SmoothedNeighborhood {
+    double imageValues[3][3];
+    double varianceValues[3][3];
+    int originX;  // index of the first image pixel in the central binned pixel
+    int originY;
+    double smoothingSigma;  // Gaussian sigma of the smoothing the values were computed with
+
+    double image(int dx, int dy) const { return imageValues[dy + 1][dx + 1]; }
+    double variance(int dx, int dy) const { return varianceValues[dy + 1][dx + 1]; }
+};
+
+/*
+ * Bin the image by binX x binY around pixel (x, y), smooth it with the PSF kernel, and return the
+ * central 3x3 pixels of the result.
+ *
+ * This is equivalent to binning the image with afw::math::binImage, convolving it (image and
+ * variance) with afw::math::convolve and rescaling the variance to a per-pixel value, but only the
+ * binned pixels within reach of the 3x3 output pixels are computed, into scratch buffers from the
+ * thread's arena.  The central binned pixel starts at (x, y).
+ *
+ * If a pyramid is given and the image is binned, the binned pixels are instead read from the pyramid,
+ * whose bins are aligned to the image: the central binned pixel is then the one containing (x, y).
+ *
+ * If a pre-smoothed image is given and the image is not binned, the 3x3 pixels are read from it
+ * instead of being computed, provided it contains them; its variance plane must be that of the image
+ * convolved with the square of the smoothing kernel, as computed by afw::math::convolve, and
+ * smoothedSigma the Gaussian sigma of that kernel.
+ */
 template <typename MaskedImageT>
-std::pair<MaskedImageT, double> smoothAndBinImage(CONST_PTR(afw::detection::Psf) psf, int const x,
-                                                  const int y, MaskedImageT const &mimage, int binX, int binY,
-                                                  FlagHandler _flagHandler) {
-    geom::Point2D const center(x + mimage.getX0(), y + mimage.getY0());
-    afw::geom::ellipses::Quadrupole const &shape = psf->computeShape(center);
-    double const smoothingSigma = shape.getDeterminantRadius();
-#if 0
-    double const nEffective = psf->computeEffectiveArea(); // not implemented yet (#2821)
-#else
+MeasurementStatus smoothAndBinNeighborhood(SmoothedNeighborhood &result, SmoothingKernel const &kernel,
+                                           int const x, int const y, MaskedImageT const &mimage, int binX,
+                                           int binY, BinnedPyramid *pyramid,
+                                           afw::image::MaskedImage<float> const *smoothed,
+                                           double smoothedSigma) {
+    double const smoothingSigma = kernel.smoothingSigma;
     double const nEffective = 4 * M_PI * smoothingSigma * smoothingSigma;  // correct for a Gaussian
-#endif
+    bool const usePyramid = pyramid && (binX > 1 || binY > 1);
+
+    // The region that would be binned and smoothed in full; sources too close to the edge for it to
+    // fit are rejected, whether or not all of it is read.
+    int const halfWidth = kernel.width / 2;
+    int const halfHeight = kernel.height / 2;
+    geom::Box2I bbox(geom::Point2I(x - binX * (2 + halfWidth), y - binY * (2 + halfHeight)),
+                     geom::Extent2I(binX * (3 + kernel.width + 1), binY * (3 + kernel.height + 1)));
+    if (!usePyramid && !geom::Box2I(geom::Point2I(0, 0), mimage.getDimensions()).contains(bbox)) {
+        return MeasurementStatus(SdssCentroidAlgorithm::EDGE);
+    }
 
-    std::shared_ptr<afw::math::Kernel const> kernel = psf->getLocalKernel(center);
-    int const kWidth = kernel->getWidth();
-    int const kHeight = kernel->getHeight();
+    if (smoothed && binX == 1 && binY == 1) {
+        // Pixel (x, y) of the image, in the pre-smoothed image's own index coordinates.
+        int const sx = x + mimage.getX0() - smoothed->getX0();
+        int const sy = y + mimage.getY0() - smoothed->getY0();
+        if (sx >= 1 && sy >= 1 && sx + 1 < smoothed->getWidth() && sy + 1 < smoothed->getHeight()) {
+            // The effective area of the kernel the image was smoothed with, not of the PSF.
+            double const smoothedNEffective = 4 * M_PI * smoothedSigma * smoothedSigma;
+            for (int dy = 0; dy < 3; ++dy) {
+                auto imageIter = smoothed->getImage()->row_begin(sy + dy - 1) + (sx - 1);
+                auto varianceIter = smoothed->getVariance()->row_begin(sy + dy - 1) + (sx - 1);
+                for (int dx = 0; dx < 3; ++dx, ++imageIter, ++varianceIter) {
+                    result.imageValues[dy][dx] = *imageIter;
+                    result.varianceValues[dy][dx] = *varianceIter * smoothedNEffective;
+                }
+            }
+            result.originX = x;
+            result.originY = y;
+            result.smoothingSigma = smoothedSigma;
+            return MeasurementStatus();
+        }
+    }
 
-    geom::BoxI bbox(geom::Point2I(x - binX * (2 + kWidth / 2), y - binY * (2 + kHeight / 2)),
-                    geom::ExtentI(binX * (3 + kWidth + 1), binY * (3 + kHeight + 1)));
+    // The binned pixels read by the 3x3 output pixels.
+    int const windowWidth = kernel.width + 2;
+    int const windowHeight = kernel.height + 2;
+    ScratchArena::Scope scratch;
+    double *const binnedImage = scratch.allocate<double>(windowWidth * windowHeight);
+    double *const binnedVariance = scratch.allocate<double>(windowWidth * windowHeight);
+    double const binArea = binX * binY;
+    if (usePyramid) {
+        // Window pixel (i, j) is pixel (i0 + i, j0 + j) of the pyramid level.
+        BinnedPyramid::Level const &level = pyramid->getLevel(binX, binY);
+        int const centerX = x / binX;
+        int const centerY = y / binY;
+        int const i0 = centerX - 1 - kernel.ctrX;
+        int const j0 = centerY - 1 - kernel.ctrY;
+        if (i0 < 0 || j0 < 0 || i0 + windowWidth > level.width || j0 + windowHeight > level.height) {
+            return MeasurementStatus(SdssCentroidAlgorithm::EDGE);
+        }
+        for (int j = 0; j < windowHeight; ++j) {
+            std::size_t const offset = static_cast<std::size_t>(j0 + j) * level.width + i0;
+            std::copy_n(&level.image[offset], windowWidth, &binnedImage[j * windowWidth]);
+            std::copy_n(&level.variance[offset], windowWidth, &binnedVariance[j * windowWidth]);
+        }
+        result.originX = centerX * binX;
+        result.originY = centerY * binY;
+    } else {
+        // Binned pixel (i, j) of the window covers the source pixels starting at
+        // (x0 + i*binX, y0 + j*binY).
+        int const x0 = bbox.getMinX() + binX * (1 + halfWidth - kernel.ctrX);
+        int const y0 = bbox.getMinY() + binY * (1 + halfHeight - kernel.ctrY);
+        std::fill_n(binnedImage, windowWidth * windowHeight, 0.0);
+        std::fill_n(binnedVariance, windowWidth * windowHeight, 0.0);
+        for (int j = 0; j < windowHeight; ++j) {
+            double *imageRow = &binnedImage[j * windowWidth];
+            double *varianceRow = &binnedVariance[j * windowWidth];
+            for (int dy = 0; dy < binY; ++dy) {
+                auto imageIter = mimage.getImage()->row_begin(y0 + j * binY + dy) + x0;
+                auto varianceIter = mimage.getVariance()->row_begin(y0 + j * binY + dy) + x0;
+                for (int i = 0; i < windowWidth; ++i) {
+                    for (int dx = 0; dx < binX; ++dx, ++imageIter, ++varianceIter) {
+                        imageRow[i] += *imageIter;
+                        varianceRow[i] += *varianceIter;
+                    }
+                }
+            }
+            for (int i = 0; i < windowWidth; ++i) {
+                imageRow[i] /= binArea;
+                varianceRow[i] /= binArea * binArea;
+            }
+        }
+        result.originX = x;
+        result.originY = y;
+    }
 
-    // image to smooth, a shallow copy
-    PTR(MaskedImageT) subImage;
-    try {
-        subImage.reset(new MaskedImageT(mimage, bbox, afw::image::LOCAL));
-    } catch (pex::exceptions::LengthError &err) {
-        throw LSST_EXCEPT(MeasurementError, SdssCentroidAlgorithm::EDGE.doc,
-                          SdssCentroidAlgorithm::EDGE.number);
+    // afw::math::convolve correlates: out(p) = sum_{u,v} k(u, v) in(p - ctr + (u, v)).
+    double const varianceScale = binArea * nEffective;  // undo the effects of binning and smoothing
+    for (int dy = 0; dy < 3; ++dy) {
+        for (int dx = 0; dx < 3; ++dx) {
+            double imageSum = 0.0;
+            double varianceSum = 0.0;
+            for (int v = 0; v < kernel.height; ++v) {
+                double const *kRow = &kernel.values[v * kernel.width];
+                double const *k2Row = &kernel.squares[v * kernel.width];
+                double const *imageRow = &binnedImage[(dy + v) * windowWidth + dx];
+                double const *varianceRow = &binnedVariance[(dy + v) * windowWidth + dx];
+                for (int u = 0; u < kernel.width; ++u) {
+                    imageSum += kRow[u] * imageRow[u];
+                    varianceSum += k2Row[u] * varianceRow[u];
+                }
+            }
+            result.imageValues[dy][dx] = imageSum;
+            result.varianceValues[dy][dx] = varianceSum * varianceScale;
+        }
     }
-    PTR(MaskedImageT) binnedImage = afw::math::binImage(*subImage, binX, binY, afw::math::MEAN);
-    binnedImage->setXY0(subImage->getXY0());
-    // image to smooth into, a deep copy.
-    MaskedImageT smoothedImage = MaskedImageT(*binnedImage, true);
-    assert(smoothedImage.getWidth() / 2 == kWidth / 2 + 2);  // assumed by the code that uses smoothedImage
-    assert(smoothedImage.getHeight() / 2 == kHeight / 2 + 2);
-
-    afw::math::convolve(smoothedImage, *binnedImage, *kernel, afw::math::ConvolutionControl());
-    *smoothedImage.getVariance() *= binX * binY * nEffective;  // We want the per-pixel variance, so undo the
-                                                               // effects of binning and smoothing
-
-    return std::make_pair(smoothedImage, smoothingSigma);
+    result.smoothingSigma = smoothingSigma;
+    return MeasurementStatus();
+}
+
+/// Return the uncertainty to record for SdssCentroid, which does not compute the x-y covariance
+UncertaintyEnum getCentroidUncertainty(SdssCentroidControl const &ctrl) {
+    UncertaintyEnum const uncertainty = makeUncertaintyEnum(ctrl.uncertainty);
+    if (uncertainty == FULL_COVARIANCE) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          "SdssCentroid does not compute the x-y covariance; use SIGMA_ONLY");
+    }
+    return uncertainty;
 }
 
 }  // end anonymous namespace
@@ -404,12 +580,46 @@ SdssCentroidAlgorithm::SdssCentroidAlgorithm(Control const &ctrl, std::string co
                                              afw::table::Schema &schema)
         : _ctrl(ctrl),
           _centroidKey(CentroidResultKey::addFields(schema, name, "centroid from Sdss Centroid algorithm",
-                                                    SIGMA_ONLY)),
+                                                    getCentroidUncertainty(ctrl))),
           _flagHandler(FlagHandler::addFields(schema, name, getFlagDefinitions())),
           _centroidExtractor(schema, name, true),
-          _centroidChecker(schema, name, ctrl.doFootprintCheck, ctrl.maxDistToPeak) {}
+          _centroidChecker(schema, name, ctrl.doFootprintCheck, ctrl.maxDistToPeak),
+          _smoothedSigma(0.0),
+          _smoothedForChildren(true) {}
+
+void SdssCentroidAlgorithm::setSmoothedImage(std::shared_ptr<afw::image::MaskedImage<float> const> image,
+                                             double smoothingSigma, bool useForChildren) {
+    _smoothedImage = std::move(image);
+    _smoothedSigma = smoothingSigma;
+    _smoothedForChildren = useForChildren;
+}
+
 void SdssCentroidAlgorithm::measure(afw::table::SourceRecord &measRecord,
                                     afw::image::Exposure<float> const &exposure) const {
+    tryMeasure(measRecord, exposure).throwIfFailed();
+}
+
+MeasurementStatus SdssCentroidAlgorithm::tryMeasure(afw::table::SourceRecord &measRecord,
+                                                    afw::image::Exposure<float> const &exposure) const {
+    return _measure(measRecord, exposure, nullptr);
+}
+
+void SdssCentroidAlgorithm::measureBatch(afw::table::SourceCatalog &measCat,
+                                         afw::image::Exposure<float> const &exposure,
+                                         std::vector<std::size_t> const &indices) const {
+    if (!_ctrl.usePyramid) {
+        SingleFrameAlgorithm::measureBatch(measCat, exposure, indices);
+        return;
+    }
+    BinnedPyramid pyramid(exposure.getMaskedImage());
+    measureEach(measCat, indices, [this, &exposure, &pyramid](afw::table::SourceRecord &measRecord) {
+        return _measure(measRecord, exposure, &pyramid);
+    });
+}
+
+MeasurementStatus SdssCentroidAlgorithm::_measure(afw::table::SourceRecord &measRecord,
+                                                  afw::image::Exposure<float> const &exposure,
+                                                  BinnedPyramid *pyramid) const {
     // get our current best guess about the centroid: either a centroider measurement or peak.
     geom::Point2D center = _centroidExtractor(measRecord, _flagHandler);
     CentroidResult result;
@@ -434,7 +644,7 @@ void SdssCentroidAlgorithm::measure(afw::table::SourceRecord &measRecord,
     int const y = image.positionToIndex(center.getY(), afw::image::Y).first;
 
     if (!image.getBBox().contains(geom::Extent2I(x, y) + image.getXY0())) {
-        throw LSST_EXCEPT(meas::base::MeasurementError, EDGE.doc, EDGE.number);
+        return MeasurementStatus(EDGE);
     }
 
     // Algorithm uses a least-squares fit (implemented via a convolution) to a symmetrized PSF model.
@@ -446,20 +656,30 @@ void SdssCentroidAlgorithm::measure(afw::table::SourceRecord &measRecord,
     int binX = 1;
     int binY = 1;
     double xc = 0., yc = 0., dxc = 0., dyc = 0.;  // estimated centre and error therein
+    SmoothingKernel const &kernel =
+            getSmoothingKernel(psf, geom::Point2D(x + mimage.getX0(), y + mimage.getY0()), _ctrl.psfCellSize);
+    double const smoothingSigma = kernel.smoothingSigma;
+    afw::image::MaskedImage<float> const *smoothed = nullptr;
+    if (_smoothedForChildren || measRecord.getParent() == 0) {
+        smoothed = _smoothedImage.get();
+    }
+    double const smoothedSigma = _smoothedSigma > 0 ? _smoothedSigma : smoothingSigma;
+    SmoothedNeighborhood mim;
     for (int binsize = 1; binsize <= _ctrl.binmax; binsize *= 2) {
-        std::pair<MaskedImageT, double> result =
-                smoothAndBinImage(psf, x, y, mimage, binX, binY, _flagHandler);
-        MaskedImageT const smoothedImage = result.first;
-        double const smoothingSigma = result.second;
-
-        MaskedImageT::xy_locator mim =
-                smoothedImage.xy_at(smoothedImage.getWidth() / 2, smoothedImage.getHeight() / 2);
+        MeasurementStatus status = smoothAndBinNeighborhood(mim, kernel, x, y, mimage, binX, binY, pyramid,
+                                                            smoothed, smoothedSigma);
+        if (!status) {
+            return status;
+        }
 
         double sizeX2, sizeY2;  // object widths^2 in x and y directions
         double peakVal;         // peak intensity in image
 
-        doMeasureCentroidImpl(&xc, &dxc, &yc, &dyc, &sizeX2, &sizeY2, &peakVal, mim, smoothingSigma, negative,
-                              _flagHandler);
+        status = doMeasureCentroidImpl(&xc, &dxc, &yc, &dyc, &sizeX2, &sizeY2, &peakVal, mim,
+                                       mim.smoothingSigma, negative, _flagHandler);
+        if (!status) {
+            return status;
+        }
 
         if (binsize > 1) {
             // dilate from the lower left corner of central pixel
@@ -472,8 +692,8 @@ void SdssCentroidAlgorithm::measure(afw::table::SourceRecord &measRecord,
             sizeY2 *= binY * binY;
         }
 
-        xc += x;  // xc, yc are measured relative to pixel (x, y)
-        yc += y;
+        xc += mim.originX;  // xc, yc are measured relative to the first pixel of the central bin
+        yc += mim.originY;
 
         double const fac = _ctrl.wfac * (1 + smoothingSigma * smoothingSigma);
         double const facX2 = fac * binX * binX;
@@ -499,6 +719,7 @@ void SdssCentroidAlgorithm::measure(afw::table::SourceRecord &measRecord,
     result.yErr = sqrt(dyc * dyc);
     measRecord.set(_centroidKey, result);
     _centroidChecker(measRecord);
+    return MeasurementStatus();
 }
 
 void SdssCentroidAlgorithm::fail(afw::table::SourceRecord &measRecord, MeasurementError *error) const {
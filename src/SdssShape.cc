@@ -21,10 +21,13 @@
  * see <https://www.lsstcorp.org/LegalNotices/>.
  */
 
+#include <algorithm>
 #include <cmath>
 #include <tuple>
+#include <vector>
 
 #include "boost/tuple/tuple.hpp"
+#include "Eigen/Core"
 #include "Eigen/LU"
 #include "lsst/geom/Angle.h"
 #include "lsst/geom/Box.h"
@@ -186,6 +189,67 @@ geom::Box2I computeAdaptiveMomentsBBox(geom::Box2I const &bbox,      // full ima
     return result;
 }
 
+/*
+ * A background-subtracted copy of a region of an image, stored in a contiguous float buffer whose rows
+ * start on SIMD-aligned boundaries.
+ *
+ * getAdaptiveMoments copies a window somewhat larger than the first weight function's bounding box once,
+ * and runs every iteration over it rather than re-reading (and re-subtracting the background from) the
+ * image; the window is only refilled if the weight function grows out of it.  It provides the subset of
+ * the Image interface used by calcmom, in the same (LOCAL) coordinates as the image it was copied from.
+ */
+class PixelWindow {
+public:
+    typedef float Pixel;
+    typedef float const *x_iterator;
+
+    PixelWindow() : _stride(0) {}
+
+    template <typename ImageT>
+    void reset(ImageT const &image, geom::BoxI const &bbox, float bkgd) {
+        int const packet = 16 / sizeof(Pixel);  // align rows for the widest common (SSE/NEON) packets
+        _bbox = bbox;
+        _stride = ((bbox.getWidth() + packet - 1) / packet) * packet;
+        _pixels.resize(static_cast<std::size_t>(_stride) * bbox.getHeight());
+        for (int i = 0; i < bbox.getHeight(); ++i) {
+            typename ImageT::x_iterator ptr = image.x_at(bbox.getMinX(), bbox.getMinY() + i);
+            Pixel *out = _pixels.data() + static_cast<std::size_t>(i) * _stride;
+            for (int j = 0; j < bbox.getWidth(); ++j, ++ptr, ++out) {
+                *out = *ptr - bkgd;
+            }
+        }
+    }
+
+    geom::BoxI const &getBBox() const { return _bbox; }
+
+    x_iterator x_at(int x, int y) const {
+        return _pixels.data() + static_cast<std::size_t>(y - _bbox.getMinY()) * _stride +
+               (x - _bbox.getMinX());
+    }
+
+private:
+    geom::BoxI _bbox;
+    int _stride;
+    std::vector<Pixel, Eigen::aligned_allocator<Pixel> > _pixels;
+};
+
+/// Return whether bbox lies within the pixels of an Image (in LOCAL coordinates) or a PixelWindow
+template <typename ImageT>
+bool hasPixels(ImageT const &image, geom::BoxI const &bbox) {
+    return bbox.getMinX() >= 0 && bbox.getMaxX() < image.getWidth() && bbox.getMinY() >= 0 &&
+           bbox.getMaxY() < image.getHeight();
+}
+
+bool hasPixels(PixelWindow const &window, geom::BoxI const &bbox) { return window.getBBox().contains(bbox); }
+
+/// Return a pointer to pixel (x, y) of an Image (in LOCAL coordinates) or a PixelWindow; rows are contiguous
+template <typename ImageT>
+typename ImageT::Pixel const *getRowData(ImageT const &image, int x, int y) {
+    return image.getArray()[y].getData() + x;
+}
+
+float const *getRowData(PixelWindow const &window, int x, int y) { return window.x_at(x, y); }
+
 /*****************************************************************************/
 /*
  * Calculate weighted moments of an object up to 2nd order
@@ -202,7 +266,8 @@ static int calcmom(ImageT const &image,                             // the image
                    double *psumx, double *psumy,                    // sum [xy]*w*I (if !instFluxOnly)
                    double *psumxx, double *psumxy, double *psumyy,  // sum [xy]^2*w*I (if !instFluxOnly)
                    double *psums4,  // sum w*I*weight^2 (if !instFluxOnly && !NULL)
-                   bool negative = false) {
+                   bool negative = false,
+                   bool vectorize = false) {  // use the row-vectorized kernel when !interpflag?
     float tmod, ymod;
     float X, Y;  // sub-pixel interpolated [xy]
     float weight;
@@ -227,14 +292,52 @@ static int calcmom(ImageT const &image,                             // the image
     int const iy0 = bbox.getMinY();  // corners of the box being analyzed
     int const iy1 = bbox.getMaxY();
 
-    if (ix0 < 0 || ix1 >= image.getWidth() || iy0 < 0 || iy1 >= image.getHeight()) {
+    if (!hasPixels(image, bbox)) {
         return -1;
     }
 
+    /*
+     * The vectorized kernel evaluates the weights and moment sums a row at a time using Eigen arrays,
+     * which compile down to the SIMD instruction set enabled for the build (SSE/AVX/NEON) and use
+     * Eigen's vectorized single-precision exp.  It is only used for the non-interpolated case; the
+     * sub-pixel interpolation path (only taken for very small weight functions) remains scalar.
+     */
+#if !RECALC_W
+    bool const useVector = vectorize && !interpflag;
+#else
+    bool const useVector = false;
+#endif
+    int const nx = ix1 - ix0 + 1;
+    Eigen::ArrayXf colIndex, xs, xs2, expon, ymodArr;
+    if (useVector) {
+        colIndex = Eigen::ArrayXf::LinSpaced(nx, ix0, ix1);
+        xs = colIndex - xcen;
+        xs2 = xs.square();
+    }
+    float const w11f = w11, w12f = w12, w22f = w22;
+
     for (int i = iy0; i <= iy1; ++i) {
-        typename ImageT::x_iterator ptr = image.x_at(ix0, i);
         float const y = i - ycen;
         float const y2 = y * y;
+        if (useVector) {
+            Eigen::Map<Eigen::Array<typename ImageT::Pixel, Eigen::Dynamic, 1> const> pixels(
+                    getRowData(image, ix0, i), nx);
+            expon = xs2 * w11f + (2 * y * w12f) * xs + y2 * w22f;
+            ymodArr = (expon <= 14.0f).select((pixels.template cast<float>() - bkgd) * (-0.5f * expon).exp(),
+                                              0.0f);
+            double const rowSum = ymodArr.sum();
+            sum += rowSum;
+            if (!instFluxOnly) {
+                sumx += (ymodArr * colIndex).sum();
+                sumy += rowSum * i;
+                sumxx += (ymodArr * xs2).sum();
+                sumxy += y * (ymodArr * xs).sum();
+                sumyy += y2 * rowSum;
+                sums4 += (expon.square() * ymodArr).sum();
+            }
+            continue;
+        }
+        typename ImageT::x_iterator ptr = image.x_at(ix0, i);
         float const yl = y - 0.375;
         float const yh = y + 0.375;
         for (int j = ix0; j <= ix1; ++j, ++ptr) {
@@ -365,6 +468,95 @@ static int calcmom(ImageT const &image,                             // the image
     }
 }
 
+/// Raise x to a positive integer power by repeated squaring
+inline double integerPower(double x, int n) {
+    double result = 1.0;
+    for (; n > 0; n >>= 1, x *= x) {
+        if (n & 1) {
+            result *= x;
+        }
+    }
+    return result;
+}
+
+/*****************************************************************************/
+/*
+ * Calculate the Gaussian-weighted sums of an object for several weight functions that differ only in
+ * scale, in a single pass over the pixels.
+ *
+ * The k-th weight is exp(-0.5*factors[k]*expon), where expon is the distance computed from (w11, w12, w22);
+ * as in calcmom<true>, sums[k] only includes pixels within bboxes[k] with factors[k]*expon <= 14.  Weights
+ * whose factor is an integer multiple of the smallest one are powers of the smallest-factor weight, so only
+ * the remaining scales need their own exp.  No sub-pixel interpolation is done.
+ */
+template <typename ImageT>
+static int calcmomScales(ImageT const &image,                    // the image data
+                         float xcen, float ycen,                 // centre of object
+                         std::vector<geom::BoxI> const &bboxes,  // bounding box to consider for each scale
+                         double w11, double w12, double w22,     // weights of the unscaled Gaussian
+                         std::vector<double> const &factors,     // multiply the weights for each scale
+                         std::vector<double> &sums) {            // sum w*I for each scale
+    std::size_t const nScales = factors.size();
+    sums.assign(nScales, 0.0);
+    if (nScales == 0) {
+        return 0;
+    }
+
+    double const minFactor = *std::min_element(factors.begin(), factors.end());
+    std::vector<int> powers(nScales, 0);  // power of the smallest-factor weight, or 0 to call exp
+    geom::BoxI bbox;
+    for (std::size_t k = 0; k < nScales; ++k) {
+        if (fabs(w11 * factors[k]) > 1e6 || fabs(w12 * factors[k]) > 1e6 || fabs(w22 * factors[k]) > 1e6) {
+            return -1;
+        }
+        double const ratio = factors[k] / minFactor;
+        long const power = std::lround(ratio);
+        if (power >= 1 && std::fabs(ratio - power) < 1e-8 * ratio) {
+            powers[k] = power;
+        }
+        bbox.include(bboxes[k]);
+    }
+    if (bbox.isEmpty()) {
+        return 0;
+    }
+
+    int const ix0 = bbox.getMinX();  // corners of the box being analyzed
+    int const ix1 = bbox.getMaxX();
+    int const iy0 = bbox.getMinY();
+    int const iy1 = bbox.getMaxY();
+
+    if (ix0 < 0 || ix1 >= image.getWidth() || iy0 < 0 || iy1 >= image.getHeight()) {
+        return -1;
+    }
+
+    for (int i = iy0; i <= iy1; ++i) {
+        float const y = i - ycen;
+        float const y2 = y * y;
+        typename ImageT::x_iterator ptr = image.x_at(ix0, i);
+        for (int j = ix0; j <= ix1; ++j, ++ptr) {
+            float const x = j - xcen;
+            float const expon = x * x * w11 + 2 * x * y * w12 + y2 * w22;
+            if (expon * minFactor > 14.0) {  // outside the cutoff of every scale
+                continue;
+            }
+            double const baseWeight = std::exp(-0.5 * minFactor * expon);
+            float const tmod = *ptr;
+            for (std::size_t k = 0; k < nScales; ++k) {
+                float const scaledExpon = expon * factors[k];
+                if (scaledExpon > 14.0 || !bboxes[k].contains(geom::Point2I(j, i))) {
+                    continue;
+                }
+                float const weight =
+                        (powers[k] > 0) ? integerPower(baseWeight, powers[k]) : std::exp(-0.5 * scaledExpon);
+                float const ymod = tmod * weight;
+                sums[k] += ymod;
+            }
+        }
+    }
+
+    return 0;
+}
+
 /*
  * Workhorse for adaptive moments
  *
@@ -372,7 +564,9 @@ static int calcmom(ImageT const &image,                             // the image
  */
 template <typename ImageT>
 bool getAdaptiveMoments(ImageT const &mimage, double bkgd, double xcen, double ycen, double shiftmax,
-                        SdssShapeResult *shape, int maxIter, float tol1, float tol2, bool negative) {
+                        SdssShapeResult *shape, int maxIter, float tol1, float tol2, bool negative,
+                        bool vectorize, afw::geom::ellipses::Quadrupole const &initialWeight,
+                        bool computeErrors, double *weightedSum = nullptr) {
     double I0 = 0;               // amplitude of best-fit Gaussian
     double sum;                  // sum of intensity*weight
     double sumx, sumy;           // sum ((int)[xy])*intensity*weight
@@ -381,9 +575,9 @@ bool getAdaptiveMoments(ImageT const &mimage, double bkgd, double xcen, double y
     float const xcen0 = xcen;    // initial centre
     float const ycen0 = ycen;    //                of object
 
-    double sigma11W = 1.5;  // quadratic moments of the
-    double sigma12W = 0.0;  //     weighting fcn;
-    double sigma22W = 1.5;  //               xx, xy, and yy
+    double sigma11W = initialWeight.getIxx();  // quadratic moments of the
+    double sigma12W = initialWeight.getIxy();  //     weighting fcn;
+    double sigma22W = initialWeight.getIyy();  //               xx, xy, and yy
 
     double w11 = -1, w12 = -1, w22 = -1;  // current weights for moments; always set when iter == 0
     float e1_old = 1e6, e2_old = 1e6;     // old values of shape parameters e1 and e2
@@ -391,18 +585,36 @@ bool getAdaptiveMoments(ImageT const &mimage, double bkgd, double xcen, double y
 
     typename ImageAdaptor<ImageT>::Image const &image = ImageAdaptor<ImageT>().getImage(mimage);
 
+    if (weightedSum) {
+        *weightedSum = std::numeric_limits<double>::quiet_NaN();
+    }
     if (std::isnan(xcen) || std::isnan(ycen)) {
         // Can't do anything
         shape->flags[SdssShapeAlgorithm::UNWEIGHTED_BAD.number] = true;
         return false;
     }
 
+    // Background-subtracted copy of the pixels, with room for the weight function to grow by ~50% in radius
+    // before it has to be refilled.
+    PixelWindow window;
+    auto const ensureWindow = [&window, &image, bkgd](geom::BoxI const &bbox) {
+        if (window.getBBox().contains(bbox)) {
+            return;
+        }
+        geom::BoxI grown(bbox);
+        grown.grow(geom::Extent2I(bbox.getWidth() / 4 + 1, bbox.getHeight() / 4 + 1));
+        grown.clip(image.getBBox(afw::image::LOCAL));
+        window.reset(image, grown, bkgd);
+    };
+
     bool interpflag = false;  // interpolate finer than a pixel?
+    bool converged = false;
     geom::BoxI bbox;
     int iter = 0;  // iteration number
     for (; iter < maxIter; iter++) {
         bbox = computeAdaptiveMomentsBBox(image.getBBox(afw::image::LOCAL), geom::Point2D(xcen, ycen),
                                           sigma11W, sigma12W, sigma22W);
+        ensureWindow(bbox);
         std::tuple<std::pair<bool, double>, double, double, double> weights =
                 getWeights(sigma11W, sigma12W, sigma22W);
         if (!std::get<0>(weights).first) {
@@ -441,8 +653,8 @@ bool getAdaptiveMoments(ImageT const &mimage, double bkgd, double xcen, double y
             }
         }
 
-        if (calcmom<false>(image, xcen, ycen, bbox, bkgd, interpflag, w11, w12, w22, &I0, &sum, &sumx, &sumy,
-                           &sumxx, &sumxy, &sumyy, &sums4, negative) < 0) {
+        if (calcmom<false>(window, xcen, ycen, bbox, 0.0, interpflag, w11, w12, w22, &I0, &sum, &sumx, &sumy,
+                           &sumxx, &sumxy, &sumyy, &sums4, negative, vectorize) < 0) {
             shape->flags[SdssShapeAlgorithm::UNWEIGHTED.number] = true;
             break;
         }
@@ -482,6 +694,7 @@ bool getAdaptiveMoments(ImageT const &mimage, double bkgd, double xcen, double y
          */
         if (iter > 0 && fabs(e1 - e1_old) < tol1 && fabs(e2 - e2_old) < tol1 &&
             fabs(sigma11_ow / sigma11_ow_old - 1.0) < tol2) {
+            converged = true;
             break;  // yes; we converged
         }
 
@@ -547,6 +760,8 @@ bool getAdaptiveMoments(ImageT const &mimage, double bkgd, double xcen, double y
         }
     }
 
+    shape->nIter = (iter < maxIter) ? iter + 1 : maxIter;
+
     if (iter == maxIter) {
         shape->flags[SdssShapeAlgorithm::UNWEIGHTED.number] = true;
         shape->flags[SdssShapeAlgorithm::MAXITER.number] = true;
@@ -555,13 +770,25 @@ bool getAdaptiveMoments(ImageT const &mimage, double bkgd, double xcen, double y
     if (sumxx + sumyy == 0.0) {
         shape->flags[SdssShapeAlgorithm::UNWEIGHTED.number] = true;
     }
+    if (weightedSum) {
+        // The last sum was computed with the weights for the final moments, just as computeFixedMomentsFlux
+        // would compute it, unless the interpolation flag was left set by an earlier (smaller) weight.
+        if (converged && !shape->flags[SdssShapeAlgorithm::UNWEIGHTED.number] && bkgd == 0.0) {
+            std::tuple<std::pair<bool, double>, double, double, double> const weights =
+                    getWeights(sigma11W, sigma12W, sigma22W);
+            if (interpflag == shouldInterp(sigma11W, sigma22W, std::get<0>(weights).second)) {
+                *weightedSum = sum;
+            }
+        }
+    }
     /*
      * Problems; try calculating the un-weighted moments
      */
     if (shape->flags[SdssShapeAlgorithm::UNWEIGHTED.number]) {
         w11 = w22 = w12 = 0;
-        if (calcmom<false>(image, xcen, ycen, bbox, bkgd, interpflag, w11, w12, w22, &I0, &sum, &sumx, &sumy,
-                           &sumxx, &sumxy, &sumyy, NULL, negative) < 0 ||
+        ensureWindow(bbox);
+        if (calcmom<false>(window, xcen, ycen, bbox, 0.0, interpflag, w11, w12, w22, &I0, &sum, &sumx, &sumy,
+                           &sumxx, &sumxy, &sumyy, NULL, negative, vectorize) < 0 ||
             (!negative && sum <= 0) || (negative && sum >= 0)) {
             shape->flags[SdssShapeAlgorithm::UNWEIGHTED.number] = false;
             shape->flags[SdssShapeAlgorithm::UNWEIGHTED_BAD.number] = true;
@@ -600,16 +827,19 @@ bool getAdaptiveMoments(ImageT const &mimage, double bkgd, double xcen, double y
                     // convention in afw::geom::ellipses is to order moments (xx, yy, xy),
                     // but the older algorithmic code uses (xx, xy, yy) - the order of
                     // indices here is not a bug.
+                    // The instFlux error is always recorded, so it is computed even without the others.
                     shape->instFluxErr = std::sqrt(cov(0, 0));
-                    shape->xxErr = std::sqrt(cov(1, 1));
-                    shape->xyErr = std::sqrt(cov(2, 2));
-                    shape->yyErr = std::sqrt(cov(3, 3));
-                    shape->instFlux_xx_Cov = cov(0, 1);
-                    shape->instFlux_xy_Cov = cov(0, 2);
-                    shape->instFlux_yy_Cov = cov(0, 3);
-                    shape->xx_yy_Cov = cov(1, 3);
-                    shape->xx_xy_Cov = cov(1, 2);
-                    shape->yy_xy_Cov = cov(2, 3);
+                    if (computeErrors) {
+                        shape->xxErr = std::sqrt(cov(1, 1));
+                        shape->xyErr = std::sqrt(cov(2, 2));
+                        shape->yyErr = std::sqrt(cov(3, 3));
+                        shape->instFlux_xx_Cov = cov(0, 1);
+                        shape->instFlux_xy_Cov = cov(0, 2);
+                        shape->instFlux_yy_Cov = cov(0, 3);
+                        shape->xx_yy_Cov = cov(1, 3);
+                        shape->xx_xy_Cov = cov(1, 2);
+                        shape->yy_xy_Cov = cov(2, 3);
+                    }
                 }
             }
         }
@@ -623,13 +853,14 @@ bool getAdaptiveMoments(ImageT const &mimage, double bkgd, double xcen, double y
 SdssShapeResult::SdssShapeResult()
         : instFlux_xx_Cov(std::numeric_limits<ErrElement>::quiet_NaN()),
           instFlux_yy_Cov(std::numeric_limits<ErrElement>::quiet_NaN()),
-          instFlux_xy_Cov(std::numeric_limits<ErrElement>::quiet_NaN()) {}
+          instFlux_xy_Cov(std::numeric_limits<ErrElement>::quiet_NaN()),
+          nIter(0) {}
 
 SdssShapeResultKey SdssShapeResultKey::addFields(afw::table::Schema &schema, std::string const &name,
-                                                 bool doMeasurePsf) {
+                                                 bool doMeasurePsf, UncertaintyEnum uncertainty) {
     SdssShapeResultKey r;
     r._shapeResult =
-            ShapeResultKey::addFields(schema, name, "elliptical Gaussian adaptive moments", SIGMA_ONLY);
+            ShapeResultKey::addFields(schema, name, "elliptical Gaussian adaptive moments", uncertainty);
     r._centroidResult = CentroidResultKey::addFields(schema, name, "elliptical Gaussian adaptive moments",
                                                      NO_UNCERTAINTY);
     r._instFluxResult = FluxResultKey::addFields(schema, name, "elliptical Gaussian adaptive moments");
@@ -643,24 +874,28 @@ SdssShapeResultKey SdssShapeResultKey::addFields(afw::table::Schema &schema, std
         r._includePsf = false;
     }
 
-    r._instFlux_xx_Cov =
-            schema.addField<ErrElement>(schema.join(name, "instFlux", "xx", "Cov"),
-                                        (boost::format("uncertainty covariance between %s and %s") %
-                                         schema.join(name, "instFlux") % schema.join(name, "xx"))
-                                                .str(),
-                                        "count*pixel^2");
-    r._instFlux_yy_Cov =
-            schema.addField<ErrElement>(schema.join(name, "instFlux", "yy", "Cov"),
-                                        (boost::format("uncertainty covariance between %s and %s") %
-                                         schema.join(name, "instFlux") % schema.join(name, "yy"))
-                                                .str(),
-                                        "count*pixel^2");
-    r._instFlux_xy_Cov =
-            schema.addField<ErrElement>(schema.join(name, "instFlux", "xy", "Cov"),
-                                        (boost::format("uncertainty covariance between %s and %s") %
-                                         schema.join(name, "instFlux") % schema.join(name, "xy"))
-                                                .str(),
-                                        "count*pixel^2");
+    if (uncertainty != NO_UNCERTAINTY) {
+        r._instFlux_xx_Cov =
+                schema.addField<ErrElement>(schema.join(name, "instFlux", "xx", "Cov"),
+                                            (boost::format("uncertainty covariance between %s and %s") %
+                                             schema.join(name, "instFlux") % schema.join(name, "xx"))
+                                                    .str(),
+                                            "count*pixel^2");
+        r._instFlux_yy_Cov =
+                schema.addField<ErrElement>(schema.join(name, "instFlux", "yy", "Cov"),
+                                            (boost::format("uncertainty covariance between %s and %s") %
+                                             schema.join(name, "instFlux") % schema.join(name, "yy"))
+                                                    .str(),
+                                            "count*pixel^2");
+        r._instFlux_xy_Cov =
+                schema.addField<ErrElement>(schema.join(name, "instFlux", "xy", "Cov"),
+                                            (boost::format("uncertainty covariance between %s and %s") %
+                                             schema.join(name, "instFlux") % schema.join(name, "xy"))
+                                                    .str(),
+                                            "count*pixel^2");
+    }
+    r._nIter = schema.addField<int>(schema.join(name, "nIter"),
+                                    "number of iterations performed by the adaptive moments fit");
 
     // Skip the psf flag if not recording the PSF shape.
     if (r._includePsf) {
@@ -673,12 +908,14 @@ SdssShapeResultKey SdssShapeResultKey::addFields(afw::table::Schema &schema, std
 }
 
 SdssShapeResultKey::SdssShapeResultKey(afw::table::SubSchema const &s)
-        : _shapeResult(s),
-          _centroidResult(s),
-          _instFluxResult(s),
-          _instFlux_xx_Cov(s["instFlux"]["xx"]["Cov"]),
-          _instFlux_yy_Cov(s["instFlux"]["yy"]["Cov"]),
-          _instFlux_xy_Cov(s["instFlux"]["xy"]["Cov"]) {
+        : _shapeResult(s), _centroidResult(s), _instFluxResult(s) {
+    // The instFlux-shape covariances are not recorded when the algorithm computes no uncertainties.
+    try {
+        _instFlux_xx_Cov = s["instFlux"]["xx"]["Cov"];
+        _instFlux_yy_Cov = s["instFlux"]["yy"]["Cov"];
+        _instFlux_xy_Cov = s["instFlux"]["xy"]["Cov"];
+    } catch (pex::exceptions::NotFoundError &e) {
+    }
     // The input SubSchema may optionally provide for a PSF.
     try {
         _psfShapeResult = afw::table::QuadrupoleKey(s["psf"]);
@@ -689,6 +926,11 @@ SdssShapeResultKey::SdssShapeResultKey(afw::table::SubSchema const &s)
                 FlagHandler(s, SdssShapeAlgorithm::getFlagDefinitions(), {SdssShapeAlgorithm::PSF_SHAPE_BAD});
         _includePsf = false;
     }
+    // Catalogs written before the iteration count was recorded won't have it.
+    try {
+        _nIter = s["nIter"];
+    } catch (pex::exceptions::NotFoundError &e) {
+    }
 }
 
 SdssShapeResult SdssShapeResultKey::get(afw::table::BaseRecord const &record) const {
@@ -696,9 +938,14 @@ SdssShapeResult SdssShapeResultKey::get(afw::table::BaseRecord const &record) co
     static_cast<ShapeResult &>(result) = record.get(_shapeResult);
     static_cast<CentroidResult &>(result) = record.get(_centroidResult);
     static_cast<FluxResult &>(result) = record.get(_instFluxResult);
-    result.instFlux_xx_Cov = record.get(_instFlux_xx_Cov);
-    result.instFlux_yy_Cov = record.get(_instFlux_yy_Cov);
-    result.instFlux_xy_Cov = record.get(_instFlux_xy_Cov);
+    if (_instFlux_xx_Cov.isValid()) {
+        result.instFlux_xx_Cov = record.get(_instFlux_xx_Cov);
+        result.instFlux_yy_Cov = record.get(_instFlux_yy_Cov);
+        result.instFlux_xy_Cov = record.get(_instFlux_xy_Cov);
+    }
+    if (_nIter.isValid()) {
+        result.nIter = record.get(_nIter);
+    }
     for (size_t n = 0; n < SdssShapeAlgorithm::N_FLAGS; ++n) {
         if (n == SdssShapeAlgorithm::PSF_SHAPE_BAD.number && !_includePsf) continue;
         result.flags[n] = _flagHandler.getValue(record, n);
@@ -714,9 +961,14 @@ void SdssShapeResultKey::set(afw::table::BaseRecord &record, SdssShapeResult con
     record.set(_shapeResult, value);
     record.set(_centroidResult, value);
     record.set(_instFluxResult, value);
-    record.set(_instFlux_xx_Cov, value.instFlux_xx_Cov);
-    record.set(_instFlux_yy_Cov, value.instFlux_yy_Cov);
-    record.set(_instFlux_xy_Cov, value.instFlux_xy_Cov);
+    if (_instFlux_xx_Cov.isValid()) {
+        record.set(_instFlux_xx_Cov, value.instFlux_xx_Cov);
+        record.set(_instFlux_yy_Cov, value.instFlux_yy_Cov);
+        record.set(_instFlux_xy_Cov, value.instFlux_xy_Cov);
+    }
+    if (_nIter.isValid()) {
+        record.set(_nIter, value.nIter);
+    }
     for (size_t n = 0; n < SdssShapeAlgorithm::N_FLAGS; ++n) {
         if (n == SdssShapeAlgorithm::PSF_SHAPE_BAD.number && !_includePsf) continue;
         _flagHandler.setValue(record, n, value.flags[n]);
@@ -746,12 +998,37 @@ bool SdssShapeResultKey::isValid() const {
 SdssShapeAlgorithm::SdssShapeAlgorithm(Control const &ctrl, std::string const &name,
                                        afw::table::Schema &schema)
         : _ctrl(ctrl),
-          _resultKey(ResultKey::addFields(schema, name, ctrl.doMeasurePsf)),
-          _centroidExtractor(schema, name) {}
+          _resultKey(ResultKey::addFields(schema, name, ctrl.doMeasurePsf,
+                                          makeUncertaintyEnum(ctrl.uncertainty))),
+          _centroidExtractor(schema, name) {
+    if (ctrl.doRecordWeightedSum) {
+        _weightedSumKey = schema.addField<double>(
+                schema.join(name, "weightedSum"),
+                "sum of the pixels weighted by the final adaptive moments weight function", "count");
+        _weightedSumCenterKey = afw::table::PointKey<double>::addFields(
+                schema, schema.join(name, "weightedSumCenter"),
+                "center of the weight function for weightedSum", "pixel");
+    }
+}
 
 template <typename ImageT>
 SdssShapeResult SdssShapeAlgorithm::computeAdaptiveMoments(ImageT const &image, geom::Point2D const &center,
                                                            bool negative, Control const &control) {
+    return computeAdaptiveMoments(image, center, getDefaultInitialWeight(), negative, control);
+}
+
+template <typename ImageT>
+SdssShapeResult SdssShapeAlgorithm::computeAdaptiveMoments(
+        ImageT const &image, geom::Point2D const &center,
+        afw::geom::ellipses::Quadrupole const &initialWeight, bool negative, Control const &control) {
+    return _computeAdaptiveMoments(image, center, initialWeight, negative, control, nullptr);
+}
+
+template <typename ImageT>
+SdssShapeResult SdssShapeAlgorithm::_computeAdaptiveMoments(
+        ImageT const &image, geom::Point2D const &center,
+        afw::geom::ellipses::Quadrupole const &initialWeight, bool negative, Control const &control,
+        double *weightedSum) {
     double xcen = center.getX();  // object's column position
     double ycen = center.getY();  // object's row position
 
@@ -769,9 +1046,13 @@ SdssShapeResult SdssShapeAlgorithm::computeAdaptiveMoments(ImageT const &image,
     try {
         result.flags[FAILURE.number] =
                 !getAdaptiveMoments(image, control.background, xcen, ycen, shiftmax, &result, control.maxIter,
-                                    control.tol1, control.tol2, negative);
+                                    control.tol1, control.tol2, negative, control.vectorize, initialWeight,
+                                    makeUncertaintyEnum(control.uncertainty) != NO_UNCERTAINTY, weightedSum);
     } catch (pex::exceptions::Exception &err) {
         result.flags[FAILURE.number] = true;
+        if (weightedSum) {
+            *weightedSum = std::numeric_limits<double>::quiet_NaN();
+        }
     }
     if (result.flags[UNWEIGHTED.number] || result.flags[SHIFT.number]) {
         // These are also considered fatal errors in terms of the quality of the results,
@@ -820,7 +1101,8 @@ SdssShapeResult SdssShapeAlgorithm::computeAdaptiveMoments(ImageT const &image,
 template <typename ImageT>
 FluxResult SdssShapeAlgorithm::computeFixedMomentsFlux(ImageT const &image,
                                                        afw::geom::ellipses::Quadrupole const &shape,
-                                                       geom::Point2D const &center) {
+                                                       geom::Point2D const &center,
+                                                       Control const &control) {
     // while arguments to computeFixedMomentsFlux are in PARENT coordinates, the implementation is LOCAL.
     geom::Point2D localCenter = center - geom::Extent2D(image.getXY0());
 
@@ -830,8 +1112,6 @@ FluxResult SdssShapeAlgorithm::computeFixedMomentsFlux(ImageT const &image,
     std::tuple<std::pair<bool, double>, double, double, double> weights =
             getWeights(shape.getIxx(), shape.getIxy(), shape.getIyy());
 
-    FluxResult result;
-
     if (!std::get<0>(weights).first) {
         throw pex::exceptions::InvalidParameterError("Input shape is singular");
     }
@@ -843,11 +1123,25 @@ FluxResult SdssShapeAlgorithm::computeFixedMomentsFlux(ImageT const &image,
 
     double sum0 = 0;  //  sum of pixel values weighted by a Gaussian
     if (calcmom<true>(ImageAdaptor<ImageT>().getImage(image), localCenter.getX(), localCenter.getY(), bbox,
-                      0.0, interp, w11, w12, w22, NULL, &sum0, NULL, NULL, NULL, NULL, NULL, NULL) < 0) {
+                      0.0, interp, w11, w12, w22, NULL, &sum0, NULL, NULL, NULL, NULL, NULL, NULL, false,
+                      control.vectorize) < 0) {
         throw LSST_EXCEPT(pex::exceptions::RuntimeError, "Error from calcmom");
     }
 
-    result.instFlux = sum0 * 2.0;
+    return computeFixedMomentsFluxFromSum(image, shape, center, sum0);
+}
+
+template <typename ImageT>
+FluxResult SdssShapeAlgorithm::computeFixedMomentsFluxFromSum(ImageT const &image,
+                                                              afw::geom::ellipses::Quadrupole const &shape,
+                                                              geom::Point2D const &center,
+                                                              double weightedSum) {
+    if (!std::get<0>(getWeights(shape.getIxx(), shape.getIxy(), shape.getIyy())).first) {
+        throw pex::exceptions::InvalidParameterError("Input shape is singular");
+    }
+
+    FluxResult result;
+    result.instFlux = weightedSum * 2.0;
 
     if (ImageAdaptor<ImageT>::hasVariance) {
         int ix = static_cast<int>(center.getX() - image.getX0());
@@ -867,6 +1161,74 @@ FluxResult SdssShapeAlgorithm::computeFixedMomentsFlux(ImageT const &image,
     return result;
 }
 
+template <typename ImageT>
+std::vector<FluxResult> SdssShapeAlgorithm::computeFixedMomentsFluxes(
+        ImageT const &image, afw::geom::ellipses::Quadrupole const &shape, geom::Point2D const &center,
+        std::vector<double> const &scales, Control const &control) {
+    geom::Point2D localCenter = center - geom::Extent2D(image.getXY0());
+
+    std::tuple<std::pair<bool, double>, double, double, double> weights =
+            getWeights(shape.getIxx(), shape.getIxy(), shape.getIyy());
+
+    if (!std::get<0>(weights).first) {
+        throw pex::exceptions::InvalidParameterError("Input shape is singular");
+    }
+
+    double const det = std::get<0>(weights).second;
+    std::vector<FluxResult> results(scales.size());
+    std::vector<geom::BoxI> bboxes;    // bounding box of each scale measured in the single pass
+    std::vector<double> factors;       // inverse squared scale of each scale measured in the single pass
+    std::vector<std::size_t> indices;  // index into scales of each scale measured in the single pass
+    for (std::size_t k = 0; k < scales.size(); ++k) {
+        if (!(scales[k] > 0.0)) {
+            throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                              (boost::format("Scale %g is not positive") % scales[k]).str());
+        }
+        double const scale2 = scales[k] * scales[k];
+        afw::geom::ellipses::Quadrupole const scaled(shape.getIxx() * scale2, shape.getIyy() * scale2,
+                                                     shape.getIxy() * scale2);
+        if (shouldInterp(scaled.getIxx(), scaled.getIyy(), det * scale2 * scale2)) {
+            results[k] = computeFixedMomentsFlux(image, scaled, center, control);
+            continue;
+        }
+        bboxes.push_back(computeAdaptiveMomentsBBox(image.getBBox(afw::image::LOCAL), localCenter,
+                                                    scaled.getIxx(), scaled.getIxy(), scaled.getIyy()));
+        factors.push_back(1.0 / scale2);
+        indices.push_back(k);
+    }
+
+    std::vector<double> sums;
+    if (calcmomScales(ImageAdaptor<ImageT>().getImage(image), localCenter.getX(), localCenter.getY(), bboxes,
+                      std::get<1>(weights), std::get<2>(weights), std::get<3>(weights), factors, sums) < 0) {
+        throw LSST_EXCEPT(pex::exceptions::RuntimeError, "Error from calcmom");
+    }
+
+    double var = std::numeric_limits<double>::quiet_NaN();
+    if (ImageAdaptor<ImageT>::hasVariance && !indices.empty()) {
+        int ix = static_cast<int>(center.getX() - image.getX0());
+        int iy = static_cast<int>(center.getY() - image.getY0());
+        if (!image.getBBox(afw::image::LOCAL).contains(geom::Point2I(ix, iy))) {
+            throw LSST_EXCEPT(pex::exceptions::RuntimeError,
+                              (boost::format("Center (%d,%d) not in image (%dx%d)") % ix % iy %
+                               image.getWidth() % image.getHeight())
+                                      .str());
+        }
+        var = ImageAdaptor<ImageT>().getVariance(image, ix, iy);
+    }
+
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        FluxResult &result = results[indices[i]];
+        result.instFlux = sums[i] * 2.0;
+        if (ImageAdaptor<ImageT>::hasVariance) {
+            // as in computeFixedMomentsFlux, with the weight area of the scaled shape
+            double const wArea = geom::PI * std::sqrt(det) / factors[i];
+            result.instFluxErr = 2 * std::sqrt(var * wArea);
+        }
+    }
+
+    return results;
+}
+
 void SdssShapeAlgorithm::measure(afw::table::SourceRecord &measRecord,
                                  afw::image::Exposure<float> const &exposure) const {
     bool negative = false;
@@ -875,9 +1237,22 @@ void SdssShapeAlgorithm::measure(afw::table::SourceRecord &measRecord,
         negative = measRecord.get(measRecord.getSchema().find<afw::table::Flag>("flags_negative").key);
     } catch (pexExcept::Exception &e) {
     }
-    SdssShapeResult result = computeAdaptiveMoments(
-            exposure.getMaskedImage(), _centroidExtractor(measRecord, _resultKey.getFlagHandler()), negative,
-            _ctrl);
+    geom::Point2D center = _centroidExtractor(measRecord, _resultKey.getFlagHandler());
+    afw::geom::ellipses::Quadrupole initialWeight = getDefaultInitialWeight();
+    if (_ctrl.doWarmStart) {
+        initialWeight = _computeInitialWeight(measRecord, exposure, center, initialWeight);
+    }
+    double weightedSum = std::numeric_limits<double>::quiet_NaN();
+    // The recorded sum must be the one computeFixedMomentsFlux would compute with a default Control.
+    bool const recordWeightedSum = _weightedSumKey.isValid() && _ctrl.background == 0.0 &&
+                                   _ctrl.vectorize == Control().vectorize;
+    SdssShapeResult result =
+            _computeAdaptiveMoments(exposure.getMaskedImage(), center, initialWeight, negative, _ctrl,
+                                    recordWeightedSum ? &weightedSum : nullptr);
+    if (_weightedSumKey.isValid()) {
+        measRecord.set(_weightedSumKey, weightedSum);
+        measRecord.set(_weightedSumCenterKey, center);
+    }
 
     if (_ctrl.doMeasurePsf) {
         // Compute moments of Psf model.  In the interest of implementing this quickly, we're just
@@ -902,15 +1277,53 @@ void SdssShapeAlgorithm::measure(afw::table::SourceRecord &measRecord,
     measRecord.set(_resultKey, result);
 }
 
+afw::geom::ellipses::Quadrupole SdssShapeAlgorithm::_computeInitialWeight(
+        afw::table::SourceRecord const &measRecord, afw::image::Exposure<float> const &exposure,
+        geom::Point2D const &center, afw::geom::ellipses::Quadrupole const &fallback) const {
+    // A usable shape already in the shape slot (e.g. the transformed reference shape in forced
+    // measurement) takes precedence; when this algorithm is itself the shape slot the values are
+    // still NaN here and fail the determinant test.
+    auto const &shapeSlot = measRecord.getTable()->getShapeSlot();
+    if (shapeSlot.getMeasKey().isValid() &&
+        !(shapeSlot.getFlagKey().isValid() && measRecord.get(shapeSlot.getFlagKey()))) {
+        afw::geom::ellipses::Quadrupole const shape = measRecord.get(shapeSlot.getMeasKey());
+        if (shape.getIxx() > 0 && shape.getIyy() > 0 && shape.getDeterminant() > 0) {
+            return shape;
+        }
+    }
+    try {
+        PTR(afw::detection::Psf const) psf = exposure.getPsf();
+        if (psf) {
+            afw::geom::ellipses::Quadrupole const shape = psf->computeShape(center);
+            if (shape.getIxx() > 0 && shape.getIyy() > 0 && shape.getDeterminant() > 0) {
+                return shape;
+            }
+        }
+    } catch (pex::exceptions::Exception &err) {
+    }
+    return fallback;
+}
+
 void SdssShapeAlgorithm::fail(afw::table::SourceRecord &measRecord, MeasurementError *error) const {
+    if (_weightedSumKey.isValid()) {
+        measRecord.set(_weightedSumKey, std::numeric_limits<double>::quiet_NaN());
+    }
     _resultKey.getFlagHandler().handleFailure(measRecord, error);
 }
 
 #define INSTANTIATE_IMAGE(IMAGE)                                          \
     template SdssShapeResult SdssShapeAlgorithm::computeAdaptiveMoments(  \
             IMAGE const &, geom::Point2D const &, bool, Control const &); \
+    template SdssShapeResult SdssShapeAlgorithm::computeAdaptiveMoments(             \
+            IMAGE const &, geom::Point2D const &, afw::geom::ellipses::Quadrupole const &, \
+            bool, Control const &);                                                      \
     template FluxResult SdssShapeAlgorithm::computeFixedMomentsFlux(      \
-            IMAGE const &, afw::geom::ellipses::Quadrupole const &, geom::Point2D const &)
+            IMAGE const &, afw::geom::ellipses::Quadrupole const &, geom::Point2D const &, Control const &); \
+    template FluxResult SdssShapeAlgorithm::computeFixedMomentsFluxFromSum(                              \
+            IMAGE const &, afw::geom::ellipses::Quadrupole const &, geom::Point2D const &, double);       \
+    template std::vector<FluxResult> SdssShapeAlgorithm::computeFixedMomentsFluxes(                      \
+            IMAGE const &, afw::geom::ellipses::Quadrupole const &, geom::Point2D const &,                \
+            std::vector<double> const &, Control const &)
 
 #define INSTANTIATE_PIXEL(PIXEL)                 \
     INSTANTIATE_IMAGE(afw::image::Image<PIXEL>); \
@@ -937,8 +1350,11 @@ SdssShapeTransform::SdssShapeTransform(Control const &ctrl, std::string const &n
         mapper.addMapping(key);
     }
 
+    // As for centroids, errors on the celestial moments always need the full covariance.
+    bool const hasErr = ShapeResultKey(mapper.getInputSchema()[name]).getShapeErr().isValid();
     _outShapeKey = ShapeResultKey::addFields(mapper.editOutputSchema(), name, "Shape in celestial moments",
-                                             FULL_COVARIANCE, afw::table::CoordinateType::CELESTIAL);
+                                             hasErr ? FULL_COVARIANCE : NO_UNCERTAINTY,
+                                             afw::table::CoordinateType::CELESTIAL);
     if (_transformPsf) {
         _outPsfShapeKey = afw::table::QuadrupoleKey::addFields(mapper.editOutputSchema(), name + "_psf",
                                                                "PSF shape in celestial moments",
@@ -956,31 +1372,41 @@ void SdssShapeTransform::operator()(afw::table::SourceCatalog const &inputCatalo
 
     CentroidResultKey centroidKey(inputCatalog.getSchema()[_name]);
     ShapeResultKey inShapeKey(inputCatalog.getSchema()[_name]);
+    bool const hasErr = inShapeKey.getShapeErr().isValid();
     afw::table::QuadrupoleKey inPsfShapeKey;
     if (_transformPsf) {
         inPsfShapeKey = afw::table::QuadrupoleKey(
                 inputCatalog.getSchema()[inputCatalog.getSchema().join(_name, "psf")]);
     }
 
+    // The transformations from the (x, y) to the (Ra, Dec) basis at all centroids, from a single call
+    // to the WCS.
+    ndarray::Array<double, 3, 3> const jacobians =
+            computePixelToSkyJacobians(wcs, centroidKey.extractCentroids(inputCatalog));
+
+    std::size_t i = 0;
     afw::table::SourceCatalog::const_iterator inSrc = inputCatalog.begin();
     afw::table::BaseCatalog::iterator outSrc = outputCatalog.begin();
-    for (; inSrc != inputCatalog.end(); ++inSrc, ++outSrc) {
+    for (; inSrc != inputCatalog.end(); ++inSrc, ++outSrc, ++i) {
         ShapeResult inShape = inShapeKey.get(*inSrc);
         ShapeResult outShape;
 
-        // The transformation from the (x, y) to the (Ra, Dec) basis.
-        geom::AffineTransform crdTr =
-                wcs.linearizePixelToSky(centroidKey.get(*inSrc).getCentroid(), geom::radians);
-        outShape.setShape(inShape.getShape().transform(crdTr.getLinear()));
+        geom::LinearTransform::Matrix matrix;
+        matrix << jacobians[i][0][0], jacobians[i][0][1], jacobians[i][1][0], jacobians[i][1][1];
+        geom::LinearTransform const crdTr(matrix);
+        outShape.setShape(inShape.getShape().transform(crdTr));
 
         // Transformation matrix from pixel to celestial basis.
-        ShapeTrMatrix m = makeShapeTransformMatrix(crdTr.getLinear());
-        outShape.setShapeErr((m * inShape.getShapeErr().cast<double>() * m.transpose()).cast<ErrElement>());
+        if (hasErr) {
+            ShapeTrMatrix m = makeShapeTransformMatrix(crdTr);
+            outShape.setShapeErr(
+                    (m * inShape.getShapeErr().cast<double>() * m.transpose()).cast<ErrElement>());
+        }
 
         _outShapeKey.set(*outSrc, outShape);
 
         if (_transformPsf) {
-            _outPsfShapeKey.set(*outSrc, inPsfShapeKey.get(*inSrc).transform(crdTr.getLinear()));
+            _outPsfShapeKey.set(*outSrc, inPsfShapeKey.get(*inSrc).transform(crdTr));
         }
     }
 }
@@ -21,10 +21,25 @@
  * see <http://www.lsstcorp.org/LegalNotices/>.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <complex>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <tuple>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "boost/math/special_functions/bessel.hpp"
-#include "boost/shared_array.hpp"
 #include "fftw3.h"
 
 #include "lsst/meas/base/SincCoeffs.h"
@@ -32,6 +47,7 @@
 #include "lsst/geom/Extent.h"
 #include "lsst/afw/image/Image.h"
 #include "lsst/afw/math/Integrate.h"
+#include "lsst/afw/math/offsetImage.h"
 
 namespace lsst {
 namespace meas {
@@ -329,41 +345,116 @@ std::pair<double, double> rotate(double x, double y, double angle) {
 /*  todo
  * - try sub pixel shift if it doesn't break even symmetry
  * - put values directly in an Image
- * - precompute the plan
  */
 
-template <typename PixelT>
-std::shared_ptr<afw::image::Image<PixelT>> calcImageKSpaceCplx(double const rad1, double const rad2,
-                                                               double const posAng,
-                                                               double const ellipticity) {
-    // we only need a half-width due to symmetry
-    // make the hwid 2*rad2 so we have some buffer space and round up to the next power of 2
+// An array allocated with fftw_malloc, so that it has the alignment FFTW plans for.
+template <typename T>
+class FftwArray {
+public:
+    explicit FftwArray(std::size_t size) : _data(static_cast<T*>(fftw_malloc(size * sizeof(T)))) {
+        if (!_data) {
+            throw std::bad_alloc();
+        }
+    }
+    FftwArray(FftwArray const&) = delete;
+    FftwArray& operator=(FftwArray const&) = delete;
+    ~FftwArray() { fftw_free(_data); }
+
+    T* get() const { return _data; }
+
+private:
+    T* _data;
+};
+
+// Return the width of the k-space images for an aperture of outer radius rad2.  We only need a half-width
+// due to symmetry; make it 2*rad2 so we have some buffer space and round up to the next power of 2.
+int computeFftWidth(double const rad2) {
     int log2 = static_cast<int>(::ceil(::log10(2.0 * rad2) / log10(2.0)));
     if (log2 < 3) {
         log2 = 3;
     }
     int hwid = pow(2, log2);
-    int wid = 2 * hwid - 1;
+    return 2 * hwid - 1;
+}
+
+// FFTW plans for the in-place transforms of each (power-of-two based) width, created on first use and
+// reused for every aperture of that width; they are never destroyed.  A plan is taken from the FFTW
+// wisdom if there is any (see SincCoeffs::importFftwWisdom and planFftw), and otherwise estimated.
+// Planning is not thread-safe, so it happens under a lock, but executing a plan on new arrays is.
+std::mutex fftwPlanMutex;
+std::map<int, fftw_plan> complexPlans;
+std::map<int, fftw_plan> realPlans;
+
+// Return the plan for a width, creating it with the given flags if needed; the lock must be held.
+// An estimated plan is only made if there is no wisdom for a measured one.
+fftw_plan makeComplexPlan(int wid, unsigned flags) {
+    auto iter = complexPlans.find(wid);
+    if (iter == complexPlans.end()) {
+        FftwArray<fftw_complex> buffer(wid * wid);
+        fftw_plan plan = nullptr;
+        if (flags & FFTW_ESTIMATE) {  // FFTW_MEASURE is zero, so it cannot be tested for
+            plan = fftw_plan_dft_2d(wid, wid, buffer.get(), buffer.get(), FFTW_BACKWARD,
+                                    FFTW_MEASURE | FFTW_WISDOM_ONLY);
+        }
+        if (!plan) {
+            plan = fftw_plan_dft_2d(wid, wid, buffer.get(), buffer.get(), FFTW_BACKWARD, flags);
+        }
+        iter = complexPlans.emplace(wid, plan).first;
+    }
+    return iter->second;
+}
+
+fftw_plan makeRealPlan(int wid, unsigned flags) {
+    auto iter = realPlans.find(wid);
+    if (iter == realPlans.end()) {
+        FftwArray<double> buffer(wid * wid);
+        fftw_plan plan = nullptr;
+        if (flags & FFTW_ESTIMATE) {  // FFTW_MEASURE is zero, so it cannot be tested for
+            plan = fftw_plan_r2r_2d(wid, wid, buffer.get(), buffer.get(), FFTW_R2HC, FFTW_R2HC,
+                                    FFTW_MEASURE | FFTW_WISDOM_ONLY);
+        }
+        if (!plan) {
+            plan = fftw_plan_r2r_2d(wid, wid, buffer.get(), buffer.get(), FFTW_R2HC, FFTW_R2HC, flags);
+        }
+        iter = realPlans.emplace(wid, plan).first;
+    }
+    return iter->second;
+}
+
+fftw_plan getComplexPlan(int wid) {
+    std::lock_guard<std::mutex> lock(fftwPlanMutex);
+    return makeComplexPlan(wid, FFTW_ESTIMATE);
+}
+
+fftw_plan getRealPlan(int wid) {
+    std::lock_guard<std::mutex> lock(fftwPlanMutex);
+    return makeRealPlan(wid, FFTW_ESTIMATE);
+}
+
+template <typename PixelT>
+std::shared_ptr<afw::image::Image<PixelT>> calcImageKSpaceCplx(double const rad1, double const rad2,
+                                                               double const posAng,
+                                                               double const ellipticity) {
+    int const wid = computeFftWidth(rad2);
     int xcen = wid / 2, ycen = wid / 2;
     FftShifter fftshift(wid);
 
-    boost::shared_array<std::complex<double>> cimg(new std::complex<double>[wid * wid]);
-    std::complex<double>* c = cimg.get();
-    // fftplan args: nx, ny, *in, *out, direction, flags
-    // - done in-situ if *in == *out
-    fftw_plan plan = fftw_plan_dft_2d(wid, wid, reinterpret_cast<fftw_complex*>(c),
-                                      reinterpret_cast<fftw_complex*>(c), FFTW_BACKWARD, FFTW_ESTIMATE);
+    FftwArray<fftw_complex> cimg(wid * wid);
+    std::complex<double>* c = reinterpret_cast<std::complex<double>*>(cimg.get());
 
-    // compute the k-space values and put them in the cimg array
+    // compute the k-space values and put them in the cimg array.  The aperture is symmetric under
+    // k -> -k, so only the half-plane up to the center is evaluated, and reflected through it.
     double const twoPiRad1 = geom::TWOPI * rad1;
     double const twoPiRad2 = geom::TWOPI * rad2;
     double const scale = (1.0 - ellipticity);
-    for (int iY = 0; iY < wid; ++iY) {
+    for (int iY = 0; iY <= ycen; ++iY) {
         int const fY = fftshift.shift(iY);
+        int const fYReflected = fftshift.shift(wid - 1 - iY);
         double const ky = (static_cast<double>(iY) - ycen) / wid;
 
-        for (int iX = 0; iX < wid; ++iX) {
+        for (int iX = 0; iX < (iY < ycen ? wid : xcen + 1); ++iX) {
             int const fX = fftshift.shift(iX);
+            int const fXReflected = fftshift.shift(wid - 1 - iX);
             double const kx = static_cast<double>(iX - xcen) / wid;
 
             // rotate
@@ -378,13 +469,13 @@ std::shared_ptr<afw::image::Image<PixelT>> calcImageKSpaceCplx(double const rad1
             double const airy = airy2 - airy1;
 
             c[fY * wid + fX] = std::complex<double>(scale * airy, 0.0);
+            c[fYReflected * wid + fXReflected] = c[fY * wid + fX];
         }
     }
     c[0] = scale * geom::PI * (rad2 * rad2 - rad1 * rad1);
 
-    // perform the fft and clean up after ourselves
-    fftw_execute(plan);
-    fftw_destroy_plan(plan);
+    // perform the fft in place
+    fftw_execute_dft(getComplexPlan(wid), cimg.get(), cimg.get());
 
     // put the coefficients into an image
     auto coeffImage = std::make_shared<afw::image::Image<PixelT>>(geom::ExtentI(wid, wid), 0.0);
@@ -412,50 +503,47 @@ std::shared_ptr<afw::image::Image<PixelT>> calcImageKSpaceCplx(double const rad1
 
 template <typename PixelT>
 std::shared_ptr<afw::image::Image<PixelT>> calcImageKSpaceReal(double const rad1, double const rad2) {
-    // we only need a half-width due to symmertry
-    // make the hwid 2*rad2 so we have some buffer space and round up to the next power of 2
-    int log2 = static_cast<int>(::ceil(::log10(2.0 * rad2) / log10(2.0)));
-    if (log2 < 3) {
-        log2 = 3;
-    }
-    int hwid = pow(2, log2);
-    int wid = 2 * hwid - 1;
+    int const wid = computeFftWidth(rad2);
+    int const hwid = (wid + 1) / 2;
     int xcen = wid / 2, ycen = wid / 2;
     FftShifter fftshift(wid);
 
-    boost::shared_array<double> cimg(new double[wid * wid]);
+    FftwArray<double> cimg(wid * wid);
     double* c = cimg.get();
-    // fftplan args: nx, ny, *in, *out, kindx, kindy, flags
-    // - done in-situ if *in == *out
-    fftw_plan plan = fftw_plan_r2r_2d(wid, wid, c, c, FFTW_R2HC, FFTW_R2HC, FFTW_ESTIMATE);
 
-    // compute the k-space values and put them in the cimg array
+    // compute the k-space values and put them in the cimg array.  They depend only on the squared
+    // distance dx^2 + dy^2 from the center (in units of 1/wid), so each octant is a reflection of the
+    // first, and the Bessel functions are evaluated once per distinct distance.
     double const twoPiRad1 = geom::TWOPI * rad1;
     double const twoPiRad2 = geom::TWOPI * rad2;
-    for (int iY = 0; iY < wid; ++iY) {
-        int const fY = fftshift.shift(iY);
-        double const ky = (static_cast<double>(iY) - ycen) / wid;
-
-        for (int iX = 0; iX < wid; ++iX) {
-            int const fX = fftshift.shift(iX);
-
-            // emacs indent breaks if this isn't separte
-            double const iXcen = static_cast<double>(iX - xcen);
-            double const kx = iXcen / wid;
-
-            double const k = ::sqrt(kx * kx + ky * ky);
-            double const airy1 = (rad1 > 0 ? rad1 * J1(twoPiRad1 * k) : 0.0) / k;
-            double const airy2 = rad2 * J1(twoPiRad2 * k) / k;
-            double const airy = airy2 - airy1;
-            c[fY * wid + fX] = airy;
+    std::vector<double> airyTable(2 * xcen * xcen + 1);
+    std::vector<bool> airyKnown(airyTable.size(), false);
+    for (int dy = 0; dy <= ycen; ++dy) {
+        for (int dx = dy; dx <= xcen; ++dx) {
+            int const d2 = dx * dx + dy * dy;
+            if (!airyKnown[d2]) {
+                double const k = std::sqrt(static_cast<double>(d2)) / wid;
+                double const airy1 = (rad1 > 0 ? rad1 * J1(twoPiRad1 * k) : 0.0) / k;
+                double const airy2 = rad2 * J1(twoPiRad2 * k) / k;
+                airyTable[d2] = airy2 - airy1;
+                airyKnown[d2] = true;
+            }
+            double const airy = airyTable[d2];
+            int const xs[2] = {fftshift.shift(xcen + dx), fftshift.shift(xcen - dx)};
+            int const ys[2] = {fftshift.shift(ycen + dy), fftshift.shift(ycen - dy)};
+            for (int const fY : ys) {
+                for (int const fX : xs) {
+                    c[fY * wid + fX] = airy;
+                    c[fX * wid + fY] = airy;
+                }
+            }
         }
     }
     int fxy = fftshift.shift(wid / 2);
     c[fxy * wid + fxy] = geom::PI * (rad2 * rad2 - rad1 * rad1);
 
-    // perform the fft and clean up after ourselves
-    fftw_execute(plan);
-    fftw_destroy_plan(plan);
+    // perform the fft in place
+    fftw_execute_r2r(getRealPlan(wid), c, c);
 
     // put the coefficients into an image
     auto coeffImage = std::make_shared<afw::image::Image<PixelT>>(geom::ExtentI(wid, wid), 0.0);
@@ -478,8 +566,160 @@ std::shared_ptr<afw::image::Image<PixelT>> calcImageKSpaceReal(double const rad1
     return coeffImage;
 }
 
+// Default bound on the memory used by each SincCoeffs cache
+std::size_t const DEFAULT_MAX_CACHE_BYTES = 256 * 1024 * 1024;
+
+// Layout of the files written by SincCoeffs::writeCache: a FileHeader, followed by one FileEntry per
+// aperture, each followed by its pixels (row by row); the entries and the pixels start on multiples of
+// FILE_ALIGNMENT bytes, so the pixels of a memory-mapped file are suitably aligned.  Version 2 added the
+// axis ratio and position angle of elliptical apertures.
+char const FILE_MAGIC[8] = {'S', 'I', 'N', 'C', 'C', 'O', 'E', 'F'};
+std::uint32_t const FILE_VERSION = 2;
+std::size_t const FILE_ALIGNMENT = 64;
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t pixelSize;
+    std::uint64_t nEntries;
+};
+
+struct FileEntry {
+    float radius;
+    float innerFactor;
+    float axisRatio;
+    float theta;
+    std::int32_t width;
+    std::int32_t height;
+    std::int32_t x0;
+    std::int32_t y0;
+};
+
+std::size_t alignFileOffset(std::size_t offset) {
+    return (offset + FILE_ALIGNMENT - 1) / FILE_ALIGNMENT * FILE_ALIGNMENT;
+}
+
 }  // namespace
 
+// A read-only, memory-mapped coefficient file, indexed by aperture.  Coefficient images are views into
+// the mapping, which stays mapped until the store and every image from it are destroyed.
+template <typename PixelT>
+class SincCoeffs<PixelT>::Store {
+public:
+    explicit Store(std::string const& filename);
+
+    // Return the coefficients for the given aperture, or null if they are not in the file
+    PTR(CoeffT) find(CacheKey const& key) const;
+
+    // Return the apertures in the file
+    std::vector<CacheKey> getKeys() const;
+
+private:
+    struct Entry {
+        FileEntry record;
+        std::size_t offset;  //< Offset of the pixels in the file
+    };
+    typedef std::map<CacheKey, Entry, CacheKeyCompare> Index;
+
+    std::shared_ptr<char> _mapping;
+    Index _index;
+};
+
+template <typename PixelT>
+SincCoeffs<PixelT>::Store::Store(std::string const& filename) {
+    int const fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw LSST_EXCEPT(pex::exceptions::IoError,
+                          (boost::format("Unable to open %s for reading") % filename).str());
+    }
+    struct stat status;
+    if (::fstat(fd, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(FileHeader)) {
+        ::close(fd);
+        throw LSST_EXCEPT(pex::exceptions::IoError,
+                          (boost::format("%s is not a sinc coefficient file") % filename).str());
+    }
+    std::size_t const size = status.st_size;
+    // Read-only: coefficient images are only handed out as const, and the pages are shared by every
+    // process that maps the file.  writeCache never modifies an existing file, so the mapping stays
+    // valid even if the store is rewritten.
+    void* const address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        throw LSST_EXCEPT(pex::exceptions::IoError, (boost::format("Unable to map %s") % filename).str());
+    }
+    _mapping.reset(static_cast<char*>(address), [size](char* pointer) { ::munmap(pointer, size); });
+
+    FileHeader header;
+    std::memcpy(&header, _mapping.get(), sizeof(header));
+    if (std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        throw LSST_EXCEPT(pex::exceptions::IoError,
+                          (boost::format("%s is not a sinc coefficient file") % filename).str());
+    }
+    if (header.version != FILE_VERSION) {
+        throw LSST_EXCEPT(pex::exceptions::IoError,
+                          (boost::format("%s has unsupported version %d (expected %d)") % filename %
+                           header.version % FILE_VERSION)
+                                  .str());
+    }
+    if (header.pixelSize != sizeof(PixelT)) {
+        throw LSST_EXCEPT(pex::exceptions::IoError,
+                          (boost::format("%s holds %d-byte pixels, not %d-byte pixels") % filename %
+                           header.pixelSize % sizeof(PixelT))
+                                  .str());
+    }
+    std::size_t offset = sizeof(header);
+    for (std::uint64_t i = 0; i < header.nEntries; ++i) {
+        offset = alignFileOffset(offset);
+        if (offset + sizeof(FileEntry) > size) {
+            throw LSST_EXCEPT(pex::exceptions::IoError, (boost::format("%s is truncated") % filename).str());
+        }
+        FileEntry record;
+        std::memcpy(&record, _mapping.get() + offset, sizeof(record));
+        offset = alignFileOffset(offset + sizeof(record));
+        std::size_t const bytes = static_cast<std::size_t>(record.width) * record.height * sizeof(PixelT);
+        if (record.width <= 0 || record.height <= 0 || offset + bytes > size) {
+            throw LSST_EXCEPT(pex::exceptions::IoError, (boost::format("%s is truncated") % filename).str());
+        }
+        _index.emplace(CacheKey(record.radius, record.innerFactor, record.axisRatio, record.theta),
+                       Entry{record, offset});
+        offset += bytes;
+    }
+}
+
+template <typename PixelT>
+PTR(typename SincCoeffs<PixelT>::CoeffT) SincCoeffs<PixelT>::Store::find(CacheKey const& key) const {
+    typename Index::const_iterator iter = _index.find(key);
+    if (iter == _index.end()) {
+        return PTR(CoeffT)();
+    }
+    FileEntry const& record = iter->second.record;
+    ndarray::Array<PixelT, 2, 2> array = ndarray::external(
+            reinterpret_cast<PixelT*>(_mapping.get() + iter->second.offset),
+            ndarray::makeVector(record.height, record.width), ndarray::makeVector(record.width, 1),
+            _mapping);
+    return std::make_shared<CoeffT>(array, false, geom::Point2I(record.x0, record.y0));
+}
+
+template <typename PixelT>
+std::vector<typename SincCoeffs<PixelT>::CacheKey> SincCoeffs<PixelT>::Store::getKeys() const {
+    std::vector<CacheKey> keys;
+    for (auto const& entry : _index) {
+        keys.push_back(entry.first);
+    }
+    return keys;
+}
+
+template <typename PixelT>
+SincCoeffs<PixelT>::SincCoeffs()
+        : _cache(),
+          _bytes(0),
+          _maxBytes(DEFAULT_MAX_CACHE_BYTES),
+          _clock(0),
+          _hits(0),
+          _misses(0),
+          _loads(0),
+          _evictions(0) {}
+
 template <typename PixelT>
 SincCoeffs<PixelT>& SincCoeffs<PixelT>::getInstance() {
     static SincCoeffs<PixelT> instance;
@@ -494,17 +734,281 @@ void SincCoeffs<PixelT>::cache(float r1, float r2) {
     }
     double const innerFactor = r1 / r2;
     afw::geom::ellipses::Axes axes(r2, r2, 0.0);
-    if (!getInstance()._lookup(axes, innerFactor)) {
+    SincCoeffs& instance = getInstance();
+    if (!instance._lookup(axes, innerFactor) && !instance._load(CacheKey(r2, innerFactor), true)) {
         PTR(typename SincCoeffs<PixelT>::CoeffT) coeff = calculate(axes, innerFactor);
-        getInstance()._cache[r2][innerFactor] = coeff;
+        instance._insert(CacheKey(r2, innerFactor), coeff);
+    }
+}
+
+template <typename PixelT>
+void SincCoeffs<PixelT>::cacheAll(std::vector<std::pair<float, float>> const& radii, int nThreads) {
+    for (auto const& r : radii) {
+        if (r.first < 0.0 || r.second < r.first) {
+            throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                              (boost::format("Invalid r1,r2 = %f,%f") % r.first % r.second).str());
+        }
+    }
+    SincCoeffs& instance = getInstance();
+    std::vector<std::pair<float, float>> missing;
+    for (auto const& r : radii) {
+        double const innerFactor = r.first / r.second;
+        if (!instance._lookup(afw::geom::ellipses::Axes(r.second, r.second, 0.0), innerFactor) &&
+            !instance._load(CacheKey(r.second, innerFactor), true) &&
+            std::find(missing.begin(), missing.end(), r) == missing.end()) {
+            missing.push_back(r);
+        }
+    }
+    if (missing.empty()) {
+        return;
+    }
+    if (nThreads <= 0) {
+        nThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    nThreads = std::min(nThreads, static_cast<int>(missing.size()));
+
+    // Each thread takes the next aperture to calculate until there are none left.
+    std::atomic<std::size_t> next(0);
+    std::vector<std::exception_ptr> errors(nThreads);
+    auto const work = [&instance, &missing, &next, &errors](int thread) {
+        try {
+            for (std::size_t i = next++; i < missing.size(); i = next++) {
+                double const innerFactor = missing[i].first / missing[i].second;
+                afw::geom::ellipses::Axes const axes(missing[i].second, missing[i].second, 0.0);
+                instance._insert(CacheKey(missing[i].second, innerFactor), calculate(axes, innerFactor));
+            }
+        } catch (...) {
+            errors[thread] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int thread = 1; thread < nThreads; ++thread) {
+        threads.emplace_back(work, thread);
+    }
+    work(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (std::exception_ptr const& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+template <typename PixelT>
+void SincCoeffs<PixelT>::writeCache(std::string const& filename) {
+    std::vector<std::pair<CacheKey, CONST_PTR(CoeffT)>> entries;
+    SincCoeffs& instance = getInstance();
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(instance._mutex);
+        for (auto const& entry : instance._cache) {
+            if (entry.first.nShift == 0) {
+                entries.emplace_back(entry.first, entry.second.coeff);
+            }
+        }
+    }
+
+    // Write to a new file in the same directory and rename it over the store, so processes that have
+    // the old file mapped keep reading it intact, and none ever sees a partial file.
+    static std::atomic<unsigned> counter(0);
+    std::string const tempname = (boost::format("%s.tmp%d.%d") % filename % ::getpid() % counter++).str();
+    std::ofstream stream(tempname, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+        throw LSST_EXCEPT(pex::exceptions::IoError,
+                          (boost::format("Unable to open %s for writing") % tempname).str());
+    }
+    std::size_t offset = 0;
+    auto const pad = [&stream, &offset](std::size_t target) {
+        static char const zeros[FILE_ALIGNMENT] = {};
+        stream.write(zeros, target - offset);
+        offset = target;
+    };
+    FileHeader header;
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = FILE_VERSION;
+    header.pixelSize = sizeof(PixelT);
+    header.nEntries = entries.size();
+    stream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    offset += sizeof(header);
+    for (auto const& entry : entries) {
+        CoeffT const& coeff = *entry.second;
+        pad(alignFileOffset(offset));
+        FileEntry const record = {entry.first.radius,    entry.first.innerFactor, entry.first.axisRatio,
+                                  entry.first.theta,     coeff.getWidth(),        coeff.getHeight(),
+                                  coeff.getX0(),         coeff.getY0()};
+        stream.write(reinterpret_cast<char const*>(&record), sizeof(record));
+        offset += sizeof(record);
+        pad(alignFileOffset(offset));
+        for (int y = 0; y < coeff.getHeight(); ++y) {
+            stream.write(reinterpret_cast<char const*>(&*coeff.row_begin(y)),
+                         coeff.getWidth() * sizeof(PixelT));
+        }
+        offset += coeff.getWidth() * coeff.getHeight() * sizeof(PixelT);
+    }
+    stream.close();
+    if (!stream) {
+        std::remove(tempname.c_str());
+        throw LSST_EXCEPT(pex::exceptions::IoError,
+                          (boost::format("Error writing sinc coefficients to %s") % tempname).str());
+    }
+    if (std::rename(tempname.c_str(), filename.c_str()) != 0) {
+        std::remove(tempname.c_str());
+        throw LSST_EXCEPT(pex::exceptions::IoError,
+                          (boost::format("Unable to rename %s to %s") % tempname % filename).str());
+    }
+}
+
+template <typename PixelT>
+void SincCoeffs<PixelT>::readCache(std::string const& filename) {
+    Store const store(filename);
+    SincCoeffs& instance = getInstance();
+    for (CacheKey const& key : store.getKeys()) {
+        instance._insert(key, store.find(key));
+    }
+}
+
+template <typename PixelT>
+void SincCoeffs<PixelT>::openStore(std::string const& filename) {
+    auto store = std::make_shared<Store const>(filename);
+    SincCoeffs& instance = getInstance();
+    std::unique_lock<std::shared_timed_mutex> lock(instance._mutex);
+    instance._stores.push_back(store);
+}
+
+template <typename PixelT>
+void SincCoeffs<PixelT>::closeStores() {
+    SincCoeffs& instance = getInstance();
+    std::unique_lock<std::shared_timed_mutex> lock(instance._mutex);
+    instance._stores.clear();
+}
+
+template <typename PixelT>
+void SincCoeffs<PixelT>::planFftw(double maxRadius) {
+    std::lock_guard<std::mutex> lock(fftwPlanMutex);
+    int const maxWid = computeFftWidth(maxRadius);
+    for (int wid = computeFftWidth(1.0); wid <= maxWid; wid = 2 * wid + 1) {
+        makeRealPlan(wid, FFTW_MEASURE);
+        makeComplexPlan(wid, FFTW_MEASURE);
+    }
+}
+
+template <typename PixelT>
+void SincCoeffs<PixelT>::importFftwWisdom(std::string const& filename) {
+    std::lock_guard<std::mutex> lock(fftwPlanMutex);
+    if (!fftw_import_wisdom_from_filename(filename.c_str())) {
+        throw LSST_EXCEPT(pex::exceptions::IoError,
+                          (boost::format("Unable to import FFTW wisdom from %s") % filename).str());
+    }
+}
+
+template <typename PixelT>
+void SincCoeffs<PixelT>::exportFftwWisdom(std::string const& filename) {
+    std::lock_guard<std::mutex> lock(fftwPlanMutex);
+    if (!fftw_export_wisdom_to_filename(filename.c_str())) {
+        throw LSST_EXCEPT(pex::exceptions::IoError,
+                          (boost::format("Unable to export FFTW wisdom to %s") % filename).str());
     }
 }
 
 template <typename PixelT>
 CONST_PTR(typename SincCoeffs<PixelT>::CoeffT)
 SincCoeffs<PixelT>::get(afw::geom::ellipses::Axes const& axes, float const innerFactor) {
-    CONST_PTR(CoeffT) coeff = getInstance()._lookup(axes, innerFactor);
-    return coeff ? coeff : calculate(axes, innerFactor);
+    SincCoeffs& instance = getInstance();
+    CONST_PTR(CoeffT) coeff = instance._lookup(axes, innerFactor);
+    if (coeff) {
+        ++instance._hits;
+        return coeff;
+    }
+    ++instance._misses;
+    // Circular coefficients loaded from a store are cached, like those requested with 'cache'.
+    bool const circular = FuzzyCompare<float>().isEqual(axes.getA(), axes.getB());
+    PTR(CoeffT) stored = circular ? instance._load(CacheKey(axes.getA(), innerFactor), true)
+                                  : instance._load(CacheKey(axes.getA(), innerFactor,
+                                                            axes.getB() / axes.getA(), axes.getTheta()),
+                                                   false);
+    if (stored) {
+        return stored;
+    }
+    return calculate(axes, innerFactor);
+}
+
+template <typename PixelT>
+afw::geom::ellipses::Axes SincCoeffs<PixelT>::quantize(afw::geom::ellipses::Axes const& axes,
+                                                       double const tolerance) {
+    if (!(tolerance > 0.0)) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("Quantization tolerance = %f is not positive") % tolerance).str());
+    }
+    afw::geom::ellipses::Axes normalized(axes);
+    normalized.normalize();
+    double const a = std::exp(std::round(std::log(normalized.getA()) / tolerance) * tolerance);
+    double const q = std::min(1.0, std::max(tolerance, std::round(normalized.getB() / normalized.getA() /
+                                                                   tolerance) *
+                                                               tolerance));
+    if (q == 1.0) {
+        return afw::geom::ellipses::Axes(a, a, 0.0);
+    }
+    double const theta = std::round(normalized.getTheta() / tolerance) * tolerance;
+    return afw::geom::ellipses::Axes(a, q * a, theta);
+}
+
+template <typename PixelT>
+CONST_PTR(typename SincCoeffs<PixelT>::CoeffT)
+SincCoeffs<PixelT>::getQuantized(afw::geom::ellipses::Axes const& axes, float const innerFactor,
+                                 double const tolerance) {
+    if (innerFactor < 0.0 || innerFactor > 1.0) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("innerFactor = %f is not between 0 and 1") % innerFactor).str());
+    }
+    afw::geom::ellipses::Axes const quantized = quantize(axes, tolerance);
+    CacheKey const key(quantized.getA(), innerFactor, quantized.getB() / quantized.getA(),
+                       quantized.getTheta());
+    SincCoeffs& instance = getInstance();
+    CONST_PTR(CoeffT) coeff = instance._find(key);
+    if (coeff) {
+        ++instance._hits;
+        return coeff;
+    }
+    ++instance._misses;
+    PTR(CoeffT) stored = instance._load(key, true);
+    if (stored) {
+        return stored;
+    }
+    PTR(CoeffT) calculated = calculate(quantized, innerFactor);
+    instance._insert(key, calculated);
+    return calculated;
+}
+
+template <typename PixelT>
+CONST_PTR(typename SincCoeffs<PixelT>::CoeffT)
+SincCoeffs<PixelT>::getShifted(afw::geom::ellipses::Axes const& axes, float const innerFactor, int shiftX,
+                               int shiftY, int nShift, std::string const& warpingKernelName) {
+    if (nShift <= 0 || shiftX < 0 || shiftX >= nShift || shiftY < 0 || shiftY >= nShift) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("Invalid shift = (%d, %d)/%d") % shiftX % shiftY % nShift).str());
+    }
+    CacheKey const key(axes.getA(), innerFactor, axes.getB() / axes.getA(), axes.getTheta(), nShift, shiftX,
+                       shiftY, warpingKernelName);
+    SincCoeffs& instance = getInstance();
+    CONST_PTR(CoeffT) coeff = instance._find(key);
+    if (coeff) {
+        ++instance._hits;
+        return coeff;
+    }
+    ++instance._misses;
+    CONST_PTR(CoeffT) base = instance._lookup(axes, innerFactor);
+    if (!base) {
+        base = instance._load(CacheKey(axes.getA(), innerFactor, axes.getB() / axes.getA(), axes.getTheta()),
+                              false);
+    }
+    if (!base) {
+        base = calculate(axes, innerFactor);
+    }
+    PTR(CoeffT) shifted = afw::math::offsetImage(*base, static_cast<float>(shiftX) / nShift,
+                                                 static_cast<float>(shiftY) / nShift, warpingKernelName);
+    instance._insert(key, shifted);
+    return shifted;
 }
 
 template <typename PixelT>
@@ -521,12 +1025,110 @@ SincCoeffs<PixelT>::_lookup(afw::geom::ellipses::Axes const& axes, double const
     if (!FuzzyCompare<float>().isEqual(axes.getA(), axes.getB())) {
         return null;
     }
-    typename CoeffMapMap::const_iterator iter1 = _cache.find(axes.getA());
-    if (iter1 == _cache.end()) {
-        return null;
+    return _find(CacheKey(axes.getA(), innerFactor));
+}
+
+template <typename PixelT>
+CONST_PTR(typename SincCoeffs<PixelT>::CoeffT)
+SincCoeffs<PixelT>::_find(CacheKey const& key) const {
+    std::shared_lock<std::shared_timed_mutex> lock(_mutex);
+    typename CoeffMap::const_iterator iter = _cache.find(key);
+    if (iter == _cache.end()) {
+        return CONST_PTR(CoeffT)();
+    }
+    iter->second.lastUsed = ++_clock;
+    return iter->second.coeff;
+}
+
+template <typename PixelT>
+PTR(typename SincCoeffs<PixelT>::CoeffT) SincCoeffs<PixelT>::_load(CacheKey const& key, bool doCache) {
+    std::vector<std::shared_ptr<Store const>> stores;
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(_mutex);
+        stores = _stores;
+    }
+    for (auto const& store : stores) {
+        PTR(CoeffT) coeff = store->find(key);
+        if (coeff) {
+            ++_loads;
+            if (doCache) {
+                _insert(key, coeff);
+            }
+            return coeff;
+        }
     }
-    typename CoeffMap::const_iterator iter2 = iter1->second.find(innerFactor);
-    return (iter2 == iter1->second.end()) ? null : iter2->second;
+    return PTR(CoeffT)();
+}
+
+template <typename PixelT>
+void SincCoeffs<PixelT>::_insert(CacheKey const& key, PTR(CoeffT) coeff) {
+    std::size_t const bytes = coeff->getWidth() * coeff->getHeight() * sizeof(PixelT);
+    std::unique_lock<std::shared_timed_mutex> lock(_mutex);
+    // Another thread may have beaten us to it, in which case we keep the existing entry
+    auto inserted = _cache.emplace(std::piecewise_construct, std::forward_as_tuple(key),
+                                   std::forward_as_tuple(coeff, bytes, ++_clock));
+    if (inserted.second) {
+        _bytes += bytes;
+        _evict();
+    }
+}
+
+template <typename PixelT>
+void SincCoeffs<PixelT>::_evict() {
+    while (_bytes > _maxBytes && !_cache.empty()) {
+        // Eviction is rare, so a linear search for the oldest entry is cheaper than
+        // maintaining a recency list that every lookup would have to update.
+        typename CoeffMap::iterator oldest = _cache.begin();
+        for (typename CoeffMap::iterator iter = _cache.begin(); iter != _cache.end(); ++iter) {
+            if (iter->second.lastUsed < oldest->second.lastUsed) {
+                oldest = iter;
+            }
+        }
+        _bytes -= oldest->second.bytes;
+        _cache.erase(oldest);
+        ++_evictions;
+    }
+}
+
+template <typename PixelT>
+void SincCoeffs<PixelT>::setMaxCacheBytes(std::size_t maxBytes) {
+    SincCoeffs& instance = getInstance();
+    std::unique_lock<std::shared_timed_mutex> lock(instance._mutex);
+    instance._maxBytes = maxBytes;
+    instance._evict();
+}
+
+template <typename PixelT>
+std::size_t SincCoeffs<PixelT>::getMaxCacheBytes() {
+    SincCoeffs& instance = getInstance();
+    std::shared_lock<std::shared_timed_mutex> lock(instance._mutex);
+    return instance._maxBytes;
+}
+
+template <typename PixelT>
+typename SincCoeffs<PixelT>::CacheStatistics SincCoeffs<PixelT>::getCacheStatistics() {
+    SincCoeffs& instance = getInstance();
+    std::shared_lock<std::shared_timed_mutex> lock(instance._mutex);
+    return CacheStatistics{instance._hits,  instance._misses,       instance._loads,
+                           instance._evictions, instance._cache.size(), instance._bytes,
+                           instance._maxBytes};
+}
+
+template <typename PixelT>
+void SincCoeffs<PixelT>::resetCacheStatistics() {
+    SincCoeffs& instance = getInstance();
+    instance._hits = 0;
+    instance._misses = 0;
+    instance._loads = 0;
+    instance._evictions = 0;
+}
+
+template <typename PixelT>
+void SincCoeffs<PixelT>::clearCache() {
+    SincCoeffs& instance = getInstance();
+    std::unique_lock<std::shared_timed_mutex> lock(instance._mutex);
+    instance._cache.clear();
+    instance._bytes = 0;
 }
 
 template <typename PixelT>
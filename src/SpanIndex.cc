@@ -0,0 +1,131 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+#include "lsst/meas/base/SpanIndex.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+namespace {
+
+// Number of recently indexed SpanSets remembered by each thread; a source's Footprint is normally
+// checked by all the centroiders before the next source is measured, so a few are plenty.
+std::size_t const CACHE_SIZE = 4;
+
+struct CacheEntry {
+    std::weak_ptr<afw::geom::SpanSet const> spans;
+    afw::geom::SpanSet const* key = nullptr;
+    std::shared_ptr<SpanIndex const> index;
+};
+
+struct Cache {
+    std::array<CacheEntry, CACHE_SIZE> entries;
+    std::size_t next = 0;
+};
+
+}  // namespace
+
+std::size_t const SpanIndex::MIN_INDEXED_SPANS;
+
+SpanIndex::SpanIndex(afw::geom::SpanSet const& spans) : _minY(0) {
+    // Spans are sorted and merged here rather than relying on the SpanSet being normalized.
+    std::vector<std::pair<int, std::pair<int, int>>> sorted;
+    sorted.reserve(spans.size());
+    for (auto const& span : spans) {
+        sorted.emplace_back(span.getY(), std::make_pair(span.getMinX(), span.getMaxX()));
+    }
+    std::sort(sorted.begin(), sorted.end());
+    if (sorted.empty()) {
+        _rowBegin.push_back(0);
+        return;
+    }
+    _minY = sorted.front().first;
+    int const nRows = sorted.back().first - _minY + 1;
+    _rowBegin.assign(nRows + 1, 0);
+    _minX.reserve(sorted.size());
+    _maxX.reserve(sorted.size());
+    int row = 0;
+    for (auto const& span : sorted) {
+        int const y = span.first - _minY;
+        if (y == row && !_minX.empty() && _rowBegin[row] < _minX.size() &&
+            span.second.first <= _maxX.back() + 1) {
+            _maxX.back() = std::max(_maxX.back(), span.second.second);
+            continue;
+        }
+        for (; row < y; ++row) {
+            _rowBegin[row + 1] = _minX.size();
+        }
+        _minX.push_back(span.second.first);
+        _maxX.push_back(span.second.second);
+    }
+    for (; row < nRows; ++row) {
+        _rowBegin[row + 1] = _minX.size();
+    }
+}
+
+bool SpanIndex::contains(geom::Point2I const& point) const {
+    int const row = point.getY() - _minY;
+    if (row < 0 || row + 1 >= static_cast<int>(_rowBegin.size())) {
+        return false;
+    }
+    auto const begin = _minX.begin() + _rowBegin[row];
+    auto const end = _minX.begin() + _rowBegin[row + 1];
+    // The last span on the row that starts at or before x is the only one that can contain it.
+    auto const after = std::upper_bound(begin, end, point.getX());
+    if (after == begin) {
+        return false;
+    }
+    return point.getX() <= _maxX[(after - _minX.begin()) - 1];
+}
+
+std::shared_ptr<SpanIndex const> SpanIndex::get(std::shared_ptr<afw::geom::SpanSet const> const& spans) {
+    thread_local Cache cache;
+    for (auto const& entry : cache.entries) {
+        if (entry.key == spans.get() && entry.spans.lock() == spans) {
+            return entry.index;
+        }
+    }
+    CacheEntry& entry = cache.entries[cache.next];
+    cache.next = (cache.next + 1) % CACHE_SIZE;
+    entry.spans = spans;
+    entry.key = spans.get();
+    entry.index = std::make_shared<SpanIndex>(*spans);
+    return entry.index;
+}
+
+bool containsPoint(std::shared_ptr<afw::geom::SpanSet const> const& spans, geom::Point2I const& point) {
+    if (spans->size() < SpanIndex::MIN_INDEXED_SPANS) {
+        return spans->contains(point);
+    }
+    return SpanIndex::get(spans)->contains(point);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -0,0 +1,171 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include <algorithm>
+
+#include "boost/format.hpp"
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/meas/base/SpanKernels.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+namespace {
+
+void checkContained(afw::geom::SpanSet const& spans, geom::Box2I const& bbox) {
+    if (!bbox.contains(spans.getBBox())) {
+        throw LSST_EXCEPT(pex::exceptions::OutOfRangeError,
+                          (boost::format("Spans with bounding box %s are not contained by image %s") %
+                           spans.getBBox() % bbox)
+                                  .str());
+    }
+}
+
+void checkPacked(afw::geom::SpanSet const& spans, std::size_t size) {
+    if (size != static_cast<std::size_t>(spans.getArea())) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("Packed array has %d elements, but spans have %d pixels") % size %
+                           spans.getArea())
+                                  .str());
+    }
+}
+
+// Pointer to the first pixel of a span in an image which contains it.
+template <typename T>
+T* getSpanRow(afw::image::Image<T> const& image, afw::geom::Span const& span) {
+    return image.getArray()[span.getY() - image.getY0()].getData() + (span.getMinX() - image.getX0());
+}
+
+}  // namespace
+
+template <typename T, typename U>
+double dotSpans(afw::geom::SpanSet const& spans, ndarray::Array<T const, 1, 1> const& packed,
+                afw::image::Image<U> const& image) {
+    checkPacked(spans, packed.template getSize<0>());
+    checkContained(spans, image.getBBox(afw::image::PARENT));
+    T const* data = packed.getData();
+    double result = 0.0;
+    for (auto const& span : spans) {
+        result += spanKernels::dotRow(data, getSpanRow(image, span), span.getWidth());
+        data += span.getWidth();
+    }
+    return result;
+}
+
+template <typename T, typename U>
+double dotResidualSpans(afw::geom::SpanSet const& spans, ndarray::Array<T const, 1, 1> const& packed,
+                        afw::image::Image<U> const& image) {
+    checkPacked(spans, packed.template getSize<0>());
+    checkContained(spans, image.getBBox(afw::image::PARENT));
+    T const* data = packed.getData();
+    double result = 0.0;
+    for (auto const& span : spans) {
+        result += spanKernels::dotResidualRow(data, getSpanRow(image, span), span.getWidth());
+        data += span.getWidth();
+    }
+    return result;
+}
+
+template <typename T>
+double sumSquares(ndarray::Array<T const, 1, 1> const& packed) {
+    return spanKernels::sumSquaresRow(packed.getData(), packed.template getSize<0>());
+}
+
+template <typename T>
+double sumSpans(afw::geom::SpanSet const& spans, afw::image::Image<T> const& image) {
+    checkContained(spans, image.getBBox(afw::image::PARENT));
+    double result = 0.0;
+    for (auto const& span : spans) {
+        result += spanKernels::sumRow(getSpanRow(image, span), span.getWidth());
+    }
+    return result;
+}
+
+afw::image::MaskPixel orSpans(afw::geom::SpanSet const& spans,
+                              afw::image::Mask<afw::image::MaskPixel> const& mask) {
+    int const x0 = mask.getX0();
+    int const y0 = mask.getY0();
+    int const width = mask.getWidth();
+    int const height = mask.getHeight();
+    auto array = mask.getArray();
+    afw::image::MaskPixel bits = 0;
+    for (auto const& span : spans) {
+        int const y = span.getY() - y0;
+        int const xBegin = std::max(span.getMinX() - x0, 0);
+        int const xEnd = std::min(span.getMaxX() - x0 + 1, width);
+        if (y < 0 || y >= height || xBegin >= xEnd) {
+            continue;
+        }
+        bits |= spanKernels::orRow(array[y].getData() + xBegin, xEnd - xBegin);
+    }
+    return bits;
+}
+
+template <typename T>
+void insertSpans(afw::geom::SpanSet const& spans, ndarray::Array<T const, 1, 1> const& packed,
+                 afw::image::Image<T>& image) {
+    checkPacked(spans, packed.template getSize<0>());
+    checkContained(spans, image.getBBox(afw::image::PARENT));
+    T const* data = packed.getData();
+    for (auto const& span : spans) {
+        std::copy(data, data + span.getWidth(), getSpanRow(image, span));
+        data += span.getWidth();
+    }
+}
+
+template <typename T>
+void extractSpans(afw::geom::SpanSet const& spans, afw::image::Image<T> const& image,
+                  ndarray::Array<T, 1, 1> const& packed) {
+    checkPacked(spans, packed.template getSize<0>());
+    checkContained(spans, image.getBBox(afw::image::PARENT));
+    T* data = packed.getData();
+    for (auto const& span : spans) {
+        T const* row = getSpanRow(image, span);
+        std::copy(row, row + span.getWidth(), data);
+        data += span.getWidth();
+    }
+}
+
+#define INSTANTIATE_DOT(T, U)                                                                             \
+    template double dotSpans(afw::geom::SpanSet const&, ndarray::Array<T const, 1, 1> const&,             \
+                             afw::image::Image<U> const&);                                                \
+    template double dotResidualSpans(afw::geom::SpanSet const&, ndarray::Array<T const, 1, 1> const&,     \
+                                     afw::image::Image<U> const&)
+
+#define INSTANTIATE(T)                                                                                    \
+    INSTANTIATE_DOT(T, float);                                                                            \
+    INSTANTIATE_DOT(T, double);                                                                           \
+    template double sumSquares(ndarray::Array<T const, 1, 1> const&);                                     \
+    template double sumSpans(afw::geom::SpanSet const&, afw::image::Image<T> const&);                     \
+    template void insertSpans(afw::geom::SpanSet const&, ndarray::Array<T const, 1, 1> const&,            \
+                              afw::image::Image<T>&);                                                     \
+    template void extractSpans(afw::geom::SpanSet const&, afw::image::Image<T> const&,                    \
+                               ndarray::Array<T, 1, 1> const&)
+
+INSTANTIATE(float);
+INSTANTIATE(double);
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
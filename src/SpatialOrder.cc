@@ -0,0 +1,131 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include "boost/format.hpp"
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/geom/Box.h"
+#include "lsst/afw/detection/Footprint.h"
+#include "lsst/meas/base/SpatialOrder.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+namespace {
+
+void checkLevel(int level) {
+    if (level < 1 || level > 31) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("Hilbert curve level %d is not in [1, 31]") % level).str());
+    }
+}
+
+// hilbertIndex, without argument checks.
+std::uint64_t computeHilbertIndex(std::uint64_t x, std::uint64_t y, int level) {
+    std::uint64_t const n = std::uint64_t(1) << level;
+    std::uint64_t d = 0;
+    for (std::uint64_t s = n >> 1; s > 0; s >>= 1) {
+        std::uint64_t const rx = (x & s) ? 1 : 0;
+        std::uint64_t const ry = (y & s) ? 1 : 0;
+        d += s * s * ((3 * rx) ^ ry);
+        // Rotate the quadrant, so that the curve within it starts and ends next to its neighbors.
+        if (ry == 0) {
+            if (rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+}  // namespace
+
+std::uint64_t hilbertIndex(std::uint32_t x, std::uint32_t y, int level) {
+    checkLevel(level);
+    std::uint64_t const n = std::uint64_t(1) << level;
+    if (x >= n || y >= n) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("Cell (%d, %d) is not on a grid of %d x %d cells") % x % y % n % n)
+                                  .str());
+    }
+    return computeHilbertIndex(x, y, level);
+}
+
+std::vector<std::size_t> hilbertOrder(std::vector<geom::Point2D> const& points, int level) {
+    checkLevel(level);
+    geom::Box2D bbox;
+    for (auto const& point : points) {
+        if (std::isfinite(point.getX()) && std::isfinite(point.getY())) {
+            bbox.include(point);
+        }
+    }
+    std::vector<std::uint64_t> keys(points.size(), std::numeric_limits<std::uint64_t>::max());
+    if (!bbox.isEmpty()) {
+        double const cellMax = static_cast<double>((std::uint64_t(1) << level) - 1);
+        double const size = std::max(bbox.getWidth(), bbox.getHeight());
+        double const scale = size > 0.0 ? cellMax / size : 0.0;
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            geom::Point2D const& point = points[i];
+            if (std::isfinite(point.getX()) && std::isfinite(point.getY())) {
+                double const x = std::min(std::max((point.getX() - bbox.getMinX()) * scale, 0.0), cellMax);
+                double const y = std::min(std::max((point.getY() - bbox.getMinY()) * scale, 0.0), cellMax);
+                keys[i] = computeHilbertIndex(static_cast<std::uint64_t>(x), static_cast<std::uint64_t>(y),
+                                              level);
+            }
+        }
+    }
+    std::vector<std::size_t> order(points.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&keys](std::size_t a, std::size_t b) { return keys[a] < keys[b]; });
+    return order;
+}
+
+std::vector<std::size_t> hilbertOrder(afw::table::SourceCatalog const& catalog, int level) {
+    std::vector<geom::Point2D> points;
+    points.reserve(catalog.size());
+    for (auto const& record : catalog) {
+        auto const footprint = record.getFootprint();
+        if (footprint && footprint->getArea() > 0) {
+            points.push_back(geom::Box2D(footprint->getBBox()).getCenter());
+        } else if (record.getTable()->getCentroidSlot().isValid()) {
+            points.push_back(record.getCentroid());
+        } else {
+            points.push_back(geom::Point2D(std::numeric_limits<double>::quiet_NaN()));
+        }
+    }
+    return hilbertOrder(points, level);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -0,0 +1,234 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2019 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/meas/base/TiledPsf.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+namespace {
+
+// Number of nodes needed to span `length` pixels with a spacing of at most `cellSize`; at least two,
+// so there is always a cell to interpolate in.
+int computeNodeCount(int length, int cellSize) {
+    return std::max(2, (length - 1 + cellSize - 1) / cellSize + 1);
+}
+
+// Fractional node coordinate of a position along one axis, clamped to the grid.
+double computeNodeCoordinate(double position, double origin, double step, int nNodes) {
+    if (step <= 0.0) {
+        return 0.0;
+    }
+    return std::min(std::max((position - origin) / step, 0.0), nNodes - 1.0);
+}
+
+}  // namespace
+
+TiledPsf::TiledPsf(std::shared_ptr<afw::detection::Psf const> psf, geom::Box2I const &bbox, int cellSize,
+                   bool interpolate)
+        : afw::detection::Psf(false),
+          _psf(psf),
+          _bbox(bbox),
+          _cellSize(cellSize),
+          _interpolate(interpolate),
+          _nx(0),
+          _ny(0),
+          _stepX(0.0),
+          _stepY(0.0),
+          _evaluations(0) {
+    if (!_psf) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "TiledPsf requires a Psf to wrap");
+    }
+    if (_bbox.isEmpty()) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "TiledPsf bounding box must not be empty");
+    }
+    if (_cellSize <= 0) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "TiledPsf cell size must be positive");
+    }
+    _nx = computeNodeCount(_bbox.getWidth(), _cellSize);
+    _ny = computeNodeCount(_bbox.getHeight(), _cellSize);
+    _stepX = static_cast<double>(_bbox.getWidth() - 1) / (_nx - 1);
+    _stepY = static_cast<double>(_bbox.getHeight() - 1) / (_ny - 1);
+    _nodes.resize(_nx * _ny);
+}
+
+geom::Point2D TiledPsf::getNodePosition(int ix, int iy) const {
+    if (ix < 0 || ix >= _nx || iy < 0 || iy >= _ny) {
+        throw LSST_EXCEPT(pex::exceptions::OutOfRangeError, "TiledPsf node index out of range");
+    }
+    return geom::Point2D(_bbox.getMinX() + ix * _stepX, _bbox.getMinY() + iy * _stepY);
+}
+
+std::size_t TiledPsf::getEvaluationCount() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _evaluations;
+}
+
+std::shared_ptr<afw::detection::Psf> TiledPsf::clone() const {
+    return std::make_shared<TiledPsf>(_psf->clone(), _bbox, _cellSize, _interpolate);
+}
+
+std::shared_ptr<afw::detection::Psf> TiledPsf::resized(int width, int height) const {
+    return std::make_shared<TiledPsf>(_psf->resized(width, height), _bbox, _cellSize, _interpolate);
+}
+
+geom::Point2D TiledPsf::getAveragePosition() const { return _psf->getAveragePosition(); }
+
+TiledPsf::Stencil TiledPsf::_getStencil(geom::Point2D const &position, bool nearestOnly) const {
+    double const fx = computeNodeCoordinate(position.getX(), _bbox.getMinX(), _stepX, _nx);
+    double const fy = computeNodeCoordinate(position.getY(), _bbox.getMinY(), _stepY, _ny);
+    Stencil stencil;
+    if (nearestOnly) {
+        stencil.size = 1;
+        stencil.nodes[0] = static_cast<int>(std::lround(fy)) * _nx + static_cast<int>(std::lround(fx));
+        stencil.weights[0] = 1.0;
+        return stencil;
+    }
+    int const ix = std::min(static_cast<int>(fx), _nx - 2);
+    int const iy = std::min(static_cast<int>(fy), _ny - 2);
+    double const tx = fx - ix;
+    double const ty = fy - iy;
+    double const weights[4] = {(1.0 - tx) * (1.0 - ty), tx * (1.0 - ty), (1.0 - tx) * ty, tx * ty};
+    int const nodes[4] = {iy * _nx + ix, iy * _nx + ix + 1, (iy + 1) * _nx + ix, (iy + 1) * _nx + ix + 1};
+    stencil.size = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (weights[i] > 0.0) {
+            stencil.nodes[stencil.size] = nodes[i];
+            stencil.weights[stencil.size] = weights[i];
+            ++stencil.size;
+        }
+    }
+    return stencil;
+}
+
+std::shared_ptr<TiledPsf::Image> TiledPsf::_getKernelImage(int node) const {
+    Node &entry = _nodes[node];
+    if (!entry.kernelImage) {
+        ++_evaluations;
+        entry.kernelImage = _psf->computeKernelImage(_getNodePosition(node));
+    }
+    return entry.kernelImage;
+}
+
+std::shared_ptr<TiledPsf::Image> TiledPsf::doComputeKernelImage(geom::Point2D const &position,
+                                                                afw::image::Color const &color) const {
+    if (!color.isIndeterminate()) {
+        return _psf->computeKernelImage(position, color);
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    Stencil stencil = _getStencil(position, !_interpolate);
+    std::shared_ptr<Image> first = _getKernelImage(stencil.nodes[0]);
+    for (int i = 1; i < stencil.size; ++i) {
+        if (_getKernelImage(stencil.nodes[i])->getBBox() != first->getBBox()) {
+            // Kernel images of different sizes can't be interpolated pixel by pixel.
+            stencil = _getStencil(position, true);
+            return _getKernelImage(stencil.nodes[0]);
+        }
+    }
+    if (stencil.size == 1) {
+        return first;
+    }
+    auto result = std::make_shared<Image>(*first, true);
+    *result *= stencil.weights[0];
+    for (int i = 1; i < stencil.size; ++i) {
+        result->scaledPlus(stencil.weights[i], *_getKernelImage(stencil.nodes[i]));
+    }
+    return result;
+}
+
+std::shared_ptr<TiledPsf::Image> TiledPsf::doComputeImage(geom::Point2D const &position,
+                                                          afw::image::Color const &color) const {
+    if (!color.isIndeterminate()) {
+        return _psf->computeImage(position, color);
+    }
+    // recenterKernelImage modifies the image it is given, so it must not be a node's.
+    auto kernelImage = std::make_shared<Image>(*doComputeKernelImage(position, color), true);
+    return recenterKernelImage(kernelImage, position);
+}
+
+double TiledPsf::doComputeApertureFlux(double radius, geom::Point2D const &position,
+                                       afw::image::Color const &color) const {
+    if (!color.isIndeterminate()) {
+        return _psf->computeApertureFlux(radius, position, color);
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    Stencil const stencil = _getStencil(position, !_interpolate);
+    double flux = 0.0;
+    for (int i = 0; i < stencil.size; ++i) {
+        Node &entry = _nodes[stencil.nodes[i]];
+        auto iter = entry.apertureFlux.find(radius);
+        if (iter == entry.apertureFlux.end()) {
+            ++_evaluations;
+            double const nodeFlux = _psf->computeApertureFlux(radius, _getNodePosition(stencil.nodes[i]));
+            iter = entry.apertureFlux.emplace(radius, nodeFlux).first;
+        }
+        flux += stencil.weights[i] * iter->second;
+    }
+    return flux;
+}
+
+afw::geom::ellipses::Quadrupole TiledPsf::doComputeShape(geom::Point2D const &position,
+                                                         afw::image::Color const &color) const {
+    if (!color.isIndeterminate()) {
+        return _psf->computeShape(position, color);
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    Stencil const stencil = _getStencil(position, !_interpolate);
+    double ixx = 0.0, iyy = 0.0, ixy = 0.0;
+    for (int i = 0; i < stencil.size; ++i) {
+        Node &entry = _nodes[stencil.nodes[i]];
+        if (!entry.hasShape) {
+            ++_evaluations;
+            entry.shape = _psf->computeShape(_getNodePosition(stencil.nodes[i]));
+            entry.hasShape = true;
+        }
+        ixx += stencil.weights[i] * entry.shape.getIxx();
+        iyy += stencil.weights[i] * entry.shape.getIyy();
+        ixy += stencil.weights[i] * entry.shape.getIxy();
+    }
+    return afw::geom::ellipses::Quadrupole(ixx, iyy, ixy);
+}
+
+geom::Box2I TiledPsf::doComputeBBox(geom::Point2D const &position, afw::image::Color const &color) const {
+    if (!color.isIndeterminate()) {
+        return _psf->computeBBox(position, color);
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    int const node = _getStencil(position, true).nodes[0];
+    Node &entry = _nodes[node];
+    if (!entry.hasBBox) {
+        ++_evaluations;
+        entry.bbox = _psf->computeBBox(_getNodePosition(node));
+        entry.hasBBox = true;
+    }
+    return entry.bbox;
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -0,0 +1,204 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+#include "boost/format.hpp"
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/meas/base/TraceRecorder.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+namespace {
+
+std::atomic<int> nextThreadIndex(0);
+std::atomic<std::uint64_t> nextSerial(0);
+
+// The splitmix64 finalizer: a cheap bijection that spreads consecutive IDs uniformly over [0, 2^64).
+std::uint64_t mixId(std::uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Write a string as a JSON string literal.
+void writeJsonString(std::ostream& stream, std::string const& value) {
+    stream << '"';
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            stream << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+                   << std::dec << std::setfill(' ');
+        } else {
+            stream << c;
+        }
+    }
+    stream << '"';
+}
+
+}  // namespace
+
+TraceRecorder::TraceRecorder(double sampleFraction)
+        : _sampleFraction(sampleFraction), _serial(nextSerial++), _origin(std::chrono::steady_clock::now()) {
+    if (!(sampleFraction >= 0.0 && sampleFraction <= 1.0)) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("Trace sample fraction %f is not in [0, 1]") % sampleFraction)
+                                  .str());
+    }
+}
+
+TraceRecorder::~TraceRecorder() = default;
+
+bool TraceRecorder::isSampled(afw::table::RecordId familyId) const {
+    if (_sampleFraction >= 1.0) {
+        return true;
+    }
+    // Map the top 53 bits of the hash onto [0, 1).
+    return (mixId(familyId) >> 11) * (1.0 / 9007199254740992.0) < _sampleFraction;
+}
+
+void TraceRecorder::setFamilies(afw::table::SourceCatalog const& catalog) {
+    std::unordered_map<afw::table::RecordId, afw::table::RecordId> parents;
+    for (auto const& record : catalog) {
+        if (record.getParent() != 0) {
+            parents.emplace(record.getId(), record.getParent());
+        }
+    }
+    _families.clear();
+    for (auto const& item : parents) {
+        afw::table::RecordId top = item.second;
+        // A well-formed catalog has no cycles, but don't loop forever on one that does.
+        for (std::size_t depth = 0; depth < parents.size(); ++depth) {
+            auto const next = parents.find(top);
+            if (next == parents.end()) {
+                break;
+            }
+            top = next->second;
+        }
+        _families.emplace(item.first, top);
+    }
+}
+
+afw::table::RecordId TraceRecorder::getFamilyId(afw::table::SourceRecord const& record) const {
+    auto const family = _families.find(record.getId());
+    if (family != _families.end()) {
+        return family->second;
+    }
+    return record.getParent() != 0 ? record.getParent() : record.getId();
+}
+
+int TraceRecorder::getThreadIndex() {
+    thread_local int const index = nextThreadIndex++;
+    return index;
+}
+
+TraceRecorder::Buffer& TraceRecorder::_getBuffer() {
+    // Each thread remembers the buffer it was given by the last recorder it recorded into; the
+    // serial number is never reused, so a stale entry cannot match a later recorder.
+    thread_local std::uint64_t cachedSerial = std::numeric_limits<std::uint64_t>::max();
+    thread_local Buffer* cachedBuffer = nullptr;
+    if (cachedSerial != _serial) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _buffers.emplace_back(getThreadIndex(), std::make_unique<Buffer>());
+        cachedBuffer = _buffers.back().second.get();
+        cachedSerial = _serial;
+    }
+    return *cachedBuffer;
+}
+
+void TraceRecorder::record(std::string const& name, std::string const& category, std::int64_t start,
+                           std::int64_t end, afw::table::RecordId id) {
+    _getBuffer().push_back(Event{name, category, start, end - start, getThreadIndex(), id});
+}
+
+std::vector<TraceRecorder::Event> TraceRecorder::getEvents() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<Event> events;
+    std::vector<std::pair<int, Buffer const*>> buffers;
+    for (auto const& buffer : _buffers) {
+        buffers.emplace_back(buffer.first, buffer.second.get());
+    }
+    std::stable_sort(buffers.begin(), buffers.end(),
+                     [](std::pair<int, Buffer const*> const& a, std::pair<int, Buffer const*> const& b) {
+                         return a.first < b.first;
+                     });
+    for (auto const& buffer : buffers) {
+        events.insert(events.end(), buffer.second->begin(), buffer.second->end());
+    }
+    return events;
+}
+
+std::size_t TraceRecorder::size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::size_t n = 0;
+    for (auto const& buffer : _buffers) {
+        n += buffer.second->size();
+    }
+    return n;
+}
+
+void TraceRecorder::clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto const& buffer : _buffers) {
+        buffer.second->clear();
+    }
+}
+
+void TraceRecorder::writeChromeTrace(std::string const& filename) const {
+    std::ofstream stream(filename, std::ios::trunc);
+    if (!stream) {
+        throw LSST_EXCEPT(pex::exceptions::IoError,
+                          (boost::format("Unable to open %s for writing") % filename).str());
+    }
+    // Complete ("X") events, with times in microseconds as the format requires.
+    stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    stream << std::fixed << std::setprecision(3);
+    bool first = true;
+    for (Event const& event : getEvents()) {
+        stream << (first ? "\n" : ",\n") << "{\"name\":";
+        writeJsonString(stream, event.name);
+        stream << ",\"cat\":";
+        writeJsonString(stream, event.category);
+        stream << ",\"ph\":\"X\",\"ts\":" << 1E-3 * event.start << ",\"dur\":" << 1E-3 * event.duration
+               << ",\"pid\":0,\"tid\":" << event.thread << ",\"args\":{\"id\":" << event.id << "}}";
+        first = false;
+    }
+    stream << "\n]}\n";
+    if (!stream) {
+        throw LSST_EXCEPT(pex::exceptions::IoError,
+                          (boost::format("Error writing trace to %s") % filename).str());
+    }
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
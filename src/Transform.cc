@@ -0,0 +1,64 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2019 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#include "lsst/meas/base/Transform.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+ndarray::Array<double, 3, 3> computePixelToSkyJacobians(afw::geom::SkyWcs const& wcs,
+                                                        std::vector<geom::Point2D> const& pixels,
+                                                        std::vector<geom::SpherePoint>* coords) {
+    // As in SkyWcs::linearizePixelToSky, the derivatives are the tangent-plane offsets of the
+    // positions one pixel away in x and in y.
+    std::size_t const nPixels = pixels.size();
+    std::vector<geom::Point2D> allPixels;
+    allPixels.reserve(3 * nPixels);
+    allPixels.insert(allPixels.end(), pixels.begin(), pixels.end());
+    for (auto const& pixel : pixels) {
+        allPixels.push_back(pixel + geom::Extent2D(1.0, 0.0));
+    }
+    for (auto const& pixel : pixels) {
+        allPixels.push_back(pixel + geom::Extent2D(0.0, 1.0));
+    }
+    std::vector<geom::SpherePoint> const allCoords = wcs.pixelToSky(allPixels);
+
+    ndarray::Array<double, 3, 3> jacobians = ndarray::allocate(nPixels, 2, 2);
+    for (std::size_t i = 0; i < nPixels; ++i) {
+        auto const dsky10 = allCoords[i].getTangentPlaneOffset(allCoords[nPixels + i]);
+        auto const dsky01 = allCoords[i].getTangentPlaneOffset(allCoords[2 * nPixels + i]);
+        jacobians[i][0][0] = dsky10.first.asRadians();
+        jacobians[i][0][1] = dsky01.first.asRadians();
+        jacobians[i][1][0] = dsky10.second.asRadians();
+        jacobians[i][1][1] = dsky01.second.asRadians();
+    }
+    if (coords) {
+        coords->assign(allCoords.begin(), allCoords.begin() + nPixels);
+    }
+    return jacobians;
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
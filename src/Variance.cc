@@ -0,0 +1,150 @@
+// -*- lsst-c++ -*-
+/*
+ * LSST Data Management System
+ * Copyright 2008-2018 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <http://www.lsstcorp.org/LegalNotices/>.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "lsst/afw/table/Source.h"
+#include "lsst/afw/geom/ellipses/PixelRegion.h"
+#include "lsst/meas/base/ScratchArena.h"
+#include "lsst/meas/base/Variance.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+namespace {
+FlagDefinitionList flagDefinitions;
+
+// Median of the values, averaging the two middle values when there are an even number of them (as
+// numpy.median does); reorders the values, which must not be empty.
+double median(float* values, std::size_t n) {
+    std::size_t const half = n / 2;
+    std::nth_element(values, values + half, values + n);
+    double const upper = values[half];
+    if (n % 2 == 1) {
+        return upper;
+    }
+    // The lower middle value is the largest of those below half.
+    double const lower = *std::max_element(values, values + half);
+    return 0.5 * (lower + upper);
+}
+
+}  // namespace
+
+FlagDefinition const VarianceAlgorithm::FAILURE = flagDefinitions.addFailureFlag();
+FlagDefinition const VarianceAlgorithm::EMPTY_FOOTPRINT =
+        flagDefinitions.add("flag_emptyFootprint", "Set to True when the footprint has no usable pixels");
+
+FlagDefinitionList const& VarianceAlgorithm::getFlagDefinitions() { return flagDefinitions; }
+
+VarianceAlgorithm::VarianceAlgorithm(Control const& ctrl, std::string const& name,
+                                     afw::table::Schema& schema)
+        : _ctrl(ctrl),
+          _valueKey(schema.addField<double>(schema.join(name, "value"), "Variance at object position")),
+          _flagHandler(FlagHandler::addFields(schema, name, getFlagDefinitions())) {
+    // Alias the badCentroid flag to the target of the centroid slot's flag, rather than to the slot
+    // itself, so the alias still points to the right thing if the slot is changed after measurement.
+    schema.getAliasMap()->set(schema.join(name, "flag", "badCentroid"),
+                              schema.getAliasMap()->apply(schema.join("slot", "Centroid", "flag")));
+    _logName = name;
+}
+
+void VarianceAlgorithm::measure(afw::table::SourceRecord& measRecord,
+                                afw::image::Exposure<float> const& exposure) const {
+    afw::image::MaskPixel const badMask = exposure.getMaskedImage().getMask()->getPlaneBitMask(_ctrl.mask);
+    measRecord.set(_valueKey, _measure(measRecord, exposure, badMask));
+}
+
+void VarianceAlgorithm::measureBatch(afw::table::SourceCatalog& measCat,
+                                     afw::image::Exposure<float> const& exposure,
+                                     std::vector<std::size_t> const& indices) const {
+    afw::image::MaskPixel const badMask = exposure.getMaskedImage().getMask()->getPlaneBitMask(_ctrl.mask);
+    measureEach(measCat, indices, [this, &exposure, badMask](afw::table::SourceRecord& measRecord) {
+        measRecord.set(_valueKey, _measure(measRecord, exposure, badMask));
+        return MeasurementStatus();
+    });
+}
+
+double VarianceAlgorithm::_measure(afw::table::SourceRecord const& measRecord,
+                                   afw::image::Exposure<float> const& exposure,
+                                   afw::image::MaskPixel badMask) const {
+    geom::Point2D const center = measRecord.getCentroid();
+    afw::geom::ellipses::Quadrupole const shape = measRecord.getShape();
+    if (!std::isfinite(center.getX()) || !std::isfinite(center.getY()) || !std::isfinite(shape.getIxx()) ||
+        !std::isfinite(shape.getIyy()) || !std::isfinite(shape.getIxy())) {
+        throw LSST_EXCEPT(MeasurementError, "Bad centroid and/or shape", FAILURE.number);
+    }
+
+    // Create an aperture and grow it by the configured scale to ensure there are enough pixels around
+    // the object to get decent statistics.
+    afw::geom::ellipses::Ellipse aperture(shape, center);
+    aperture.getCore().scale(_ctrl.scale);
+    afw::geom::ellipses::PixelRegion const region(aperture);
+
+    // Collect the variance of the unmasked pixels in the aperture span by span, clipped to the image,
+    // into a scratch buffer from the thread's arena.
+    ScratchArena::Scope scratch;
+    float* const values = scratch.allocate<float>(region.getBBox().getArea());
+    std::size_t nValues = 0;
+    afw::image::MaskedImage<float> const& image = exposure.getMaskedImage();
+    geom::Box2I const bbox = image.getBBox();
+    auto const varianceArray = image.getVariance()->getArray();
+    auto const maskArray = image.getMask()->getArray();
+    bool hasNan = false;
+    for (auto const& span : region) {
+        int const y = span.getY();
+        if (y < bbox.getMinY() || y > bbox.getMaxY()) {
+            continue;
+        }
+        int const xBegin = std::max(span.getMinX(), bbox.getMinX()) - image.getX0();
+        int const xEnd = std::min(span.getMaxX(), bbox.getMaxX()) + 1 - image.getX0();
+        auto const varianceRow = varianceArray[y - image.getY0()];
+        auto const maskRow = maskArray[y - image.getY0()];
+        for (int x = xBegin; x < xEnd; ++x) {
+            if ((maskRow[x] & badMask) == 0) {
+                hasNan |= std::isnan(varianceRow[x]);
+                values[nValues++] = varianceRow[x];
+            }
+        }
+    }
+
+    if (nValues == 0) {
+        throw LSST_EXCEPT(MeasurementError,
+                          "Footprint empty, or all pixels are masked, can't compute median",
+                          EMPTY_FOOTPRINT.number);
+    }
+    // An unmasked NaN makes the median NaN, as it would with numpy.
+    return hasNan ? std::numeric_limits<double>::quiet_NaN() : median(values, nValues);
+}
+
+void VarianceAlgorithm::fail(afw::table::SourceRecord& measRecord, MeasurementError* error) const {
+    measRecord.set(_valueKey, std::numeric_limits<double>::quiet_NaN());
+    _flagHandler.handleFailure(measRecord, error);
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
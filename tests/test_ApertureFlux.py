@@ -26,8 +26,9 @@ import numpy as np
 import lsst.geom
 import lsst.afw.geom
 import lsst.afw.image
+import lsst.afw.math
 import lsst.utils.tests
-from lsst.meas.base import ApertureFluxAlgorithm
+from lsst.meas.base import ApertureFluxAlgorithm, SincCoeffsF
 from lsst.meas.base.tests import (AlgorithmTestCase, FluxTransformTestCase,
                                   SingleFramePluginTransformSetupHelper)
 
@@ -147,6 +148,155 @@ class ApertureFluxTestCase(lsst.utils.tests.TestCase):
         self.assertTrue(invalid2.getFlag(ApertureFluxAlgorithm.SINC_COEFFS_TRUNCATED.number))
         self.assertFalse(np.isnan(invalid2.instFlux))
 
+    def testExact(self):
+        positions = [lsst.geom.Point2D(60.0, -60.0),
+                     lsst.geom.Point2D(60.5, -60.0),
+                     lsst.geom.Point2D(60.3, -60.7)]
+        cores = [lsst.afw.geom.ellipses.Axes(12.0, 12.0, 0.0),
+                 lsst.afw.geom.ellipses.Axes(17.0, 11.0, 0.6)]
+        ctrl = ApertureFluxAlgorithm.Control()
+        ctrl.maxExactRadius = 20.0
+        for position in positions:
+            for core in cores:
+                ellipse = lsst.afw.geom.Ellipse(core, position)
+                area = core.getArea()
+
+                def check(method, image):
+                    # the overlap fractions of a uniform image sum to the area of the aperture
+                    result = method(image, ellipse, ctrl)
+                    self.assertFloatsAlmostEqual(result.instFlux, area, rtol=1E-10)
+                    self.assertFalse(result.getFlag(ApertureFluxAlgorithm.APERTURE_TRUNCATED.number))
+                    if hasattr(image, "getVariance"):
+                        # partial pixels contribute the squares of their weights
+                        self.assertLess(result.instFluxErr, (area*0.25)**0.5)
+                        perimeter = 2*np.pi*core.getTraceRadius()
+                        self.assertGreater(result.instFluxErr, ((area - perimeter)*0.25)**0.5)
+                    else:
+                        self.assertTrue(np.isnan(result.instFluxErr))
+                check(ApertureFluxAlgorithm.computeExactFlux, self.exposure.getMaskedImage())
+                check(ApertureFluxAlgorithm.computeExactFlux, self.exposure.getMaskedImage().getImage())
+                check(ApertureFluxAlgorithm.computeFlux, self.exposure.getMaskedImage())
+                check(ApertureFluxAlgorithm.computeFlux, self.exposure.getMaskedImage().getImage())
+        # test failure conditions when the aperture itself is truncated
+        invalid = ApertureFluxAlgorithm.computeExactFlux(
+            self.exposure.getMaskedImage().getImage(),
+            lsst.afw.geom.Ellipse(lsst.afw.geom.ellipses.Axes(12.0, 12.0),
+                                  lsst.geom.Point2D(25.0, -60.0)),
+            ctrl)
+        self.assertTrue(invalid.getFlag(ApertureFluxAlgorithm.APERTURE_TRUNCATED.number))
+        self.assertTrue(invalid.getFlag(ApertureFluxAlgorithm.FAILURE.number))
+        self.assertTrue(np.isnan(invalid.instFlux))
+
+    def testComputeFluxesExact(self):
+        """Test that exact-overlap apertures measured together match those
+        measured one at a time.
+        """
+        ctrl = ApertureFluxAlgorithm.Control()
+        ctrl.radii = [3.0, 12.0, 17.0, 25.0]
+        ctrl.maxExactRadius = 17.0
+        position = lsst.geom.Point2D(60.3, -60.6)
+        results = ApertureFluxAlgorithm.computeFluxes(self.exposure.getMaskedImage(), position, ctrl)
+        for radius, result in zip(ctrl.radii, results):
+            ellipse = lsst.afw.geom.Ellipse(lsst.afw.geom.ellipses.Axes(radius, radius, 0.0), position)
+            if radius > ctrl.maxSincRadius and radius <= ctrl.maxExactRadius:
+                expected = ApertureFluxAlgorithm.computeExactFlux(self.exposure.getMaskedImage(), ellipse)
+                self.assertFloatsAlmostEqual(result.instFlux, np.pi*radius**2, rtol=1E-10)
+            else:
+                expected = ApertureFluxAlgorithm.computeFlux(self.exposure.getMaskedImage(), ellipse, ctrl)
+            self.assertFloatsAlmostEqual(result.instFlux, expected.instFlux, rtol=1E-6)
+            self.assertFloatsAlmostEqual(result.instFluxErr, expected.instFluxErr, rtol=1E-6)
+
+    def testComputeFluxes(self):
+        """Test that measuring all radii at once matches measuring them one at a time.
+        """
+        ctrl = ApertureFluxAlgorithm.Control()
+        ctrl.radii = [12.0, 3.0, 17.0, 9.0, 7.0, 25.0, 50.0]
+        position = lsst.geom.Point2D(60.3, -60.6)
+        for image in (self.exposure.getMaskedImage(), self.exposure.getMaskedImage().getImage()):
+            results = ApertureFluxAlgorithm.computeFluxes(image, position, ctrl)
+            self.assertEqual(len(results), len(ctrl.radii))
+            for radius, result in zip(ctrl.radii, results):
+                ellipse = lsst.afw.geom.Ellipse(lsst.afw.geom.ellipses.Axes(radius, radius, 0.0), position)
+                expected = ApertureFluxAlgorithm.computeFlux(image, ellipse, ctrl)
+                for flag in (ApertureFluxAlgorithm.FAILURE, ApertureFluxAlgorithm.APERTURE_TRUNCATED,
+                             ApertureFluxAlgorithm.SINC_COEFFS_TRUNCATED):
+                    self.assertEqual(result.getFlag(flag.number), expected.getFlag(flag.number))
+                for value, expectedValue in ((result.instFlux, expected.instFlux),
+                                             (result.instFluxErr, expected.instFluxErr)):
+                    if np.isnan(expectedValue):
+                        self.assertTrue(np.isnan(value))
+                    else:
+                        self.assertFloatsAlmostEqual(value, expectedValue, rtol=1E-6)
+
+    def testComputeFluxesNaivePixels(self):
+        """Test that the naive apertures measured together include exactly
+        the pixels whose centers they contain, including pixels exactly on
+        their boundaries.
+        """
+        ctrl = ApertureFluxAlgorithm.Control()
+        ctrl.maxSincRadius = 0.0
+        ctrl.radii = [5.0, 13.0, 10.0, 30.0]
+        rng = np.random.RandomState(5)
+        image = self.exposure.getMaskedImage()
+        image.getImage().getArray()[:, :] = rng.uniform(-1.0, 10.0, size=image.getImage().getArray().shape)
+        image.getVariance().getArray()[:, :] = rng.uniform(0.5, 2.0,
+                                                           size=image.getVariance().getArray().shape)
+        x, y = np.meshgrid(np.arange(self.bbox.getBeginX(), self.bbox.getEndX()),
+                           np.arange(self.bbox.getBeginY(), self.bbox.getEndY()))
+        # An integer center puts pixels on the boundary of every aperture (e.g. at (3, 4) and (5, 12)).
+        position = lsst.geom.Point2D(60.0, -60.0)
+        results = ApertureFluxAlgorithm.computeFluxes(image, position, ctrl)
+        for radius, result in zip(ctrl.radii, results):
+            if radius == max(ctrl.radii):
+                continue  # the outermost aperture is bounded by its PixelRegion
+            mask = (x - position.getX())**2 + (y - position.getY())**2 <= radius**2
+            instFlux = image.getImage().getArray()[mask].astype(np.float64).sum()
+            instFluxVar = image.getVariance().getArray()[mask].astype(np.float64).sum()
+            self.assertFloatsAlmostEqual(result.instFlux, instFlux, rtol=1E-10)
+            self.assertFloatsAlmostEqual(result.instFluxErr, np.sqrt(instFluxVar), rtol=1E-10)
+
+    def computeSplitSincFlux(self, image, axes, position):
+        """Compute Sinc photometry with coefficients warped by the same
+        floor-plus-fraction split of the center that the shift bank uses.
+        """
+        ix = int(np.floor(position.getX()))
+        iy = int(np.floor(position.getY()))
+        coeffs = SincCoeffsF.get(axes, 0.0)
+        coeffs = lsst.afw.math.offsetImage(coeffs, position.getX() - ix, position.getY() - iy,
+                                           self.ctrl.shiftKernel)
+        coeffs.setXY0(coeffs.getXY0() + lsst.geom.Extent2I(ix, iy))
+        bbox = coeffs.getBBox()
+        bbox.clip(image.getBBox())
+        weights = coeffs[bbox].getArray().astype(np.float64)
+        instFlux = (image[bbox].getImage().getArray()*weights).sum()
+        instFluxVar = (image[bbox].getVariance().getArray()*weights**2).sum()
+        return instFlux, np.sqrt(instFluxVar)
+
+    def testSincShiftBank(self):
+        """Test that pre-shifted coefficients agree with per-source warping.
+        """
+        bankCtrl = ApertureFluxAlgorithm.Control()
+        bankCtrl.shiftBankSize = 4
+        image = self.exposure.getMaskedImage()
+        axes = lsst.afw.geom.ellipses.Axes(7.0, 7.0, 0.0)
+        # include negative coordinates with quarter- and half-pixel fractions, where truncating
+        # and flooring the center would split it into different integer and sub-pixel shifts
+        for position in [lsst.geom.Point2D(60.25, -60.75), lsst.geom.Point2D(59.5, -61.0),
+                         lsst.geom.Point2D(60.75, -60.5)]:
+            ellipse = lsst.afw.geom.Ellipse(axes, position)
+            banked = ApertureFluxAlgorithm.computeSincFlux(image, ellipse, bankCtrl)
+            # positions on the grid of shifts should reproduce the warped coefficients
+            instFlux, instFluxErr = self.computeSplitSincFlux(image, axes, position)
+            self.assertFloatsAlmostEqual(banked.instFlux, instFlux, rtol=1E-5)
+            self.assertFloatsAlmostEqual(banked.instFluxErr, instFluxErr, rtol=1E-5)
+            # and the result should not depend much on how the shift was split
+            exact = ApertureFluxAlgorithm.computeSincFlux(image, ellipse, self.ctrl)
+            self.assertFloatsAlmostEqual(banked.instFlux, exact.instFlux, rtol=1E-3)
+        # positions off the grid are rounded onto it
+        ellipse = lsst.afw.geom.Ellipse(axes, lsst.geom.Point2D(60.1, -60.3))
+        banked = ApertureFluxAlgorithm.computeSincFlux(image, ellipse, bankCtrl)
+        self.assertFloatsAlmostEqual(banked.instFlux, ellipse.getCore().getArea(), rtol=1E-3)
+
 
 class CircularApertureFluxTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase):
     """Test case for the CircularApertureFlux algorithm/plugin.
@@ -219,6 +369,21 @@ class CircularApertureFluxTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase)
                 self.assertFloatsAlmostEqual(record.get("base_CircularApertureFlux_25_0_instFlux"),
                                              record.get("truth_instFlux"), rtol=0.02)
 
+    def testMeasureBatch(self):
+        """Test that measureBatch gives the same results as measure.
+        """
+        baseName = "base_CircularApertureFlux"
+        self.dataset.addSource(50000.0, lsst.geom.Point2D(20.2, 80.7))
+        task = self.makeSingleFrameMeasurementTask(baseName)
+        algorithm = task.plugins[baseName].cpp
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+        batchCatalog = catalog.copy(deep=True)
+        for record in catalog:
+            algorithm.measure(record, exposure)
+        algorithm.measureBatch(batchCatalog, exposure, list(range(len(batchCatalog))))
+        for name in catalog.schema.extract(baseName + "_*"):
+            np.testing.assert_array_equal(batchCatalog[name], catalog[name], err_msg=name)
+
     def testForcedPlugin(self):
         baseName = "base_CircularApertureFlux"
         algMetadata = lsst.daf.base.PropertyList()
@@ -277,6 +442,13 @@ class ApertureFluxTransformTestCase(FluxTransformTestCase, SingleFramePluginTran
         FluxTransformTestCase.testTransform(self, [ApertureFluxAlgorithm.makeFieldPrefix(self.name, r)
                                                    for r in self.control.radii])
 
+    def testTransformNonContiguous(self):
+        """Test `ApertureFluxTransform` with a non-contiguous subset of a
+        synthetic catalog.
+        """
+        FluxTransformTestCase.testTransformNonContiguous(
+            self, [ApertureFluxAlgorithm.makeFieldPrefix(self.name, r) for r in self.control.radii])
+
 
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
@@ -190,6 +190,59 @@ class ApplyApCorrTestCase(lsst.meas.base.tests.AlgorithmTestCase, lsst.utils.tes
 
         self.assertAlmostEqual(sourceCat[instFluxErrKey], source_test_sigma)
 
+    def testChunked(self):
+        """Test aperture correcting many sources, in chunks, with a spatially
+        varying correction that is negative for some of them.
+        """
+        schema = afwTable.SourceTable.makeMinimalSchema()
+        schema.addField(self.name + "_instFlux", type=np.float64)
+        schema.addField(self.name + "_instFluxErr", type=np.float64)
+        schema.addField(self.name + "_flag", type="Flag")
+        schema.addField(self.name + "_Centroid_x", type=np.float64)
+        schema.addField(self.name + "_Centroid_y", type=np.float64)
+        schema.getAliasMap().set('slot_Centroid', self.name + '_Centroid')
+        task = applyApCorr.ApplyApCorrTask(schema=schema, config=applyApCorr.ApplyApCorrConfig(
+            chunkSize=7))
+
+        instFluxName = self.name + "_instFlux"
+        instFluxErrName = self.name + "_instFluxErr"
+        instFluxKey = schema.find(instFluxName).key
+        instFluxErrKey = schema.find(instFluxErrName).key
+        apCorrKey = schema.find(self.name + "_apCorr").key
+        flagKey = schema.find(self.name + "_flag_apCorr").key
+        centroidKey = afwTable.Point2DKey(schema["slot_Centroid"])
+        sourceCat = afwTable.SourceCatalog(schema)
+        rng = np.random.RandomState(3)
+        for x, y in rng.uniform(0.0, 10.0, size=(25, 2)):
+            source = sourceCat.addNew()
+            source.set(instFluxKey, 10.0)
+            source.set(instFluxErrKey, 0.5)
+            source.set(centroidKey, lsst.geom.Point2D(x, y))
+
+        apCorrMap = afwImage.ApCorrMap()
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.ExtentI(10, 10))
+        # Correction of 0.5 + 0.7*(x - 5)/5: negative for x < ~1.4
+        coefficients = np.array([[0.5, 0.7]], dtype=np.float64)
+        apCorrModel = ChebyshevBoundedField(bbox, coefficients)
+        apCorrMap[instFluxName] = apCorrModel
+        apCorrMap[instFluxErrName] = ChebyshevBoundedField(bbox, np.zeros((1, 1), dtype=np.float64))
+        task.run(sourceCat, apCorrMap)
+
+        nFlagged = 0
+        for source in sourceCat:
+            apCorr = apCorrModel.evaluate(source.getCentroid())
+            self.assertFloatsAlmostEqual(source.get(apCorrKey), apCorr, rtol=1E-14)
+            if apCorr > 0.0:
+                self.assertFalse(source.get(flagKey))
+                self.assertFloatsAlmostEqual(source.get(instFluxKey), 10.0*apCorr, rtol=1E-14)
+                self.assertFloatsAlmostEqual(source.get(instFluxErrKey), 0.5*apCorr, rtol=1E-14)
+            else:
+                nFlagged += 1
+                self.assertTrue(source.get(flagKey))
+                self.assertEqual(source.get(instFluxKey), 10.0)
+                self.assertEqual(source.get(instFluxErrKey), 0.5)
+        self.assertGreater(nFlagged, 0)
+
 
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
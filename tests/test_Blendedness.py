@@ -22,7 +22,10 @@
 from contextlib import contextmanager
 import unittest
 
+import numpy as np
+
 import lsst.geom
+import lsst.afw.detection
 import lsst.daf.base
 import lsst.meas.base
 import lsst.utils.tests
@@ -91,6 +94,39 @@ class BlendednessTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase):
         self.assertGreater(catalog[1].get('base_Blendedness_abs'), 0)
         self.assertGreater(catalog[2].get('base_Blendedness_abs'), 0)
 
+    def testOldIsolatedChild(self):
+        """Test that the old blendedness is exactly zero for a child with no
+        siblings, whose pixels are those of its parent.
+        """
+        schema = lsst.meas.base.tests.TestDataset.makeMinimalSchema()
+        algorithm = lsst.meas.base.BlendednessAlgorithm(lsst.meas.base.BlendednessControl(),
+                                                        "base_Blendedness", schema)
+        exposure, catalog = self.dataset.realize(10.0, schema, randomSeed=0)
+        child = catalog[1]
+        child.setFootprint(lsst.afw.detection.makeHeavyFootprint(child.getFootprint(),
+                                                                 exposure.getMaskedImage()))
+        algorithm.measureParentPixels(exposure.getMaskedImage(), child)
+        self.assertEqual(child.get("base_Blendedness_old"), 0.0)
+
+    def testFused(self):
+        """Test that capturing the child pixels and measuring child and parent
+        moments together does not change the results.
+        """
+        catalogs = []
+        for doFuseBlendedness in (False, True):
+            config = self.makeSingleFrameMeasurementConfig("base_Blendedness")
+            config.doFuseBlendedness = doFuseBlendedness
+            task = self.makeSingleFrameMeasurementTask(config=config)
+            exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+            task.run(catalog, exposure)
+            catalogs.append(catalog)
+        schema = catalogs[0].getSchema()
+        names = [name for name in schema.getNames() if name.startswith("base_Blendedness_")]
+        self.assertGreater(len(names), 0)
+        for name in names:
+            with self.subTest(name=name):
+                np.testing.assert_array_equal(catalogs[0][name], catalogs[1][name])
+
 
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
@@ -0,0 +1,104 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+import unittest
+
+import lsst.geom
+import lsst.afw.detection
+import lsst.pex.exceptions
+import lsst.meas.base
+import lsst.meas.base.tests
+import lsst.utils.tests
+
+
+class CachingPsfTestCase(lsst.meas.base.tests.AlgorithmTestCase, lsst.utils.tests.TestCase):
+
+    def setUp(self):
+        self.psf = lsst.afw.detection.GaussianPsf(21, 21, 2.0)
+        self.position = lsst.geom.Point2D(50.1, 49.8)
+
+    def tearDown(self):
+        del self.psf
+
+    def testPassThrough(self):
+        """Test that the cached products are identical to those of the wrapped Psf."""
+        cached = lsst.meas.base.CachingPsf(self.psf)
+        self.assertEqual(cached.getCapacity(), 8)
+        for i in range(2):
+            shape = cached.computeShape(self.position)
+            self.assertEqual(shape, self.psf.computeShape(self.position))
+            self.assertEqual(cached.computeBBox(self.position), self.psf.computeBBox(self.position))
+            self.assertEqual(cached.computeApertureFlux(3.0, self.position),
+                             self.psf.computeApertureFlux(3.0, self.position))
+            self.assertImagesEqual(cached.computeImage(self.position), self.psf.computeImage(self.position))
+            self.assertImagesEqual(cached.computeKernelImage(self.position),
+                                   self.psf.computeKernelImage(self.position))
+        self.assertEqual(cached.getMissCount(), 3)
+        self.assertEqual(cached.getHitCount(), 3)
+
+    def testEviction(self):
+        """Test that only the most recent positions are retained."""
+        cached = lsst.meas.base.CachingPsf(self.psf, 2)
+        positions = [lsst.geom.Point2D(10.0*i, 5.0) for i in range(3)]
+        for position in positions:
+            cached.computeShape(position)
+        self.assertEqual(cached.getMissCount(), 3)
+        cached.computeShape(positions[2])
+        cached.computeShape(positions[1])
+        self.assertEqual(cached.getHitCount(), 2)
+        cached.computeShape(positions[0])
+        self.assertEqual(cached.getMissCount(), 4)
+        cached.clearCache()
+        cached.computeShape(positions[0])
+        self.assertEqual(cached.getMissCount(), 5)
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            lsst.meas.base.CachingPsf(self.psf, 0)
+
+    def testMeasurementTask(self):
+        """Test that the measurement framework restores the original Psf and gets the same results."""
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(100, 100))
+        dataset = lsst.meas.base.tests.TestDataset(bbox)
+        dataset.addSource(100000.0, self.position)
+        results = []
+        for doCachePsf in (False, True):
+            config = self.makeSingleFrameMeasurementConfig("base_PsfFlux", dependencies=("base_SdssShape",))
+            config.doCachePsf = doCachePsf
+            task = self.makeSingleFrameMeasurementTask(config=config)
+            exposure, catalog = dataset.realize(10.0, task.schema, randomSeed=0)
+            psf = exposure.getPsf()
+            task.run(catalog, exposure)
+            self.assertNotIsInstance(exposure.getPsf(), lsst.meas.base.CachingPsf)
+            self.assertEqual(exposure.getPsf().computeShape(), psf.computeShape())
+            results.append((catalog[0].get("base_PsfFlux_instFlux"), catalog[0].get("base_SdssShape_psf_xx")))
+        self.assertEqual(results[0], results[1])
+
+
+class TestMemory(lsst.utils.tests.MemoryTestCase):
+    pass
+
+
+def setup_module(module):
+    lsst.utils.tests.init()
+
+
+if __name__ == "__main__":
+    lsst.utils.tests.init()
+    unittest.main()
@@ -24,6 +24,7 @@ import unittest
 import lsst.utils.tests
 import lsst.geom
 import lsst.afw.geom
+import lsst.afw.table
 import lsst.meas.base.tests
 import lsst.meas.base as measBase
 import lsst.meas.base.catalogCalculation as catCalc
@@ -125,6 +126,45 @@ class ClassificationTestCase(lsst.meas.base.tests.AlgorithmTestCase, lsst.utils.
         abConfig.plugins["base_ClassificationExtendedness"].psfErrFactor = 1.
         self.assertTrue(runFlagTest(psfFluxErr=float("NaN")))
 
+    def testColumns(self):
+        """Test that classifying whole columns gives the per-record results
+        for every failure mode.
+        """
+        config = measBase.SingleFrameMeasurementConfig()
+        config.slots.psfFlux = "base_PsfFlux"
+        config.slots.modelFlux = "base_GaussianFlux"
+        abConfig = catCalc.CatalogCalculationConfig()
+        abConfig.plugins["base_ClassificationExtendedness"].modelErrFactor = 1.
+        task = self.makeSingleFrameMeasurementTask(config=config)
+        abTask = catCalc.CatalogCalculationTask(schema=task.schema, config=abConfig)
+        plugin = abTask.plugins["base_ClassificationExtendedness"]
+        exposure, template = self.dataset.realize(10.0, task.schema, randomSeed=1)
+        nan = float("NaN")
+        cases = [(100.0, 200.0, 1.0, False, False), (300.0, 200.0, 1.0, False, False),
+                 (100.0, 200.0, 1.0, True, False), (100.0, 200.0, 1.0, False, True),
+                 (nan, 200.0, 1.0, False, False), (100.0, 200.0, nan, False, False)]
+        columnar = lsst.afw.table.SourceCatalog(task.schema)
+        perRecord = lsst.afw.table.SourceCatalog(task.schema)
+        for psfFlux, modelFlux, modelFluxErr, psfFluxFlag, modelFluxFlag in cases:
+            for catalog in (columnar, perRecord):
+                source = catalog.addNew()
+                source.assign(template[0])
+                source.set("base_PsfFlux_instFlux", psfFlux)
+                source.set("base_PsfFlux_flag", psfFluxFlag)
+                source.set("base_GaussianFlux_instFlux", modelFlux)
+                source.set("base_GaussianFlux_instFluxErr", modelFluxErr)
+                source.set("base_GaussianFlux_flag", modelFluxFlag)
+        self.assertTrue(columnar.isContiguous())
+        plugin.calculateColumns(columnar)
+        for source in perRecord:
+            plugin.calculate(source)
+        self.assertFloatsEqual(columnar["base_ClassificationExtendedness_value"],
+                               perRecord["base_ClassificationExtendedness_value"], ignoreNaNs=True)
+        self.assertEqual(list(columnar["base_ClassificationExtendedness_flag"]),
+                         list(perRecord["base_ClassificationExtendedness_flag"]))
+        self.assertEqual(list(columnar["base_ClassificationExtendedness_flag"]),
+                         [False, False, True, True, True, True])
+
 
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
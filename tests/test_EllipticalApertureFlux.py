@@ -0,0 +1,188 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+import unittest
+import math
+
+import numpy as np
+
+import lsst.geom
+import lsst.afw.geom
+import lsst.afw.image
+import lsst.afw.table
+import lsst.meas.base
+from lsst.meas.base.tests import (AlgorithmTestCase, FluxTransformTestCase,
+                                  SingleFramePluginTransformSetupHelper)
+import lsst.utils.tests
+
+
+class EllipticalApertureFluxTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase):
+
+    def setUp(self):
+        self.center = lsst.geom.Point2D(50.1, 49.8)
+        self.shape = lsst.afw.geom.Quadrupole(12.0, 6.0, 3.0)
+        self.bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0),
+                                    lsst.geom.Extent2I(100, 100))
+        self.dataset = lsst.meas.base.tests.TestDataset(self.bbox)
+        self.sourceFlux = 100000.0
+        self.dataset.addSource(self.sourceFlux, self.center, self.shape)
+
+    def tearDown(self):
+        del self.center
+        del self.shape
+        del self.bbox
+        del self.dataset
+
+    def makeAlgorithm(self, ctrl=None):
+        """Construct an algorithm and return both it and its schema.
+        """
+        if ctrl is None:
+            ctrl = lsst.meas.base.EllipticalApertureFluxControl()
+        schema = lsst.meas.base.tests.TestDataset.makeMinimalSchema()
+        algorithm = lsst.meas.base.EllipticalApertureFluxAlgorithm(ctrl, "base_EllipticalApertureFlux",
+                                                                   schema)
+        return algorithm, schema
+
+    def testScaledFluxes(self):
+        """Test that computeScaledFluxes matches computeFlux on each aperture.
+        """
+        schema = lsst.meas.base.tests.TestDataset.makeMinimalSchema()
+        exposure, catalog = self.dataset.realize(10.0, schema, randomSeed=0)
+        ctrl = lsst.meas.base.ApertureFluxControl()
+        ctrl.maxSincRadius = 5.0
+        axes = lsst.afw.geom.ellipses.Axes(catalog[0].getShape())
+        ellipse = lsst.afw.geom.ellipses.Ellipse(axes, catalog[0].getCentroid())
+        # The first two scales are measured with sinc photometry, the others naively.
+        scales = [2.0, 1.0, 4.0, 3.0]
+        results = lsst.meas.base.ApertureFluxAlgorithm.computeScaledFluxes(exposure.getMaskedImage(),
+                                                                           ellipse, scales, ctrl)
+        self.assertEqual(len(results), len(scales))
+        for scale, result in zip(scales, results):
+            aperture = lsst.afw.geom.ellipses.Ellipse(
+                lsst.afw.geom.ellipses.Axes(axes.getA()*scale, axes.getB()*scale, axes.getTheta()),
+                ellipse.getCenter())
+            expected = lsst.meas.base.ApertureFluxAlgorithm.computeFlux(exposure.getMaskedImage(),
+                                                                         aperture, ctrl)
+            self.assertFloatsAlmostEqual(result.instFlux, expected.instFlux, rtol=1E-5)
+            self.assertFloatsAlmostEqual(result.instFluxErr, expected.instFluxErr, rtol=1E-5)
+
+    def testShapeApertures(self):
+        """Test the fraction of a Gaussian's instFlux within multiples of its
+        ellipse.
+        """
+        ctrl = lsst.meas.base.EllipticalApertureFluxControl()
+        ctrl.scales = [1.0, 2.0, 3.0]
+        algorithm, schema = self.makeAlgorithm(ctrl)
+        exposure, catalog = self.dataset.realize(10.0, schema, randomSeed=1)
+        algorithm.measure(catalog[0], exposure)
+        for scale in ctrl.scales:
+            prefix = lsst.meas.base.ApertureFluxAlgorithm.makeFieldPrefix("base_EllipticalApertureFlux",
+                                                                          scale)
+            self.assertAlmostEqual(catalog[0].get(prefix + "_instFlux")/self.sourceFlux,
+                                   1.0 - math.exp(-0.5*scale**2), delta=0.01)
+            self.assertFalse(catalog[0].get(prefix + "_flag"))
+        self.assertFalse(catalog[0].get("base_EllipticalApertureFlux_flag"))
+
+    def testKronRadius(self):
+        """Test that the Kron radius of a Gaussian is sqrt(pi/2) times its
+        ellipse.
+        """
+        ctrl = lsst.meas.base.EllipticalApertureFluxControl()
+        ctrl.useKronRadius = True
+        ctrl.scales = [2.5]
+        algorithm, schema = self.makeAlgorithm(ctrl)
+        exposure, catalog = self.dataset.realize(10.0, schema, randomSeed=2)
+        algorithm.measure(catalog[0], exposure)
+        kronScale = math.sqrt(math.pi/2)
+        self.assertFloatsAlmostEqual(catalog[0].get("base_EllipticalApertureFlux_kronRadius"),
+                                     kronScale*catalog[0].getShape().getDeterminantRadius(), rtol=0.02)
+        self.assertAlmostEqual(catalog[0].get("base_EllipticalApertureFlux_2_5_instFlux")/self.sourceFlux,
+                               1.0 - math.exp(-0.5*(2.5*kronScale)**2), delta=0.01)
+
+        # A source with no positive instFlux has no Kron radius.
+        exposure.getMaskedImage().getImage().getArray()[:, :] = -np.abs(
+            exposure.getMaskedImage().getImage().getArray())
+        with self.assertRaises(lsst.meas.base.MeasurementError) as context:
+            algorithm.measure(catalog[0], exposure)
+        algorithm.fail(catalog[0], context.exception.cpp)
+        self.assertTrue(catalog[0].get("base_EllipticalApertureFlux_flag"))
+        self.assertTrue(catalog[0].get("base_EllipticalApertureFlux_flag_badKronRadius"))
+        self.assertTrue(catalog[0].get("base_EllipticalApertureFlux_2_5_flag"))
+
+    def testPlugin(self):
+        """Test the plugin in a measurement task, and its transform.
+        """
+        task = self.makeSingleFrameMeasurementTask("base_EllipticalApertureFlux")
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=3)
+        task.run(catalog, exposure)
+        self.assertFalse(catalog[0].get("base_EllipticalApertureFlux_flag"))
+        self.assertNotIn("base_EllipticalApertureFlux_kronRadius", catalog.schema.getNames())
+        mapper = lsst.afw.table.SchemaMapper(catalog.schema)
+        ctrl = lsst.meas.base.EllipticalApertureFluxControl()
+        transform = lsst.meas.base.EllipticalApertureFluxTransform(ctrl, "base_EllipticalApertureFlux",
+                                                                   mapper)
+        outCat = lsst.afw.table.BaseCatalog(mapper.getOutputSchema())
+        outCat.extend(catalog, mapper=mapper)
+        photoCalib = lsst.afw.image.PhotoCalib(1.0)
+        transform(catalog, outCat, exposure.getWcs(), photoCalib)
+        for scale in ctrl.scales:
+            prefix = lsst.meas.base.ApertureFluxAlgorithm.makeFieldPrefix("base_EllipticalApertureFlux",
+                                                                          scale)
+            self.assertFloatsAlmostEqual(outCat[0].get(prefix + "_mag"),
+                                         photoCalib.instFluxToMagnitude(catalog[0].get(prefix + "_instFlux")))
+            self.assertEqual(outCat[0].get(prefix + "_flag"), catalog[0].get(prefix + "_flag"))
+
+
+class EllipticalApertureFluxTransformTestCase(FluxTransformTestCase, SingleFramePluginTransformSetupHelper,
+                                              lsst.utils.tests.TestCase):
+    controlClass = lsst.meas.base.EllipticalApertureFluxControl
+    algorithmClass = lsst.meas.base.EllipticalApertureFluxAlgorithm
+    transformClass = lsst.meas.base.EllipticalApertureFluxTransform
+    flagNames = ('flag', 'flag_apertureTruncated', 'flag_sincCoeffsTruncated')
+    singleFramePlugins = ('base_EllipticalApertureFlux',)
+
+    def _getBaseNames(self):
+        return [lsst.meas.base.ApertureFluxAlgorithm.makeFieldPrefix(self.name, scale)
+                for scale in self.control.scales]
+
+    def testTransform(self):
+        """Test `EllipticalApertureFluxTransform` with a synthetic catalog.
+        """
+        FluxTransformTestCase.testTransform(self, self._getBaseNames())
+
+    def testTransformNonContiguous(self):
+        """Test `EllipticalApertureFluxTransform` with a non-contiguous subset
+        of a synthetic catalog.
+        """
+        FluxTransformTestCase.testTransformNonContiguous(self, self._getBaseNames())
+
+
+class TestMemory(lsst.utils.tests.MemoryTestCase):
+    pass
+
+
+def setup_module(module):
+    lsst.utils.tests.init()
+
+
+if __name__ == "__main__":
+    lsst.utils.tests.init()
+    unittest.main()
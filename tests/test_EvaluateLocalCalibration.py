@@ -95,6 +95,50 @@ class TestLocalWcs(lsst.meas.base.tests.AlgorithmTestCase,
                             * record.get("base_LocalWcs_CDMatrix_1_2"))))
 
 
+class TestBatch(lsst.meas.base.tests.AlgorithmTestCase,
+                lsst.utils.tests.TestCase):
+
+    def setUp(self):
+        self.bbox = lsst.geom.Box2I(lsst.geom.Point2I(-20, -30),
+                                    lsst.geom.Extent2I(140, 160))
+        self.dataset = lsst.meas.base.tests.TestDataset(self.bbox)
+        for x, y in ((50.1, 49.8), (12.0, 15.6), (13.4, 100.0), (-10.5, 120.2)):
+            self.dataset.addSource(100000.0, lsst.geom.Point2D(x, y))
+
+    def tearDown(self):
+        del self.bbox
+        del self.dataset
+
+    def testBatch(self):
+        """Test that measuring all sources at once gives the same results
+        as measuring them one at a time.
+        """
+        config = self.makeSingleFrameMeasurementConfig("base_LocalWcs")
+        config.plugins.names |= ["base_LocalPhotoCalib", "base_Jacobian"]
+        catalogs = []
+        for doReplaceWithNoise in (True, False):
+            config.doReplaceWithNoise = doReplaceWithNoise
+            task = self.makeSingleFrameMeasurementTask(config=config)
+            exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+            task.run(catalog, exposure)
+            catalogs.append(catalog)
+        for name in ("base_LocalWcs_CDMatrix_1_1", "base_LocalWcs_CDMatrix_1_2",
+                     "base_LocalWcs_CDMatrix_2_1", "base_LocalWcs_CDMatrix_2_2",
+                     "base_LocalPhotoCalib", "base_LocalPhotoCalibErr", "base_Jacobian_value"):
+            np.testing.assert_array_equal(catalogs[0][name], catalogs[1][name])
+
+        # The local matrices agree with a finite-difference linearization of
+        # the WCS.
+        wcs = exposure.getWcs()
+        for record in catalogs[1]:
+            linear = wcs.linearizePixelToSky(record.getCentroid(), lsst.geom.radians).getLinear()
+            matrix = np.array([[record.get("base_LocalWcs_CDMatrix_1_1"),
+                                record.get("base_LocalWcs_CDMatrix_1_2")],
+                               [record.get("base_LocalWcs_CDMatrix_2_1"),
+                                record.get("base_LocalWcs_CDMatrix_2_2")]])
+            self.assertFloatsAlmostEqual(matrix, linear.getMatrix(), rtol=1E-6, atol=1E-12)
+
+
 class MemoryTester(lsst.utils.tests.MemoryTestCase):
     pass
 
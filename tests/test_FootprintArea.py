@@ -22,6 +22,7 @@
 import unittest
 
 import lsst.geom
+import lsst.afw.table
 import lsst.meas.base.tests
 import lsst.utils.tests
 
@@ -53,6 +54,34 @@ class FootprintAreaTestCase(lsst.meas.base.tests.AlgorithmTestCase,
         self.assertEqual(record.getFootprint().getArea(),
                          record.get("base_FootprintArea_value"))
 
+    def testColumns(self):
+        """Test that contiguous and non-contiguous catalogs give the same
+        areas, and that records without Footprints get zero.
+        """
+        self.dataset.addSource(50000.0, lsst.geom.Point2D(90.3, 100.2))
+        schema = self.dataset.makeMinimalSchema()
+        config = lsst.meas.base.CatalogCalculationTask.ConfigClass()
+        config.plugins.names = set(["base_FootprintArea"])
+        task = lsst.meas.base.CatalogCalculationTask(config=config, schema=schema)
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+        catalog[1].setFootprint(None)
+        self.assertTrue(catalog.isContiguous())
+        task.run(catalog)
+        self.assertEqual(list(catalog["base_FootprintArea_value"]),
+                         [catalog[0].getFootprint().getArea(), 0])
+        self.assertEqual(list(lsst.meas.base.extractFootprintAreas(catalog)),
+                         list(catalog["base_FootprintArea_value"]))
+        # Records out of table order make the catalog non-contiguous, so the
+        # plugin runs record by record.
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+        backwards = lsst.afw.table.SourceCatalog(catalog.table)
+        for record in catalog[::-1]:
+            backwards.append(record)
+        self.assertFalse(backwards.isContiguous())
+        task.run(backwards)
+        self.assertEqual([record.get("base_FootprintArea_value") for record in backwards],
+                         [record.getFootprint().getArea() for record in backwards])
+
 
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
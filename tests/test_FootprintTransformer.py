@@ -0,0 +1,120 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+import unittest
+
+import lsst.pex.exceptions
+import lsst.geom
+import lsst.afw.image
+import lsst.utils.tests
+import lsst.meas.base.tests
+from lsst.meas.base import FootprintTransformer
+
+
+class FootprintTransformerTestCase(lsst.meas.base.tests.AlgorithmTestCase, lsst.utils.tests.TestCase):
+
+    def setUp(self):
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(200, 200))
+        self.dataset = lsst.meas.base.tests.TestDataset(bbox)
+        self.dataset.addSource(100000.0, lsst.geom.Point2D(50.2, 40.7))
+        self.dataset.addSource(80000.0, lsst.geom.Point2D(150.6, 160.1))
+        with self.dataset.addBlend() as family:
+            family.addChild(70000.0, lsst.geom.Point2D(100.3, 90.8))
+            family.addChild(60000.0, lsst.geom.Point2D(108.1, 95.2))
+        self.refCat = self.dataset.catalog
+        self.refWcs = self.dataset.exposure.getWcs()
+        self.exposureWcs = self.dataset.makePerturbedWcs(self.refWcs, randomSeed=5)
+        self.region = lsst.geom.Box2I(lsst.geom.Point2I(-20, -10), lsst.geom.Extent2I(180, 190))
+
+    def tearDown(self):
+        del self.dataset
+        del self.refCat
+
+    def testExact(self):
+        """Test that with no tiles the results are those of
+        Footprint.transform.
+        """
+        transformer = FootprintTransformer(self.refWcs, self.exposureWcs, self.region)
+        footprints = transformer.transformFootprints(self.refCat)
+        self.assertEqual(len(footprints), len(self.refCat))
+        for footprint, refRecord in zip(footprints, self.refCat):
+            expected = refRecord.getFootprint().transform(self.refWcs, self.exposureWcs, self.region)
+            self.assertEqual(footprint.getSpans(), expected.getSpans())
+            self.assertEqual([(p.getFx(), p.getFy()) for p in footprint.getPeaks()],
+                             [(p.getFx(), p.getFy()) for p in expected.getPeaks()])
+        self.assertEqual(transformer.getApproximatedCount(), 0)
+        for spans, footprint in zip(transformer.transformSpans(self.refCat), footprints):
+            self.assertEqual(spans, footprint.getSpans())
+
+    def testApproximate(self):
+        """Test that the affine approximation is used where it is accurate,
+        and changes the footprints by at most a few boundary pixels.
+        """
+        transformer = FootprintTransformer(self.refWcs, self.exposureWcs, self.region,
+                                           tileSize=64, maxError=0.05)
+        footprints = transformer.transformFootprints(self.refCat)
+        self.assertEqual(transformer.getApproximatedCount(), len(self.refCat))
+        for footprint, refRecord in zip(footprints, self.refCat):
+            expected = refRecord.getFootprint().transform(self.refWcs, self.exposureWcs, self.region)
+            self.assertTrue(self.region.contains(footprint.getBBox()))
+            difference = (footprint.getSpans().getArea() + expected.getSpans().getArea()
+                          - 2*footprint.getSpans().intersect(expected.getSpans()).getArea())
+            self.assertLessEqual(difference, 0.02*expected.getSpans().getArea())
+            # Peaks are always transformed exactly.
+            self.assertEqual([(p.getFx(), p.getFy()) for p in footprint.getPeaks()],
+                             [(p.getFx(), p.getFy()) for p in expected.getPeaks()])
+
+        # An error bound no approximation can meet falls back to the exact mapping.
+        transformer = FootprintTransformer(self.refWcs, self.exposureWcs, self.region,
+                                           tileSize=64, maxError=0.0)
+        for footprint, refRecord in zip(transformer.transformFootprints(self.refCat), self.refCat):
+            expected = refRecord.getFootprint().transform(self.refWcs, self.exposureWcs, self.region)
+            self.assertEqual(footprint.getSpans(), expected.getSpans())
+
+    def testAttachTransformedFootprints(self):
+        exposure = self.dataset.realize(10.0, self.dataset.makeMinimalSchema(), randomSeed=1)[0]
+        for tileSize in (0, 64):
+            config = self.makeForcedMeasurementConfig("base_PsfFlux")
+            config.footprintTransformTileSize = tileSize
+            task = self.makeForcedMeasurementTask(config=config)
+            measCat = task.generateMeasCat(exposure, self.refCat, self.refWcs)
+            task.attachTransformedFootprints(measCat, self.refCat, exposure, self.refWcs)
+            for measRecord, refRecord in zip(measCat, self.refCat):
+                expected = refRecord.getFootprint().transform(self.refWcs, exposure.getWcs(),
+                                                              exposure.getBBox(lsst.afw.image.PARENT))
+                self.assertFloatsAlmostEqual(measRecord.getFootprint().getArea(), expected.getArea(),
+                                             rtol=0.02)
+        transformer = FootprintTransformer(self.refWcs, exposure.getWcs(), exposure.getBBox())
+        with self.assertRaises(lsst.pex.exceptions.LengthError):
+            transformer.attachFootprints(measCat[:1], self.refCat)
+
+
+class TestMemory(lsst.utils.tests.MemoryTestCase):
+    pass
+
+
+def setup_module(module):
+    lsst.utils.tests.init()
+
+
+if __name__ == "__main__":
+    lsst.utils.tests.init()
+    unittest.main()
@@ -0,0 +1,208 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+import threading
+import unittest
+
+import numpy as np
+
+import lsst.geom
+import lsst.afw.geom
+import lsst.pipe.base
+import lsst.utils.tests
+import lsst.meas.base.tests
+from lsst.meas.base.forcedPhotCoadd import ForcedPhotCoaddRunner, ForcedPhotCoaddTask
+from lsst.meas.base.forcedPhotImage import ForcedPhotImageTask
+
+
+class ForcedPhotCoaddMultiBandTestCase(lsst.meas.base.tests.AlgorithmTestCase, lsst.utils.tests.TestCase):
+    """Test forced measurement of several bands of a patch at once.
+    """
+
+    def setUp(self):
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(200, 100))
+        self.dataset = lsst.meas.base.tests.TestDataset(bbox)
+        self.dataset.addSource(100000.0, lsst.geom.Point2D(50.2, 40.7))
+        self.dataset.addSource(80000.0, lsst.geom.Point2D(150.6, 60.1), lsst.afw.geom.Quadrupole(6, 5, 1))
+
+    def tearDown(self):
+        del self.dataset
+
+    def makeTask(self):
+        config = ForcedPhotCoaddTask.ConfigClass()
+        config.doApCorr = False
+        config.footprintDatasetName = None
+        config.measurement.slots.centroid = "base_TransformedCentroid"
+        config.measurement.slots.shape = "base_TransformedShape"
+        config.measurement.slots.modelFlux = None
+        config.measurement.slots.apFlux = None
+        config.measurement.slots.psfFlux = None
+        config.measurement.slots.gaussianFlux = None
+        config.measurement.plugins.names = ["base_PsfFlux", "base_TransformedCentroid",
+                                            "base_TransformedShape"]
+        return ForcedPhotCoaddTask(refSchema=self.dataset.catalog.schema, config=config)
+
+    def testRunMultiBand(self):
+        """Test that measuring two bands together matches measuring each in
+        turn.
+        """
+        refCat = self.dataset.catalog
+        refWcs = self.dataset.exposure.getWcs()
+        exposures = [self.dataset.realize(10.0, self.dataset.makeMinimalSchema(), randomSeed=seed)[0]
+                     for seed in (1, 2)]
+        task = self.makeTask()
+        result = task.runMultiBand(exposures, refCat, refWcs, exposureIds=[1, 2])
+        self.assertEqual(len(result.measCats), 2)
+        for exposureId, exposure, measCat in zip((1, 2), exposures, result.measCats):
+            expected = task.measurement.generateMeasCat(exposure, refCat, refWcs)
+            task.attachFootprints(expected, refCat, exposure, refWcs, None)
+            task.run(expected, exposure, refCat, refWcs, exposureId=exposureId)
+            self.assertEqual(len(measCat), len(refCat))
+            np.testing.assert_array_equal(measCat["id"], refCat["id"])
+            for name in ("base_TransformedCentroid_x", "base_TransformedCentroid_y",
+                         "base_PsfFlux_instFlux", "base_PsfFlux_instFluxErr"):
+                np.testing.assert_array_equal(measCat[name], expected[name], err_msg=name)
+        self.assertFalse(np.array_equal(result.measCats[0]["base_PsfFlux_instFlux"],
+                                        result.measCats[1]["base_PsfFlux_instFlux"]))
+
+    def testRunner(self):
+        """Test that the command-line runner passes the bands of each patch
+        to runDataRefs if config.doMultiBand is set.
+        """
+        dataRefs = [lsst.pipe.base.Struct(dataId={"tract": 0, "patch": patch, "filter": band})
+                    for patch in ("1,1", "1,2") for band in ("g", "r")]
+        config = ForcedPhotCoaddTask.ConfigClass()
+        parsedCmd = lsst.pipe.base.Struct(config=config, psfCache=50,
+                                          id=lsst.pipe.base.Struct(refList=dataRefs))
+        targets = ForcedPhotCoaddRunner.getTargetList(parsedCmd)
+        self.assertEqual(targets, [(dataRef, {"psfCache": 50}) for dataRef in dataRefs])
+        config.doMultiBand = True
+        targets = ForcedPhotCoaddRunner.getTargetList(parsedCmd)
+        self.assertEqual(targets, [(dataRefs[:2], {"psfCache": 50}), (dataRefs[2:], {"psfCache": 50})])
+
+        calls = []
+        task = lsst.pipe.base.Struct(
+            config=config,
+            runDataRef=lambda dataRef, **kwargs: calls.append(("one", kwargs)),
+            runDataRefs=lambda dataRefs, **kwargs: calls.append(("all", kwargs)),
+            runDataRefsPipelined=lambda dataRefs, **kwargs: calls.append(("pipelined", kwargs)),
+        )
+        runner = ForcedPhotCoaddRunner.__new__(ForcedPhotCoaddRunner)
+        runner.runTask(task, dataRefs[0], {"psfCache": 50})
+        runner.runTask(task, dataRefs[:2], {"psfCache": 50})
+        self.assertEqual(calls, [("one", {"psfCache": 50}), ("all", {"psfCache": 50})])
+
+        # All the data references are passed to runDataRefsPipelined in one
+        # call if config.doPipelined is set instead.
+        config.doMultiBand = False
+        config.doPipelined = True
+        targets = ForcedPhotCoaddRunner.getTargetList(parsedCmd)
+        self.assertEqual(targets, [(dataRefs, {"psfCache": 50})])
+        del calls[:]
+        runner.runTask(task, dataRefs, {"psfCache": 50})
+        self.assertEqual(calls, [("pipelined", {"psfCache": 50})])
+        config.doMultiBand = True
+        with self.assertRaises(ValueError):
+            config.validate()
+
+
+class FakeForcedPhotTask:
+    """Stand-in for a forced photometry task that records the thread each
+    step of `ForcedPhotImageTask.runDataRefsPipelined` is called from.
+    """
+
+    def __init__(self, readAhead, failOn=None):
+        self.config = lsst.pipe.base.Struct(readAhead=readAhead)
+        self.log = lsst.pipe.base.Struct(info=lambda msg: None)
+        self.failOn = failOn
+        self.lock = threading.Lock()
+        self.threads = {"read": set(), "run": set(), "write": set()}
+        self.measured = []
+        self.written = []
+
+    def record(self, step):
+        with self.lock:
+            self.threads[step].add(threading.get_ident())
+
+    def readDataRef(self, dataRef, psfCache=None):
+        self.record("read")
+        return lsst.pipe.base.Struct(exposure=dataRef, refCat=None, refWcs=None)
+
+    def makeMeasCat(self, dataRef, inputs):
+        self.record("read")
+        return [dataRef]
+
+    def getExposureId(self, dataRef):
+        self.record("read")
+        return dataRef.dataId["visit"]
+
+    def run(self, measCat, exposure, refCat, refWcs, exposureId=None):
+        self.record("run")
+        if exposureId == self.failOn:
+            raise RuntimeError("failed on %d" % exposureId)
+        with self.lock:
+            self.measured.append(exposureId)
+        return lsst.pipe.base.Struct(measCat=measCat)
+
+    def writeOutput(self, dataRef, sources):
+        self.record("write")
+        with self.lock:
+            self.written.append((dataRef, sources))
+
+
+class RunDataRefsPipelinedTestCase(lsst.utils.tests.TestCase):
+    """Test that `ForcedPhotImageTask.runDataRefsPipelined` only measures in
+    the background.
+    """
+
+    def testThreads(self):
+        for readAhead in (0, 1, 3):
+            task = FakeForcedPhotTask(readAhead)
+            dataRefs = [lsst.pipe.base.Struct(dataId={"visit": i}) for i in range(5)]
+            ForcedPhotImageTask.runDataRefsPipelined(task, dataRefs)
+            self.assertEqual(task.written, [(dataRef, [dataRef]) for dataRef in dataRefs])
+            caller = {threading.get_ident()}
+            self.assertEqual(task.threads["read"], caller)
+            self.assertEqual(task.threads["write"], caller)
+            self.assertEqual(len(task.threads["run"]), 1)
+            self.assertNotEqual(task.threads["run"], caller)
+
+    def testFailure(self):
+        task = FakeForcedPhotTask(readAhead=2, failOn=3)
+        dataRefs = [lsst.pipe.base.Struct(dataId={"visit": i}) for i in range(7)]
+        with self.assertRaises(RuntimeError):
+            ForcedPhotImageTask.runDataRefsPipelined(task, dataRefs)
+        # Only the results measured before the failure are written.
+        self.assertEqual([dataRef for dataRef, sources in task.written], dataRefs[:3])
+
+
+class TestMemory(lsst.utils.tests.MemoryTestCase):
+    pass
+
+
+def setup_module(module):
+    lsst.utils.tests.init()
+
+
+if __name__ == "__main__":
+    lsst.utils.tests.init()
+    unittest.main()
@@ -25,7 +25,9 @@ import numpy as np
 
 import lsst.geom
 import lsst.afw.geom
+import lsst.afw.table
 import lsst.meas.base
+import lsst.pex.exceptions
 import lsst.utils.tests
 from lsst.meas.base.tests import (AlgorithmTestCase, FluxTransformTestCase,
                                   SingleFramePluginTransformSetupHelper)
@@ -67,6 +69,34 @@ class GaussianFluxTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase):
             self.assertFloatsAlmostEqual(measRecord.get("base_GaussianFlux_instFlux"),
                                          measRecord.get("truth_instFlux"), rtol=3E-3)
 
+    def testReuseWeightedSum(self):
+        """Test that reusing the weighted sum recorded by base_SdssShape
+        gives exactly the same results as recomputing it.
+        """
+        results = {}
+        for doRecordWeightedSum in (False, True):
+            config = self.makeSingleFrameMeasurementConfig("base_GaussianFlux",
+                                                           dependencies=("base_SdssShape",))
+            config.slots.shape = "base_SdssShape"
+            config.plugins["base_SdssShape"].doRecordWeightedSum = doRecordWeightedSum
+            task = self.makeSingleFrameMeasurementTask(config=config)
+            exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+            task.run(catalog, exposure)
+            results[doRecordWeightedSum] = catalog
+        self.assertNotIn("base_SdssShape_weightedSum", results[False].schema)
+        for recomputed, reused in zip(results[False], results[True]):
+            self.assertFalse(reused.get("base_SdssShape_flag"))
+            self.assertTrue(np.isfinite(reused.get("base_SdssShape_weightedSum")))
+            self.assertEqual(reused.get("base_SdssShape_weightedSumCenter_x"), reused.getX())
+            self.assertEqual(reused.get("base_SdssShape_weightedSumCenter_y"), reused.getY())
+            self.assertFalse(reused.get("base_GaussianFlux_flag"))
+            self.assertEqual(reused.get("base_GaussianFlux_instFlux"),
+                             2*reused.get("base_SdssShape_weightedSum"))
+            self.assertEqual(reused.get("base_GaussianFlux_instFlux"),
+                             recomputed.get("base_GaussianFlux_instFlux"))
+            self.assertEqual(reused.get("base_GaussianFlux_instFluxErr"),
+                             recomputed.get("base_GaussianFlux_instFluxErr"))
+
     def testMonteCarlo(self):
         """Test an ideal simulation, with no noise.
 
@@ -131,6 +161,73 @@ class GaussianFluxTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase):
             self.assertLess(measRecord.get("base_GaussianFlux_instFluxErr"), 500.0)
 
 
+class MultiScaleGaussianFluxTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase):
+
+    def setUp(self):
+        self.bbox = lsst.geom.Box2I(lsst.geom.Point2I(-20, -30),
+                                    lsst.geom.Extent2I(240, 160))
+        self.dataset = lsst.meas.base.tests.TestDataset(self.bbox)
+        self.dataset.addSource(100000.0, lsst.geom.Point2D(50.1, 49.8))
+        self.dataset.addSource(100000.0, lsst.geom.Point2D(149.9, 50.3),
+                               lsst.afw.geom.Quadrupole(8, 9, 3))
+
+    def tearDown(self):
+        del self.bbox
+        del self.dataset
+
+    def testFixedMomentsFluxes(self):
+        """Test that the single-pass fluxes match one computeFixedMomentsFlux
+        call per scale, including the interpolated (small) scales.
+        """
+        exposure, catalog = self.dataset.realize(10.0, self.dataset.makeMinimalSchema(), randomSeed=0)
+        scales = [0.25, 0.5, 1.0, 1.5, 2.0, 3.0]
+        for shape in (lsst.afw.geom.Quadrupole(8, 9, 3), lsst.afw.geom.Quadrupole(1.0, 1.2, 0.1)):
+            for record in catalog:
+                center = record.getCentroid()
+                results = lsst.meas.base.SdssShapeAlgorithm.computeFixedMomentsFluxes(
+                    exposure.getMaskedImage(), shape, center, scales)
+                self.assertEqual(len(results), len(scales))
+                for scale, result in zip(scales, results):
+                    scaled = lsst.afw.geom.Quadrupole(shape.getIxx()*scale**2, shape.getIyy()*scale**2,
+                                                      shape.getIxy()*scale**2)
+                    expected = lsst.meas.base.SdssShapeAlgorithm.computeFixedMomentsFlux(
+                        exposure.getMaskedImage(), scaled, center)
+                    self.assertFloatsAlmostEqual(result.instFlux, expected.instFlux, rtol=1E-5)
+                    self.assertFloatsAlmostEqual(result.instFluxErr, expected.instFluxErr, rtol=1E-10)
+
+    def testDuplicatePrefixes(self):
+        """Test that scales which would share field names are rejected.
+        """
+        ctrl = lsst.meas.base.MultiScaleGaussianFluxControl()
+        ctrl.scales = [1.21, 1.24]
+        schema = self.dataset.makeMinimalSchema()
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            lsst.meas.base.MultiScaleGaussianFluxAlgorithm(ctrl, "base_MultiScaleGaussianFlux", schema)
+        self.assertNotIn("base_MultiScaleGaussianFlux_1_2_instFlux", schema.getNames())
+
+    def testPlugin(self):
+        """Test that the plugin's unit-scale columns match base_GaussianFlux.
+        """
+        config = self.makeSingleFrameMeasurementConfig("base_MultiScaleGaussianFlux",
+                                                       dependencies=("base_GaussianFlux",))
+        config.plugins["base_MultiScaleGaussianFlux"].scales = [0.5, 1.0, 2.0]
+        task = self.makeSingleFrameMeasurementTask(config=config)
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+        task.run(catalog, exposure)
+        prefix = lsst.meas.base.MultiScaleGaussianFluxAlgorithm.makeFieldPrefix(
+            "base_MultiScaleGaussianFlux", 1.0)
+        self.assertEqual(prefix, "base_MultiScaleGaussianFlux_1_0")
+        for measRecord in catalog:
+            self.assertFalse(measRecord.get("base_MultiScaleGaussianFlux_flag"))
+            self.assertFloatsAlmostEqual(measRecord.get(prefix + "_instFlux"),
+                                         measRecord.get("base_GaussianFlux_instFlux"), rtol=1E-5)
+            self.assertFloatsAlmostEqual(measRecord.get(prefix + "_instFluxErr"),
+                                         measRecord.get("base_GaussianFlux_instFluxErr"), rtol=1E-10)
+            # Larger weights enclose more of the source's flux.
+            self.assertLess(measRecord.get("base_MultiScaleGaussianFlux_0_5_instFlux"),
+                            measRecord.get("base_MultiScaleGaussianFlux_2_0_instFlux"))
+
+
 class GaussianFluxTransformTestCase(FluxTransformTestCase, SingleFramePluginTransformSetupHelper,
                                     lsst.utils.tests.TestCase):
     controlClass = lsst.meas.base.GaussianFluxControl
@@ -140,6 +237,40 @@ class GaussianFluxTransformTestCase(FluxTransformTestCase, SingleFramePluginTran
     forcedPlugins = ('base_GaussianFlux',)
 
 
+class MultiScaleGaussianFluxTransformTestCase(FluxTransformTestCase, SingleFramePluginTransformSetupHelper,
+                                              lsst.utils.tests.TestCase):
+    controlClass = lsst.meas.base.MultiScaleGaussianFluxControl
+    algorithmClass = lsst.meas.base.MultiScaleGaussianFluxAlgorithm
+    transformClass = lsst.meas.base.MultiScaleGaussianFluxTransform
+    singleFramePlugins = ('base_MultiScaleGaussianFlux',)
+
+    def _getBaseNames(self):
+        return [lsst.meas.base.MultiScaleGaussianFluxAlgorithm.makeFieldPrefix(self.name, scale)
+                for scale in self.control.scales]
+
+    def _populateCatalog(self, baseNames):
+        FluxTransformTestCase._populateCatalog(self, baseNames)
+        # The failure flag belongs to the algorithm, not to each scale.
+        for record, flagValue in zip(self.inputCat[-2:], (True, False)):
+            record.set(self.name + "_flag", flagValue)
+
+    def _checkOutput(self, baseNames):
+        FluxTransformTestCase._checkOutput(self, baseNames)
+        for inSrc, outSrc in zip(self.inputCat, self.outputCat):
+            self.assertEqual(outSrc.get(self.name + "_flag"), inSrc.get(self.name + "_flag"))
+
+    def testTransform(self):
+        """Test `MultiScaleGaussianFluxTransform` with a synthetic catalog.
+        """
+        FluxTransformTestCase.testTransform(self, self._getBaseNames())
+
+    def testTransformNonContiguous(self):
+        """Test `MultiScaleGaussianFluxTransform` with a non-contiguous subset
+        of a synthetic catalog.
+        """
+        FluxTransformTestCase.testTransformNonContiguous(self, self._getBaseNames())
+
+
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
 
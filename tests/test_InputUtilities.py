@@ -21,6 +21,9 @@
 
 import unittest
 
+import numpy as np
+
+import lsst.geom
 import lsst.afw.geom
 import lsst.meas.base.tests
 import lsst.pex.exceptions
@@ -98,6 +101,41 @@ class InputUtilitiesTestCase(lsst.meas.base.tests.AlgorithmTestCase, lsst.utils.
         with self.assertRaises(lsst.pex.exceptions.LogicError):
             self.makeSingleFrameMeasurementTask(config=config)
 
+    def testExtractAll(self):
+        """Test that extracting all centroids at once matches extracting them
+        one record at a time.
+        """
+        dataset = lsst.meas.base.tests.TestDataset(lsst.geom.Box2I(lsst.geom.Point2I(0, 0),
+                                                                   lsst.geom.Extent2I(100, 100)))
+        for x, y in ((20.3, 30.7), (60.1, 45.5), (75.8, 80.2)):
+            dataset.addSource(10000.0, lsst.geom.Point2D(x, y))
+        schema = lsst.meas.base.tests.TestDataset.makeMinimalSchema()
+        flagDefs = lsst.meas.base.FlagDefinitionList()
+        flagDefs.addFailureFlag()
+        flagHandler = lsst.meas.base.FlagHandler.addFields(schema, "test", flagDefs)
+        centroidExtractor = lsst.meas.base.SafeCentroidExtractor(schema, "test")
+        shapeExtractor = lsst.meas.base.SafeShapeExtractor(schema, "test")
+        exposure, catalog = dataset.realize(10.0, schema, randomSeed=0)
+        xKey = schema.find("truth_x").key
+        flagKey = schema.find("truth_flag").key
+        # Flagged NaN centroid: falls back to the Peak and sets our flag.
+        catalog[1].set(xKey, np.nan)
+        catalog[1].set(flagKey, True)
+        # Unflagged NaN centroid: an error, reported as a NaN row.
+        catalog[2].set(xKey, np.nan)
+        centroids = centroidExtractor.extractAll(catalog, flagHandler)
+        self.assertEqual(centroids.shape, (len(catalog), 2))
+        self.assertFloatsEqual(centroids[0], [catalog[0].getX(), catalog[0].getY()])
+        self.assertFalse(catalog[0].get("test_flag"))
+        peak = catalog[1].getFootprint().getPeaks()[0]
+        self.assertFloatsEqual(centroids[1], [peak.getFx(), peak.getFy()])
+        self.assertTrue(catalog[1].get("test_flag"))
+        self.assertTrue(np.isnan(centroids[2]).all())
+        with self.assertRaises(lsst.pex.exceptions.RuntimeError):
+            centroidExtractor(catalog[2], flagHandler)
+        self.assertFloatsEqual(shapeExtractor(catalog[0], flagHandler).getParameterVector(),
+                               catalog[0].getShape().getParameterVector())
+
 
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
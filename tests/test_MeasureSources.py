@@ -33,6 +33,7 @@ import lsst.afw.geom as afwGeom
 import lsst.afw.table as afwTable
 import lsst.afw.image as afwImage
 import lsst.meas.base as measBase
+import lsst.meas.base.tests
 import lsst.utils.tests
 
 try:
@@ -387,6 +388,483 @@ def makeFakeImage(bbox, centerList, instFluxList, fwhm, var):
     return maskedImage
 
 
+class MeasureBatchTestCase(measBase.tests.AlgorithmTestCase, lsst.utils.tests.TestCase):
+    """Test that measuring all sources in one call per plugin matches the per-source loop.
+    """
+
+    def setUp(self):
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(140, 100))
+        self.dataset = measBase.tests.TestDataset(bbox)
+        self.dataset.addSource(100000.0, lsst.geom.Point2D(35.2, 40.7))
+        self.dataset.addSource(80000.0, lsst.geom.Point2D(90.6, 60.1), afwGeom.Quadrupole(6, 5, 1))
+        # close to the edge, to trigger failures
+        self.dataset.addSource(50000.0, lsst.geom.Point2D(1.5, 98.5))
+
+    def tearDown(self):
+        del self.dataset
+
+    def testMeasureBatch(self):
+        plugins = ("base_PsfFlux", "base_SdssShape", "base_PixelFlags", "base_CircularApertureFlux")
+        catalogs = []
+        for doMeasureBatch in (False, True):
+            config = self.makeSingleFrameMeasurementConfig("base_SdssCentroid", dependencies=plugins)
+            config.slots.centroid = "base_SdssCentroid"
+            config.doReplaceWithNoise = False
+            config.doMeasureBatch = doMeasureBatch
+            task = self.makeSingleFrameMeasurementTask(config=config)
+            exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=5)
+            task.run(catalog, exposure)
+            catalogs.append(catalog)
+        unbatched, batched = catalogs
+        for name in unbatched.schema.getNames():
+            if name.startswith("base_"):
+                np.testing.assert_array_equal(unbatched[name], batched[name], err_msg=name)
+        self.assertTrue(np.all(np.isfinite(batched["base_PsfFlux_instFlux"][:2])))
+
+
+class ParallelMeasurementTestCase(measBase.tests.AlgorithmTestCase, lsst.utils.tests.TestCase):
+    """Test that measuring parent families on several threads matches the serial loop.
+    """
+
+    def setUp(self):
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(300, 100))
+        self.dataset = measBase.tests.TestDataset(bbox)
+        # Sources are far enough apart that the noise replacing their neighbors
+        # (which is drawn independently per tile) doesn't affect them.
+        self.dataset.addSource(100000.0, lsst.geom.Point2D(50.2, 40.7))
+        self.dataset.addSource(80000.0, lsst.geom.Point2D(150.6, 60.1), afwGeom.Quadrupole(6, 5, 1))
+        self.dataset.addSource(70000.0, lsst.geom.Point2D(245.3, 50.8))
+
+    def tearDown(self):
+        del self.dataset
+
+    def testParallel(self):
+        plugins = ("base_PsfFlux", "base_SdssShape", "base_PixelFlags")
+        catalogs = []
+        for numThreads in (1, 3):
+            config = self.makeSingleFrameMeasurementConfig("base_SdssCentroid", dependencies=plugins)
+            config.numThreads = numThreads
+            config.parallelTileSize = 64
+            config.parallelBorder = 20
+            task = self.makeSingleFrameMeasurementTask(config=config)
+            exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=6)
+            original = exposure.getMaskedImage().getImage().getArray().copy()
+            task.run(catalog, exposure)
+            np.testing.assert_array_equal(exposure.getMaskedImage().getImage().getArray(), original)
+            self.assertNotIn("THISDET", exposure.getMaskedImage().getMask().getMaskPlaneDict())
+            catalogs.append(catalog)
+        serial, parallel = catalogs
+        self.assertEqual(len(parallel), 3)
+        for name in ("base_SdssCentroid_x", "base_SdssCentroid_y", "base_PsfFlux_instFlux",
+                     "base_SdssShape_xx", "base_SdssShape_yy", "base_SdssShape_xy"):
+            self.assertFloatsAlmostEqual(parallel[name], serial[name], rtol=1E-6)
+        for name in serial.schema.extract("*_flag*"):
+            np.testing.assert_array_equal(parallel[name], serial[name], err_msg=name)
+
+    def testScheduling(self):
+        """Test that expensive families are split out of their tiles and
+        scheduled first, and that the time taken by each family is recorded.
+        """
+        with self.dataset.addBlend() as family:
+            family.addChild(60000.0, lsst.geom.Point2D(160.3, 30.8))
+            family.addChild(60000.0, lsst.geom.Point2D(170.1, 35.2))
+            family.addChild(60000.0, lsst.geom.Point2D(165.1, 25.2))
+        config = self.makeSingleFrameMeasurementConfig("base_SdssCentroid", dependencies=["base_PsfFlux"])
+        config.numThreads = 2
+        config.parallelTileSize = 128
+        config.parallelBorder = 20
+        config.doTiming = True
+        task = self.makeSingleFrameMeasurementTask(config=config)
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=6)
+        parents = catalog.getChildren(0)
+        tiles = task._scheduleTiles(catalog, parents, exposure.getBBox())
+        self.assertEqual(sorted(i for tile in tiles for i in tile.parentIndices), list(range(len(parents))))
+        self.assertEqual(tiles[0].parentIndices, [3])
+        self.assertEqual([tile.cost for tile in tiles], sorted((tile.cost for tile in tiles), reverse=True))
+
+        task.run(catalog, exposure)
+        metadata = task.algMetadata
+        self.assertEqual(sorted(metadata.getArray("TIMING_FAMILY_IDS")), sorted(parents["id"]))
+        costs = dict(zip(metadata.getArray("TIMING_FAMILY_IDS"), metadata.getArray("TIMING_FAMILY_COSTS")))
+        self.assertEqual(costs[parents[3].getId()], task.estimateFamilyCost(parents[3], 3))
+        for wallTime in metadata.getArray("TIMING_FAMILY_WALLTIMES"):
+            self.assertGreater(wallTime, 0.0)
+
+
+class TiledMeasurementTestCase(measBase.tests.AlgorithmTestCase, lsst.utils.tests.TestCase):
+    """Test that measuring tile by tile from sub-images matches measuring the
+    whole image.
+    """
+
+    def setUp(self):
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(300, 100))
+        self.dataset = measBase.tests.TestDataset(bbox)
+        self.dataset.addSource(100000.0, lsst.geom.Point2D(50.2, 40.7))
+        self.dataset.addSource(80000.0, lsst.geom.Point2D(150.6, 60.1), afwGeom.Quadrupole(6, 5, 1))
+        with self.dataset.addBlend() as family:
+            family.addChild(70000.0, lsst.geom.Point2D(240.3, 50.8))
+            family.addChild(60000.0, lsst.geom.Point2D(251.1, 47.2))
+
+    def tearDown(self):
+        del self.dataset
+
+    def makeReader(self, exposure):
+        """Return a callable that reads sub-images of an exposure, and a list
+        that records the boxes read.
+        """
+        boxes = []
+
+        def getExposure(bbox):
+            boxes.append(bbox)
+            return exposure.Factory(exposure, bbox, afwImage.PARENT, True)
+
+        return getExposure, boxes
+
+    def testTiles(self):
+        task = self.makeSingleFrameMeasurementTask("base_SdssCentroid")
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=6)
+        tiles = task.makeTiles(catalog.getChildren(0), exposure.getBBox(), tileSize=64, halo=20)
+        self.assertEqual(len(tiles), 3)
+        self.assertEqual(sorted(i for tile in tiles for i in tile.parentIndices), [0, 1, 2])
+        parents = catalog.getChildren(0)
+        for tile in tiles:
+            self.assertTrue(exposure.getBBox().contains(tile.bbox))
+            for parentIdx in tile.parentIndices:
+                self.assertTrue(tile.bbox.contains(parents[parentIdx].getFootprint().getBBox()))
+
+    def testSingleFrame(self):
+        plugins = ("base_PsfFlux", "base_SdssShape", "base_PixelFlags")
+        for doReplaceWithNoise in (False, True):
+            catalogs = []
+            for tiled in (False, True):
+                config = self.makeSingleFrameMeasurementConfig("base_SdssCentroid", dependencies=plugins)
+                config.doReplaceWithNoise = doReplaceWithNoise
+                config.parallelTileSize = 64
+                config.parallelBorder = 20
+                task = self.makeSingleFrameMeasurementTask(config=config)
+                exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=6)
+                if tiled:
+                    getExposure, boxes = self.makeReader(exposure)
+                    task.runTiled(catalog, exposure.getBBox(), getExposure)
+                    self.assertEqual(len(boxes), 3)
+                    for bbox in boxes:
+                        self.assertLess(bbox.getArea(), exposure.getBBox().getArea()//2)
+                else:
+                    task.run(catalog, exposure)
+                catalogs.append(catalog)
+            whole, tiled = catalogs
+            # The noise replacing the blended siblings is drawn per tile, so
+            # only the isolated sources match when it is used.
+            rows = slice(0, 2) if doReplaceWithNoise else slice(None)
+            for name in ("base_SdssCentroid_x", "base_SdssCentroid_y", "base_PsfFlux_instFlux",
+                         "base_SdssShape_xx", "base_SdssShape_yy", "base_SdssShape_xy"):
+                self.assertFloatsAlmostEqual(tiled[name][rows], whole[name][rows], rtol=1E-6)
+            for name in whole.schema.extract("*_flag*"):
+                np.testing.assert_array_equal(tiled[name][rows], whole[name][rows], err_msg=name)
+
+    def testForced(self):
+        refCat = self.dataset.catalog
+        refWcs = self.dataset.exposure.getWcs()
+        exposure = self.dataset.realize(10.0, self.dataset.makeMinimalSchema(), randomSeed=1)[0]
+        catalogs = []
+        for tiled in (False, True):
+            config = self.makeForcedMeasurementConfig("base_PsfFlux")
+            config.parallelTileSize = 64
+            config.parallelBorder = 20
+            task = self.makeForcedMeasurementTask(config=config)
+            measCat = task.generateMeasCat(exposure, refCat, refWcs)
+            task.attachTransformedFootprints(measCat, refCat, exposure, refWcs)
+            if tiled:
+                getExposure, boxes = self.makeReader(exposure)
+                task.runTiled(measCat, exposure.getBBox(), getExposure, refCat, refWcs, exposureId=1)
+                self.assertEqual(len(boxes), 3)
+            else:
+                task.run(measCat, exposure, refCat, refWcs, exposureId=1)
+            catalogs.append(measCat)
+        whole, tiled = catalogs
+        self.assertEqual(len(tiled), len(refCat))
+        self.assertFloatsEqual(tiled["base_TransformedCentroid_x"], whole["base_TransformedCentroid_x"])
+        self.assertFloatsEqual(tiled["base_TransformedCentroid_y"], whole["base_TransformedCentroid_y"])
+        # As for single-frame measurement, only the isolated sources are
+        # unaffected by the noise replacing their neighbors being drawn per tile.
+        for name in ("base_PsfFlux_instFlux", "base_PsfFlux_instFluxErr"):
+            self.assertFloatsAlmostEqual(tiled[name][:2], whole[name][:2], rtol=1E-6)
+
+
+class RemeasureTestCase(measBase.tests.AlgorithmTestCase, lsst.utils.tests.TestCase):
+    """Test re-running some plugins on a catalog that has already been
+    measured.
+    """
+
+    def setUp(self):
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(300, 100))
+        self.dataset = measBase.tests.TestDataset(bbox)
+        self.dataset.addSource(100000.0, lsst.geom.Point2D(50.2, 40.7))
+        self.dataset.addSource(80000.0, lsst.geom.Point2D(150.6, 60.1), afwGeom.Quadrupole(6, 5, 1))
+        with self.dataset.addBlend() as family:
+            family.addChild(70000.0, lsst.geom.Point2D(240.3, 50.8))
+            family.addChild(60000.0, lsst.geom.Point2D(251.1, 47.2))
+
+    def tearDown(self):
+        del self.dataset
+
+    def testRemeasure(self):
+        config = self.makeSingleFrameMeasurementConfig("base_SdssCentroid",
+                                                       dependencies=("base_PsfFlux", "base_GaussianFlux"))
+        config.noiseReplacer.noiseRng = "counter"
+        config.parallelBorder = 20
+        task = self.makeSingleFrameMeasurementTask(config=config)
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=6)
+        task.run(catalog, exposure, exposureId=3)
+        original = catalog.copy(deep=True)
+        image = exposure.getMaskedImage().getImage().getArray().copy()
+        fluxKey = catalog.schema.find("base_GaussianFlux_instFlux").key
+        psfFluxKey = catalog.schema.find("base_PsfFlux_instFlux").key
+        for record in catalog:
+            record.set(fluxKey, np.nan)
+            record.set(psfFluxKey, -1.0)
+
+        # Counter-based noise does not depend on which neighbors are
+        # replaced, so the results are those of the full run.
+        self.assertEqual(task.remeasure(catalog, exposure, ["base_GaussianFlux"], exposureId=3), 3)
+        self.assertFloatsEqual(catalog["base_GaussianFlux_instFlux"], original["base_GaussianFlux_instFlux"])
+        self.assertFloatsEqual(catalog["base_PsfFlux_instFlux"], -1.0)
+        self.assertFloatsEqual(exposure.getMaskedImage().getImage().getArray(), image)
+
+        # Only the families whose slot inputs changed are measured.
+        previous = catalog.copy(deep=True)
+        for record in catalog:
+            record.set(fluxKey, np.nan)
+        catalog[1].set("truth_x", catalog[1].get("truth_x") + 0.5)
+        self.assertEqual(task.remeasure(catalog, exposure, ["base_GaussianFlux"], previousCat=previous,
+                                        exposureId=3), 1)
+        self.assertTrue(np.isfinite(catalog[1].get(fluxKey)))
+        for i in (0, 2, 3, 4):
+            self.assertTrue(np.isnan(catalog[i].get(fluxKey)))
+        self.assertEqual(task.remeasure(original, exposure, ["base_GaussianFlux"], previousCat=original), 0)
+
+        with self.assertRaises(ValueError):
+            task.remeasure(catalog, exposure, ["base_CircularApertureFlux"])
+
+    def testRemeasureClearsFlags(self):
+        """Test that re-measuring a source whose centroid has been corrected
+        clears the flags of its earlier failure.
+        """
+        config = self.makeSingleFrameMeasurementConfig("base_SdssCentroid", dependencies=("base_PsfFlux",))
+        config.noiseReplacer.noiseRng = "counter"
+        task = self.makeSingleFrameMeasurementTask(config=config)
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=6)
+        task.run(catalog, exposure, exposureId=3)
+        original = catalog.copy(deep=True)
+        self.assertFalse(original[1].get("base_PsfFlux_flag"))
+
+        # Move the source off the image, so PsfFlux fails.
+        previous = catalog.copy(deep=True)
+        catalog[1].set("truth_x", -100.0)
+        self.assertEqual(task.remeasure(catalog, exposure, ["base_PsfFlux"], previousCat=previous,
+                                        exposureId=3), 1)
+        self.assertTrue(catalog[1].get("base_PsfFlux_flag"))
+
+        # Correct the centroid: the failure must not survive.
+        previous = catalog.copy(deep=True)
+        catalog[1].set("truth_x", original[1].get("truth_x"))
+        self.assertEqual(task.remeasure(catalog, exposure, ["base_PsfFlux"], previousCat=previous,
+                                        exposureId=3), 1)
+        for name in ("base_PsfFlux_flag", "base_PsfFlux_flag_edge", "base_PsfFlux_flag_noGoodPixels"):
+            self.assertEqual(catalog[1].get(name), original[1].get(name))
+        self.assertEqual(catalog[1].get("base_PsfFlux_instFlux"), original[1].get("base_PsfFlux_instFlux"))
+        # Fields of other plugins are left alone.
+        self.assertEqual(catalog[1].get("base_SdssCentroid_x"), original[1].get("base_SdssCentroid_x"))
+
+    def testResetPluginFieldsIntegers(self):
+        """Test that re-measurement resets the integer fields of a plugin.
+        """
+        config = self.makeSingleFrameMeasurementConfig("base_SdssCentroid", dependencies=("base_InputCount",))
+        task = self.makeSingleFrameMeasurementTask(config=config)
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=6)
+        key = catalog.schema.find("base_InputCount_value").key
+        for record in catalog:
+            record.set(key, 5)
+        task._resetPluginFields(catalog, ["base_InputCount"])
+        for record in catalog:
+            self.assertEqual(record.get(key), 0)
+        for record in catalog:
+            record.set(key, 5)
+        task._resetPluginFields(catalog, ["base_SdssCentroid"])
+        for record in catalog:
+            self.assertEqual(record.get(key), 5)
+
+    def testChangedFamilies(self):
+        """Test that the family of a changed grandchild is its top-level
+        parent's.
+        """
+        schema = afwTable.SourceTable.makeMinimalSchema()
+        catalog = afwTable.SourceCatalog(schema)
+        parent = catalog.addNew()
+        child = catalog.addNew()
+        child.setParent(parent.getId())
+        grandchild = catalog.addNew()
+        grandchild.setParent(child.getId())
+        catalog.addNew()
+        previous = afwTable.SourceCatalog(schema)
+        previous.extend((record for record in catalog if record.getId() != grandchild.getId()), deep=True)
+        catalog.sort(afwTable.SourceTable.getParentKey())
+        measParentCat = catalog.getChildren(0)
+        indices = measBase.SingleFrameMeasurementTask._getChangedFamilies(catalog, measParentCat, previous)
+        self.assertEqual([measParentCat[i].getId() for i in indices], [parent.getId()])
+
+
+class ForcedMultipleTestCase(measBase.tests.AlgorithmTestCase, lsst.utils.tests.TestCase):
+    """Test forced measurement of one reference catalog on several exposures.
+    """
+
+    def setUp(self):
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(200, 100))
+        self.dataset = measBase.tests.TestDataset(bbox)
+        self.dataset.addSource(100000.0, lsst.geom.Point2D(50.2, 40.7))
+        self.dataset.addSource(80000.0, lsst.geom.Point2D(150.6, 60.1), afwGeom.Quadrupole(6, 5, 1))
+
+    def tearDown(self):
+        del self.dataset
+
+    def testRunMultiple(self):
+        refCat = self.dataset.catalog
+        refWcs = self.dataset.exposure.getWcs()
+        measWcs = self.dataset.makePerturbedWcs(refWcs, randomSeed=3)
+        measDataset = self.dataset.transform(measWcs)
+        exposures = [self.dataset.realize(10.0, self.dataset.makeMinimalSchema(), randomSeed=1)[0],
+                     measDataset.realize(10.0, measDataset.makeMinimalSchema(), randomSeed=2)[0],
+                     self.dataset.realize(10.0, self.dataset.makeMinimalSchema(), randomSeed=3)[0]]
+
+        task = self.makeForcedMeasurementTask("base_PsfFlux")
+        expected = []
+        for exposureId, exposure in enumerate(exposures):
+            measCat = task.generateMeasCat(exposure, refCat, refWcs)
+            task.attachTransformedFootprints(measCat, refCat, exposure, refWcs)
+            task.run(measCat, exposure, refCat, refWcs, exposureId=exposureId)
+            expected.append(measCat)
+
+        for numThreads in (1, 2):
+            config = self.makeForcedMeasurementConfig("base_PsfFlux")
+            config.numThreads = numThreads
+            task = self.makeForcedMeasurementTask(config=config)
+            measCats = task.runMultiple(exposures, refCat, refWcs, exposureIds=range(len(exposures)))
+            self.assertEqual(len(measCats), len(exposures))
+            for measCat, expectedCat in zip(measCats, expected):
+                self.assertEqual(len(measCat), len(refCat))
+                # The catalog of the second exposure is on a different pixel
+                # grid, but still gets the same IDs.
+                np.testing.assert_array_equal(measCat["id"], measCats[0]["id"])
+                for name in ("base_TransformedCentroid_x", "base_TransformedCentroid_y",
+                             "base_PsfFlux_instFlux", "base_PsfFlux_instFluxErr"):
+                    np.testing.assert_array_equal(measCat[name], expectedCat[name], err_msg=name)
+            for exposure in exposures:
+                self.assertNotIn("THISDET", exposure.getMaskedImage().getMask().getMaskPlaneDict())
+
+    def testAttachFootprints(self):
+        """Test that per-exposure Footprints can be attached by the caller,
+        as for per-band deblended Footprints on coadds.
+        """
+        refCat = self.dataset.catalog
+        refWcs = self.dataset.exposure.getWcs()
+        exposures = [self.dataset.realize(10.0, self.dataset.makeMinimalSchema(), randomSeed=seed)[0]
+                     for seed in (4, 5)]
+        config = self.makeForcedMeasurementConfig("base_PsfFlux")
+        config.doReplaceWithNoise = False
+        task = self.makeForcedMeasurementTask(config=config)
+        expected = task.runMultiple(exposures, refCat, refWcs, exposureIds=[1, 2])
+        attached = []
+
+        def attachFootprints(index, measCat):
+            attached.append(index)
+            for refRecord, measRecord in zip(refCat, measCat):
+                measRecord.setFootprint(refRecord.getFootprint())
+
+        measCats = task.runMultiple(exposures, refCat, refWcs, exposureIds=[1, 2],
+                                    attachFootprints=attachFootprints)
+        self.assertEqual(attached, [0, 1])
+        for measCat, expectedCat in zip(measCats, expected):
+            for measRecord, refRecord in zip(measCat, refCat):
+                self.assertEqual(measRecord.getFootprint().getSpans(), refRecord.getFootprint().getSpans())
+            # Without noise replacement PsfFlux does not depend on the
+            # Footprints.
+            for name in ("base_PsfFlux_instFlux", "base_PsfFlux_instFluxErr"):
+                np.testing.assert_array_equal(measCat[name], expectedCat[name], err_msg=name)
+
+
+class SpatialOrderTestCase(measBase.tests.AlgorithmTestCase, lsst.utils.tests.TestCase):
+    """Test measuring sources in order along a Hilbert curve.
+    """
+
+    def setUp(self):
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(160, 120))
+        self.dataset = measBase.tests.TestDataset(bbox)
+        for x, y in ((20.3, 20.1), (130.7, 95.2), (25.6, 90.4), (125.1, 25.8), (75.2, 60.7)):
+            self.dataset.addSource(60000.0, lsst.geom.Point2D(x, y))
+        with self.dataset.addBlend() as family:
+            family.addChild(50000.0, lsst.geom.Point2D(80.2, 15.3))
+            family.addChild(50000.0, lsst.geom.Point2D(88.9, 18.6))
+
+    def tearDown(self):
+        del self.dataset
+
+    def testHilbertIndex(self):
+        self.assertEqual([measBase.hilbertIndex(x, y, 1) for x, y in ((0, 0), (0, 1), (1, 1), (1, 0))],
+                         [0, 1, 2, 3])
+        level = 3
+        n = 2**level
+        cells = [None]*n**2
+        for x in range(n):
+            for y in range(n):
+                cells[measBase.hilbertIndex(x, y, level)] = (x, y)
+        # Every cell is visited once, and consecutive cells are neighbors.
+        self.assertNotIn(None, cells)
+        for (x1, y1), (x2, y2) in zip(cells[:-1], cells[1:]):
+            self.assertEqual(abs(x1 - x2) + abs(y1 - y2), 1)
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            measBase.hilbertIndex(n, 0, level)
+        points = [lsst.geom.Point2D(x, y) for x, y in ((0.0, 9.0), (np.nan, 1.0), (0.0, 0.0), (9.0, 0.0))]
+        self.assertEqual(measBase.hilbertOrder(points), [2, 0, 3, 1])
+
+    def testOrder(self):
+        """Test that measuring in Hilbert order does not change the results,
+        with or without noise replacement.
+        """
+        plugins = ("base_SdssShape", "base_PsfFlux", "base_CircularApertureFlux")
+        for doReplaceWithNoise in (True, False):
+            catalogs = []
+            for sourceOrder in ("catalog", "hilbert"):
+                config = self.makeSingleFrameMeasurementConfig("base_SdssCentroid", dependencies=plugins)
+                config.doReplaceWithNoise = doReplaceWithNoise
+                config.sourceOrder = sourceOrder
+                task = self.makeSingleFrameMeasurementTask(config=config)
+                exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=7)
+                task.run(catalog, exposure)
+                catalogs.append(catalog)
+            order = task.getSourceOrder(catalog.getChildren(0))
+            self.assertEqual(sorted(order), list(range(6)))
+            self.assertNotEqual(order, list(range(6)))
+            for name in catalogs[0].schema.getNames():
+                if name.startswith("base_"):
+                    np.testing.assert_array_equal(catalogs[0][name], catalogs[1][name], err_msg=name)
+
+    def testForced(self):
+        refCat = self.dataset.catalog
+        refWcs = self.dataset.exposure.getWcs()
+        exposure = self.dataset.realize(10.0, self.dataset.makeMinimalSchema(), randomSeed=8)[0]
+        catalogs = []
+        for sourceOrder in ("catalog", "hilbert"):
+            config = self.makeForcedMeasurementConfig("base_PsfFlux")
+            config.sourceOrder = sourceOrder
+            task = self.makeForcedMeasurementTask(config=config)
+            measCat = task.generateMeasCat(exposure, refCat, refWcs)
+            task.attachTransformedFootprints(measCat, refCat, exposure, refWcs)
+            task.run(measCat, exposure, refCat, refWcs, exposureId=1)
+            catalogs.append(measCat)
+        for name in ("base_PsfFlux_instFlux", "base_PsfFlux_instFluxErr", "base_PsfFlux_flag"):
+            np.testing.assert_array_equal(catalogs[0][name], catalogs[1][name], err_msg=name)
+
+
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
 
@@ -21,7 +21,10 @@
 
 import unittest
 
+import numpy as np
+
 import lsst.geom
+import lsst.meas.base
 from lsst.meas.base.tests import (AlgorithmTestCase, CentroidTransformTestCase,
                                   SingleFramePluginTransformSetupHelper)
 import lsst.utils.tests
@@ -52,6 +55,52 @@ class NaiveCentroidTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase):
         self.assertFloatsAlmostEqual(x, self.center.getX(), atol=None, rtol=.02)
         self.assertFloatsAlmostEqual(y, self.center.getY(), atol=None, rtol=.02)
 
+    def testEdgeStatus(self):
+        """Test that a source at the edge is reported by tryMeasure without
+        raising, and by measure as a MeasurementError.
+        """
+        schema = lsst.meas.base.tests.TestDataset.makeMinimalSchema()
+        algorithm = lsst.meas.base.NaiveCentroidAlgorithm(lsst.meas.base.NaiveCentroidControl(),
+                                                          "base_NaiveCentroid", schema)
+        exposure, catalog = self.dataset.realize(10.0, schema, randomSeed=0)
+        record = catalog[0]
+        status = algorithm.tryMeasure(record, exposure)
+        self.assertTrue(status.isSuccess())
+        record.set("truth_x", self.bbox.getMinX() + 0.2)
+        status = algorithm.tryMeasure(record, exposure)
+        self.assertFalse(status)
+        self.assertEqual(status.getFlagNumber(), lsst.meas.base.NaiveCentroidAlgorithm.EDGE.number)
+        with self.assertRaises(lsst.meas.base.MeasurementError) as context:
+            algorithm.measure(record, exposure)
+        self.assertEqual(context.exception.getFlagBit(), status.getFlagNumber())
+        # The batch entry point calls fail itself.
+        self.assertFalse(record.get("base_NaiveCentroid_flag_edge"))
+        algorithm.measureBatch(catalog, exposure, [0])
+        self.assertTrue(record.get("base_NaiveCentroid_flag"))
+        self.assertTrue(record.get("base_NaiveCentroid_flag_edge"))
+
+
+    def testMeasureBatch(self):
+        """Test that measureBatch gives the same results as measure, failing
+        only the records that fail.
+        """
+        self.dataset.addSource(50000.0, lsst.geom.Point2D(self.bbox.getMinX() + 0.2, 20.4))
+        self.dataset.addSource(80000.0, lsst.geom.Point2D(90.6, 100.3))
+        schema = lsst.meas.base.tests.TestDataset.makeMinimalSchema()
+        algorithm = lsst.meas.base.NaiveCentroidAlgorithm(lsst.meas.base.NaiveCentroidControl(),
+                                                          "base_NaiveCentroid", schema)
+        exposure, catalog = self.dataset.realize(10.0, schema, randomSeed=0)
+        batchCatalog = catalog.copy(deep=True)
+        for record in catalog:
+            try:
+                algorithm.measure(record, exposure)
+            except lsst.meas.base.MeasurementError as error:
+                algorithm.fail(record, error)
+        algorithm.measureBatch(batchCatalog, exposure, list(range(len(batchCatalog))))
+        self.assertEqual(list(batchCatalog["base_NaiveCentroid_flag_edge"]), [False, True, False])
+        for name in catalog.schema.extract("base_NaiveCentroid_*"):
+            np.testing.assert_array_equal(batchCatalog[name], catalog[name], err_msg=name)
+
 
 class NaiveCentroidTransformTestCase(CentroidTransformTestCase,
                                      SingleFramePluginTransformSetupHelper,
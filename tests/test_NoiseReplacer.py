@@ -57,6 +57,37 @@ class NoiseReplacerTestPlugin(lsst.meas.base.SingleFramePlugin):
         measRecord.set(self.insideKey, insideFlux)
         measRecord.set(self.outsideKey, outsideFlux)
 
+    def needsDetectionMasks(self):
+        return False
+
+
+@lsst.meas.base.register("test_DetectionMasks")
+class DetectionMasksTestPlugin(lsst.meas.base.SingleFramePlugin):
+    """Plugin that counts the footprint pixels marked THISDET and OTHERDET.
+
+    It relies on the default `needsDetectionMasks`, as plugins written before
+    that method existed do.
+    """
+
+    @staticmethod
+    def getExecutionOrder():
+        return 2.0
+
+    def __init__(self, config, name, schema, metadata):
+        lsst.meas.base.SingleFramePlugin.__init__(self, config, name, schema, metadata)
+        self.thisKey = schema.addField("%s_this" % (name,), type=np.int32,
+                                       doc="number of footprint pixels marked THISDET")
+        self.otherKey = schema.addField("%s_other" % (name,), type=np.int32,
+                                        doc="number of footprint pixels marked OTHERDET")
+
+    def measure(self, measRecord, exposure):
+        footprint = measRecord.getFootprint()
+        mask = exposure.getMaskedImage().getMask()
+        maskArray = np.zeros(footprint.getArea(), dtype=mask.getArray().dtype)
+        footprint.spans.flatten(maskArray, mask.getArray(), exposure.getXY0())
+        measRecord.set(self.thisKey, int(np.count_nonzero(maskArray & mask.getPlaneBitMask("THISDET"))))
+        measRecord.set(self.otherKey, int(np.count_nonzero(maskArray & mask.getPlaneBitMask("OTHERDET"))))
+
 
 class NoiseReplacerTestCase(lsst.meas.base.tests.AlgorithmTestCase, lsst.utils.tests.TestCase):
 
@@ -96,6 +127,91 @@ class NoiseReplacerTestCase(lsst.meas.base.tests.AlgorithmTestCase, lsst.utils.t
             # fail (indeed, 67% should)
             self.assertLess(record.get("test_NoiseReplacer_outside"), np.sqrt(sumVariance))
 
+    def testScratchImages(self):
+        """Test that noise replacement in scratch images leaves the exposure
+        untouched and measures the same inside fluxes.
+        """
+        task = self.makeSingleFrameMeasurementTask("test_NoiseReplacer")
+        exposure, catalog = self.dataset.realize(1.0, task.schema, randomSeed=0)
+        task.run(catalog, exposure)
+
+        config = self.makeSingleFrameMeasurementConfig("test_NoiseReplacer")
+        config.noiseReplacer.useScratchImages = True
+        scratchTask = self.makeSingleFrameMeasurementTask(config=config)
+        scratchExposure, scratchCatalog = self.dataset.realize(1.0, scratchTask.schema, randomSeed=0)
+        original = scratchExposure.getMaskedImage().getImage().getArray().copy()
+        scratchTask.run(scratchCatalog, scratchExposure)
+
+        self.assertFloatsEqual(scratchExposure.getMaskedImage().getImage().getArray(), original)
+        self.assertNotIn("THISDET", scratchExposure.getMaskedImage().getMask().getMaskPlaneDict())
+        for record, scratchRecord in zip(catalog, scratchCatalog):
+            self.assertEqual(scratchRecord.get("test_NoiseReplacer_inside"),
+                             record.get("test_NoiseReplacer_inside"))
+
+    def testCounterNoiseMatchesScratch(self):
+        """Test that in-place replacement with counter-based noise and scratch
+        images produce identical pixels, and that the exposure is restored.
+        """
+        schema = lsst.meas.base.tests.TestDataset.makeMinimalSchema()
+        exposure, catalog = self.dataset.realize(1.0, schema, randomSeed=0)
+        original = exposure.getMaskedImage().getImage().getArray().copy()
+        footprints = {record.getId(): (record.getParent(), record.getFootprint()) for record in catalog}
+        config = lsst.meas.base.NoiseReplacerConfig()
+        config.noiseRng = 'counter'
+        scratchReplacer = lsst.meas.base.ScratchNoiseReplacer(config, exposure, footprints, exposureId=5)
+        scratches = {record.getId(): scratchReplacer.insertSource(record.getId()) for record in catalog}
+        replacer = lsst.meas.base.NoiseReplacer(config, exposure, footprints, exposureId=5)
+        # Visit the sources in reverse order to check that it makes no difference.
+        for record in reversed(catalog):
+            replacer.insertSource(record.getId())
+            scratch = scratches[record.getId()]
+            inPlace = exposure.getMaskedImage().getImage()[scratch.getBBox()]
+            self.assertFloatsEqual(scratch.getMaskedImage().getImage().getArray(), inPlace.getArray())
+            replacer.removeSource(record.getId())
+        replacer.end()
+        scratchReplacer.end()
+        self.assertFloatsEqual(exposure.getMaskedImage().getImage().getArray(), original)
+
+    def testDetectionMasks(self):
+        """Test that the detection mask planes are only maintained when a
+        plugin needs them, and mark exactly the source being measured.
+        """
+        task = self.makeSingleFrameMeasurementTask("test_NoiseReplacer")
+        self.assertFalse(task.needsDetectionMasks())
+        # None of the plugins of this package read the planes.
+        self.assertFalse(self.makeSingleFrameMeasurementTask("base_PsfFlux").needsDetectionMasks())
+        exposure, catalog = self.dataset.realize(1.0, task.schema, randomSeed=0)
+        footprints = {record.getId(): (record.getParent(), record.getFootprint()) for record in catalog}
+        replacer = lsst.meas.base.NoiseReplacer(task.config.noiseReplacer, exposure, footprints,
+                                                detectionMasks=False)
+        self.assertNotIn("THISDET", exposure.getMaskedImage().getMask().getMaskPlaneDict())
+        replacer.end()
+
+        for useScratchImages in (False, True):
+            config = self.makeSingleFrameMeasurementConfig("test_NoiseReplacer",
+                                                           dependencies=("test_DetectionMasks",))
+            config.noiseReplacer.useScratchImages = useScratchImages
+            task = self.makeSingleFrameMeasurementTask(config=config)
+            self.assertTrue(task.needsDetectionMasks())
+            self.assertFalse(task.needsDetectionMasks(endOrder=1.0))
+            exposure, catalog = self.dataset.realize(1.0, task.schema, randomSeed=0)
+            task.run(catalog, exposure)
+            for record in catalog:
+                self.assertEqual(record.get("test_DetectionMasks_this"), record.getFootprint().getArea())
+                self.assertEqual(record.get("test_DetectionMasks_other"), 0)
+            self.assertNotIn("THISDET", exposure.getMaskedImage().getMask().getMaskPlaneDict())
+
+    def testCounterBasedNoise(self):
+        """Test that counter-based deviates are reproducible and unit normal.
+        """
+        noise = lsst.meas.base.CounterBasedNoise(12345)
+        values = np.array([noise.getDeviate(7, x, y) for y in range(100) for x in range(100)])
+        self.assertEqual(noise.getDeviate(7, 99, 99), values[-1])
+        self.assertNotEqual(noise.getDeviate(8, 99, 99), values[-1])
+        self.assertNotEqual(lsst.meas.base.CounterBasedNoise(12346).getDeviate(7, 99, 99), values[-1])
+        self.assertFloatsAlmostEqual(values.mean(), 0.0, atol=0.05)
+        self.assertFloatsAlmostEqual(values.std(), 1.0, rtol=0.05)
+
     def tearDown(self):
         del self.bbox
         del self.dataset
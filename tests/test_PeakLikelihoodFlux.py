@@ -21,10 +21,89 @@
 
 import unittest
 
+import numpy as np
+
+import lsst.geom
+import lsst.afw.image
+import lsst.afw.math
 import lsst.meas.base
+import lsst.meas.base.tests
 import lsst.utils.tests
 
-from lsst.meas.base.tests import FluxTransformTestCase, SingleFramePluginTransformSetupHelper
+from lsst.meas.base.tests import (AlgorithmTestCase, FluxTransformTestCase,
+                                  SingleFramePluginTransformSetupHelper)
+
+
+class PeakLikelihoodFluxTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase):
+
+    def setUp(self):
+        self.bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0),
+                                    lsst.geom.Extent2I(100, 100))
+        self.dataset = lsst.meas.base.tests.TestDataset(self.bbox)
+        # Fractional offsets of both signs, to exercise both kernel centers
+        self.dataset.addSource(100000.0, lsst.geom.Point2D(30.3, 29.8))
+        self.dataset.addSource(80000.0, lsst.geom.Point2D(70.9, 30.1))
+        self.dataset.addSource(60000.0, lsst.geom.Point2D(30.5, 70.45))
+        self.dataset.addSource(40000.0, lsst.geom.Point2D(69.55, 70.0))
+
+    def tearDown(self):
+        del self.bbox
+        del self.dataset
+
+    def computeReference(self, exposure, center, warpingKernelName):
+        """Compute the PeakLikelihood flux and its error directly with a
+        full 2-d warping kernel image.
+        """
+        index = [int(np.floor(value + 0.5)) for value in center]
+        frac = [value - i for value, i in zip(center, index)]
+        kernel = lsst.afw.math.makeWarpingKernel(warpingKernelName)
+        kernelCtr = lsst.geom.Extent2I(kernel.getCtr())
+        kernelCtr += lsst.geom.Extent2I(1 if frac[0] < 0 else 0, 1 if frac[1] < 0 else 0)
+        kernel.setCtr(lsst.geom.Point2I(kernelCtr))
+        kernel.setKernelParameters(frac)
+        kernelImage = lsst.afw.image.ImageD(kernel.getDimensions())
+        kernel.computeImage(kernelImage, True)
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(*index) - kernelCtr, kernel.getDimensions())
+        subImage = exposure.getMaskedImage().Factory(exposure.getMaskedImage(), bbox,
+                                                     lsst.afw.image.PARENT)
+        weights = kernelImage.getArray()
+        value = np.sum(weights*subImage.getImage().getArray())
+        variance = np.sum(weights**2*subImage.getVariance().getArray())
+        psfImage = exposure.getPsf().computeImage(lsst.geom.Point2D(*index)).getArray()
+        weight = np.sum(psfImage)**2/np.sum(psfImage**2)
+        return value*weight, np.sqrt(variance)*weight
+
+    def testMatchesWarpingKernel(self):
+        """Test that the tabulated kernel weights reproduce a direct
+        evaluation of the warping kernel.
+        """
+        for warpingKernelName in ("lanczos4", "lanczos3", "bilinear"):
+            with self.subTest(warpingKernelName=warpingKernelName):
+                ctrl = lsst.meas.base.PeakLikelihoodFluxControl()
+                ctrl.warpingKernelName = warpingKernelName
+                schema = lsst.meas.base.tests.TestDataset.makeMinimalSchema()
+                algorithm = lsst.meas.base.PeakLikelihoodFluxAlgorithm(ctrl, "base_PeakLikelihoodFlux",
+                                                                       schema)
+                exposure, catalog = self.dataset.realize(10.0, schema, randomSeed=0)
+                for record in catalog:
+                    algorithm.measure(record, exposure)
+                    instFlux, instFluxErr = self.computeReference(exposure, record.getCentroid(),
+                                                                  warpingKernelName)
+                    self.assertFloatsAlmostEqual(record.get("base_PeakLikelihoodFlux_instFlux"),
+                                                 instFlux, rtol=1E-5)
+                    self.assertFloatsAlmostEqual(record.get("base_PeakLikelihoodFlux_instFluxErr"),
+                                                 instFluxErr, rtol=1E-5)
+
+    def testEdge(self):
+        """Test that a source too close to the edge for the warping kernel
+        is flagged.
+        """
+        dataset = lsst.meas.base.tests.TestDataset(self.bbox)
+        dataset.addSource(100000.0, lsst.geom.Point2D(1.2, 50.3))
+        task = self.makeSingleFrameMeasurementTask("base_PeakLikelihoodFlux")
+        exposure, catalog = dataset.realize(10.0, task.schema, randomSeed=0)
+        task.run(catalog, exposure)
+        self.assertTrue(catalog[0].get("base_PeakLikelihoodFlux_flag"))
 
 
 class PeakLikelihoodFluxTransformTestCase(FluxTransformTestCase,
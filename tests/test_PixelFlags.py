@@ -22,6 +22,7 @@
 import unittest
 
 import lsst.geom
+import lsst.afw.image
 import lsst.utils.tests
 import lsst.meas.base.tests
 
@@ -55,6 +56,30 @@ class PixelFlagsTestCase(lsst.meas.base.tests.AlgorithmTestCase, lsst.utils.test
         self.assertFalse(record.get("base_PixelFlags_flag_crCenter"))
         self.assertFalse(record.get("base_PixelFlags_flag_bad"))
 
+    def testMaskBits(self):
+        """Test that mask bits in the center and the rest of the footprint
+        set the right flags, whether sources are measured one at a time or
+        as a batch.
+        """
+        for doReplaceWithNoise in (True, False):
+            config = self.makeSingleFrameMeasurementConfig("base_PixelFlags")
+            config.doReplaceWithNoise = doReplaceWithNoise
+            task = self.makeSingleFrameMeasurementTask(config=config)
+            exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+            mask = exposure.getMaskedImage().getMask()
+            center = lsst.geom.Point2I(self.center)
+            mask[center.getX() + 1, center.getY(), lsst.afw.image.PARENT] |= mask.getPlaneBitMask("CR")
+            mask[center.getX() + 5, center.getY(), lsst.afw.image.PARENT] |= mask.getPlaneBitMask("SAT")
+            task.run(catalog, exposure)
+            record = catalog[0]
+            self.assertFalse(record.get("base_PixelFlags_flag"))
+            self.assertTrue(record.get("base_PixelFlags_flag_cr"))
+            self.assertTrue(record.get("base_PixelFlags_flag_crCenter"))
+            self.assertTrue(record.get("base_PixelFlags_flag_saturated"))
+            self.assertFalse(record.get("base_PixelFlags_flag_saturatedCenter"))
+            self.assertFalse(record.get("base_PixelFlags_flag_edge"))
+            self.assertFalse(record.get("base_PixelFlags_flag_bad"))
+
 
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
@@ -0,0 +1,217 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+import unittest
+
+import numpy as np
+
+import lsst.geom
+import lsst.afw.table
+import lsst.pex.exceptions
+import lsst.utils.tests
+import lsst.meas.base
+import lsst.meas.base.tests
+from lsst.meas.base import PluginChain
+
+
+class PluginChainTestCase(lsst.meas.base.tests.AlgorithmTestCase, lsst.utils.tests.TestCase):
+
+    def setUp(self):
+        self.bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(100, 100))
+        self.dataset = lsst.meas.base.tests.TestDataset(self.bbox)
+        self.dataset.addSource(100000.0, lsst.geom.Point2D(30.2, 40.6))
+        self.dataset.addSource(50000.0, lsst.geom.Point2D(70.5, 60.1))
+        # Too close to the edge for most plugins to succeed, so failures are handled by the chain.
+        self.dataset.addSource(20000.0, lsst.geom.Point2D(1.2, 80.7))
+
+    def tearDown(self):
+        del self.bbox
+        del self.dataset
+
+    def assertCatalogsEqual(self, catalog1, catalog2):
+        for item in catalog1.schema:
+            name = item.field.getName()
+            if item.field.getTypeString() not in ("Flag", "F", "D", "I", "L"):
+                continue
+            np.testing.assert_array_equal(catalog1.get(name), catalog2.get(name), err_msg=name)
+
+    def testSingleFrame(self):
+        """Test that chaining the C++ plugins does not change single-frame
+        measurements, and that Python plugins are still run in order.
+        """
+        plugins = ["base_SdssCentroid", "base_PeakCentroid", "base_SdssShape", "base_PsfFlux",
+                   "base_GaussianFlux"]
+        results = {}
+        for doPluginChain in (False, True):
+            config = self.makeSingleFrameMeasurementConfig(plugin=plugins[0], dependencies=plugins[1:])
+            config.doPluginChain = doPluginChain
+            task = self.makeSingleFrameMeasurementTask(config=config)
+            exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+            task.run(catalog, exposure)
+            results[doPluginChain] = catalog
+        self.assertCatalogsEqual(results[True], results[False])
+        self.assertTrue(results[True][-1].get("base_PsfFlux_flag_edge"))
+        steps = task._getMeasureSteps()
+        chains = [step for step in steps if isinstance(step, PluginChain)]
+        self.assertEqual(len(chains), 1)
+        self.assertEqual(len(chains[0]), 4)
+        self.assertIn(task.plugins["base_PeakCentroid"], steps)
+        # The chain honors execution order bounds.
+        self.assertEqual(chains[0].getMinExecutionOrder(), lsst.meas.base.BasePlugin.CENTROID_ORDER)
+        self.assertEqual(chains[0].getMaxExecutionOrder(), lsst.meas.base.BasePlugin.FLUX_ORDER)
+        record = results[True][0]
+        record.set("base_PsfFlux_instFlux", np.nan)
+        record.set("base_SdssShape_xx", np.nan)
+        chains[0].measure(record, exposure, beginOrder=lsst.meas.base.BasePlugin.FLUX_ORDER)
+        self.assertTrue(np.isnan(record.get("base_SdssShape_xx")))
+        self.assertEqual(record.get("base_PsfFlux_instFlux"), results[False][0].get("base_PsfFlux_instFlux"))
+
+    def testForced(self):
+        """Test that chaining the C++ plugins does not change forced
+        measurements.
+        """
+        results = {}
+        for doPluginChain in (False, True):
+            config = self.makeForcedMeasurementConfig(plugin="base_PsfFlux",
+                                                      dependencies=["base_GaussianFlux"])
+            config.doPluginChain = doPluginChain
+            task = self.makeForcedMeasurementTask(config=config)
+            measWcs = self.dataset.makePerturbedWcs(self.dataset.exposure.getWcs(), randomSeed=1)
+            measDataset = self.dataset.transform(measWcs)
+            exposure, truthCatalog = measDataset.realize(10.0, measDataset.makeMinimalSchema(), randomSeed=1)
+            refCat = self.dataset.catalog
+            refWcs = self.dataset.exposure.getWcs()
+            measCat = task.generateMeasCat(exposure, refCat, refWcs)
+            task.attachTransformedFootprints(measCat, refCat, exposure, refWcs)
+            task.run(measCat, exposure, refCat, refWcs)
+            results[doPluginChain] = measCat
+        self.assertCatalogsEqual(results[True], results[False])
+        self.assertTrue(any(isinstance(step, PluginChain) for step in task._getMeasureSteps()))
+
+    def testPreconditions(self):
+        """Test that plugins whose preconditions do not hold are failed
+        without being run, whether or not they are chained.
+        """
+        plugins = ["base_SdssCentroid", "base_SdssShape", "base_PsfFlux", "base_GaussianFlux",
+                   "base_PeakLikelihoodFlux"]
+        results = {}
+        for doPluginChain in (False, True):
+            config = self.makeSingleFrameMeasurementConfig(plugin=plugins[0], dependencies=plugins[1:])
+            config.doPluginChain = doPluginChain
+            config.doPreconditions = True
+            config.slots.centroid = "base_SdssCentroid"
+            config.slots.shape = "base_SdssShape"
+            task = self.makeSingleFrameMeasurementTask(config=config)
+            exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+            task.run(catalog, exposure)
+            # Move one source off the image (but close enough for its PSF model to overlap it), and
+            # fail the shape of another, then measure their fluxes again.
+            catalog[0].set("base_SdssCentroid_x", -3.0)
+            catalog[1].set("base_SdssShape_xx", np.nan)
+            catalog[1].set("base_SdssShape_flag", True)
+            for record in catalog[:2]:
+                for name in ("base_PsfFlux", "base_GaussianFlux", "base_PeakLikelihoodFlux"):
+                    record.set(name + "_instFlux", np.nan)
+                    record.set(name + "_flag", False)
+                task.callMeasure(record, exposure, beginOrder=lsst.meas.base.BasePlugin.FLUX_ORDER)
+            results[doPluginChain] = catalog
+        self.assertCatalogsEqual(results[True], results[False])
+        offImage, badShape = results[True][0], results[True][1]
+        # PsfFlux only requires a centroid, so it still measures (and flags) sources off the edge.
+        self.assertTrue(offImage.get("base_PsfFlux_flag"))
+        self.assertTrue(offImage.get("base_PsfFlux_flag_edge"))
+        self.assertTrue(np.isfinite(offImage.get("base_PsfFlux_instFlux")))
+        # PeakLikelihoodFlux cannot measure a source whose centroid is off the image at all.
+        self.assertTrue(offImage.get("base_PeakLikelihoodFlux_flag"))
+        self.assertTrue(np.isnan(offImage.get("base_PeakLikelihoodFlux_instFlux")))
+        self.assertTrue(badShape.get("base_GaussianFlux_flag"))
+        self.assertTrue(np.isnan(badShape.get("base_GaussianFlux_instFlux")))
+        self.assertFalse(badShape.get("base_PsfFlux_flag"))
+        self.assertTrue(np.isfinite(badShape.get("base_PsfFlux_instFlux")))
+
+    def testSourceConditions(self):
+        Preconditions = lsst.meas.base.Preconditions
+        config = self.makeSingleFrameMeasurementConfig(plugin="base_SdssCentroid")
+        task = self.makeSingleFrameMeasurementTask(config=config)
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+        task.run(catalog, exposure)
+        record = catalog[1]
+        conditions = lsst.meas.base.SourceConditions(record, exposure)
+        self.assertTrue(conditions.hasCentroid())
+        self.assertTrue(conditions.isOnImage())
+        self.assertEqual(conditions.getGoodPixelFraction(), 1.0)
+        preconditions = Preconditions().require(Preconditions.CENTROID).requireGoodPixelFraction(0.5, 3)
+        self.assertEqual(preconditions.getFlagBit(Preconditions.GOOD_PIXELS), 3)
+        self.assertEqual(preconditions.getFlagBit(Preconditions.CENTROID), -1)
+        self.assertEqual(conditions.check(preconditions), Preconditions.NONE)
+        # Mask the pixels of the left half of the footprint as bad.
+        bad = exposure.mask.getPlaneBitMask("BAD")
+        spans = record.getFootprint().spans
+        x0 = exposure.getX0()
+        xMid = int(record.getX())
+        for span in spans:
+            exposure.mask.array[span.getY() - exposure.getY0(), span.getMinX() - x0:xMid - x0] |= bad
+        fraction = lsst.meas.base.SourceConditions(record, exposure, bad).getGoodPixelFraction()
+        self.assertGreater(fraction, 0.25)
+        self.assertLess(fraction, 0.75)
+        strict = Preconditions().requireGoodPixelFraction(0.9)
+        self.assertEqual(lsst.meas.base.SourceConditions(record, exposure, bad).check(strict),
+                         Preconditions.GOOD_PIXELS)
+        # A NaN centroid is only replaced by the peak if it is flagged.
+        record.set("base_SdssCentroid_x", np.nan)
+        record.set("base_SdssCentroid_flag", False)
+        self.assertFalse(lsst.meas.base.SourceConditions(record, exposure).hasCentroid())
+        record.set("base_SdssCentroid_flag", True)
+        self.assertTrue(lsst.meas.base.SourceConditions(record, exposure).hasCentroid())
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            Preconditions().requireGoodPixelFraction(1.5)
+
+    def testInvalidChains(self):
+        schema = lsst.meas.base.tests.TestDataset.makeMinimalSchema()
+        psfFlux = lsst.meas.base.PsfFluxAlgorithm(lsst.meas.base.PsfFluxControl(), "base_PsfFlux", schema)
+        naive = lsst.meas.base.NaiveCentroidAlgorithm(lsst.meas.base.NaiveCentroidControl(),
+                                                      "base_NaiveCentroid", schema)
+        chain = PluginChain()
+        self.assertTrue(chain.empty())
+        chain.addSingleFrame(psfFlux, lsst.meas.base.BasePlugin.FLUX_ORDER)
+        # Execution orders must not decrease.
+        with self.assertRaises(lsst.pex.exceptions.LogicError):
+            chain.addSingleFrame(naive, lsst.meas.base.BasePlugin.CENTROID_ORDER)
+        # Single-frame and forced algorithms cannot be mixed.
+        with self.assertRaises(lsst.pex.exceptions.LogicError):
+            chain.addForced(psfFlux, lsst.meas.base.BasePlugin.FLUX_ORDER)
+        self.assertEqual(len(chain), 1)
+        chain.setLogName(0, "measurement.base_PsfFlux")
+        with self.assertRaises(lsst.pex.exceptions.OutOfRangeError):
+            chain.setLogName(1, "measurement.base_NaiveCentroid")
+
+
+class TestMemory(lsst.utils.tests.MemoryTestCase):
+    pass
+
+
+def setup_module(module):
+    lsst.utils.tests.init()
+
+
+if __name__ == "__main__":
+    lsst.utils.tests.init()
+    unittest.main()
@@ -0,0 +1,310 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+import json
+import os
+import tempfile
+import unittest
+
+import lsst.geom
+import lsst.afw.table
+import lsst.pex.exceptions
+import lsst.utils.tests
+import lsst.meas.base.tests
+from lsst.meas.base import PluginTimer, ScratchArena, TraceRecorder
+from lsst.meas.base.measurementInvestigationLib import getSlowSources, rerunSlowSources
+
+
+class PluginTimerTestCase(lsst.utils.tests.TestCase):
+
+    def testRecord(self):
+        timer = PluginTimer(doHistogram=True)
+        timer.record("a", 2E-6)
+        timer.record("a", 1.5E-3, nSources=3, nFailures=1)
+        timer.record("b", 20.0)
+        self.assertEqual(timer.getNames(), ["a", "b"])
+        self.assertIsNone(timer.getTiming("c"))
+        timing = timer.getTiming("a")
+        self.assertEqual(timing.calls, 4)
+        self.assertEqual(timing.failures, 1)
+        self.assertFloatsAlmostEqual(timing.wallTime, 1.502E-3, rtol=1E-12)
+        self.assertEqual(timing.histogram, [0, 1, 0, 3, 0, 0, 0, 0, 0])
+        self.assertEqual(timer.getTiming("b").histogram[-1], 1)
+
+
+class TraceRecorderTestCase(lsst.utils.tests.TestCase):
+
+    def testSampling(self):
+        ids = range(1, 10001)
+        self.assertTrue(all(TraceRecorder(1.0).isSampled(i) for i in ids))
+        self.assertFalse(any(TraceRecorder(0.0).isSampled(i) for i in ids))
+        recorder = TraceRecorder(0.25)
+        sampled = [i for i in ids if recorder.isSampled(i)]
+        self.assertEqual(sampled, [i for i in ids if TraceRecorder(0.25).isSampled(i)])
+        self.assertFloatsAlmostEqual(len(sampled)/len(ids), 0.25, atol=0.02)
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            TraceRecorder(1.5)
+
+    def testFamilies(self):
+        """Test that deblended sources are sampled with their top-level
+        parent, however deep they are.
+        """
+        catalog = lsst.afw.table.SourceCatalog(lsst.afw.table.SourceTable.makeMinimalSchema())
+        parent = catalog.addNew()
+        child = catalog.addNew()
+        child.setParent(parent.getId())
+        grandchild = catalog.addNew()
+        grandchild.setParent(child.getId())
+        recorder = TraceRecorder(0.5)
+        self.assertEqual(recorder.getFamilyId(child), parent.getId())
+        self.assertEqual(recorder.getFamilyId(grandchild), child.getId())
+        recorder.setFamilies(catalog)
+        for record in catalog:
+            self.assertEqual(recorder.getFamilyId(record), parent.getId())
+
+    def testWrite(self):
+        recorder = TraceRecorder()
+        start = recorder.now()
+        recorder.record("a\"b", "test", start, start + 2500, 7)
+        recorder.record("c", "test", start + 3000, start + 4000)
+        self.assertEqual(len(recorder), 2)
+        events = recorder.getEvents()
+        self.assertEqual(events[0].duration, 2500)
+        self.assertEqual(events[0].thread, TraceRecorder.getThreadIndex())
+        with tempfile.TemporaryDirectory() as tempDir:
+            filename = os.path.join(tempDir, "trace.json")
+            recorder.writeChromeTrace(filename)
+            with open(filename) as stream:
+                trace = json.load(stream)
+        written = trace["traceEvents"]
+        self.assertEqual([event["name"] for event in written], ["a\"b", "c"])
+        self.assertEqual(written[0]["ph"], "X")
+        self.assertFloatsAlmostEqual(written[0]["dur"], 2.5)
+        self.assertEqual(written[0]["args"]["id"], 7)
+        recorder.clear()
+        self.assertEqual(len(recorder), 0)
+
+
+class PluginTimingTestCase(lsst.meas.base.tests.AlgorithmTestCase, lsst.utils.tests.TestCase):
+
+    def setUp(self):
+        self.bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(100, 100))
+        self.dataset = lsst.meas.base.tests.TestDataset(self.bbox)
+        self.dataset.addSource(100000.0, lsst.geom.Point2D(30.2, 40.6))
+        self.dataset.addSource(50000.0, lsst.geom.Point2D(70.5, 60.1))
+
+    def tearDown(self):
+        del self.bbox
+        del self.dataset
+
+    def testMetadata(self):
+        """Test that timing is written to the task metadata only when enabled,
+        and does not change the measurements.
+        """
+        plugins = ["base_SdssCentroid", "base_PsfFlux"]
+        results = {}
+        for doTiming in (False, True):
+            config = self.makeSingleFrameMeasurementConfig(plugin=plugins[0], dependencies=plugins[1:])
+            config.doTiming = doTiming
+            config.doTimingHistogram = doTiming
+            task = self.makeSingleFrameMeasurementTask(config=config)
+            exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+            task.run(catalog, exposure)
+            results[doTiming] = catalog
+            metadata = task.algMetadata
+            self.assertEqual(metadata.exists("TIMING_SCRATCH_BUFFERS"), doTiming)
+            if doTiming:
+                # SdssCentroid bins the neighborhood of each source into two scratch buffers
+                self.assertGreaterEqual(metadata.getScalar("TIMING_SCRATCH_BUFFERS"), 2*len(catalog))
+            for name in plugins:
+                if not doTiming:
+                    self.assertFalse(metadata.exists("TIMING_%s_WALLTIME" % name))
+                    continue
+                self.assertEqual(metadata.getScalar("TIMING_%s_CALLS" % name), len(catalog))
+                self.assertEqual(metadata.getScalar("TIMING_%s_FAILURES" % name), 0)
+                self.assertGreater(metadata.getScalar("TIMING_%s_WALLTIME" % name), 0.0)
+                self.assertEqual(metadata.getScalar("TIMING_%s_CPPCALLS" % name), len(catalog))
+                self.assertLessEqual(metadata.getScalar("TIMING_%s_CPPTIME" % name),
+                                     metadata.getScalar("TIMING_%s_WALLTIME" % name))
+                self.assertEqual(sum(metadata.getArray("TIMING_%s_HISTOGRAM" % name)), len(catalog))
+            for plugin in task.plugins.values():
+                self.assertIsNone(plugin.getTiming())
+        self.assertFloatsEqual(results[True].get("base_PsfFlux_instFlux"),
+                               results[False].get("base_PsfFlux_instFlux"))
+
+    def testSlowSources(self):
+        """Test that the slowest calls are recorded in the metadata and can
+        be re-measured with the same results.
+        """
+        plugins = ["base_SdssCentroid", "base_SdssShape"]
+        config = self.makeSingleFrameMeasurementConfig(plugin=plugins[0], dependencies=plugins[1:])
+        config.doTiming = True
+        config.timingSlowSourceCount = 3
+        task = self.makeSingleFrameMeasurementTask(config=config)
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+        task.run(catalog, exposure)
+        metadata = task.algMetadata
+        slowSources = getSlowSources(metadata)
+        self.assertEqual(len(slowSources), 3)
+        wallTimes = metadata.getArray("TIMING_SLOW_WALLTIMES")
+        self.assertEqual(wallTimes, sorted(wallTimes, reverse=True))
+        records = {record.getId(): record for record in catalog}
+        for i, (srcId, name) in enumerate(slowSources):
+            self.assertIn(name, plugins)
+            footprint = records[srcId].getFootprint()
+            self.assertEqual(metadata.getArray("TIMING_SLOW_AREAS")[i], footprint.getArea())
+            self.assertEqual(metadata.getArray("TIMING_SLOW_MINX")[i], footprint.getBBox().getMinX())
+            self.assertEqual(metadata.getArray("TIMING_SLOW_MAXY")[i], footprint.getBBox().getMaxY())
+            nIter = records[srcId].get("base_SdssShape_nIter") if name == "base_SdssShape" else -1
+            self.assertEqual(metadata.getArray("TIMING_SLOW_NITER")[i], nIter)
+
+        # Only calls on a single record are candidates.
+        timer = PluginTimer(nSlowest=2)
+        timer.record("a", 1.0, measRecord=catalog[0])
+        timer.record("a", 3.0, measRecord=catalog[1])
+        timer.record("b", 2.0, measRecord=catalog[0])
+        timer.record("b", 5.0, nSources=2)
+        self.assertEqual([(slow.plugin, slow.wallTime) for slow in timer.getSlowest()],
+                         [("a", 3.0), ("b", 2.0)])
+
+        original = exposure.getMaskedImage().getImage().getArray().copy()
+        reruns = rerunSlowSources(task, exposure, catalog, nRepeats=2)
+        self.assertFloatsEqual(exposure.getMaskedImage().getImage().getArray(), original)
+        self.assertEqual([(rerun.id, rerun.plugin) for rerun in reruns], slowSources)
+        for rerun in reruns:
+            self.assertEqual(len(rerun.wallTimes), 2)
+            for field in ("x", "y") if rerun.plugin == "base_SdssCentroid" else ("xx", "yy", "xy"):
+                self.assertEqual(rerun.record.get("%s_%s" % (rerun.plugin, field)),
+                                 records[rerun.id].get("%s_%s" % (rerun.plugin, field)))
+
+    def testSlowUndeblendedSources(self):
+        """Test re-measuring slow calls of undeblended plugins, which measure
+        the image without noise replacement.
+        """
+        plugins = ["base_SdssCentroid", "base_SdssShape"]
+        config = self.makeSingleFrameMeasurementConfig(plugin=plugins[0], dependencies=plugins[1:])
+        config.undeblended.names = ["base_SdssShape"]
+        config.doTiming = True
+        config.timingSlowSourceCount = 1000
+        task = self.makeSingleFrameMeasurementTask(config=config)
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+        task.run(catalog, exposure)
+        slowSources = getSlowSources(task.algMetadata)
+        self.assertIn("undeblended_base_SdssShape", [name for srcId, name in slowSources])
+        records = {record.getId(): record for record in catalog}
+        reruns = rerunSlowSources(task, exposure, catalog)
+        self.assertEqual([(rerun.id, rerun.plugin) for rerun in reruns], slowSources)
+        for rerun in reruns:
+            if rerun.plugin == "base_SdssCentroid":
+                continue
+            for field in ("xx", "yy", "xy"):
+                self.assertEqual(rerun.record.get("%s_%s" % (rerun.plugin, field)),
+                                 records[rerun.id].get("%s_%s" % (rerun.plugin, field)))
+
+    def testTrace(self):
+        """Test that a traced run writes nested family, source, plugin and
+        compiled-code events, and does not change the measurements.
+        """
+        with self.dataset.addBlend() as family:
+            family.addChild(60000.0, lsst.geom.Point2D(40.3, 75.2))
+            family.addChild(40000.0, lsst.geom.Point2D(46.8, 77.1))
+        plugins = ["base_SdssCentroid", "base_PsfFlux"]
+        config = self.makeSingleFrameMeasurementConfig(plugin=plugins[0], dependencies=plugins[1:])
+        task = self.makeSingleFrameMeasurementTask(config=config)
+        exposure, expected = self.dataset.realize(10.0, task.schema, randomSeed=0)
+        task.run(expected, exposure)
+        with tempfile.TemporaryDirectory() as tempDir:
+            config.traceFile = os.path.join(tempDir, "trace.json")
+            task = self.makeSingleFrameMeasurementTask(config=config)
+            exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+            task.run(catalog, exposure)
+            self.assertIsNone(task.tracer)
+            with open(config.traceFile) as stream:
+                events = json.load(stream)["traceEvents"]
+        self.assertFloatsEqual(catalog.get("base_PsfFlux_instFlux"), expected.get("base_PsfFlux_instFlux"))
+        self.assertGreater(len(catalog.getChildren(0)), 0)
+        for record in catalog:
+            recordEvents = [event for event in events if event["args"]["id"] == record.getId()]
+            names = {(event["cat"], event["name"]) for event in recordEvents}
+            self.assertIn(("source", "source"), names)
+            self.assertIn(("noise", "insertSource"), names)
+            for name in plugins:
+                self.assertIn(("plugin", name), names)
+                self.assertIn(("cpp", name), names)
+            # children are measured within their parent's family event
+            familyId = record.getParent() or record.getId()
+            family = [event for event in events
+                      if event["cat"] == "family" and event["args"]["id"] == familyId][0]
+            for event in recordEvents:
+                self.assertGreaterEqual(event["ts"], family["ts"])
+                self.assertLessEqual(event["ts"] + event["dur"], family["ts"] + family["dur"] + 1E-3)
+
+        # a family's events are kept or dropped together
+        config.traceSampleFraction = 0.5
+        with tempfile.TemporaryDirectory() as tempDir:
+            config.traceFile = os.path.join(tempDir, "trace.json")
+            task = self.makeSingleFrameMeasurementTask(config=config)
+            exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+            task.run(catalog, exposure)
+            with open(config.traceFile) as stream:
+                tracedIds = {event["args"]["id"] for event in json.load(stream)["traceEvents"]}
+        for record in catalog:
+            familyId = record.getParent() or record.getId()
+            self.assertEqual(record.getId() in tracedIds, familyId in tracedIds)
+            self.assertEqual(record.getId() in tracedIds, TraceRecorder(0.5).isSampled(familyId))
+
+        config.traceSampleFraction = 0.0
+        with tempfile.TemporaryDirectory() as tempDir:
+            config.traceFile = os.path.join(tempDir, "trace.json")
+            task = self.makeSingleFrameMeasurementTask(config=config)
+            exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+            task.run(catalog, exposure)
+            with open(config.traceFile) as stream:
+                self.assertEqual(json.load(stream)["traceEvents"], [])
+
+    def testScratchReuse(self):
+        """Test that measuring again reuses the scratch memory of the first
+        pass instead of allocating more.
+        """
+        config = self.makeSingleFrameMeasurementConfig(plugin="base_SdssCentroid",
+                                                       dependencies=["base_PsfFlux"])
+        task = self.makeSingleFrameMeasurementTask(config=config)
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+        task.run(catalog, exposure)
+        ScratchArena.resetStatistics()
+        task.run(catalog, exposure)
+        statistics = ScratchArena.getStatistics()
+        self.assertGreaterEqual(statistics.buffers, 2*len(catalog))
+        self.assertEqual(statistics.blocks, 0)
+        self.assertEqual(statistics.blockBytes, 0)
+
+
+class TestMemory(lsst.utils.tests.MemoryTestCase):
+    pass
+
+
+def setup_module(module):
+    lsst.utils.tests.init()
+
+
+if __name__ == "__main__":
+    lsst.utils.tests.init()
+    unittest.main()
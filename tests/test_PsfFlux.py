@@ -26,6 +26,7 @@ import numpy as np
 import lsst.geom
 import lsst.afw.image
 import lsst.afw.table
+import lsst.pex.exceptions
 import lsst.utils.tests
 
 from lsst.meas.base.tests import (AlgorithmTestCase, FluxTransformTestCase,
@@ -105,6 +106,71 @@ class PsfFluxTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase):
                                      atol=3*record.get("base_PsfFlux_instFluxErr"))
         self.assertTrue(record.get("base_PsfFlux_flag_edge"))
 
+    def testEdgeFlagsKeptOnFailure(self):
+        """Test that flags set before a failure are written to the record.
+        """
+        ctrl = lsst.meas.base.PsfFluxControl()
+        ctrl.badMaskPlanes = ["BAD"]
+        algorithm, schema = self.makeAlgorithm(ctrl)
+        exposure, catalog = self.dataset.realize(10.0, schema, randomSeed=1)
+        record = catalog[0]
+        bbox = exposure.getPsf().computeImage(record.getCentroid()).getBBox()
+        bbox.grow(-1)
+        subExposure = exposure.Factory(exposure, bbox, lsst.afw.image.LOCAL)
+        subExposure.getMaskedImage().getMask().getArray()[:, :] |= \
+            subExposure.getMaskedImage().getMask().getPlaneBitMask("BAD")
+        for name in ("flag", "flag_edge", "flag_noGoodPixels"):
+            self.assertFalse(record.get("base_PsfFlux_" + name))
+        with self.assertRaises(lsst.meas.base.MeasurementError) as context:
+            algorithm.measure(record, subExposure)
+        algorithm.fail(record, context.exception.cpp)
+        for name in ("flag", "flag_edge", "flag_noGoodPixels"):
+            self.assertTrue(record.get("base_PsfFlux_" + name), name)
+
+        # An unknown mask plane is only discovered after the edge has been found.
+        ctrl.badMaskPlanes = ["NOT_A_MASK_PLANE"]
+        algorithm, schema = self.makeAlgorithm(ctrl)
+        exposure, catalog = self.dataset.realize(10.0, schema, randomSeed=1)
+        record = catalog[0]
+        subExposure = exposure.Factory(exposure, bbox, lsst.afw.image.LOCAL)
+        with self.assertRaises(lsst.pex.exceptions.Exception):
+            algorithm.measure(record, subExposure)
+        algorithm.fail(record)
+        self.assertTrue(record.get("base_PsfFlux_flag"))
+        self.assertTrue(record.get("base_PsfFlux_flag_edge"))
+
+    def testWeighted(self):
+        """Test the inverse-variance weighted fit.
+
+        With a constant variance plane it must agree with the unweighted fit,
+        and otherwise its uncertainty must be no larger.
+        """
+        algorithm, schema = self.makeAlgorithm()
+        ctrl = lsst.meas.base.PsfFluxControl()
+        ctrl.useWeights = True
+        weightedAlgorithm, _ = self.makeAlgorithm(ctrl)
+        exposure, catalog = self.dataset.realize(10.0, schema, randomSeed=4)
+        record = catalog[0]
+        variance = exposure.getMaskedImage().getVariance().getArray()
+        original = variance.copy()
+
+        variance[:, :] = 100.0
+        algorithm.measure(record, exposure)
+        unweighted = (record.get("base_PsfFlux_instFlux"), record.get("base_PsfFlux_instFluxErr"),
+                      record.get("base_PsfFlux_area"))
+        weightedAlgorithm.measure(record, exposure)
+        self.assertFloatsAlmostEqual(record.get("base_PsfFlux_instFlux"), unweighted[0], rtol=1E-10)
+        self.assertFloatsAlmostEqual(record.get("base_PsfFlux_instFluxErr"), unweighted[1], rtol=1E-10)
+        self.assertFloatsAlmostEqual(record.get("base_PsfFlux_area"), unweighted[2], rtol=1E-6)
+
+        variance[:, :] = original
+        algorithm.measure(record, exposure)
+        unweightedErr = record.get("base_PsfFlux_instFluxErr")
+        weightedAlgorithm.measure(record, exposure)
+        self.assertLessEqual(record.get("base_PsfFlux_instFluxErr"), unweightedErr)
+        self.assertFloatsAlmostEqual(record.get("base_PsfFlux_instFlux"), record.get("truth_instFlux"),
+                                     atol=3*record.get("base_PsfFlux_instFluxErr"))
+
     def testNoPsf(self):
         """Test that we raise `FatalAlgorithmError` when there's no PSF.
         """
@@ -150,6 +216,94 @@ class PsfFluxTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase):
             self.assertFloatsAlmostEqual(instFluxErrMean, instFluxStandardDeviation, rtol=0.10)
             self.assertLess(instFluxMean - instFlux, 2.0*instFluxErrMean / nSamples**0.5)
 
+    def testMeasureNSingleSource(self):
+        """Test that a family of one gives the same result as measure.
+        """
+        algorithm, schema = self.makeAlgorithm()
+        exposure, catalog = self.dataset.realize(10.0, schema, randomSeed=2)
+        record = catalog[0]
+        algorithm.measure(record, exposure)
+        instFlux = record.get("base_PsfFlux_instFlux")
+        instFluxErr = record.get("base_PsfFlux_instFluxErr")
+        area = record.get("base_PsfFlux_area")
+        record.set("base_PsfFlux_instFlux", np.nan)
+        algorithm.measureN(catalog, exposure)
+        self.assertFloatsAlmostEqual(record.get("base_PsfFlux_instFlux"), instFlux, rtol=1E-10)
+        self.assertFloatsAlmostEqual(record.get("base_PsfFlux_instFluxErr"), instFluxErr, rtol=1E-10)
+        self.assertFloatsAlmostEqual(record.get("base_PsfFlux_area"), area, rtol=1E-10)
+        self.assertFalse(record.get("base_PsfFlux_flag"))
+
+    def testMeasureNBlend(self):
+        """Test that a simultaneous fit separates two blended point sources.
+        """
+        dataset = lsst.meas.base.tests.TestDataset(self.bbox)
+        dataset.addSource(100000.0, lsst.geom.Point2D(48.6, 49.8))
+        dataset.addSource(40000.0, lsst.geom.Point2D(52.1, 50.3))
+        algorithm, schema = self.makeAlgorithm()
+        # Results are RNG dependent; we choose a seed that is known to pass.
+        exposure, catalog = dataset.realize(10.0, schema, randomSeed=3)
+        algorithm.measureN(catalog, exposure)
+        for record in catalog:
+            self.assertFalse(record.get("base_PsfFlux_flag"))
+            self.assertFloatsAlmostEqual(record.get("base_PsfFlux_instFlux"), record.get("truth_instFlux"),
+                                         atol=3*record.get("base_PsfFlux_instFluxErr"))
+        # Fitting the sources one at a time is biased high by the flux of the neighbor.
+        algorithm.measure(catalog[1], exposure)
+        self.assertGreater(catalog[1].get("base_PsfFlux_instFlux") - catalog[1].get("truth_instFlux"),
+                           3*catalog[1].get("base_PsfFlux_instFluxErr"))
+
+    def testMeasureBatch(self):
+        """Test that measureBatch gives the same results as measure, for
+        sources measured by the kernel backend and for flagged sources.
+        """
+        dataset = lsst.meas.base.tests.TestDataset(self.bbox)
+        dataset.addSource(100000.0, lsst.geom.Point2D(30.2, 40.7))
+        dataset.addSource(80000.0, lsst.geom.Point2D(70.6, 60.1))
+        dataset.addSource(60000.0, lsst.geom.Point2D(2.3, 50.4))  # on the edge
+        ctrl = lsst.meas.base.PsfFluxControl()
+        ctrl.badMaskPlanes = ["BAD"]
+        algorithm, schema = self.makeAlgorithm(ctrl)
+        exposure, catalog = dataset.realize(10.0, schema, randomSeed=5)
+        # Mask all the pixels of the second source's model, so it has no good pixels.
+        mask = exposure.getMaskedImage().getMask()
+        bbox = exposure.getPsf().computeImage(catalog[1].getCentroid()).getBBox()
+        mask.getArray()[bbox.getMinY():bbox.getMaxY() + 1, bbox.getMinX():bbox.getMaxX() + 1] |= \
+            mask.getPlaneBitMask("BAD")
+        self.assertEqual(lsst.meas.base.FluxKernelBackend.getDefault().getName(), "cpu")
+        expected = catalog.copy(deep=True)
+        for record in expected:
+            try:
+                algorithm.measure(record, exposure)
+            except lsst.meas.base.MeasurementError as error:
+                algorithm.fail(record, error.cpp)
+        algorithm.measureBatch(catalog, exposure, list(range(len(catalog))))
+        for name in ("instFlux", "instFluxErr", "area"):
+            self.assertFloatsEqual(catalog["base_PsfFlux_" + name], expected["base_PsfFlux_" + name],
+                                   ignoreNaNs=True)
+        for name in ("flag", "flag_edge", "flag_noGoodPixels"):
+            self.assertEqual(list(catalog["base_PsfFlux_" + name]), list(expected["base_PsfFlux_" + name]))
+        self.assertEqual(list(catalog["base_PsfFlux_flag"]), [False, True, True])
+        # The sums the backend computes are those of the per-source kernel.
+        psfImage = exposure.getPsf().computeImage(catalog[0].getCentroid())
+        sums = lsst.meas.base.accumulateModelFit(psfImage, exposure.getMaskedImage(), psfImage.getBBox(),
+                                                 mask.getPlaneBitMask("BAD"), False)
+        self.assertEqual(sums.area, psfImage.getBBox().getArea())
+        self.assertFloatsAlmostEqual(sums.modelData/sums.modelSquared,
+                                     catalog[0].get("base_PsfFlux_instFlux"), rtol=1E-14)
+
+    def testMeasureBatchUnknownMaskPlane(self):
+        """Test that an unknown bad mask plane fails the records of a batch
+        one at a time instead of aborting the whole batch.
+        """
+        ctrl = lsst.meas.base.PsfFluxControl()
+        ctrl.badMaskPlanes = ["NOT_A_MASK_PLANE"]
+        algorithm, schema = self.makeAlgorithm(ctrl)
+        exposure, catalog = self.dataset.realize(10.0, schema, randomSeed=1)
+        algorithm.measureBatch(catalog, exposure, list(range(len(catalog))))
+        for record in catalog:
+            self.assertTrue(record.get("base_PsfFlux_flag"))
+            self.assertTrue(np.isnan(record.get("base_PsfFlux_instFlux")))
+
     def testSingleFramePlugin(self):
         task = self.makeSingleFrameMeasurementTask("base_PsfFlux")
         # Results are RNG dependent; we choose a seed that is known to pass.
@@ -0,0 +1,137 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+import math
+import unittest
+
+import lsst.geom
+import lsst.afw.detection
+import lsst.afw.geom
+import lsst.afw.table
+import lsst.pex.exceptions
+import lsst.meas.base
+import lsst.meas.base.tests
+import lsst.utils.tests
+
+
+class ReferenceTransformTestCase(lsst.meas.base.tests.AlgorithmTestCase, lsst.utils.tests.TestCase):
+    """Test the batch transformation of reference centroids, shapes and peaks.
+    """
+
+    def setUp(self):
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(200, 100))
+        self.dataset = lsst.meas.base.tests.TestDataset(bbox)
+        self.dataset.addSource(100000.0, lsst.geom.Point2D(50.2, 40.7))
+        self.dataset.addSource(80000.0, lsst.geom.Point2D(150.6, 60.1), lsst.afw.geom.Quadrupole(6, 5, 1))
+        self.refWcs = self.dataset.exposure.getWcs()
+        self.measWcs = self.dataset.makePerturbedWcs(self.refWcs, randomSeed=3)
+
+    def tearDown(self):
+        del self.dataset
+        del self.refWcs
+        del self.measWcs
+
+    def testPoints(self):
+        transform = lsst.meas.base.ReferenceTransform(self.refWcs, self.measWcs)
+        self.assertFalse(transform.isIdentity())
+        self.assertTrue(lsst.meas.base.ReferenceTransform(self.refWcs, self.refWcs).isIdentity())
+        points = [lsst.geom.Point2D(10.5, 20.25), lsst.geom.Point2D(150.0, 75.0),
+                  lsst.geom.Point2D(math.nan, 3.0)]
+        transformed = transform.transformPoints(points)
+        linear = transform.computeLocalLinearTransforms(points)
+        pairTransform = lsst.afw.geom.makeWcsPairTransform(self.refWcs, self.measWcs)
+        for point, result, local in zip(points[:2], transformed, linear):
+            expected = self.measWcs.skyToPixel(self.refWcs.pixelToSky(point))
+            self.assertFloatsAlmostEqual(result.getX(), expected.getX(), atol=1E-8)
+            self.assertFloatsAlmostEqual(result.getY(), expected.getY(), atol=1E-8)
+            expectedLinear = lsst.afw.geom.linearizeTransform(pairTransform, point).getLinear()
+            self.assertFloatsAlmostEqual(local.getMatrix(), expectedLinear.getMatrix(), atol=1E-12)
+        self.assertTrue(math.isnan(transformed[2].getX()))
+        self.assertTrue(math.isnan(linear[2].getMatrix()[0, 0]))
+
+    def testPlugins(self):
+        """Test that measuring all sources at once gives the results of the
+        per-source plugins.
+        """
+        catalogs = []
+        for doMeasureBatch in (False, True):
+            config = self.makeForcedMeasurementConfig("base_PeakCentroid", dependencies=("base_PsfFlux",))
+            config.doMeasureBatch = doMeasureBatch
+            task = self.makeForcedMeasurementTask(config=config)
+            measDataset = self.dataset.transform(self.measWcs)
+            exposure = measDataset.realize(10.0, measDataset.makeMinimalSchema(), randomSeed=2)[0]
+            refCat = self.dataset.catalog
+            measCat = task.generateMeasCat(exposure, refCat, self.refWcs)
+            task.attachTransformedFootprints(measCat, refCat, exposure, self.refWcs)
+            task.run(measCat, exposure, refCat, self.refWcs, exposureId=1)
+            catalogs.append(measCat)
+        single, batch = catalogs
+        for name in ("base_TransformedCentroid_x", "base_TransformedCentroid_y",
+                     "base_PeakCentroid_x", "base_PeakCentroid_y"):
+            self.assertFloatsAlmostEqual(batch[name], single[name], atol=1E-8)
+        for name in ("base_TransformedShape_xx", "base_TransformedShape_yy", "base_TransformedShape_xy"):
+            self.assertFloatsAlmostEqual(batch[name], single[name], rtol=1E-12)
+        # Plugins run after the batch read its results through the slots.
+        self.assertFloatsAlmostEqual(batch["base_PsfFlux_instFlux"], single["base_PsfFlux_instFlux"],
+                                     rtol=1E-6)
+
+    def testMissingPeak(self):
+        """Test that a reference without a peak is flagged, whether or not
+        the sources are measured all at once.
+        """
+        refCat = self.dataset.catalog.copy(deep=True)
+        refCat[0].setFootprint(lsst.afw.detection.Footprint(refCat[0].getFootprint().getSpans()))
+        for doMeasureBatch in (False, True):
+            config = self.makeForcedMeasurementConfig("base_PeakCentroid")
+            config.doReplaceWithNoise = False
+            config.doMeasureBatch = doMeasureBatch
+            task = self.makeForcedMeasurementTask(config=config)
+            exposure = self.dataset.exposure
+            measCat = task.generateMeasCat(exposure, refCat, self.refWcs)
+            task.attachTransformedFootprints(measCat, refCat, exposure, self.refWcs)
+            task.run(measCat, exposure, refCat, self.refWcs)
+            self.assertEqual(list(measCat["base_PeakCentroid_flag"]), [True, False])
+            self.assertTrue(math.isnan(measCat[0].get("base_PeakCentroid_x")))
+            self.assertFalse(math.isnan(measCat[1].get("base_PeakCentroid_x")))
+
+    def testLengthMismatch(self):
+        config = self.makeForcedMeasurementConfig("base_PsfFlux")
+        task = self.makeForcedMeasurementTask(config=config)
+        refCat = self.dataset.catalog
+        measCat = task.generateMeasCat(self.dataset.exposure, refCat, self.refWcs)
+        transform = lsst.meas.base.ReferenceTransform(self.refWcs, self.measWcs)
+        centroidKey = lsst.afw.table.Point2DKey(measCat.schema["base_TransformedCentroid"])
+        with self.assertRaises(lsst.pex.exceptions.LengthError):
+            transform.transformCentroids(measCat[:1], refCat, centroidKey, lsst.afw.table.Key["Flag"]())
+
+
+class TestMemory(lsst.utils.tests.MemoryTestCase):
+    pass
+
+
+def setup_module(module):
+    lsst.utils.tests.init()
+
+
+if __name__ == "__main__":
+    lsst.utils.tests.init()
+    unittest.main()
@@ -0,0 +1,308 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+import unittest
+
+import numpy as np
+
+import lsst.geom
+import lsst.afw.geom
+import lsst.afw.table
+import lsst.pipe.base
+import lsst.utils.tests
+from lsst.meas.base.references import (BaseReferencesTask, CoaddSrcReferencesTask, ReferenceIndex,
+                                       ReferenceCatalogCache)
+
+
+class ListReferencesTask(BaseReferencesTask):
+    """A references task that only provides a schema, for testing `subset`.
+    """
+
+    def __init__(self, schema, **kwargs):
+        BaseReferencesTask.__init__(self, schema=schema, name="references", **kwargs)
+        self.schema = schema
+
+
+class ReferenceIndexTestCase(lsst.utils.tests.TestCase):
+
+    def setUp(self):
+        self.schema = lsst.afw.table.SourceTable.makeMinimalSchema()
+        self.catalog = lsst.afw.table.SourceCatalog(self.schema)
+        rng = np.random.RandomState(12)
+        # Scatter parents over a region straddling RA=0, each with a child
+        # at a nearby position.
+        for ra, dec in zip(rng.uniform(-0.5, 0.5, 400), rng.uniform(-0.5, 0.5, 400)):
+            parent = self.catalog.addNew()
+            parent.setCoord(lsst.geom.SpherePoint(ra, dec, lsst.geom.degrees))
+            child = self.catalog.addNew()
+            child.setParent(parent.getId())
+            child.setCoord(lsst.geom.SpherePoint(ra + 0.001, dec, lsst.geom.degrees))
+        scale = (0.2*lsst.geom.arcseconds).asDegrees()
+        self.wcs = lsst.afw.geom.makeSkyWcs(crpix=lsst.geom.Point2D(1000.0, 1000.0),
+                                            crval=lsst.geom.SpherePoint(0.0, 0.0, lsst.geom.degrees),
+                                            cdMatrix=lsst.afw.geom.makeCdMatrix(scale*lsst.geom.degrees,
+                                                                                30*lsst.geom.degrees))
+        self.bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(2000, 4000))
+
+    def tearDown(self):
+        del self.catalog
+        del self.wcs
+
+    def bruteForce(self, bbox):
+        boxD = lsst.geom.Box2D(bbox)
+        parents = [record for record in self.catalog if record.getParent() == 0
+                   and boxD.contains(self.wcs.skyToPixel(record.getCoord()))]
+        ids = set(parent.getId() for parent in parents)
+        return sorted(record.getId() for record in self.catalog
+                      if record.getId() in ids or record.getParent() in ids)
+
+    def testQuery(self):
+        """Test that the candidates include every parent in the circle.
+        """
+        index = ReferenceIndex(self.catalog, self.schema, zoneHeight=0.05*lsst.geom.degrees)
+        self.assertEqual(len(index), len(self.catalog)//2)
+        center = lsst.geom.SpherePoint(359.9, 0.1, lsst.geom.degrees)
+        radius = 0.2*lsst.geom.degrees
+        candidates = set(index._parents[i].getId() for i in index.query(center, radius))
+        expected = set(record.getId() for record in self.catalog
+                       if record.getParent() == 0 and center.separation(record.getCoord()) < radius)
+        self.assertTrue(expected.issubset(candidates))
+        self.assertLess(len(candidates), len(index))
+
+    def testSubset(self):
+        """Test that indexed selection matches testing every parent.
+        """
+        task = ListReferencesTask(self.schema)
+        offset = lsst.geom.Box2I(lsst.geom.Point2I(-4000, -2000), lsst.geom.Extent2I(3000, 3000))
+        for bbox in (self.bbox, offset):
+            selected = sorted(record.getId() for record in task.subset(self.catalog, bbox, self.wcs))
+            self.assertEqual(selected, self.bruteForce(bbox))
+            self.assertGreater(len(selected), 0)
+        index = task.makeIndex(self.catalog)
+        empty = lsst.geom.Box2I(lsst.geom.Point2I(100000, 100000), lsst.geom.Extent2I(10, 10))
+        self.assertEqual(list(index.subset(empty, self.wcs)), [])
+
+
+class FakeButler:
+    """A butler that serves one catalog for every patch and counts reads.
+    """
+
+    def __init__(self, catalog):
+        self.catalog = catalog
+        self.reads = 0
+
+    def datasetExists(self, dataset, dataId):
+        return True
+
+    def get(self, dataset, dataId, immediate=True):
+        self.reads += 1
+        return self.catalog
+
+
+class FakePatch:
+
+    def __init__(self, index, innerBBox=None):
+        self.index = index
+        self.innerBBox = innerBBox
+
+    def getIndex(self):
+        return self.index
+
+    def getInnerBBox(self):
+        return self.innerBBox
+
+
+class FakeTract:
+    """A tract that returns the same patches for every region.
+    """
+
+    def __init__(self, patches):
+        self.patches = patches
+
+    def findPatchList(self, coordList):
+        return self.patches
+
+
+class ReferenceCatalogCacheTestCase(lsst.utils.tests.TestCase):
+
+    def setUp(self):
+        self.schema = lsst.afw.table.SourceTable.makeMinimalSchema()
+        self.schema.addField("base_Test_x", type=float, doc="x")
+        self.schema.addField("base_Test_y", type=float, doc="y")
+        self.schema.addField("other_value", type=float, doc="unused")
+        self.schema.getAliasMap().set("slot_Centroid", "base_Test")
+        self.catalog = lsst.afw.table.SourceCatalog(self.schema)
+        for i in range(10):
+            record = self.catalog.addNew()
+            record.setCoord(lsst.geom.SpherePoint(10.0, 0.01*i, lsst.geom.degrees))
+            record.set("base_Test_x", float(i))
+        butler = FakeButler(self.catalog)
+        self.dataRef = lsst.pipe.base.Struct(dataId={"tract": 0}, butlerSubset=lsst.pipe.base.Struct(
+            butler=butler))
+
+    def tearDown(self):
+        del self.catalog
+        del self.dataRef
+
+    def makeTask(self, cache=None, columns=None):
+        config = CoaddSrcReferencesTask.ConfigClass()
+        config.filter = "r"
+        config.removePatchOverlaps = False
+        return CoaddSrcReferencesTask(schema=self.schema, config=config, cache=cache, columns=columns,
+                                      name="references")
+
+    def testEviction(self):
+        """Test that the cache evicts least-recently-used entries to stay
+        within its bound.
+        """
+        cache = ReferenceCatalogCache(maxSize=3.0/1024**2)
+        cache.put("a", 1, 1)
+        cache.put("b", 2, 1)
+        cache.put("c", 3, 1)
+        self.assertEqual(cache.get("a"), 1)
+        cache.put("d", 4, 1)
+        self.assertNotIn("b", cache)
+        self.assertEqual([cache.get(key) for key in "acd"], [1, 3, 4])
+        cache.put("e", 5, 4)
+        self.assertNotIn("e", cache)
+        self.assertEqual(cache.size, 3)
+        self.assertEqual((cache.hits, cache.misses), (4, 0))
+        cache.clear()
+        self.assertEqual(len(cache), 0)
+
+    def testSharedReads(self):
+        """Test that tasks sharing a cache read each patch once.
+        """
+        cache = ReferenceCatalogCache(maxSize=100.0)
+        patches = [FakePatch((0, 0)), FakePatch((0, 1))]
+        for i in range(3):
+            task = self.makeTask(cache=cache)
+            self.assertEqual(len(list(task.fetchInPatches(self.dataRef, patches))), 2*len(self.catalog))
+        self.assertEqual(self.dataRef.butlerSubset.butler.reads, 2)
+        self.assertEqual(len(cache), 2)
+        self.assertGreater(cache.size, 0)
+        uncached = self.makeTask()
+        list(uncached.fetchInPatches(self.dataRef, patches))
+        self.assertEqual(self.dataRef.butlerSubset.butler.reads, 4)
+
+    def testColumns(self):
+        """Test that only the requested columns, the minimal schema and the
+        aliases to them are loaded.
+        """
+        task = self.makeTask(columns=["slot_Centroid_*"])
+        names = task.schema.getNames()
+        self.assertIn("base_Test_x", names)
+        self.assertIn("base_Test_y", names)
+        self.assertNotIn("other_value", names)
+        self.assertEqual(task.schema.getAliasMap().get("slot_Centroid"), "base_Test")
+        sources = list(task.fetchInPatches(self.dataRef, [FakePatch((0, 0))]))
+        self.assertEqual([source.get("base_Test_x") for source in sources],
+                         [record.get("base_Test_x") for record in self.catalog])
+        task.setColumns([])
+        self.assertIn("other_value", task.schema.getNames())
+
+
+class FetchInBoxTestCase(lsst.utils.tests.TestCase):
+
+    def setUp(self):
+        self.schema = lsst.afw.table.SourceTable.makeMinimalSchema()
+        centroidKey = lsst.afw.table.Point2DKey.addFields(self.schema, "base_Test", "centroid", "pixel")
+        self.schema.getAliasMap().set("slot_Centroid", "base_Test")
+        scale = (0.2*lsst.geom.arcseconds).asDegrees()
+        self.wcs = lsst.afw.geom.makeSkyWcs(crpix=lsst.geom.Point2D(0.0, 0.0),
+                                            crval=lsst.geom.SpherePoint(10.0, 0.0, lsst.geom.degrees),
+                                            cdMatrix=lsst.afw.geom.makeCdMatrix(scale*lsst.geom.degrees))
+        self.catalog = lsst.afw.table.SourceCatalog(self.schema)
+
+        def addSource(x, y, parent=None):
+            record = self.catalog.addNew()
+            if parent is not None:
+                record.setParent(parent.getId())
+            record.set(centroidKey, lsst.geom.Point2D(x, y))
+            record.setCoord(self.wcs.pixelToSky(lsst.geom.Point2D(x, y)))
+            return record
+
+        # One family on each side of the patch boundary at x=100, and one
+        # whose parent lies in the left patch but whose children straddle
+        # the boundary.
+        left = addSource(50.0, 50.0)
+        addSource(52.0, 50.0, left)
+        right = addSource(150.0, 50.0)
+        addSource(152.0, 50.0, right)
+        self.straddling = addSource(98.0, 20.0)
+        addSource(97.0, 20.0, self.straddling)
+        addSource(103.0, 20.0, self.straddling)
+        self.patches = [FakePatch((0, 0), lsst.geom.Box2I(lsst.geom.Point2I(0, 0),
+                                                          lsst.geom.Extent2I(100, 100))),
+                        FakePatch((1, 0), lsst.geom.Box2I(lsst.geom.Point2I(100, 0),
+                                                          lsst.geom.Extent2I(100, 100)))]
+        skyMap = {0: FakeTract(self.patches)}
+        self.dataRef = lsst.pipe.base.Struct(
+            dataId={"tract": 0},
+            get=lambda dataset, immediate=True: skyMap,
+            butlerSubset=lsst.pipe.base.Struct(butler=FakeButler(self.catalog)),
+        )
+
+    def tearDown(self):
+        del self.catalog
+        del self.dataRef
+        del self.straddling
+
+    def makeTask(self):
+        config = CoaddSrcReferencesTask.ConfigClass()
+        config.filter = "r"
+        config.removePatchOverlaps = True
+        return CoaddSrcReferencesTask(schema=self.schema, config=config, name="references")
+
+    def testStraddlingFamily(self):
+        """Test that a family split across patches is returned whole, with
+        the parent before its children, as when the patches are merged.
+        """
+        task = self.makeTask()
+        for bbox in (lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(200, 100)),
+                     lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(100, 40))):
+            expected = sorted(record.getId() for record in
+                              task.subset(task.fetchInPatches(self.dataRef, self.patches), bbox, self.wcs))
+            sources = list(task.fetchInBox(self.dataRef, bbox, self.wcs))
+            self.assertEqual(sorted(source.getId() for source in sources), expected)
+            self.assertEqual(len(sources), len(set(source.getId() for source in sources)))
+            family = [source.getId() for source in sources
+                      if self.straddling.getId() in (source.getId(), source.getParent())]
+            self.assertEqual(len(family), 3)
+            self.assertEqual(family[0], self.straddling.getId())
+        # The child in the right patch follows its parent out of the box.
+        outside = lsst.geom.Box2I(lsst.geom.Point2I(100, 0), lsst.geom.Extent2I(100, 100))
+        sources = list(task.fetchInBox(self.dataRef, outside, self.wcs))
+        self.assertNotIn(self.straddling.getId(), [source.getParent() for source in sources])
+        self.assertEqual(len(sources), 2)
+
+
+class TestMemory(lsst.utils.tests.MemoryTestCase):
+    pass
+
+
+def setup_module(module):
+    lsst.utils.tests.init()
+
+
+if __name__ == "__main__":
+    lsst.utils.tests.init()
+    unittest.main()
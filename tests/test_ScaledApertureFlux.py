@@ -117,6 +117,37 @@ class ScaledApertureFluxTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase):
         self.assertFalse(catalog[0].get("base_ScaledApertureFlux_flag_apertureTruncated"))
         self.assertTrue(catalog[0].get("base_ScaledApertureFlux_flag_sincCoeffsTruncated"))
 
+    def testRadiusGrid(self):
+        """Check that interpolating between cached grid radii agrees with the
+        direct measurement, and that the grid coefficients are reused.
+        """
+        algorithm, schema = self.makeAlgorithm()
+        exposure, catalog = self.dataset.realize(10.0, schema, randomSeed=3)
+        algorithm.measure(catalog[0], exposure)
+        direct = catalog[0].get("base_ScaledApertureFlux_instFlux")
+        directErr = catalog[0].get("base_ScaledApertureFlux_instFluxErr")
+
+        ctrl = lsst.meas.base.ScaledApertureFluxControl()
+        ctrl.radiusGridStep = 0.05
+        algorithm, schema = self.makeAlgorithm(ctrl)
+        self.assertIn("base_ScaledApertureFlux_instFluxInterpErr", schema.getNames())
+        exposure, catalog = self.dataset.realize(10.0, schema, randomSeed=3)
+        algorithm.measure(catalog[0], exposure)
+        self.assertFalse(catalog[0].get("base_ScaledApertureFlux_flag"))
+        self.assertFloatsAlmostEqual(catalog[0].get("base_ScaledApertureFlux_instFlux"), direct, rtol=1E-3)
+        self.assertFloatsAlmostEqual(catalog[0].get("base_ScaledApertureFlux_instFluxErr"), directErr,
+                                     rtol=0.05)
+        interpErr = catalog[0].get("base_ScaledApertureFlux_instFluxInterpErr")
+        self.assertGreaterEqual(interpErr, 0.0)
+        self.assertLess(interpErr, 1E-3*direct)
+
+        # A second measurement finds both grid radii in the cache.
+        lsst.meas.base.SincCoeffsF.resetCacheStatistics()
+        algorithm.measure(catalog[0], exposure)
+        stats = lsst.meas.base.SincCoeffsF.getCacheStatistics()
+        self.assertEqual(stats.misses, 0)
+        self.assertEqual(stats.hits, 2)
+
 
 class ScaledApertureFluxTransformTestCase(FluxTransformTestCase,
                                           SingleFramePluginTransformSetupHelper,
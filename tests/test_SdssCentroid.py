@@ -27,6 +27,9 @@ import lsst.geom
 from lsst.meas.base.tests import (AlgorithmTestCase, CentroidTransformTestCase,
                                   SingleFramePluginTransformSetupHelper)
 import lsst.afw.geom
+import lsst.afw.image
+import lsst.afw.math
+import lsst.pex.exceptions
 import lsst.utils.tests
 
 # N.B. Some tests here depend on the noise realization in the test data
@@ -119,6 +122,135 @@ class SdssCentroidTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase):
             self.assertLess(xMean - x, 3.0*xErrMean / nSamples**0.5)   # rng dependent
             self.assertLess(yMean - y, 3.0*yErrMean / nSamples**0.5)   # rng dependent
 
+    def testPsfCellSize(self):
+        """Test that sharing the smoothing kernel between sources in a cell
+        has no effect when the PSF is constant.
+        """
+        results = []
+        for psfCellSize in (0, 64):
+            ctrl = lsst.meas.base.SdssCentroidControl()
+            ctrl.psfCellSize = psfCellSize
+            algorithm, schema = self.makeAlgorithm(ctrl)
+            exposure, catalog = self.dataset.realize(10.0, schema, randomSeed=3)
+            algorithm.measure(catalog[0], exposure)
+            results.append((catalog[0].get("base_SdssCentroid_x"), catalog[0].get("base_SdssCentroid_y"),
+                            catalog[0].get("base_SdssCentroid_xErr")))
+        self.assertEqual(results[0], results[1])
+
+    def testUncertainty(self):
+        """Test that the uncertainty option controls the error fields, and
+        that the unsupported full covariance is rejected.
+        """
+        ctrl = lsst.meas.base.SdssCentroidControl()
+        self.assertEqual(ctrl.uncertainty, "SIGMA_ONLY")
+        ctrl.uncertainty = "NO_UNCERTAINTY"
+        algorithm, schema = self.makeAlgorithm(ctrl)
+        self.assertNotIn("base_SdssCentroid_xErr", schema)
+        self.assertNotIn("base_SdssCentroid_yErr", schema)
+        exposure, catalog = self.dataset.realize(10.0, schema, randomSeed=3)
+        algorithm.measure(catalog[0], exposure)
+        self.assertFalse(catalog[0].get("base_SdssCentroid_flag"))
+        self.assertFloatsAlmostEqual(catalog[0].get("base_SdssCentroid_x"), self.center.getX(), atol=0.1)
+        ctrl.uncertainty = "FULL_COVARIANCE"
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            self.makeAlgorithm(ctrl)
+
+    def testBinned(self):
+        """Test a source large enough that the image must be binned before
+        it is smoothed.
+        """
+        dataset = lsst.meas.base.tests.TestDataset(self.bbox)
+        dataset.addSource(1000000.0, self.center, lsst.afw.geom.Quadrupole(40.0, 40.0, 0.0))
+        algorithm, schema = self.makeAlgorithm()
+        exposure, catalog = dataset.realize(0.0, schema, randomSeed=4)
+        record = catalog[0]
+        algorithm.measure(record, exposure)
+        self.assertFalse(record.get("base_SdssCentroid_flag"))
+        self.assertFloatsAlmostEqual(record.get("base_SdssCentroid_x"), record.get("truth_x"), atol=0.2)
+        self.assertFloatsAlmostEqual(record.get("base_SdssCentroid_y"), record.get("truth_y"), atol=0.2)
+
+    def makeSmoothedImage(self, exposure):
+        """Convolve an exposure with its PSF, as detection does.
+        """
+        kernel = exposure.getPsf().getLocalKernel(self.center)
+        smoothed = lsst.afw.image.MaskedImageF(exposure.getBBox())
+        lsst.afw.math.convolve(smoothed, exposure.getMaskedImage(), kernel,
+                               lsst.afw.math.ConvolutionControl())
+        return smoothed
+
+    def testSmoothedImage(self):
+        """Test reading the neighbourhood of the source from an image already
+        smoothed with the (here constant) PSF.
+        """
+        algorithm, schema = self.makeAlgorithm()
+        exposure, catalog = self.dataset.realize(10.0, schema, randomSeed=3)
+        record = catalog[0]
+        algorithm.measure(record, exposure)
+        expected = (record.get("base_SdssCentroid_x"), record.get("base_SdssCentroid_y"),
+                    record.get("base_SdssCentroid_xErr"))
+
+        algorithm.setSmoothedImage(self.makeSmoothedImage(exposure))
+        algorithm.measure(record, exposure)
+        self.assertFalse(record.get("base_SdssCentroid_flag"))
+        self.assertFloatsAlmostEqual(record.get("base_SdssCentroid_x"), expected[0], rtol=1E-6)
+        self.assertFloatsAlmostEqual(record.get("base_SdssCentroid_y"), expected[1], rtol=1E-6)
+        self.assertFloatsAlmostEqual(record.get("base_SdssCentroid_xErr"), expected[2], rtol=1E-5)
+
+        # Giving the sigma of the kernel explicitly is the same, since the
+        # image was smoothed with the PSF.
+        sigma = exposure.getPsf().computeShape(self.center).getDeterminantRadius()
+        algorithm.setSmoothedImage(self.makeSmoothedImage(exposure), sigma)
+        algorithm.measure(record, exposure)
+        self.assertFloatsAlmostEqual(record.get("base_SdssCentroid_x"), expected[0], rtol=1E-6)
+        self.assertFloatsAlmostEqual(record.get("base_SdssCentroid_xErr"), expected[2], rtol=1E-5)
+
+        # A different noise realization shows the smoothed image really is read.
+        other, _ = self.dataset.realize(10.0, schema, randomSeed=4)
+        algorithm.setSmoothedImage(self.makeSmoothedImage(other))
+        algorithm.measure(record, exposure)
+        self.assertNotEqual(record.get("base_SdssCentroid_x"), expected[0])
+
+        # ...except for deblended children, when they are measured with their
+        # siblings replaced by noise.
+        algorithm.setSmoothedImage(self.makeSmoothedImage(other), useForChildren=False)
+        record.setParent(record.getId() + 1)
+        algorithm.measure(record, exposure)
+        self.assertEqual(record.get("base_SdssCentroid_x"), expected[0])
+        record.setParent(0)
+        algorithm.setSmoothedImage(None)
+        self.assertIsNone(algorithm.getSmoothedImage())
+
+        task = self.makeSingleFrameMeasurementTask("base_SdssCentroid")
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=3)
+        task.run(catalog, exposure, smoothedImage=self.makeSmoothedImage(exposure))
+        self.assertFloatsAlmostEqual(catalog[0].get("base_SdssCentroid_x"), expected[0], rtol=1E-6)
+        self.assertIsNone(task.plugins["base_SdssCentroid"].cpp.getSmoothedImage())
+
+    def testPyramid(self):
+        """Test measuring a batch of sources with binned neighbourhoods read
+        from a pyramid of the image.
+        """
+        dataset = lsst.meas.base.tests.TestDataset(self.bbox)
+        dataset.addSource(1000000.0, self.center, lsst.afw.geom.Quadrupole(40.0, 40.0, 0.0))
+        dataset.addSource(100000.0, lsst.geom.Point2D(20.3, 95.6))
+        results = []
+        for usePyramid in (False, True):
+            ctrl = lsst.meas.base.SdssCentroidControl()
+            ctrl.usePyramid = usePyramid
+            algorithm, schema = self.makeAlgorithm(ctrl)
+            exposure, catalog = dataset.realize(0.0, schema, randomSeed=4)
+            algorithm.measureBatch(catalog, exposure, list(range(len(catalog))))
+            for record in catalog:
+                self.assertFalse(record.get("base_SdssCentroid_flag"))
+                self.assertFloatsAlmostEqual(record.get("base_SdssCentroid_x"), record.get("truth_x"),
+                                             atol=0.2)
+                self.assertFloatsAlmostEqual(record.get("base_SdssCentroid_y"), record.get("truth_y"),
+                                             atol=0.2)
+            results.append(catalog)
+        # The compact source needs no binning, so it does not use the pyramid.
+        self.assertEqual(results[0][1].get("base_SdssCentroid_x"), results[1][1].get("base_SdssCentroid_x"))
+        self.assertEqual(results[0][1].get("base_SdssCentroid_y"), results[1][1].get("base_SdssCentroid_y"))
+
     def testEdge(self):
         task = self.makeSingleFrameMeasurementTask("base_SdssCentroid")
         exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=2)
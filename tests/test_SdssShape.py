@@ -27,6 +27,7 @@ import lsst.geom
 import lsst.afw.geom
 import lsst.meas.base
 import lsst.meas.base.tests
+import lsst.pex.exceptions
 import lsst.utils.tests
 
 
@@ -129,6 +130,131 @@ class SdssShapeTestCase(lsst.meas.base.tests.AlgorithmTestCase, lsst.utils.tests
             self._checkShape(result, record)
             self.assertTrue(result.getFlag(lsst.meas.base.SdssShapeAlgorithm.PSF_SHAPE_BAD.number))
 
+    def testWarmStart(self):
+        """Test that starting from a good initial weight converges to the same moments in fewer iterations,
+        and that the iteration count is recorded.
+        """
+        exposure, catalog = self.dataset.realize(10.0, self.dataset.makeMinimalSchema(), randomSeed=3)
+        for record in catalog:
+            center = record.getCentroid()
+            cold = lsst.meas.base.SdssShapeAlgorithm.computeAdaptiveMoments(exposure.getMaskedImage(), center)
+            warm = lsst.meas.base.SdssShapeAlgorithm.computeAdaptiveMoments(
+                exposure.getMaskedImage(), center, cold.getShape())
+            self.assertGreater(cold.nIter, 0)
+            self.assertLessEqual(warm.nIter, cold.nIter)
+            self.assertFloatsAlmostEqual(warm.xx, cold.xx, rtol=1E-3)
+            self.assertFloatsAlmostEqual(warm.yy, cold.yy, rtol=1E-3)
+            self.assertFloatsAlmostEqual(warm.xy, cold.xy, rtol=1E-3, atol=1E-3)
+        self.config.plugins["base_SdssShape"].doWarmStart = True
+        _, catalog = self._runMeasurementTask()
+        key = lsst.meas.base.SdssShapeResultKey(catalog.schema["base_SdssShape"])
+        for record in catalog:
+            result = record.get(key)
+            self._checkShape(result, record)
+            self.assertGreater(record.get("base_SdssShape_nIter"), 0)
+            self.assertEqual(result.nIter, record.get("base_SdssShape_nIter"))
+
+    def testVectorizedMoments(self):
+        """Test that the vectorized moments kernel agrees with the scalar loop.
+
+        The vectorized kernel uses single-precision exp and per-row partial sums, so we only
+        expect agreement to a relative tolerance of 1E-5.
+        """
+        exposure, catalog = self.dataset.realize(10.0, self.dataset.makeMinimalSchema(), randomSeed=2)
+        scalarCtrl = lsst.meas.base.SdssShapeControl()
+        self.assertFalse(scalarCtrl.vectorize)
+        vectorCtrl = lsst.meas.base.SdssShapeControl()
+        vectorCtrl.vectorize = True
+        for record in catalog:
+            center = record.getCentroid()
+            scalar = lsst.meas.base.SdssShapeAlgorithm.computeAdaptiveMoments(
+                exposure.getMaskedImage(), center, ctrl=scalarCtrl)
+            vector = lsst.meas.base.SdssShapeAlgorithm.computeAdaptiveMoments(
+                exposure.getMaskedImage(), center, ctrl=vectorCtrl)
+            for attr in ("instFlux", "x", "y", "xx", "yy", "xy", "xxErr", "yyErr", "xyErr"):
+                self.assertFloatsAlmostEqual(getattr(vector, attr), getattr(scalar, attr),
+                                             rtol=1E-5, atol=1E-8)
+            for flag in ("FAILURE", "UNWEIGHTED_BAD", "UNWEIGHTED", "SHIFT", "MAXITER"):
+                number = getattr(lsst.meas.base.SdssShapeAlgorithm, flag).number
+                self.assertEqual(vector.getFlag(number), scalar.getFlag(number))
+            shape = scalar.getShape()
+            scalarFlux = lsst.meas.base.SdssShapeAlgorithm.computeFixedMomentsFlux(
+                exposure.getMaskedImage(), shape, center, ctrl=scalarCtrl)
+            vectorFlux = lsst.meas.base.SdssShapeAlgorithm.computeFixedMomentsFlux(
+                exposure.getMaskedImage(), shape, center, ctrl=vectorCtrl)
+            self.assertFloatsAlmostEqual(vectorFlux.instFlux, scalarFlux.instFlux, rtol=1E-5)
+            self.assertFloatsAlmostEqual(vectorFlux.instFluxErr, scalarFlux.instFluxErr, rtol=1E-5)
+
+    def testPixelWindow(self):
+        """Test that the moments do not depend on how far the weight function moves from its initial
+        size (which determines how often the copied pixel window is refilled), and that the background
+        is subtracted from the copied pixels.
+        """
+        exposure, catalog = self.dataset.realize(10.0, self.dataset.makeMinimalSchema(), randomSeed=4)
+        background = 50.0
+        shifted = exposure.getMaskedImage().clone()
+        shifted.getImage().getArray()[:, :] += background
+        ctrl = lsst.meas.base.SdssShapeControl()
+        ctrl.background = background
+        for record in catalog:
+            center = record.getCentroid()
+            default = lsst.meas.base.SdssShapeAlgorithm.computeAdaptiveMoments(
+                exposure.getMaskedImage(), center)
+            for initialWeight in (lsst.afw.geom.Quadrupole(0.6, 0.6, 0.0),
+                                  lsst.afw.geom.Quadrupole(40.0, 30.0, 5.0)):
+                result = lsst.meas.base.SdssShapeAlgorithm.computeAdaptiveMoments(
+                    exposure.getMaskedImage(), center, initialWeight)
+                self._checkShape(result, record)
+                self.assertFloatsAlmostEqual(result.xx, default.xx, rtol=1E-3)
+                self.assertFloatsAlmostEqual(result.yy, default.yy, rtol=1E-3)
+                self.assertFloatsAlmostEqual(result.xy, default.xy, rtol=1E-3, atol=1E-3)
+            subtracted = lsst.meas.base.SdssShapeAlgorithm.computeAdaptiveMoments(shifted, center, ctrl=ctrl)
+            for attr in ("instFlux", "x", "y", "xx", "yy", "xy"):
+                self.assertFloatsAlmostEqual(getattr(subtracted, attr), getattr(default, attr),
+                                             rtol=1E-4, atol=1E-6)
+
+    def testUncertainty(self):
+        """Test that the uncertainty option controls which error fields are added and computed,
+        without changing the moments themselves.
+        """
+        exposure, catalog = self.dataset.realize(10.0, self.dataset.makeMinimalSchema(), randomSeed=5)
+        defaultCtrl = lsst.meas.base.SdssShapeControl()
+        self.assertEqual(defaultCtrl.uncertainty, "SIGMA_ONLY")
+        noneCtrl = lsst.meas.base.SdssShapeControl()
+        noneCtrl.uncertainty = "NO_UNCERTAINTY"
+        for record in catalog:
+            center = record.getCentroid()
+            full = lsst.meas.base.SdssShapeAlgorithm.computeAdaptiveMoments(
+                exposure.getMaskedImage(), center, ctrl=defaultCtrl)
+            none = lsst.meas.base.SdssShapeAlgorithm.computeAdaptiveMoments(
+                exposure.getMaskedImage(), center, ctrl=noneCtrl)
+            for attr in ("instFlux", "x", "y", "xx", "yy", "xy"):
+                self.assertEqual(getattr(none, attr), getattr(full, attr))
+            self.assertFinite(full.xxErr)
+            self.assertFinite(none.instFluxErr)
+            self.assertEqual(none.instFluxErr, full.instFluxErr)
+            for attr in ("xxErr", "yyErr", "xyErr", "instFlux_xx_Cov", "xx_yy_Cov"):
+                self.assertTrue(np.isnan(getattr(none, attr)))
+
+        self.config.plugins["base_SdssShape"].uncertainty = "NO_UNCERTAINTY"
+        _, catalog = self._runMeasurementTask()
+        for name in ("xxErr", "yyErr", "xyErr", "instFlux_xx_Cov", "xx_yy_Cov"):
+            self.assertNotIn("base_SdssShape_" + name, catalog.schema)
+        self.assertFalse(catalog[1].get("base_SdssShape_flag"))
+        self.assertFinite(catalog[1].get("base_SdssShape_instFluxErr"))
+
+        self.config.plugins["base_SdssShape"].uncertainty = "FULL_COVARIANCE"
+        _, catalog = self._runMeasurementTask()
+        key = lsst.meas.base.SdssShapeResultKey(catalog.schema["base_SdssShape"])
+        for record in catalog:
+            self._checkShape(record.get(key), record)
+            for name in ("xx_yy_Cov", "xx_xy_Cov", "yy_xy_Cov"):
+                self.assertFinite(record.get("base_SdssShape_" + name))
+
+        self.config.plugins["base_SdssShape"].uncertainty = "SOME_UNCERTAINTY"
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            self.makeSingleFrameMeasurementTask("base_SdssShape", config=self.config)
+
 
 class SdssShapeTransformTestCase(lsst.meas.base.tests.FluxTransformTestCase,
                                  lsst.meas.base.tests.CentroidTransformTestCase,
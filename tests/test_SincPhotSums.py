@@ -31,6 +31,7 @@ import lsst.afw.math as afwMath
 import lsst.afw.geom as afwGeom
 import lsst.afw.geom.ellipses as afwEll
 import lsst.meas.base as measBase
+import lsst.pex.exceptions
 import lsst.utils.tests
 
 try:
@@ -252,6 +253,153 @@ class SincCoeffTestCase(lsst.utils.tests.TestCase):
         coeff1, coeff2 = self.getCoeffCircle(self.radius2)
         self.assertCached(coeff1, coeff2)
 
+    def testQuantizedElliptical(self):
+        tolerance = 0.01
+        coeff1 = measBase.SincCoeffsF.getQuantized(self.ellipse, self.inner, tolerance)
+        coeff2 = measBase.SincCoeffsF.getQuantized(self.ellipse, self.inner, tolerance)
+        self.assertCached(coeff1, coeff2)
+        # A slightly different ellipse falls in the same bin
+        nearby = afwEll.Axes(self.ellipse.getA()*1.001, self.ellipse.getB(), self.ellipse.getTheta())
+        self.assertCached(coeff1, measBase.SincCoeffsF.getQuantized(nearby, self.inner, tolerance))
+        quantized = measBase.SincCoeffsF.quantize(self.ellipse, tolerance)
+        self.assertAlmostEqual(quantized.getA()/self.ellipse.getA(), 1.0, delta=tolerance)
+        self.assertAlmostEqual(quantized.getB()/quantized.getA(),
+                               self.ellipse.getB()/self.ellipse.getA(), delta=tolerance)
+        self.assertAlmostEqual(quantized.getTheta(), self.ellipse.getTheta(), delta=tolerance)
+
+    def testQuantizedEllipticalFlux(self):
+        image = afwImage.MaskedImageF(lsst.geom.Box2I(lsst.geom.Point2I(-50, -50),
+                                                      lsst.geom.Extent2I(101, 101)))
+        image.image.set(1.0)
+        image.variance.set(1.0)
+        ellipse = afwEll.Ellipse(afwEll.Axes(6.0, 4.0, 0.3), lsst.geom.Point2D(0.25, -0.5))
+        ctrl = measBase.ApertureFluxControl()
+        exact = measBase.ApertureFluxAlgorithm.computeSincFlux(image, ellipse, ctrl)
+        self.assertFalse(exact.getFlag(measBase.ApertureFluxAlgorithm.SINC_COEFFS_APPROXIMATE.number))
+        ctrl.ellipticalCacheTolerance = 0.01
+        approx = measBase.ApertureFluxAlgorithm.computeSincFlux(image, ellipse, ctrl)
+        self.assertTrue(approx.getFlag(measBase.ApertureFluxAlgorithm.SINC_COEFFS_APPROXIMATE.number))
+        # Area of a uniform image scales with a*b, so the error is bounded by the quantization step
+        self.assertFloatsAlmostEqual(approx.instFlux, exact.instFlux, rtol=3*ctrl.ellipticalCacheTolerance)
+
+    def testCacheStatistics(self):
+        measBase.SincCoeffsF.cache(self.radius1, self.radius2)
+        measBase.SincCoeffsF.resetCacheStatistics()
+        self.getCoeffCircle(self.radius2)
+        measBase.SincCoeffsF.get(self.ellipse, self.inner)
+        stats = measBase.SincCoeffsF.getCacheStatistics()
+        self.assertEqual(stats.hits, 2)
+        self.assertEqual(stats.misses, 1)
+        self.assertGreater(stats.entries, 0)
+        self.assertGreater(stats.bytes, 0)
+        self.assertLessEqual(stats.bytes, stats.maxBytes)
+
+    def testCacheEviction(self):
+        maxBytes = measBase.SincCoeffsF.getMaxCacheBytes()
+        try:
+            measBase.SincCoeffsF.clearCache()
+            measBase.SincCoeffsF.cache(self.radius1, self.radius2)
+            entryBytes = measBase.SincCoeffsF.getCacheStatistics().bytes
+            measBase.SincCoeffsF.setMaxCacheBytes(entryBytes)
+            # A second aperture of the same size displaces the least-recently-used one
+            measBase.SincCoeffsF.cache(0.0, self.radius2)
+            stats = measBase.SincCoeffsF.getCacheStatistics()
+            self.assertEqual(stats.entries, 1)
+            self.assertGreater(stats.evictions, 0)
+            self.assertNotCached(*self.getCoeffCircle(self.radius2))
+            # A bound of zero disables caching
+            measBase.SincCoeffsF.setMaxCacheBytes(0)
+            self.assertEqual(measBase.SincCoeffsF.getCacheStatistics().entries, 0)
+        finally:
+            measBase.SincCoeffsF.setMaxCacheBytes(maxBytes)
+
+    def testCacheAll(self):
+        radii = [(0.0, 3.0), (0.0, 4.5), (self.radius1, 6.0), (0.0, 3.0)]
+        measBase.SincCoeffsF.clearCache()
+        measBase.SincCoeffsF.cacheAll(radii, nThreads=3)
+        self.assertEqual(measBase.SincCoeffsF.getCacheStatistics().entries, 3)
+        for r1, r2 in radii:
+            circle = afwEll.Axes(r2, r2, 0.0)
+            coeff = measBase.SincCoeffsF.get(circle, r1/r2)
+            self.assertCached(coeff, measBase.SincCoeffsF.get(circle, r1/r2))
+            # concurrently calculated coefficients are the same as serially calculated ones
+            expected = measBase.SincCoeffsD.get(circle, r1/r2)
+            self.assertFloatsAlmostEqual(coeff.getArray(), expected.getArray().astype(np.float32),
+                                         atol=1E-6)
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            measBase.SincCoeffsF.cacheAll([(2.0, 1.0)])
+
+    def testReadWriteCache(self):
+        measBase.SincCoeffsF.clearCache()
+        measBase.SincCoeffsF.cacheAll([(0.0, 3.0), (self.radius1, self.radius2)])
+        circle = afwEll.Axes(self.radius2, self.radius2, 0.0)
+        expected = measBase.SincCoeffsF.get(circle, self.inner)
+        with lsst.utils.tests.getTempFilePath(".sinc") as filename:
+            measBase.SincCoeffsF.writeCache(filename)
+            measBase.SincCoeffsF.clearCache()
+            measBase.SincCoeffsF.readCache(filename)
+            self.assertEqual(measBase.SincCoeffsF.getCacheStatistics().entries, 2)
+            coeff = measBase.SincCoeffsF.get(circle, self.inner)
+            self.assertCached(coeff, measBase.SincCoeffsF.get(circle, self.inner))
+            self.assertEqual(coeff.getBBox(), expected.getBBox())
+            np.testing.assert_array_equal(coeff.getArray(), expected.getArray())
+            # the file is specific to the pixel type
+            with self.assertRaises(lsst.pex.exceptions.IoError):
+                measBase.SincCoeffsD.readCache(filename)
+        measBase.SincCoeffsF.clearCache()
+
+    def testStore(self):
+        tolerance = 0.01
+        circle = afwEll.Axes(self.radius2, self.radius2, 0.0)
+        measBase.SincCoeffsF.clearCache()
+        expectedCircle = measBase.SincCoeffsF.get(circle, self.inner)
+        measBase.SincCoeffsF.cache(self.radius1, self.radius2)
+        expectedEllipse = measBase.SincCoeffsF.getQuantized(self.ellipse, self.inner, tolerance)
+        with lsst.utils.tests.getTempFilePath(".sinc") as filename:
+            measBase.SincCoeffsF.writeCache(filename)
+            measBase.SincCoeffsF.clearCache()
+            try:
+                measBase.SincCoeffsF.openStore(filename)
+                measBase.SincCoeffsF.resetCacheStatistics()
+                coeff = measBase.SincCoeffsF.get(circle, self.inner)
+                np.testing.assert_array_equal(coeff.getArray(), expectedCircle.getArray())
+                # circular coefficients from the store are cached
+                self.assertCached(coeff, measBase.SincCoeffsF.get(circle, self.inner))
+                coeff = measBase.SincCoeffsF.getQuantized(self.ellipse, self.inner, tolerance)
+                np.testing.assert_array_equal(coeff.getArray(), expectedEllipse.getArray())
+                # apertures that are not in the store are calculated
+                measBase.SincCoeffsF.get(afwEll.Axes(2*self.radius2, 2*self.radius2, 0.0), 0.0)
+                stats = measBase.SincCoeffsF.getCacheStatistics()
+                self.assertEqual(stats.hits, 1)
+                self.assertEqual(stats.misses, 3)
+                self.assertEqual(stats.loads, 2)
+            finally:
+                measBase.SincCoeffsF.closeStores()
+        measBase.SincCoeffsF.clearCache()
+
+    def testSymmetry(self):
+        """Test that coefficients synthesized from part of k-space have the
+        symmetries of the aperture.
+        """
+        circle = measBase.SincCoeffsD.calculate(afwEll.Axes(self.radius2, self.radius2, 0.0), self.inner)
+        array = circle.getArray()
+        atol = 1E-12*np.abs(array).max()
+        self.assertFloatsAlmostEqual(array, array[::-1, :], atol=atol)
+        self.assertFloatsAlmostEqual(array, array[:, ::-1], atol=atol)
+        self.assertFloatsAlmostEqual(array, array.T, atol=atol)
+        self.assertFloatsAlmostEqual(array.sum(), math.pi*(self.radius2**2 - self.radius1**2), rtol=1E-3)
+        ellipse = measBase.SincCoeffsD.calculate(self.ellipse, self.inner)
+        array = ellipse.getArray()
+        self.assertFloatsAlmostEqual(array, array[::-1, ::-1], atol=1E-12*np.abs(array).max())
+
+    def testFftwWisdom(self):
+        measBase.SincCoeffsF.planFftw(self.radius2)
+        with lsst.utils.tests.getTempFilePath(".wisdom") as filename:
+            measBase.SincCoeffsF.exportFftwWisdom(filename)
+            measBase.SincCoeffsF.importFftwWisdom(filename)
+        with self.assertRaises(lsst.pex.exceptions.IoError):
+            measBase.SincCoeffsF.importFftwWisdom("/nonexistent/sinc.wisdom")
+
 
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
@@ -0,0 +1,170 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+import unittest
+
+import numpy as np
+
+import lsst.geom
+import lsst.afw.detection
+import lsst.afw.geom
+import lsst.afw.image
+import lsst.afw.table
+import lsst.pex.exceptions
+import lsst.utils.tests
+import lsst.meas.base
+
+
+class SpanKernelsTestCase(lsst.utils.tests.TestCase):
+
+    def setUp(self):
+        self.bbox = lsst.geom.Box2I(lsst.geom.Point2I(-5, 10), lsst.geom.Extent2I(40, 30))
+        # Spans of several widths, so that the kernels' blocked and remainder loops are both used.
+        self.spans = lsst.afw.geom.SpanSet.fromShape(7).shiftedBy(10, 25)
+        rng = np.random.RandomState(5)
+        self.images = {}
+        for Image, dtype in ((lsst.afw.image.ImageF, np.float32), (lsst.afw.image.ImageD, np.float64)):
+            image = Image(self.bbox)
+            image.array[:, :] = rng.randn(*image.array.shape).astype(dtype)
+            self.images[dtype] = image
+
+    def tearDown(self):
+        del self.bbox
+        del self.spans
+        del self.images
+
+    def flatten(self, image):
+        return self.spans.flatten(image.array, image.getXY0())
+
+    def testDot(self):
+        for packedType in (np.float32, np.float64):
+            packed = self.flatten(self.images[packedType])
+            self.assertFloatsAlmostEqual(lsst.meas.base.sumSquares(packed),
+                                         np.sum(packed.astype(np.float64)**2), rtol=1E-12)
+            for image in self.images.values():
+                expected = np.dot(packed.astype(np.float64), self.flatten(image).astype(np.float64))
+                self.assertFloatsAlmostEqual(lsst.meas.base.dotSpans(self.spans, packed, image),
+                                             expected, rtol=1E-12)
+                residual = np.dot(packed.astype(np.float64),
+                                  self.flatten(image).astype(np.float64) - packed.astype(np.float64))
+                self.assertFloatsAlmostEqual(lsst.meas.base.dotResidualSpans(self.spans, packed, image),
+                                             residual, rtol=1E-12)
+                self.assertFloatsAlmostEqual(lsst.meas.base.sumSpans(self.spans, image),
+                                             np.sum(self.flatten(image).astype(np.float64)), rtol=1E-12)
+            # The residual of an image with its own pixels is exactly zero.
+            self.assertEqual(lsst.meas.base.dotResidualSpans(self.spans, packed, self.images[packedType]),
+                             0.0)
+            with self.assertRaises(lsst.pex.exceptions.LengthError):
+                lsst.meas.base.dotSpans(self.spans, packed[1:], self.images[packedType])
+            outside = self.spans.shiftedBy(30, 0)
+            with self.assertRaises(lsst.pex.exceptions.OutOfRangeError):
+                lsst.meas.base.dotSpans(outside, packed, self.images[packedType])
+
+    def testCopy(self):
+        for dtype, image in self.images.items():
+            packed = np.zeros(self.spans.getArea(), dtype=dtype)
+            lsst.meas.base.extractSpans(self.spans, image, packed)
+            np.testing.assert_array_equal(packed, self.flatten(image))
+            target = type(image)(self.bbox)
+            lsst.meas.base.insertSpans(self.spans, packed, target)
+            expected = type(image)(self.bbox)
+            self.spans.copyImage(image, expected)
+            np.testing.assert_array_equal(target.array, expected.array)
+
+    def testOr(self):
+        mask = lsst.afw.image.Mask(self.bbox)
+        inside = mask.getPlaneBitMask("SAT")
+        outside = mask.getPlaneBitMask("CR")
+        x0, y0 = self.bbox.getMinX(), self.bbox.getMinY()
+        mask.array[25 - y0, 10 - x0] = inside
+        mask.array[11 - y0, 0 - x0] = outside
+        self.assertEqual(lsst.meas.base.orSpans(self.spans, mask), inside)
+        # Spans are clipped to the mask rather than rejected.
+        self.assertEqual(lsst.meas.base.orSpans(self.spans.shiftedBy(-12, -14), mask), outside)
+
+
+class SpanIndexTestCase(lsst.utils.tests.TestCase):
+
+    def checkContains(self, spans):
+        index = lsst.meas.base.SpanIndex(spans)
+        bbox = spans.getBBox()
+        bbox.grow(2)
+        for y in range(bbox.getMinY(), bbox.getMaxY() + 1):
+            for x in range(bbox.getMinX(), bbox.getMaxX() + 1):
+                point = lsst.geom.Point2I(x, y)
+                expected = spans.contains(point)
+                self.assertEqual(index.contains(point), expected, point)
+                self.assertEqual(lsst.meas.base.containsPoint(spans, point), expected, point)
+
+    def testShapes(self):
+        """Test that the index agrees with SpanSet.contains, for SpanSets with
+        several spans per row and empty rows.
+        """
+        disk = lsst.afw.geom.SpanSet.fromShape(12).shiftedBy(30, -4)
+        annulus = disk.intersectNot(lsst.afw.geom.SpanSet.fromShape(5).shiftedBy(30, -4))
+        self.assertGreater(len(annulus), lsst.meas.base.SpanIndex.MIN_INDEXED_SPANS)
+        gapped = annulus.union(lsst.afw.geom.SpanSet.fromShape(3).shiftedBy(30, 20))
+        for spans in (lsst.afw.geom.SpanSet.fromShape(2), annulus, gapped):
+            self.checkContains(spans)
+
+    def testUnnormalized(self):
+        """Test that overlapping, adjacent and unsorted spans are merged.
+        """
+        spans = lsst.afw.geom.SpanSet([lsst.afw.geom.Span(3, 10, 14), lsst.afw.geom.Span(1, 2, 4),
+                                       lsst.afw.geom.Span(3, 12, 20), lsst.afw.geom.Span(3, 21, 22),
+                                       lsst.afw.geom.Span(3, 30, 31)], False)
+        self.checkContains(spans)
+        self.assertFalse(lsst.meas.base.SpanIndex(lsst.afw.geom.SpanSet()).contains(lsst.geom.Point2I(0, 0)))
+
+    def testCentroidChecker(self):
+        """Test that a centroid outside a big footprint is reset to the peak.
+        """
+        schema = lsst.afw.table.SourceTable.makeMinimalSchema()
+        lsst.meas.base.CentroidResultKey.addFields(schema, "test", "centroid",
+                                                   lsst.meas.base.UncertaintyEnum.NO_UNCERTAINTY)
+        schema.addField("test_flag", type="Flag", doc="general failure flag")
+        checker = lsst.meas.base.CentroidChecker(schema, "test", True)
+        catalog = lsst.afw.table.SourceCatalog(schema)
+        spans = lsst.afw.geom.SpanSet.fromShape(20).intersectNot(lsst.afw.geom.SpanSet.fromShape(4))
+        footprint = lsst.afw.detection.Footprint(spans)
+        footprint.addPeak(10, 0, 1.0)
+        for x, reset in ((15.2, False), (0.3, True)):
+            record = catalog.addNew()
+            record.setFootprint(footprint)
+            record.set("test_x", x)
+            record.set("test_y", 0.4)
+            self.assertEqual(checker(record), reset)
+            self.assertEqual(record.get("test_flag_resetToPeak"), reset)
+            self.assertEqual(record.get("test_x"), 10.0 if reset else x)
+
+
+class TestMemory(lsst.utils.tests.MemoryTestCase):
+    pass
+
+
+def setup_module(module):
+    lsst.utils.tests.init()
+
+
+if __name__ == "__main__":
+    lsst.utils.tests.init()
+    unittest.main()
@@ -25,6 +25,7 @@ import numpy as np
 
 import lsst.geom
 import lsst.afw.geom as afwGeom
+import lsst.meas.base
 import lsst.utils.tests as utilsTests
 
 # Rename the class on import so it does not confuse the test scanner
@@ -75,6 +76,57 @@ class TestDatasetTestCase(utilsTests.TestCase):
         for init, final in zip(init_state, np.random.get_state()):
             self.assertTrue(np.array_equal(init, final))
 
+    def test_addSources(self):
+        """Test that the fast path gives the same images, footprints and
+        truth values as adding the sources one at a time.
+        """
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(-10, 5), lsst.geom.Extent2I(120, 90))
+        instFluxes = [100000.0, 50000.0, 80000.0]
+        centroids = [lsst.geom.Point2D(20.3, 30.6), lsst.geom.Point2D(61.8, 52.1),
+                     lsst.geom.Point2D(-8.4, 90.2)]  # the last is on the edge
+        shapes = [None, afwGeom.Quadrupole(8.0, 5.0, 1.5), None]
+        slow = DatasetTester(bbox)
+        np.random.seed(5)
+        images = [slow.addSource(*args)[1] for args in zip(instFluxes, centroids, shapes)]
+        fast = DatasetTester(bbox)
+        np.random.seed(5)
+        records = fast.addSources(instFluxes, centroids, shapes, nThreads=2)
+        self.assertEqual(len(records), len(fast.catalog))
+        self.assertFloatsAlmostEqual(fast.exposure.getMaskedImage().getImage().getArray(),
+                                     slow.exposure.getMaskedImage().getImage().getArray(),
+                                     rtol=1E-5, atol=1E-3)
+        np.testing.assert_array_equal(fast.exposure.getMaskedImage().getMask().getArray(),
+                                      slow.exposure.getMaskedImage().getMask().getArray())
+        keys = DatasetTester.keys
+        for fastRecord, slowRecord in zip(fast.catalog, slow.catalog):
+            self.assertEqual(fastRecord.get(keys["instFlux"]), slowRecord.get(keys["instFlux"]))
+            self.assertEqual(fastRecord.get(keys["centroid"]), slowRecord.get(keys["centroid"]))
+            self.assertFloatsEqual(fastRecord.get(keys["centroid_sigma"]),
+                                   slowRecord.get(keys["centroid_sigma"]))
+            self.assertEqual(fastRecord.get(keys["shape"]).getParameterVector().tolist(),
+                             slowRecord.get(keys["shape"]).getParameterVector().tolist())
+            self.assertEqual(fastRecord.get(keys["isStar"]), slowRecord.get(keys["isStar"]))
+            fastFootprint = fastRecord.getFootprint()
+            slowFootprint = slowRecord.getFootprint()
+            self.assertEqual(fastFootprint.spans, slowFootprint.spans)
+            self.assertEqual(len(fastFootprint.getPeaks()), 1)
+            self.assertEqual(fastFootprint.getPeaks()[0].getI(), slowFootprint.getPeaks()[0].getI())
+
+        # HeavyFootprints hold each source's own image within its footprint.
+        realizer = lsst.meas.base.SceneRealizer(fast.threshold.getValue())
+        sources = [lsst.meas.base.SceneSource(record.get("truth_instFlux"), record.getCentroid(),
+                                              record.getShape()) for record in fast.catalog]
+        heavies = realizer.makeHeavyFootprints(sources, [record.getFootprint() for record in fast.catalog])
+        for heavy, image in zip(heavies, images):
+            self.assertFloatsAlmostEqual(heavy.getImageArray(),
+                                         heavy.spans.flatten(image.array, image.getXY0()),
+                                         rtol=1E-5, atol=1E-3)
+
+        # Sources that are never above the threshold are rejected before anything is added.
+        with self.assertRaises(RuntimeError):
+            fast.addSources([1.0], [lsst.geom.Point2D(50.0, 50.0)])
+        self.assertEqual(len(fast.catalog), len(instFluxes))
+
 
 class TestMemory(utilsTests.MemoryTestCase):
     pass
@@ -0,0 +1,146 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+import concurrent.futures
+import unittest
+
+import numpy as np
+
+import lsst.geom
+import lsst.afw.geom
+import lsst.utils.tests
+import lsst.meas.base
+import lsst.meas.base.tests
+
+# C++ plugins whose results do not depend on the order in which records are measured, when the slots
+# are set to the truth fields and noise replacement is disabled.
+SINGLE_FRAME_PLUGINS = ("base_SdssCentroid", "base_NaiveCentroid", "base_SdssShape", "base_PsfFlux",
+                        "base_GaussianFlux", "base_MultiScaleGaussianFlux", "base_PeakLikelihoodFlux",
+                        "base_CircularApertureFlux", "base_ScaledApertureFlux", "base_PixelFlags",
+                        "base_LocalBackground", "base_Variance")
+FORCED_PLUGINS = ("base_PsfFlux", "base_GaussianFlux", "base_CircularApertureFlux", "base_PixelFlags")
+
+
+class ThreadSafetyTestCase(lsst.meas.base.tests.AlgorithmTestCase, lsst.utils.tests.TestCase):
+    """Stress test measuring distinct records concurrently with the same
+    plugins and pixels.
+    """
+    nThreads = 8
+    nRepeats = 3
+
+    def setUp(self):
+        self.bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(200, 200))
+        self.dataset = lsst.meas.base.tests.TestDataset(self.bbox)
+        rng = np.random.RandomState(3)
+        for i in range(6):
+            for j in range(6):
+                center = lsst.geom.Point2D(15.0 + 34.0*i + rng.rand(), 15.0 + 34.0*j + rng.rand())
+                if (i + j) % 2:
+                    self.dataset.addSource(50000.0, center)
+                else:
+                    self.dataset.addSource(50000.0, center, lsst.afw.geom.Quadrupole(6.0, 4.0, 1.0))
+        # Near the edge, so most plugins fail.
+        self.dataset.addSource(10000.0, lsst.geom.Point2D(1.5, 100.2))
+
+    def tearDown(self):
+        del self.bbox
+        del self.dataset
+
+    def assertCatalogsEqual(self, catalog1, catalog2):
+        for item in catalog1.schema:
+            name = item.field.getName()
+            if item.field.getTypeString() not in ("Flag", "F", "D", "I", "L"):
+                continue
+            np.testing.assert_array_equal(catalog1.get(name), catalog2.get(name), err_msg=name)
+
+    def measureConcurrently(self, task, catalog, exposure, refCat=None, refWcs=None):
+        """Measure each record of a catalog with every plugin of a task, with
+        the records shared out among several threads.
+
+        Psf models may not be evaluated concurrently, so each thread measures
+        on a shallow copy of the exposure carrying its own clone of the Psf.
+        """
+        plugins = list(task.plugins.iter())
+        threadExposures = []
+        for k in range(self.nThreads):
+            threadExposure = exposure.Factory(exposure, False)
+            threadExposure.setPsf(exposure.getPsf().clone())
+            threadExposures.append(threadExposure)
+
+        def measure(indices, exposure):
+            for i in indices:
+                for plugin in plugins:
+                    if refCat is None:
+                        task.doMeasurement(plugin, catalog[i], exposure)
+                    else:
+                        task.doMeasurement(plugin, catalog[i], exposure, refCat[i], refWcs)
+
+        with concurrent.futures.ThreadPoolExecutor(self.nThreads) as executor:
+            futures = [executor.submit(measure, range(k, len(catalog), self.nThreads), threadExposures[k])
+                       for k in range(self.nThreads)]
+            for future in futures:
+                future.result()
+
+    def testSingleFrame(self):
+        config = self.makeSingleFrameMeasurementConfig(plugin=SINGLE_FRAME_PLUGINS[0],
+                                                       dependencies=SINGLE_FRAME_PLUGINS[1:])
+        config.doReplaceWithNoise = False
+        task = self.makeSingleFrameMeasurementTask(config=config)
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+        serial = catalog.copy(deep=True)
+        task.run(serial, exposure)
+        for repeat in range(self.nRepeats):
+            threaded = catalog.copy(deep=True)
+            self.measureConcurrently(task, threaded, exposure)
+            self.assertCatalogsEqual(serial, threaded)
+        self.assertTrue(serial[-1].get("base_PsfFlux_flag_edge"))
+
+    def testForced(self):
+        config = self.makeForcedMeasurementConfig(plugin=FORCED_PLUGINS[0], dependencies=FORCED_PLUGINS[1:])
+        config.doReplaceWithNoise = False
+        task = self.makeForcedMeasurementTask(config=config)
+        measWcs = self.dataset.makePerturbedWcs(self.dataset.exposure.getWcs(), randomSeed=1)
+        measDataset = self.dataset.transform(measWcs)
+        exposure, truthCatalog = measDataset.realize(10.0, measDataset.makeMinimalSchema(), randomSeed=1)
+        refCat = self.dataset.catalog
+        refWcs = self.dataset.exposure.getWcs()
+        measCat = task.generateMeasCat(exposure, refCat, refWcs)
+        task.attachTransformedFootprints(measCat, refCat, exposure, refWcs)
+        serial = measCat.copy(deep=True)
+        task.run(serial, exposure, refCat, refWcs)
+        for repeat in range(self.nRepeats):
+            threaded = measCat.copy(deep=True)
+            self.measureConcurrently(task, threaded, exposure, refCat, refWcs)
+            self.assertCatalogsEqual(serial, threaded)
+
+
+class TestMemory(lsst.utils.tests.MemoryTestCase):
+    pass
+
+
+def setup_module(module):
+    lsst.utils.tests.init()
+
+
+if __name__ == "__main__":
+    lsst.utils.tests.init()
+    unittest.main()
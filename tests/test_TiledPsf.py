@@ -0,0 +1,107 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+import unittest
+
+import lsst.geom
+import lsst.afw.detection
+import lsst.pex.exceptions
+import lsst.meas.base
+import lsst.meas.base.tests
+import lsst.utils.tests
+
+
+class TiledPsfTestCase(lsst.meas.base.tests.AlgorithmTestCase, lsst.utils.tests.TestCase):
+
+    def setUp(self):
+        self.psf = lsst.afw.detection.GaussianPsf(21, 21, 2.0)
+        self.bbox = lsst.geom.Box2I(lsst.geom.Point2I(-10, 5), lsst.geom.Extent2I(101, 60))
+        self.position = lsst.geom.Point2D(50.1, 49.8)
+
+    def tearDown(self):
+        del self.psf
+        del self.bbox
+
+    def testGrid(self):
+        """Test that the nodes span the bounding box, spaced by at most the cell size."""
+        tiled = lsst.meas.base.TiledPsf(self.psf, self.bbox, 25)
+        self.assertEqual(tiled.getNodeCountX(), 5)
+        self.assertEqual(tiled.getNodeCountY(), 4)
+        self.assertEqual(tiled.getNodePosition(0, 0), lsst.geom.Point2D(self.bbox.getMin()))
+        self.assertPairsAlmostEqual(tiled.getNodePosition(4, 3), lsst.geom.Point2D(self.bbox.getMax()),
+                                    maxDiff=1E-12)
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            lsst.meas.base.TiledPsf(self.psf, self.bbox, 0)
+        with self.assertRaises(lsst.pex.exceptions.OutOfRangeError):
+            tiled.getNodePosition(5, 0)
+
+    def testConstantPsf(self):
+        """Test that a spatially constant Psf is reproduced, evaluating it
+        only at the grid nodes.
+        """
+        for interpolate in (False, True):
+            tiled = lsst.meas.base.TiledPsf(self.psf, self.bbox, 25, interpolate)
+            self.assertEqual(tiled.getInterpolate(), interpolate)
+            positions = [lsst.geom.Point2D(40.0 + 0.7*i, 30.0 + 0.3*i) for i in range(10)]
+            for position in positions:
+                self.assertFloatsAlmostEqual(tiled.computeShape(position).getParameterVector(),
+                                             self.psf.computeShape(position).getParameterVector(),
+                                             rtol=1E-14)
+                self.assertImagesAlmostEqual(tiled.computeKernelImage(position),
+                                             self.psf.computeKernelImage(position), rtol=1E-14)
+                self.assertFloatsAlmostEqual(tiled.computeApertureFlux(3.0, position),
+                                             self.psf.computeApertureFlux(3.0, position), rtol=1E-14)
+                self.assertEqual(tiled.computeBBox(position), self.psf.computeBBox(position))
+            # All positions lie within one cell: at most four nodes for each of
+            # the kernel image, shape and aperture flux, and one for the bbox.
+            self.assertLessEqual(tiled.getEvaluationCount(), 13 if interpolate else 4)
+
+    def testMeasurementTask(self):
+        """Test that the measurement framework installs and removes the grid,
+        with results unchanged for a constant Psf.
+        """
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(100, 100))
+        dataset = lsst.meas.base.tests.TestDataset(bbox)
+        dataset.addSource(100000.0, self.position)
+        results = []
+        for psfGridCellSize in (0, 32):
+            config = self.makeSingleFrameMeasurementConfig("base_PsfFlux", dependencies=("base_SdssShape",))
+            config.psfGridCellSize = psfGridCellSize
+            task = self.makeSingleFrameMeasurementTask(config=config)
+            exposure, catalog = dataset.realize(10.0, task.schema, randomSeed=0)
+            task.run(catalog, exposure)
+            self.assertNotIsInstance(exposure.getPsf(), lsst.meas.base.TiledPsf)
+            results.append((catalog[0].get("base_PsfFlux_instFlux"), catalog[0].get("base_SdssShape_psf_xx")))
+        self.assertFloatsAlmostEqual(results[0][0], results[1][0], rtol=1E-6)
+        self.assertFloatsAlmostEqual(results[0][1], results[1][1], rtol=1E-12)
+
+
+class TestMemory(lsst.utils.tests.MemoryTestCase):
+    pass
+
+
+def setup_module(module):
+    lsst.utils.tests.init()
+
+
+if __name__ == "__main__":
+    lsst.utils.tests.init()
+    unittest.main()
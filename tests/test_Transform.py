@@ -23,7 +23,8 @@ import unittest
 
 import numpy as np
 
-from lsst.afw.geom import makeSkyWcs
+import lsst.geom
+from lsst.afw.geom import makeCdMatrix, makeSkyWcs
 import lsst.afw.image as afwImage
 import lsst.afw.table as afwTable
 import lsst.daf.base as dafBase
@@ -181,6 +182,25 @@ class AlgorithmConfigurationTestCase(lsst.utils.tests.TestCase):
         self.assertEqual(singleFrame.getTransformClass(), measBase.PassThroughTransform)
 
 
+class PixelToSkyJacobiansTestCase(lsst.utils.tests.TestCase):
+
+    def testMatchesLinearize(self):
+        """Bulk Jacobians should match SkyWcs.linearizePixelToSky.
+        """
+        wcs = makeSkyWcs(crpix=lsst.geom.Point2D(1000.0, 2000.0),
+                         crval=lsst.geom.SpherePoint(30.0, 60.0, lsst.geom.degrees),
+                         cdMatrix=makeCdMatrix(scale=0.2*lsst.geom.arcseconds,
+                                               orientation=30*lsst.geom.degrees))
+        rng = np.random.RandomState(5)
+        pixels = [lsst.geom.Point2D(x, y) for x, y in rng.uniform(-5000.0, 5000.0, size=(20, 2))]
+        jacobians = measBase.computePixelToSkyJacobians(wcs, pixels)
+        self.assertEqual(jacobians.shape, (len(pixels), 2, 2))
+        for pixel, jacobian in zip(pixels, jacobians):
+            expected = wcs.linearizePixelToSky(pixel, lsst.geom.radians).getLinear().getMatrix()
+            self.assertFloatsAlmostEqual(jacobian, expected, rtol=1E-8, atol=1E-14)
+        self.assertEqual(len(measBase.computePixelToSkyJacobians(wcs, [])), 0)
+
+
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
 
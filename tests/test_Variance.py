@@ -147,6 +147,19 @@ class VarianceTest(lsst.utils.tests.TestCase):
         # non-masked pixels at this point.
         self.assertFalse(self.source.get("base_Variance_flag_emptyFootprint"))
 
+    def testNumpyMedian(self):
+        """Test that the value is the numpy median of the unmasked pixels in the scaled aperture."""
+        self.task.run(self.catalog, self.exp)
+
+        aperture = afwGeom.Ellipse(self.source.getShape(), self.source.getCentroid())
+        aperture.scale(self.task.config.plugins["base_Variance"].scale)
+        foot = afwDetection.Footprint(afwGeom.SpanSet.fromShape(aperture))
+        foot.clipTo(self.exp.getBBox(afwImage.PARENT))
+        pixels = afwDetection.makeHeavyFootprint(foot, self.exp.getMaskedImage())
+        good = np.logical_not(pixels.getMaskArray() & self.mask.getPlaneBitMask(["BAD", "SAT"]))
+        expected = np.median(pixels.getVarianceArray()[good])
+        self.assertFloatsAlmostEqual(self.source.get("base_Variance_value"), expected, rtol=1E-7)
+
     def testEmptyFootprint(self):
         # Set the pixel mask for all pixels to ``BAD`` and remeasure.
         self.mask.getArray()[:, :] = self.mask.getPlaneBitMask("BAD")
@@ -158,6 +171,32 @@ class VarianceTest(lsst.utils.tests.TestCase):
         self.assertTrue(np.isnan(self.source.get("base_Variance_value")))
         self.assertTrue(self.source.get("base_Variance_flag_emptyFootprint"))
 
+    def testBatch(self):
+        """Test that measuring a batch (through a ResultBuffer) matches
+        measuring each record, including records that fail.
+        """
+        self.task.run(self.catalog, self.exp)
+        bad = self.catalog.addNew()
+        bad.assign(self.source)
+        bad.set("base_NaiveCentroid_x", np.nan)
+        self.catalog = self.catalog.copy(deep=True)
+        for record in self.catalog:
+            record.set("base_Variance_value", np.nan)
+            record.set("base_Variance_flag", False)
+            record.set("base_Variance_flag_emptyFootprint", False)
+        algorithm = self.task.plugins["base_Variance"].cpp
+        serial = self.catalog.copy(deep=True)
+        for record in serial:
+            try:
+                algorithm.measure(record, self.exp)
+            except measBase.MeasurementError as error:
+                algorithm.fail(record, error.cpp)
+        algorithm.measureBatch(self.catalog, self.exp, list(range(len(self.catalog))))
+        for name in ("base_Variance_value", "base_Variance_flag", "base_Variance_flag_emptyFootprint"):
+            np.testing.assert_array_equal(self.catalog[name], serial[name], err_msg=name)
+        self.assertTrue(self.catalog[-1].get("base_Variance_flag"))
+        self.assertFalse(self.catalog[0].get("base_Variance_flag"))
+
 
 class BadCentroidTest(lsst.utils.tests.TestCase):
 
@@ -175,13 +214,15 @@ class BadCentroidTest(lsst.utils.tests.TestCase):
                                                       "variance", schema, None)
         catalog = afwTable.SourceCatalog(schema)
 
+        exposure = afwImage.ExposureF(1, 1)
+
         # The centroid is not flagged as bad, but there's no way the algorithm
         # can run without valid data in the SourceRecord and Exposure: this
         # should throw a logic error.
         record = catalog.addNew()
         record.set("centroid_flag", False)
         with self.assertRaises(measBase.MeasurementError) as measErr:
-            variance.measure(record, None)
+            variance.measure(record, exposure)
         variance.fail(record, measErr.exception)
         self.assertTrue(record.get("variance_flag"))
         self.assertFalse(record.get("variance_flag_badCentroid"))
@@ -191,7 +232,7 @@ class BadCentroidTest(lsst.utils.tests.TestCase):
         record = catalog.addNew()
         record.set("centroid_flag", True)
         with self.assertRaises(measBase.MeasurementError) as measErr:
-            variance.measure(record, None)
+            variance.measure(record, exposure)
         variance.fail(record, measErr.exception)
         self.assertTrue(record.get("variance_flag"))
         self.assertTrue(record.get("variance_flag_badCentroid"))
@@ -24,7 +24,9 @@ import unittest
 import numpy as np
 
 import lsst.geom
+import lsst.afw.geom
 import lsst.afw.image
+import lsst.afw.math
 import lsst.utils.tests
 from lsst.meas.base import LocalBackgroundAlgorithm
 from lsst.meas.base.tests import (AlgorithmTestCase, FluxTransformTestCase,
@@ -90,6 +92,37 @@ class LocalBackgroundTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase):
         exposure, catalog = self.dataset.realize(self.bgStdev, task.schema, randomSeed=12345)
         self.checkCatalog(task, catalog, exposure)
 
+    def testMatchesAfwStatistics(self):
+        """Test that the annulus statistics match afw's MEANCLIP/STDEVCLIP
+        for a source near the edge of the image."""
+        dataset = lsst.meas.base.tests.TestDataset(self.bbox)
+        dataset.addSource(100000.0, lsst.geom.Point2D(10.3, 60.8))
+        config = self.makeSingleFrameMeasurementConfig(self.algName)
+        self.setConfig(config)
+        task = self.makeSingleFrameMeasurementTask(config=config)
+        exposure, catalog = dataset.realize(self.bgStdev, task.schema, randomSeed=54321)
+        exposure.maskedImage.image.array[:] += self.bgValue
+        task.run(catalog, exposure)
+        src = catalog[0]
+
+        psfSigma = exposure.getPsf().computeShape().getDeterminantRadius()
+        center = src.getCentroid()
+
+        def makeCircle(radius):
+            axes = lsst.afw.geom.ellipses.Axes(radius, radius)
+            return lsst.afw.geom.SpanSet.fromShape(lsst.afw.geom.ellipses.Ellipse(axes, center))
+
+        annulus = makeCircle(self.annulusOuter*psfSigma).clippedTo(exposure.getBBox())
+        annulus = annulus.intersectNot(makeCircle(self.annulusInner*psfSigma))
+        values = annulus.flatten(exposure.image.array, exposure.getXY0())
+        stats = lsst.afw.math.makeStatistics(values.astype(np.float32),
+                                             lsst.afw.math.MEANCLIP | lsst.afw.math.STDEVCLIP,
+                                             lsst.afw.math.StatisticsControl(3.0, 3))
+        self.assertFloatsAlmostEqual(src.get(self.algName + "_instFlux"),
+                                     stats.getValue(lsst.afw.math.MEANCLIP), rtol=1E-6)
+        self.assertFloatsAlmostEqual(src.get(self.algName + "_instFluxErr"),
+                                     stats.getValue(lsst.afw.math.STDEVCLIP), rtol=1E-4)
+
     def testForcedPlugin(self):
         config = self.makeForcedMeasurementConfig(self.algName)
         self.setConfig(config)
@@ -34,6 +34,7 @@ import lsst.afw.geom as afwGeom
 import lsst.afw.detection as afwDetection
 import lsst.afw.math as afwMath
 import lsst.meas.base as measBase
+import lsst.meas.base.tests
 import lsst.utils.tests
 
 
@@ -170,6 +171,76 @@ class UndeblendedTestCase(lsst.utils.tests.TestCase):
         self.assertIn("undeblended_" + fieldName + "_apCorr", schema)
         self.assertIn("undeblended_" + fieldName + "_apCorrErr", schema)
 
+    def testThreadedPasses(self):
+        """Check that splitting the undeblended and blendedness passes across
+        threads gives the serial results.
+        """
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(200, 200))
+        dataset = measBase.tests.TestDataset(bbox)
+        for i in range(4):
+            dataset.addSource(50000.0 + 1000.0*i, lsst.geom.Point2D(20.2 + 40*i, 30.7 + 35*i))
+        with dataset.addBlend() as family:
+            family.addChild(70000.0, lsst.geom.Point2D(120.3, 160.8))
+            family.addChild(60000.0, lsst.geom.Point2D(126.1, 165.2))
+
+        results = []
+        for numThreads in (1, 3):
+            config = measBase.SingleFrameMeasurementConfig()
+            config.plugins.names = ["base_SdssCentroid", "base_SdssShape", "base_PsfFlux",
+                                    "base_Blendedness"]
+            config.undeblended.names = ["base_PsfFlux", "base_GaussianFlux"]
+            config.slots.centroid = "base_SdssCentroid"
+            config.slots.shape = "base_SdssShape"
+            config.slots.psfFlux = "base_PsfFlux"
+            for name in ("apFlux", "modelFlux", "gaussianFlux", "calibFlux"):
+                setattr(config.slots, name, None)
+            config.doReplaceWithNoise = False
+            config.numThreads = numThreads
+            schema = measBase.tests.TestDataset.makeMinimalSchema()
+            task = measBase.SingleFrameMeasurementTask(schema=schema, config=config)
+            exposure, catalog = dataset.realize(10.0, schema, randomSeed=2)
+            task.run(catalog, exposure)
+            results.append(catalog)
+        serial, threaded = results
+        for name in ("undeblended_base_PsfFlux_instFlux", "undeblended_base_GaussianFlux_instFlux",
+                     "base_Blendedness_abs", "base_Blendedness_raw"):
+            self.assertFloatsEqual(threaded[name], serial[name], ignoreNaNs=True)
+        self.assertEqual(list(threaded["undeblended_base_PsfFlux_flag"]),
+                         list(serial["undeblended_base_PsfFlux_flag"]))
+
+    def testUndeblendedWeightedSum(self):
+        """Check that the undeblended GaussianFlux does not reuse the weighted
+        sum SdssShape recorded on the noise-replaced image.
+        """
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(100, 100))
+        dataset = measBase.tests.TestDataset(bbox)
+        with dataset.addBlend() as family:
+            family.addChild(70000.0, lsst.geom.Point2D(45.3, 50.8))
+            family.addChild(60000.0, lsst.geom.Point2D(52.1, 55.2))
+
+        results = {}
+        for doRecordWeightedSum in (False, True):
+            config = measBase.SingleFrameMeasurementConfig()
+            config.plugins.names = ["base_SdssCentroid", "base_SdssShape", "base_GaussianFlux"]
+            config.plugins["base_SdssShape"].doRecordWeightedSum = doRecordWeightedSum
+            config.undeblended.names = ["base_GaussianFlux"]
+            config.slots.centroid = "base_SdssCentroid"
+            config.slots.shape = "base_SdssShape"
+            for name in ("psfFlux", "apFlux", "modelFlux", "gaussianFlux", "calibFlux"):
+                setattr(config.slots, name, None)
+            schema = measBase.tests.TestDataset.makeMinimalSchema()
+            task = measBase.SingleFrameMeasurementTask(schema=schema, config=config)
+            exposure, catalog = dataset.realize(10.0, schema, randomSeed=3)
+            task.run(catalog, exposure, exposureId=5)
+            results[doRecordWeightedSum] = catalog
+        recomputed, reused = results[False], results[True]
+        for child in reused.getChildren(reused[0].getId()):
+            self.assertNotEqual(child.get("undeblended_base_GaussianFlux_instFlux"),
+                                2*child.get("base_SdssShape_weightedSum"))
+        for name in ("base_GaussianFlux_instFlux", "undeblended_base_GaussianFlux_instFlux",
+                     "undeblended_base_GaussianFlux_instFluxErr"):
+            self.assertFloatsEqual(reused[name], recomputed[name], ignoreNaNs=True)
+
 
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass